@@ -0,0 +1,280 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+// The driver of the benchmarks: runs the registered benchmark functions,
+// displays the results and compares them with the results of an earlier run.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "bench.h"
+#include "srt.h"
+
+using namespace std;
+
+namespace srt
+{
+namespace bench
+{
+
+namespace
+{
+
+struct Registered
+{
+    const char*   name;
+    BenchFunction fn;
+};
+
+vector<Registered>& registry()
+{
+    static vector<Registered> r;
+    return r;
+}
+
+double percentile(const vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    const size_t i = min(sorted.size() - 1, size_t(p * sorted.size()));
+    return sorted[i];
+}
+
+vector<string> splitList(const string& s)
+{
+    vector<string> out;
+    stringstream   ss(s);
+    string         item;
+    while (getline(ss, item, ','))
+    {
+        if (!item.empty())
+            out.push_back(item);
+    }
+    return out;
+}
+
+bool startsWith(const string& s, const string& prefix)
+{
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+Registrar::Registrar(const char* name, BenchFunction fn)
+{
+    Registered r = {name, fn};
+    registry().push_back(r);
+}
+
+bool Context::selected(const string& prefix) const
+{
+    const vector<string> filters = splitList(m_sFilter);
+    if (filters.empty())
+        return true;
+    for (size_t i = 0; i < filters.size(); ++i)
+    {
+        // Either the filter selects the whole group, or a case in it.
+        if (startsWith(prefix, filters[i]) || startsWith(filters[i], prefix))
+            return true;
+    }
+    return false;
+}
+
+Case::Case(Context& ctx, const string& name)
+    : m_Context(ctx)
+    , m_sName(name)
+    , m_bSelected(ctx.selected(name))
+    , m_tsStart(clock_type::now())
+    , m_uOps(0)
+    , m_uBytes(0)
+    , m_dTimeNs(0)
+{
+}
+
+bool Case::running() const
+{
+    // At least one sample is always done.
+    return m_bSelected && (m_uOps == 0 || elapsed_ns(m_tsStart) < m_Context.timeMs() * 1e6);
+}
+
+void Case::end(size_t nops, size_t nbytes)
+{
+    const double ns = elapsed_ns(m_tsBegin);
+    m_uOps += nops;
+    m_uBytes += nbytes;
+    m_dTimeNs += ns;
+    m_Samples.push_back(ns / max<size_t>(nops, 1));
+}
+
+Case::~Case()
+{
+    if (!m_bSelected)
+        return;
+
+    Result r;
+    r.name = m_sName;
+    r.ops  = m_uOps;
+    r.note = m_sNote;
+    if (m_dTimeNs > 0)
+    {
+        r.ops_per_s = m_uOps / m_dTimeNs * 1e9;
+        r.mb_per_s  = m_uBytes / m_dTimeNs * 1e3;
+    }
+
+    sort(m_Samples.begin(), m_Samples.end());
+    r.p50  = percentile(m_Samples, 0.5);
+    r.p90  = percentile(m_Samples, 0.9);
+    r.p99  = percentile(m_Samples, 0.99);
+    r.p999 = percentile(m_Samples, 0.999);
+    r.max  = m_Samples.empty() ? 0 : m_Samples.back();
+
+    ostringstream mb;
+    if (m_uBytes)
+        mb << fixed << setprecision(1) << r.mb_per_s;
+    else
+        mb << "-";
+    cout << left << setw(40) << r.name << right << fixed << setprecision(3) << setw(12) << r.ops_per_s / 1e6
+         << setw(10) << mb.str() << setprecision(1) << setw(10) << r.p50 << setw(10) << r.p90 << setw(10) << r.p99
+         << setw(10) << r.p999 << setw(12) << r.max;
+    if (!r.note.empty())
+        cout << "  " << r.note;
+    cout << endl;
+
+    m_Context.results().push_back(r);
+}
+
+} // namespace bench
+} // namespace srt
+
+using namespace srt::bench;
+
+static void writeCSV(const string& path, const vector<Result>& results)
+{
+    ofstream out(path.c_str());
+    out << "name,ops,ops_per_s,mb_per_s,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        out << r.name << "," << r.ops << "," << r.ops_per_s << "," << r.mb_per_s << "," << r.p50 << "," << r.p90 << ","
+            << r.p99 << "," << r.p999 << "," << r.max << "\n";
+    }
+}
+
+// Returns the number of cases with the throughput lower than in the baseline
+// by more than the given tolerance.
+static int compareWithBaseline(const string& path, const vector<Result>& results, double tolerance)
+{
+    ifstream in(path.c_str());
+    if (!in)
+    {
+        cerr << "Can't read the baseline file " << path << endl;
+        return 1;
+    }
+
+    map<string, pair<double, double> > baseline; // throughput and p99
+    string                              line;
+    getline(in, line); // header
+    while (getline(in, line))
+    {
+        const vector<string> f = splitList(line);
+        if (f.size() >= 7)
+            baseline[f[0]] = make_pair(atof(f[2].c_str()), atof(f[6].c_str()));
+    }
+
+    cout << "\nComparison with " << path << " (tolerance " << tolerance * 100 << "%):\n";
+    int nregressions = 0;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        map<string, pair<double, double> >::const_iterator b = baseline.find(r.name);
+        if (b == baseline.end() || b->second.first <= 0)
+            continue;
+
+        const double ratio     = r.ops_per_s / b->second.first;
+        const bool   regressed = ratio < 1 - tolerance;
+        nregressions += regressed;
+        cout << left << setw(40) << r.name << right << fixed << setprecision(1) << " throughput " << setw(6)
+             << (ratio - 1) * 100 << "%, p99 " << setw(10) << b->second.second << " -> " << setw(10) << r.p99 << " ns"
+             << (regressed ? "  REGRESSION" : "") << endl;
+    }
+    return nregressions;
+}
+
+static void usage(const char* argv0)
+{
+    cerr << "Usage: " << argv0 << " [options]\n"
+         << "  -f, --filter PREFIX[,PREFIX...]  run only the cases with the name starting with a prefix\n"
+         << "  -t, --time MS                    measuring time of every case (default 300)\n"
+         << "      --csv FILE                   write the results to a CSV file\n"
+         << "      --baseline FILE              compare with the results written by --csv before,\n"
+         << "                                   exit with 1 if the throughput of a case is lower\n"
+         << "      --tolerance PERCENT          allowed throughput decrease (default 10)\n"
+         << "  -l, --list                       list the benchmark groups\n";
+}
+
+int main(int argc, char** argv)
+{
+    string filter, csv, baseline;
+    int    time_ms   = 300;
+    double tolerance = 0.1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        const bool   has_value = i + 1 < argc;
+        if ((arg == "-f" || arg == "--filter") && has_value)
+            filter = argv[++i];
+        else if ((arg == "-t" || arg == "--time") && has_value)
+            time_ms = atoi(argv[++i]);
+        else if (arg == "--csv" && has_value)
+            csv = argv[++i];
+        else if (arg == "--baseline" && has_value)
+            baseline = argv[++i];
+        else if (arg == "--tolerance" && has_value)
+            tolerance = atof(argv[++i]) / 100;
+        else if (arg == "-l" || arg == "--list")
+        {
+            for (size_t r = 0; r < registry().size(); ++r)
+                cout << registry()[r].name << endl;
+            return 0;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    srt_setloglevel(LOG_ERR);
+
+    Context ctx(filter, max(time_ms, 1));
+    cout << left << setw(40) << "Case" << right << setw(12) << "Mops/s" << setw(10) << "MB/s" << setw(10) << "p50 ns"
+         << setw(10) << "p90 ns" << setw(10) << "p99 ns" << setw(10) << "p99.9 ns" << setw(12) << "max ns" << endl;
+
+    for (size_t r = 0; r < registry().size(); ++r)
+    {
+        if (ctx.selected(registry()[r].name))
+            registry()[r].fn(ctx);
+    }
+
+    if (!csv.empty())
+        writeCSV(csv, ctx.results());
+
+    if (!baseline.empty())
+        return compareWithBaseline(baseline, ctx.results(), tolerance) == 0 ? 0 : 1;
+    return 0;
+}
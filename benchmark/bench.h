@@ -0,0 +1,134 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#ifndef INC_SRT_BENCH_H
+#define INC_SRT_BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace srt
+{
+namespace bench
+{
+
+typedef std::chrono::steady_clock clock_type;
+
+inline double elapsed_ns(clock_type::time_point since, clock_type::time_point until = clock_type::now())
+{
+    return std::chrono::duration<double, std::nano>(until - since).count();
+}
+
+/// Results of one case: the number of operations done in the measured time
+/// and the percentiles of the time per operation.
+struct Result
+{
+    std::string name;
+    uint64_t    ops       = 0;
+    double      ops_per_s = 0;
+    double      mb_per_s  = 0;
+    double      p50 = 0, p90 = 0, p99 = 0, p999 = 0, max = 0; // ns
+    std::string note;
+};
+
+class Context
+{
+public:
+    Context(const std::string& filter, int time_ms)
+        : m_sFilter(filter)
+        , m_iTimeMs(time_ms)
+    {
+    }
+
+    /// Whether any case with the name starting with @a prefix is selected to run.
+    /// To be checked before an expensive setup.
+    bool selected(const std::string& prefix) const;
+
+    int timeMs() const { return m_iTimeMs; }
+
+    std::vector<Result>& results() { return m_Results; }
+
+private:
+    std::string         m_sFilter;
+    int                 m_iTimeMs;
+    std::vector<Result> m_Results;
+};
+
+/// Measurement of one case, reported when destroyed. The operations are
+/// timed in samples, until the measuring time is used up:
+///
+///     Case c(ctx, "CSndBuffer.addBuffer");
+///     while (c.running())
+///     {
+///         prepare();   // not measured
+///         c.begin();
+///         ... n operations ...
+///         c.end(n);
+///     }
+///
+/// The percentiles are taken from the time per operation in the samples, so
+/// a sample should contain a single operation, unless it is too short to be
+/// measured alone. Operations done in other threads are counted with addOps(),
+/// their latency added with record(), and the elapsed time set with setTime().
+class Case
+{
+public:
+    Case(Context& ctx, const std::string& name);
+    ~Case();
+
+    /// Whether the case is selected and its measuring time is not yet used up.
+    bool running() const;
+
+    void begin() { m_tsBegin = clock_type::now(); }
+    void end(size_t nops = 1, size_t nbytes = 0);
+
+    void addOps(size_t nops, size_t nbytes = 0) { m_uOps += nops; m_uBytes += nbytes; }
+    void record(double ns) { m_Samples.push_back(ns); }
+    void setTime(double ns) { m_dTimeNs = ns; }
+
+    /// Add a note displayed with the results.
+    void note(const std::string& text) { m_sNote = text; }
+
+private:
+    Case(const Case&);
+    Case& operator=(const Case&);
+
+    Context&               m_Context;
+    const std::string      m_sName;
+    const bool             m_bSelected;
+    clock_type::time_point m_tsStart;
+    clock_type::time_point m_tsBegin;
+    uint64_t               m_uOps;
+    uint64_t               m_uBytes;
+    double                 m_dTimeNs;
+    std::vector<double>    m_Samples;
+    std::string            m_sNote;
+};
+
+typedef void (*BenchFunction)(Context&);
+
+/// Registers a benchmark function, to be called by main() in the order of registration.
+struct Registrar
+{
+    Registrar(const char* name, BenchFunction fn);
+};
+
+} // namespace bench
+} // namespace srt
+
+/// Define a benchmark function, which runs its cases in the given context.
+#define SRT_BENCHMARK(name)                                                     \
+    static void srtbench_##name(srt::bench::Context& ctx);                     \
+    static srt::bench::Registrar srtbench_reg_##name(#name, &srtbench_##name); \
+    static void srtbench_##name(srt::bench::Context& ctx)
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+// The socket lookup done by every API call, from one thread and from
+// several threads, each with its own sockets.
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "srt.h"
+
+using namespace std;
+using namespace srt::bench;
+
+namespace
+{
+
+const int NSOCKETS = 1000;
+
+void runLookup(Context& ctx, const string& name, const vector<SRTSOCKET>& ids, int nthreads)
+{
+    if (!ctx.selected(name))
+        return;
+
+    atomic<bool>     go(false), stop(false);
+    atomic<uint64_t> ops(0), bad(0);
+    vector<thread>   threads;
+    for (int t = 0; t < nthreads; ++t)
+    {
+        threads.emplace_back([&, t] {
+            while (!go)
+                this_thread::yield();
+
+            uint64_t n = 0, nbad = 0;
+            while (!stop)
+            {
+                for (size_t i = t; i < ids.size(); i += nthreads)
+                    nbad += srt_getsockstate(ids[i]) != SRTS_INIT;
+                n += (ids.size() + nthreads - 1 - t) / nthreads;
+            }
+            ops += n;
+            bad += nbad;
+        });
+    }
+
+    const clock_type::time_point start = clock_type::now();
+    go                                 = true;
+    this_thread::sleep_for(chrono::milliseconds(ctx.timeMs()));
+    stop = true;
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+    Case c(ctx, name);
+    c.addOps(ops);
+    c.setTime(elapsed_ns(start));
+    if (bad)
+    {
+        ostringstream note;
+        note << bad << " not found";
+        c.note(note.str());
+    }
+}
+
+} // namespace
+
+SRT_BENCHMARK(API)
+{
+    if (!ctx.selected("API"))
+        return;
+
+    srt_startup();
+    vector<SRTSOCKET> ids;
+    for (int i = 0; i < NSOCKETS; ++i)
+        ids.push_back(srt_create_socket());
+
+    {
+        Case   c(ctx, "API.getsockstate");
+        size_t bad = 0;
+        while (c.running())
+        {
+            c.begin();
+            for (size_t i = 0; i < ids.size(); ++i)
+                bad += srt_getsockstate(ids[i]) != SRTS_INIT;
+            c.end(ids.size());
+        }
+        if (bad)
+            c.note("not found");
+    }
+
+    runLookup(ctx, "API.getsockstate(4 threads)", ids, 4);
+    runLookup(ctx, "API.getsockstate(16 threads)", ids, 16);
+
+    for (size_t i = 0; i < ids.size(); ++i)
+        srt_close(ids[i]);
+    srt_cleanup();
+}
@@ -0,0 +1,225 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+// The sender and receiver buffers, with live mode packets.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "buffer_snd.h"
+#include "buffer_rcv.h"
+#include "queue.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::bench;
+
+namespace
+{
+
+const int PAYLOAD_SIZE = 1316;
+const int MAX_PAYLOAD  = 1456;
+const int BUFFER_SIZE  = 8192;
+const int FILL         = 1024; // Packets in the buffer, before it's emptied
+const int ISN          = 1000;
+
+// Add a single packet message.
+void addMessage(CSndBuffer& buf, const char* data, int32_t& w_seqno)
+{
+    SRT_MSGCTRL mc = srt_msgctrl_default;
+    mc.pktseq      = w_seqno;
+    buf.addBuffer(data, PAYLOAD_SIZE, (mc));
+    w_seqno = mc.pktseq;
+}
+
+int readData(CSndBuffer& buf, CPacket& w_pkt)
+{
+    sync::steady_clock::time_point origin;
+    int                            seqnoinc  = 0;
+    bool                           encrypted = false;
+    return buf.readData((w_pkt), (origin), 0, (seqnoinc), (encrypted));
+}
+
+// Insert a single packet message at the given offset from the initial sequence number.
+int insertPacket(CRcvBuffer& buf, CUnitQueue& units, int32_t isn, int offset)
+{
+    CUnit* unit = units.getNextAvailUnit();
+    if (!unit)
+        return -1;
+
+    CPacket& pkt     = unit->m_Packet;
+    pkt.m_iSeqNo     = CSeqNo::incseq(isn, offset);
+    pkt.m_iMsgNo     = (offset + 1) | PacketBoundaryBits(PB_SOLO) | MSGNO_PACKET_INORDER::wrap(1);
+    pkt.m_iTimeStamp = offset;
+    pkt.setLength(PAYLOAD_SIZE);
+    return buf.insert(unit);
+}
+
+} // namespace
+
+SRT_BENCHMARK(CSndBuffer)
+{
+    const vector<char> payload(PAYLOAD_SIZE, 'x');
+
+    {
+        CSndBuffer buf(AF_INET, BUFFER_SIZE, MAX_PAYLOAD, 0);
+        int32_t    seqno = ISN;
+        Case       c(ctx, "CSndBuffer.addBuffer");
+        while (c.running())
+        {
+            for (int i = 0; i < FILL; ++i)
+            {
+                c.begin();
+                addMessage(buf, &payload[0], (seqno));
+                c.end(1, PAYLOAD_SIZE);
+            }
+            buf.ackData(FILL);
+        }
+    }
+
+    {
+        CSndBuffer buf(AF_INET, BUFFER_SIZE, MAX_PAYLOAD, 0);
+        int32_t    seqno = ISN;
+        CPacket    pkt;
+        Case       c(ctx, "CSndBuffer.readData");
+        while (c.running())
+        {
+            for (int i = 0; i < FILL; ++i)
+                addMessage(buf, &payload[0], (seqno));
+            for (int i = 0; i < FILL; ++i)
+            {
+                c.begin();
+                readData(buf, (pkt));
+                c.end(1, PAYLOAD_SIZE);
+            }
+            buf.ackData(FILL);
+        }
+    }
+
+    {
+        // Retransmission: the packets read at random offsets from the ACK point.
+        CSndBuffer buf(AF_INET, BUFFER_SIZE, MAX_PAYLOAD, 0);
+        int32_t    seqno = ISN;
+        CPacket    pkt;
+        for (int i = 0; i < FILL; ++i)
+        {
+            addMessage(buf, &payload[0], (seqno));
+            readData(buf, (pkt));
+        }
+
+        mt19937                        rnd(7);
+        uniform_int_distribution<int>  offsets(0, FILL - 1);
+        Case                           c(ctx, "CSndBuffer.readData(rexmit)");
+        while (c.running())
+        {
+            const int                      offset = offsets(rnd);
+            sync::steady_clock::time_point origin;
+            int                            msglen = 0;
+            c.begin();
+            buf.readData(offset, (pkt), (origin), (msglen));
+            c.end(1, PAYLOAD_SIZE);
+        }
+    }
+
+    {
+        CSndBuffer buf(AF_INET, BUFFER_SIZE, MAX_PAYLOAD, 0);
+        int32_t    seqno = ISN;
+        CPacket    pkt;
+        Case       c(ctx, "CSndBuffer.ackData(x16)");
+        while (c.running())
+        {
+            for (int i = 0; i < FILL; ++i)
+            {
+                addMessage(buf, &payload[0], (seqno));
+                readData(buf, (pkt));
+            }
+            for (int i = 0; i < FILL; i += 16)
+            {
+                c.begin();
+                buf.ackData(16);
+                c.end(16);
+            }
+        }
+    }
+}
+
+SRT_BENCHMARK(CRcvBuffer)
+{
+    {
+        CUnitQueue units(BUFFER_SIZE, MAX_PAYLOAD);
+        CRcvBuffer buf(ISN, BUFFER_SIZE, &units, true);
+        int32_t    isn = ISN;
+        char       data[MAX_PAYLOAD];
+        Case       c(ctx, "CRcvBuffer.insert");
+        while (c.running())
+        {
+            for (int i = 0; i < FILL; ++i)
+            {
+                c.begin();
+                insertPacket(buf, units, isn, i);
+                c.end(1, PAYLOAD_SIZE);
+            }
+            for (int i = 0; i < FILL; ++i)
+                buf.readMessage(data, sizeof data);
+            isn = CSeqNo::incseq(isn, FILL);
+        }
+    }
+
+    {
+        // Reordered within groups of 16 packets, as after retransmissions.
+        vector<int> order(FILL);
+        for (int i = 0; i < FILL; ++i)
+            order[i] = i;
+        mt19937 rnd(7);
+        for (int i = 0; i < FILL; i += 16)
+            shuffle(order.begin() + i, order.begin() + i + 16, rnd);
+
+        CUnitQueue units(BUFFER_SIZE, MAX_PAYLOAD);
+        CRcvBuffer buf(ISN, BUFFER_SIZE, &units, true);
+        int32_t    isn = ISN;
+        char       data[MAX_PAYLOAD];
+        Case       c(ctx, "CRcvBuffer.insert(reordered)");
+        while (c.running())
+        {
+            for (int i = 0; i < FILL; ++i)
+            {
+                c.begin();
+                insertPacket(buf, units, isn, order[i]);
+                c.end(1, PAYLOAD_SIZE);
+            }
+            for (int i = 0; i < FILL; ++i)
+                buf.readMessage(data, sizeof data);
+            isn = CSeqNo::incseq(isn, FILL);
+        }
+    }
+
+    {
+        CUnitQueue units(BUFFER_SIZE, MAX_PAYLOAD);
+        CRcvBuffer buf(ISN, BUFFER_SIZE, &units, true);
+        int32_t    isn = ISN;
+        char       data[MAX_PAYLOAD];
+        Case       c(ctx, "CRcvBuffer.readMessage");
+        while (c.running())
+        {
+            for (int i = 0; i < FILL; ++i)
+                insertPacket(buf, units, isn, i);
+            for (int i = 0; i < FILL; ++i)
+            {
+                c.begin();
+                buf.readMessage(data, sizeof data);
+                c.end(1, PAYLOAD_SIZE);
+            }
+            isn = CSeqNo::incseq(isn, FILL);
+        }
+    }
+}
@@ -0,0 +1,258 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+// Loopback transmission between two UDP channels, and between two channels
+// on the in-process link, with the packets sent one by one and in batches. The sender keeps a limited number of packets
+// in flight, so that they aren't dropped by the system, and the latency is
+// the time from sending to receiving every packet.
+
+#include <atomic>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "channel.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::bench;
+
+namespace
+{
+
+const int    PAYLOAD_SIZE = 1316;
+const int    MAX_PAYLOAD  = 1456;
+const int    UDP_BUFFER   = 1024 * 1024;
+const int    WINDOW       = 256; // Packets in flight
+const double LOST_AFTER_NS = 20e6; // Time after which all packets in flight are taken as lost
+
+struct Counters
+{
+    atomic<uint64_t> received;
+    atomic<bool>     done;
+    Counters()
+        : received(0)
+        , done(false)
+    {
+    }
+};
+
+// Every packet carries the time of sending.
+void stamp(char* payload)
+{
+    const int64_t now = clock_type::now().time_since_epoch().count();
+    memcpy(payload, &now, sizeof now);
+}
+
+double latencyOf(const char* payload, clock_type::time_point now)
+{
+    int64_t sent;
+    memcpy(&sent, payload, sizeof sent);
+    return elapsed_ns(clock_type::time_point(clock_type::duration(sent)), now);
+}
+
+// With io_uring the packets are received into the packets lent to the channel.
+void receiveLent(const CChannel& channel, int batch, Counters& w_cnt, vector<double>& w_latencies)
+{
+    const size_t         bufsize = CChannel::RECV_HEADROOM + MAX_PAYLOAD;
+    vector<char>         bufs(CChannel::RECV_LENT_MAX * bufsize);
+    vector<CPacket>      packets(CChannel::RECV_LENT_MAX);
+    vector<sockaddr_any> addrs(batch);
+    vector<int>          ids(batch);
+    vector<EReadStatus>  status(batch);
+    for (int id = 0; id < CChannel::RECV_LENT_MAX; ++id)
+    {
+        packets[id].m_pcData = &bufs[id * bufsize + CChannel::RECV_HEADROOM];
+        packets[id].setLength(MAX_PAYLOAD);
+        channel.lendRecvPacket(packets[id], id);
+    }
+
+    while (!w_cnt.done)
+    {
+        int nrecv = 0;
+        channel.recvfrom_lent(&addrs[0], &ids[0], &status[0], batch, (nrecv));
+
+        const clock_type::time_point now = clock_type::now();
+        for (int i = 0; i < nrecv; ++i)
+        {
+            CPacket& pkt = packets[ids[i]];
+            if (status[i] == RST_OK)
+            {
+                w_latencies.push_back(latencyOf(pkt.data(), now));
+                ++w_cnt.received;
+            }
+            pkt.setLength(MAX_PAYLOAD);
+            channel.lendRecvPacket(pkt, ids[i]);
+        }
+    }
+    channel.stopReceiving();
+}
+
+void receive(const CChannel& channel, int batch, Counters& w_cnt, vector<double>& w_latencies)
+{
+    if (channel.receivesLent())
+    {
+        receiveLent(channel, batch, w_cnt, w_latencies);
+        return;
+    }
+
+    vector<CPacket>      packets(batch);
+    vector<CPacket*>     ptrs(batch);
+    vector<sockaddr_any> addrs(batch);
+    vector<EReadStatus>  status(batch);
+    for (int i = 0; i < batch; ++i)
+    {
+        packets[i].allocate(MAX_PAYLOAD);
+        ptrs[i] = &packets[i];
+    }
+
+    while (!w_cnt.done)
+    {
+        for (int i = 0; i < batch; ++i)
+            packets[i].setLength(MAX_PAYLOAD);
+
+        int nrecv = 0;
+        if (batch > 1)
+        {
+            channel.recvfrom_batch(&addrs[0], &ptrs[0], &status[0], batch, (nrecv));
+        }
+        else
+        {
+            status[0] = channel.recvfrom((addrs[0]), (packets[0]));
+            nrecv     = status[0] == RST_OK ? 1 : 0;
+        }
+
+        const clock_type::time_point now = clock_type::now();
+        for (int i = 0; i < nrecv; ++i)
+        {
+            if (status[i] != RST_OK)
+                continue;
+            w_latencies.push_back(latencyOf(packets[i].data(), now));
+            ++w_cnt.received;
+        }
+    }
+}
+
+void runChannel(Context& ctx, const string& name, int batch, bool iouring, const string& inproc = "")
+{
+    if (!ctx.selected(name))
+        return;
+
+    CSrtMuxerConfig cfg;
+    cfg.iUDPRcvBufSize = UDP_BUFFER;
+    cfg.iUDPSndBufSize = UDP_BUFFER;
+    cfg.iUDPRcvBatch   = batch;
+    cfg.iUDPSndBatch   = batch;
+    cfg.bUDPIoUring    = iouring;
+    cfg.sInprocLink    = inproc;
+
+    in_addr lo;
+    lo.s_addr = htonl(INADDR_LOOPBACK);
+    CChannel rcv, snd;
+    rcv.setConfig(cfg);
+    snd.setConfig(cfg);
+    rcv.open(sockaddr_any(lo, 0));
+    snd.open(sockaddr_any(lo, 0));
+    sockaddr_any dst;
+    rcv.getSockAddr((dst));
+
+    Counters       cnt;
+    vector<double> latencies;
+    thread         receiver(receive, ref(rcv), batch, ref(cnt), ref(latencies));
+
+    // The packets for sendto_batch(), the header in the network order followed by the payload.
+    vector<vector<char> > bufs(batch, vector<char>(CPacket::HDR_SIZE + PAYLOAD_SIZE, 0));
+    vector<CSendSlot>     slots(batch);
+    CSendBatchBuffers     sndbufs;
+    CPacket               pkt;
+    pkt.allocate(MAX_PAYLOAD);
+    pkt.setLength(PAYLOAD_SIZE);
+
+    const sockaddr_any           src(AF_INET);
+    const clock_type::time_point start = clock_type::now();
+    uint64_t                     sent = 0, lost = 0;
+    int32_t                      seq  = 0;
+    while (elapsed_ns(start) < ctx.timeMs() * 1e6)
+    {
+        const clock_type::time_point wait_start = clock_type::now();
+        while (sent - lost - cnt.received > uint64_t(WINDOW - batch))
+        {
+            if (elapsed_ns(wait_start) > LOST_AFTER_NS)
+            {
+                lost = sent - cnt.received;
+                break;
+            }
+            this_thread::yield();
+        }
+
+        if (batch > 1)
+        {
+            for (int i = 0; i < batch; ++i)
+            {
+                uint32_t* hdr     = reinterpret_cast<uint32_t*>(&bufs[i][0]);
+                hdr[SRT_PH_SEQNO] = htonl(seq++);
+                hdr[SRT_PH_MSGNO] = htonl(seq | MSGNO_PACKET_BOUNDARY::wrap(PB_SOLO));
+                hdr[SRT_PH_TIMESTAMP] = 0;
+                hdr[SRT_PH_ID]        = 0;
+                stamp(&bufs[i][CPacket::HDR_SIZE]);
+
+                slots[i].addr   = dst;
+                slots[i].source = src;
+                slots[i].data   = &bufs[i][0];
+                slots[i].size   = bufs[i].size();
+            }
+            snd.sendto_batch(&slots[0], batch, (sndbufs));
+            sent += batch;
+        }
+        else
+        {
+            pkt.m_iSeqNo = seq++;
+            pkt.m_iMsgNo = seq | MSGNO_PACKET_BOUNDARY::wrap(PB_SOLO);
+            stamp(pkt.data());
+            snd.sendto(dst, pkt, src);
+            ++sent;
+        }
+    }
+
+    // Let the last packets come.
+    const clock_type::time_point end = clock_type::now();
+    while (cnt.received + lost < sent && elapsed_ns(end) < LOST_AFTER_NS)
+        this_thread::yield();
+    const double time_ns = elapsed_ns(start);
+    cnt.done             = true;
+    receiver.join();
+    rcv.close();
+    snd.close();
+
+    Case c(ctx, name);
+    c.addOps(cnt.received, cnt.received * PAYLOAD_SIZE);
+    c.setTime(time_ns);
+    for (size_t i = 0; i < latencies.size(); ++i)
+        c.record(latencies[i]);
+
+    ostringstream note;
+    note << sent - cnt.received << " lost";
+    c.note(note.str());
+}
+
+} // namespace
+
+SRT_BENCHMARK(Channel)
+{
+    runChannel(ctx, "Channel.sendto", 1, false);
+    runChannel(ctx, "Channel.batch(x32)", 32, false);
+#ifdef SRT_ENABLE_IO_URING
+    runChannel(ctx, "Channel.iouring(x32)", 32, true);
+#endif
+    runChannel(ctx, "Channel.inproc", 1, false, "on");
+    runChannel(ctx, "Channel.inproc(x32)", 32, false, "on");
+}
@@ -0,0 +1,170 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+// The payload encryption and decryption with a 256-bit key, one packet at a
+// time and in batches, in the AES-CTR and (where supported) AES-GCM modes.
+
+#include "platform_sys.h"
+
+#if defined(SRT_ENABLE_ENCRYPTION)
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "bench.h"
+#include "crypto.h"
+#include "hcrypt.h"
+#include "socketconfig.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::bench;
+
+namespace
+{
+
+const size_t PAYLOAD_SIZE = 1316;
+const int    BATCH        = 32;
+
+// Set up the keys, with the same instance as the sender and the receiver.
+bool initCrypto(CCryptoControl& w_crypt, int mode)
+{
+    const string pwd = "abcdefghijk";
+    CSrtConfig   cfg;
+    memset(&cfg.CryptoSecret, 0, sizeof(cfg.CryptoSecret));
+    cfg.CryptoSecret.typ = HAICRYPT_SECTYP_PASSPHRASE;
+    cfg.CryptoSecret.len = pwd.size();
+    memcpy((cfg.CryptoSecret.str), pwd.c_str(), pwd.size());
+    w_crypt.setCryptoSecret(cfg.CryptoSecret);
+
+    cfg.iSndCryptoKeyLen = SrtHSRequest::SRT_PBKEYLEN_BITS::wrap(4);
+    w_crypt.setCryptoKeylen(cfg.iSndCryptoKeyLen);
+    cfg.iCryptoMode = mode;
+    if (!w_crypt.init(HSD_INITIATOR, cfg, true))
+        return false;
+
+    const size_t km_len = w_crypt.getKmMsg_size(0);
+    uint32_t     km_nworder[72];
+    uint32_t     kmout[72];
+    size_t       kmout_len = 72;
+    NtoHLA(km_nworder, reinterpret_cast<const uint32_t*>(w_crypt.getKmMsg_data(0)), km_len);
+    w_crypt.processSrtMsg_KMREQ(km_nworder, km_len, 5, kmout, kmout_len);
+    return true;
+}
+
+void makePacket(CPacket& w_pkt, int kflg, int i)
+{
+    w_pkt.allocate(1500);
+    w_pkt.m_iSeqNo     = 1000 + i;
+    w_pkt.m_iMsgNo     = (1 + i) | PacketBoundaryBits(PB_SOLO) | MSGNO_ENCKEYSPEC::wrap(kflg);
+    w_pkt.m_iTimeStamp = 356 + i;
+    for (size_t b = 0; b < PAYLOAD_SIZE; ++b)
+        w_pkt.data()[b] = char(i + b);
+    w_pkt.setLength(PAYLOAD_SIZE);
+}
+
+void copyPacket(CPacket& w_dst, CPacket& src)
+{
+    memcpy(w_dst.getHeader(), src.getHeader(), CPacket::HDR_SIZE);
+    memcpy(w_dst.data(), src.data(), src.getLength());
+    w_dst.setLength(src.getLength());
+}
+
+void runMode(Context& ctx, const string& name, int mode)
+{
+    if (!ctx.selected(name))
+        return;
+
+    CCryptoControl crypt(SRT_INVALID_SOCK);
+    if (!initCrypto((crypt), mode))
+    {
+        Case c(ctx, name);
+        c.note("not supported");
+        return;
+    }
+    const int kflg = crypt.getSndCryptoFlags();
+
+    vector<unique_ptr<CPacket> > clear, encrypted, work;
+    vector<CPacket*>             ptrs;
+    for (int i = 0; i < BATCH; ++i)
+    {
+        clear.emplace_back(new CPacket);
+        encrypted.emplace_back(new CPacket);
+        work.emplace_back(new CPacket);
+        makePacket(*clear.back(), kflg, i);
+        makePacket(*encrypted.back(), kflg, i);
+        crypt.encrypt(*encrypted.back());
+        work.back()->allocate(1500);
+        ptrs.push_back(work.back().get());
+    }
+
+    {
+        Case c(ctx, name + ".encrypt");
+        while (c.running())
+        {
+            copyPacket(*work[0], *clear[0]);
+            c.begin();
+            crypt.encrypt(*work[0]);
+            c.end(1, PAYLOAD_SIZE);
+        }
+    }
+
+    {
+        Case c(ctx, name + ".decrypt");
+        while (c.running())
+        {
+            copyPacket(*work[0], *encrypted[0]);
+            c.begin();
+            const EncryptionStatus st = crypt.decrypt(*work[0]);
+            c.end(1, PAYLOAD_SIZE);
+            if (st != ENCS_CLEAR)
+                c.note("decryption failed");
+        }
+    }
+
+    {
+        Case c(ctx, name + ".encrypt(x32)");
+        while (c.running())
+        {
+            for (int i = 0; i < BATCH; ++i)
+                copyPacket(*work[i], *clear[i]);
+            c.begin();
+            crypt.encrypt(&ptrs[0], BATCH);
+            c.end(BATCH, BATCH * PAYLOAD_SIZE);
+        }
+    }
+
+    {
+        Case             c(ctx, name + ".decrypt(x32)");
+        EncryptionStatus status[BATCH];
+        while (c.running())
+        {
+            for (int i = 0; i < BATCH; ++i)
+                copyPacket(*work[i], *encrypted[i]);
+            c.begin();
+            crypt.decrypt(&ptrs[0], BATCH, status);
+            c.end(BATCH, BATCH * PAYLOAD_SIZE);
+            if (status[0] != ENCS_CLEAR)
+                c.note("decryption failed");
+        }
+    }
+}
+
+} // namespace
+
+SRT_BENCHMARK(CCryptoControl)
+{
+    runMode(ctx, "CCryptoControl.CTR", CSrtConfig::CIPHER_MODE_AES_CTR);
+    if (HaiCrypt_IsAESGCM_Supported())
+        runMode(ctx, "CCryptoControl.GCM", CSrtConfig::CIPHER_MODE_AES_GCM);
+}
+
+#endif
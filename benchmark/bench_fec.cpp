@@ -0,0 +1,180 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+// The builtin FEC filters: the sender producing the FEC packets, and the
+// receiver rebuilding one lost packet in every 10.
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "bench.h"
+#include "packet.h"
+#include "packetfilter.h"
+#include "fec.h"
+#include "fec_rs.h"
+#include "socketconfig.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::bench;
+
+namespace
+{
+
+const int       SOCKID       = 54321;
+const int32_t   ISN          = 123456;
+const size_t    PAYLOAD_SIZE = 1316;
+const int       NPACKETS     = 2000;
+
+SrtFilterInitializer makeInitializer()
+{
+    SrtFilterInitializer init = {SOCKID, ISN - 1, ISN - 1, PAYLOAD_SIZE, CSrtConfig::DEF_BUFFER_SIZE};
+    return init;
+}
+
+CPacket* makeDataPacket(int i)
+{
+    CPacket* p = new CPacket;
+    p->allocate(SRT_LIVE_MAX_PLSIZE);
+    uint32_t* hdr         = p->getHeader();
+    hdr[SRT_PH_SEQNO]     = CSeqNo::incseq(ISN, i);
+    hdr[SRT_PH_MSGNO]     = (i + 1) | MSGNO_PACKET_BOUNDARY::wrap(PB_SOLO);
+    hdr[SRT_PH_ID]        = SOCKID;
+    hdr[SRT_PH_TIMESTAMP] = 10 * i;
+
+    // Sizes vary as with the variable bitrate.
+    const size_t length = PAYLOAD_SIZE - (i * 37) % 500;
+    for (size_t b = 0; b < length; ++b)
+        p->data()[b] = char(i + b);
+    p->setLength(length);
+    return p;
+}
+
+// Copy the FEC packet as PacketFilter::packControlPacket() does.
+CPacket* makeControlPacket(const SrtPacket& ctl)
+{
+    CPacket* p = new CPacket;
+    p->allocate(SRT_LIVE_MAX_PLSIZE);
+    memcpy(p->getHeader(), ctl.hdr, SRT_PH_E_SIZE * sizeof(uint32_t));
+    memcpy(p->data(), ctl.buffer, ctl.length);
+    p->setLength(ctl.length);
+    p->m_iMsgNo = SRT_MSGNO_CONTROL | MSGNO_PACKET_BOUNDARY::wrap(PB_SOLO);
+    p->setMsgCryptoFlags(EncryptionKeySpec(0));
+    return p;
+}
+
+// Send the packets through the sender filter, as CUDT::packData() does,
+// optionally collecting the packets sent, including the FEC packets.
+template <class Filter>
+void sendThroughFilter(Filter& fec, const vector<unique_ptr<CPacket> >& source, Case* c,
+                       vector<unique_ptr<CPacket> >* w_sent)
+{
+    SrtPacket ctl(SRT_LIVE_MAX_PLSIZE);
+    int32_t   lastseq = CSeqNo::decseq(ISN);
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        if (c)
+            c->begin();
+        // Every FEC packet ready goes instead of the data packet,
+        // as long as the filter has any.
+        while (fec.packControlPacket(ctl, lastseq))
+        {
+            if (w_sent)
+                w_sent->push_back(unique_ptr<CPacket>(makeControlPacket(ctl)));
+        }
+        fec.feedSource(*source[i]);
+        if (c)
+            c->end(1, source[i]->getLength());
+
+        if (w_sent)
+            w_sent->push_back(unique_ptr<CPacket>(source[i]->clone()));
+        lastseq = source[i]->getSeqNo();
+    }
+}
+
+template <class Filter>
+void runConfig(Context& ctx, const string& name, const string& config)
+{
+    if (!ctx.selected(name))
+        return;
+
+    vector<unique_ptr<CPacket> > source;
+    for (int i = 0; i < NPACKETS; ++i)
+        source.push_back(unique_ptr<CPacket>(makeDataPacket(i)));
+
+    {
+        Case c(ctx, name + ".encode");
+        while (c.running())
+        {
+            vector<SrtPacket> provided;
+            Filter            fec(makeInitializer(), provided, config);
+            sendThroughFilter(fec, source, &c, NULL);
+        }
+    }
+
+    if (!ctx.selected(name + ".rebuild"))
+        return;
+
+    vector<unique_ptr<CPacket> > sent;
+    {
+        vector<SrtPacket> provided;
+        Filter            fec(makeInitializer(), provided, config);
+        sendThroughFilter(fec, source, NULL, &sent);
+    }
+
+    // One packet lost in every 10 (the length of a row, or of a block of "rs"), at a random position.
+    vector<bool>                  lost(sent.size(), false);
+    mt19937                       rnd(7);
+    uniform_int_distribution<int> pos(0, 9);
+    for (int i = 0; i < NPACKETS; i += 10)
+        lost[i + pos(rnd)] = true;
+
+    Case   c(ctx, name + ".rebuild");
+    size_t nrebuilt = 0;
+    while (c.running())
+    {
+        vector<SrtPacket> provided;
+        Filter            fec(makeInitializer(), provided, config);
+
+        int data_index = 0;
+        for (size_t i = 0; i < sent.size(); ++i)
+        {
+            const bool is_data = sent[i]->getMsgSeq() != SRT_MSGNO_CONTROL;
+            if (is_data && lost[data_index++])
+                continue;
+
+            typename Filter::loss_seqs_t loss;
+            c.begin();
+            fec.receive(*sent[i], (loss));
+            c.end(1, sent[i]->getLength());
+            nrebuilt += provided.size();
+            provided.clear();
+        }
+    }
+
+    ostringstream note;
+    note << nrebuilt << " rebuilt";
+    c.note(note.str());
+}
+
+} // namespace
+
+SRT_BENCHMARK(FEC)
+{
+    PacketFilter::globalInit();
+
+    runConfig<FECFilterBuiltin>(ctx, "FEC.row", "fec,cols:10,rows:1");
+    runConfig<FECFilterBuiltin>(ctx, "FEC.matrix", "fec,cols:10,rows:10");
+    runConfig<RSFilterBuiltin>(ctx, "FEC.rs", "rs,k:10,m:2");
+    runConfig<RSFilterBuiltin>(ctx, "FEC.rs(20+5)", "rs,k:20,m:5");
+}
@@ -0,0 +1,161 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+// The sender and receiver loss lists, with scattered losses of 1 to 3 packets,
+// as reported by the receiver and retransmitted by the sender. Every round
+// takes the losses in the next half of the window, as the ACK moves forward.
+
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "list.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::bench;
+
+namespace
+{
+
+const int     WINDOW = 8192;
+const int     ROUND  = WINDOW / 2;
+const int32_t ISN    = 0x7FFFF000; // Wraps around after a few rounds
+
+struct Loss
+{
+    int32_t first, last;
+};
+
+// Losses in the given round (offsets within a round are always the same).
+vector<Loss> makeLosses(int round)
+{
+    static vector<int> offsets, lengths;
+    if (offsets.empty())
+    {
+        mt19937                       rnd(7);
+        uniform_int_distribution<int> gap(1, 20), len(1, 3);
+        for (int pos = gap(rnd); pos + 3 < ROUND; pos += gap(rnd))
+        {
+            offsets.push_back(pos);
+            lengths.push_back(len(rnd));
+            pos += lengths.back();
+        }
+    }
+
+    const int32_t base = CSeqNo::incseq(ISN, (round % 1024) * ROUND);
+    vector<Loss>  losses(offsets.size());
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        losses[i].first = CSeqNo::incseq(base, offsets[i]);
+        losses[i].last  = CSeqNo::incseq(losses[i].first, lengths[i] - 1);
+    }
+    return losses;
+}
+
+} // namespace
+
+SRT_BENCHMARK(CSndLossList)
+{
+    {
+        CSndLossList list(WINDOW * 2);
+        Case         c(ctx, "CSndLossList.insert");
+        for (int round = 0; c.running(); ++round)
+        {
+            const vector<Loss> l = makeLosses(round);
+            for (size_t i = 0; i < l.size(); ++i)
+            {
+                c.begin();
+                list.insert(l[i].first, l[i].last);
+                c.end();
+            }
+            list.removeUpTo(l.back().last);
+        }
+    }
+
+    {
+        CSndLossList list(WINDOW * 2);
+        Case         c(ctx, "CSndLossList.popLostSeq");
+        for (int round = 0; c.running(); ++round)
+        {
+            const vector<Loss> l = makeLosses(round);
+            for (size_t i = 0; i < l.size(); ++i)
+                list.insert(l[i].first, l[i].last);
+
+            for (;;)
+            {
+                c.begin();
+                const int32_t seq = list.popLostSeq();
+                c.end();
+                if (seq == SRT_SEQNO_NONE)
+                    break;
+            }
+        }
+    }
+}
+
+SRT_BENCHMARK(CRcvLossList)
+{
+    {
+        CRcvLossList list(WINDOW);
+        Case         c(ctx, "CRcvLossList.insert");
+        for (int round = 0; c.running(); ++round)
+        {
+            const vector<Loss> l = makeLosses(round);
+            for (size_t i = 0; i < l.size(); ++i)
+            {
+                c.begin();
+                list.insert(l[i].first, l[i].last);
+                c.end();
+            }
+            list.removeUpTo(l.back().last);
+        }
+    }
+
+    {
+        // The retransmitted packets received in order.
+        CRcvLossList list(WINDOW);
+        Case         c(ctx, "CRcvLossList.remove");
+        for (int round = 0; c.running(); ++round)
+        {
+            const vector<Loss> l = makeLosses(round);
+            for (size_t i = 0; i < l.size(); ++i)
+                list.insert(l[i].first, l[i].last);
+
+            for (size_t i = 0; i < l.size(); ++i)
+            {
+                for (int32_t s = l[i].first; CSeqNo::seqcmp(s, l[i].last) <= 0; s = CSeqNo::incseq(s))
+                {
+                    c.begin();
+                    list.remove(s);
+                    c.end();
+                }
+            }
+        }
+    }
+
+    {
+        // The loss report, sent periodically while the losses are in the list.
+        CRcvLossList       list(WINDOW);
+        const vector<Loss> l = makeLosses(0);
+        for (size_t i = 0; i < l.size(); ++i)
+            list.insert(l[i].first, l[i].last);
+
+        int32_t array[350];
+        Case    c(ctx, "CRcvLossList.getLossArray");
+        while (c.running())
+        {
+            int len = 0;
+            c.begin();
+            list.getLossArray(array, len, 350);
+            c.end();
+        }
+    }
+}
@@ -0,0 +1,297 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+// The structures of the multiplexer queues: the socket lookup of the receiver
+// queue and the scheduling heap of the sender queue.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "api.h"
+#include "queue.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::bench;
+
+namespace srt
+{
+
+// Access to the private parts of CUDT, granted for the tests.
+class TestMockCUDT
+{
+public:
+    static void open(CUDT& u) { u.open(); }
+};
+
+} // namespace srt
+
+namespace
+{
+
+const int NSOCKETS = 1000;
+
+// The previous implementation of CHash, with chained buckets and a fixed
+// size, kept for comparison.
+class ChainedHash
+{
+public:
+    explicit ChainedHash(int size)
+        : m_buckets(size, nullptr)
+    {
+    }
+
+    ~ChainedHash()
+    {
+        for (Bucket* b : m_buckets)
+        {
+            while (b)
+            {
+                Bucket* n = b->next;
+                delete b;
+                b = n;
+            }
+        }
+    }
+
+    CUDT* lookup(int32_t id) const
+    {
+        for (const Bucket* b = m_buckets[id % m_buckets.size()]; b; b = b->next)
+        {
+            if (b->id == id)
+                return b->udt;
+        }
+        return nullptr;
+    }
+
+    void insert(int32_t id, CUDT* u)
+    {
+        Bucket*& head = m_buckets[id % m_buckets.size()];
+        head          = new Bucket{id, u, head};
+    }
+
+private:
+    struct Bucket
+    {
+        int32_t id;
+        CUDT*   udt;
+        Bucket* next;
+    };
+    vector<Bucket*> m_buckets;
+};
+
+// Socket IDs are assigned in decreasing order, starting from a random value.
+// The lookups come in random order, as the packets of many sockets are received.
+vector<int32_t> makeSocketIDs(int count)
+{
+    vector<int32_t> ids;
+    for (int32_t i = 0; i < count; ++i)
+        ids.push_back(0x2345678 - i);
+    mt19937 rnd(7);
+    shuffle(ids.begin(), ids.end(), rnd);
+    return ids;
+}
+
+// The socket instances are never accessed by CHash, so any distinct pointer values will do.
+CUDT* fakeSocket(int32_t id)
+{
+    return reinterpret_cast<CUDT*>(static_cast<intptr_t>(id) * 16);
+}
+
+template <class Table>
+void lookupCase(Context& ctx, const string& name, const Table& table, const vector<int32_t>& ids)
+{
+    Case   c(ctx, name);
+    size_t found = 0;
+    while (c.running())
+    {
+        c.begin();
+        for (size_t i = 0; i < ids.size(); ++i)
+            found += table.lookup(ids[i]) != NULL;
+        c.end(ids.size());
+    }
+    if (found == 0)
+        c.note("nothing found");
+}
+
+} // namespace
+
+SRT_BENCHMARK(CHash)
+{
+    // The socket instances are never accessed by CHash, so any distinct pointer values will do.
+    vector<int32_t> ids;
+    CHash           hash;
+    hash.init(1024);
+    for (int32_t i = 0; i < NSOCKETS; ++i)
+    {
+        ids.push_back(0x2345678 - i);
+        hash.insert(ids.back(), reinterpret_cast<CUDT*>(static_cast<intptr_t>(i + 1) * 16));
+    }
+
+    // Random order, as the packets of many sockets are received.
+    mt19937 rnd(7);
+    shuffle(ids.begin(), ids.end(), rnd);
+
+    {
+        Case   c(ctx, "CHash.lookup");
+        size_t found = 0;
+        while (c.running())
+        {
+            c.begin();
+            for (size_t i = 0; i < ids.size(); ++i)
+                found += hash.lookup(ids[i]) != NULL;
+            c.end(ids.size());
+        }
+        if (found == 0)
+            c.note("nothing found");
+    }
+
+    {
+        Case   c(ctx, "CHash.lookup(missing)");
+        size_t found = 0;
+        while (c.running())
+        {
+            c.begin();
+            for (size_t i = 0; i < ids.size(); ++i)
+                found += hash.lookup(ids[i] + NSOCKETS) != NULL;
+            c.end(ids.size());
+        }
+        if (found != 0)
+            c.note("found a missing socket");
+    }
+
+    {
+        Case   c(ctx, "CHash.lookupShared");
+        size_t found = 0;
+        while (c.running())
+        {
+            c.begin();
+            for (size_t i = 0; i < ids.size(); ++i)
+                found += hash.lookupShared(ids[i]) != NULL;
+            c.end(ids.size());
+        }
+        if (found == 0)
+            c.note("nothing found");
+    }
+}
+
+// The open addressing table against the previous chained one, with the
+// 1024 buckets used by the multiplexer.
+SRT_BENCHMARK(CHashChained)
+{
+    if (!ctx.selected("CHash"))
+        return;
+
+    const int counts[] = {10, 1000, 50000};
+    for (size_t k = 0; k < sizeof counts / sizeof counts[0]; ++k)
+    {
+        const vector<int32_t> ids = makeSocketIDs(counts[k]);
+
+        ChainedHash chained(1024);
+        CHash       hash;
+        hash.init(1024);
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            chained.insert(ids[i], fakeSocket(ids[i]));
+            hash.insert(ids[i], fakeSocket(ids[i]));
+        }
+
+        const string suffix = "(" + to_string(counts[k]) + " sockets)";
+        lookupCase(ctx, "CHash.lookup" + suffix, hash, ids);
+        lookupCase(ctx, "CHash.lookupChained" + suffix, chained, ids);
+    }
+}
+
+SRT_BENCHMARK(CSndUList)
+{
+    if (!ctx.selected("CSndUList"))
+        return;
+
+    // The sockets are needed for their scheduling nodes only, created when opened.
+    vector<unique_ptr<CUDTSocket> > owned;
+    vector<CUDT*>                   sockets;
+    for (int i = 0; i < NSOCKETS; ++i)
+    {
+        owned.emplace_back(new CUDTSocket);
+        TestMockCUDT::open(owned.back()->core());
+        sockets.push_back(&owned.back()->core());
+    }
+
+    // The sending times in the past, so that all can be popped at once.
+    typedef sync::steady_clock::time_point time_point;
+    mt19937                       rnd(7);
+    uniform_int_distribution<int> past_us(1000, 1000000);
+    vector<time_point>            times(NSOCKETS);
+
+    sync::CTimer timer;
+    CSndUList    list(&timer);
+
+    {
+        Case c(ctx, "CSndUList.update(insert)");
+        while (c.running())
+        {
+            const time_point now = sync::steady_clock::now();
+            for (int i = 0; i < NSOCKETS; ++i)
+                times[i] = now - sync::microseconds_from(past_us(rnd));
+
+            for (int i = 0; i < NSOCKETS; ++i)
+            {
+                c.begin();
+                list.update(sockets[i], CSndUList::DO_RESCHEDULE, times[i]);
+                c.end();
+            }
+            while (list.pop())
+                ;
+        }
+    }
+
+    {
+        // Rescheduled earlier, as when a packet is to be retransmitted.
+        Case c(ctx, "CSndUList.update(reschedule)");
+        while (c.running())
+        {
+            const time_point now = sync::steady_clock::now();
+            for (int i = 0; i < NSOCKETS; ++i)
+            {
+                times[i] = now - sync::microseconds_from(past_us(rnd));
+                list.update(sockets[i], CSndUList::DO_RESCHEDULE, now);
+            }
+
+            for (int i = 0; i < NSOCKETS; ++i)
+            {
+                c.begin();
+                list.update(sockets[i], CSndUList::DO_RESCHEDULE, times[i]);
+                c.end();
+            }
+            while (list.pop())
+                ;
+        }
+    }
+
+    {
+        Case c(ctx, "CSndUList.pop");
+        while (c.running())
+        {
+            const time_point now = sync::steady_clock::now();
+            for (int i = 0; i < NSOCKETS; ++i)
+                list.update(sockets[i], CSndUList::DO_RESCHEDULE, now - sync::microseconds_from(past_us(rnd)));
+
+            for (int i = 0; i < NSOCKETS; ++i)
+            {
+                c.begin();
+                list.pop();
+                c.end();
+            }
+        }
+    }
+}
@@ -743,6 +743,87 @@ static int crysprFallback_MsDecrypt(CRYSPR_cb *cryspr_cb, hcrypt_Ctx *ctx,
 }
 
 
+#if CRYSPR_HAS_AESCTR
+/*
+ * Encrypt or decrypt a batch of AES-CTR packets directly in the input buffers.
+ * The key is taken once for the batch and the output buffer copy is skipped,
+ * so the packets are processed back to back by the crypto library.
+ */
+static int _crysprFallback_CtrBatch(CRYSPR_cb *cryspr_cb, hcrypt_Ctx *ctx, bool bEncrypt,
+	hcrypt_DataDesc *in_data, int nbin, int res[])
+{
+	CRYSPR_AESCTX *aes_key = CRYSPR_GETSEK(cryspr_cb, hcryptCtx_GetKeyIndex(ctx));
+	int nbfail = 0;
+	int i;
+
+	for (i = 0; i < nbin; i++) {
+		unsigned char iv[CRYSPR_AESBLKSZ];
+		hcrypt_Pki pki = hcryptMsg_GetPki(ctx->msg_info, in_data[i].pfx, 1);
+
+		/* Same IV as for a single packet (see crysprFallback_MsEncrypt) */
+		hcrypt_SetCtrIV((unsigned char *)&pki, ctx->salt, iv);
+		if (cryspr_cb->cryspr->aes_ctr_cipher(bEncrypt, aes_key, iv, in_data[i].payload, in_data[i].len,
+				in_data[i].payload)) {
+			nbfail++;
+			if (NULL != res) res[i] = -1;
+		} else if (NULL != res) {
+			res[i] = 0;
+		}
+	}
+	return(nbfail);
+}
+#endif /* CRYSPR_HAS_AESCTR */
+
+static int crysprFallback_MsEncryptBatch(CRYSPR_cb *cryspr_cb, hcrypt_Ctx *ctx,
+	hcrypt_DataDesc *in_data, int nbin)
+{
+	int i;
+
+	ASSERT(NULL != cryspr_cb);
+	ASSERT(NULL != ctx);
+
+#if CRYSPR_HAS_AESCTR
+	if (ctx->mode == HCRYPT_CTX_MODE_AESCTR) {
+		return(_crysprFallback_CtrBatch(cryspr_cb, ctx, true, in_data, nbin, NULL) ? -1 : 0);
+	}
+#endif /* CRYSPR_HAS_AESCTR */
+
+	for (i = 0; i < nbin; i++) {
+		int nbout = cryspr_cb->cryspr->ms_encrypt(cryspr_cb, ctx, &in_data[i], 1, NULL, NULL, NULL);
+		if (nbout < 0) {
+			return(-1);
+		}
+		if (nbout > 0) {
+			/* Encoding produced more payload (auth tag) */
+			in_data[i].len = nbout;
+		}
+	}
+	return(0);
+}
+
+static int crysprFallback_MsDecryptBatch(CRYSPR_cb *cryspr_cb, hcrypt_Ctx *ctx,
+	hcrypt_DataDesc *in_data, int nbin, int res[])
+{
+	int nbfail = 0;
+	int i;
+
+	ASSERT(NULL != cryspr_cb);
+	ASSERT(NULL != ctx);
+
+#if CRYSPR_HAS_AESCTR
+	if (ctx->mode == HCRYPT_CTX_MODE_AESCTR) {
+		return(_crysprFallback_CtrBatch(cryspr_cb, ctx, false, in_data, nbin, res));
+	}
+#endif /* CRYSPR_HAS_AESCTR */
+
+	for (i = 0; i < nbin; i++) {
+		res[i] = cryspr_cb->cryspr->ms_decrypt(cryspr_cb, ctx, &in_data[i], 1, NULL, NULL, NULL) < 0 ? -1 : 0;
+		if (res[i] < 0) nbfail++;
+	}
+	return(nbfail);
+}
+
+
 CRYSPR_methods *crysprInit(CRYSPR_methods *cryspr)
 {
 	/* CryptoLib Primitive API */
@@ -765,6 +846,8 @@ CRYSPR_methods *crysprInit(CRYSPR_methods *cryspr)
 	cryspr->ms_setkey  = crysprFallback_MsSetKey;
 	cryspr->ms_encrypt = crysprFallback_MsEncrypt;
 	cryspr->ms_decrypt = crysprFallback_MsDecrypt;
+	cryspr->ms_encrypt_batch = crysprFallback_MsEncryptBatch;
+	cryspr->ms_decrypt_batch = crysprFallback_MsDecryptBatch;
 
 	return(cryspr);
 }
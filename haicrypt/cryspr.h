@@ -213,6 +213,30 @@ typedef struct tag_CRYSPR_methods {
             hcrypt_DataDesc *in_data, int nbin,             /* Clear text transport packets: header and payload */
             void *out_p[], size_t out_len_p[], int *nbout); /* Encrypted packets */
 
+        /*
+        * encrypt_batch:
+        * Encrypt nbin clear transport packets (hcrypt_DataDesc *in_data) in place, all with the current key of ctx.
+        * in_data[].len is updated with the encrypted length (auth tag added in AES-GCM).
+        * Returns 0 on success, -1 on failure.
+        */
+        int (*ms_encrypt_batch)(
+            CRYSPR_cb *cryspr_cb,                           /* Cryspr Control Block */
+            hcrypt_Ctx *ctx,                                /* HaiCrypt Context (cipher, keys, Odd/Even, etc..) */
+            hcrypt_DataDesc *in_data, int nbin);            /* Clear text transport packets: header and payload */
+
+        /*
+        * decrypt_batch:
+        * Decrypt nbin encrypted transport packets (hcrypt_DataDesc *in_data) in place, all with the key of ctx.
+        * in_data[].len is updated with the clear text length, res[] is set to 0 for a decrypted packet
+        * or -1 for a packet that failed (e.g. authentication in AES-GCM).
+        * Returns the number of failed packets.
+        */
+        int (*ms_decrypt_batch)(
+            CRYSPR_cb *cryspr_cb,                           /* Cryspr Control Block */
+            hcrypt_Ctx *ctx,                                /* HaiCrypt Context (cipher, keys, Odd/Even, etc..) */
+            hcrypt_DataDesc *in_data, int nbin,             /* Encrypted transport packets: header and payload */
+            int res[]);                                     /* Result for each packet */
+
 } CRYSPR_methods;
 
 CRYSPR_cb  *crysprHelper_Open(CRYSPR_methods *cryspr, size_t cb_len, size_t max_len);
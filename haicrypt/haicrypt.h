@@ -109,6 +109,17 @@ int  HaiCrypt_Tx_ManageKeys(HaiCrypt_Handle hhc, void *out_p[], size_t out_len_p
 int  HaiCrypt_Tx_Data(HaiCrypt_Handle hhc, unsigned char *pfx, unsigned char *data, size_t data_len);
 int  HaiCrypt_Rx_Data(HaiCrypt_Handle hhc, unsigned char *pfx, unsigned char *data, size_t data_len);
 
+/// @brief Encrypt several packets in place with one call, as HaiCrypt_Tx_Data() for each of them.
+/// @param data_len [in,out] payload lengths, updated with the encrypted lengths (auth tag added in AES-GCM).
+/// @return 0 on success, -1 on failure.
+int  HaiCrypt_Tx_DataBatch(HaiCrypt_Handle hhc, unsigned char *pfx[], unsigned char *data[], size_t data_len[], int nb);
+
+/// @brief Decrypt several packets in place with one call, as HaiCrypt_Rx_Data() for each of them.
+/// @param data_len [in,out] payload lengths, updated with the decrypted lengths.
+/// @param res [out] result for each packet, as returned by HaiCrypt_Rx_Data().
+/// @return the number of packets not decrypted, -1 on invalid parameters.
+int  HaiCrypt_Rx_DataBatch(HaiCrypt_Handle hhc, unsigned char *pfx[], unsigned char *data[], size_t data_len[], int res[], int nb);
+
 /// @brief Check if the crypto service provider supports AES GCM.
 /// @return returns 1 if AES GCM is supported, 0 otherwise.
 int  HaiCrypt_IsAESGCM_Supported(void);
@@ -114,6 +114,9 @@ typedef struct hcrypt_Session_str {
 #define ASSERT(c)   assert(c)
 #endif
 
+/* Max packets passed at once to the cryspr batch methods (stack descriptors) */
+#define HCRYPT_BATCH_MAX    64
+
 
 /* HaiCrypt-TP CTR mode IV (128-bit):
  *    0   1   2   3   4   5  6   7   8   9   10  11  12  13  14  15
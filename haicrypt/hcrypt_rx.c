@@ -61,6 +61,64 @@ int HaiCrypt_Rx_Data(HaiCrypt_Handle hhc,
 	return(nb);
 }
 
+int HaiCrypt_Rx_DataBatch(HaiCrypt_Handle hhc,
+	unsigned char *in_pfx[], unsigned char *data[], size_t data_len[], int res[], int nb)
+{
+	hcrypt_Session *crypto = (hcrypt_Session *)hhc;
+	hcrypt_Ctx *ctx;
+	hcrypt_DataDesc indata[HCRYPT_BATCH_MAX];
+	int nbfail = 0;
+	int done, n, i;
+
+	if ((NULL == crypto)
+	||  (NULL == data)
+	||  (0 > nb)) {
+		HCRYPT_LOG(LOG_ERR, "%s", "invalid parameters\n");
+		return(-1);
+	}
+	ASSERT(NULL != crypto->cryspr); /* Header check should prevent this error */
+
+	for (done = 0; done < nb; done += n) {
+		/* Consecutive packets with the same key (odd|even) are decrypted together */
+		const unsigned kidx = hcryptMsg_GetKeyIndex(crypto->msg_info, in_pfx[done]);
+
+		for (n = 1; (done + n < nb) && (n < HCRYPT_BATCH_MAX)
+				&& (hcryptMsg_GetKeyIndex(crypto->msg_info, in_pfx[done + n]) == kidx); n++) {
+		}
+
+		ctx = &crypto->ctx_pair[kidx];
+		crypto->ctx = ctx; /* Context of last received msg */
+
+		if (NULL == crypto->cryspr->ms_decrypt_batch) {
+			HCRYPT_LOG(LOG_ERR, "%s", "cryspr had no decryptor\n");
+			for (i = 0; i < n; i++) res[done + i] = -1;
+			nbfail += n;
+		} else if (ctx->status >= HCRYPT_CTX_S_KEYED) {
+			for (i = 0; i < n; i++) {
+				indata[i].pfx      = in_pfx[done + i];
+				indata[i].payload  = data[done + i];
+				indata[i].len      = data_len[done + i];
+			}
+
+			if (0 < crypto->cryspr->ms_decrypt_batch(crypto->cryspr_cb, ctx, indata, n, &res[done])) {
+				HCRYPT_LOG(LOG_ERR, "%s", "ms_decrypt_batch failed\n");
+			}
+			for (i = 0; i < n; i++) {
+				if (0 > res[done + i]) {
+					nbfail++;
+				} else {
+					data_len[done + i] = indata[i].len;
+					res[done + i] = (int)indata[i].len;
+				}
+			}
+		} else { /* No key received yet */
+			for (i = 0; i < n; i++) res[done + i] = 0;
+			nbfail += n;
+		}
+	}
+	return(nbfail);
+}
+
 int HaiCrypt_Rx_Process(HaiCrypt_Handle hhc, 
 	unsigned char *in_msg, size_t in_len, 
 	void *out_p[], size_t out_len_p[], int maxout)
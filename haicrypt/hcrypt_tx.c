@@ -129,6 +129,51 @@ int HaiCrypt_Tx_Data(HaiCrypt_Handle hhc,
 	return(nbout);
 }
 
+int HaiCrypt_Tx_DataBatch(HaiCrypt_Handle hhc,
+	unsigned char *in_pfx[], unsigned char *in_data[], size_t in_len[], int nb)
+{
+	hcrypt_Session *crypto = (hcrypt_Session *)hhc;
+	hcrypt_Ctx *ctx = NULL;
+	hcrypt_DataDesc indata[HCRYPT_BATCH_MAX];
+	int done, n, i;
+
+	if ((NULL == crypto)
+	||  (NULL == (ctx = crypto->ctx))
+	||  (0 > nb)) {
+		HCRYPT_LOG(LOG_ERR, "Tx_DataBatch: invalid params: crypto=%p crypto->ctx=%p nb=%d\n", crypto, ctx, nb);
+		return(-1);
+	}
+
+	for (done = 0; done < nb; done += n) {
+		n = (nb - done) < HCRYPT_BATCH_MAX ? (nb - done) : HCRYPT_BATCH_MAX;
+
+		for (i = 0; i < n; i++) {
+			/* Get/Set packet index */
+			ctx->msg_info->indexMsg(in_pfx[done + i], ctx->MSpfx_cache);
+
+			if (hcryptMsg_GetKeyIndex(ctx->msg_info, in_pfx[done + i]) != hcryptCtx_GetKeyIndex(ctx))
+			{
+				HCRYPT_LOG(LOG_ERR, "Tx_DataBatch: Key mismatch!");
+			}
+			indata[i].pfx      = in_pfx[done + i];
+			indata[i].payload  = in_data[done + i];
+			indata[i].len      = in_len[done + i];
+		}
+
+		/* Encrypt */
+		if (0 > crypto->cryspr->ms_encrypt_batch(crypto->cryspr_cb, ctx, indata, n)) {
+			HCRYPT_LOG(LOG_ERR, "%s", "ms_encrypt_batch failed\n");
+			return(-1);
+		}
+		for (i = 0; i < n; i++) {
+			in_len[done + i] = indata[i].len;
+		}
+		ctx->pkt_cnt += n;
+	}
+
+	return(0);
+}
+
 int HaiCrypt_Tx_Process(HaiCrypt_Handle hhc,
 	unsigned char *in_msg, size_t in_len,
 	void *out_p[], size_t out_len_p[], int maxout)
@@ -158,6 +158,7 @@ function(ShowProjectConfig)
       "    ENABLE_RELATIVE_LIBPATH: ${ENABLE_RELATIVE_LIBPATH}\n"
       "    ENABLE_GETNAMEINFO: ${ENABLE_GETNAMEINFO}\n"
       "    ENABLE_UNITTESTS: ${ENABLE_UNITTESTS}\n"
+      "    ENABLE_BENCHMARKS: ${ENABLE_BENCHMARKS}\n"
       "    ENABLE_ENCRYPTION: ${ENABLE_ENCRYPTION}\n"
       "    ENABLE_CXX_DEPS: ${ENABLE_CXX_DEPS}\n"
       "    USE_STATIC_LIBSTDCXX: ${USE_STATIC_LIBSTDCXX}\n"
@@ -170,6 +171,7 @@ function(ShowProjectConfig)
       "    USE_BUSY_WAITING: ${USE_BUSY_WAITING}\n"
       "    USE_GNUSTL: ${USE_GNUSTL}\n"
       "    ENABLE_SOCK_CLOEXEC: ${ENABLE_SOCK_CLOEXEC}\n"
+      "    ENABLE_IO_URING: ${ENABLE_IO_URING}\n"
       "    ENABLE_SHOW_PROJECT_CONFIG: ${ENABLE_SHOW_PROJECT_CONFIG}\n"
       "    ENABLE_CLANG_TSA: ${ENABLE_CLANG_TSA}\n"
       "    ATOMIC_USE_SRT_SYNC_MUTEX: ${ATOMIC_USE_SRT_SYNC_MUTEX}\n"
@@ -143,6 +143,7 @@ void srt::CUDTSocket::setBrokenClosed()
 {
     m_UDT.m_iBrokenCounter = 60;
     m_UDT.m_bBroken        = true;
+    m_UDT.rescheduleTimers();
     setClosed();
 }
 
@@ -237,7 +238,7 @@ string srt::CUDTUnited::CONID(SRTSOCKET sock)
     return os.str();
 }
 
-int srt::CUDTUnited::startup()
+int srt::CUDTUnited::startup(int tsbpd_workers)
 {
     ScopedLock gcinit(m_InitLock);
 
@@ -268,6 +269,9 @@ int srt::CUDTUnited::startup()
 
     m_bGCStatus = true;
 
+    if (tsbpd_workers > 0 && !m_TsbPdPool.start(tsbpd_workers))
+        return -1;
+
     HLOGC(inlog.Debug, log << "SRT Clock Type: " << SRT_SYNC_CLOCK_STR);
 
     return 0;
@@ -302,6 +306,7 @@ int srt::CUDTUnited::cleanup()
     // pthread_join() call will block for 1 second.
     CSync::notify_one_relaxed(m_GCStopCond);
     m_GCThread.join();
+    m_TsbPdPool.stop();
 
     m_bGCStatus = false;
 
@@ -454,10 +459,15 @@ SRTSOCKET srt::CUDTUnited::newSocket(CUDTSocket** pps)
         // protect the m_Sockets structure.
         ScopedLock cs(m_GlobControlLock);
         m_Sockets[ns->m_SocketID] = ns;
+        m_SocketTable.insert(ns->m_SocketID, ns);
     }
     catch (...)
     {
         // failure and rollback
+        {
+            ScopedLock cs(m_GlobControlLock);
+            m_Sockets.erase(ns->m_SocketID);
+        }
         delete ns;
         ns = NULL;
         throw CUDTException(MJ_SYSTEMRES, MN_MEMORY, 0);
@@ -604,6 +614,7 @@ int srt::CUDTUnited::newConnection(const SRTSOCKET     listen,
         {
             ScopedLock cg(m_GlobControlLock);
             m_Sockets[ns->m_SocketID] = ns;
+            m_SocketTable.insert(ns->m_SocketID, ns);
         }
 
         if (ls->core().m_cbAcceptHook)
@@ -896,7 +907,14 @@ int srt::CUDTUnited::installConnectHook(const SRTSOCKET u, srt_connect_callback_
 
 SRT_SOCKSTATUS srt::CUDTUnited::getStatus(const SRTSOCKET u)
 {
-    // protects the m_Sockets structure
+    {
+        CSocketTable::Reader r(m_SocketTable, u);
+        if (CUDTSocket* s = r.socket())
+            return s->m_Status == SRTS_CLOSED ? SRTS_CLOSED : s->getStatus();
+    }
+
+    // Not in the table, but may be still in m_ClosedSockets
+    // after it was released from the table.
     ScopedLock cg(m_GlobControlLock);
 
     sockets_t::const_iterator i = m_Sockets.find(u);
@@ -1486,8 +1504,8 @@ int srt::CUDTUnited::groupConnect(CUDTGroup* pg, SRT_SOCKGROUPCONFIG* targets, i
             else
             {
                 targets[tii].id = CUDT::INVALID_SOCK;
-                delete ns;
                 m_Sockets.erase(sid);
+                m_SocketTable.dispose(ns);
 
                 // If failed to set options, then do not continue
                 // neither with binding, nor with connecting.
@@ -1553,7 +1571,7 @@ int srt::CUDTUnited::groupConnect(CUDTGroup* pg, SRT_SOCKGROUPCONFIG* targets, i
             ns->removeFromGroup(false);
             m_Sockets.erase(ns->m_SocketID);
             // Intercept to delete the socket on failure.
-            delete ns;
+            m_SocketTable.dispose(ns);
             continue;
         }
         catch (...)
@@ -1565,7 +1583,7 @@ int srt::CUDTUnited::groupConnect(CUDTGroup* pg, SRT_SOCKGROUPCONFIG* targets, i
             ns->removeFromGroup(false);
             m_Sockets.erase(ns->m_SocketID);
             // Intercept to delete the socket on failure.
-            delete ns;
+            m_SocketTable.dispose(ns);
 
             // Do not use original exception, it may crash off a C API.
             throw CUDTException(MJ_SYSTEMRES, MN_OBJECT);
@@ -1906,13 +1924,28 @@ int srt::CUDTUnited::close(const SRTSOCKET u)
         return 0;
     }
 #endif
-    CUDTSocket* s = locateSocket(u);
+    CUDTSocket* s = locateSocket(u, ERH_RETURN);
     if (!s)
-        throw CUDTException(MJ_NOTSUP, MN_SIDINVAL, 0);
+        return unsubscribeClosed(u);
 
     return close(s);
 }
 
+int srt::CUDTUnited::unsubscribeClosed(const SRTSOCKET u)
+{
+    // The socket may have been closed already by the GC after its
+    // connection broke, but it stays subscribed in the EIDs until it's
+    // removed. As the application has closed it, it's no longer reported.
+    ScopedLock cg(m_GlobControlLock);
+    sockets_t::iterator i = m_ClosedSockets.find(u);
+    if (i == m_ClosedSockets.end())
+        throw CUDTException(MJ_NOTSUP, MN_SIDINVAL, 0);
+
+    i->second->core().removeEPolls();
+    HLOGC(smlog.Debug, log << "@" << u << "U::close: closed already, removed from the EIDs");
+    return 0;
+}
+
 #if ENABLE_BONDING
 void srt::CUDTUnited::deleteGroup(CUDTGroup* g)
 {
@@ -2480,11 +2513,18 @@ int srt::CUDTUnited::epoll_release(const int eid)
     return m_EPoll.release(eid);
 }
 
+int srt::CUDTUnited::epoll_notify_fd(const int eid)
+{
+    return m_EPoll.notify_fd(eid);
+}
+
 srt::CUDTSocket* srt::CUDTUnited::locateSocket(const SRTSOCKET u, ErrorHandling erh)
 {
-    ScopedLock  cg(m_GlobControlLock);
-    CUDTSocket* s = locateSocket_LOCKED(u);
-    if (!s)
+    // The socket found is valid at least until it's closed, just
+    // like when found in m_Sockets under m_GlobControlLock.
+    CSocketTable::Reader r(m_SocketTable, u);
+    CUDTSocket*          s = r.socket();
+    if (!s || s->m_Status == SRTS_CLOSED)
     {
         if (erh == ERH_RETURN)
             return NULL;
@@ -2567,6 +2607,8 @@ void srt::CUDTUnited::checkBrokenSockets()
 {
     ScopedLock cg(m_GlobControlLock);
 
+    m_SocketTable.collect();
+
 #if ENABLE_BONDING
     vector<SRTSOCKET> delgids;
 
@@ -2671,11 +2713,12 @@ void srt::CUDTUnited::checkBrokenSockets()
                 j->second->core().m_tsLingerExpiration = steady_clock::time_point();
                 j->second->core().m_bClosing           = true;
                 j->second->m_tsClosureTimeStamp        = steady_clock::now();
+                j->second->core().rescheduleTimers();
             }
         }
 
         // timeout 1 second to destroy a socket AND it has been removed from
-        // RcvUList
+        // the receiver queue timers
         const steady_clock::time_point now        = steady_clock::now();
         const steady_clock::duration   closed_ago = now - j->second->m_tsClosureTimeStamp;
         if (closed_ago > seconds_from(1))
@@ -2727,6 +2770,11 @@ void srt::CUDTUnited::removeSocket(const SRTSOCKET u)
     if (rn && rn->m_bOnList)
         return;
 
+    // The API calls that looked up the socket without locking may
+    // be still checking it. Skip it until they are all gone.
+    if (!m_SocketTable.release(s))
+        return;
+
 #if ENABLE_BONDING
     if (s->m_GroupOf)
     {
@@ -3155,9 +3203,9 @@ void srt::CUDTUnited::updateMux(CUDTSocket* s, const sockaddr_any& reqaddr, cons
 
         m.m_pTimer    = new CTimer;
         m.m_pSndQueue = new CSndQueue;
-        m.m_pSndQueue->init(m.m_pChannel, m.m_pTimer);
+        m.m_pSndQueue->init(m.m_pChannel, m.m_pTimer, m.m_mcfg);
         m.m_pRcvQueue = new CRcvQueue;
-        m.m_pRcvQueue->init(128, s->core().maxPayloadSize(), m.m_iIPversion, 1024, m.m_pChannel, m.m_pTimer);
+        m.m_pRcvQueue->init(m.m_mcfg.iRcvUnits, s->core().maxPayloadSize(), m.m_iIPversion, 1024, m.m_pChannel, m.m_pTimer, m.m_mcfg);
 
         // Rewrite the port here, as it might be only known upon return
         // from CChannel::open.
@@ -3346,15 +3394,20 @@ void* srt::CUDTUnited::garbageCollect(void* p)
         srt::sync::this_thread::sleep_for(milliseconds_from(1));
     }
 
+    {
+        ScopedLock glock(self->m_GlobControlLock);
+        self->m_SocketTable.clear();
+    }
+
     THREAD_EXIT();
     return NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-int srt::CUDT::startup()
+int srt::CUDT::startup(int tsbpd_workers)
 {
-    return uglobal().startup();
+    return uglobal().startup(tsbpd_workers);
 }
 
 int srt::CUDT::cleanup()
@@ -3840,6 +3893,11 @@ int srt::CUDT::sendmsg(SRTSOCKET u, const char* buf, int len, int ttl, bool inor
 }
 
 int srt::CUDT::sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& w_m)
+{
+    return sendmsg2(u, buf, len, (w_m), NULL, NULL);
+}
+
+int srt::CUDT::sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& w_m, srt_send_release_fn* release, void* opaque)
 {
     try
     {
@@ -3847,11 +3905,16 @@ int srt::CUDT::sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& w_m)
         if (u & SRTGROUP_MASK)
         {
             CUDTUnited::GroupKeeper k(uglobal(), u, CUDTUnited::ERH_THROW);
-            return k.group->send(buf, len, (w_m));
+
+            // The data are copied into the sender buffer of every member.
+            const int size = k.group->send(buf, len, (w_m));
+            if (release && size > 0)
+                release(opaque, buf, size);
+            return size;
         }
 #endif
 
-        return uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().sendmsg2(buf, len, (w_m));
+        return uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().sendmsg2(buf, len, (w_m), release, opaque);
     }
     catch (const CUDTException& e)
     {
@@ -3908,6 +3971,126 @@ int srt::CUDT::recvmsg2(SRTSOCKET u, char* buf, int len, SRT_MSGCTRL& w_m)
     }
 }
 
+int srt::CUDT::sendmsgv(SRTSOCKET u, const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL& w_m)
+{
+    try
+    {
+#if ENABLE_BONDING
+        if (u & SRTGROUP_MASK)
+        {
+            // The group sends the same contiguous buffer over all members.
+            const int len = CIoVecCursor::totalSize(iov, iovcnt);
+            if (len <= 0)
+                throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+            vector<char> buf(len);
+            CIoVecCursor(iov, iovcnt).gather(&buf[0], len);
+
+            CUDTUnited::GroupKeeper k(uglobal(), u, CUDTUnited::ERH_THROW);
+            return k.group->send(&buf[0], len, (w_m));
+        }
+#endif
+
+        return uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().sendmsgv(iov, iovcnt, (w_m));
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+    catch (bad_alloc&)
+    {
+        return APIError(MJ_SYSTEMRES, MN_MEMORY, 0);
+    }
+    catch (const std::exception& ee)
+    {
+        LOGC(aclog.Fatal, log << "sendmsgv: UNEXPECTED EXCEPTION: " << typeid(ee).name() << ": " << ee.what());
+        return APIError(MJ_UNKNOWN, MN_NONE, 0);
+    }
+}
+
+int srt::CUDT::recvmsgv(SRTSOCKET u, const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL& w_m)
+{
+    try
+    {
+#if ENABLE_BONDING
+        if (u & SRTGROUP_MASK)
+        {
+            // The group reads from the member buffers into a contiguous buffer.
+            const int len = CIoVecCursor::totalSize(iov, iovcnt);
+            if (len <= 0)
+                throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+            vector<char> buf(len);
+            CUDTUnited::GroupKeeper k(uglobal(), u, CUDTUnited::ERH_THROW);
+            const int res = k.group->recv(&buf[0], len, (w_m));
+            if (res > 0)
+                CIoVecCursor(iov, iovcnt).scatter(&buf[0], res);
+            return res;
+        }
+#endif
+
+        return uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().recvmsgv(iov, iovcnt, (w_m));
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+    catch (bad_alloc&)
+    {
+        return APIError(MJ_SYSTEMRES, MN_MEMORY, 0);
+    }
+    catch (const std::exception& ee)
+    {
+        LOGC(aclog.Fatal, log << "recvmsgv: UNEXPECTED EXCEPTION: " << typeid(ee).name() << ": " << ee.what());
+        return APIError(MJ_UNKNOWN, MN_NONE, 0);
+    }
+}
+
+int srt::CUDT::recvmsgBorrow(SRTSOCKET u, SRT_MSGLOAN& w_loan, SRT_MSGCTRL& w_m)
+{
+    try
+    {
+#if ENABLE_BONDING
+        // Group members keep their own receiver buffers and the group copies from them.
+        if (u & SRTGROUP_MASK)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+#endif
+
+        return uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().recvmsgBorrow((w_loan), (w_m));
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+    catch (bad_alloc&)
+    {
+        return APIError(MJ_SYSTEMRES, MN_MEMORY, 0);
+    }
+    catch (const std::exception& ee)
+    {
+        LOGC(aclog.Fatal, log << "recvmsg_borrow: UNEXPECTED EXCEPTION: " << typeid(ee).name() << ": " << ee.what());
+        return APIError(MJ_UNKNOWN, MN_NONE, 0);
+    }
+}
+
+int srt::CUDT::recvmsgRelease(SRTSOCKET u, SRT_MSGLOAN& w_loan)
+{
+    try
+    {
+        uglobal().locateSocket(u, CUDTUnited::ERH_THROW)->core().recvmsgRelease((w_loan));
+        return 0;
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+    catch (const std::exception& ee)
+    {
+        LOGC(aclog.Fatal, log << "recvmsg_release: UNEXPECTED EXCEPTION: " << typeid(ee).name() << ": " << ee.what());
+        return APIError(MJ_UNKNOWN, MN_NONE, 0);
+    }
+}
+
 int64_t srt::CUDT::sendfile(SRTSOCKET u, fstream& ifs, int64_t& offset, int64_t size, int block)
 {
     try
@@ -4217,6 +4400,23 @@ int srt::CUDT::epoll_release(const int eid)
     }
 }
 
+int srt::CUDT::epoll_notify_fd(const int eid)
+{
+    try
+    {
+        return uglobal().epoll_notify_fd(eid);
+    }
+    catch (const CUDTException& e)
+    {
+        return APIError(e);
+    }
+    catch (const std::exception& ee)
+    {
+        LOGC(aclog.Fatal, log << "epoll_notify_fd: UNEXPECTED EXCEPTION: " << typeid(ee).name() << ": " << ee.what());
+        return APIError(MJ_UNKNOWN, MN_NONE, 0);
+    }
+}
+
 srt::CUDTException& srt::CUDT::getlasterror()
 {
     return GetThreadLocalError();
@@ -64,6 +64,8 @@ modified by
 #include "epoll.h"
 #include "handshake.h"
 #include "core.h"
+#include "tsbpd_pool.h"
+#include "socket_table.h"
 #if ENABLE_BONDING
 #include "group.h"
 #endif
@@ -200,6 +202,7 @@ public:
     void setClosing()
     {
         core().m_bClosing = true;
+        core().rescheduleTimers();
     }
 
     /// This does the same as setClosed, plus sets the m_bBroken to true.
@@ -244,8 +247,10 @@ public:
     static std::string CONID(SRTSOCKET sock);
 
     /// initialize the UDT library.
+    /// @param tsbpd_workers number of threads of the shared TSBPD pool,
+    /// or 0 to have a TSBPD thread per receiving socket.
     /// @return 0 if success, otherwise -1 is returned.
-    int startup();
+    int startup(int tsbpd_workers = 0);
 
     /// release the UDT library.
     /// @return 0 if success, otherwise -1 is returned.
@@ -297,6 +302,8 @@ public:
 #endif
     int  close(const SRTSOCKET u);
     int  close(CUDTSocket* s);
+    /// Remove a socket already closed by the GC from all EIDs, when the application closes it.
+    int  unsubscribeClosed(const SRTSOCKET u);
     void getpeername(const SRTSOCKET u, sockaddr* name, int* namelen);
     void getsockname(const SRTSOCKET u, sockaddr* name, int* namelen);
     int  select(UDT::UDSET* readfds, UDT::UDSET* writefds, UDT::UDSET* exceptfds, const timeval* timeout);
@@ -322,6 +329,7 @@ public:
     int     epoll_uwait(const int eid, SRT_EPOLL_EVENT* fdsSet, int fdsSize, int64_t msTimeOut);
     int32_t epoll_set(const int eid, int32_t flags);
     int     epoll_release(const int eid);
+    int     epoll_notify_fd(const int eid);
 
 #if ENABLE_BONDING
     // [[using locked(m_GlobControlLock)]]
@@ -387,6 +395,10 @@ private:
     typedef std::map<SRTSOCKET, CUDTSocket*> sockets_t; // stores all the socket structures
     sockets_t                                m_Sockets;
 
+    // The same sockets as in m_Sockets and m_ClosedSockets, until they are
+    // deleted, for the lookup without locking m_GlobControlLock.
+    CSocketTable m_SocketTable;
+
 #if ENABLE_BONDING
     typedef std::map<SRTSOCKET, CUDTGroup*> groups_t;
     groups_t                                m_Groups;
@@ -478,6 +490,8 @@ private:
     sync::CThread m_GCThread;
     static void*  garbageCollect(void*);
 
+    CTsbPdPool m_TsbPdPool; // Used instead of TSBPD threads of sockets when running
+
     sockets_t m_ClosedSockets; // temporarily store closed sockets
 #if ENABLE_BONDING
     groups_t m_ClosedGroups;
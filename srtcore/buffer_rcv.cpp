@@ -91,6 +91,17 @@ namespace {
 
         return iFirstNonreadPos > iStartPos && iFirstNonreadPos <= iLastPos;
     }
+
+    template <class T>
+    void atomicAdd(sync::atomic<T>& value, T inc)
+    {
+        for (;;)
+        {
+            const T old = value.load();
+            if (value.compare_exchange(old, old + inc))
+                return;
+        }
+    }
 }
 
 
@@ -98,7 +109,7 @@ namespace {
  *   RcvBufferNew (circular buffer):
  *
  *   |<------------------- m_iSize ----------------------------->|
- *   |       |<----------- m_iMaxPosOff ------------>|           |
+ *   |       |<----------- maxPosOff() ------------->|           |
  *   |       |                                       |           |
  *   +---+---+---+---+---+---+---+---+---+---+---+---+---+   +---+
  *   | 0 | 0 | 1 | 1 | 1 | 0 | 1 | 1 | 1 | 1 | 0 | 1 | 0 |...| 0 | m_pUnit[]
@@ -109,10 +120,7 @@ namespace {
  *
  *   m_pUnit[i]->m_iFlag: 0:free, 1:good, 2:passack, 3:dropped
  *
- *   thread safety:
- *    m_iStartPos:   CUDT::m_RecvLock
- *    m_iLastAckPos: CUDT::m_AckLock
- *    m_iMaxPosOff:     none? (modified on add and ack
+ *   thread safety: see buffer_rcv.h
  */
 
 CRcvBuffer::CRcvBuffer(int initSeqNo, size_t size, CUnitQueue* unitqueue, bool bMessageAPI)
@@ -122,8 +130,9 @@ CRcvBuffer::CRcvBuffer(int initSeqNo, size_t size, CUnitQueue* unitqueue, bool b
     , m_iStartSeqNo(initSeqNo)
     , m_iStartPos(0)
     , m_iFirstNonreadPos(0)
-    , m_iMaxPosOff(0)
     , m_iNotch(0)
+    , m_llStart(makeStart(initSeqNo, 0))
+    , m_iEndSeqNo(initSeqNo)
     , m_numOutOfOrderPackets(0)
     , m_iFirstReadableOutOfOrder(-1)
     , m_bPeerRexmitFlag(true)
@@ -133,14 +142,16 @@ CRcvBuffer::CRcvBuffer(int initSeqNo, size_t size, CUnitQueue* unitqueue, bool b
     , m_uAvgPayloadSz(0)
 {
     SRT_ASSERT(size < size_t(std::numeric_limits<int>::max())); // All position pointers are integers
+    for (size_t i = 0; i < size; ++i)
+        m_entries[i].state.store(makeState(CSeqNo::incseq(initSeqNo, int(i)), EntryState_Empty));
 }
 
 CRcvBuffer::~CRcvBuffer()
 {
-    // Can be optimized by only iterating m_iMaxPosOff from m_iStartPos.
+    // Can be optimized by only iterating maxPosOff() from m_iStartPos.
     for (FixedArray<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
     {
-        if (!it->pUnit)
+        if (stateStatus(it->state.load()) != EntryState_Avail)
             continue;
         
         m_pUnitQueue->makeUnitFree(it->pUnit);
@@ -148,16 +159,30 @@ CRcvBuffer::~CRcvBuffer()
     }
 }
 
+void CRcvBuffer::setStartSeqNo(int seqno)
+{
+    m_iStartSeqNo = seqno;
+    m_iEndSeqNo   = seqno;
+    for (int i = 0; i < int(m_szSize); ++i)
+    {
+        const int         pos    = incPos(m_iStartPos, i);
+        const EntryStatus status = statusAt(pos) == EntryState_Avail ? EntryState_Avail : EntryState_Empty;
+        m_entries[pos].state.store(makeState(CSeqNo::incseq(seqno, i), status));
+    }
+    publishStart();
+}
+
 int CRcvBuffer::insert(CUnit* unit)
 {
     SRT_ASSERT(unit != NULL);
-    const int32_t seqno  = unit->m_Packet.getSeqNo();
-    const int     offset = CSeqNo::seqoff(m_iStartSeqNo, seqno);
+    const int32_t  seqno  = unit->m_Packet.getSeqNo();
+    const uint64_t start  = m_llStart.load();
+    const int      offset = CSeqNo::seqoff(startSeqNo(start), seqno);
 
     IF_RCVBUF_DEBUG(ScopedLog scoped_log);
     IF_RCVBUF_DEBUG(scoped_log.ss << "CRcvBuffer::insert: seqno " << seqno);
     IF_RCVBUF_DEBUG(scoped_log.ss << " msgno " << unit->m_Packet.getMsgSeq(m_bPeerRexmitFlag));
-    IF_RCVBUF_DEBUG(scoped_log.ss << " m_iStartSeqNo " << m_iStartSeqNo << " offset " << offset);
+    IF_RCVBUF_DEBUG(scoped_log.ss << " m_iStartSeqNo " << startSeqNo(start) << " offset " << offset);
 
     if (offset < 0)
     {
@@ -171,41 +196,68 @@ int CRcvBuffer::insert(CUnit* unit)
         return -3;
     }
 
-    // TODO: Don't do assert here. Process this situation somehow.
-    // If >= 2, then probably there is a long gap, and buffer needs to be reset.
-    SRT_ASSERT((m_iStartPos + offset) / m_szSize < 2);
-
-    const int pos = (m_iStartPos + offset) % m_szSize;
-    if (offset >= m_iMaxPosOff)
-        m_iMaxPosOff = offset + 1;
-
-    // Packet already exists
+    const int pos = incPos(startPos(start), offset);
     SRT_ASSERT(pos >= 0 && pos < int(m_szSize));
-    if (m_entries[pos].status != EntryState_Empty)
+
+    const uint64_t empty = makeState(seqno, EntryState_Empty);
+    const uint64_t state = m_entries[pos].state.load();
+    if (state != empty)
     {
-        IF_RCVBUF_DEBUG(scoped_log.ss << " returns -1");
-        return -1;
+        // Packet already exists, or the reader has passed the entry after the start was taken.
+        const int res = stateSeqNo(state) == seqno ? -1 : -2;
+        IF_RCVBUF_DEBUG(scoped_log.ss << " returns " << res);
+        return res;
     }
     SRT_ASSERT(m_entries[pos].pUnit == NULL);
 
     m_pUnitQueue->makeUnitTaken(unit);
-    m_entries[pos].pUnit  = unit;
-    m_entries[pos].status = EntryState_Avail;
-    countBytes(1, (int)unit->m_Packet.getLength());
+    m_entries[pos].pUnit = unit;
+    const int pktlen = (int)unit->m_Packet.getLength();
+    countBytes(1, pktlen);
+
+    // Publish the unit, unless the reader passed the entry in the meantime.
+    while (!m_entries[pos].state.compare_exchange(empty, makeState(seqno, EntryState_Avail)))
+    {
+        if (m_entries[pos].state.load() == empty)
+            continue; // Spurious failure
+
+        m_entries[pos].pUnit = NULL;
+        countBytes(-1, -pktlen);
+        m_pUnitQueue->makeUnitFree(unit);
+        IF_RCVBUF_DEBUG(scoped_log.ss << " returns -2 (passed)");
+        return -2;
+    }
+
+    for (;;)
+    {
+        const int32_t end = m_iEndSeqNo.load();
+        if (CSeqNo::seqcmp(end, seqno) > 0 || m_iEndSeqNo.compare_exchange(end, CSeqNo::incseq(seqno)))
+            break;
+    }
 
     // If packet "in order" flag is zero, it can be read out of order.
     // With TSBPD enabled packets are always assumed in order (the flag is ignored).
-    if (!m_tsbpd.isEnabled() && m_bMessageAPI && !unit->m_Packet.getMsgOrderFlag())
+    if (insertNeedsLock() && !unit->m_Packet.getMsgOrderFlag())
     {
         ++m_numOutOfOrderPackets;
         onInsertNotInOrderPacket(pos);
     }
 
-    updateNonreadPos();
     IF_RCVBUF_DEBUG(scoped_log.ss << " returns 0 (OK)");
     return 0;
 }
 
+bool CRcvBuffer::hasPacket(int32_t seqno) const
+{
+    const uint64_t start  = m_llStart.load();
+    const int      offset = CSeqNo::seqoff(startSeqNo(start), seqno);
+    if (offset < 0 || offset >= (int)capacity())
+        return false;
+
+    const uint64_t state = m_entries[incPos(startPos(start), offset)].state.load();
+    return stateSeqNo(state) == seqno && stateStatus(state) != EntryState_Empty;
+}
+
 int CRcvBuffer::dropUpTo(int32_t seqno)
 {
     IF_RCVBUF_DEBUG(ScopedLog scoped_log);
@@ -218,22 +270,18 @@ int CRcvBuffer::dropUpTo(int32_t seqno)
         return 0;
     }
 
-    m_iMaxPosOff -= len;
-    if (m_iMaxPosOff < 0)
-        m_iMaxPosOff = 0;
-
+    updateNonreadPos();
     const int iDropCnt = len;
     while (len > 0)
     {
-        dropUnitInPos(m_iStartPos);
-        m_entries[m_iStartPos].status = EntryState_Empty;
-        SRT_ASSERT(m_entries[m_iStartPos].pUnit == NULL && m_entries[m_iStartPos].status == EntryState_Empty);
-        m_iStartPos = incPos(m_iStartPos);
+        const int pos  = m_iStartPos;
+        CUnit*    unit = passStartEntry();
+        if (unit)
+            releaseDroppedUnit(unit, pos);
         --len;
     }
+    SRT_ASSERT(m_iStartSeqNo == seqno);
 
-    // Update positions
-    m_iStartSeqNo = seqno;
     // Move forward if there are "read/drop" entries.
     releaseNextFillerEntries();
 
@@ -254,8 +302,7 @@ int CRcvBuffer::dropAll()
     if (empty())
         return 0;
 
-    const int end_seqno = CSeqNo::incseq(m_iStartSeqNo, m_iMaxPosOff);
-    return dropUpTo(end_seqno);
+    return dropUpTo(m_iEndSeqNo.load());
 }
 
 int CRcvBuffer::dropMessage(int32_t seqnolo, int32_t seqnohi, int32_t msgno, DropActionIfExists actionOnExisting)
@@ -275,6 +322,7 @@ int CRcvBuffer::dropMessage(int32_t seqnolo, int32_t seqnohi, int32_t msgno, Dro
         return 0;
     }
 
+    updateNonreadPos();
     const bool bKeepExisting = (actionOnExisting == KEEP_EXISTING);
     int minDroppedOffset = -1;
     int iDropCnt = 0;
@@ -286,10 +334,11 @@ int CRcvBuffer::dropMessage(int32_t seqnolo, int32_t seqnohi, int32_t msgno, Dro
     for (int i = start_pos; i != end_pos; i = incPos(i))
     {
         // Check if the unit was already dropped earlier.
-        if (m_entries[i].status == EntryState_Drop)
+        const EntryStatus status = statusAt(i);
+        if (status == EntryState_Drop)
             continue;
 
-        if (m_entries[i].pUnit)
+        if (status == EntryState_Avail)
         {
             const PacketBoundary bnd = packetAt(i).getMsgBoundary();
 
@@ -319,7 +368,6 @@ int CRcvBuffer::dropMessage(int32_t seqnolo, int32_t seqnohi, int32_t msgno, Dro
 
         dropUnitInPos(i);
         ++iDropCnt;
-        m_entries[i].status = EntryState_Drop;
         if (minDroppedOffset == -1)
             minDroppedOffset = offPos(m_iStartPos, i);
     }
@@ -335,7 +383,7 @@ int CRcvBuffer::dropMessage(int32_t seqnolo, int32_t seqnohi, int32_t msgno, Dro
         for (int i = start_pos; i != stop_pos; i = decPos(i))
         {
             // Can't drop if message number is not known.
-            if (!m_entries[i].pUnit) // also dropped earlier.
+            if (statusAt(i) != EntryState_Avail) // also dropped earlier.
                 continue;
 
             const PacketBoundary bnd = packetAt(i).getMsgBoundary();
@@ -353,7 +401,6 @@ int CRcvBuffer::dropMessage(int32_t seqnolo, int32_t seqnohi, int32_t msgno, Dro
 
             ++iDropCnt;
             dropUnitInPos(i);
-            m_entries[i].status = EntryState_Drop;
             // As the search goes backward, i is always earlier than minDroppedOffset.
             minDroppedOffset = offPos(m_iStartPos, i);
 
@@ -382,8 +429,17 @@ int CRcvBuffer::dropMessage(int32_t seqnolo, int32_t seqnohi, int32_t msgno, Dro
     return iDropCnt;
 }
 
-int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
+int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl, std::vector<CUnit*>* w_borrowed)
 {
+    SRT_IOVEC iov;
+    iov.base = data;
+    iov.len  = len;
+    return readMessage(&iov, 1, msgctrl, w_borrowed);
+}
+
+int CRcvBuffer::readMessage(const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL* msgctrl, std::vector<CUnit*>* w_borrowed)
+{
+    updateNonreadPos();
     const bool canReadInOrder = hasReadableInorderPkts();
     if (!canReadInOrder && m_iFirstReadableOutOfOrder < 0)
     {
@@ -396,29 +452,35 @@ int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
     IF_RCVBUF_DEBUG(ScopedLog scoped_log);
     IF_RCVBUF_DEBUG(scoped_log.ss << "CRcvBuffer::readMessage. m_iStartSeqNo " << m_iStartSeqNo << " m_iStartPos " << m_iStartPos << " readPos " << readPos);
 
-    size_t remain = len;
-    char* dst = data;
+    CIoVecCursor dst(iov, iovcnt);
+    int    bytes_copied = 0;
     int    pkts_read = 0;
     int    bytes_extracted = 0; // The total number of bytes extracted from the buffer.
     const bool updateStartPos = (readPos == m_iStartPos); // Indicates if the m_iStartPos can be changed
     for (int i = readPos;; i = incPos(i))
     {
-        SRT_ASSERT(m_entries[i].pUnit);
-        if (!m_entries[i].pUnit)
+        SRT_ASSERT(statusAt(i) == EntryState_Avail);
+        if (statusAt(i) != EntryState_Avail)
         {
             LOGC(rbuflog.Error, log << "CRcvBuffer::readMessage(): null packet encountered.");
             break;
         }
 
-        const CPacket& packet  = packetAt(i);
+        CUnit* const   unit    = m_entries[i].pUnit;
+        const CPacket& packet  = unit->m_Packet;
         const size_t   pktsize = packet.getLength();
         const int32_t pktseqno = packet.getSeqNo();
 
-        // unitsize can be zero
-        const size_t unitsize = std::min(remain, pktsize);
-        memcpy(dst, packet.m_pcData, unitsize);
-        remain -= unitsize;
-        dst += unitsize;
+        if (w_borrowed)
+        {
+            // The unit is not freed below, but only when returned.
+            w_borrowed->push_back(unit);
+        }
+        else
+        {
+            // Copies less (or nothing) when the blocks are full.
+            bytes_copied += (int) dst.scatter(packet.m_pcData, pktsize);
+        }
 
         ++pkts_read;
         bytes_extracted += (int) pktsize;
@@ -441,19 +503,19 @@ int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
         if (msgctrl)
             msgctrl->pktseq = pktseqno;
 
-        releaseUnitInPos(i);
         if (updateStartPos)
         {
-            m_iStartPos = incPos(i);
-            --m_iMaxPosOff;
-            SRT_ASSERT(m_iMaxPosOff >= 0);
-            m_iStartSeqNo = CSeqNo::incseq(pktseqno);
+            SRT_ASSERT(i == m_iStartPos);
+            passStartEntry();
         }
         else
         {
             // If out of order, only mark it read.
-            m_entries[i].status = EntryState_Read;
+            m_entries[i].pUnit = NULL;
+            setStatus(i, EntryState_Read);
         }
+        if (!w_borrowed)
+            m_pUnitQueue->makeUnitFree(unit);
 
         if (pbLast)
         {
@@ -467,7 +529,7 @@ int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
 
     releaseNextFillerEntries();
 
-    if (!isInRange(m_iStartPos, m_iMaxPosOff, m_szSize, m_iFirstNonreadPos))
+    if (!isInRange(m_iStartPos, maxPosOff(), m_szSize, m_iFirstNonreadPos))
     {
         m_iFirstNonreadPos = m_iStartPos;
         //updateNonreadPos();
@@ -478,17 +540,23 @@ int CRcvBuffer::readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl)
         // incase readable inorder packets are all read out.
         updateFirstReadableOutOfOrder();
 
-    const int bytes_read = int(dst - data);
+    const int bytes_read = w_borrowed ? bytes_extracted : bytes_copied;
     if (bytes_read < bytes_extracted)
     {
         LOGC(rbuflog.Error, log << "readMessage: small dst buffer, copied only " << bytes_read << "/" << bytes_extracted << " bytes.");
     }
 
-    IF_RCVBUF_DEBUG(scoped_log.ss << " pldi64 " << *reinterpret_cast<uint64_t*>(data));
+    IF_RCVBUF_DEBUG(if (!w_borrowed) scoped_log.ss << " pldi64 " << *reinterpret_cast<uint64_t*>(iov[0].base));
 
     return bytes_read;
 }
 
+void CRcvBuffer::releaseBorrowed(const std::vector<CUnit*>& units)
+{
+    for (size_t i = 0; i < units.size(); ++i)
+        m_pUnitQueue->makeUnitFree(units[i]);
+}
+
 namespace {
     /// @brief Writes bytes to file stream.
     /// @param data pointer to data to write.
@@ -519,6 +587,7 @@ namespace {
 
 int CRcvBuffer::readBufferTo(int len, copy_to_dst_f funcCopyToDst, void* arg)
 {
+    updateNonreadPos();
     int p = m_iStartPos;
     const int end_pos = m_iFirstNonreadPos;
 
@@ -528,7 +597,7 @@ int CRcvBuffer::readBufferTo(int len, copy_to_dst_f funcCopyToDst, void* arg)
     int rs = len;
     while ((p != end_pos) && (rs > 0))
     {
-        if (!m_entries[p].pUnit)
+        if (statusAt(p) != EntryState_Avail)
         {
             p = incPos(p);
             LOGC(rbuflog.Error, log << "readBufferTo: IPE: NULL unit found in file transmission");
@@ -558,14 +627,9 @@ int CRcvBuffer::readBufferTo(int len, copy_to_dst_f funcCopyToDst, void* arg)
 
         if (rs >= remain_pktlen)
         {
-            releaseUnitInPos(p);
-            p = incPos(p);
+            m_pUnitQueue->makeUnitFree(passStartEntry());
+            p = m_iStartPos;
             m_iNotch = 0;
-
-            m_iStartPos = p;
-            --m_iMaxPosOff;
-            SRT_ASSERT(m_iMaxPosOff >= 0);
-            m_iStartSeqNo = CSeqNo::incseq(m_iStartSeqNo);
         }
         else
             m_iNotch += rs;
@@ -580,7 +644,7 @@ int CRcvBuffer::readBufferTo(int len, copy_to_dst_f funcCopyToDst, void* arg)
     // Update positions
     // Set nonread position to the starting position before updating,
     // because start position was increased, and preceding packets are invalid.
-    if (!isInRange(m_iStartPos, m_iMaxPosOff, m_szSize, m_iFirstNonreadPos))
+    if (!isInRange(m_iStartPos, maxPosOff(), m_szSize, m_iFirstNonreadPos))
     {
         m_iFirstNonreadPos = m_iStartPos;
     }
@@ -610,10 +674,7 @@ bool CRcvBuffer::hasAvailablePackets() const
 
 int CRcvBuffer::getRcvDataSize() const
 {
-    if (m_iFirstNonreadPos >= m_iStartPos)
-        return m_iFirstNonreadPos - m_iStartPos;
-
-    return int(m_szSize + m_iFirstNonreadPos - m_iStartPos);
+    return offPos(m_iStartPos, scanNonreadPos(false));
 }
 
 int CRcvBuffer::getTimespan_ms() const
@@ -621,30 +682,31 @@ int CRcvBuffer::getTimespan_ms() const
     if (!m_tsbpd.isEnabled())
         return 0;
 
-    if (m_iMaxPosOff == 0)
+    const int maxoff = maxPosOff();
+    if (maxoff == 0)
         return 0;
 
-    int lastpos = incPos(m_iStartPos, m_iMaxPosOff - 1);
+    int lastpos = incPos(m_iStartPos, maxoff - 1);
     // Normally the last position should always be non empty
     // if TSBPD is enabled (reading out of order is not allowed).
     // However if decryption of the last packet fails, it may be dropped
     // from the buffer (AES-GCM), and the position will be empty.
-    SRT_ASSERT(m_entries[lastpos].pUnit != NULL || m_entries[lastpos].status == EntryState_Drop);
-    while (m_entries[lastpos].pUnit == NULL && lastpos != m_iStartPos)
+    SRT_ASSERT(statusAt(lastpos) == EntryState_Avail || statusAt(lastpos) == EntryState_Drop);
+    while (statusAt(lastpos) != EntryState_Avail && lastpos != m_iStartPos)
     {
         lastpos = decPos(lastpos);
     }
     
-    if (m_entries[lastpos].pUnit == NULL)
+    if (statusAt(lastpos) != EntryState_Avail)
         return 0;
 
     int startpos = m_iStartPos;
-    while (m_entries[startpos].pUnit == NULL && startpos != lastpos)
+    while (statusAt(startpos) != EntryState_Avail && startpos != lastpos)
     {
         startpos = incPos(startpos);
     }
 
-    if (m_entries[startpos].pUnit == NULL)
+    if (statusAt(startpos) != EntryState_Avail)
         return 0;
 
     const steady_clock::time_point startstamp =
@@ -660,19 +722,17 @@ int CRcvBuffer::getTimespan_ms() const
 
 int CRcvBuffer::getRcvDataSize(int& bytes, int& timespan) const
 {
-    ScopedLock lck(m_BytesCountLock);
-    bytes = m_iBytesCount;
+    bytes = m_iBytesCount.load();
     timespan = getTimespan_ms();
-    return m_iPktsCount;
+    return m_iPktsCount.load();
 }
 
 CRcvBuffer::PacketInfo CRcvBuffer::getFirstValidPacketInfo() const
 {
-    const int end_pos = incPos(m_iStartPos, m_iMaxPosOff);
+    const int end_pos = incPos(m_iStartPos, maxPosOff());
     for (int i = m_iStartPos; i != end_pos; i = incPos(i))
     {
-        // TODO: Maybe check status?
-        if (!m_entries[i].pUnit)
+        if (statusAt(i) != EntryState_Avail)
             continue;
 
         const CPacket& packet = packetAt(i);
@@ -692,9 +752,7 @@ std::pair<int, int> CRcvBuffer::getAvailablePacketsRange() const
 
 size_t CRcvBuffer::countReadable() const
 {
-    if (m_iFirstNonreadPos >= m_iStartPos)
-        return m_iFirstNonreadPos - m_iStartPos;
-    return m_szSize + m_iFirstNonreadPos - m_iStartPos;
+    return offPos(m_iStartPos, scanNonreadPos(false));
 }
 
 bool CRcvBuffer::isRcvDataReady(time_point time_now) const
@@ -754,76 +812,109 @@ CRcvBuffer::PacketInfo CRcvBuffer::getFirstReadablePacketInfo(time_point time_no
 
 void CRcvBuffer::countBytes(int pkts, int bytes)
 {
-    ScopedLock lock(m_BytesCountLock);
-    m_iBytesCount += bytes; // added or removed bytes from rcv buffer
-    m_iPktsCount  += pkts;
-    if (bytes > 0)          // Assuming one pkt when adding bytes
+    atomicAdd(m_iBytesCount, bytes); // added or removed bytes from rcv buffer
+    atomicAdd(m_iPktsCount, pkts);
+    if (bytes > 0)          // Assuming one pkt when adding bytes (only by the inserting thread)
     {
-        if (!m_uAvgPayloadSz)
+        const unsigned avg = m_uAvgPayloadSz.load();
+        if (!avg)
             m_uAvgPayloadSz = bytes;
         else
-            m_uAvgPayloadSz = avg_iir<100>(m_uAvgPayloadSz, (unsigned) bytes);
+            m_uAvgPayloadSz = avg_iir<100>(avg, (unsigned) bytes);
     }
 }
 
-void CRcvBuffer::releaseUnitInPos(int pos)
+CUnit* CRcvBuffer::passStartEntry()
 {
-    CUnit* tmp = m_entries[pos].pUnit;
-    m_entries[pos] = Entry(); // pUnit = NULL; status = Empty
-    if (tmp != NULL)
-        m_pUnitQueue->makeUnitFree(tmp);
+    Entry&         entry = m_entries[m_iStartPos];
+    const uint64_t empty = makeState(m_iStartSeqNo, EntryState_Empty);
+    const uint64_t next  = makeState(CSeqNo::incseq(m_iStartSeqNo, int(m_szSize)), EntryState_Empty);
+
+    CUnit* unit = NULL;
+    for (;;)
+    {
+        const uint64_t state = entry.state.load();
+        SRT_ASSERT(stateSeqNo(state) == m_iStartSeqNo);
+        if (state == empty)
+        {
+            // The inserting thread may be just filling it, so only the state can be changed.
+            if (entry.state.compare_exchange(empty, next))
+                break;
+            continue;
+        }
+
+        // Available, read or dropped: the inserting thread doesn't touch it anymore.
+        if (stateStatus(state) == EntryState_Avail)
+            unit = entry.pUnit;
+        entry.pUnit = NULL;
+        entry.state.store(next);
+        break;
+    }
+
+    m_iStartPos   = incPos(m_iStartPos);
+    m_iStartSeqNo = CSeqNo::incseq(m_iStartSeqNo);
+    publishStart();
+    return unit;
 }
 
 bool CRcvBuffer::dropUnitInPos(int pos)
 {
-    if (!m_entries[pos].pUnit)
+    // Mark the entry first: an empty entry may be filled by the inserting thread
+    // until then, and the unit is released here if it was.
+    if (setStatus(pos, EntryState_Drop) != EntryState_Avail)
         return false;
+    CUnit* unit = m_entries[pos].pUnit;
+    m_entries[pos].pUnit = NULL;
+    releaseDroppedUnit(unit, pos);
+    return true;
+}
+
+void CRcvBuffer::releaseDroppedUnit(CUnit* unit, int pos)
+{
+    const CPacket& pkt = unit->m_Packet;
     if (m_tsbpd.isEnabled())
     {
-        updateTsbPdTimeBase(packetAt(pos).getMsgTimeStamp());
+        updateTsbPdTimeBase(pkt.getMsgTimeStamp());
     }
-    else if (m_bMessageAPI && !packetAt(pos).getMsgOrderFlag())
+    else if (m_bMessageAPI && !pkt.getMsgOrderFlag())
     {
         --m_numOutOfOrderPackets;
         if (pos == m_iFirstReadableOutOfOrder)
             m_iFirstReadableOutOfOrder = -1;
     }
-    releaseUnitInPos(pos);
-    return true;
+    m_pUnitQueue->makeUnitFree(unit);
 }
 
 void CRcvBuffer::releaseNextFillerEntries()
 {
-    int pos = m_iStartPos;
-    while (m_entries[pos].status == EntryState_Read || m_entries[pos].status == EntryState_Drop)
+    for (;;)
     {
-        m_iStartSeqNo = CSeqNo::incseq(m_iStartSeqNo);
-        releaseUnitInPos(pos);
-        pos = incPos(pos);
-        m_iStartPos = pos;
-        --m_iMaxPosOff;
-        if (m_iMaxPosOff < 0)
-            m_iMaxPosOff = 0;
+        const EntryStatus status = statusAt(m_iStartPos);
+        if (status != EntryState_Read && status != EntryState_Drop)
+            break;
+        passStartEntry();
     }
 }
 
 // TODO: Is this function complete? There are some comments left inside.
-void CRcvBuffer::updateNonreadPos()
+int CRcvBuffer::scanNonreadPos(bool first_only) const
 {
-    if (m_iMaxPosOff == 0)
-        return;
+    const int maxoff = maxPosOff();
+    if (maxoff == 0)
+        return m_iFirstNonreadPos;
 
-    const int end_pos = incPos(m_iStartPos, m_iMaxPosOff); // The empty position right after the last valid entry.
+    const int end_pos = incPos(m_iStartPos, maxoff); // The empty position right after the last valid entry.
 
-    int pos = m_iFirstNonreadPos;
-    while (m_entries[pos].pUnit && m_entries[pos].status == EntryState_Avail)
+    int nonread = m_iFirstNonreadPos;
+    int pos     = nonread;
+    while (statusAt(pos) == EntryState_Avail)
     {
         if (m_bMessageAPI && (packetAt(pos).getMsgBoundary() & PB_FIRST) == 0)
             break;
 
         for (int i = pos; i != end_pos; i = incPos(i))
         {
-            if (!m_entries[i].pUnit || m_entries[pos].status != EntryState_Avail)
+            if (statusAt(i) != EntryState_Avail)
             {
                 break;
             }
@@ -831,23 +922,29 @@ void CRcvBuffer::updateNonreadPos()
             // Check PB_LAST only in message mode.
             if (!m_bMessageAPI || packetAt(i).getMsgBoundary() & PB_LAST)
             {
-                m_iFirstNonreadPos = incPos(i);
+                nonread = incPos(i);
                 break;
             }
         }
 
-        if (pos == m_iFirstNonreadPos || !m_entries[m_iFirstNonreadPos].pUnit)
+        if (first_only || pos == nonread || statusAt(nonread) != EntryState_Avail)
             break;
 
-        pos = m_iFirstNonreadPos;
+        pos = nonread;
     }
+    return nonread;
+}
+
+void CRcvBuffer::updateNonreadPos()
+{
+    m_iFirstNonreadPos = scanNonreadPos(false);
 }
 
 int CRcvBuffer::findLastMessagePkt()
 {
     for (int i = m_iStartPos; i != m_iFirstNonreadPos; i = incPos(i))
     {
-        SRT_ASSERT(m_entries[i].pUnit);
+        SRT_ASSERT(statusAt(i) == EntryState_Avail);
 
         if (packetAt(i).getMsgBoundary() & PB_LAST)
         {
@@ -874,8 +971,8 @@ void CRcvBuffer::onInsertNotInOrderPacket(int insertPos)
 
     // Just a sanity check. This function is called when a new packet is added.
     // So the should be unacknowledged packets.
-    SRT_ASSERT(m_iMaxPosOff > 0);
-    SRT_ASSERT(m_entries[insertPos].pUnit);
+    SRT_ASSERT(maxPosOff() > 0);
+    SRT_ASSERT(statusAt(insertPos) == EntryState_Avail);
     const CPacket& pkt = packetAt(insertPos);
     const PacketBoundary boundary = pkt.getMsgBoundary();
 
@@ -904,14 +1001,15 @@ void CRcvBuffer::onInsertNotInOrderPacket(int insertPos)
 
 bool CRcvBuffer::checkFirstReadableOutOfOrder()
 {
-    if (m_numOutOfOrderPackets <= 0 || m_iFirstReadableOutOfOrder < 0 || m_iMaxPosOff == 0)
+    const int maxoff = maxPosOff();
+    if (m_numOutOfOrderPackets <= 0 || m_iFirstReadableOutOfOrder < 0 || maxoff == 0)
         return false;
 
-    const int endPos = incPos(m_iStartPos, m_iMaxPosOff);
+    const int endPos = incPos(m_iStartPos, maxoff);
     int msgno = -1;
     for (int pos = m_iFirstReadableOutOfOrder; pos != endPos; pos = incPos(pos))
     {
-        if (!m_entries[pos].pUnit)
+        if (statusAt(pos) != EntryState_Avail)
             return false;
 
         const CPacket& pkt = packetAt(pos);
@@ -935,7 +1033,8 @@ void CRcvBuffer::updateFirstReadableOutOfOrder()
     if (hasReadableInorderPkts() || m_numOutOfOrderPackets <= 0 || m_iFirstReadableOutOfOrder >= 0)
         return;
 
-    if (m_iMaxPosOff == 0)
+    const int maxoff = maxPosOff();
+    if (maxoff == 0)
         return;
 
     // TODO: unused variable outOfOrderPktsRemain?
@@ -943,7 +1042,7 @@ void CRcvBuffer::updateFirstReadableOutOfOrder()
 
     // Search further packets to the right.
     // First check if there are packets to the right.
-    const int lastPos = (m_iStartPos + m_iMaxPosOff - 1) % m_szSize;
+    const int lastPos = (m_iStartPos + maxoff - 1) % m_szSize;
 
     int posFirst = -1;
     int posLast = -1;
@@ -951,7 +1050,7 @@ void CRcvBuffer::updateFirstReadableOutOfOrder()
 
     for (int pos = m_iStartPos; outOfOrderPktsRemain; pos = incPos(pos))
     {
-        if (!m_entries[pos].pUnit)
+        if (statusAt(pos) != EntryState_Avail)
         {
             posFirst = posLast = msgNo = -1;
             continue;
@@ -997,7 +1096,7 @@ int CRcvBuffer::scanNotInOrderMessageRight(const int startPos, int msgNo) const
 {
     // Search further packets to the right.
     // First check if there are packets to the right.
-    const int lastPos = (m_iStartPos + m_iMaxPosOff - 1) % m_szSize;
+    const int lastPos = (m_iStartPos + maxPosOff() - 1) % m_szSize;
     if (startPos == lastPos)
         return -1;
 
@@ -1005,7 +1104,7 @@ int CRcvBuffer::scanNotInOrderMessageRight(const int startPos, int msgNo) const
     do
     {
         pos = incPos(pos);
-        if (!m_entries[pos].pUnit)
+        if (statusAt(pos) != EntryState_Avail)
             break;
 
         const CPacket& pkt = packetAt(pos);
@@ -1036,7 +1135,7 @@ int CRcvBuffer::scanNotInOrderMessageLeft(const int startPos, int msgNo) const
     {
         pos = decPos(pos);
 
-        if (!m_entries[pos].pUnit)
+        if (statusAt(pos) != EntryState_Avail)
             return -1;
 
         const CPacket& pkt = packetAt(pos);
@@ -1095,19 +1194,19 @@ string CRcvBuffer::strFullnessState(int iFirstUnackSeqNo, const time_point& tsNo
     stringstream ss;
 
     ss << "iFirstUnackSeqNo=" << iFirstUnackSeqNo << " m_iStartSeqNo=" << m_iStartSeqNo
-       << " m_iStartPos=" << m_iStartPos << " m_iMaxPosOff=" << m_iMaxPosOff << ". ";
+       << " m_iStartPos=" << m_iStartPos << " maxPosOff=" << maxPosOff() << ". ";
 
     ss << "Space avail " << getAvailSize(iFirstUnackSeqNo) << "/" << m_szSize << " pkts. ";
 
-    if (m_tsbpd.isEnabled() && m_iMaxPosOff > 0)
+    if (m_tsbpd.isEnabled() && maxPosOff() > 0)
     {
         const PacketInfo nextValidPkt = getFirstValidPacketInfo();
         ss << "(TSBPD ready in ";
         if (!is_zero(nextValidPkt.tsbpd_time))
         {
             ss << count_milliseconds(nextValidPkt.tsbpd_time - tsNow) << "ms";
-            const int iLastPos = incPos(m_iStartPos, m_iMaxPosOff - 1);
-            if (m_entries[iLastPos].pUnit)
+            const int iLastPos = incPos(m_iStartPos, maxPosOff() - 1);
+            if (statusAt(iLastPos) == EntryState_Avail)
             {
                 ss << ", timespan ";
                 const uint32_t usPktTimestamp = packetAt(iLastPos).getMsgTimeStamp();
@@ -23,23 +23,32 @@ namespace srt
  *   Circular receiver buffer.
  *
  *   |<------------------- m_szSize ---------------------------->|
- *   |       |<------------ m_iMaxPosOff ----------->|           |
+ *   |       |<------------ maxPosOff() ------------>|           |
  *   |       |                                       |           |
  *   +---+---+---+---+---+---+---+---+---+---+---+---+---+   +---+
- *   | 0 | 0 | 1 | 1 | 1 | 0 | 1 | 1 | 1 | 1 | 0 | 1 | 0 |...| 0 | m_pUnit[]
+ *   | 0 | 0 | 1 | 1 | 1 | 0 | 1 | 1 | 1 | 1 | 0 | 1 | 0 |...| 0 | m_entries[]
  *   +---+---+---+---+---+---+---+---+---+---+---+---+---+   +---+
  *             |                                   |
- *             |                                   \__last pkt received
+ *             |                                   \__last pkt received (m_iEndSeqNo - 1)
  *             |
  *             \___ m_iStartPos: first message to read
  *
- *   m_pUnit[i]->status_: 0: free, 1: good, 2: read, 3: dropped (can be combined with read?)
+ *   m_entries[i].state: the sequence number expected in the entry and its status
+ *   (0: empty, 1: good, 2: read, 3: dropped).
  *
  *   thread safety:
- *    start_pos_:      CUDT::m_RecvLock
- *    first_unack_pos_:    CUDT::m_AckLock
- *    max_pos_inc_:        none? (modified on add and ack
- *    first_nonread_pos_:
+ *    insert() is called by the receiving thread without locking, unless
+ *    insertNeedsLock() (reading out of order requires the lookup of the other packets).
+ *    All the other functions that modify the buffer must be called with CUDT::m_RcvBufferLock.
+ *    The inserting thread only turns an empty entry into an available one, and only
+ *    if it still expects the same sequence number. The readers release an entry
+ *    and move the start by tagging it with the next sequence number expected there,
+ *    so an insertion racing with the reader passing its entry fails like a belated packet.
+ *    Dropping an entry changes its status with compare-exchange as well, and releases
+ *    the unit if the inserting thread has won.
+ *    m_iStartPos, m_iFirstNonreadPos: modified by the readers only.
+ *    m_llStart:    start published for the inserting thread.
+ *    m_iEndSeqNo:  extended by the inserting thread.
  */
 
 class CRcvBuffer
@@ -61,9 +70,19 @@ public:
     ///
     /// @return  0 on success, -1 if packet is already in buffer, -2 if packet is before m_iStartSeqNo.
     /// -3 if a packet is offset is ahead the buffer capacity.
+    /// @note Doesn't need locking unless insertNeedsLock(), see the thread safety notes above.
     // TODO: Previously '-2' also meant 'already acknowledged'. Check usage of this value.
     int insert(CUnit* unit);
 
+    /// Tells if the packet must be inserted with the buffer locked.
+    /// Only the packets that can be read out of order need it.
+    bool insertNeedsLock() const { return !m_tsbpd.isEnabled() && m_bMessageAPI; }
+
+    /// Check if the entry of the packet is already taken (received, read or dropped).
+    /// Like insert(), can be called by the inserting thread without locking.
+    /// @return false also if the packet doesn't fit the buffer.
+    bool hasPacket(int32_t seqno) const;
+
     /// Drop packets in the receiver buffer from the current position up to the seqno (excluding seqno).
     /// @param [in] seqno drop units up to this sequence number
     /// @return  number of dropped packets.
@@ -103,11 +122,31 @@ public:
     /// @param [in,out] data buffer to write the message into.
     /// @param [in] len size of the buffer.
     /// @param [in,out] message control data
+    /// @param [out] w_borrowed if not NULL, the units of the message are appended
+    ///              to it instead of copying them into @a data (@a data and @a len
+    ///              are then ignored). The units stay taken until returned
+    ///              with releaseBorrowed().
     ///
     /// @return actual number of bytes extracted from the buffer.
     ///          0 if nothing to read.
     ///         -1 on failure.
-    int readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl = NULL);
+    int readMessage(char* data, size_t len, SRT_MSGCTRL* msgctrl = NULL, std::vector<CUnit*>* w_borrowed = NULL);
+
+    /// Read the whole message, scattering it over several blocks.
+    ///
+    /// @param [in] iov blocks to write the message into, in order.
+    /// @param [in] iovcnt number of blocks.
+    /// @param [in,out] message control data
+    /// @param [out] w_borrowed as in the function above.
+    ///
+    /// @return actual number of bytes extracted from the buffer.
+    ///          0 if nothing to read.
+    ///         -1 on failure.
+    int readMessage(const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL* msgctrl = NULL, std::vector<CUnit*>* w_borrowed = NULL);
+
+    /// Return the units borrowed by readMessage() to the unit queue.
+    /// Does not access the buffer itself, so it doesn't need to be locked.
+    void releaseBorrowed(const std::vector<CUnit*>& units);
 
     /// Read acknowledged data into a user buffer.
     /// @param [in, out] dst pointer to the target user buffer.
@@ -123,11 +162,11 @@ public:
 
 public:
     /// Get the starting position of the buffer as a packet sequence number.
-    int getStartSeqNo() const { return m_iStartSeqNo; }
+    int getStartSeqNo() const { return startSeqNo(m_llStart.load()); }
 
     /// Sets the start seqno of the buffer.
     /// Must be used with caution and only when the buffer is empty.
-    void setStartSeqNo(int seqno) { m_iStartSeqNo = seqno; }
+    void setStartSeqNo(int seqno);
 
     /// Given the sequence number of the first unacknowledged packet
     /// tells the size of the buffer available for packets.
@@ -197,7 +236,7 @@ public:
 
     bool empty() const
     {
-        return (m_iMaxPosOff == 0);
+        return (maxPosOff() == 0);
     }
 
     /// Return buffer capacity.
@@ -224,7 +263,7 @@ public:
     int  getRcvAvgDataSize(int& bytes, int& timespan);
     void updRcvAvgDataSize(const time_point& now);
 
-    unsigned getRcvAvgPayloadSize() const { return m_uAvgPayloadSz; }
+    unsigned getRcvAvgPayloadSize() const { return m_uAvgPayloadSz.load(); }
 
     void getInternalTimeBase(time_point& w_timebase, bool& w_wrp, duration& w_udrift)
     {
@@ -248,25 +287,48 @@ private:
         return off2 - off1;
     }
 
-    // NOTE: Assumes that pUnit != NULL
+    // NOTE: Assumes that the entry is available (pUnit != NULL)
     CPacket& packetAt(int pos) { return m_entries[pos].pUnit->m_Packet; }
     const CPacket& packetAt(int pos) const { return m_entries[pos].pUnit->m_Packet; }
 
+    /// The offset of the end of the received packets from the start (0 if empty).
+    int maxPosOff() const
+    {
+        const int off = CSeqNo::seqoff(m_iStartSeqNo, m_iEndSeqNo.load());
+        return off > 0 ? off : 0;
+    }
+
 private:
     void countBytes(int pkts, int bytes);
+
+    /// Find the position following the packets available for reading in order.
+    /// @param first_only stop after the first message.
+    int  scanNonreadPos(bool first_only) const;
     void updateNonreadPos();
-    void releaseUnitInPos(int pos);
 
-    /// @brief Drop a unit from the buffer.
+    /// Release the entry at the start position and move the start forward.
+    /// @return the unit of the entry if it was available (to be freed by the caller), otherwise NULL.
+    CUnit* passStartEntry();
+
+    /// Publish the start position for the inserting thread.
+    void publishStart() { m_llStart.store(makeStart(m_iStartSeqNo, m_iStartPos)); }
+
+    /// @brief Mark the entry as dropped and release its unit, if any.
     /// @param pos position in the m_entries of the unit to drop.
     /// @return false if nothing to drop, true if the unit was dropped successfully.
     bool dropUnitInPos(int pos);
 
+    /// Update the state after dropping the unit taken from @a pos, and free it.
+    void releaseDroppedUnit(CUnit* unit, int pos);
+
     /// Release entries following the current buffer position if they were already
     /// read out of order (EntryState_Read) or dropped (EntryState_Drop).
     void releaseNextFillerEntries();
 
-    bool hasReadableInorderPkts() const { return (m_iFirstNonreadPos != m_iStartPos); }
+    bool hasReadableInorderPkts() const
+    {
+        return m_iFirstNonreadPos != m_iStartPos || scanNonreadPos(true) != m_iStartPos;
+    }
 
     /// Find position of the last packet of the message.
     int findLastMessagePkt();
@@ -320,13 +382,39 @@ private:
     {
         Entry()
             : pUnit(NULL)
-            , status(EntryState_Empty)
         {}
 
-        CUnit*      pUnit;
-        EntryStatus status;
+        CUnit*                 pUnit;
+        sync::atomic<uint64_t> state; // Expected sequence number (high 32 bits) and EntryStatus
     };
 
+    static uint64_t makeState(int32_t seqno, EntryStatus status)
+    {
+        return (uint64_t(uint32_t(seqno)) << 32) | uint32_t(status);
+    }
+    static int32_t     stateSeqNo(uint64_t state) { return int32_t(uint32_t(state >> 32)); }
+    static EntryStatus stateStatus(uint64_t state) { return EntryStatus(uint32_t(state)); }
+
+    EntryStatus statusAt(int pos) const { return stateStatus(m_entries[pos].state.load()); }
+
+    /// Change the status keeping the expected sequence number.
+    /// The inserting thread may turn an empty entry into an available one at the same time,
+    /// hence the compare-exchange.
+    /// @return the status replaced.
+    EntryStatus setStatus(int pos, EntryStatus status)
+    {
+        for (;;)
+        {
+            const uint64_t state = m_entries[pos].state.load();
+            if (m_entries[pos].state.compare_exchange(state, makeState(stateSeqNo(state), status)))
+                return stateStatus(state);
+        }
+    }
+
+    static uint64_t makeStart(int32_t seqno, int pos) { return (uint64_t(uint32_t(seqno)) << 32) | uint32_t(pos); }
+    static int32_t  startSeqNo(uint64_t start) { return int32_t(uint32_t(start >> 32)); }
+    static int      startPos(uint64_t start) { return int(uint32_t(start)); }
+
     //static Entry emptyEntry() { return Entry { NULL, EntryState_Empty }; }
 
     FixedArray<Entry> m_entries;
@@ -336,10 +424,12 @@ private:
 
     int m_iStartSeqNo;
     int m_iStartPos;        // the head position for I/O (inclusive)
-    int m_iFirstNonreadPos; // First position that can't be read (<= m_iLastAckPos)
-    int m_iMaxPosOff;       // the furthest data position
+    int m_iFirstNonreadPos; // First position that can't be read (<= m_iLastAckPos), updated when reading
     int m_iNotch;           // the starting read point of the first unit
 
+    sync::atomic<uint64_t> m_llStart;   // m_iStartSeqNo and m_iStartPos, see makeStart()
+    sync::atomic<int32_t>  m_iEndSeqNo; // the sequence number following the furthest packet inserted
+
     size_t m_numOutOfOrderPackets;  // The number of stored packets with "inorder" flag set to false
     int m_iFirstReadableOutOfOrder; // In case of out ouf order packet, points to a position of the first such packet to
                                     // read
@@ -380,11 +470,10 @@ private:
 private: // Statistics
     AvgBufSize m_mavg;
 
-    // TODO: m_BytesCountLock is probably not needed as the buffer has to be protected from simultaneous access.
-    mutable sync::Mutex m_BytesCountLock;   // used to protect counters operations
-    int         m_iBytesCount;      // Number of payload bytes in the buffer
-    int         m_iPktsCount;       // Number of payload bytes in the buffer
-    unsigned    m_uAvgPayloadSz;    // Average payload size for dropped bytes estimation
+    // Modified by the inserting thread and by the readers.
+    sync::atomic<int>      m_iBytesCount;   // Number of payload bytes in the buffer
+    sync::atomic<int>      m_iPktsCount;    // Number of payload bytes in the buffer
+    sync::atomic<unsigned> m_uAvgPayloadSz; // Average payload size for dropped bytes estimation (by the inserting thread)
 };
 
 } // namespace srt
@@ -66,10 +66,9 @@ using namespace sync;
 
 CSndBuffer::CSndBuffer(int ip_family, int size, int maxpld, int authtag)
     : m_BufLock()
-    , m_pBlock(NULL)
-    , m_pFirstBlock(NULL)
-    , m_pCurrBlock(NULL)
-    , m_pLastBlock(NULL)
+    , m_iFirstBlock(0)
+    , m_iCurrBlock(0)
+    , m_iLastBlock(0)
     , m_pBuffer(NULL)
     , m_iNextMsgNo(1)
     , m_iSize(size)
@@ -85,40 +84,32 @@ CSndBuffer::CSndBuffer(int ip_family, int size, int maxpld, int authtag)
     m_pBuffer->m_iSize  = m_iSize;
     m_pBuffer->m_pNext  = NULL;
 
-    // circular linked list for out bound packets
-    m_pBlock  = new Block;
-    Block* pb = m_pBlock;
-    char* pc  = m_pBuffer->m_pcData;
-
+    // ring of blocks for out bound packets
+    m_Blocks.resize(m_iSize);
+    char* pc = m_pBuffer->m_pcData;
     for (int i = 0; i < m_iSize; ++i)
     {
-        pb->m_iMsgNoBitset = 0;
-        pb->m_pcData       = pc;
-        pc                += m_iBlockLen;
-
-        if (i < m_iSize - 1)
-        {
-            pb->m_pNext        = new Block;
-            pb                 = pb->m_pNext;
-        }
+        Block& b         = m_Blocks[i];
+        b.m_iMsgNoBitset = 0;
+        b.m_pcData       = pc;
+        b.m_pcStorage    = pc;
+        b.m_UserBuffer.m_pfnRelease = NULL;
+        pc              += m_iBlockLen;
     }
-    pb->m_pNext = m_pBlock;
-
-    m_pFirstBlock = m_pCurrBlock = m_pLastBlock = m_pBlock;
 
     setupMutex(m_BufLock, "Buf");
 }
 
 CSndBuffer::~CSndBuffer()
 {
-    Block* pb = m_pBlock->m_pNext;
-    while (pb != m_pBlock)
+    // The user buffers still referred to are returned to the application.
+    vector<UserBuffer> released;
+    for (int i = m_iFirstBlock; i != m_iLastBlock; i = nextBlock(i))
     {
-        Block* temp = pb;
-        pb          = pb->m_pNext;
-        delete temp;
+        if (m_Blocks[i].m_UserBuffer.m_pfnRelease)
+            released.push_back(m_Blocks[i].m_UserBuffer);
     }
-    delete m_pBlock;
+    releaseUserBuffers(released);
 
     while (m_pBuffer != NULL)
     {
@@ -131,8 +122,54 @@ CSndBuffer::~CSndBuffer()
     releaseMutex(m_BufLock);
 }
 
-void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
+void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl, srt_send_release_fn* release, void* opaque)
+{
+    SRT_IOVEC iov;
+    iov.base = const_cast<char*>(data);
+    iov.len  = len;
+    addBuffer(&iov, 1, len, (w_mctrl), release, opaque);
+}
+
+void CSndBuffer::addBuffer(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl)
+{
+    addBuffer(iov, iovcnt, len, (w_mctrl), NULL, NULL);
+}
+
+void CSndBuffer::addBuffer(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl,
+                           srt_send_release_fn* release, void* opaque)
+{
+    // Retrieve current time before locking the mutex to be closer to packet submission event.
+    const steady_clock::time_point tnow = steady_clock::now();
+
+    Reservation res;
+    ScopedLock  bufferguard(m_BufLock);
+    insertBlocks(iov, iovcnt, len, (w_mctrl), release, opaque, tnow, (res));
+    publishBlocks(res);
+}
+
+void CSndBuffer::reserveBuffer(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl, Reservation& w_res)
 {
+    const steady_clock::time_point tnow = steady_clock::now();
+
+    ScopedLock bufferguard(m_BufLock);
+    insertBlocks(iov, iovcnt, len, (w_mctrl), NULL, NULL, tnow, (w_res));
+}
+
+void CSndBuffer::commitBuffer(const Reservation& res)
+{
+    ScopedLock bufferguard(m_BufLock);
+    publishBlocks(res);
+}
+
+void CSndBuffer::insertBlocks(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl,
+                              srt_send_release_fn* release, void* opaque, const time_point& tnow,
+                              Reservation& w_res)
+{
+    // Referring to the user data requires contiguous packets.
+    SRT_ASSERT(!release || iovcnt == 1);
+    const char*  data = static_cast<const char*>(iov[0].base);
+    CIoVecCursor source(iov, iovcnt);
+
     int32_t& w_msgno     = w_mctrl.msgno;
     int32_t& w_seqno     = w_mctrl.pktseq;
     int64_t& w_srctime   = w_mctrl.srctime;
@@ -142,10 +179,6 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
 
     HLOGC(bslog.Debug,
           log << "addBuffer: needs=" << iNumBlocks << " buffers for " << len << " bytes. Taken=" << m_iCount << "/" << m_iSize);
-    // Retrieve current time before locking the mutex to be closer to packet submission event.
-    const steady_clock::time_point tnow = steady_clock::now();
-
-    ScopedLock bufferguard(m_BufLock);
     // Dynamically increase sender buffer if there is not enough room.
     while (iNumBlocks + m_iCount >= m_iSize)
     {
@@ -169,7 +202,8 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
     // If there's more than one packet, this function must increase it by itself
     // and then return the accordingly modified sequence number in the reference.
 
-    Block* s = m_pLastBlock;
+    int s    = m_iLastBlock;
+    int last = s;
 
     if (w_msgno == SRT_MSGNO_NONE) // DEFAULT-UNCHANGED msgno supplied
     {
@@ -188,20 +222,31 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
         if (pktlen > iPktLen)
             pktlen = iPktLen;
 
-        HLOGC(bslog.Debug,
-              log << "addBuffer: %" << w_seqno << " #" << w_msgno << " offset=" << (i * iPktLen)
-                  << " size=" << pktlen << " TO BUFFER:" << (void*)s->m_pcData);
-        memcpy((s->m_pcData), data + i * iPktLen, pktlen);
-        s->m_iLength = pktlen;
+        Block& b = m_Blocks[s];
+        if (release)
+        {
+            // Refer to the user buffer. It's only read from, as it's not encrypted in place.
+            b.m_pcData = const_cast<char*>(data + i * iPktLen);
+        }
+        else
+        {
+            HLOGC(bslog.Debug,
+                  log << "addBuffer: %" << w_seqno << " #" << w_msgno << " offset=" << (i * iPktLen)
+                      << " size=" << pktlen << " TO BUFFER:" << (void*)b.m_pcStorage);
+            b.m_pcData = b.m_pcStorage;
+            source.gather((b.m_pcData), pktlen);
+        }
+        b.m_iLength = pktlen;
+        b.m_UserBuffer.m_pfnRelease = NULL;
 
-        s->m_iSeqNo = w_seqno;
-        w_seqno     = CSeqNo::incseq(w_seqno);
+        b.m_iSeqNo = w_seqno;
+        w_seqno    = CSeqNo::incseq(w_seqno);
 
-        s->m_iMsgNoBitset = m_iNextMsgNo | inorder;
+        b.m_iMsgNoBitset = m_iNextMsgNo | inorder;
         if (i == 0)
-            s->m_iMsgNoBitset |= PacketBoundaryBits(PB_FIRST);
+            b.m_iMsgNoBitset |= PacketBoundaryBits(PB_FIRST);
         if (i == iNumBlocks - 1)
-            s->m_iMsgNoBitset |= PacketBoundaryBits(PB_LAST);
+            b.m_iMsgNoBitset |= PacketBoundaryBits(PB_LAST);
         // NOTE: if i is neither 0 nor size-1, it resuls with PB_SUBSEQUENT.
         //       if i == 0 == size-1, it results with PB_SOLO.
         // Packets assigned to one message can be:
@@ -209,21 +254,28 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
         // [PB_FIRST] [PB_LAST] - 2 packets per message
         // [PB_SOLO] - 1 packet per message
 
-        s->m_iTTL = ttl;
-        s->m_tsRexmitTime = time_point();
-        s->m_tsOriginTime = m_tsLastOriginTime;
-        
-        // Should never happen, as the call to increase() should ensure enough buffers.
-        SRT_ASSERT(s->m_pNext);
-        s = s->m_pNext;
+        b.m_iTTL = ttl;
+        b.m_tsRexmitTime = time_point();
+        b.m_tsOriginTime = m_tsLastOriginTime;
+
+        last = s;
+        s    = nextBlock(s);
     }
-    m_pLastBlock = s;
 
-    m_iCount += iNumBlocks;
-    m_iBytesCount += len;
+    if (release)
+    {
+        // The last block of the message is removed last, either when acknowledged or dropped.
+        UserBuffer& ub  = m_Blocks[last].m_UserBuffer;
+        ub.m_pfnRelease = release;
+        ub.m_pOpaque    = opaque;
+        ub.m_pcData     = data;
+        ub.m_iLength    = len;
+    }
 
-    m_rateEstimator.updateInputRate(m_tsLastOriginTime, iNumBlocks, len);
-    updAvgBufSize(m_tsLastOriginTime);
+    w_res.iFirst = m_iLastBlock;
+    w_res.iEnd   = s;
+    w_res.iCount = iNumBlocks;
+    w_res.iBytes = len;
 
     // MSGNO_SEQ::mask has a form: 00000011111111...
     // At least it's known that it's from some index inside til the end (to bit 0).
@@ -236,6 +288,64 @@ void CSndBuffer::addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl)
     m_iNextMsgNo = nextmsgno;
 }
 
+void CSndBuffer::publishBlocks(const Reservation& res)
+{
+    // The blocks following m_iLastBlock are moved only by the insertion,
+    // so the reading and the acknowledgement may run before this.
+    SRT_ASSERT(res.iFirst == m_iLastBlock);
+    m_iLastBlock = res.iEnd;
+
+    m_iCount += res.iCount;
+    m_iBytesCount += res.iBytes;
+
+    m_rateEstimator.updateInputRate(m_tsLastOriginTime, res.iCount, res.iBytes);
+    updAvgBufSize(m_tsLastOriginTime);
+}
+
+void CSndBuffer::encryptBuffer(const Reservation& res, CCryptoControl& crypto)
+{
+    const int first = res.iFirst;
+    const int count = res.iCount;
+    const int kflgs = crypto.getSndCryptoFlags();
+    if (kflgs == -1 || kflgs == EK_NOENC)
+        return; // Left to readData(), which knows what to do then.
+
+    const int32_t kkbits = MSGNO_ENCKEYSPEC::wrap(kflgs);
+    const int     MAX_CHUNK = 16;
+    CPacket       packets[MAX_CHUNK];
+    CPacket*      ptrs[MAX_CHUNK];
+
+    int idx = first;
+    for (int done = 0; done < count;)
+    {
+        const int n = std::min(count - done, MAX_CHUNK);
+        for (int i = 0, b = idx; i < n; ++i, b = nextBlock(b))
+        {
+            const Block& blk = m_Blocks[b];
+            CPacket&     pkt = packets[i];
+            pkt.m_pcData     = blk.m_pcData;
+            pkt.setLength(blk.m_iLength, m_iBlockLen);
+            pkt.m_iSeqNo = blk.m_iSeqNo;
+            // The key flags must be set for the encryption.
+            pkt.m_iMsgNo = blk.m_iMsgNoBitset | kkbits;
+            ptrs[i]      = &pkt;
+        }
+
+        if (crypto.encrypt(ptrs, n) != ENCS_CLEAR)
+        {
+            // The CTR batch fails only before anything is encrypted, so the remaining
+            // blocks are still encrypted when sent, just as without encrypting ahead.
+            LOGC(bslog.Warn, log << CONID() << "CSndBuffer: encrypting in advance failed for %" << m_Blocks[idx].m_iSeqNo
+                                 << ", will encrypt when sending");
+            return;
+        }
+
+        for (int i = 0; i < n; ++i, idx = nextBlock(idx))
+            m_Blocks[idx].m_iMsgNoBitset |= kkbits;
+        done += n;
+    }
+}
+
 int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
 {
     const int iPktLen    = getMaxPacketLen();
@@ -246,19 +356,26 @@ int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
               << " buffers for " << len << " bytes");
 
     // dynamically increase sender buffer
-    while (iNumBlocks + m_iCount >= m_iSize)
     {
-        HLOGC(bslog.Debug,
-              log << "addBufferFromFile: ... still lacking " << (iNumBlocks + m_iCount - m_iSize) << " buffers...");
-        increase();
+        // The ring is rearranged, while the sending thread may be reading from it.
+        ScopedLock bufferguard(m_BufLock);
+        while (iNumBlocks + m_iCount >= m_iSize)
+        {
+            HLOGC(bslog.Debug,
+                  log << "addBufferFromFile: ... still lacking " << (iNumBlocks + m_iCount - m_iSize) << " buffers...");
+            increase();
+        }
     }
 
     HLOGC(bslog.Debug,
           log << CONID() << "addBufferFromFile: adding " << iPktLen << " packets (" << len
               << " bytes) to send, msgno=" << m_iNextMsgNo);
 
-    Block* s     = m_pLastBlock;
-    int    total = 0;
+    // The blocks past the last one are not accessed by other threads,
+    // so they can be filled without locking.
+    int s       = m_iLastBlock;
+    int total   = 0;
+    int nblocks = 0;
     for (int i = 0; i < iNumBlocks; ++i)
     {
         if (ifs.bad() || ifs.fail() || ifs.eof())
@@ -268,32 +385,37 @@ int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
         if (pktlen > iPktLen)
             pktlen = iPktLen;
 
+        Block& b = m_Blocks[s];
         HLOGC(bslog.Debug,
               log << "addBufferFromFile: reading from=" << (i * iPktLen) << " size=" << pktlen
-                  << " TO BUFFER:" << (void*)s->m_pcData);
-        ifs.read(s->m_pcData, pktlen);
+                  << " TO BUFFER:" << (void*)b.m_pcStorage);
+        b.m_pcData = b.m_pcStorage;
+        b.m_UserBuffer.m_pfnRelease = NULL;
+        ifs.read(b.m_pcData, pktlen);
         if ((pktlen = int(ifs.gcount())) <= 0)
             break;
 
         // currently file transfer is only available in streaming mode, message is always in order, ttl = infinite
-        s->m_iMsgNoBitset = m_iNextMsgNo | MSGNO_PACKET_INORDER::mask;
+        b.m_iMsgNoBitset = m_iNextMsgNo | MSGNO_PACKET_INORDER::mask;
         if (i == 0)
-            s->m_iMsgNoBitset |= PacketBoundaryBits(PB_FIRST);
+            b.m_iMsgNoBitset |= PacketBoundaryBits(PB_FIRST);
         if (i == iNumBlocks - 1)
-            s->m_iMsgNoBitset |= PacketBoundaryBits(PB_LAST);
+            b.m_iMsgNoBitset |= PacketBoundaryBits(PB_LAST);
         // NOTE: PB_FIRST | PB_LAST == PB_SOLO.
         // none of PB_FIRST & PB_LAST == PB_SUBSEQUENT.
 
-        s->m_iLength = pktlen;
-        s->m_iTTL    = SRT_MSGTTL_INF;
-        s            = s->m_pNext;
+        b.m_iLength = pktlen;
+        b.m_iTTL    = SRT_MSGTTL_INF;
+        s           = nextBlock(s);
 
         total += pktlen;
+        ++nblocks;
     }
-    m_pLastBlock = s;
 
     enterCS(m_BufLock);
-    m_iCount += iNumBlocks;
+    // Only the blocks actually filled are taken, so that the count matches the ring.
+    m_iLastBlock = s;
+    m_iCount += nblocks;
     m_iBytesCount += total;
 
     leaveCS(m_BufLock);
@@ -305,19 +427,22 @@ int CSndBuffer::addBufferFromFile(fstream& ifs, int len)
     return total;
 }
 
-int CSndBuffer::readData(CPacket& w_packet, steady_clock::time_point& w_srctime, int kflgs, int& w_seqnoinc)
+int CSndBuffer::readData(CPacket& w_packet, steady_clock::time_point& w_srctime, int kflgs, int& w_seqnoinc, bool& w_encrypted)
 {
     int readlen = 0;
     w_seqnoinc = 0;
+    w_encrypted = false;
 
     ScopedLock bufferguard(m_BufLock);
-    while (m_pCurrBlock != m_pLastBlock)
+    while (m_iCurrBlock != m_iLastBlock)
     {
+        Block& b = m_Blocks[m_iCurrBlock];
+
         // Make the packet REFLECT the data stored in the buffer.
-        w_packet.m_pcData = m_pCurrBlock->m_pcData;
-        readlen = m_pCurrBlock->m_iLength;
+        w_packet.m_pcData = b.m_pcData;
+        readlen = b.m_iLength;
         w_packet.setLength(readlen, m_iBlockLen);
-        w_packet.m_iSeqNo = m_pCurrBlock->m_iSeqNo;
+        w_packet.m_iSeqNo = b.m_iSeqNo;
 
         // 1. On submission (addBuffer), the KK flag is set to EK_NOENC (0).
         // 2. The readData() is called to get the original (unique) payload not ever sent yet.
@@ -326,30 +451,29 @@ int CSndBuffer::readData(CPacket& w_packet, steady_clock::time_point& w_srctime,
         //    header must be set and remembered accordingly (see EncryptionKeySpec).
         // 3. The next time this packet is read (only for retransmission), the payload is already
         //    encrypted, and the proper flag value is already stored.
-        
-        // TODO: Alternatively, encryption could happen before the packet is submitted to the buffer
-        // (before the addBuffer() call), and corresponding flags could be set accordingly.
-        // This may also put an encryption burden on the application thread, rather than the sending thread,
-        // which could be more efficient. Note that packet sequence number must be properly set in that case,
-        // as it is used as a counter for the AES encryption.
-        if (kflgs == -1)
+        // Alternatively the payload is encrypted already on submission, on the application thread
+        // (see addBuffer() with crypto), and the KK flag is set then.
+        if (b.m_iMsgNoBitset & PMASK_MSGNO_ENCKEYSPEC)
+        {
+            w_encrypted = true;
+        }
+        else if (kflgs == -1)
         {
             HLOGC(bslog.Debug, log << CONID() << " CSndBuffer: ERROR: encryption required and not possible. NOT SENDING.");
             readlen = 0;
         }
         else
         {
-            m_pCurrBlock->m_iMsgNoBitset |= MSGNO_ENCKEYSPEC::wrap(kflgs);
+            b.m_iMsgNoBitset |= MSGNO_ENCKEYSPEC::wrap(kflgs);
         }
 
-        Block* p = m_pCurrBlock;
-        w_packet.m_iMsgNo = m_pCurrBlock->m_iMsgNoBitset;
-        w_srctime = m_pCurrBlock->m_tsOriginTime;
-        m_pCurrBlock = m_pCurrBlock->m_pNext;
+        w_packet.m_iMsgNo = b.m_iMsgNoBitset;
+        w_srctime = b.m_tsOriginTime;
+        m_iCurrBlock = nextBlock(m_iCurrBlock);
 
-        if ((p->m_iTTL >= 0) && (count_milliseconds(steady_clock::now() - w_srctime) > p->m_iTTL))
+        if ((b.m_iTTL >= 0) && (count_milliseconds(steady_clock::now() - w_srctime) > b.m_iTTL))
         {
-            LOGC(bslog.Warn, log << CONID() << "CSndBuffer: skipping packet %" << p->m_iSeqNo << " #" << p->getMsgSeq() << " with TTL=" << p->m_iTTL);
+            LOGC(bslog.Warn, log << CONID() << "CSndBuffer: skipping packet %" << b.m_iSeqNo << " #" << b.getMsgSeq() << " with TTL=" << b.m_iTTL);
             // Skip this packet due to TTL expiry.
             readlen = 0;
             ++w_seqnoinc;
@@ -370,26 +494,17 @@ int CSndBuffer::readData(CPacket& w_packet, steady_clock::time_point& w_srctime,
 CSndBuffer::time_point CSndBuffer::peekNextOriginal() const
 {
     ScopedLock bufferguard(m_BufLock);
-    if (m_pCurrBlock == m_pLastBlock)
+    if (m_iCurrBlock == m_iLastBlock)
         return time_point();
 
-    return m_pCurrBlock->m_tsOriginTime;
+    return m_Blocks[m_iCurrBlock].m_tsOriginTime;
 }
 
 int32_t CSndBuffer::getMsgNoAt(const int offset)
 {
     ScopedLock bufferguard(m_BufLock);
 
-    Block* p = m_pFirstBlock;
-
-    if (p)
-    {
-        HLOGC(bslog.Debug,
-              log << "CSndBuffer::getMsgNoAt: FIRST MSG: size=" << p->m_iLength << " %" << p->m_iSeqNo << " #"
-                  << p->getMsgSeq() << " !" << BufferStamp(p->m_pcData, p->m_iLength));
-    }
-
-    if (offset >= m_iCount)
+    if (offset < 0 || offset >= m_iCount)
     {
         // Prevent accessing the last "marker" block
         LOGC(bslog.Error,
@@ -397,29 +512,12 @@ int32_t CSndBuffer::getMsgNoAt(const int offset)
         return SRT_MSGNO_CONTROL;
     }
 
-    // XXX Suboptimal procedure to keep the blocks identifiable
-    // by sequence number. Consider using some circular buffer.
-    int       i;
-    Block* ee SRT_ATR_UNUSED = 0;
-    for (i = 0; i < offset && p; ++i)
-    {
-        ee = p;
-        p  = p->m_pNext;
-    }
-
-    if (!p)
-    {
-        LOGC(bslog.Error,
-             log << "CSndBuffer::getMsgNoAt: IPE: offset=" << offset << " not found, stopped at " << i << " with #"
-                 << (ee ? ee->getMsgSeq() : SRT_MSGNO_NONE));
-        return SRT_MSGNO_CONTROL;
-    }
-
+    const Block& b = m_Blocks[blockAt(offset)];
     HLOGC(bslog.Debug,
-          log << "CSndBuffer::getMsgNoAt: offset=" << offset << " found, size=" << p->m_iLength << " %" << p->m_iSeqNo
-              << " #" << p->getMsgSeq() << " !" << BufferStamp(p->m_pcData, p->m_iLength));
+          log << "CSndBuffer::getMsgNoAt: offset=" << offset << " found, size=" << b.m_iLength << " %" << b.m_iSeqNo
+              << " #" << b.getMsgSeq() << " !" << BufferStamp(b.m_pcData, b.m_iLength));
 
-    return p->getMsgSeq();
+    return b.getMsgSeq();
 }
 
 int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time_point& w_srctime, int& w_msglen)
@@ -428,28 +526,22 @@ int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time
 
     ScopedLock bufferguard(m_BufLock);
 
-    Block* p = m_pFirstBlock;
-
-    // XXX Suboptimal procedure to keep the blocks identifiable
-    // by sequence number. Consider using some circular buffer.
-    for (int i = 0; i < offset && p != m_pLastBlock; ++i)
-    {
-        p = p->m_pNext;
-    }
-    if (p == m_pLastBlock)
+    if (offset < 0 || offset >= m_iCount)
     {
         LOGC(qslog.Error, log << "CSndBuffer::readData: offset " << offset << " too large!");
         return 0;
     }
+    int    i = blockAt(offset);
+    Block* p = &m_Blocks[i];
 #if ENABLE_HEAVY_LOGGING
     const int32_t first_seq = p->m_iSeqNo;
     int32_t last_seq = p->m_iSeqNo;
 #endif
 
-    // Check if the block that is the next candidate to send (m_pCurrBlock pointing) is stale.
+    // Check if the block that is the next candidate to send (m_iCurrBlock pointing) is stale.
 
     // If so, then inform the caller that it should first take care of the whole
-    // message (all blocks with that message id). Shift the m_pCurrBlock pointer
+    // message (all blocks with that message id). Shift the m_iCurrBlock index
     // to the position past the last of them. Then return -1 and set the
     // msgno_bitset return reference to the message id that should be dropped as
     // a whole.
@@ -465,18 +557,18 @@ int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time
     {
         int32_t msgno = p->getMsgSeq();
         w_msglen      = 1;
-        p             = p->m_pNext;
+        i             = nextBlock(i);
         bool move     = false;
-        while (p != m_pLastBlock && msgno == p->getMsgSeq())
+        while (i != m_iLastBlock && msgno == m_Blocks[i].getMsgSeq())
         {
 #if ENABLE_HEAVY_LOGGING
-            last_seq = p->m_iSeqNo;
+            last_seq = m_Blocks[i].m_iSeqNo;
 #endif
-            if (p == m_pCurrBlock)
+            if (i == m_iCurrBlock)
                 move = true;
-            p = p->m_pNext;
+            i = nextBlock(i);
             if (move)
-                m_pCurrBlock = p;
+                m_iCurrBlock = i;
             w_msglen++;
         }
 
@@ -518,38 +610,47 @@ int CSndBuffer::readData(const int offset, CPacket& w_packet, steady_clock::time
 sync::steady_clock::time_point CSndBuffer::getPacketRexmitTime(const int offset)
 {
     ScopedLock bufferguard(m_BufLock);
-    const Block* p = m_pFirstBlock;
-
-    // XXX Suboptimal procedure to keep the blocks identifiable
-    // by sequence number. Consider using some circular buffer.
-    for (int i = 0; i < offset; ++i)
-    {
-        SRT_ASSERT(p);
-        p = p->m_pNext;
-    }
+    SRT_ASSERT(offset >= 0 && offset < m_iCount);
+    if (offset < 0 || offset >= m_iCount)
+        return time_point();
 
-    SRT_ASSERT(p);
-    return p->m_tsRexmitTime;
+    return m_Blocks[blockAt(offset)].m_tsRexmitTime;
 }
 
 void CSndBuffer::ackData(int offset)
 {
-    ScopedLock bufferguard(m_BufLock);
-
-    bool move = false;
-    for (int i = 0; i < offset; ++i)
+    vector<UserBuffer> released;
     {
-        m_iBytesCount -= m_pFirstBlock->m_iLength;
-        if (m_pFirstBlock == m_pCurrBlock)
-            move = true;
-        m_pFirstBlock = m_pFirstBlock->m_pNext;
-    }
-    if (move)
-        m_pCurrBlock = m_pFirstBlock;
+        ScopedLock bufferguard(m_BufLock);
 
-    m_iCount -= offset;
+        bool move = false;
+        for (int i = 0; i < offset; ++i)
+        {
+            const Block& b = m_Blocks[m_iFirstBlock];
+            m_iBytesCount -= b.m_iLength;
+            if (b.m_UserBuffer.m_pfnRelease)
+                released.push_back(b.m_UserBuffer);
+            if (m_iFirstBlock == m_iCurrBlock)
+                move = true;
+            m_iFirstBlock = nextBlock(m_iFirstBlock);
+        }
+        if (move)
+            m_iCurrBlock = m_iFirstBlock;
 
-    updAvgBufSize(steady_clock::now());
+        m_iCount -= offset;
+
+        updAvgBufSize(steady_clock::now());
+    }
+    releaseUserBuffers(released);
+}
+
+void CSndBuffer::releaseUserBuffers(const vector<UserBuffer>& released)
+{
+    for (size_t i = 0; i < released.size(); ++i)
+    {
+        const UserBuffer& ub = released[i];
+        ub.m_pfnRelease(ub.m_pOpaque, ub.m_pcData, ub.m_iLength);
+    }
 }
 
 int CSndBuffer::getCurrBufSize() const
@@ -615,7 +716,7 @@ int CSndBuffer::getCurrBufSize(int& w_bytes, int& w_timespan) const
      * Also, if there is only one pkt in buffer, the time difference will be 0.
      * Therefore, always add 1 ms if not empty.
      */
-    w_timespan = 0 < m_iCount ? (int) count_milliseconds(m_tsLastOriginTime - m_pFirstBlock->m_tsOriginTime) + 1 : 0;
+    w_timespan = 0 < m_iCount ? (int) count_milliseconds(m_tsLastOriginTime - m_Blocks[m_iFirstBlock].m_tsOriginTime) + 1 : 0;
 
     return m_iCount;
 }
@@ -623,11 +724,10 @@ int CSndBuffer::getCurrBufSize(int& w_bytes, int& w_timespan) const
 CSndBuffer::duration CSndBuffer::getBufferingDelay(const time_point& tnow) const
 {
     ScopedLock lck(m_BufLock);
-    SRT_ASSERT(m_pFirstBlock);
     if (m_iCount == 0)
         return duration(0);
 
-    return tnow - m_pFirstBlock->m_tsOriginTime;
+    return tnow - m_Blocks[m_iFirstBlock].m_tsOriginTime;
 }
 
 int CSndBuffer::dropLateData(int& w_bytes, int32_t& w_first_msgno, const steady_clock::time_point& too_late_time)
@@ -637,21 +737,25 @@ int CSndBuffer::dropLateData(int& w_bytes, int32_t& w_first_msgno, const steady_
     bool    move   = false;
     int32_t msgno  = 0;
 
-    ScopedLock bufferguard(m_BufLock);
-    for (int i = 0; i < m_iCount && m_pFirstBlock->m_tsOriginTime < too_late_time; ++i)
+    vector<UserBuffer> released;
+    UniqueLock bufferguard(m_BufLock);
+    for (int i = 0; i < m_iCount && m_Blocks[m_iFirstBlock].m_tsOriginTime < too_late_time; ++i)
     {
+        const Block& b = m_Blocks[m_iFirstBlock];
         dpkts++;
-        dbytes += m_pFirstBlock->m_iLength;
-        msgno = m_pFirstBlock->getMsgSeq();
+        dbytes += b.m_iLength;
+        msgno = b.getMsgSeq();
+        if (b.m_UserBuffer.m_pfnRelease)
+            released.push_back(b.m_UserBuffer);
 
-        if (m_pFirstBlock == m_pCurrBlock)
+        if (m_iFirstBlock == m_iCurrBlock)
             move = true;
-        m_pFirstBlock = m_pFirstBlock->m_pNext;
+        m_iFirstBlock = nextBlock(m_iFirstBlock);
     }
 
     if (move)
     {
-        m_pCurrBlock = m_pFirstBlock;
+        m_iCurrBlock = m_iFirstBlock;
     }
     m_iCount -= dpkts;
 
@@ -664,7 +768,9 @@ int CSndBuffer::dropLateData(int& w_bytes, int32_t& w_first_msgno, const steady_
     w_first_msgno = ++MsgNo(msgno);
 
     updAvgBufSize(steady_clock::now());
+    bufferguard.unlock();
 
+    releaseUserBuffers(released);
     return (dpkts);
 }
 
@@ -674,13 +780,18 @@ void CSndBuffer::increase()
 
     // new physical buffer
     Buffer* nbuf = NULL;
+    vector<Block> blocks;
     try
     {
         nbuf           = new Buffer;
+        nbuf->m_pcData = NULL;
         nbuf->m_pcData = new char[unitsize * m_iBlockLen];
+        blocks.reserve(m_iSize + unitsize);
     }
     catch (...)
     {
+        if (nbuf)
+            delete[] nbuf->m_pcData;
         delete nbuf;
         throw CUDTException(MJ_SYSTEMRES, MN_MEMORY, 0);
     }
@@ -693,37 +804,30 @@ void CSndBuffer::increase()
         p = p->m_pNext;
     p->m_pNext = nbuf;
 
-    // new packet blocks
-    Block* nblk = NULL;
-    try
-    {
-        nblk = new Block;
-    }
-    catch (...)
-    {
-        delete nblk;
-        throw CUDTException(MJ_SYSTEMRES, MN_MEMORY, 0);
-    }
-    Block* pb = nblk;
-    for (int i = 1; i < unitsize; ++i)
-    {
-        pb->m_pNext = new Block;
-        pb          = pb->m_pNext;
-    }
-
-    // insert the new blocks onto the existing one
-    pb->m_pNext           = m_pLastBlock->m_pNext;
-    m_pLastBlock->m_pNext = nblk;
+    // Unroll the ring starting from the first block, so that the offsets
+    // of the blocks stay the same, and append the new blocks after it.
+    // The blocks keep their storage, only their descriptions are moved.
+    for (int i = 0, b = m_iFirstBlock; i < m_iSize; ++i, b = nextBlock(b))
+        blocks.push_back(m_Blocks[b]);
 
-    pb       = nblk;
     char* pc = nbuf->m_pcData;
     for (int i = 0; i < unitsize; ++i)
     {
-        pb->m_pcData = pc;
-        pb           = pb->m_pNext;
+        Block nblk = Block();
+        nblk.m_pcData       = pc;
+        nblk.m_pcStorage    = pc;
+        nblk.m_UserBuffer.m_pfnRelease = NULL;
+        blocks.push_back(nblk);
         pc += m_iBlockLen;
     }
 
+    const int curr_offset = m_iCurrBlock >= m_iFirstBlock ? m_iCurrBlock - m_iFirstBlock : m_iCurrBlock + m_iSize - m_iFirstBlock;
+    const int last_offset = m_iLastBlock >= m_iFirstBlock ? m_iLastBlock - m_iFirstBlock : m_iLastBlock + m_iSize - m_iFirstBlock;
+
+    m_Blocks.swap(blocks);
+    m_iFirstBlock = 0;
+    m_iCurrBlock  = curr_offset;
+    m_iLastBlock  = last_offset;
     m_iSize += unitsize;
 
     HLOGC(bslog.Debug,
@@ -71,6 +71,8 @@ modified by
 
 namespace srt {
 
+class CCryptoControl;
+
 class CSndBuffer
 {
     typedef sync::steady_clock::time_point time_point;
@@ -106,8 +108,46 @@ public:
     /// @param [in] data pointer to the user data block.
     /// @param [in] len size of the block.
     /// @param [inout] w_mctrl Message control data
+    /// @param [in] release if not NULL, the packets refer to @a data instead of copying it,
+    ///             and @a release is called with @a opaque when no packet refers to it anymore.
+    /// @param [in] opaque user data passed to @a release
+    SRT_ATTR_EXCLUDES(m_BufLock)
+    void addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl,
+                   srt_send_release_fn* release = NULL, void* opaque = NULL);
+
+    /// Insert a user message gathered from several blocks into the sending list.
+    /// The blocks are copied directly into the packets, without joining them first.
+    /// @param [in] iov blocks of the message, in order.
+    /// @param [in] iovcnt number of blocks.
+    /// @param [in] len size of the message, up to the total size of the blocks.
+    /// @param [inout] w_mctrl Message control data
+    SRT_ATTR_EXCLUDES(m_BufLock)
+    void addBuffer(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl);
+
+    /// Blocks of a message inserted with reserveBuffer(), not yet available for reading.
+    struct Reservation
+    {
+        int iFirst; // first block of the message
+        int iEnd;   // block following the last one
+        int iCount; // number of blocks
+        int iBytes; // size of the message
+    };
+
+    /// Insert a user message as addBuffer() does, but without making its packets
+    /// available for reading until commitBuffer(), so that they can be encrypted
+    /// in the meantime with no lock held. No other insertion may be done until then.
+    /// @param [out] w_res the blocks inserted, to pass to encryptBuffer() and commitBuffer().
     SRT_ATTR_EXCLUDES(m_BufLock)
-    void addBuffer(const char* data, int len, SRT_MSGCTRL& w_mctrl);
+    void reserveBuffer(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl, Reservation& w_res);
+
+    /// Encrypt the payload of the reserved blocks with the sequence numbers scheduled
+    /// for them, and set the crypto flags in them if succeeded. The buffer is not locked,
+    /// as the blocks not yet available for reading are accessed only by the insertion.
+    void encryptBuffer(const Reservation& res, CCryptoControl& crypto);
+
+    /// Make the reserved blocks available for reading.
+    SRT_ATTR_EXCLUDES(m_BufLock)
+    void commitBuffer(const Reservation& res);
 
     /// Read a block of data from file and insert it into the sending list.
     /// @param [in] ifs input file stream.
@@ -121,9 +161,10 @@ public:
     /// @param [out] origintime origin time stamp of the message
     /// @param [in] kflags Odd|Even crypto key flag
     /// @param [out] seqnoinc the number of packets skipped due to TTL, so that seqno should be incremented.
+    /// @param [out] encrypted whether the payload was already encrypted when added to the buffer.
     /// @return Actual length of data read.
     SRT_ATTR_EXCLUDES(m_BufLock)
-    int readData(CPacket& w_packet, time_point& w_origintime, int kflgs, int& w_seqnoinc);
+    int readData(CPacket& w_packet, time_point& w_origintime, int kflgs, int& w_seqnoinc, bool& w_encrypted);
 
     /// Peek an information on the next original data packet to send.
     /// @return origin time stamp of the next packet; epoch start time otherwise.
@@ -197,13 +238,55 @@ public:
 private:
     void increase();
 
+    /// Index of the block following the block at @a idx in the ring.
+    int nextBlock(int idx) const { return idx + 1 == m_iSize ? 0 : idx + 1; }
+
+    /// Index of the block at @a offset from the first block (0 <= offset < m_iSize).
+    int blockAt(int offset) const
+    {
+        const int idx = m_iFirstBlock + offset;
+        return idx >= m_iSize ? idx - m_iSize : idx;
+    }
+
+    SRT_ATTR_EXCLUDES(m_BufLock)
+    void addBuffer(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl,
+                   srt_send_release_fn* release, void* opaque);
+
+    /// Fill in the blocks of a message following the last block, without making them
+    /// available for reading (see addBuffer() for the parameters).
+    /// @param [in] tnow time of the submission
+    SRT_ATTR_REQUIRES(m_BufLock)
+    void insertBlocks(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl,
+                      srt_send_release_fn* release, void* opaque, const time_point& tnow,
+                      Reservation& w_res);
+
+    /// Make the blocks filled in by insertBlocks() available for reading.
+    SRT_ATTR_REQUIRES(m_BufLock)
+    void publishBlocks(const Reservation& res);
+
+    /// User buffer referred to by the packets of a message, to be released
+    /// when the last of them is removed from the buffer.
+    struct UserBuffer
+    {
+        srt_send_release_fn* m_pfnRelease;
+        void*                m_pOpaque;
+        const char*          m_pcData;
+        int                  m_iLength;
+    };
+
+    /// Call the release functions of the user buffers. Must not be called with m_BufLock locked.
+    static void releaseUserBuffers(const std::vector<UserBuffer>& released);
+
 private:
     mutable sync::Mutex m_BufLock; // used to synchronize buffer operation
 
     struct Block
     {
-        char* m_pcData;  // pointer to the data block
-        int   m_iLength; // payload length of the block (excluding auth tag).
+        char* m_pcData;    // pointer to the data block
+        char* m_pcStorage; // the block's own storage (m_pcData unless it refers to a user buffer)
+        int   m_iLength;   // payload length of the block (excluding auth tag).
+
+        UserBuffer m_UserBuffer; // set on the last block of a message referring to a user buffer
 
         int32_t    m_iMsgNoBitset; // message number
         int32_t    m_iSeqNo;       // sequence number for scheduling
@@ -211,9 +294,7 @@ private:
         time_point m_tsRexmitTime; // packet retransmission time
         int        m_iTTL; // time to live (milliseconds)
 
-        Block* m_pNext; // next block
-
-        int32_t getMsgSeq()
+        int32_t getMsgSeq() const
         {
             // NOTE: this extracts message ID with regard to REXMIT flag.
             // This is valid only for message ID that IS GENERATED in this instance,
@@ -222,12 +303,17 @@ private:
             return m_iMsgNoBitset & MSGNO_SEQ::mask;
         }
 
-    } * m_pBlock, *m_pFirstBlock, *m_pCurrBlock, *m_pLastBlock;
+    };
+
+    // The blocks form a ring, so that the block of a packet is found directly by its offset
+    // from the first block (which is the same as the sequence number offset from the ACK point).
+    // Growing the buffer rearranges the ring, but the payload storage of the blocks never moves,
+    // so the packets already read from the buffer stay valid.
+    std::vector<Block> m_Blocks;
 
-    // m_pBlock:         The head pointer
-    // m_pFirstBlock:    The first block
-    // m_pCurrBlock:	 The current block
-    // m_pLastBlock:     The last block (if first == last, buffer is empty)
+    int m_iFirstBlock; // The first block (the oldest not acknowledged)
+    int m_iCurrBlock;  // The current block (the next to send for the first time)
+    int m_iLastBlock;  // The block past the last one (if first == last, buffer is empty)
 
     struct Buffer
     {
@@ -238,7 +324,7 @@ private:
 
     int32_t m_iNextMsgNo; // next message number
 
-    int m_iSize; // buffer size (number of packets)
+    int m_iSize; // buffer size (number of packets, equal to m_Blocks.size())
     const int m_iBlockLen;  // maximum length of a block holding packet payload and AUTH tag (excluding packet header).
     const int m_iAuthTagSize; // Authentication tag size (if GCM is enabled).
     int m_iCount; // number of used blocks
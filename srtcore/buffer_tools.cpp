@@ -51,6 +51,7 @@ modified by
 *****************************************************************************/
 
 #include "platform_sys.h"
+#include <limits>
 #include "buffer_tools.h"
 #include "packet.h"
 #include "logger_defs.h"
@@ -272,5 +273,60 @@ int CSndRateEstimator::incSampleIdx(int val, int inc) const
     return val;
 }
 
+size_t CIoVecCursor::gather(char* dst, size_t len)
+{
+    size_t copied = 0;
+    while (copied < len && m_iIndex < m_iCount)
+    {
+        const SRT_IOVEC& v     = m_pIov[m_iIndex];
+        const size_t     chunk = min(len - copied, v.len - m_zOffset);
+        memcpy(dst + copied, static_cast<const char*>(v.base) + m_zOffset, chunk);
+        copied += chunk;
+        m_zOffset += chunk;
+        if (m_zOffset == v.len)
+        {
+            ++m_iIndex;
+            m_zOffset = 0;
+        }
+    }
+    return copied;
+}
+
+size_t CIoVecCursor::scatter(const char* src, size_t len)
+{
+    size_t copied = 0;
+    while (copied < len && m_iIndex < m_iCount)
+    {
+        const SRT_IOVEC& v     = m_pIov[m_iIndex];
+        const size_t     chunk = min(len - copied, v.len - m_zOffset);
+        memcpy(static_cast<char*>(v.base) + m_zOffset, src + copied, chunk);
+        copied += chunk;
+        m_zOffset += chunk;
+        if (m_zOffset == v.len)
+        {
+            ++m_iIndex;
+            m_zOffset = 0;
+        }
+    }
+    return copied;
+}
+
+int CIoVecCursor::totalSize(const SRT_IOVEC* iov, int iovcnt)
+{
+    if (!iov || iovcnt <= 0)
+        return -1;
+
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; ++i)
+    {
+        if (iov[i].len && !iov[i].base)
+            return -1;
+        if (iov[i].len > size_t(numeric_limits<int>::max()) - total)
+            return -1;
+        total += iov[i].len;
+    }
+    return int(total);
+}
+
 }
 
@@ -197,6 +197,36 @@ private:
     int        m_iRateBps;          // Input Rate in Bytes/sec
 };
 
+/// Sequential access to a message scattered over several user blocks.
+class CIoVecCursor
+{
+public:
+    CIoVecCursor(const SRT_IOVEC* iov, int iovcnt)
+        : m_pIov(iov)
+        , m_iCount(iovcnt)
+        , m_iIndex(0)
+        , m_zOffset(0)
+    {
+    }
+
+    /// Copy the data from the current position to @a dst and move past them.
+    /// @return the number of bytes copied, less than @a len only at the end of the blocks.
+    size_t gather(char* dst, size_t len);
+
+    /// Copy the data from @a src to the current position and move past them.
+    /// @return the number of bytes copied, less than @a len only at the end of the blocks.
+    size_t scatter(const char* src, size_t len);
+
+    /// The total size of the blocks, or -1 if it's invalid or exceeds INT_MAX.
+    static int totalSize(const SRT_IOVEC* iov, int iovcnt);
+
+private:
+    const SRT_IOVEC* m_pIov;
+    int              m_iCount;
+    int              m_iIndex;  //< Current block
+    size_t           m_zOffset; //< Position in the current block
+};
+
 } // namespace srt
 
 #endif
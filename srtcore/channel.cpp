@@ -66,6 +66,15 @@ modified by
 
 #ifdef _WIN32
 typedef int socklen_t;
+#else
+#include <poll.h>
+#endif
+
+#ifdef SRT_ENABLE_MMSG
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103 // UDP generic segmentation offload, since Linux 4.18
+#endif
 #endif
 
 using namespace std;
@@ -139,10 +148,33 @@ static int set_cloexec(int fd, int set)
 
 srt::CChannel::CChannel()
     : m_iSocket(INVALID_SOCKET)
+#ifdef SRT_ENABLE_MMSG
+    , m_bUseGSO(false)
+#endif
+    , m_pInproc(NULL)
+#ifndef _WIN32
+    , m_bWakePending(false)
+#endif
 #ifdef SRT_ENABLE_PKTINFO
     , m_bBindMasked(true)
 #endif
 {
+#ifndef _WIN32
+    if (::pipe(m_aiWakeFD) == 0)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            ::fcntl(m_aiWakeFD[i], F_SETFL, ::fcntl(m_aiWakeFD[i], F_GETFL) | O_NONBLOCK);
+            ::fcntl(m_aiWakeFD[i], F_SETFD, FD_CLOEXEC);
+        }
+    }
+    else
+    {
+        // The receiving then only waits as long as on Windows.
+        LOGC(kmlog.Warn, log << CONID() << "pipe: " << SysStrError(NET_ERROR) << " - receiver can't be woken up");
+        m_aiWakeFD[0] = m_aiWakeFD[1] = -1;
+    }
+#endif
 #ifdef _WIN32
     SecureZeroMemory((PVOID)&m_SendOverlapped, sizeof(WSAOVERLAPPED));
     m_SendOverlapped.hEvent = WSACreateEvent();
@@ -170,6 +202,12 @@ srt::CChannel::~CChannel()
 {
 #ifdef _WIN32
     WSACloseEvent(m_SendOverlapped.hEvent);
+#else
+    if (m_aiWakeFD[0] != -1)
+    {
+        ::close(m_aiWakeFD[0]);
+        ::close(m_aiWakeFD[1]);
+    }
 #endif
 }
 
@@ -229,6 +267,12 @@ void srt::CChannel::createSocket(int family)
 
 void srt::CChannel::open(const sockaddr_any& addr)
 {
+    if (!m_mcfg.sInprocLink.empty())
+    {
+        openInproc(addr);
+        return;
+    }
+
     createSocket(addr.family());
     socklen_t namelen = addr.size();
 
@@ -246,6 +290,12 @@ void srt::CChannel::open(const sockaddr_any& addr)
 
 void srt::CChannel::open(int family)
 {
+    if (!m_mcfg.sInprocLink.empty())
+    {
+        openInproc(sockaddr_any(family));
+        return;
+    }
+
     createSocket(family);
 
     // sendto or WSASendTo will also automatically bind the socket
@@ -292,8 +342,28 @@ void srt::CChannel::open(int family)
     setUDPSockOpt();
 }
 
+void srt::CChannel::openInproc(const sockaddr_any& addr)
+{
+    CInprocLinkModel model;
+    if (!CInprocLinkModel::parse(m_mcfg.sInprocLink, (model)))
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+    m_pInproc = CInprocNetwork::bind(addr, model, m_mcfg.iUDPRcvBufSize, (m_BindAddr));
+#ifdef SRT_ENABLE_PKTINFO
+    // The source address of the sent datagrams is always the bound one.
+    m_bBindMasked = false;
+#endif
+    LOGC(kmlog.Debug, log << "CHANNEL: Bound to in-process address: " << m_BindAddr.str());
+}
+
 void srt::CChannel::attach(UDPSOCKET udpsock, const sockaddr_any& udpsocks_addr)
 {
+    if (!m_mcfg.sInprocLink.empty())
+    {
+        LOGC(kmlog.Error, log << "CHANNEL: a UDP socket can't be used with SRTO_INPROC_LINK");
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+    }
+
     // The getsockname() call is done before calling it and the
     // result is placed into udpsocks_addr.
     m_iSocket  = udpsock;
@@ -531,10 +601,30 @@ void srt::CChannel::setUDPSockOpt()
         //::setsockopt(m_iSocket, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
     }
 #endif
+
+#ifdef SRT_ENABLE_MMSG
+    // Segmentation offload is only used by batched sending. Setting the
+    // option to 0 checks whether the system supports it at all.
+    m_bUseGSO = false;
+    if (m_mcfg.iUDPSndBatch > 1)
+    {
+        const int gso_off = 0;
+        m_bUseGSO = ::setsockopt(m_iSocket, SOL_UDP, UDP_SEGMENT, &gso_off, sizeof gso_off) == 0;
+        HLOGC(kmlog.Debug, log << "UDP GSO " << (m_bUseGSO ? "supported" : "NOT supported") << " - batches of up to "
+                << m_mcfg.iUDPSndBatch << " packets");
+    }
+#endif
 }
 
 void srt::CChannel::close() const
 {
+    if (m_pInproc)
+    {
+        CInprocNetwork::unbind(m_BindAddr, m_pInproc);
+        m_pInproc = NULL;
+        return;
+    }
+
 #ifndef _WIN32
     ::close(m_iSocket);
 #else
@@ -568,6 +658,9 @@ void srt::CChannel::getSocketOption(int level, int option, char* pw_dataptr, soc
 
 int srt::CChannel::getIpTTL() const
 {
+    if (m_pInproc)
+        return m_mcfg.iIpTTL;
+
     if (m_iSocket == INVALID_SOCKET)
         throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
 
@@ -591,6 +684,9 @@ int srt::CChannel::getIpTTL() const
 
 int srt::CChannel::getIpToS() const
 {
+    if (m_pInproc)
+        return m_mcfg.iIpToS;
+
     if (m_iSocket == INVALID_SOCKET)
         throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
 
@@ -658,6 +754,12 @@ int srt::CChannel::sockoptQuery(int level SRT_ATR_UNUSED, int option SRT_ATR_UNU
 
 void srt::CChannel::getSockAddr(sockaddr_any& w_addr) const
 {
+    if (m_pInproc)
+    {
+        w_addr = m_BindAddr;
+        return;
+    }
+
     // The getsockname function requires only to have enough target
     // space to copy the socket name, it doesn't have to be correlated
     // with the address family. So the maximum space for any name,
@@ -749,6 +851,13 @@ int srt::CChannel::sendto(const sockaddr_any& addr, CPacket& packet, const socka
     // convert control information into network order
     packet.toNL();
 
+    if (m_pInproc)
+    {
+        CInprocNetwork::send(inprocSource(addr), addr, packet.m_PacketVector, 2);
+        packet.toHL();
+        return int(CPacket::HDR_SIZE + packet.getLength());
+    }
+
 #ifndef _WIN32
     msghdr mh;
     mh.msg_name       = (sockaddr*)&addr;
@@ -822,23 +931,95 @@ int srt::CChannel::sendto(const sockaddr_any& addr, CPacket& packet, const socka
     return res;
 }
 
-srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet) const
+int srt::CChannel::waitReadable(int wait_us) const
 {
-    EReadStatus status    = RST_OK;
-    int         msg_flags = 0;
-    int         recv_size = -1;
-
-#if defined(UNIX) || defined(_WIN32)
+#ifndef _WIN32
+    pollfd fds[2];
+    fds[0].fd      = m_iSocket;
+    fds[0].events  = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd      = m_aiWakeFD[0];
+    fds[1].events  = POLLIN;
+    fds[1].revents = 0;
+
+    const nfds_t nfds = m_aiWakeFD[0] == -1 ? 1 : 2;
+    if (nfds == 1)
+        wait_us = min(wait_us, int(RECV_POLL_US));
+
+    // Rounded up, so that the caller isn't woken up before the time it waits for.
+    const int ret = ::poll(fds, nfds, (wait_us + 999) / 1000);
+    if (ret <= 0)
+        return ret;
+
+    if (fds[1].revents)
+        drainWakeups();
+
+    // Errors are reported by reading.
+    return fds[0].revents ? 1 : 0;
+#else
     fd_set  set;
     timeval tv;
     FD_ZERO(&set);
     FD_SET(m_iSocket, &set);
-    tv.tv_sec            = 0;
-    tv.tv_usec           = 10000;
-    const int select_ret = ::select((int)m_iSocket + 1, &set, NULL, &set, &tv);
-#else
-    const int select_ret = 1; // the socket is expected to be in the blocking mode itself
+    tv.tv_sec  = 0;
+    tv.tv_usec = min(wait_us, int(RECV_POLL_US));
+    return ::select((int)m_iSocket + 1, &set, NULL, &set, &tv);
+#endif
+}
+
+void srt::CChannel::wakeReceiver() const
+{
+    if (m_pInproc)
+    {
+        m_pInproc->wakeup();
+        return;
+    }
+
+#ifndef _WIN32
+    // One byte is enough until the receiver drains it.
+    if (m_aiWakeFD[1] != -1 && !m_bWakePending.exchange(true))
+    {
+        const char b = 0;
+        if (::write(m_aiWakeFD[1], &b, 1) == -1)
+            m_bWakePending = false;
+    }
+#endif
+}
+
+void srt::CChannel::drainWakeups() const
+{
+#ifndef _WIN32
+    if (!m_bWakePending)
+        return;
+
+    char buf[16];
+    while (::read(m_aiWakeFD[0], buf, sizeof buf) > 0)
+    {
+    }
+    // Cleared only now: a wakeup skipped in the meantime is
+    // done by this one, as the caller didn't check its state yet.
+    m_bWakePending = false;
 #endif
+}
+
+srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet, int wait_us) const
+{
+    EReadStatus status    = RST_OK;
+    int         msg_flags = 0;
+    int         recv_size = -1;
+
+    if (m_pInproc)
+    {
+        recv_size = m_pInproc->receive((w_addr), w_packet.m_PacketVector, 2, wait_us);
+        if (recv_size == -1)
+        {
+            w_packet.setLength(-1);
+            return RST_AGAIN;
+        }
+        return completeRead(recv_size, 0, (w_packet));
+    }
+
+    const int select_ret = waitReadable(wait_us);
 
     if (select_ret == 0) // timeout
     {
@@ -1000,13 +1181,369 @@ srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet
         msg_flags = 1;
 #endif
 
+    return completeRead(recv_size, msg_flags, (w_packet));
+
+Return_error:
+    w_packet.setLength(-1);
+    return status;
+}
+
+srt::EReadStatus srt::CChannel::recvfrom_batch(sockaddr_any*   w_addr,
+                                               CPacket* const* w_packets,
+                                               EReadStatus*    w_status,
+                                               int             size,
+                                               int&            w_nrecv,
+                                               int             wait_us) const
+{
+    w_nrecv = 0;
+
+    if (m_pInproc)
+    {
+        // Wait only for the first packet, as with recvmmsg() below.
+        for (; w_nrecv < size; ++w_nrecv)
+        {
+            const int recv_size = m_pInproc->receive((w_addr[w_nrecv]), w_packets[w_nrecv]->m_PacketVector, 2, w_nrecv == 0 ? wait_us : 0);
+            if (recv_size == -1)
+                break;
+            w_status[w_nrecv] = completeRead(recv_size, 0, (*w_packets[w_nrecv]));
+        }
+        return w_nrecv > 0 ? RST_OK : RST_AGAIN;
+    }
+
+#ifdef SRT_ENABLE_MMSG
+    if (size > 1)
+    {
+#ifdef SRT_ENABLE_PKTINFO
+        static const size_t CTRL_BUF_SIZE = sizeof(CMSGNodeIPv4) + sizeof(CMSGNodeIPv6);
+#endif
+        if (m_RecvHdrs.size() < size_t(size))
+        {
+            m_RecvHdrs.resize(size);
+#ifdef SRT_ENABLE_PKTINFO
+            m_RecvCtrlBufs.resize(size * CTRL_BUF_SIZE);
+#endif
+        }
+
+        for (int i = 0; i < size; ++i)
+        {
+            msghdr& mh = m_RecvHdrs[i].msg_hdr;
+
+            mh.msg_name       = w_addr[i].get();
+            mh.msg_namelen    = w_addr[i].size();
+            mh.msg_iov        = w_packets[i]->m_PacketVector;
+            mh.msg_iovlen     = 2;
+            mh.msg_control    = NULL;
+            mh.msg_controllen = 0;
+#ifdef SRT_ENABLE_PKTINFO
+            if (m_bBindMasked)
+            {
+                mh.msg_control    = &m_RecvCtrlBufs[i * CTRL_BUF_SIZE];
+                mh.msg_controllen = CTRL_BUF_SIZE;
+            }
+#endif
+            mh.msg_flags          = 0;
+            m_RecvHdrs[i].msg_len = 0;
+        }
+
+        // Wait for the first packet here, where wakeReceiver() can interrupt it,
+        // then MSG_WAITFORONE takes whatever is already waiting in the system buffer.
+        int nrecv = waitReadable(wait_us);
+        if (nrecv > 0)
+            nrecv = ::recvmmsg(m_iSocket, &m_RecvHdrs[0], size, MSG_WAITFORONE, NULL);
+        if (nrecv <= 0)
+        {
+            // Errors are interpreted the same way as in recvfrom().
+            const int err = NET_ERROR;
+            if (nrecv == 0 || err == EAGAIN || err == EINTR || err == ECONNREFUSED)
+                return RST_AGAIN;
+
+            HLOGC(krlog.Debug, log << CONID() << "(sys)recvmmsg: " << SysStrError(err) << " [" << err << "]");
+            return RST_ERROR;
+        }
+
+        for (int i = 0; i < nrecv; ++i)
+        {
+#ifdef SRT_ENABLE_PKTINFO
+            if (m_bBindMasked)
+                w_packets[i]->m_DestAddr = getTargetAddress(m_RecvHdrs[i].msg_hdr);
+#endif
+            w_status[i] = completeRead((int)m_RecvHdrs[i].msg_len, m_RecvHdrs[i].msg_hdr.msg_flags, (*w_packets[i]));
+        }
+
+        HLOGC(krlog.Debug, log << CONID() << "(sys)recvmmsg: read " << nrecv << " packets of max " << size);
+        w_nrecv = nrecv;
+        return RST_OK;
+    }
+#else
+    (void)size;
+#endif
+
+    w_status[0] = recvfrom((w_addr[0]), (*w_packets[0]), wait_us);
+    if (w_status[0] == RST_OK)
+        w_nrecv = 1;
+    return w_status[0];
+}
+
+bool srt::CChannel::receivesLent() const
+{
+#ifdef SRT_ENABLE_IO_URING
+    // Set up in the first call, as the ring is bound to the thread using it.
+    return !m_pInproc && m_mcfg.bUDPIoUring && m_RecvRing.prepareRecv(m_iSocket, m_aiWakeFD[0]);
+#else
+    return false;
+#endif
+}
+
+void srt::CChannel::lendRecvPacket(CPacket& packet, int id) const
+{
+#ifdef SRT_ENABLE_IO_URING
+    if (m_LentPackets.empty())
+        m_LentPackets.resize(RECV_LENT_MAX, NULL);
+
+    SRT_ASSERT(id >= 0 && id < RECV_LENT_MAX && !m_LentPackets[id]);
+    m_LentPackets[id] = &packet;
+    // The kernel places the SRT header right before the payload.
+    m_RecvRing.provideRecvBuffer(id, packet.data() - RECV_HEADROOM, RECV_HEADROOM + packet.getLength());
+#else
+    (void)packet;
+    (void)id;
+#endif
+}
+
+srt::EReadStatus srt::CChannel::recvfrom_lent(sockaddr_any*   w_addr,
+                                              int*            w_ids,
+                                              EReadStatus*    w_status,
+                                              int             size,
+                                              int&            w_nrecv,
+                                              int             wait_us) const
+{
+    w_nrecv = 0;
+
+#ifdef SRT_ENABLE_IO_URING
+    CIoUring::RecvMsg msgs[CIoUring::RECV_BUFFERS];
+
+    // The ring waits for the wakeups itself.
+    const int nrecv = m_RecvRing.recvmsgs(msgs, min(size, int(RECV_LENT_MAX)), m_aiWakeFD[0] == -1 ? min(wait_us, int(RECV_POLL_US)) : wait_us);
+    if (nrecv <= 0)
+    {
+        const int err = errno;
+        drainWakeups();
+
+        // Errors are interpreted the same way as in recvfrom().
+        if (err == EAGAIN || err == EINTR || err == ECONNREFUSED)
+            return RST_AGAIN;
+
+        HLOGC(krlog.Debug, log << CONID() << "(io_uring)recvmsg: " << SysStrError(err) << " [" << err << "]");
+        return RST_ERROR;
+    }
+
+    for (int i = 0; i < nrecv; ++i)
+    {
+        const CIoUring::RecvMsg& msg = msgs[i];
+        CPacket&                 pkt = *m_LentPackets[msg.bid];
+        m_LentPackets[msg.bid]       = NULL;
+
+        w_ids[i] = (int)msg.bid;
+        w_addr[i].set(msg.name, msg.namelen);
+
+        // The payload is already in place, only the header is to be taken.
+        memcpy(pkt.m_PacketVector[CPacket::PV_HEADER].dataRef(), pkt.data() - CPacket::HDR_SIZE,
+               min(msg.len, size_t(CPacket::HDR_SIZE)));
+#ifdef SRT_ENABLE_PKTINFO
+        if (m_bBindMasked)
+        {
+            msghdr mh;
+            memset(&mh, 0, sizeof mh);
+            mh.msg_control    = (void*)msg.control;
+            mh.msg_controllen = msg.controllen;
+            pkt.m_DestAddr    = getTargetAddress(mh);
+        }
+#endif
+        w_status[i] = completeRead((int)msg.len, msg.flags, (pkt));
+    }
+
+    HLOGC(krlog.Debug, log << CONID() << "(io_uring)recvmsg: read " << nrecv << " packets of max " << size);
+    w_nrecv = nrecv;
+    return RST_OK;
+#else
+    (void)w_addr;
+    (void)w_ids;
+    (void)w_status;
+    (void)size;
+    (void)wait_us;
+    return RST_ERROR;
+#endif
+}
+
+bool srt::CChannel::stopReceiving() const
+{
+#ifdef SRT_ENABLE_IO_URING
+    // The receiving request keeps the socket open (and the port bound) until
+    // it's cancelled, which only the receiving thread can do.
+    return m_RecvRing.cancelRecv();
+#else
+    return true;
+#endif
+}
+
+#ifdef SRT_ENABLE_MMSG
+// Whether two packets would be sent from the same source address (see sendto()).
+static inline bool sameSource(const srt::sockaddr_any& a, const srt::sockaddr_any& b)
+{
+    return a.family() == b.family() && (a.family() == AF_UNSPEC || a.equal_address(b));
+}
+#endif
+
+int srt::CChannel::sendto_batch(const CSendSlot* slots, int size, CSendBatchBuffers& w_buf) const
+{
+    int nsent = 0;
+
+    if (m_pInproc)
+    {
+        for (; nsent < size; ++nsent)
+        {
+            IOVector iov;
+            iov.set((void*)slots[nsent].data, slots[nsent].size);
+            CInprocNetwork::send(inprocSource(slots[nsent].addr), slots[nsent].addr, &iov, 1);
+        }
+        return nsent;
+    }
+
+#ifdef SRT_ENABLE_MMSG
+    // Limits of a single segmented datagram: the kernel's UDP_MAX_SEGMENTS
+    // and the maximum size of an IP packet, with some spare room for headers.
+    static const int    MAX_GSO_SEGMENTS = 64;
+    static const size_t MAX_GSO_BYTES    = 63 * 1024;
+    static const size_t CTRL_BUF_SIZE    = CMSG_SPACE(sizeof(in6_pktinfo)) + CMSG_SPACE(sizeof(uint16_t));
+
+    if (w_buf.hdrs.size() < size_t(size))
+    {
+        w_buf.hdrs.resize(size);
+        w_buf.iov.resize(size);
+        w_buf.npackets.resize(size);
+        w_buf.ctrl.resize(size * CTRL_BUF_SIZE);
+    }
+
+    for (int i = 0; i < size; ++i)
+    {
+        w_buf.iov[i].iov_base = (void*)slots[i].data;
+        w_buf.iov[i].iov_len  = slots[i].size;
+    }
+
+    int pos = 0;
+    while (pos < size)
+    {
+        // Compose the messages for the remaining packets. With GSO, a message
+        // collects consecutive packets of the same size sent to the same
+        // destination; only the last one in the message may be shorter.
+        int nmsg = 0;
+        for (int i = pos; i < size; ++nmsg)
+        {
+            const int    first = i++;
+            const size_t gso_size = slots[first].size;
+            size_t       total    = gso_size;
+            if (m_bUseGSO)
+            {
+                while (i < size && i - first < MAX_GSO_SEGMENTS && slots[i].size <= gso_size
+                        && total + slots[i].size <= MAX_GSO_BYTES && slots[i].addr == slots[first].addr
+                        && sameSource(slots[i].source, slots[first].source))
+                {
+                    total += slots[i].size;
+                    if (slots[i++].size < gso_size)
+                        break;
+                }
+            }
+
+            msghdr& mh = w_buf.hdrs[nmsg].msg_hdr;
+            mh.msg_name       = (sockaddr*)slots[first].addr.get();
+            mh.msg_namelen    = slots[first].addr.size();
+            mh.msg_iov        = &w_buf.iov[first];
+            mh.msg_iovlen     = i - first;
+            mh.msg_control    = NULL;
+            mh.msg_controllen = 0;
+            mh.msg_flags      = 0;
+            w_buf.npackets[nmsg] = i - first;
+
+            char* ctrl_buf = &w_buf.ctrl[nmsg * CTRL_BUF_SIZE];
+#ifdef SRT_ENABLE_PKTINFO
+            const sockaddr_any& source_addr = slots[first].source;
+            if (m_bBindMasked && source_addr.family() != AF_UNSPEC && !source_addr.isany())
+            {
+                if (!setSourceAddress(mh, ctrl_buf, source_addr))
+                {
+                    LOGC(kslog.Error, log << "CChannel::setSourceAddress: source address invalid family #" << source_addr.family() << ", NOT setting.");
+                }
+            }
+#endif
+            if (i - first > 1)
+            {
+                cmsghdr* cmsg    = (cmsghdr*)(ctrl_buf + mh.msg_controllen);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type  = UDP_SEGMENT;
+                cmsg->cmsg_len   = CMSG_LEN(sizeof(uint16_t));
+                const uint16_t segment = uint16_t(gso_size);
+                memcpy(CMSG_DATA(cmsg), &segment, sizeof segment);
+
+                mh.msg_control = ctrl_buf;
+                mh.msg_controllen += CMSG_SPACE(sizeof(uint16_t));
+            }
+        }
+
+#ifdef SRT_ENABLE_IO_URING
+        const int res = m_mcfg.bUDPIoUring && w_buf.ring.prepare()
+                            ? w_buf.ring.sendmmsg(m_iSocket, &w_buf.hdrs[0], nmsg)
+                            : ::sendmmsg(m_iSocket, &w_buf.hdrs[0], nmsg, 0);
+#else
+        const int res = ::sendmmsg(m_iSocket, &w_buf.hdrs[0], nmsg, 0);
+#endif
+        if (res <= 0)
+        {
+            const int err = NET_ERROR;
+            if (m_bUseGSO && w_buf.npackets[0] > 1 && (err == EIO || err == EINVAL))
+            {
+                // The device doesn't support segmentation offload (e.g. no
+                // checksum offload). Turn it off and resend the packets one by one.
+                LOGC(kslog.Warn, log << CONID() << "sendmmsg: UDP GSO failed: " << SysStrError(err) << " - turning it off");
+                m_bUseGSO = false;
+                continue;
+            }
+
+            // Just like in sendto(), the packets failed to be sent are
+            // simply considered lost.
+            HLOGC(kslog.Debug, log << CONID() << "sendmmsg: " << SysStrError(err) << " - dropping " << w_buf.npackets[0] << " packets");
+            pos += w_buf.npackets[0];
+            continue;
+        }
+
+        for (int m = 0; m < res; ++m)
+        {
+            pos += w_buf.npackets[m];
+            nsent += w_buf.npackets[m];
+        }
+        HLOGC(kslog.Debug, log << CONID() << "sendmmsg: sent " << res << " messages, " << nsent << " of " << size << " packets");
+    }
+#else
+    (void)w_buf;
+    for (int i = 0; i < size; ++i)
+    {
+        const int res = (int)::sendto(m_iSocket, slots[i].data, (int)slots[i].size, 0, slots[i].addr.get(), slots[i].addr.size());
+        if (res >= 0)
+            ++nsent;
+    }
+#endif
+
+    return nsent;
+}
+
+srt::EReadStatus srt::CChannel::completeRead(int recv_size, int msg_flags, CPacket& w_packet) const
+{
     // Sanity check for a case when it didn't fill in even the header
     if (size_t(recv_size) < CPacket::HDR_SIZE)
     {
-        status = RST_AGAIN;
         HLOGC(krlog.Debug,
               log << CONID() << "POSSIBLE ATTACK: received too short packet with " << recv_size << " bytes");
-        goto Return_error;
+        w_packet.setLength(-1);
+        return RST_AGAIN;
     }
 
     // Fix for an issue with Linux Kernel found during tests at Tencent.
@@ -1061,8 +1598,8 @@ srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet
               log << CONID() << "NET ERROR: packet size=" << recv_size << " msg_flags=0x" << hex << msg_flags
                   << ", detected flags:" << flg.str());
 #endif
-        status = RST_AGAIN;
-        goto Return_error;
+        w_packet.setLength(-1);
+        return RST_AGAIN;
     }
 
     w_packet.setLength(recv_size - CPacket::HDR_SIZE);
@@ -1087,8 +1624,16 @@ srt::EReadStatus srt::CChannel::recvfrom(sockaddr_any& w_addr, CPacket& w_packet
     }
 
     return RST_OK;
+}
 
-Return_error:
-    w_packet.setLength(-1);
-    return status;
+srt::sockaddr_any srt::CChannel::inprocSource(const sockaddr_any& target) const
+{
+    // Bound to "any", the datagram comes from the address it was sent to,
+    // as it would over the loopback device.
+    if (!m_BindAddr.isany())
+        return m_BindAddr;
+
+    sockaddr_any source = target;
+    source.hport(m_BindAddr.hport());
+    return source;
 }
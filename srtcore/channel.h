@@ -49,6 +49,10 @@ written by
 modified by
    Haivision Systems Inc.
 *****************************************************************************/
+#ifndef INC_SRT_CHANNEL_H
+#define INC_SRT_CHANNEL_H
+
+#ifndef SRT_ATR_ALIGNAS
 #if HAVE_CXX11
 #define SRT_ATR_ALIGNAS(n) alignas(n)
 #elif HAVE_GCC
@@ -56,18 +60,47 @@ modified by
 #else
 #define SRT_ATR_ALIGNAS(n)
 #endif
-#ifndef INC_SRT_CHANNEL_H
-#define INC_SRT_CHANNEL_H
+#endif
 
 #include "platform_sys.h"
 #include "udt.h"
 #include "packet.h"
 #include "socketconfig.h"
 #include "netinet_any.h"
+#include "sync.h"
+#include "iouring.h"
+#include "inproc.h"
+
+#include <vector>
 
 namespace srt
 {
 
+/// A packet prepared for CChannel::sendto_batch(): the header in the
+/// network order immediately followed by the payload.
+struct CSendSlot
+{
+    sockaddr_any addr;   // destination address
+    sockaddr_any source; // source address (used as in CChannel::sendto())
+    const char*  data;   // header and payload
+    size_t       size;   // total size of the header and payload
+};
+
+/// Buffers used by CChannel::sendto_batch() to compose the system call.
+/// Every thread sending batches must use its own.
+struct CSendBatchBuffers
+{
+#ifdef SRT_ENABLE_MMSG
+    std::vector<mmsghdr> hdrs;
+    std::vector<iovec>   iov;      // One element per packet
+    std::vector<int>     npackets; // Number of packets in each of hdrs
+    std::vector<char>    ctrl;     // Ancillary data buffers for hdrs
+#endif
+#ifdef SRT_ENABLE_IO_URING
+    CIoUring ring; // Used instead of sendmmsg() with SRTO_UDP_IOURING
+#endif
+};
+
 class CChannel
 {
     void createSocket(int family);
@@ -129,9 +162,84 @@ public:
     /// Receive a packet from the channel and record the source address.
     /// @param [in] addr pointer to the source address.
     /// @param [in] packet reference to a CPacket entity.
+    /// @param [in] wait_us maximum time to wait for the packet (see wakeReceiver()).
     /// @return Actual size of data received.
 
-    EReadStatus recvfrom(sockaddr_any& addr, srt::CPacket& packet) const;
+    EReadStatus recvfrom(sockaddr_any& addr, srt::CPacket& packet, int wait_us = RECV_POLL_US) const;
+
+    /// Receive up to @a size packets from the channel in one system call.
+    /// Where batched reading isn't supported, this reads a single packet as recvfrom().
+    /// @param [out] w_addr array of source addresses, one per packet.
+    /// @param [in,out] w_packets array of packets to receive into.
+    /// @param [out] w_status array of per-packet read status (RST_AGAIN for a rejected packet).
+    /// @param [in] size number of elements in each array.
+    /// @param [out] w_nrecv number of packets read (leading elements of the arrays).
+    /// @param [in] wait_us maximum time to wait for the first packet, as in recvfrom().
+    /// @return RST_OK if at least one packet was read, otherwise as recvfrom().
+
+    EReadStatus recvfrom_batch(sockaddr_any* w_addr, srt::CPacket* const* w_packets, EReadStatus* w_status, int size, int& w_nrecv,
+                               int wait_us = RECV_POLL_US) const;
+
+    /// Whether the packets are received with recvfrom_lent() into the packets
+    /// lent to the channel, rather than with recvfrom_batch(). This is the case
+    /// with io_uring (see SRTO_UDP_IOURING), where the kernel places the packets
+    /// in the buffers given in advance. Must be called by the receiving thread.
+    bool receivesLent() const;
+
+    /// Lend a packet to the channel to receive into with recvfrom_lent().
+    /// @param [in] packet packet with RECV_HEADROOM bytes of its buffer free
+    ///             before the payload, and the length set to the payload capacity
+    /// @param [in] id number of the packet, below RECV_LENT_MAX and not used by another packet lent
+
+    void lendRecvPacket(srt::CPacket& packet, int id) const;
+
+    /// Receive up to @a size packets as recvfrom_batch() does, into the packets
+    /// lent with lendRecvPacket(). The packets received into are not lent any longer.
+    /// @param [out] w_addr array of source addresses, one per packet.
+    /// @param [out] w_ids array of numbers of the packets received into.
+    /// @param [out] w_status array of per-packet read status (RST_AGAIN for a rejected packet).
+    /// @param [in] size number of elements in each array.
+    /// @param [out] w_nrecv number of packets read (leading elements of the arrays).
+    /// @param [in] wait_us maximum time to wait for the first packet, as in recvfrom().
+    /// @return RST_OK if at least one packet was read, otherwise as recvfrom().
+
+    EReadStatus recvfrom_lent(sockaddr_any* w_addr, int* w_ids, EReadStatus* w_status, int size, int& w_nrecv,
+                              int wait_us = RECV_POLL_US) const;
+
+#ifdef SRT_ENABLE_IO_URING
+    /// Room needed before the payload of the packets lent for receiving:
+    /// the message is placed after the headroom of the ring, SRT header first.
+    static const size_t RECV_HEADROOM = CIoUring::RECV_HEADROOM + CPacket::HDR_SIZE;
+    static const int    RECV_LENT_MAX = CIoUring::RECV_BUFFERS;
+#else
+    static const size_t RECV_HEADROOM = 0;
+    static const int    RECV_LENT_MAX = 0;
+#endif
+
+    /// Stop the receiving in progress in the system, to be called by the
+    /// receiving thread when it exits, before the channel is closed.
+    /// @return false if the packets lent may still be written into by the
+    /// system, in which case they must not be reused.
+    bool stopReceiving() const;
+
+    /// Make the thread waiting in recvfrom() or recvfrom_batch() return RST_AGAIN
+    /// now, or in the next call if it isn't waiting. Can be called by any thread.
+    void wakeReceiver() const;
+
+    /// The longest wait in recvfrom() where wakeReceiver() can't interrupt
+    /// it (on Windows), and the default wait.
+    static const int RECV_POLL_US = 10000;
+
+    /// Send @a size prepared packets to the channel, using as few system calls as possible.
+    /// Consecutive packets of equal size to the same destination are sent as a single
+    /// segmented datagram where the system supports it (UDP GSO). Where batched sending
+    /// isn't supported, the packets are sent one by one.
+    /// @param [in] slots array of packets to send
+    /// @param [in] size number of elements in @a slots
+    /// @param [in,out] w_buf buffers owned by the calling thread
+    /// @return Number of packets passed to the system (failed ones are treated as lost).
+
+    int sendto_batch(const CSendSlot* slots, int size, CSendBatchBuffers& w_buf) const;
 
     void setConfig(const CSrtMuxerConfig& config);
 
@@ -174,11 +282,51 @@ public:
 private:
     void setUDPSockOpt();
 
+    /// Bind to the in-process link instead of UDP (see SRTO_INPROC_LINK).
+    void openInproc(const sockaddr_any& addr);
+
+    /// The source address of a datagram sent over the in-process link.
+    sockaddr_any inprocSource(const sockaddr_any& target) const;
+
+    /// Check and convert into host order a packet of @a recv_size bytes
+    /// just read from the system. The packet length is set to -1 on failure.
+    /// @return RST_OK if the packet is valid, RST_AGAIN if it should be dropped.
+    EReadStatus completeRead(int recv_size, int msg_flags, srt::CPacket& w_packet) const;
+
+    /// Wait up to @a wait_us for a packet to read, or for wakeReceiver().
+    /// @return as select(): 1 if a packet can be read, 0 if not, -1 on error
+    int waitReadable(int wait_us) const;
+
+    /// Consume the pending wakeReceiver() calls.
+    void drainWakeups() const;
+
 private:
     UDPSOCKET m_iSocket; // socket descriptor
+#ifdef SRT_ENABLE_MMSG
+    // Header array for recvmmsg(). Used exclusively by the receiver
+    // thread, just like the single-packet reading in recvfrom().
+    mutable std::vector<mmsghdr> m_RecvHdrs;
+#ifdef SRT_ENABLE_PKTINFO
+    mutable std::vector<char> m_RecvCtrlBufs; // Ancillary data buffers for m_RecvHdrs.
+#endif
+    mutable sync::atomic<bool> m_bUseGSO; // UDP segmentation offload is supported
+#endif
+#ifdef SRT_ENABLE_IO_URING
+    // Used instead of recvmmsg() with SRTO_UDP_IOURING, by the receiver thread only.
+    mutable CIoUring m_RecvRing;
+    mutable std::vector<srt::CPacket*> m_LentPackets; // Packets lent to m_RecvRing, by number.
+#endif
 #ifdef _WIN32
     mutable WSAOVERLAPPED m_SendOverlapped;
 #endif
+    // Used instead of the UDP socket with SRTO_INPROC_LINK.
+    mutable CInprocEndpoint* m_pInproc;
+#ifndef _WIN32
+    // Pipe waited for together with the socket, written by wakeReceiver().
+    // Both ends are -1 if it couldn't be created.
+    int m_aiWakeFD[2];
+    mutable sync::atomic<bool> m_bWakePending; // A byte is in m_aiWakeFD not yet drained
+#endif
 
     // Mutable because when querying original settings
     // this comprises the cache for extracted values,
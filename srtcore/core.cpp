@@ -61,6 +61,7 @@ modified by
 #include <sstream>
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include "srt.h"
 #include "access_control.h" // Required for SRT_REJX_FALLBACK
 #include "queue.h"
@@ -163,6 +164,13 @@ struct SrtOptionAction
         flags[SRTO_RCVBUF]             = SRTO_R_PREBIND;
         flags[SRTO_UDP_SNDBUF]         = SRTO_R_PREBIND;
         flags[SRTO_UDP_RCVBUF]         = SRTO_R_PREBIND;
+        flags[SRTO_UDP_RCVBATCH]       = SRTO_R_PREBIND;
+        flags[SRTO_UDP_SNDBATCH]       = SRTO_R_PREBIND;
+        flags[SRTO_RCVWORKERS]         = SRTO_R_PREBIND;
+        flags[SRTO_SNDWORKERS]         = SRTO_R_PREBIND;
+        flags[SRTO_RCVUNITS]           = SRTO_R_PREBIND;
+        flags[SRTO_UDP_IOURING]        = SRTO_R_PREBIND;
+        flags[SRTO_INPROC_LINK]        = SRTO_R_PREBIND;
         flags[SRTO_RENDEZVOUS]         = SRTO_R_PRE;
         flags[SRTO_REUSEADDR]          = SRTO_R_PREBIND;
         flags[SRTO_MAXBW]              = SRTO_POST_SPEC;
@@ -201,12 +209,14 @@ struct SrtOptionAction
 #if ENABLE_BONDING
         flags[SRTO_GROUPCONNECT]       = SRTO_R_PRE;
         flags[SRTO_GROUPMINSTABLETIMEO]= SRTO_R_PRE;
+        flags[SRTO_GROUPRCVBUF]        = SRTO_R_PRE;
 #endif
         flags[SRTO_PACKETFILTER]       = SRTO_R_PRE;
         flags[SRTO_RETRANSMITALGO]     = SRTO_R_PRE;
 #ifdef ENABLE_AEAD_API_PREVIEW
         flags[SRTO_CRYPTOMODE]         = SRTO_R_PRE;
 #endif
+        flags[SRTO_CRYPTOAHEAD]        = SRTO_R_PRE;
 
         // For "private" options (not derived from the listener
         // socket by an accepted socket) provide below private_default
@@ -295,9 +305,16 @@ void srt::CUDT::construct()
     m_bPeerTsbPd          = false;
     m_bTsbPd              = false;
     m_bTsbPdAckWakeup     = false;
+    m_bTsbPdPooled        = false;
+#if ENABLE_BONDING
+    m_pTsbPdGroup         = NULL;
+    m_bTsbPdGroupAcquired = false;
+    m_pRcvBufferGroup     = NULL;
+#endif
     m_bGroupTsbPd         = false;
     m_bPeerTLPktDrop      = false;
     m_bBufferWasFull      = false;
+    m_bSndSeqUnscheduled  = false;
 
     // Initilize mutex and condition variables.
     initSynch();
@@ -379,9 +396,27 @@ srt::CUDT::CUDT(CUDTSocket* parent, const CUDT& ancestor)
 
 srt::CUDT::~CUDT()
 {
+    // Normally done already when closing.
+    releaseTsbPdPool();
+
+#if ENABLE_BONDING
+    if (m_pRcvBufferGroup)
+    {
+        ScopedLock cgroup(*m_pRcvBufferGroup->exp_groupLock());
+        m_pRcvBufferGroup->apiRelease();
+    }
+#endif
+
     // release mutex/condtion variables
     destroySynch();
 
+    // The messages still borrowed can't be accessed by the application any longer.
+    for (std::set<RcvLoan*>::iterator i = m_RcvLoans.begin(); i != m_RcvLoans.end(); ++i)
+    {
+        m_pRcvBuffer->releaseBorrowed((*i)->units);
+        delete *i;
+    }
+
     // destroy the data structures
     delete m_pSndBuffer;
     delete m_pRcvBuffer;
@@ -513,6 +548,44 @@ void srt::CUDT::getOpt(SRT_SOCKOPT optName, void *optval, int &optlen)
         optlen         = sizeof(int);
         break;
 
+    case SRTO_UDP_RCVBATCH:
+        *(int *)optval = m_config.iUDPRcvBatch;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_UDP_SNDBATCH:
+        *(int *)optval = m_config.iUDPSndBatch;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_RCVWORKERS:
+        *(int *)optval = m_config.iRcvWorkers;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_SNDWORKERS:
+        *(int *)optval = m_config.iSndWorkers;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_RCVUNITS:
+        *(int *)optval = m_config.iRcvUnits;
+        optlen         = sizeof(int);
+        break;
+
+    case SRTO_UDP_IOURING:
+        *(bool *)optval = m_config.bUDPIoUring;
+        optlen          = sizeof(bool);
+        break;
+
+    case SRTO_INPROC_LINK:
+        if (size_t(optlen) < m_config.sInprocLink.size() + 1)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        optlen = (int)m_config.sInprocLink.copy((char*)optval, (size_t)optlen - 1);
+        ((char*)optval)[optlen] = '\0';
+        break;
+
     case SRTO_RENDEZVOUS:
         *(bool *)optval = m_config.bRendezvous;
         optlen          = sizeof(bool);
@@ -797,6 +870,11 @@ void srt::CUDT::getOpt(SRT_SOCKOPT optName, void *optval, int &optlen)
         *(int*)optval = (int)m_config.uMinStabilityTimeout_ms;
         break;
 
+    case SRTO_GROUPRCVBUF:
+        optlen          = sizeof(bool);
+        *(bool*)optval = m_config.bGroupRcvBuffer;
+        break;
+
     case SRTO_GROUPTYPE:
         optlen         = sizeof (int);
         *(int*)optval = m_HSGroupType;
@@ -840,6 +918,11 @@ void srt::CUDT::getOpt(SRT_SOCKOPT optName, void *optval, int &optlen)
         break;
 #endif
 
+    case SRTO_CRYPTOAHEAD:
+        *(bool *)optval = m_config.bCryptoAhead;
+        optlen          = sizeof(bool);
+        break;
+
     default:
         throw CUDTException(MJ_NOTSUP, MN_NONE, 0);
     }
@@ -956,7 +1039,8 @@ void srt::CUDT::open()
     if (m_pRNode == NULL)
         m_pRNode = new CRNode;
     m_pRNode->m_pUDT      = this;
-    m_pRNode->m_tsTimeStamp = steady_clock::now();
+    m_pRNode->m_llTick    = 0;
+    m_pRNode->m_iSlot     = -1;
     m_pRNode->m_pPrev = m_pRNode->m_pNext = NULL;
     m_pRNode->m_bOnList                   = false;
 
@@ -3434,7 +3518,8 @@ void srt::CUDT::synchronizeWithGroup(CUDTGroup* gp)
 
     // These are the values that are normally set initially by setters.
     int32_t snd_isn = m_iSndLastAck, rcv_isn = m_iRcvLastAck;
-    if (!gp->applyGroupSequences(m_SocketID, (snd_isn), (rcv_isn)))
+    const bool first_member = gp->applyGroupSequences(m_SocketID, (snd_isn), (rcv_isn));
+    if (!first_member)
     {
         HLOGC(gmlog.Debug,
                 log << CONID() << "synchronizeWithGroup: DERIVED ISN: RCV=%" << m_iRcvLastAck << " -> %" << rcv_isn
@@ -3449,6 +3534,16 @@ void srt::CUDT::synchronizeWithGroup(CUDTGroup* gp)
                 log << CONID() << "synchronizeWithGroup: DEFINED ISN: RCV=%" << m_iRcvLastAck << " SND=%"
                 << m_iSndLastAck);
     }
+
+    // The group receiver buffer relies on the TSBPD thread dropping
+    // the packets that no member has delivered in time (live mode).
+    if (m_config.bGroupRcvBuffer && m_bTsbPd && m_bTLPktDrop && !m_pRcvBufferGroup
+            && gp->rcvBufferAttach(this, first_member))
+    {
+        // Released in the destructor; the receiving thread may still be using it until then.
+        gp->apiAcquire();
+        m_pRcvBufferGroup = gp;
+    }
 }
 #endif
 
@@ -5386,6 +5481,9 @@ void * srt::CUDT::tsbpd(void* param)
     // deleted until this thread exits.
     // NOTE: DO NOT LEAD TO EVER CANCEL THE THREAD!!!
     CUDTUnited::GroupKeeper gkeeper(self->uglobal(), self->m_parent);
+    CUDTGroup* group = gkeeper.group;
+#else
+    CUDTGroup* group = NULL;
 #endif
 
     CUniqueSync recvdata_lcc (self->m_RecvLock, self->m_RecvDataCond);
@@ -5394,113 +5492,184 @@ void * srt::CUDT::tsbpd(void* param)
     self->m_bTsbPdAckWakeup = true;
     while (!self->m_bClosing)
     {
-        steady_clock::time_point tsNextDelivery; // Next packet delivery time
-        bool                     rxready = false;
+        INCREMENT_THREAD_ITERATIONS();
+
+        const steady_clock::time_point tsNextDelivery = self->tsbpdDeliver(recvdata_lcc, group);
+
+        // We may just briefly unlocked the m_RecvLock, so we need to check m_bClosing again to avoid deadlock.
+        if (self->m_bClosing)
+            break;
+
+        THREAD_PAUSED();
+        if (!is_zero(tsNextDelivery))
+            tsbpd_cc.wait_until(tsNextDelivery);
+        else
+            tsbpd_cc.wait();
+        THREAD_RESUMED();
+
+        HLOGC(tslog.Debug, log << self->CONID() << "tsbpd: WAKE UP!!!");
+    }
+    THREAD_EXIT();
+    HLOGC(tslog.Debug, log << self->CONID() << "tsbpd: EXITING");
+    return NULL;
+}
+
+srt::CUDT::time_point srt::CUDT::tsbpdPoolRound()
+{
+#if ENABLE_BONDING
+    // Like the TSBPD thread, keep the group from being deleted until
+    // the socket is removed from the pool.
+    if (!m_bTsbPdGroupAcquired)
+    {
+        m_pTsbPdGroup         = uglobal().acquireSocketsGroup(m_parent);
+        m_bTsbPdGroupAcquired = true;
+    }
+    CUDTGroup* group = m_pTsbPdGroup;
+#else
+    CUDTGroup* group = NULL;
+#endif
+
+    CUniqueSync recvdata_lcc (m_RecvLock, m_RecvDataCond);
+    if (m_bClosing)
+        return time_point();
+
+    return tsbpdDeliver(recvdata_lcc, group);
+}
+
+void srt::CUDT::releaseTsbPdPool()
+{
+    if (!m_bTsbPdPooled)
+        return;
+
+    uglobal().m_TsbPdPool.remove(this);
+    m_bTsbPdPooled = false;
+
 #if ENABLE_BONDING
-        bool shall_update_group = false;
+    if (m_pTsbPdGroup)
+    {
+        ScopedLock cgroup(*m_pTsbPdGroup->exp_groupLock());
+        m_pTsbPdGroup->apiRelease();
+    }
+    m_pTsbPdGroup         = NULL;
+    m_bTsbPdGroupAcquired = false;
 #endif
+}
 
-        INCREMENT_THREAD_ITERATIONS();
+void srt::CUDT::wakeTsbPdPool()
+{
+    if (m_bTsbPdPooled)
+        uglobal().m_TsbPdPool.wake(this);
+}
+
+srt::CUDT::time_point srt::CUDT::tsbpdDeliver(CUniqueSync& recvdata_lcc, CUDTGroup* group SRT_ATR_UNUSED)
+{
+    steady_clock::time_point tsNextDelivery; // Next packet delivery time
+    bool                     rxready = false;
+    steady_clock::time_point tsNextGroupCheck; // Next delivery time if the group has read the packets already
+#if ENABLE_BONDING
+    bool shall_update_group = false;
+#endif
 
-        enterCS(self->m_RcvBufferLock);
-        const steady_clock::time_point tnow = steady_clock::now();
+    enterCS(m_RcvBufferLock);
+    const steady_clock::time_point tnow = steady_clock::now();
 
-        self->m_pRcvBuffer->updRcvAvgDataSize(tnow);
-        const srt::CRcvBuffer::PacketInfo info = self->m_pRcvBuffer->getFirstValidPacketInfo();
+    m_pRcvBuffer->updRcvAvgDataSize(tnow);
+    const srt::CRcvBuffer::PacketInfo info = m_pRcvBuffer->getFirstValidPacketInfo();
 
-        const bool is_time_to_deliver = !is_zero(info.tsbpd_time) && (tnow >= info.tsbpd_time);
-        tsNextDelivery = info.tsbpd_time;
+    const bool is_time_to_deliver = !is_zero(info.tsbpd_time) && (tnow >= info.tsbpd_time);
+    tsNextDelivery = info.tsbpd_time;
 
-        if (!self->m_bTLPktDrop)
-        {
-            rxready = !info.seq_gap && is_time_to_deliver;
-        }
-        else if (is_time_to_deliver)
+    if (!m_bTLPktDrop)
+    {
+        rxready = !info.seq_gap && is_time_to_deliver;
+    }
+    else if (is_time_to_deliver)
+    {
+        rxready = true;
+        if (info.seq_gap)
         {
-            rxready = true;
-            if (info.seq_gap)
-            {
-                const int iDropCnt SRT_ATR_UNUSED = self->rcvDropTooLateUpTo(info.seqno);
+            const int iDropCnt SRT_ATR_UNUSED = rcvDropTooLateUpTo(info.seqno);
 #if ENABLE_BONDING
-                shall_update_group = true;
+            shall_update_group = true;
 #endif
 
 #if ENABLE_LOGGING
-                const int64_t timediff_us = count_microseconds(tnow - info.tsbpd_time);
+            const int64_t timediff_us = count_microseconds(tnow - info.tsbpd_time);
 #if ENABLE_HEAVY_LOGGING
-                HLOGC(tslog.Debug,
-                    log << self->CONID() << "tsbpd: DROPSEQ: up to seqno %" << CSeqNo::decseq(info.seqno) << " ("
-                    << iDropCnt << " packets) playable at " << FormatTime(info.tsbpd_time) << " delayed "
-                    << (timediff_us / 1000) << "." << std::setw(3) << std::setfill('0') << (timediff_us % 1000) << " ms");
+            HLOGC(tslog.Debug,
+                log << CONID() << "tsbpd: DROPSEQ: up to seqno %" << CSeqNo::decseq(info.seqno) << " ("
+                << iDropCnt << " packets) playable at " << FormatTime(info.tsbpd_time) << " delayed "
+                << (timediff_us / 1000) << "." << std::setw(3) << std::setfill('0') << (timediff_us % 1000) << " ms");
 #endif
-                string why;
-                if (self->frequentLogAllowed(FREQLOGFA_RCV_DROPPED, tnow, (why)))
-                {
-                    LOGC(brlog.Warn, log << self->CONID() << "RCV-DROPPED " << iDropCnt << " packet(s). Packet seqno %" << info.seqno
-                            << " delayed for " << (timediff_us / 1000) << "." << std::setw(3) << std::setfill('0')
-                            << (timediff_us % 1000) << " ms " << why);
-                }
+            string why;
+            if (frequentLogAllowed(FREQLOGFA_RCV_DROPPED, tnow, (why)))
+            {
+                LOGC(brlog.Warn, log << CONID() << "RCV-DROPPED " << iDropCnt << " packet(s). Packet seqno %" << info.seqno
+                        << " delayed for " << (timediff_us / 1000) << "." << std::setw(3) << std::setfill('0')
+                        << (timediff_us % 1000) << " ms " << why);
+            }
 #if SRT_ENABLE_FREQUENT_LOG_TRACE
-                else
-                {
-                    LOGC(brlog.Warn, log << "SUPPRESSED: RCV-DROPPED LOG: " << why);
-                }
+            else
+            {
+                LOGC(brlog.Warn, log << "SUPPRESSED: RCV-DROPPED LOG: " << why);
+            }
 #endif
 #endif
 
-                tsNextDelivery = steady_clock::time_point(); // Ready to read, nothing to wait for.
-            }
+            tsNextDelivery = steady_clock::time_point(); // Ready to read, nothing to wait for.
         }
-        leaveCS(self->m_RcvBufferLock);
+    }
+    leaveCS(m_RcvBufferLock);
 
-        if (rxready)
+    if (rxready)
+    {
+        HLOGC(tslog.Debug,
+            log << CONID() << "tsbpd: PLAYING PACKET seq=" << info.seqno << " (belated "
+            << (count_milliseconds(steady_clock::now() - info.tsbpd_time)) << "ms)");
+        /*
+         * There are packets ready to be delivered
+         * signal a waiting "recv" call if there is any data available
+         */
+        if (m_config.bSynRecving)
         {
-            HLOGC(tslog.Debug,
-                log << self->CONID() << "tsbpd: PLAYING PACKET seq=" << info.seqno << " (belated "
-                << (count_milliseconds(steady_clock::now() - info.tsbpd_time)) << "ms)");
-            /*
-             * There are packets ready to be delivered
-             * signal a waiting "recv" call if there is any data available
-             */
-            if (self->m_config.bSynRecving)
-            {
-                recvdata_lcc.notify_one();
-            }
-            /*
-             * Set EPOLL_IN to wakeup any thread waiting on epoll
-             */
-            self->uglobal().m_EPoll.update_events(self->m_SocketID, self->m_sPollID, SRT_EPOLL_IN, true);
+            recvdata_lcc.notify_one();
+        }
+        /*
+         * Set EPOLL_IN to wakeup any thread waiting on epoll
+         */
+        uglobal().m_EPoll.update_events(m_SocketID, m_sPollID, SRT_EPOLL_IN, true);
 #if ENABLE_BONDING
-            // If this is NULL, it means:
-            // - the socket never was a group member
-            // - the socket was a group member, but:
-            //    - was just removed as a part of closure
-            //    - and will never be member of the group anymore
-
-            // If this is not NULL, it means:
-            // - This socket is currently member of the group
-            // - This socket WAS a member of the group, though possibly removed from it already, BUT:
-            //   - the group that this socket IS OR WAS member of is in the GroupKeeper
-            //   - the GroupKeeper prevents the group from being deleted
-            //   - it is then completely safe to access the group here,
-            //     EVEN IF THE SOCKET THAT WAS ITS MEMBER IS BEING DELETED.
-
-            // It is ensured that the group object exists here because GroupKeeper
-            // keeps it busy, even if you just closed the socket, remove it as a member
-            // or even the group is empty and was explicitly closed.
-            if (gkeeper.group)
+        // If this is NULL, it means:
+        // - the socket never was a group member
+        // - the socket was a group member, but:
+        //    - was just removed as a part of closure
+        //    - and will never be member of the group anymore
+
+        // If this is not NULL, it means:
+        // - This socket is currently member of the group
+        // - This socket WAS a member of the group, though possibly removed from it already, BUT:
+        //   - the group that this socket IS OR WAS member of is in the GroupKeeper
+        //   - the GroupKeeper prevents the group from being deleted
+        //   - it is then completely safe to access the group here,
+        //     EVEN IF THE SOCKET THAT WAS ITS MEMBER IS BEING DELETED.
+
+        // It is ensured that the group object exists here because GroupKeeper
+        // keeps it busy, even if you just closed the socket, remove it as a member
+        // or even the group is empty and was explicitly closed.
+        if (group)
+        {
             {
                 // Functions called below will lock m_GroupLock, which in hierarchy
                 // lies after m_RecvLock. Must unlock m_RecvLock to be able to lock
                 // m_GroupLock inside the calls.
-                InvertedLock unrecv(self->m_RecvLock);
+                InvertedLock unrecv(m_RecvLock);
                 // The current "APP reader" needs to simply decide as to whether
                 // the next CUDTGroup::recv() call should return with no blocking or not.
                 // When the group is read-ready, it should update its pollers as it sees fit.
 
                 // NOTE: this call will set lock to m_IncludedGroup->m_GroupLock
-                HLOGC(tslog.Debug, log << self->CONID() << "tsbpd: GROUP: checking if %" << info.seqno << " makes group readable");
-                gkeeper.group->updateReadState(self->m_SocketID, info.seqno);
+                HLOGC(tslog.Debug, log << CONID() << "tsbpd: GROUP: checking if %" << info.seqno << " makes group readable");
+                group->updateReadState(m_SocketID, info.seqno);
 
                 if (shall_update_group)
                 {
@@ -5508,58 +5677,52 @@ void * srt::CUDT::tsbpd(void* param)
                     // should it have any. Pass the current socket position in order
                     // to skip it from the group loop.
                     // NOTE: SELF LOCKING.
-                    gkeeper.group->updateLatestRcv(self->m_parent);
+                    group->updateLatestRcv(m_parent);
                 }
             }
-#endif
-            CGlobEvent::triggerEvent();
-            tsNextDelivery = steady_clock::time_point(); // Ready to read, nothing to wait for.
-        }
-
-        // We may just briefly unlocked the m_RecvLock, so we need to check m_bClosing again to avoid deadlock.
-        if (self->m_bClosing)
-            break;
 
-        if (!is_zero(tsNextDelivery))
-        {
-            IF_HEAVY_LOGGING(const steady_clock::duration timediff = tsNextDelivery - tnow);
-            /*
-             * Buffer at head of queue is not ready to play.
-             * Schedule wakeup when it will be.
-             */
-            self->m_bTsbPdAckWakeup = false;
-            HLOGC(tslog.Debug,
-                log << self->CONID() << "tsbpd: FUTURE PACKET seq=" << info.seqno
-                << " T=" << FormatTime(tsNextDelivery) << " - waiting " << count_milliseconds(timediff) << "ms");
-            THREAD_PAUSED();
-            tsbpd_cc.wait_until(tsNextDelivery);
-            THREAD_RESUMED();
-        }
-        else
-        {
-            /*
-             * We have just signaled epoll; or
-             * receive queue is empty; or
-             * next buffer to deliver is not in receive queue (missing packet in sequence).
-             *
-             * Block until woken up by one of the following event:
-             * - All ready-to-play packets have been pulled and EPOLL_IN cleared (then loop to block until next pkt time
-             * if any)
-             * - New buffers ACKed
-             * - Closing the connection
-             */
-            HLOGC(tslog.Debug, log << self->CONID() << "tsbpd: no data, scheduling wakeup at ack");
-            self->m_bTsbPdAckWakeup = true;
-            THREAD_PAUSED();
-            tsbpd_cc.wait();
-            THREAD_RESUMED();
+            // With m_RecvLock released the reader could have extracted the packets
+            // and an ACK could have come in the meantime, both signaling the TSBPD
+            // thread when it wasn't waiting. Don't wait for another signal then.
+            ScopedLock lck(m_RcvBufferLock);
+            if (!m_pRcvBuffer->isRcvDataReady(steady_clock::now()))
+                tsNextGroupCheck = m_pRcvBuffer->getFirstValidPacketInfo().tsbpd_time;
         }
+#endif
+        CGlobEvent::triggerEvent();
+        tsNextDelivery = tsNextGroupCheck; // Ready to read, nothing to wait for (unless read in the meantime).
+    }
 
-        HLOGC(tslog.Debug, log << self->CONID() << "tsbpd: WAKE UP!!!");
+    if (!is_zero(tsNextDelivery))
+    {
+        IF_HEAVY_LOGGING(const steady_clock::duration timediff = tsNextDelivery - tnow);
+        /*
+         * Buffer at head of queue is not ready to play.
+         * Schedule wakeup when it will be.
+         */
+        m_bTsbPdAckWakeup = false;
+        HLOGC(tslog.Debug,
+            log << CONID() << "tsbpd: FUTURE PACKET seq=" << info.seqno
+            << " T=" << FormatTime(tsNextDelivery) << " - waiting " << count_milliseconds(timediff) << "ms");
     }
-    THREAD_EXIT();
-    HLOGC(tslog.Debug, log << self->CONID() << "tsbpd: EXITING");
-    return NULL;
+    else
+    {
+        /*
+         * We have just signaled epoll; or
+         * receive queue is empty; or
+         * next buffer to deliver is not in receive queue (missing packet in sequence).
+         *
+         * Block until woken up by one of the following event:
+         * - All ready-to-play packets have been pulled and EPOLL_IN cleared (then loop to block until next pkt time
+         * if any)
+         * - New buffers ACKed
+         * - Closing the connection
+         */
+        HLOGC(tslog.Debug, log << CONID() << "tsbpd: no data, scheduling wakeup at ack");
+        m_bTsbPdAckWakeup = true;
+    }
+
+    return tsNextDelivery;
 }
 
 int srt::CUDT::rcvDropTooLateUpTo(int seqno)
@@ -5568,9 +5731,13 @@ int srt::CUDT::rcvDropTooLateUpTo(int seqno)
     if (CSeqNo::seqcmp(seqno, CSeqNo::incseq(m_iRcvCurrSeqNo)) > 0)
         seqno = CSeqNo::incseq(m_iRcvCurrSeqNo);
 
+    // The buffer start is moved first: the receiving thread records the losses without
+    // m_RcvBufferLock, and either before the loss lists are cleaned here, or after, clipped
+    // to the new start (see recordRcvLoss()).
+    const int iDropCnt = m_pRcvBuffer->dropUpTo(seqno);
+
     dropFromLossLists(SRT_SEQNO_NONE, CSeqNo::decseq(seqno));
 
-    const int iDropCnt = m_pRcvBuffer->dropUpTo(seqno);
     if (iDropCnt > 0)
     {
         enterCS(m_StatsLock);
@@ -6138,8 +6305,35 @@ void srt::CUDT::checkSndKMRefresh()
 {
     // Do not apply the regenerated key to the to the receiver context.
     const bool bidir = false;
-    if (m_pCryptoControl)
-        m_pCryptoControl->regenCryptoKm(this, bidir);
+
+    // The KM request sent is retransmitted by the timer checks until answered.
+    if (m_pCryptoControl && m_pCryptoControl->regenCryptoKm(this, bidir))
+        rescheduleTimers();
+}
+
+bool srt::CUDT::sndEncryptsInPlace() const
+{
+    return m_pCryptoControl && m_pCryptoControl->getSndCryptoFlags() != EK_NOENC;
+}
+
+srt::CCryptoControl* srt::CUDT::sndCryptoAhead()
+{
+    // The blocks added by srt_sendfile have no sequence number, which is needed
+    // for encrypting, so from then on they are all encrypted when sent.
+    if (!m_config.bCryptoAhead || m_bSndSeqUnscheduled || !m_pCryptoControl)
+        return NULL;
+
+    // AES-GCM authenticates also the header fields that are set when sending.
+    if (m_pCryptoControl->getCryptoMode() == CSrtConfig::CIPHER_MODE_AES_GCM)
+        return NULL;
+
+#if ENABLE_BONDING
+    // The group members can have the sequence number overridden when sending.
+    if (m_parent->m_GroupOf)
+        return NULL;
+#endif
+
+    return m_pCryptoControl.get();
 }
 
 void srt::CUDT::addressAndSend(CPacket& w_pkt)
@@ -6210,7 +6404,7 @@ bool srt::CUDT::closeInternal()
 
     // remove this socket from the snd queue
     if (m_bConnected)
-        m_pSndQueue->m_pSndUList->remove(this);
+        m_pSndQueue->listOf(this)->remove(this);
 
     /*
      * update_events below useless
@@ -6220,42 +6414,14 @@ bool srt::CUDT::closeInternal()
      * it would remove the socket from the EPoll after close.
      */
 
-    // Make a copy under a lock because other thread might access it
-    // at the same time.
-    enterCS(uglobal().m_EPoll.m_EPollLock);
-    set<int> epollid = m_sPollID;
-    leaveCS(uglobal().m_EPoll.m_EPollLock);
-
     // trigger any pending IO events.
-    HLOGC(smlog.Debug, log << CONID() << "close: SETTING ERR readiness on E" << Printable(epollid));
+    HLOGC(smlog.Debug, log << CONID() << "close: SETTING ERR readiness");
     uglobal().m_EPoll.update_events(m_SocketID, m_sPollID, SRT_EPOLL_ERR, true);
-    // then remove itself from all epoll monitoring
-    int no_events = 0;
-    for (set<int>::iterator i = epollid.begin(); i != epollid.end(); ++i)
-    {
-        HLOGC(smlog.Debug, log << CONID() << "close: CLEARING subscription on E" << (*i));
-        try
-        {
-            uglobal().m_EPoll.update_usock(*i, m_SocketID, &no_events);
-        }
-        catch (...)
-        {
-            // The goal of this loop is to remove all subscriptions in
-            // the epoll system to this socket. If it's unsubscribed already,
-            // that's even better.
-        }
-        HLOGC(smlog.Debug, log << CONID() << "close: removing E" << (*i) << " from back-subscribers");
-    }
-
-    // Not deleting elements from m_sPollID inside the loop because it invalidates
-    // the control iterator of the loop. Instead, all will be removed at once.
 
     // IMPORTANT: there's theoretically little time between setting ERR readiness
     // and unsubscribing, however if there's an application waiting on this event,
-    // it should be informed before this below instruction locks the epoll mutex.
-    enterCS(uglobal().m_EPoll.m_EPollLock);
-    m_sPollID.clear();
-    leaveCS(uglobal().m_EPoll.m_EPollLock);
+    // it should be informed before removeEPolls() locks the epoll mutex.
+    removeEPolls();
 
     // XXX What's this, could any of the above actions make it !m_bOpened?
     if (!m_bOpened)
@@ -6265,6 +6431,7 @@ bool srt::CUDT::closeInternal()
 
     // Inform the threads handler to stop.
     m_bClosing = true;
+    rescheduleTimers();
 
     HLOGC(smlog.Debug, log << CONID() << "CLOSING STATE. Acquiring connection lock");
 
@@ -6315,14 +6482,17 @@ bool srt::CUDT::closeInternal()
     ScopedLock sendguard(m_SendLock);
     ScopedLock recvguard(m_RecvLock);
 
-    // Locking m_RcvBufferLock to protect calling to m_pCryptoControl->decrypt((packet))
+    // Locking m_RcvCryptoLock to protect calling to m_pCryptoControl->decrypt((packet))
     // from the processData(...) function while resetting Crypto Control.
-    enterCS(m_RcvBufferLock);
+    // Likewise m_SndCryptoLock for encrypting in packUniqueData(...).
+    enterCS(m_RcvCryptoLock);
+    enterCS(m_SndCryptoLock);
     if (m_pCryptoControl)
         m_pCryptoControl->close();
 
     m_pCryptoControl.reset();
-    leaveCS(m_RcvBufferLock);
+    leaveCS(m_SndCryptoLock);
+    leaveCS(m_RcvCryptoLock);
 
     m_uPeerSrtVersion        = SRT_VERSION_UNK;
     m_tsRcvPeerStartTime     = steady_clock::time_point();
@@ -6437,6 +6607,7 @@ int srt::CUDT::receiveBuffer(char *data, int len)
     {
         HLOGP(tslog.Debug, "Ping TSBPD thread to schedule wakeup");
         tscond.notify_one_locked(recvguard);
+        wakeTsbPdPool();
     }
     else
     {
@@ -6557,8 +6728,32 @@ int srt::CUDT::sendmsg(const char *data, int len, int msttl, bool inorder, int64
 // [[using maybe_locked(CUDTGroup::m_GroupLock, m_parent->m_GroupOf != NULL)]]
 // GroupLock is applied when this function is called from inside CUDTGroup::send,
 // which is the only case when the m_parent->m_GroupOf is not NULL.
-int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
+int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl, srt_send_release_fn* release, void* opaque)
+{
+    SRT_IOVEC iov;
+    iov.base = const_cast<char*>(data);
+    iov.len  = len > 0 ? len : 0;
+    return sendMessage(&iov, 1, len, (w_mctrl), release, opaque);
+}
+
+int srt::CUDT::sendmsgv(const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL& w_mctrl)
+{
+    const int len = CIoVecCursor::totalSize(iov, iovcnt);
+    if (len < 0)
+    {
+        LOGC(aslog.Error, log << CONID() << "INVALID: blocks for sending: " << iovcnt << ", total size exceeds the limit or NULL buffer");
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+    }
+
+    return sendMessage(iov, iovcnt, len, (w_mctrl), NULL, NULL);
+}
+
+int srt::CUDT::sendMessage(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl,
+                           srt_send_release_fn* release, void* opaque)
 {
+    // The user buffer as a whole, when it's a single block (always the case with release).
+    const char* data = static_cast<const char*>(iov[0].base);
+
     // throw an exception if not connected
     if (m_bBroken || m_bClosing)
         throw CUDTException(MJ_CONNECTION, MN_CONNLOST, 0);
@@ -6741,7 +6936,8 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
 
     // If the sender's buffer is empty,
     // record total time used for sending
-    if (m_pSndBuffer->getCurrBufSize() == 0)
+    const bool snd_was_empty = m_pSndBuffer->getCurrBufSize() == 0;
+    if (snd_was_empty)
     {
         ScopedLock lock(m_StatsLock);
         m_stats.sndDurationCounter = steady_clock::now();
@@ -6757,8 +6953,10 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
         size = min(len, sndBuffersLeft() * m_iMaxSRTPayloadSize);
     }
 
+    bool release_now = false;
     {
-        ScopedLock recvAckLock(m_RecvAckLock);
+        ScopedLock cryptoLock(m_SndCryptoLock);
+        UniqueLock recvAckLock(m_RecvAckLock);
         // insert the user buffer into the sending list
 
         int32_t seqno = m_iSndNextSeqNo;
@@ -6782,6 +6980,8 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
             {
                 HLOGC(aslog.Debug, log << CONID() << "sock:SENDING (NOT): group-req %" << w_mctrl.pktseq
                         << " OLDER THAN next expected %" << seqno << " - FAKE-SENDING.");
+                if (release)
+                    release(opaque, data, size);
                 return size;
             }
         }
@@ -6798,7 +6998,7 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
         HLOGC(aslog.Debug, log << CONID() << "buf:SENDING (BEFORE) srctime:"
                 << (w_mctrl.srctime ? FormatTime(ts_srctime) : "none")
                 << " DATA SIZE: " << size << " sched-SEQUENCE: " << seqno
-                << " STAMP: " << BufferStamp(data, size));
+                << " STAMP: " << BufferStamp(data, min<size_t>(size, iov[0].len)));
 
         if (w_mctrl.srctime && w_mctrl.srctime < count_microseconds(m_stats.tsStartTime.time_since_epoch()))
         {
@@ -6821,13 +7021,40 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
         // - OUTPUT: value of the sequence number to be put on the first packet at the next sendmsg2 call.
         // We need to supply to the output the value that was STAMPED ON THE PACKET,
         // which is seqno. In the output we'll get the next sequence number.
-        m_pSndBuffer->addBuffer(data, size, (w_mctrl));
+        CCryptoControl* const   crypto = sndCryptoAhead();
+        CSndBuffer::Reservation reserved;
+        if (release && !sndEncryptsInPlace())
+        {
+            m_pSndBuffer->addBuffer(data, size, (w_mctrl), release, opaque);
+        }
+        else
+        {
+            // With encryption the payload is encrypted in place in the sender buffer,
+            // so the user buffer can't be referred to.
+            if (crypto)
+                m_pSndBuffer->reserveBuffer(iov, iovcnt, size, (w_mctrl), (reserved));
+            else
+                m_pSndBuffer->addBuffer(iov, iovcnt, size, (w_mctrl));
+            release_now = (release != NULL);
+        }
         m_iSndNextSeqNo = w_mctrl.pktseq;
         w_mctrl.pktseq = seqno;
 
         HLOGC(aslog.Debug, log << CONID() << "buf:SENDING srctime:" << FormatTime(ts_srctime)
               << " size=" << size << " #" << w_mctrl.msgno << " SCHED %" << orig_seqno
-              << "(>> %" << seqno << ") !" << BufferStamp(data, size));
+              << "(>> %" << seqno << ") !" << BufferStamp(data, min<size_t>(size, iov[0].len)));
+
+        if (crypto)
+        {
+            // The sequence numbers are scheduled, and the packets are not available for
+            // sending until committed, so the sending and the ACK processing need not wait
+            // for the encryption. Only m_SndCryptoLock is kept to keep the keys in place,
+            // and m_SendLock keeps the other insertions out.
+            recvAckLock.unlock();
+            m_pSndBuffer->encryptBuffer(reserved, *crypto);
+            m_pSndBuffer->commitBuffer(reserved);
+            recvAckLock.lock();
+        }
 
         if (sndBuffersLeft() < 1) // XXX Not sure if it should test if any space in the buffer, or as requried.
         {
@@ -6836,9 +7063,16 @@ int srt::CUDT::sendmsg2(const char *data, int len, SRT_MSGCTRL& w_mctrl)
         }
     }
 
+    if (release_now)
+        release(opaque, data, size);
+
     // Insert this socket to the snd list if it is not on the list already.
     // m_pSndUList->pop may lock CSndUList::m_ListLock and then m_RecvAckLock
-    m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+    m_pSndQueue->listOf(this)->update(this, CSndUList::DONT_RESCHEDULE);
+
+    // The retransmission timer runs only with data in the sender's buffer.
+    if (snd_was_empty)
+        rescheduleTimers();
 
 #ifdef SRT_ENABLE_ECN
     // IF there was a packet drop on the sender side, report congestion to the app.
@@ -6898,17 +7132,126 @@ int srt::CUDT::recvmsg2(char* data, int len, SRT_MSGCTRL& w_mctrl)
     return receiveBuffer(data, len);
 }
 
-// [[using locked(m_RcvBufferLock)]]
-size_t srt::CUDT::getAvailRcvBufferSizeNoLock() const
+int srt::CUDT::recvmsgv(const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL& w_mctrl)
 {
-    return m_pRcvBuffer->getAvailSize(m_iRcvLastAck);
-}
+#if ENABLE_BONDING
+    if (m_parent->m_GroupOf && m_parent->m_GroupOf->isGroupReceiver())
+    {
+        LOGP(arlog.Error, "recv*: This socket is a receiver group member. Use group ID, NOT socket ID.");
+        throw CUDTException(MJ_NOTSUP, MN_INVALMSGAPI, 0);
+    }
+#endif
 
-bool srt::CUDT::isRcvBufferReady() const
-{
-    ScopedLock lck(m_RcvBufferLock);
-    return m_pRcvBuffer->isRcvDataReady(steady_clock::now());
-}
+    if (!m_bConnected || !m_CongCtl.ready())
+        throw CUDTException(MJ_CONNECTION, MN_NOCONN, 0);
+
+    const int len = CIoVecCursor::totalSize(iov, iovcnt);
+    if (len <= 0)
+    {
+        LOGC(arlog.Error, log << CONID() << "Blocks supplied to srt_recvmsgv: " << iovcnt << ", total size: " << len);
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+    }
+
+    if (!m_config.bMessageAPI)
+    {
+        LOGC(arlog.Error, log << CONID() << "srt_recvmsgv: only message mode is supported.");
+        throw CUDTException(MJ_NOTSUP, MN_INVALBUFFERAPI, 0);
+    }
+
+    return receiveMessage(iov, iovcnt, len, (w_mctrl), CUDTUnited::ERH_THROW, NULL);
+}
+
+int srt::CUDT::recvmsgBorrow(SRT_MSGLOAN& w_loan, SRT_MSGCTRL& w_mctrl)
+{
+#if ENABLE_BONDING
+    if (m_parent->m_GroupOf && m_parent->m_GroupOf->isGroupReceiver())
+    {
+        LOGP(arlog.Error, "recv*: This socket is a receiver group member. Use group ID, NOT socket ID.");
+        throw CUDTException(MJ_NOTSUP, MN_INVALMSGAPI, 0);
+    }
+#endif
+
+    if (!m_bConnected || !m_CongCtl.ready())
+        throw CUDTException(MJ_CONNECTION, MN_NOCONN, 0);
+
+    if (!m_config.bMessageAPI)
+    {
+        LOGC(arlog.Error, log << CONID() << "srt_recvmsg_borrow: only message mode is supported.");
+        throw CUDTException(MJ_NOTSUP, MN_INVALBUFFERAPI, 0);
+    }
+
+    RcvLoan* loan = new RcvLoan;
+    int      res  = 0;
+    try
+    {
+        // The size is not used for borrowing, but it must satisfy the checks of any congctl.
+        res = receiveMessage(NULL, std::numeric_limits<int>::max(), (w_mctrl), CUDTUnited::ERH_THROW, &loan->units);
+    }
+    catch (...)
+    {
+        // A message may have been extracted before the connection was found broken.
+        m_pRcvBuffer->releaseBorrowed(loan->units);
+        delete loan;
+        throw;
+    }
+
+    if (res <= 0)
+    {
+        m_pRcvBuffer->releaseBorrowed(loan->units);
+        delete loan;
+        return res;
+    }
+
+    loan->segments.resize(loan->units.size());
+    for (size_t i = 0; i < loan->units.size(); ++i)
+    {
+        const CPacket& packet  = loan->units[i]->m_Packet;
+        loan->segments[i].data = packet.m_pcData;
+        loan->segments[i].len  = (int) packet.getLength();
+    }
+
+    {
+        ScopedLock lk(m_RcvLoansLock);
+        m_RcvLoans.insert(loan);
+    }
+
+    w_loan.segments  = &loan->segments[0];
+    w_loan.nsegments = (int) loan->segments.size();
+    w_loan.handle    = loan;
+    return res;
+}
+
+void srt::CUDT::recvmsgRelease(SRT_MSGLOAN& w_loan)
+{
+    RcvLoan* loan = static_cast<RcvLoan*>(w_loan.handle);
+    {
+        ScopedLock lk(m_RcvLoansLock);
+        if (!loan || m_RcvLoans.erase(loan) == 0)
+        {
+            LOGC(arlog.Error, log << CONID() << "srt_recvmsg_release: the message was not borrowed from this socket.");
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+        }
+    }
+
+    m_pRcvBuffer->releaseBorrowed(loan->units);
+    delete loan;
+
+    w_loan.segments  = NULL;
+    w_loan.nsegments = 0;
+    w_loan.handle    = NULL;
+}
+
+// [[using locked(m_RcvBufferLock)]]
+size_t srt::CUDT::getAvailRcvBufferSizeNoLock() const
+{
+    return m_pRcvBuffer->getAvailSize(m_iRcvLastAck);
+}
+
+bool srt::CUDT::isRcvBufferReady() const
+{
+    ScopedLock lck(m_RcvBufferLock);
+    return m_pRcvBuffer->isRcvDataReady(steady_clock::now());
+}
 
 bool srt::CUDT::isRcvBufferReadyNoLock() const
 {
@@ -6919,7 +7262,16 @@ bool srt::CUDT::isRcvBufferReadyNoLock() const
 // - 0 - by return value
 // - 1 - by exception
 // - 2 - by abort (unused)
-int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_exception)
+int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_exception, std::vector<CUnit*>* w_borrowed)
+{
+    SRT_IOVEC iov;
+    iov.base = data;
+    iov.len  = len > 0 ? len : 0;
+    return receiveMessage(&iov, 1, len, (w_mctrl), by_exception, w_borrowed);
+}
+
+int srt::CUDT::receiveMessage(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_mctrl, int by_exception,
+                              std::vector<CUnit*>* w_borrowed)
 {
     // Recvmsg isn't restricted to the congctl type, it's the most
     // basic method of passing the data. You can retrieve data as
@@ -6932,7 +7284,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
     // is only used internally, we state that the problem that would be
     // handled by exception here should not happen, and in case if it does,
     // it's a bug to fix, so the exception is nothing wrong.
-    if (!m_CongCtl->checkTransArgs(SrtCongestion::STA_MESSAGE, SrtCongestion::STAD_RECV, data, len, SRT_MSGTTL_INF, false))
+    if (!m_CongCtl->checkTransArgs(SrtCongestion::STA_MESSAGE, SrtCongestion::STAD_RECV, static_cast<char*>(iov[0].base), len, SRT_MSGTTL_INF, false))
         throw CUDTException(MJ_NOTSUP, MN_INVALMSGAPI, 0);
 
     UniqueLock recvguard (m_RecvLock);
@@ -6956,7 +7308,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
         HLOGC(arlog.Debug, log << CONID() << "receiveMessage: CONNECTION BROKEN - reading from recv buffer just for formality");
         enterCS(m_RcvBufferLock);
         const int res = (m_pRcvBuffer->isRcvDataReady(steady_clock::now()))
-            ? m_pRcvBuffer->readMessage(data, len, &w_mctrl)
+            ? m_pRcvBuffer->readMessage(iov, iovcnt, &w_mctrl, w_borrowed)
             : 0;
         leaveCS(m_RcvBufferLock);
 
@@ -6965,6 +7317,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
         {
             HLOGP(tslog.Debug, "Ping TSBPD thread to schedule wakeup");
             tscond.notify_one_locked(recvguard);
+            wakeTsbPdPool();
         }
         else
         {
@@ -6995,7 +7348,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
         HLOGC(arlog.Debug, log << CONID() << "receiveMessage: BEGIN ASYNC MODE. Going to extract payload size=" << len);
         enterCS(m_RcvBufferLock);
         const int res = (m_pRcvBuffer->isRcvDataReady(steady_clock::now()))
-            ? m_pRcvBuffer->readMessage(data, len, &w_mctrl)
+            ? m_pRcvBuffer->readMessage(iov, iovcnt, &w_mctrl, w_borrowed)
             : 0;
         leaveCS(m_RcvBufferLock);
         HLOGC(arlog.Debug, log << CONID() << "AFTER readMsg: (NON-BLOCKING) result=" << res);
@@ -7008,6 +7361,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
             {
                 HLOGP(arlog.Debug, "receiveMessage: nothing to read, kicking TSBPD, return AGAIN");
                 tscond.notify_one_locked(recvguard);
+                wakeTsbPdPool();
             }
             else
             {
@@ -7029,6 +7383,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
             {
                 HLOGP(arlog.Debug, "receiveMessage: DATA READ, but nothing more - kicking TSBPD.");
                 tscond.notify_one_locked(recvguard);
+                wakeTsbPdPool();
             }
             else
             {
@@ -7073,6 +7428,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
 
                 HLOGC(tslog.Debug, log << CONID() << "receiveMessage: KICK tsbpd");
                 tscond.notify_one_locked(recvguard);
+                wakeTsbPdPool();
             }
 
             THREAD_PAUSED();
@@ -7114,7 +7470,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
                 */
 
         enterCS(m_RcvBufferLock);
-        res = m_pRcvBuffer->readMessage((data), len, &w_mctrl);
+        res = m_pRcvBuffer->readMessage(iov, iovcnt, &w_mctrl, w_borrowed);
         leaveCS(m_RcvBufferLock);
         HLOGC(arlog.Debug, log << CONID() << "AFTER readMsg: (BLOCKING) result=" << res);
 
@@ -7150,6 +7506,7 @@ int srt::CUDT::receiveMessage(char* data, int len, SRT_MSGCTRL& w_mctrl, int by_
         {
             HLOGP(tslog.Debug, "recvmsg: KICK tsbpd() (buffer empty)");
             tscond.notify_one_locked(recvguard);
+            wakeTsbPdPool();
         }
 
         // Shut up EPoll if no more messages in non-blocking mode
@@ -7264,7 +7621,8 @@ int64_t srt::CUDT::sendfile(fstream &ifs, int64_t &offset, int64_t size, int blo
         }
 
         // record total time used for sending
-        if (m_pSndBuffer->getCurrBufSize() == 0)
+        const bool snd_was_empty = m_pSndBuffer->getCurrBufSize() == 0;
+        if (snd_was_empty)
         {
             ScopedLock lock(m_StatsLock);
             m_stats.sndDurationCounter = steady_clock::now();
@@ -7272,6 +7630,7 @@ int64_t srt::CUDT::sendfile(fstream &ifs, int64_t &offset, int64_t size, int blo
 
         {
             ScopedLock        recvAckLock(m_RecvAckLock);
+            m_bSndSeqUnscheduled = true;
             const int64_t sentsize = m_pSndBuffer->addBufferFromFile(ifs, unitsize);
 
             if (sentsize > 0)
@@ -7288,7 +7647,11 @@ int64_t srt::CUDT::sendfile(fstream &ifs, int64_t &offset, int64_t size, int blo
         }
 
         // insert this socket to snd list if it is not on the list yet
-        m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+        m_pSndQueue->listOf(this)->update(this, CSndUList::DONT_RESCHEDULE);
+
+        // The retransmission timer runs only with data in the sender's buffer.
+        if (snd_was_empty)
+            rescheduleTimers();
     }
 
     return size - tosend;
@@ -7534,6 +7897,14 @@ void srt::CUDT::bstats(CBytePerfMon *perf, bool clear, bool instantaneous)
 
     perf->mbpsBandwidth = Bps2Mbps(availbw * (m_iMaxSRTPayloadSize + pktHdrSize));
 
+    if (m_pRcvQueue)
+    {
+        const CUnitQueue* uq      = m_pRcvQueue->m_pUnitQueue;
+        perf->pktRcvUnitsCapacity = uq->capacity();
+        perf->pktRcvUnitsInUse    = uq->numTaken();
+        perf->pktRcvUnitsMaxInUse = uq->maxTaken();
+    }
+
     if (tryEnterCS(m_ConnectionLock))
     {
         if (m_pSndBuffer)
@@ -7722,6 +8093,8 @@ void srt::CUDT::initSynch()
     setupMutex(m_RcvLossLock, "RcvLoss");
     setupMutex(m_RecvAckLock, "RecvAck");
     setupMutex(m_RcvBufferLock, "RcvBuffer");
+    setupMutex(m_RcvCryptoLock, "RcvCrypto");
+    setupMutex(m_SndCryptoLock, "SndCrypto");
     setupMutex(m_ConnectionLock, "Connection");
     setupMutex(m_StatsLock, "Stats");
     setupCond(m_RcvTsbPdCond, "RcvTsbPd");
@@ -7745,6 +8118,8 @@ void srt::CUDT::destroySynch()
     releaseMutex(m_RcvLossLock);
     releaseMutex(m_RecvAckLock);
     releaseMutex(m_RcvBufferLock);
+    releaseMutex(m_RcvCryptoLock);
+    releaseMutex(m_SndCryptoLock);
     releaseMutex(m_ConnectionLock);
     releaseMutex(m_StatsLock);
 
@@ -7764,6 +8139,7 @@ void srt::CUDT::releaseSynch()
     // Awake tsbpd() and srt_recv*(..) threads for them to check m_bClosing.
     CSync::lock_notify_one(m_RecvDataCond, m_RecvLock);
     CSync::lock_notify_one(m_RcvTsbPdCond, m_RecvLock);
+    wakeTsbPdPool();
 
     // Azquiring m_RcvTsbPdStartupLock protects race in starting
     // the tsbpd() thread in CUDT::processData().
@@ -7773,6 +8149,8 @@ void srt::CUDT::releaseSynch()
     {
         m_RcvTsbPdThread.join();
     }
+    // Wait likewise until the shared pool finishes with this socket.
+    releaseTsbPdPool();
     leaveCS(m_RcvTsbPdStartupLock);
 
     // Acquiring the m_RecvLock it is assumed that both tsbpd()
@@ -8143,7 +8521,10 @@ int srt::CUDT::sendCtrlAck(CPacket& ctrlpkt, int size)
             CUniqueSync tslcc (m_RecvLock, m_RcvTsbPdCond);
             // m_bTsbPdAckWakeup is protected by m_RecvLock in the tsbpd() thread
             if (m_bTsbPdAckWakeup)
+            {
                 tslcc.notify_one();
+                wakeTsbPdPool();
+            }
         }
         else
         {
@@ -8353,7 +8734,7 @@ void srt::CUDT::updateSndLossListOnACK(int32_t ackdata_seqno)
 
     // insert this socket to snd list if it is not on the list yet
     const steady_clock::time_point currtime = steady_clock::now();
-    m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE, currtime);
+    m_pSndQueue->listOf(this)->update(this, CSndUList::DONT_RESCHEDULE, currtime);
 
     if (m_config.bSynSending)
     {
@@ -8457,7 +8838,7 @@ void srt::CUDT::processCtrlAck(const CPacket &ctrlpkt, const steady_clock::time_
         const int cwnd    = std::min(int(m_iFlowWindowSize), int(m_dCongestionWindow));
         if (bWasStuck && cwnd > getFlightSpan())
         {
-            m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+            m_pSndQueue->listOf(this)->update(this, CSndUList::DONT_RESCHEDULE);
             HLOGC(gglog.Debug,
                     log << CONID() << "processCtrlAck: could reschedule SND. iFlowWindowSize " << m_iFlowWindowSize
                     << " SPAN " << getFlightSpan() << " ackdataseqno %" << ackdata_seqno);
@@ -8729,6 +9110,10 @@ void srt::CUDT::processCtrlLossReport(const CPacket& ctrlpkt)
     {
         ScopedLock ack_lock(m_RecvAckLock);
 
+        // The ranges are collected and inserted into the sender loss list at once.
+        CSndLossList::ranges_t lost;
+        lost.reserve(losslist_len);
+
         // decode loss list message and insert loss into the sender loss list
         for (int i = 0, n = (int)losslist_len; i < n; ++i)
         {
@@ -8757,13 +9142,12 @@ void srt::CUDT::processCtrlLossReport(const CPacket& ctrlpkt)
                     break;
                 }
 
-                int num = 0;
                 // IF losslist_lo %>= m_iSndLastAck
                 if (CSeqNo::seqcmp(losslist_lo, m_iSndLastAck) >= 0)
                 {
                     HLOGC(inlog.Debug, log << CONID() << "LOSSREPORT: adding "
                         << losslist_lo << " - " << losslist_hi << " to loss list");
-                    num = m_pSndLossList->insert(losslist_lo, losslist_hi);
+                    lost.push_back(std::make_pair(losslist_lo, losslist_hi));
                 }
                 // ELSE losslist_lo %< m_iSndLastAck
                 else
@@ -8787,7 +9171,7 @@ void srt::CUDT::processCtrlLossReport(const CPacket& ctrlpkt)
                     {
                         HLOGC(inlog.Debug, log << CONID() << "LOSSREPORT: adding "
                                 << m_iSndLastAck << "[ACK] - " << losslist_hi << " to loss list");
-                        num = m_pSndLossList->insert(m_iSndLastAck, losslist_hi);
+                        lost.push_back(std::make_pair(int32_t(m_iSndLastAck), losslist_hi));
                         dropreq_hi = CSeqNo::decseq(m_iSndLastAck);
                         IF_HEAVY_LOGGING(drop_type = "partially");
                     }
@@ -8806,10 +9190,6 @@ void srt::CUDT::processCtrlLossReport(const CPacket& ctrlpkt)
                               << ": %" << losslist_lo << "-" << dropreq_hi << " - sending DROPREQ");
                     sendCtrl(UMSG_DROPREQ, &no_msgno, seqpair, sizeof(seqpair));
                 }
-
-                enterCS(m_StatsLock);
-                m_stats.sndr.lost.count(num);
-                leaveCS(m_StatsLock);
             }
             // ELSE the loss is a single seq
             else
@@ -8829,11 +9209,7 @@ void srt::CUDT::processCtrlLossReport(const CPacket& ctrlpkt)
 
                     HLOGC(inlog.Debug,
                             log << CONID() << "LOSSREPORT: adding %" << losslist[i] << " (1 packet) to loss list");
-                    const int num = m_pSndLossList->insert(losslist[i], losslist[i]);
-
-                    enterCS(m_StatsLock);
-                    m_stats.sndr.lost.count(num);
-                    leaveCS(m_StatsLock);
+                    lost.push_back(std::make_pair(losslist[i], losslist[i]));
                 }
                 // ELSE loss_seq %< m_iSndLastAck
                 else
@@ -8849,6 +9225,13 @@ void srt::CUDT::processCtrlLossReport(const CPacket& ctrlpkt)
                 }
             }
         }
+
+        // Also the losses decoded before a wrong one are taken.
+        const int num = m_pSndLossList->insert(lost);
+
+        enterCS(m_StatsLock);
+        m_stats.sndr.lost.count(num);
+        leaveCS(m_StatsLock);
     }
 
     updateCC(TEV_LOSSREPORT, EventVariant(losslist, losslist_len));
@@ -8865,7 +9248,7 @@ void srt::CUDT::processCtrlLossReport(const CPacket& ctrlpkt)
     }
 
     // the lost packet (retransmission) should be sent out immediately
-    m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+    m_pSndQueue->listOf(this)->update(this, CSndUList::DONT_RESCHEDULE);
 
     enterCS(m_StatsLock);
     m_stats.sndr.recvdNak.count(1);
@@ -9031,6 +9414,7 @@ void srt::CUDT::processCtrlDropReq(const CPacket& ctrlpkt)
         {
             HLOGP(inlog.Debug, "DROPREQ: signal TSBPD");
             rcvtscc.notify_one();
+            wakeTsbPdPool();
         }
     }
 
@@ -9703,6 +10087,7 @@ bool srt::CUDT::packUniqueData(CPacket& w_packet)
 {
     int current_sequence_number; // reflexing variable
     int kflg;
+    bool encrypted_ahead = false;
     time_point tsOrigin;
     int pld_size;
 
@@ -9719,14 +10104,12 @@ bool srt::CUDT::packUniqueData(CPacket& w_packet)
             return false;
         }
 
-        // XXX Here it's needed to set kflg to msgno_bitset in the block stored in the
-        // send buffer. This should be somehow avoided, the crypto flags should be set
-        // together with encrypting, and the packet should be sent as is, when rexmitting.
-        // It would be nice to research as to whether CSndBuffer::Block::m_iMsgNoBitset field
-        // isn't a useless redundant state copy. If it is, then taking the flags here can be removed.
+        // The crypto flags are set to msgno_bitset in the block stored in the send buffer,
+        // so that the packet is sent as is when rexmitting. If the block was encrypted
+        // when added to the buffer (SRTO_CRYPTOAHEAD), it has the flags set already.
         kflg = m_pCryptoControl->getSndCryptoFlags();
         int pktskipseqno = 0;
-        pld_size = m_pSndBuffer->readData((w_packet), (tsOrigin), kflg, (pktskipseqno));
+        pld_size = m_pSndBuffer->readData((w_packet), (tsOrigin), kflg, (pktskipseqno), (encrypted_ahead));
         if (pktskipseqno)
         {
             // Some packets were skipped due to TTL expiry.
@@ -9819,6 +10202,15 @@ bool srt::CUDT::packUniqueData(CPacket& w_packet)
                   << " over SCHEDULING sequence " << w_packet.m_iSeqNo << " for socket not in group:"
                   << " DIFF=" << CSeqNo::seqcmp(current_sequence_number, w_packet.m_iSeqNo)
                   << " STAMP=" << BufferStamp(w_packet.m_pcData, w_packet.getLength()));
+        // The payload encrypted in advance is valid only with the scheduling sequence.
+        if (encrypted_ahead && w_packet.m_iSeqNo != current_sequence_number)
+        {
+            LOGC(qslog.Error,
+                 log << CONID() << "IPE: packUniqueData: EXTRACTION sequence " << current_sequence_number
+                     << " differs from SCHEDULING sequence " << w_packet.m_iSeqNo
+                     << " of a packet encrypted in advance, the peer will fail to decrypt it");
+        }
+
         // Do this always when not in a group.
         w_packet.m_iSeqNo = current_sequence_number;
     }
@@ -9827,20 +10219,39 @@ bool srt::CUDT::packUniqueData(CPacket& w_packet)
     w_packet.m_iID = m_PeerID; // Destination SRT Socket ID
     setDataPacketTS(w_packet, tsOrigin);
 
-    if (kflg != EK_NOENC)
+    if (kflg != EK_NOENC && !encrypted_ahead)
     {
+        // Only with SRTO_CRYPTOAHEAD the application thread encrypts as well,
+        // otherwise the encryption is done only here.
+        const bool shared_crypto = m_config.bCryptoAhead;
+        if (shared_crypto)
+            enterCS(m_SndCryptoLock);
+
         // Note that the packet header must have a valid seqno set, as it is used as a counter for encryption.
         // Other fields of the data packet header (e.g. timestamp, destination socket ID) are not used for the counter.
         // Cypher may change packet length!
-        if (m_pCryptoControl->encrypt((w_packet)) != ENCS_CLEAR)
+        const bool encrypted = m_pCryptoControl->encrypt((w_packet)) == ENCS_CLEAR;
+        if (encrypted)
+            checkSndKMRefresh();
+
+        if (shared_crypto)
+            leaveCS(m_SndCryptoLock);
+
+        if (!encrypted)
         {
             // Encryption failed
             //>>Add stats for crypto failure
             LOGC(qslog.Warn, log << CONID() << "ENCRYPT FAILED - packet won't be sent, size=" << pld_size);
             return false;
         }
-
+    }
+    else if (encrypted_ahead && w_packet.getMsgCryptoFlags() == kflg && tryEnterCS(m_SndCryptoLock))
+    {
+        // The key refresh is still done when sending, and only once the packets encrypted
+        // with the previous key are all sent, as a refresh may regenerate that key.
+        // If the lock is busy, the application is encrypting, and a later packet does it.
         checkSndKMRefresh();
+        leaveCS(m_SndCryptoLock);
     }
 
 #if SRT_DEBUG_TRACE_SND
@@ -9868,6 +10279,7 @@ void srt::CUDT::processClose()
     {
         HLOGP(smlog.Debug, "processClose: lock-and-signal TSBPD");
         CSync::lock_notify_one(m_RcvTsbPdCond, m_RecvLock);
+        wakeTsbPdPool();
     }
 
     // Signal the sender and recver if they are waiting for data.
@@ -9959,15 +10371,28 @@ bool srt::CUDT::overrideSndSeqNo(int32_t seq)
 
 int srt::CUDT::checkLazySpawnTsbPdThread()
 {
+#if ENABLE_BONDING
+    // The group receiver buffer has its own TSBPD thread.
+    if (m_pRcvBufferGroup)
+        return 0;
+#endif
     const bool need_tsbpd = m_bTsbPd || m_bGroupTsbPd;
 
-    if (need_tsbpd && !m_RcvTsbPdThread.joinable())
+    if (need_tsbpd && !m_RcvTsbPdThread.joinable() && !m_bTsbPdPooled)
     {
         ScopedLock lock(m_RcvTsbPdStartupLock);
 
         if (m_bClosing) // Check again to protect join() in CUDT::releaseSync()
             return -1;
 
+        if (uglobal().m_TsbPdPool.running())
+        {
+            HLOGP(qrlog.Debug, "Adding socket to the shared TSBPD pool");
+            m_bTsbPdPooled = true;
+            uglobal().m_TsbPdPool.add(this);
+            return 0;
+        }
+
         HLOGP(qrlog.Debug, "Spawning Socket TSBPD thread");
 #if ENABLE_HEAVY_LOGGING
         std::ostringstream tns1, tns2;
@@ -9993,7 +10418,49 @@ CUDT::time_point srt::CUDT::getPktTsbPdTime(void*, const CPacket& packet)
 
 SRT_ATR_UNUSED static const char *const s_rexmitstat_str[] = {"ORIGINAL", "REXMITTED", "RXS-UNKNOWN"};
 
-// [[using locked(m_RcvBufferLock)]]
+void srt::CUDT::decryptIncoming(const vector<CUnit*>& incoming, int32_t bufseq, vector<EncryptionStatus>& w_status)
+{
+    w_status.assign(incoming.size(), ENCS_NOTSUP);
+
+    vector<CPacket*> packets;
+    vector<size_t>   which;
+    for (size_t i = 0; i < incoming.size(); ++i)
+    {
+        CPacket&      pkt    = incoming[i]->m_Packet;
+        const int32_t bufidx = CSeqNo::seqoff(bufseq, pkt.m_iSeqNo);
+        if (pkt.getMsgCryptoFlags() == EK_NOENC || bufidx < 0 || bufidx >= int(m_pRcvBuffer->capacity())
+                || CSeqNo::seqcmp(pkt.m_iSeqNo, m_iRcvLastAck) < 0 || m_pRcvBuffer->hasPacket(pkt.m_iSeqNo))
+            continue;
+        packets.push_back(&pkt);
+        which.push_back(i);
+    }
+
+    if (packets.empty())
+        return;
+
+    ScopedLock cryptolock(m_RcvCryptoLock);
+    if (!m_pCryptoControl)
+        return;
+
+    // Reset retransmission flag (must be excluded from GCM auth tag).
+    vector<char> retransmitted(packets.size());
+    for (size_t k = 0; k < packets.size(); ++k)
+    {
+        retransmitted[k] = m_bPeerRexmitFlag && packets[k]->getRexmitFlag();
+        packets[k]->setRexmitFlag(false);
+    }
+
+    vector<EncryptionStatus> status(packets.size());
+    m_pCryptoControl->decrypt(&packets[0], int(packets.size()), &status[0]);
+
+    for (size_t k = 0; k < packets.size(); ++k)
+    {
+        packets[k]->setRexmitFlag(retransmitted[k] != 0); // Recover the flag.
+        w_status[which[k]] = status[k];
+    }
+}
+
+// The receiver buffer is locked here only when needed, see CRcvBuffer::insertNeedsLock().
 int srt::CUDT::handleSocketPacketReception(const vector<CUnit*>& incoming, bool& w_new_inserted, bool& w_was_sent_in_order, CUDT::loss_seqs_t& w_srt_loss_seqs)
 {
     bool excessive SRT_ATR_UNUSED = true; // stays true unless it was successfully added
@@ -10001,6 +10468,12 @@ int srt::CUDT::handleSocketPacketReception(const vector<CUnit*>& incoming, bool&
     w_new_inserted = false;
     const int32_t bufseq = m_pRcvBuffer->getStartSeqNo();
 
+    // The packets rebuilt by the packet filter come together with the received one,
+    // then they are decrypted at once.
+    vector<EncryptionStatus> batch_status;
+    if (incoming.size() > 1)
+        decryptIncoming(incoming, bufseq, (batch_status));
+
     // Loop over all incoming packets that were filtered out.
     // In case when there is no filter, there's just one packet in 'incoming',
     // the one that came in the input of this function.
@@ -10084,6 +10557,7 @@ int srt::CUDT::handleSocketPacketReception(const vector<CUnit*>& incoming, bool&
             }
             else
             {
+                ScopedLock lck(m_RcvBufferLock);
                 LOGC(qrlog.Warn, log << CONID() << "No room to store incoming packet seqno " << rpkt.m_iSeqNo
                         << ", insert offset " << bufidx << ". "
                         << m_pRcvBuffer->strFullnessState(m_iRcvLastAck, steady_clock::now())
@@ -10093,14 +10567,83 @@ int srt::CUDT::handleSocketPacketReception(const vector<CUnit*>& incoming, bool&
             }
         }
 
-        const int buffer_add_result = m_pRcvBuffer->insert(u);
-        if (buffer_add_result < 0)
+#if ENABLE_BONDING
+        CUDTGroup* const rcvgroup = m_pRcvBufferGroup;
+#else
+        CUDTGroup* const rcvgroup = NULL;
+#endif
+
+        // Decrypt before inserting, as the packet can be read as soon as it is in the buffer.
+        // A redundant packet is not decrypted (and if it is corrupted, the stored one is not dropped).
+        // With the group receiver buffer the packet is redundant also if received over another member.
+#if ENABLE_BONDING
+        const bool redundant = rcvgroup ? rcvgroup->rcvBufferHasPacket(rpkt.m_iSeqNo) : m_pRcvBuffer->hasPacket(rpkt.m_iSeqNo);
+#else
+        const bool redundant = m_pRcvBuffer->hasPacket(rpkt.m_iSeqNo);
+#endif
+        EncryptionStatus rc = ENCS_CLEAR;
+        bool unencrypted = false; // Unencrypted packets are not allowed with AES-GCM.
+        if (!redundant)
+        {
+            ScopedLock cryptolock(m_RcvCryptoLock);
+            const EncryptionStatus batched = batch_status.empty() ? ENCS_NOTSUP : batch_status[unitIt - incoming.begin()];
+            if (batched != ENCS_NOTSUP)
+            {
+                rc = batched;
+            }
+            else if (u->m_Packet.getMsgCryptoFlags() != EK_NOENC)
+            {
+                // TODO: reset and restore the timestamp if TSBPD is disabled.
+                // Reset retransmission flag (must be excluded from GCM auth tag).
+                u->m_Packet.setRexmitFlag(false);
+                rc = m_pCryptoControl ? m_pCryptoControl->decrypt((u->m_Packet)) : ENCS_NOTSUP;
+                u->m_Packet.setRexmitFlag(retransmitted); // Recover the flag.
+            }
+            else if (m_pCryptoControl && m_pCryptoControl->getCryptoMode() == CSrtConfig::CIPHER_MODE_AES_GCM)
+            {
+                unencrypted = true;
+            }
+        }
+
+        int buffer_add_result = -1;
+#if ENABLE_BONDING
+        if (rcvgroup)
+        {
+            if (!redundant && rc == ENCS_CLEAR && !unencrypted)
+                buffer_add_result = rcvgroup->rcvBufferInsert(u);
+
+            // The member's buffer stays empty, but its TSBPD time base has
+            // to follow the timestamps for the drift shared with the group.
+            ScopedLock lck(m_RcvBufferLock);
+            m_pRcvBuffer->updateTsbPdTimeBase(rpkt.getMsgTimeStamp());
+        }
+        else
+#endif
+        if (!redundant && rc == ENCS_CLEAR && !unencrypted)
+        {
+            const bool lock_buffer = m_pRcvBuffer->insertNeedsLock();
+            if (lock_buffer)
+                enterCS(m_RcvBufferLock);
+            buffer_add_result = m_pRcvBuffer->insert(u);
+            if (lock_buffer)
+                leaveCS(m_RcvBufferLock);
+        }
+
+        if (redundant || (buffer_add_result < 0 && rc == ENCS_CLEAR && !unencrypted))
         {
             // The insert() result is -1 if at the position evaluated from this packet's
             // sequence number there already is a packet.
             // So this packet is "redundant".
             IF_HEAVY_LOGGING(exc_type = "UNACKED");
             adding_successful = false;
+
+            // A packet already received over another group member is still
+            // new for this member, which has to detect its own losses.
+            if (rcvgroup && CSeqNo::seqcmp(rpkt.m_iSeqNo, m_iRcvCurrSeqNo) > 0)
+            {
+                adding_successful = true;
+                w_new_inserted    = true;
+            }
         }
         else
         {
@@ -10108,56 +10651,54 @@ int srt::CUDT::handleSocketPacketReception(const vector<CUnit*>& incoming, bool&
 
             IF_HEAVY_LOGGING(exc_type = "ACCEPTED");
             excessive = false;
-            if (u->m_Packet.getMsgCryptoFlags() != EK_NOENC)
+            if (rc != ENCS_CLEAR)
             {
-                // TODO: reset and restore the timestamp if TSBPD is disabled.
-                // Reset retransmission flag (must be excluded from GCM auth tag).
-                u->m_Packet.setRexmitFlag(false);
-                const EncryptionStatus rc = m_pCryptoControl ? m_pCryptoControl->decrypt((u->m_Packet)) : ENCS_NOTSUP;
-                u->m_Packet.setRexmitFlag(retransmitted); // Recover the flag.
+                adding_successful = false;
+                IF_HEAVY_LOGGING(exc_type = "UNDECRYPTED");
+
+                // If TSBPD is disabled, then SRT either operates in buffer mode, of in message API without a restriction
+                // of a single message packet. In that case just dropping a packet is not enough.
+                // In message mode the whole message has to be dropped.
+                // However, when decryption fails the message number in the packet cannot be trusted.
+                // The packet has to be removed from the RCV buffer based on that pkt sequence number,
+                // and the sequence number itself must go into the RCV loss list.
+                // See issue ##2626.
+                SRT_ASSERT(m_bTsbPd);
+
+                // Drop the packet from the receiver buffer (it was not inserted, but the position is marked dropped).
+                // The sequence number is used, as the message number can't be trusted.
+                // A drawback is that it would prevent a valid packet with the same sequence number, if it happens to arrive later, to end up in the buffer.
+                int iDropCnt = 0;
+                {
+                    ScopedLock lck(m_RcvBufferLock);
+                    iDropCnt = m_pRcvBuffer->dropMessage(u->m_Packet.getSeqNo(), u->m_Packet.getSeqNo(), SRT_MSGNO_NONE, CRcvBuffer::DROP_EXISTING);
+                }
 
-                if (rc != ENCS_CLEAR)
+                const steady_clock::time_point tnow = steady_clock::now();
+                ScopedLock lg(m_StatsLock);
+                m_stats.rcvr.dropped.count(stats::BytesPackets(iDropCnt * rpkt.getLength(), iDropCnt));
+                m_stats.rcvr.undecrypted.count(stats::BytesPackets(rpkt.getLength(), 1));
+                string why;
+                if (frequentLogAllowed(FREQLOGFA_ENCRYPTION_FAILURE, tnow, (why)))
                 {
-                    adding_successful = false;
-                    IF_HEAVY_LOGGING(exc_type = "UNDECRYPTED");
-
-                    // If TSBPD is disabled, then SRT either operates in buffer mode, of in message API without a restriction
-                    // of a single message packet. In that case just dropping a packet is not enough.
-                    // In message mode the whole message has to be dropped.
-                    // However, when decryption fails the message number in the packet cannot be trusted.
-                    // The packet has to be removed from the RCV buffer based on that pkt sequence number,
-                    // and the sequence number itself must go into the RCV loss list.
-                    // See issue ##2626.
-                    SRT_ASSERT(m_bTsbPd);
-
-                    // Drop the packet from the receiver buffer.
-                    // The packet was added to the buffer based on the sequence number, therefore sequence number should be used to drop it from the buffer.
-                    // A drawback is that it would prevent a valid packet with the same sequence number, if it happens to arrive later, to end up in the buffer.
-                    const int iDropCnt = m_pRcvBuffer->dropMessage(u->m_Packet.getSeqNo(), u->m_Packet.getSeqNo(), SRT_MSGNO_NONE, CRcvBuffer::DROP_EXISTING);
-
-                    const steady_clock::time_point tnow = steady_clock::now();
-                    ScopedLock lg(m_StatsLock);
-                    m_stats.rcvr.dropped.count(stats::BytesPackets(iDropCnt * rpkt.getLength(), iDropCnt));
-                    m_stats.rcvr.undecrypted.count(stats::BytesPackets(rpkt.getLength(), 1));
-                    string why;
-                    if (frequentLogAllowed(FREQLOGFA_ENCRYPTION_FAILURE, tnow, (why)))
-                    {
-                        LOGC(qrlog.Warn, log << CONID() << "Decryption failed (seqno %" << u->m_Packet.getSeqNo() << "), dropped "
-                            << iDropCnt << ". pktRcvUndecryptTotal=" << m_stats.rcvr.undecrypted.total.count() << "." << why);
-                    }
+                    LOGC(qrlog.Warn, log << CONID() << "Decryption failed (seqno %" << u->m_Packet.getSeqNo() << "), dropped "
+                        << iDropCnt << ". pktRcvUndecryptTotal=" << m_stats.rcvr.undecrypted.total.count() << "." << why);
+                }
 #if SRT_ENABLE_FREQUENT_LOG_TRACE
-                    else
-                    {
+                else
+                {
 
-                        LOGC(qrlog.Warn, log << "SUPPRESSED: Decryption failed LOG: " << why);
-                    }
-#endif
+                    LOGC(qrlog.Warn, log << "SUPPRESSED: Decryption failed LOG: " << why);
                 }
+#endif
             }
-            else if (m_pCryptoControl && m_pCryptoControl->getCryptoMode() == CSrtConfig::CIPHER_MODE_AES_GCM)
+            else if (unencrypted)
             {
-                // Unencrypted packets are not allowed.
-                const int iDropCnt = m_pRcvBuffer->dropMessage(u->m_Packet.getSeqNo(), u->m_Packet.getSeqNo(), SRT_MSGNO_NONE, CRcvBuffer::DROP_EXISTING);
+                int iDropCnt = 0;
+                {
+                    ScopedLock lck(m_RcvBufferLock);
+                    iDropCnt = m_pRcvBuffer->dropMessage(u->m_Packet.getSeqNo(), u->m_Packet.getSeqNo(), SRT_MSGNO_NONE, CRcvBuffer::DROP_EXISTING);
+                }
 
                 const steady_clock::time_point tnow = steady_clock::now();
                 ScopedLock lg(m_StatsLock);
@@ -10433,10 +10974,9 @@ int srt::CUDT::processData(CUnit* in_unit)
     }
 
     {
-        // Start of offset protected section
-        // Prevent TsbPd thread from modifying Ack position while adding data
-        // offset from RcvLastAck in RcvBuffer must remain valid between seqoff() and addData()
-        UniqueLock recvbuf_acklock(m_RcvBufferLock);
+        // The receiver buffer is not locked here: packets are inserted concurrently
+        // with reading (see CRcvBuffer::insert()), and a packet found belated
+        // by the buffer after the offset was checked is rejected like a redundant one.
         // Needed for possibly check for needsQuickACK.
         const bool incoming_belated = (CSeqNo::seqcmp(in_unit->m_Packet.m_iSeqNo, m_pRcvBuffer->getStartSeqNo()) < 0);
 
@@ -10445,13 +10985,15 @@ int srt::CUDT::processData(CUnit* in_unit)
                 (was_sent_in_order),
                 (srt_loss_seqs));
 
+        // The units rebuilt by the packet filter were reserved for this call only.
+        for (vector<CUnit*>::const_iterator i = incoming.begin(); i != incoming.end(); ++i)
+        {
+            if (*i != in_unit)
+                m_pRcvQueue->m_pUnitQueue->releaseUnit(*i);
+        }
+
         if (res == -2)
         {
-            // This is a scoped lock with AckLock, but for the moment
-            // when processClose() is called this lock must be taken out,
-            // otherwise this will cause a deadlock. We don't need this
-            // lock anymore, and at 'return' it will be unlocked anyway.
-            recvbuf_acklock.unlock();
             processClose();
 
             return -1;
@@ -10464,21 +11006,7 @@ int srt::CUDT::processData(CUnit* in_unit)
 
         if (!srt_loss_seqs.empty())
         {
-            ScopedLock lock(m_RcvLossLock);
-
-            HLOGC(qrlog.Debug,
-                  log << CONID() << "processData: RECORDING LOSS: " << Printable(srt_loss_seqs)
-                      << " tolerance=" << initial_loss_ttl);
-
-            for (loss_seqs_t::iterator i = srt_loss_seqs.begin(); i != srt_loss_seqs.end(); ++i)
-            {
-                m_pRcvLossList->insert(i->first, i->second);
-                if (initial_loss_ttl)
-                {
-                    // The LOSSREPORT will be sent after initial_loss_ttl.
-                    m_FreshLoss.push_back(CRcvFreshLoss(i->first, i->second, initial_loss_ttl));
-                }
-            }
+            recordRcvLoss(srt_loss_seqs, initial_loss_ttl);
         }
 
         // This is moved earlier after introducing filter because it shouldn't
@@ -10503,7 +11031,7 @@ int srt::CUDT::processData(CUnit* in_unit)
         {
             return -1;
         }
-    } // End of recvbuf_acklock
+    }
 
     if (m_bClosing)
     {
@@ -10536,6 +11064,7 @@ int srt::CUDT::processData(CUnit* in_unit)
         {
             HLOGC(qrlog.Debug, log << CONID() << "loss: signaling TSBPD cond");
             CSync::lock_notify_one(m_RcvTsbPdCond, m_RecvLock);
+            wakeTsbPdPool();
         }
         else
         {
@@ -10557,6 +11086,7 @@ int srt::CUDT::processData(CUnit* in_unit)
         {
             HLOGC(qrlog.Debug, log << CONID() << "loss: signaling TSBPD cond");
             CSync::lock_notify_one(m_RcvTsbPdCond, m_RecvLock);
+            wakeTsbPdPool();
         }
     }
 
@@ -10815,6 +11345,35 @@ void srt::CUDT::unlose(const CPacket &packet)
     }
 }
 
+void srt::CUDT::recordRcvLoss(const loss_seqs_t& seqs, int initial_loss_ttl)
+{
+    ScopedLock lock(m_RcvLossLock);
+
+    HLOGC(qrlog.Debug,
+          log << CONID() << "processData: RECORDING LOSS: " << Printable(seqs)
+              << " tolerance=" << initial_loss_ttl);
+
+    // Read after rcvDropTooLateUpTo() moved it, if it cleaned the loss lists already.
+    const int32_t bufseq = m_pRcvBuffer->getStartSeqNo();
+    for (loss_seqs_t::const_iterator i = seqs.begin(); i != seqs.end(); ++i)
+    {
+        if (CSeqNo::seqcmp(i->second, bufseq) < 0)
+        {
+            HLOGC(qrlog.Debug, log << CONID() << "processData: LOSS %" << i->first << "-%" << i->second
+                    << " dropped already, buffer=%" << bufseq);
+            continue;
+        }
+
+        const int32_t seqlo = CSeqNo::seqcmp(i->first, bufseq) < 0 ? bufseq : i->first;
+        m_pRcvLossList->insert(seqlo, i->second);
+        if (initial_loss_ttl)
+        {
+            // The LOSSREPORT will be sent after initial_loss_ttl.
+            m_FreshLoss.push_back(CRcvFreshLoss(seqlo, i->second, initial_loss_ttl));
+        }
+    }
+}
+
 void srt::CUDT::dropFromLossLists(int32_t from, int32_t to)
 {
     ScopedLock lg(m_RcvLossLock);
@@ -11415,23 +11974,7 @@ bool srt::CUDT::checkExpTimer(const steady_clock::time_point& currtime, int chec
     HLOGC(xtlog.Debug, log << CONID() << "checkTimer: ACTIVITIES PERFORMED: " << decision);
 #endif
 
-    // In UDT the m_bUserDefinedRTO and m_iRTO were in CCC class.
-    // There's nothing in the original code that alters these values.
-
-    steady_clock::time_point next_exp_time;
-    if (m_CongCtl->RTO())
-    {
-        next_exp_time = m_tsLastRspTime.load() + microseconds_from(m_CongCtl->RTO());
-    }
-    else
-    {
-        steady_clock::duration exp_timeout =
-            microseconds_from(m_iEXPCount * (m_iSRTT + 4 * m_iRTTVar) + COMM_SYN_INTERVAL_US);
-        if (exp_timeout < (m_iEXPCount * m_tdMinExpInterval))
-            exp_timeout = m_iEXPCount * m_tdMinExpInterval;
-        next_exp_time = m_tsLastRspTime.load() + exp_timeout;
-    }
-
+    const steady_clock::time_point next_exp_time = nextExpTime();
     if (currtime <= next_exp_time && !m_bBreakAsUnstable)
         return false;
 
@@ -11455,7 +11998,7 @@ bool srt::CUDT::checkExpTimer(const steady_clock::time_point& currtime, int chec
         m_iBrokenCounter = 30;
 
         // update snd U list to remove this socket
-        m_pSndQueue->m_pSndUList->update(this, CSndUList::DO_RESCHEDULE);
+        m_pSndQueue->listOf(this)->update(this, CSndUList::DO_RESCHEDULE);
 
         updateBrokenConnection();
         completeBrokenConnectionDependencies(SRT_ECONNLOST); // LOCKS!
@@ -11485,6 +12028,20 @@ bool srt::CUDT::checkExpTimer(const steady_clock::time_point& currtime, int chec
     return false;
 }
 
+srt::sync::steady_clock::time_point srt::CUDT::nextExpTime()
+{
+    // In UDT the m_bUserDefinedRTO and m_iRTO were in CCC class.
+    // There's nothing in the original code that alters these values.
+    if (m_CongCtl->RTO())
+        return m_tsLastRspTime.load() + microseconds_from(m_CongCtl->RTO());
+
+    steady_clock::duration exp_timeout =
+        microseconds_from(m_iEXPCount * (m_iSRTT + 4 * m_iRTTVar) + COMM_SYN_INTERVAL_US);
+    if (exp_timeout < (m_iEXPCount * m_tdMinExpInterval))
+        exp_timeout = m_iEXPCount * m_tdMinExpInterval;
+    return m_tsLastRspTime.load() + exp_timeout;
+}
+
 void srt::CUDT::checkRexmitTimer(const steady_clock::time_point& currtime)
 {
     // Check if HSv4 should be retransmitted, and if KM_REQ should be resent if the side is INITIATOR.
@@ -11560,7 +12117,7 @@ void srt::CUDT::checkRexmitTimer(const steady_clock::time_point& currtime)
     updateCC(TEV_CHECKTIMER, EventVariant(stage));
 
     // schedule sending if not scheduled already
-    m_pSndQueue->m_pSndUList->update(this, CSndUList::DONT_RESCHEDULE);
+    m_pSndQueue->listOf(this)->update(this, CSndUList::DONT_RESCHEDULE);
 }
 
 void srt::CUDT::checkTimers()
@@ -11611,6 +12168,65 @@ void srt::CUDT::checkTimers()
     }
 }
 
+srt::sync::steady_clock::time_point srt::CUDT::nextTimerDeadline(const steady_clock::time_point& currtime)
+{
+    // Visited to be broken or removed from the receiver queue.
+    if (m_bBreakAsUnstable || !m_bConnected || m_bBroken || m_bClosing)
+        return currtime;
+
+    // Keepalive (see checkTimers()).
+    steady_clock::time_point deadline = m_tsLastSndTime.load() + microseconds_from(COMM_KEEPALIVE_PERIOD_US);
+
+    // Peer response expiration (see checkExpTimer()).
+    deadline = std::min(deadline, nextExpTime());
+
+    // Loss report (see checkNAKTimer()).
+    enterCS(m_RcvLossLock);
+    const int loss_len = m_pRcvLossList->getLossLength();
+    leaveCS(m_RcvLossLock);
+    if (loss_len > 0 && m_config.bRcvNakReport && m_PktFilterRexmitLevel == SRT_ARQ_ALWAYS)
+        deadline = std::min(deadline, m_tsNextNAKTime.load());
+
+    // Acknowledgement (see checkACKTimer()). When nothing has been received since
+    // the last ACK and that one was acknowledged, the ACK timer does nothing.
+    bool ack_pending = m_iPktCount > 0 || loss_len > 0 || m_bBufferWasFull || m_iRcvLastAck != m_iRcvLastAckAck;
+#if ENABLE_BONDING
+    // The group may move the receiver base of this socket (see dropToGroupRecvBase()).
+    ack_pending = ack_pending || m_parent->m_GroupOf;
+#endif
+    if (ack_pending)
+        deadline = std::min(deadline, m_tsNextACKTime.load());
+
+    // Blind retransmission (see checkRexmitTimer()).
+    if (m_pSndBuffer->getCurrBufSize() > 0)
+    {
+        ScopedLock ack_lock(m_RecvAckLock);
+        const uint64_t rtt_syn    = (m_iSRTT + 4 * m_iRTTVar + 2 * COMM_SYN_INTERVAL_US);
+        const uint64_t exp_int_us = (m_iReXmitCount * rtt_syn + COMM_SYN_INTERVAL_US);
+        deadline = std::min(deadline, m_tsLastRspAckTime + microseconds_from(exp_int_us));
+    }
+
+    // Legacy HSREQ and KM request retransmission (see checkSndTimers()).
+    if (m_SrtHsSide == HSD_INITIATOR && m_iSndHsRetryCnt > 0 && isOPT_TsbPd() && m_config.bDataSender)
+        deadline = std::min(deadline, m_tsSndHsLastTime + microseconds_from(m_iSRTT * 3 / 2));
+
+    ScopedLock lck(m_ConnectionLock);
+    if (m_pCryptoControl)
+    {
+        const steady_clock::time_point km_retry = m_pCryptoControl->nextKmRetryTime(SRTT());
+        if (!is_zero(km_retry))
+            deadline = std::min(deadline, km_retry);
+    }
+
+    return deadline;
+}
+
+void srt::CUDT::rescheduleTimers()
+{
+    if (m_pRcvQueue)
+        m_pRcvQueue->rescheduleTimers(m_SocketID);
+}
+
 void srt::CUDT::updateBrokenConnection()
 {
     m_bClosing = true;
@@ -11721,6 +12337,39 @@ void srt::CUDT::removeEPollID(const int eid)
     leaveCS(uglobal().m_EPoll.m_EPollLock);
 }
 
+void srt::CUDT::removeEPolls()
+{
+    // Make a copy under a lock because other thread might access it
+    // at the same time.
+    enterCS(uglobal().m_EPoll.m_EPollLock);
+    set<int> epollid = m_sPollID;
+    leaveCS(uglobal().m_EPoll.m_EPollLock);
+
+    // remove itself from all epoll monitoring
+    int no_events = 0;
+    for (set<int>::iterator i = epollid.begin(); i != epollid.end(); ++i)
+    {
+        HLOGC(smlog.Debug, log << CONID() << "close: CLEARING subscription on E" << (*i));
+        try
+        {
+            uglobal().m_EPoll.update_usock(*i, m_SocketID, &no_events);
+        }
+        catch (...)
+        {
+            // The goal of this loop is to remove all subscriptions in
+            // the epoll system to this socket. If it's unsubscribed already,
+            // that's even better.
+        }
+        HLOGC(smlog.Debug, log << CONID() << "close: removing E" << (*i) << " from back-subscribers");
+    }
+
+    // Not deleting elements from m_sPollID inside the loop because it invalidates
+    // the control iterator of the loop. Instead, all will be removed at once.
+    enterCS(uglobal().m_EPoll.m_EPollLock);
+    m_sPollID.clear();
+    leaveCS(uglobal().m_EPoll.m_EPollLock);
+}
+
 void srt::CUDT::ConnectSignal(ETransmissionEvent evt, EventSlot sl)
 {
     if (evt >= TEV_E_SIZE)
@@ -55,6 +55,7 @@ modified by
 #define INC_SRT_CORE_H
 
 #include <deque>
+#include <set>
 #include <sstream>
 #include "srt.h"
 #include "common.h"
@@ -150,9 +151,7 @@ class CCryptoControl;
 namespace srt {
 class CUDTUnited;
 class CUDTSocket;
-#if ENABLE_BONDING
 class CUDTGroup;
-#endif
 
 // XXX REFACTOR: The 'CUDT' class is to be merged with 'CUDTSocket'.
 // There's no reason for separating them, there's no case of having them
@@ -170,11 +169,15 @@ class CUDT
     friend class CRendezvousQueue;
     friend class CSndQueue;
     friend class CRcvQueue;
+    friend class CRcvQueueShard;
+    friend class CSndQueueShard;
+    friend class CTsbPdPool;
     friend class CSndUList;
-    friend class CRcvUList;
+    friend class CTimerWheel;
     friend class PacketFilter;
     friend class CUDTGroup;
     friend class TestMockCUDT; // unit tests
+    friend class TestMockRcvLoss; // unit tests
 
     typedef sync::steady_clock::time_point time_point;
     typedef sync::steady_clock::duration duration;
@@ -190,7 +193,7 @@ private: // constructor and desctructor
     ~CUDT();
 
 public: //API
-    static int startup();
+    static int startup(int tsbpd_workers = 0);
     static int cleanup();
     static SRTSOCKET socket();
 #if ENABLE_BONDING
@@ -219,7 +222,12 @@ public: //API
     static int sendmsg(SRTSOCKET u, const char* buf, int len, int ttl = SRT_MSGTTL_INF, bool inorder = false, int64_t srctime = 0);
     static int recvmsg(SRTSOCKET u, char* buf, int len, int64_t& srctime);
     static int sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& mctrl);
+    static int sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL& mctrl, srt_send_release_fn* release, void* opaque);
     static int recvmsg2(SRTSOCKET u, char* buf, int len, SRT_MSGCTRL& w_mctrl);
+    static int sendmsgv(SRTSOCKET u, const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL& w_mctrl);
+    static int recvmsgv(SRTSOCKET u, const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL& w_mctrl);
+    static int recvmsgBorrow(SRTSOCKET u, SRT_MSGLOAN& w_loan, SRT_MSGCTRL& w_mctrl);
+    static int recvmsgRelease(SRTSOCKET u, SRT_MSGLOAN& w_loan);
     static int64_t sendfile(SRTSOCKET u, std::fstream& ifs, int64_t& offset, int64_t size, int block = SRT_DEFAULT_SENDFILE_BLOCK);
     static int64_t recvfile(SRTSOCKET u, std::fstream& ofs, int64_t& offset, int64_t size, int block = SRT_DEFAULT_RECVFILE_BLOCK);
     static int select(int nfds, UDT::UDSET* readfds, UDT::UDSET* writefds, UDT::UDSET* exceptfds, const timeval* timeout);
@@ -237,6 +245,7 @@ public: //API
     static int epoll_uwait(const int eid, SRT_EPOLL_EVENT* fdsSet, int fdsSize, int64_t msTimeOut);
     static int32_t epoll_set(const int eid, int32_t flags);
     static int epoll_release(const int eid);
+    static int epoll_notify_fd(const int eid);
     static CUDTException& getlasterror();
     static int bstats(SRTSOCKET u, CBytePerfMon* perf, bool clear = true, bool instantaneous = false);
 #if ENABLE_BONDING
@@ -455,7 +464,11 @@ public: // internal API
     SRTU_PROPERTY_RR(sync::Condition*, recvTsbPdCond, &m_RcvTsbPdCond);
 
     /// @brief  Request a socket to be broken due to too long instability (normally by a group).
-    void breakAsUnstable() { m_bBreakAsUnstable = true; }
+    void breakAsUnstable()
+    {
+        m_bBreakAsUnstable = true;
+        rescheduleTimers();
+    }
 
     void ConnectSignal(ETransmissionEvent tev, EventSlot sl);
     void DisconnectSignal(ETransmissionEvent tev);
@@ -631,11 +644,44 @@ private:
     /// @param len [in] size of the buffer.
     /// @return Actual size of data received.
 
-    SRT_ATR_NODISCARD int sendmsg2(const char* data, int len, SRT_MSGCTRL& w_m);
+    /// Send a message from buffer "data".
+    /// @param release [in] if not NULL, "data" is referred to by the sender buffer instead of
+    ///                copied, and "release" is called with "opaque" when it's no longer needed.
+    ///                When an exception is thrown, "data" is neither referred to nor released,
+    ///                except for SRT_ECONGEST (SRT_ENABLE_ECN), thrown after it was stored.
+    SRT_ATR_NODISCARD int sendmsg2(const char* data, int len, SRT_MSGCTRL& w_m,
+                                   srt_send_release_fn* release = NULL, void* opaque = NULL);
+
+    /// Send a message gathered from several blocks.
+    /// @param iov [in] blocks of the message, in order.
+    /// @param iovcnt [in] number of blocks.
+    /// @return Actual size of data sent.
+    SRT_ATR_NODISCARD int sendmsgv(const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL& w_m);
+
+    /// Common implementation of sendmsg2() and sendmsgv(), @a len being the total size of the blocks.
+    SRT_ATR_NODISCARD int sendMessage(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_m,
+                                      srt_send_release_fn* release, void* opaque);
 
     SRT_ATR_NODISCARD int recvmsg(char* data, int len, int64_t& srctime);
     SRT_ATR_NODISCARD int recvmsg2(char* data, int len, SRT_MSGCTRL& w_m);
-    SRT_ATR_NODISCARD int receiveMessage(char* data, int len, SRT_MSGCTRL& w_m, int erh = 1 /*throw exception*/);
+
+    /// Receive a message scattering it over several blocks.
+    /// @param iov [in] blocks to receive the message into, in order.
+    /// @param iovcnt [in] number of blocks.
+    /// @return Actual size of data received.
+    SRT_ATR_NODISCARD int recvmsgv(const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL& w_m);
+
+    /// Receive a message without copying it. The units holding the message
+    /// are lent out until returned by recvmsgRelease().
+    /// @param w_loan [out] segments of the message.
+    /// @return Actual size of data received.
+    SRT_ATR_NODISCARD int recvmsgBorrow(SRT_MSGLOAN& w_loan, SRT_MSGCTRL& w_m);
+    void recvmsgRelease(SRT_MSGLOAN& w_loan);
+
+    SRT_ATR_NODISCARD int receiveMessage(char* data, int len, SRT_MSGCTRL& w_m, int erh = 1 /*throw exception*/,
+                                         std::vector<CUnit*>* w_borrowed = NULL);
+    SRT_ATR_NODISCARD int receiveMessage(const SRT_IOVEC* iov, int iovcnt, int len, SRT_MSGCTRL& w_m, int erh,
+                                         std::vector<CUnit*>* w_borrowed);
     SRT_ATR_NODISCARD int receiveBuffer(char* data, int len);
 
     size_t dropMessage(int32_t seqtoskip);
@@ -691,14 +737,32 @@ private:
     /// the receiver fresh loss list.
     void unlose(const CPacket& oldpacket);
     void dropFromLossLists(int32_t from, int32_t to);
+
+    /// Add the losses detected at reception to the loss lists. The receiver buffer is not
+    /// locked, so rcvDropTooLateUpTo() may have dropped a part of them meanwhile; the ranges
+    /// are clipped to the buffer start, read under m_RcvLossLock.
+    /// @param seqs [in] The lost sequence ranges.
+    /// @param initial_loss_ttl [in] Delay of the loss report (see m_FreshLoss), 0 for none.
+    void recordRcvLoss(const loss_seqs_t& seqs, int initial_loss_ttl);
     bool getFirstNoncontSequence(int32_t& w_seq, std::string& w_log_reason);
 
     SRT_ATTR_EXCLUDES(m_ConnectionLock)
     void checkSndTimers();
     
     /// @brief Check and perform KM refresh if needed.
+    /// With SRTO_CRYPTOAHEAD, m_SndCryptoLock must be locked.
     void checkSndKMRefresh();
 
+    /// Get the crypto control to encrypt the payload with when it's added to the
+    /// sender buffer (see SRTO_CRYPTOAHEAD).
+    /// @return NULL if the payload is to be encrypted when the packet is sent.
+    SRT_ATTR_REQUIRES(m_SndCryptoLock)
+    CCryptoControl* sndCryptoAhead();
+
+    /// Check if the payload is encrypted in place in the sender buffer, so that
+    /// the data passed to sendmsg2() with a release function are copied anyway.
+    bool sndEncryptsInPlace() const;
+
     void handshakeDone()
     {
         m_iSndHsRetryCnt = 0;
@@ -749,6 +813,21 @@ private:
     // TSBPD thread main function.
     static void* tsbpd(void* param);
 
+    /// One round of the TSBPD delivery: signal the readiness of the packets whose
+    /// time to play has come, dropping the too late ones before them.
+    /// @return the time of the next delivery, or zero time to wait for a wake-up.
+    SRT_ATTR_REQUIRES(m_RecvLock)
+    time_point tsbpdDeliver(sync::CUniqueSync& recvdata_lcc, CUDTGroup* group);
+
+    /// The round of the TSBPD delivery done by the shared TSBPD pool.
+    SRT_ATTR_EXCLUDES(m_RecvLock)
+    time_point tsbpdPoolRound();
+
+    /// Wake up the TSBPD delivery if this socket is served by the shared TSBPD pool.
+    /// The TSBPD thread of the socket is woken up by signaling m_RcvTsbPdCond instead.
+    void wakeTsbPdPool();
+    void releaseTsbPdPool();
+
     /// Drop too late packets (receiver side). Update loss lists and ACK positions.
     /// The @a seqno packet itself is not dropped.
     /// @param seqno [in] The sequence number of the first packets following those to be dropped.
@@ -903,6 +982,8 @@ private: // Timers
     //   always increased by one in this call, otherwise it will be increased by the number of blocks
     //   scheduled for sending.
 
+    bool m_bSndSeqUnscheduled;                   // Blocks without a scheduled sequence were added (srt_sendfile)
+
     int32_t m_iSndLastAck2;                      // Last ACK2 sent back
     time_point m_SndLastAck2Time;                // The time when last ACK2 was sent back
     void setInitialSndSeq(int32_t isn)
@@ -943,6 +1024,14 @@ private: // Timers
 
 private: // Receiving related data
     CRcvBuffer* m_pRcvBuffer;                    //< Receiver buffer
+
+    struct RcvLoan                               //< Message lent out by recvmsgBorrow()
+    {
+        std::vector<CUnit*> units;
+        std::vector<SRT_MSGSEGMENT> segments;
+    };
+    SRT_ATTR_GUARDED_BY(m_RcvLoansLock)
+    std::set<RcvLoan*> m_RcvLoans;               //< Messages not yet returned by the application
     SRT_ATTR_GUARDED_BY(m_RcvLossLock)
     CRcvLossList* m_pRcvLossList;                //< Receiver loss list
     SRT_ATTR_GUARDED_BY(m_RcvLossLock)
@@ -976,6 +1065,12 @@ private: // Receiving related data
     sync::Condition m_RcvTsbPdCond;              // TSBPD signals if reading is ready. Use together with m_RecvLock
     bool m_bTsbPdAckWakeup;                      // Signal TsbPd thread on Ack sent
     sync::Mutex m_RcvTsbPdStartupLock;           // Protects TSBPD thread creating and joining
+    sync::atomic<bool> m_bTsbPdPooled;           // TSBPD done by the shared pool instead of m_RcvTsbPdThread
+#if ENABLE_BONDING
+    CUDTGroup* m_pTsbPdGroup;                    // Group kept from deletion while in the TSBPD pool (like by the TSBPD thread)
+    bool m_bTsbPdGroupAcquired;
+    CUDTGroup* m_pRcvBufferGroup;                // Group whose receiver buffer takes the packets (SRTO_GROUPRCVBUF), kept from deletion
+#endif
 
     CallbackHolder<srt_listen_callback_fn> m_cbAcceptHook;
     CallbackHolder<srt_connect_callback_fn> m_cbConnectHook;
@@ -1008,11 +1103,14 @@ private: // synchronization: mutexes and conditions
     sync::Mutex m_SendBlockLock;                 // lock associated to m_SendBlockCond
 
     mutable sync::Mutex m_RcvBufferLock;         // Protects the state of the m_pRcvBuffer
+    sync::Mutex m_RcvCryptoLock;                 // Protects m_pCryptoControl from being reset while decrypting
+    sync::Mutex m_SndCryptoLock;                 // With SRTO_CRYPTOAHEAD, serializes the encryption and the KM refresh of the sender; protects m_pCryptoControl from being reset
     // Protects access to m_iSndCurrSeqNo, m_iSndLastAck
     mutable sync::Mutex m_RecvAckLock;                   // Protects the state changes while processing incoming ACK (SRT_EPOLL_OUT)
 
     sync::Condition m_RecvDataCond;              // used to block "srt_recv*" when there is no data. Use together with m_RecvLock
     sync::Mutex m_RecvLock;                      // used to synchronize "srt_recv*" call, protects TSBPD drift updates (CRcvBuffer::isRcvDataReady())
+    sync::Mutex m_RcvLoansLock;                  // Protects m_RcvLoans
 
     sync::Mutex m_SendLock;                      // used to synchronize "send" call
     sync::Mutex m_RcvLossLock;                   // Protects the receiver loss list (access: CRcvQueue::worker, CUDT::tsbpd)
@@ -1123,6 +1221,12 @@ private: // Generation and processing of packets
     /// @return -2 The incoming packet exceeds the expected sequence by more than a length of the buffer (irrepairable discrepancy).
     int handleSocketPacketReception(const std::vector<CUnit*>& incoming, bool& w_new_inserted, bool& w_was_sent_in_order, CUDT::loss_seqs_t& w_srt_loss_seqs);
 
+    /// Decrypt with one call the encrypted packets from @a incoming that will be inserted
+    /// into the receiver buffer (that is, within the buffer and not there yet).
+    /// @param bufseq the start sequence number of the receiver buffer
+    /// @param w_status [out] the result for each packet, ENCS_NOTSUP for those not decrypted here.
+    void decryptIncoming(const std::vector<CUnit*>& incoming, int32_t bufseq, std::vector<EncryptionStatus>& w_status);
+
     /// Get the packet's TSBPD time.
     /// The @a grp passed by void* is not used yet
     /// and shall not be used when ENABLE_BONDING=0.
@@ -1194,6 +1298,18 @@ private: // Timers functions
                      LAST_BECAUSE_BIT  =      3;
 
     void checkTimers();
+
+    /// Get the time when checkTimers() should be called next, that is, when any of
+    /// the timers may expire, if no packet is received for the socket in the meantime.
+    /// Threads other than the receiver queue worker that change the state this
+    /// depends on (e.g. data scheduled for sending) call rescheduleTimers() then.
+    time_point nextTimerDeadline(const time_point& currtime);
+
+    /// Have the receiver queue worker call nextTimerDeadline() for this socket again.
+    /// Can be called by any thread.
+    void rescheduleTimers();
+    time_point nextExpTime();
+
     void considerLegacySrtHandshake(const time_point &timebase);
     int checkACKTimer (const time_point& currtime);
     int checkNAKTimer(const time_point& currtime);
@@ -1219,6 +1335,7 @@ private: // for epoll
     void addEPoll(const int eid);
     void removeEPollEvents(const int eid);
     void removeEPollID(const int eid);
+    void removeEPolls(); // from all EIDs at once
 };
 
 } // namespace srt
@@ -77,6 +77,9 @@ std::string KmStateStr(SRT_KM_STATE state)
 
 using srt_logging::KmStateStr;
 
+// Defined, as std::min() takes it by reference.
+const int srt::CCryptoControl::MAX_BATCH;
+
 void srt::CCryptoControl::globalInit()
 {
 #ifdef SRT_ENABLE_ENCRYPTION
@@ -504,12 +507,29 @@ void srt::CCryptoControl::sendKeysToPeer(CUDT* sock SRT_ATR_UNUSED, int iSRTT SR
 #endif
 }
 
-void srt::CCryptoControl::regenCryptoKm(CUDT* sock SRT_ATR_UNUSED, bool bidirectional SRT_ATR_UNUSED)
+srt::sync::steady_clock::time_point srt::CCryptoControl::nextKmRetryTime(int iSRTT SRT_ATR_UNUSED)
+{
+#ifdef SRT_ENABLE_ENCRYPTION
+    sync::ScopedLock lck(m_mtxLock);
+    if (m_hSndCrypto && m_SndKmState != SRT_KM_S_UNSECURED)
+    {
+        // The keys that sendKeysToPeer() sends.
+        for (int ki = 0; ki < 2; ki++)
+        {
+            if (m_SndKmMsg[ki].iPeerRetry > 0 && m_SndKmMsg[ki].MsgLen > 0)
+                return m_SndKmLastTime + srt::sync::microseconds_from((iSRTT * 3)/2);
+        }
+    }
+#endif
+    return srt::sync::steady_clock::time_point();
+}
+
+bool srt::CCryptoControl::regenCryptoKm(CUDT* sock SRT_ATR_UNUSED, bool bidirectional SRT_ATR_UNUSED)
 {
 #ifdef SRT_ENABLE_ENCRYPTION
     sync::ScopedLock lck(m_mtxLock);
     if (!m_hSndCrypto)
-        return;
+        return false;
 
     void *out_p[2];
     size_t out_len_p[2];
@@ -581,6 +601,9 @@ void srt::CCryptoControl::regenCryptoKm(CUDT* sock SRT_ATR_UNUSED, bool bidirect
 
     if (sent)
         m_SndKmLastTime = srt::sync::steady_clock::now();
+    return sent > 0;
+#else
+    return false;
 #endif
 }
 
@@ -829,6 +852,35 @@ srt::EncryptionStatus srt::CCryptoControl::decrypt(CPacket& w_packet SRT_ATR_UNU
         return ENCS_CLEAR; // not encrypted, no need do decrypt, no flags to be modified
     }
 
+    const EncryptionStatus ready = checkRcvSecured(w_packet);
+    if (ready != ENCS_CLEAR)
+        return ready;
+
+    const int rc = HaiCrypt_Rx_Data(m_hRcvCrypto, ((uint8_t *)w_packet.getHeader()), ((uint8_t *)w_packet.m_pcData), w_packet.getLength());
+    if (rc <= 0)
+    {
+        LOGC(cnlog.Note, log << "decrypt ERROR: HaiCrypt_Rx_Data failure=" << rc << " - returning failed decryption");
+        // -1: decryption failure
+        // 0: key not received yet
+        return ENCS_FAILED;
+    }
+    // Otherwise: rc == decrypted text length.
+    w_packet.setLength(rc); /* In case clr txt size is different from cipher txt */
+
+    // Decryption succeeded. Update flags.
+    w_packet.setMsgCryptoFlags(EK_NOENC);
+
+    HLOGC(cnlog.Debug, log << "decrypt: successfully decrypted, resulting length=" << rc);
+    return ENCS_CLEAR;
+#else
+    return ENCS_NOTSUP;
+#endif
+}
+
+
+#ifdef SRT_ENABLE_ENCRYPTION
+srt::EncryptionStatus srt::CCryptoControl::checkRcvSecured(const CPacket& packet)
+{
     if (m_RcvKmState == SRT_KM_S_UNSECURED)
     {
         if (m_KmSecret.len != 0)
@@ -837,7 +889,7 @@ srt::EncryptionStatus srt::CCryptoControl::decrypt(CPacket& w_packet SRT_ATR_UNU
             // but now here we are.
             m_RcvKmState = SRT_KM_S_SECURING;
             LOGC(cnlog.Note, log << "SECURITY UPDATE: Peer has surprised Agent with encryption, but KMX is pending - current packet size="
-                    << w_packet.getLength() << " dropped");
+                    << packet.getLength() << " dropped");
             return ENCS_FAILED;
         }
         else
@@ -867,34 +919,107 @@ srt::EncryptionStatus srt::CCryptoControl::decrypt(CPacket& w_packet SRT_ATR_UNU
         if (!m_bErrorReported)
         {
             m_bErrorReported = true;
-            LOGC(cnlog.Error, log << "SECURITY STATUS: " << KmStateStr(m_RcvKmState) << " - can't decrypt w_packet.");
+            LOGC(cnlog.Error, log << "SECURITY STATUS: " << KmStateStr(m_RcvKmState) << " - can't decrypt packet.");
         }
         HLOGC(cnlog.Debug, log << "Packet still not decrypted, status=" << KmStateStr(m_RcvKmState)
-                << " - dropping size=" << w_packet.getLength());
+                << " - dropping size=" << packet.getLength());
         return ENCS_FAILED;
     }
 
-    const int rc = HaiCrypt_Rx_Data(m_hRcvCrypto, ((uint8_t *)w_packet.getHeader()), ((uint8_t *)w_packet.m_pcData), w_packet.getLength());
-    if (rc <= 0)
+    return ENCS_CLEAR;
+}
+#endif
+
+srt::EncryptionStatus srt::CCryptoControl::encrypt(CPacket* const packets[] SRT_ATR_UNUSED, int n SRT_ATR_UNUSED)
+{
+#ifdef SRT_ENABLE_ENCRYPTION
+    if (getSndCryptoFlags() == EK_NOENC)
+        return ENCS_CLEAR;
+
+    unsigned char* pfx[MAX_BATCH];
+    unsigned char* data[MAX_BATCH];
+    size_t         len[MAX_BATCH];
+    for (int begin = 0; begin < n; begin += MAX_BATCH)
     {
-        LOGC(cnlog.Note, log << "decrypt ERROR: HaiCrypt_Rx_Data failure=" << rc << " - returning failed decryption");
-        // -1: decryption failure
-        // 0: key not received yet
-        return ENCS_FAILED;
-    }
-    // Otherwise: rc == decrypted text length.
-    w_packet.setLength(rc); /* In case clr txt size is different from cipher txt */
+        const int nb = std::min(n - begin, MAX_BATCH);
+        for (int i = 0; i < nb; ++i)
+        {
+            CPacket& pkt = *packets[begin + i];
+            pfx[i]  = (uint8_t*)pkt.getHeader();
+            data[i] = (uint8_t*)pkt.m_pcData;
+            len[i]  = pkt.getLength();
+        }
 
-    // Decryption succeeded. Update flags.
-    w_packet.setMsgCryptoFlags(EK_NOENC);
+        if (HaiCrypt_Tx_DataBatch(m_hSndCrypto, pfx, data, len, nb) < 0)
+            return ENCS_FAILED;
+
+        // The length grows by the auth tag in case of GCM.
+        for (int i = 0; i < nb; ++i)
+            packets[begin + i]->setLength(len[i]);
+    }
 
-    HLOGC(cnlog.Debug, log << "decrypt: successfully decrypted, resulting length=" << rc);
     return ENCS_CLEAR;
 #else
     return ENCS_NOTSUP;
 #endif
 }
 
+void srt::CCryptoControl::decrypt(CPacket* const packets[] SRT_ATR_UNUSED, int n, EncryptionStatus w_status[])
+{
+#ifdef SRT_ENABLE_ENCRYPTION
+    unsigned char* pfx[MAX_BATCH];
+    unsigned char* data[MAX_BATCH];
+    size_t         len[MAX_BATCH];
+    int            res[MAX_BATCH];
+    int            which[MAX_BATCH];
+    for (int begin = 0; begin < n; begin += MAX_BATCH)
+    {
+        const int end = std::min(n, begin + MAX_BATCH);
+        int       nb  = 0;
+        for (int i = begin; i < end; ++i)
+        {
+            CPacket& pkt = *packets[i];
+            if (pkt.getMsgCryptoFlags() == EK_NOENC)
+            {
+                w_status[i] = ENCS_CLEAR;
+                continue;
+            }
+
+            w_status[i] = checkRcvSecured(pkt);
+            if (w_status[i] != ENCS_CLEAR)
+                continue;
+
+            which[nb] = i;
+            pfx[nb]   = (uint8_t*)pkt.getHeader();
+            data[nb]  = (uint8_t*)pkt.m_pcData;
+            len[nb]   = pkt.getLength();
+            ++nb;
+        }
+
+        if (nb == 0)
+            continue;
+
+        HaiCrypt_Rx_DataBatch(m_hRcvCrypto, pfx, data, len, res, nb);
+        for (int k = 0; k < nb; ++k)
+        {
+            CPacket& pkt = *packets[which[k]];
+            if (res[k] <= 0)
+            {
+                LOGC(cnlog.Note, log << "decrypt ERROR: HaiCrypt_Rx_DataBatch failure=" << res[k] << " %" << pkt.getSeqNo()
+                        << " - returning failed decryption");
+                w_status[which[k]] = ENCS_FAILED;
+                continue;
+            }
+            pkt.setLength(res[k]);
+            pkt.setMsgCryptoFlags(EK_NOENC);
+            w_status[which[k]] = ENCS_CLEAR;
+        }
+    }
+#else
+    for (int i = 0; i < n; ++i)
+        w_status[i] = ENCS_NOTSUP;
+#endif
+}
 
 srt::CCryptoControl::~CCryptoControl()
 {
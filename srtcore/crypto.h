@@ -84,6 +84,13 @@ private:
 
     bool m_bErrorReported;
 
+    // Packets passed at once to the HaiCrypt batch functions.
+    static const int MAX_BATCH = 64;
+
+    /// Checks if the receiver can decrypt (the state of the keying material is SECURED).
+    /// Updates and reports the state if it can't.
+    EncryptionStatus checkRcvSecured(const CPacket& packet);
+
 public:
     static void globalInit();
 
@@ -119,8 +126,9 @@ public:
     /// Regenerate cryptographic key material if needed.
     /// @param[in] sock If not null, the socket will be used to send the KM message to the peer (e.g. KM refresh).
     /// @param[in] bidirectional If true, the key material will be regenerated for both directions (receiver and sender).
+    /// @return true if a KM message was sent to the peer (to be retransmitted by sendKeysToPeer()).
     SRT_ATTR_EXCLUDES(m_mtxLock)
-    void regenCryptoKm(CUDT* sock, bool bidirectional);
+    bool regenCryptoKm(CUDT* sock, bool bidirectional);
 
     size_t KeyLen() { return m_iSndKmKeyLen; }
 
@@ -220,6 +228,11 @@ public:
     SRT_ATTR_EXCLUDES(m_mtxLock)
     void sendKeysToPeer(CUDT* sock, int iSRTT);
 
+    /// Get the time when sendKeysToPeer() is going to retransmit the KM request,
+    /// or zero time if no KM request is waiting for the response.
+    SRT_ATTR_EXCLUDES(m_mtxLock)
+    sync::steady_clock::time_point nextKmRetryTime(int iSRTT);
+
     void setCryptoSecret(const HaiCrypt_Secret& secret)
     {
         m_KmSecret = secret;
@@ -275,6 +288,16 @@ public:
     // in PH_MSGNO is set to EK_NOENC.
     EncryptionStatus decrypt(CPacket& w_packet);
 
+    /// Encrypts several packets with one call to HaiCrypt, as encrypt()
+    /// does for each of them.
+    /// @return ENCS_FAILED if any of the packets failed.
+    EncryptionStatus encrypt(CPacket* const packets[], int n);
+
+    /// Decrypts several packets with one call to HaiCrypt, as decrypt()
+    /// does for each of them.
+    /// @param w_status the result for each packet
+    void decrypt(CPacket* const packets[], int n, EncryptionStatus w_status[]);
+
     ~CCryptoControl();
 };
 
@@ -62,6 +62,10 @@ modified by
 #include <sys/event.h>
 #endif
 
+#ifdef LINUX
+#include <sys/eventfd.h>
+#endif
+
 #include "common.h"
 #include "epoll.h"
 #include "logging.h"
@@ -159,6 +163,13 @@ ENOMEM: There was insufficient memory to create the kernel object.
    pair<map<int, CEPollDesc>::iterator, bool> res = m_mPolls.insert(make_pair(m_iIDSeed, CEPollDesc(m_iIDSeed, localid)));
    if (!res.second)  // Insertion failed (no memory?)
        throw CUDTException(MJ_SETUP, MN_NONE);
+
+   CEPollDesc::Wakeup* w = new CEPollDesc::Wakeup;
+   w->waiters = 0;
+   w->released = false;
+   setupCond(w->cond, "EPollWakeup");
+   res.first->second.m_pWakeup = w;
+
    if (pout)
        *pout = &res.first->second;
 
@@ -177,6 +188,7 @@ int srt::CEPoll::clear_usocks(int eid)
    CEPollDesc& d = p->second;
 
    d.clearAll();
+   d.signal();
 
    return 0;
 }
@@ -217,6 +229,8 @@ void srt::CEPoll::clear_ready_usocks(CEPollDesc& d, int direction)
 
     for (size_t j = 0; j < cleared.size(); ++j)
         d.removeSubscription(cleared[j]);
+
+    d.updateNotifyFD();
 }
 
 int srt::CEPoll::add_ssock(const int eid, const SYSSOCKET& s, const int* events)
@@ -287,6 +301,8 @@ int srt::CEPoll::add_ssock(const int eid, const SYSSOCKET& s, const int* events)
 #endif
 
    p->second.m_sLocals.insert(s);
+   // Waiting threads must switch to polling the system sockets.
+   p->second.signal();
 
    return 0;
 }
@@ -317,6 +333,7 @@ int srt::CEPoll::remove_ssock(const int eid, const SYSSOCKET& s)
 #endif
 
    p->second.m_sLocals.erase(s);
+   p->second.signal();
 
    return 0;
 }
@@ -391,6 +408,7 @@ int srt::CEPoll::update_usock(const int eid, const SRTSOCKET& u, const int* even
         HLOGC(ealog.Debug, log << "srt_epoll_update_usock: REMOVED E" << eid << " socket @" << u);
         d.removeSubscription(u);
     }
+    d.signal();
     return 0;
 }
 
@@ -486,6 +504,7 @@ int srt::CEPoll::setflags(const int eid, int32_t flags)
     {
         ed.set_flags(flags);
     }
+    ed.signal();
 
     return oflags;
 }
@@ -500,56 +519,58 @@ int srt::CEPoll::uwait(const int eid, SRT_EPOLL_EVENT* fdsSet, int fdsSize, int6
 
     steady_clock::time_point entertime = steady_clock::now();
 
+    UniqueLock pg(m_EPollLock);
     while (true)
     {
-        {
-            ScopedLock pg(m_EPollLock);
-            map<int, CEPollDesc>::iterator p = m_mPolls.find(eid);
-            if (p == m_mPolls.end())
-                throw CUDTException(MJ_NOTSUP, MN_EIDINVAL);
-            CEPollDesc& ed = p->second;
+        // Find it again each time, as it could be released while waiting.
+        map<int, CEPollDesc>::iterator p = m_mPolls.find(eid);
+        if (p == m_mPolls.end())
+            throw CUDTException(MJ_NOTSUP, MN_EIDINVAL);
+        CEPollDesc& ed = p->second;
 
-            if (!ed.flags(SRT_EPOLL_ENABLE_EMPTY) && ed.watch_empty())
-            {
-                // Empty EID is not allowed, report error.
-                throw CUDTException(MJ_NOTSUP, MN_EEMPTY);
-            }
+        if (!ed.flags(SRT_EPOLL_ENABLE_EMPTY) && ed.watch_empty())
+        {
+            // Empty EID is not allowed, report error.
+            throw CUDTException(MJ_NOTSUP, MN_EEMPTY);
+        }
 
-            if (ed.flags(SRT_EPOLL_ENABLE_OUTPUTCHECK) && (fdsSet == NULL || fdsSize == 0))
-            {
-                // Empty EID is not allowed, report error.
-                throw CUDTException(MJ_NOTSUP, MN_INVAL);
-            }
+        if (ed.flags(SRT_EPOLL_ENABLE_OUTPUTCHECK) && (fdsSet == NULL || fdsSize == 0))
+        {
+            // Empty EID is not allowed, report error.
+            throw CUDTException(MJ_NOTSUP, MN_INVAL);
+        }
 
-            if (!ed.m_sLocals.empty())
-            {
-                // XXX Add error log
-                // uwait should not be used with EIDs subscribed to system sockets
-                throw CUDTException(MJ_NOTSUP, MN_INVAL);
-            }
+        if (!ed.m_sLocals.empty())
+        {
+            // XXX Add error log
+            // uwait should not be used with EIDs subscribed to system sockets
+            throw CUDTException(MJ_NOTSUP, MN_INVAL);
+        }
 
-            int total = 0; // This is a list, so count it during iteration
-            CEPollDesc::enotice_t::iterator i = ed.enotice_begin();
-            while (i != ed.enotice_end())
-            {
-                int pos = total; // previous past-the-end position
-                ++total;
+        int total = 0; // This is a list, so count it during iteration
+        CEPollDesc::enotice_t::iterator i = ed.enotice_begin();
+        while (i != ed.enotice_end())
+        {
+            int pos = total; // previous past-the-end position
+            ++total;
 
-                if (total > fdsSize)
-                    break;
+            if (total > fdsSize)
+                break;
 
-                fdsSet[pos] = *i;
+            fdsSet[pos] = *i;
 
-                ed.checkEdge(i++); // NOTE: potentially deletes `i`
-            }
-            if (total)
-                return total;
+            ed.checkEdge(i++); // NOTE: potentially deletes `i`
+        }
+        if (total)
+        {
+            ed.updateNotifyFD();
+            return total;
         }
 
         if ((msTimeOut >= 0) && (count_microseconds(srt::sync::steady_clock::now() - entertime) >= msTimeOut * int64_t(1000)))
             break; // official wait does: throw CUDTException(MJ_AGAIN, MN_XMTIMEOUT, 0);
 
-        CGlobEvent::waitForEvent();
+        waitSignal(pg, ed, entertime, msTimeOut, false);
     }
 
     return 0;
@@ -570,173 +591,173 @@ int srt::CEPoll::wait(const int eid, set<SRTSOCKET>* readfds, set<SRTSOCKET>* wr
     int total = 0;
 
     srt::sync::steady_clock::time_point entertime = srt::sync::steady_clock::now();
+    UniqueLock epollock(m_EPollLock);
     while (true)
     {
+        // Find it again each time, as it could be released while waiting.
+        map<int, CEPollDesc>::iterator p = m_mPolls.find(eid);
+        if (p == m_mPolls.end())
         {
-            ScopedLock epollock(m_EPollLock);
+            LOGC(ealog.Error, log << "EID:" << eid << " INVALID.");
+            throw CUDTException(MJ_NOTSUP, MN_EIDINVAL);
+        }
 
-            map<int, CEPollDesc>::iterator p = m_mPolls.find(eid);
-            if (p == m_mPolls.end())
-            {
-                LOGC(ealog.Error, log << "EID:" << eid << " INVALID.");
-                throw CUDTException(MJ_NOTSUP, MN_EIDINVAL);
-            }
+        CEPollDesc& ed = p->second;
 
-            CEPollDesc& ed = p->second;
+        if (!ed.flags(SRT_EPOLL_ENABLE_EMPTY) && ed.watch_empty() && ed.m_sLocals.empty())
+        {
+            // Empty EID is not allowed, report error.
+            //throw CUDTException(MJ_NOTSUP, MN_INVAL);
+            LOGC(ealog.Error, log << "EID:" << eid << " no sockets to check, this would deadlock");
+            throw CUDTException(MJ_NOTSUP, MN_EEMPTY, 0);
+        }
 
-            if (!ed.flags(SRT_EPOLL_ENABLE_EMPTY) && ed.watch_empty() && ed.m_sLocals.empty())
-            {
-                // Empty EID is not allowed, report error.
-                //throw CUDTException(MJ_NOTSUP, MN_INVAL);
-                LOGC(ealog.Error, log << "EID:" << eid << " no sockets to check, this would deadlock");
-                throw CUDTException(MJ_NOTSUP, MN_EEMPTY, 0);
-            }
+        if (ed.flags(SRT_EPOLL_ENABLE_OUTPUTCHECK))
+        {
+            // Empty report is not allowed, report error.
+            if (!ed.m_sLocals.empty() && (!lrfds || !lwfds))
+                throw CUDTException(MJ_NOTSUP, MN_INVAL);
 
-            if (ed.flags(SRT_EPOLL_ENABLE_OUTPUTCHECK))
-            {
-                // Empty report is not allowed, report error.
-                if (!ed.m_sLocals.empty() && (!lrfds || !lwfds))
-                    throw CUDTException(MJ_NOTSUP, MN_INVAL);
+            if (!ed.watch_empty() && (!readfds || !writefds))
+                throw CUDTException(MJ_NOTSUP, MN_INVAL);
+        }
 
-                if (!ed.watch_empty() && (!readfds || !writefds))
-                    throw CUDTException(MJ_NOTSUP, MN_INVAL);
+        IF_HEAVY_LOGGING(int total_noticed = 0);
+        IF_HEAVY_LOGGING(ostringstream debug_sockets);
+        // Sockets with exceptions are returned to both read and write sets.
+        for (CEPollDesc::enotice_t::iterator it = ed.enotice_begin(), it_next = it; it != ed.enotice_end(); it = it_next)
+        {
+            ++it_next;
+            IF_HEAVY_LOGGING(++total_noticed);
+            if (readfds && ((it->events & SRT_EPOLL_IN) || (it->events & SRT_EPOLL_ERR)))
+            {
+                if (readfds->insert(it->fd).second)
+                    ++total;
             }
 
-            IF_HEAVY_LOGGING(int total_noticed = 0);
-            IF_HEAVY_LOGGING(ostringstream debug_sockets);
-            // Sockets with exceptions are returned to both read and write sets.
-            for (CEPollDesc::enotice_t::iterator it = ed.enotice_begin(), it_next = it; it != ed.enotice_end(); it = it_next)
+            if (writefds && ((it->events & SRT_EPOLL_OUT) || (it->events & SRT_EPOLL_ERR)))
             {
-                ++it_next;
-                IF_HEAVY_LOGGING(++total_noticed);
-                if (readfds && ((it->events & SRT_EPOLL_IN) || (it->events & SRT_EPOLL_ERR)))
-                {
-                    if (readfds->insert(it->fd).second)
-                        ++total;
-                }
-
-                if (writefds && ((it->events & SRT_EPOLL_OUT) || (it->events & SRT_EPOLL_ERR)))
-                {
-                    if (writefds->insert(it->fd).second)
-                        ++total;
-                }
+                if (writefds->insert(it->fd).second)
+                    ++total;
+            }
 
-                IF_HEAVY_LOGGING(debug_sockets << " " << it->fd << ":"
-                        << IF_DIRNAME(it->events, SRT_EPOLL_IN, "R")
-                        << IF_DIRNAME(it->events, SRT_EPOLL_OUT, "W")
-                        << IF_DIRNAME(it->events, SRT_EPOLL_ERR, "E"));
+            IF_HEAVY_LOGGING(debug_sockets << " " << it->fd << ":"
+                    << IF_DIRNAME(it->events, SRT_EPOLL_IN, "R")
+                    << IF_DIRNAME(it->events, SRT_EPOLL_OUT, "W")
+                    << IF_DIRNAME(it->events, SRT_EPOLL_ERR, "E"));
 
-                if (ed.checkEdge(it)) // NOTE: potentially erases 'it'.
-                {
-                    IF_HEAVY_LOGGING(debug_sockets << "!");
-                }
+            if (ed.checkEdge(it)) // NOTE: potentially erases 'it'.
+            {
+                IF_HEAVY_LOGGING(debug_sockets << "!");
             }
+        }
 
-            HLOGC(ealog.Debug, log << "CEPoll::wait: REPORTED " << total << "/" << total_noticed
-                    << debug_sockets.str());
+        HLOGC(ealog.Debug, log << "CEPoll::wait: REPORTED " << total << "/" << total_noticed
+                << debug_sockets.str());
 
-            if ((lrfds || lwfds) && !ed.m_sLocals.empty())
-            {
+        if ((lrfds || lwfds) && !ed.m_sLocals.empty())
+        {
 #ifdef LINUX
-                const int max_events = ed.m_sLocals.size();
-                SRT_ASSERT(max_events > 0);
-                srt::FixedArray<epoll_event> ev(max_events);
-                int nfds = ::epoll_wait(ed.m_iLocalID, ev.data(), ev.size(), 0);
+            const int max_events = ed.m_sLocals.size();
+            SRT_ASSERT(max_events > 0);
+            srt::FixedArray<epoll_event> ev(max_events);
+            int nfds = ::epoll_wait(ed.m_iLocalID, ev.data(), ev.size(), 0);
 
-                IF_HEAVY_LOGGING(const int prev_total = total);
-                for (int i = 0; i < nfds; ++ i)
+            IF_HEAVY_LOGGING(const int prev_total = total);
+            for (int i = 0; i < nfds; ++ i)
+            {
+                if ((NULL != lrfds) && (ev[i].events & EPOLLIN))
                 {
-                    if ((NULL != lrfds) && (ev[i].events & EPOLLIN))
-                    {
-                        lrfds->insert(ev[i].data.fd);
-                        ++ total;
-                    }
-                    if ((NULL != lwfds) && (ev[i].events & EPOLLOUT))
-                    {
-                        lwfds->insert(ev[i].data.fd);
-                        ++ total;
-                    }
+                    lrfds->insert(ev[i].data.fd);
+                    ++ total;
+                }
+                if ((NULL != lwfds) && (ev[i].events & EPOLLOUT))
+                {
+                    lwfds->insert(ev[i].data.fd);
+                    ++ total;
                 }
-                HLOGC(ealog.Debug, log << "CEPoll::wait: LINUX: picking up " << (total - prev_total)  << " ready fds.");
+            }
+            HLOGC(ealog.Debug, log << "CEPoll::wait: LINUX: picking up " << (total - prev_total)  << " ready fds.");
 
 #elif defined(BSD) || TARGET_OS_MAC
-                struct timespec tmout = {0, 0};
-                const int max_events = (int)ed.m_sLocals.size();
-                SRT_ASSERT(max_events > 0);
-                srt::FixedArray<struct kevent> ke(max_events);
+            struct timespec tmout = {0, 0};
+            const int max_events = (int)ed.m_sLocals.size();
+            SRT_ASSERT(max_events > 0);
+            srt::FixedArray<struct kevent> ke(max_events);
 
-                int nfds = kevent(ed.m_iLocalID, NULL, 0, ke.data(), (int)ke.size(), &tmout);
-                IF_HEAVY_LOGGING(const int prev_total = total);
+            int nfds = kevent(ed.m_iLocalID, NULL, 0, ke.data(), (int)ke.size(), &tmout);
+            IF_HEAVY_LOGGING(const int prev_total = total);
 
-                for (int i = 0; i < nfds; ++ i)
+            for (int i = 0; i < nfds; ++ i)
+            {
+                if ((NULL != lrfds) && (ke[i].filter == EVFILT_READ))
                 {
-                    if ((NULL != lrfds) && (ke[i].filter == EVFILT_READ))
-                    {
-                        lrfds->insert((int)ke[i].ident);
-                        ++ total;
-                    }
-                    if ((NULL != lwfds) && (ke[i].filter == EVFILT_WRITE))
-                    {
-                        lwfds->insert((int)ke[i].ident);
-                        ++ total;
-                    }
+                    lrfds->insert((int)ke[i].ident);
+                    ++ total;
+                }
+                if ((NULL != lwfds) && (ke[i].filter == EVFILT_WRITE))
+                {
+                    lwfds->insert((int)ke[i].ident);
+                    ++ total;
                 }
+            }
 
-                HLOGC(ealog.Debug, log << "CEPoll::wait: Darwin/BSD: picking up " << (total - prev_total)  << " ready fds.");
+            HLOGC(ealog.Debug, log << "CEPoll::wait: Darwin/BSD: picking up " << (total - prev_total)  << " ready fds.");
 
 #else
-                //currently "select" is used for all non-Linux platforms.
-                //faster approaches can be applied for specific systems in the future.
+            //currently "select" is used for all non-Linux platforms.
+            //faster approaches can be applied for specific systems in the future.
 
-                //"select" has a limitation on the number of sockets
-                int max_fd = 0;
+            //"select" has a limitation on the number of sockets
+            int max_fd = 0;
 
-                fd_set rqreadfds;
-                fd_set rqwritefds;
-                FD_ZERO(&rqreadfds);
-                FD_ZERO(&rqwritefds);
+            fd_set rqreadfds;
+            fd_set rqwritefds;
+            FD_ZERO(&rqreadfds);
+            FD_ZERO(&rqwritefds);
 
-                for (set<SYSSOCKET>::const_iterator i = ed.m_sLocals.begin(); i != ed.m_sLocals.end(); ++ i)
-                {
-                    if (lrfds)
-                        FD_SET(*i, &rqreadfds);
-                    if (lwfds)
-                        FD_SET(*i, &rqwritefds);
-                    if ((int)*i > max_fd)
-                        max_fd = (int)*i;
-                }
+            for (set<SYSSOCKET>::const_iterator i = ed.m_sLocals.begin(); i != ed.m_sLocals.end(); ++ i)
+            {
+                if (lrfds)
+                    FD_SET(*i, &rqreadfds);
+                if (lwfds)
+                    FD_SET(*i, &rqwritefds);
+                if ((int)*i > max_fd)
+                    max_fd = (int)*i;
+            }
 
-                IF_HEAVY_LOGGING(const int prev_total = total);
-                timeval tv;
-                tv.tv_sec = 0;
-                tv.tv_usec = 0;
-                if (::select(max_fd + 1, &rqreadfds, &rqwritefds, NULL, &tv) > 0)
+            IF_HEAVY_LOGGING(const int prev_total = total);
+            timeval tv;
+            tv.tv_sec = 0;
+            tv.tv_usec = 0;
+            if (::select(max_fd + 1, &rqreadfds, &rqwritefds, NULL, &tv) > 0)
+            {
+                for (set<SYSSOCKET>::const_iterator i = ed.m_sLocals.begin(); i != ed.m_sLocals.end(); ++ i)
                 {
-                    for (set<SYSSOCKET>::const_iterator i = ed.m_sLocals.begin(); i != ed.m_sLocals.end(); ++ i)
+                    if (lrfds && FD_ISSET(*i, &rqreadfds))
+                    {
+                        lrfds->insert(*i);
+                        ++ total;
+                    }
+                    if (lwfds && FD_ISSET(*i, &rqwritefds))
                     {
-                        if (lrfds && FD_ISSET(*i, &rqreadfds))
-                        {
-                            lrfds->insert(*i);
-                            ++ total;
-                        }
-                        if (lwfds && FD_ISSET(*i, &rqwritefds))
-                        {
-                            lwfds->insert(*i);
-                            ++ total;
-                        }
+                        lwfds->insert(*i);
+                        ++ total;
                     }
                 }
-
-                HLOGC(ealog.Debug, log << "CEPoll::wait: select(otherSYS): picking up " << (total - prev_total)  << " ready fds.");
-#endif
             }
 
-        } // END-LOCK: m_EPollLock
+            HLOGC(ealog.Debug, log << "CEPoll::wait: select(otherSYS): picking up " << (total - prev_total)  << " ready fds.");
+#endif
+        }
 
         HLOGC(ealog.Debug, log << "CEPoll::wait: Total of " << total << " READY SOCKETS");
 
         if (total > 0)
+        {
+            ed.updateNotifyFD();
             return total;
+        }
 
         if ((msTimeOut >= 0) && (count_microseconds(srt::sync::steady_clock::now() - entertime) >= msTimeOut * int64_t(1000)))
         {
@@ -744,9 +765,9 @@ int srt::CEPoll::wait(const int eid, set<SRTSOCKET>* readfds, set<SRTSOCKET>* wr
             throw CUDTException(MJ_AGAIN, MN_XMTIMEOUT, 0);
         }
 
-        const bool wait_signaled SRT_ATR_UNUSED = CGlobEvent::waitForEvent();
-        HLOGC(ealog.Debug, log << "CEPoll::wait: EVENT WAITING: "
-            << (wait_signaled ? "TRIGGERED" : "CHECKPOINT"));
+        // The system sockets can't signal, so they are polled periodically.
+        waitSignal(epollock, ed, entertime, msTimeOut, (lrfds || lwfds) && !ed.m_sLocals.empty());
+        HLOGC(ealog.Debug, log << "CEPoll::wait: EVENT WAITING: WOKEN UP");
     }
 
     return 0;
@@ -754,16 +775,21 @@ int srt::CEPoll::wait(const int eid, set<SRTSOCKET>* readfds, set<SRTSOCKET>* wr
 
 int srt::CEPoll::swait(CEPollDesc& d, map<SRTSOCKET, int>& st, int64_t msTimeOut, bool report_by_exception)
 {
+    // Not extracting separately because this function is
+    // for internal use only and we state that the eid could
+    // not be deleted or changed the target CEPollDesc in the
+    // meantime.
+
+    // Here we only prevent the pollset be updated simultaneously
+    // with unstable reading.
+    UniqueLock lg (m_EPollLock);
+    if (!d.flags(SRT_EPOLL_ENABLE_EMPTY) && d.watch_empty() && msTimeOut < 0)
     {
-        ScopedLock lg (m_EPollLock);
-        if (!d.flags(SRT_EPOLL_ENABLE_EMPTY) && d.watch_empty() && msTimeOut < 0)
-        {
-            // no socket is being monitored, this may be a deadlock
-            LOGC(ealog.Error, log << "EID:" << d.m_iID << " no sockets to check, this would deadlock");
-            if (report_by_exception)
-                throw CUDTException(MJ_NOTSUP, MN_EEMPTY, 0);
-            return -1;
-        }
+        // no socket is being monitored, this may be a deadlock
+        LOGC(ealog.Error, log << "EID:" << d.m_iID << " no sockets to check, this would deadlock");
+        if (report_by_exception)
+            throw CUDTException(MJ_NOTSUP, MN_EEMPTY, 0);
+        return -1;
     }
 
     st.clear();
@@ -771,59 +797,49 @@ int srt::CEPoll::swait(CEPollDesc& d, map<SRTSOCKET, int>& st, int64_t msTimeOut
     steady_clock::time_point entertime = steady_clock::now();
     while (true)
     {
+        if (!d.flags(SRT_EPOLL_ENABLE_EMPTY) && d.watch_empty())
         {
-            // Not extracting separately because this function is
-            // for internal use only and we state that the eid could
-            // not be deleted or changed the target CEPollDesc in the
-            // meantime.
+            // Empty EID is not allowed, report error.
+            throw CUDTException(MJ_NOTSUP, MN_EEMPTY);
+        }
 
-            // Here we only prevent the pollset be updated simultaneously
-            // with unstable reading. 
-            ScopedLock lg (m_EPollLock);
+        if (!d.m_sLocals.empty())
+        {
+            // XXX Add error log
+            // uwait should not be used with EIDs subscribed to system sockets
+            throw CUDTException(MJ_NOTSUP, MN_INVAL);
+        }
 
-            if (!d.flags(SRT_EPOLL_ENABLE_EMPTY) && d.watch_empty())
-            {
-                // Empty EID is not allowed, report error.
-                throw CUDTException(MJ_NOTSUP, MN_EEMPTY);
-            }
+        bool empty = d.enotice_empty();
 
-            if (!d.m_sLocals.empty())
+        if (!empty || msTimeOut == 0)
+        {
+            IF_HEAVY_LOGGING(ostringstream singles);
+            // If msTimeOut == 0, it means that we need the information
+            // immediately, we don't want to wait. Therefore in this case
+            // report also when none is ready.
+            int total = 0; // This is a list, so count it during iteration
+            CEPollDesc::enotice_t::iterator i = d.enotice_begin();
+            while (i != d.enotice_end())
             {
-                // XXX Add error log
-                // uwait should not be used with EIDs subscribed to system sockets
-                throw CUDTException(MJ_NOTSUP, MN_INVAL);
+                ++total;
+                st[i->fd] = i->events;
+                IF_HEAVY_LOGGING(singles << "@" << i->fd << ":");
+                IF_HEAVY_LOGGING(PrintEpollEvent(singles, i->events, i->parent->edgeOnly()));
+                const bool edged SRT_ATR_UNUSED = d.checkEdge(i++); // NOTE: potentially deletes `i`
+                IF_HEAVY_LOGGING(singles << (edged ? "<^> " : " "));
             }
+            d.updateNotifyFD();
 
-            bool empty = d.enotice_empty();
-
-            if (!empty || msTimeOut == 0)
-            {
-                IF_HEAVY_LOGGING(ostringstream singles);
-                // If msTimeOut == 0, it means that we need the information
-                // immediately, we don't want to wait. Therefore in this case
-                // report also when none is ready.
-                int total = 0; // This is a list, so count it during iteration
-                CEPollDesc::enotice_t::iterator i = d.enotice_begin();
-                while (i != d.enotice_end())
-                {
-                    ++total;
-                    st[i->fd] = i->events;
-                    IF_HEAVY_LOGGING(singles << "@" << i->fd << ":");
-                    IF_HEAVY_LOGGING(PrintEpollEvent(singles, i->events, i->parent->edgeOnly()));
-                    const bool edged SRT_ATR_UNUSED = d.checkEdge(i++); // NOTE: potentially deletes `i`
-                    IF_HEAVY_LOGGING(singles << (edged ? "<^> " : " "));
-                }
-
-                // Logging into 'singles' because it notifies as to whether
-                // the edge-triggered event has been cleared
-                HLOGC(ealog.Debug, log << "E" << d.m_iID << " rdy=" << total << ": "
-                        << singles.str()
-                        << " TRACKED: " << d.DisplayEpollWatch());
-                return total;
-            }
-            // Don't report any updates because this check happens
-            // extremely often.
+            // Logging into 'singles' because it notifies as to whether
+            // the edge-triggered event has been cleared
+            HLOGC(ealog.Debug, log << "E" << d.m_iID << " rdy=" << total << ": "
+                    << singles.str()
+                    << " TRACKED: " << d.DisplayEpollWatch());
+            return total;
         }
+        // Don't report any updates because this check happens
+        // extremely often.
 
         if ((msTimeOut >= 0) && ((steady_clock::now() - entertime) >= microseconds_from(msTimeOut * int64_t(1000))))
         {
@@ -833,7 +849,7 @@ int srt::CEPoll::swait(CEPollDesc& d, map<SRTSOCKET, int>& st, int64_t msTimeOut
             return 0; // meaning "none is ready"
         }
 
-        CGlobEvent::waitForEvent();
+        waitSignal(lg, d, entertime, msTimeOut, false);
     }
 
     return 0;
@@ -856,15 +872,110 @@ int srt::CEPoll::release(const int eid)
    #ifdef LINUX
    // release local/system epoll descriptor
    ::close(i->second.m_iLocalID);
+   if (i->second.m_iNotifyFD != -1)
+      ::close(i->second.m_iNotifyFD);
    #elif defined(BSD) || TARGET_OS_MAC
    ::close(i->second.m_iLocalID);
    #endif
 
+   // The threads still waiting find the EID gone; the last one deletes the wakeup.
+   CEPollDesc::Wakeup* w = i->second.m_pWakeup;
+   if (w->waiters)
+   {
+      w->released = true;
+      w->cond.notify_all();
+   }
+   else
+   {
+      releaseCond(w->cond);
+      delete w;
+   }
+
    m_mPolls.erase(i);
 
    return 0;
 }
 
+int srt::CEPoll::notify_fd(const int eid)
+{
+   ScopedLock pg(m_EPollLock);
+
+   map<int, CEPollDesc>::iterator i = m_mPolls.find(eid);
+   if (i == m_mPolls.end())
+      throw CUDTException(MJ_NOTSUP, MN_EIDINVAL);
+
+#ifdef LINUX
+   CEPollDesc& d = i->second;
+   if (d.m_iNotifyFD == -1)
+   {
+      int flags = EFD_NONBLOCK;
+      #if ENABLE_SOCK_CLOEXEC
+      flags |= EFD_CLOEXEC;
+      #endif
+      d.m_iNotifyFD = ::eventfd(0, flags);
+      if (d.m_iNotifyFD == -1)
+         throw CUDTException(MJ_SETUP, MN_NONE, errno);
+      d.m_bNotifySet = false;
+      d.updateNotifyFD();
+   }
+   return d.m_iNotifyFD;
+#else
+   // XXX kqueue could provide it with EVFILT_USER.
+   throw CUDTException(MJ_NOTSUP, MN_NONE);
+#endif
+}
+
+void srt::CEPoll::waitSignal(UniqueLock& lk, CEPollDesc& d, const steady_clock::time_point& entertime,
+                             int64_t msTimeOut, bool poll_locals)
+{
+   steady_clock::time_point until;
+   if (msTimeOut >= 0)
+      until = entertime + milliseconds_from(msTimeOut);
+   if (poll_locals)
+   {
+      const steady_clock::time_point next_poll = steady_clock::now() + milliseconds_from(10);
+      if (is_zero(until) || next_poll < until)
+         until = next_poll;
+   }
+
+   // The descriptor may be erased while waiting, but not the wakeup.
+   CEPollDesc::Wakeup* w = d.m_pWakeup;
+   ++w->waiters;
+   if (is_zero(until))
+      w->cond.wait(lk);
+   else
+      w->cond.wait_until(lk, until);
+   --w->waiters;
+
+   if (w->released && w->waiters == 0)
+   {
+      releaseCond(w->cond);
+      delete w;
+   }
+}
+
+void srt::CEPollDesc::updateNotifyFD()
+{
+#ifdef LINUX
+   if (m_iNotifyFD == -1)
+      return;
+
+   const bool ready = !m_USockEventNotice.empty();
+   if (ready == m_bNotifySet)
+      return;
+
+   uint64_t val = 1;
+   const ssize_t res = ready ? ::write(m_iNotifyFD, &val, sizeof val) : ::read(m_iNotifyFD, &val, sizeof val);
+   if (res != (ssize_t)sizeof val)
+   {
+      LOGC(eilog.Error, log << "epoll: E" << m_iID << " failed to " << (ready ? "set" : "clear")
+              << " the notify descriptor: " << SysStrError(errno));
+      return;
+   }
+   m_bNotifySet = ready;
+#endif
+}
+
 
 int srt::CEPoll::update_events(const SRTSOCKET& uid, std::set<int>& eids, const int events, const bool enable)
 {
@@ -939,6 +1050,7 @@ int srt::CEPoll::update_events(const SRTSOCKET& uid, std::set<int>& eids, const
         // - if enable, it will set event flags, possibly in a new notice object
         // - if !enable, it will clear event flags, possibly remove notice if resulted in 0
         ed.updateEventNotice(*pwait, uid, events, enable);
+        ed.signal();
         ++nupdated;
 
         HLOGC(eilog.Debug, log << debug.str() << ": E" << (*i)
@@ -58,6 +58,7 @@ modified by
 #include <set>
 #include <list>
 #include "udt.h"
+#include "sync.h"
 
 namespace srt
 {
@@ -165,6 +166,22 @@ std::string DisplayEpollWatch();
    // Special behavior
    int32_t m_Flags;
 
+   /// Wakes up only the threads waiting on this EID. Allocated separately,
+   /// as the descriptor is copied into the container, and it is deleted by
+   /// the last waiting thread if the EID is released while waited on.
+   struct Wakeup
+   {
+       srt::sync::Condition cond;
+       int                  waiters;  // number of threads waiting on `cond`
+       bool                 released; // the EID no longer exists
+   };
+   Wakeup* m_pWakeup;
+
+   /// System descriptor readable as long as any event is ready (see srt_epoll_notify_fd),
+   /// or -1 if not requested.
+   int  m_iNotifyFD;
+   bool m_bNotifySet; // the descriptor is currently readable
+
    enotice_t::iterator nullNotice() { return m_USockEventNotice.end(); }
 
    // Only CEPoll class should have access to it.
@@ -175,10 +192,26 @@ std::string DisplayEpollWatch();
    CEPollDesc(int id, int localID)
        : m_iID(id)
        , m_Flags(0)
+       , m_pWakeup(NULL)
+       , m_iNotifyFD(-1)
+       , m_bNotifySet(false)
        , m_iLocalID(localID)
     {
     }
 
+   /// Wake up the threads waiting on this EID and update the notify descriptor.
+   /// To be called, with CEPoll::m_EPollLock locked, after any change that may
+   /// affect the result of waiting.
+   void signal()
+   {
+       if (m_pWakeup->waiters)
+           m_pWakeup->cond.notify_all();
+       updateNotifyFD();
+   }
+
+   /// Make the notify descriptor readable exactly when any event is ready.
+   void updateNotifyFD();
+
    static const int32_t EF_NOCHECK_EMPTY = 1 << 0;
    static const int32_t EF_CHECK_REP = 1 << 1;
 
@@ -477,6 +510,13 @@ public: // for CUDTUnited API
 
    int release(const int eid);
 
+   /// get a system file descriptor that is readable as long as any event is
+   /// ready in the EPoll, to be waited on together with other descriptors.
+   /// @param [in] eid EPoll ID.
+   /// @return the descriptor, owned by the EPoll.
+
+   int notify_fd(const int eid);
+
 public: // for CUDT to acknowledge IO status
 
    /// Update events available for a UDT socket. At the end this function
@@ -492,6 +532,16 @@ public: // for CUDT to acknowledge IO status
    int setflags(const int eid, int32_t flags);
 
 private:
+   /// Wait until the EID is signaled, or until the timeout since @a entertime.
+   /// The descriptor may no longer exist when this returns.
+   /// @param lk lock on m_EPollLock
+   /// @param d the descriptor to wait on
+   /// @param entertime the time when the waiting started
+   /// @param msTimeOut timeout in milliseconds, -1 for infinite
+   /// @param poll_locals if true, wait at most 10ms, as the system sockets don't signal
+   void waitSignal(srt::sync::UniqueLock& lk, CEPollDesc& d, const srt::sync::steady_clock::time_point& entertime,
+                   int64_t msTimeOut, bool poll_locals);
+
    int m_iIDSeed;                            // seed to generate a new ID
    srt::sync::Mutex m_SeedLock;
 
@@ -392,12 +392,11 @@ void FECFilterBuiltin::ResetGroup(Group& g)
     g.collected = 0;
 
     // This isn't necessary for ConfigureGroup because the
-    // vector after resizing is filled with a given value,
-    // by default the default value of the type, char(), that is 0.
+    // buffer after resizing is filled with zeros.
     g.length_clip = 0;
     g.flag_clip = 0;
     g.timestamp_clip = 0;
-    memset(&g.payload_clip[0], 0, g.payload_clip.size());
+    memset(g.payload_clip.data(), 0, g.payload_clip.size());
 }
 
 void FECFilterBuiltin::feedSource(CPacket& packet)
@@ -598,18 +597,12 @@ void FECFilterBuiltin::ClipData(Group& g, uint16_t length_net, uint8_t kflg,
     g.flag_clip = g.flag_clip ^ kflg;
     g.timestamp_clip = g.timestamp_clip ^ timestamp_hw;
 
-    // Payload goes "as is".
-    for (size_t i = 0; i < payload_size; ++i)
-    {
-        g.payload_clip[i] = g.payload_clip[i] ^ payload[i];
-    }
-
-    // Fill the rest with zeros. When this packet is going to be
-    // recovered, the payload extracted from this process will have
-    // the maximum length, but it will be cut to the right length
+    // Payload goes "as is". The rest of the clip stays as it is,
+    // as if XOR-ed with the padding zeros. When this packet is going
+    // to be recovered, the payload extracted from this process will
+    // have the maximum length, but it will be cut to the right length
     // and these padding 0s taken out.
-    for (size_t i = payload_size; i < payloadSize(); ++i)
-        g.payload_clip[i] = g.payload_clip[i] ^ 0;
+    xorInto(g.payload_clip.data(), payload, payload_size);
 }
 
 bool FECFilterBuiltin::packControlPacket(SrtPacket& rpkt, int32_t seq)
@@ -1456,7 +1449,7 @@ void FECFilterBuiltin::RcvRebuild(Group& g, int32_t seqno, Group::Type tp)
 
     // The payload clip may be longer than length_hw, but it
     // contains only trailing zeros for completion, which are skipped.
-    copy(g.payload_clip.begin(), g.payload_clip.end(), p.buffer);
+    memcpy(p.buffer, g.payload_clip.data(), g.payload_clip.size());
 
     HLOGC(pflog.Debug, log << "FEC: REBUILT: %" << seqno
             << " msgno=" << MSGNO_SEQ::unwrap(p.hdr[SRT_PH_MSGNO])
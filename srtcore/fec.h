@@ -18,6 +18,7 @@
 #include <deque>
 
 #include "packetfilter_api.h"
+#include "fec_xor.h"
 
 namespace srt {
 
@@ -54,7 +55,7 @@ public:
         uint16_t length_clip;
         uint8_t flag_clip;
         uint32_t timestamp_clip;
-        std::vector<char> payload_clip;
+        CAlignedBuffer payload_clip;
 
         // This is mutable because it's an intermediate buffer for
         // the purpose of output.
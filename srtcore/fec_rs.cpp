@@ -0,0 +1,523 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#include "platform_sys.h"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <iterator>
+
+#include "packetfilter.h"
+#include "core.h"
+#include "packet.h"
+#include "logging.h"
+
+#include "fec_rs.h"
+
+// Maximum number of blocks remembered by the receiver, to rebuild
+// the packets of a block when its repair packets come late.
+#define SRT_RS_MAX_RCV_HISTORY 10
+
+using namespace std;
+using namespace srt_logging;
+
+namespace srt {
+
+const char RSFilterBuiltin::defaultConfig [] = "rs,m:2,arq:onreq";
+
+bool RSFilterBuiltin::verifyConfig(const SrtFilterConfig& cfg, string& w_error)
+{
+    string kspec = map_get(cfg.parameters, "k"), mspec = map_get(cfg.parameters, "m");
+
+    int k = 1, m = 2;
+    if (kspec != "")
+    {
+        k = atoi(kspec.c_str());
+        if (k < 1)
+        {
+            w_error = "'k' must be >= 1";
+            return false;
+        }
+    }
+
+    if (mspec != "")
+    {
+        m = atoi(mspec.c_str());
+        if (m < 1)
+        {
+            w_error = "'m' must be >= 1";
+            return false;
+        }
+    }
+
+    // Every packet in the block needs a distinct element of GF(2^8)
+    // in the Cauchy matrix.
+    if (k + m > 256)
+    {
+        w_error = "'k' + 'm' must be <= 256";
+        return false;
+    }
+
+    string level = map_get(cfg.parameters, "arq");
+    if (level != "" && level != "never" && level != "onreq" && level != "always")
+    {
+        w_error = "'arq' value '" + level + "' invalid. Allowed: never, onreq, always";
+        return false;
+    }
+
+    for (map<string, string>::const_iterator i = cfg.parameters.begin(); i != cfg.parameters.end(); ++i)
+    {
+        if (i->first != "k" && i->first != "m" && i->first != "arq")
+        {
+            w_error = "Extra parameters. Allowed only: k, m, arq";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+RSFilterBuiltin::RSFilterBuiltin(const SrtFilterInitializer& init, std::vector<SrtPacket>& provided, const string& confstr)
+    : SrtPacketFilterBase(init)
+    , m_fallback_level(SRT_ARQ_ONREQ)
+    , rcv(provided)
+{
+    if (!ParseFilterConfig(confstr, cfg))
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+    string ermsg;
+    if (!verifyConfig(cfg, (ermsg)))
+    {
+        LOGC(pflog.Error, log << "IPE: Filter config failed: " << ermsg);
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+    }
+
+    string kspec = map_get(cfg.parameters, "k"), mspec = map_get(cfg.parameters, "m");
+    if (kspec == "")
+    {
+        LOGC(pflog.Error, log << "RS filter config: parameter 'k' is mandatory");
+        throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+    }
+
+    m_number_source = atoi(kspec.c_str());
+    m_number_repair = mspec == "" ? 2 : atoi(mspec.c_str());
+
+    string level = map_get(cfg.parameters, "arq");
+    if (level == "never")
+        m_fallback_level = SRT_ARQ_NEVER;
+    else if (level == "always")
+        m_fallback_level = SRT_ARQ_ALWAYS;
+
+    // The Cauchy matrix 1/(x[j] + y[i]) with x[j] = j and y[i] = M + i,
+    // every column divided by its element in the first row. Scaling the
+    // columns keeps every square submatrix nonsingular, so any K packets
+    // out of the block suffice to rebuild it.
+    m_coefficients.resize(m_number_repair * m_number_source);
+    for (size_t i = 0; i < m_number_source; ++i)
+    {
+        // The first row is 1/(0 + y), so the column is multiplied by y.
+        const uint8_t y = uint8_t(m_number_repair + i);
+        for (size_t j = 0; j < m_number_repair; ++j)
+            m_coefficients[j * m_number_source + i] = gfMul(gfInv(uint8_t(j) ^ y), y);
+    }
+
+    rcv.id = socketID();
+
+    // The blocks start at the ISN on both sides.
+    snd.base = CSeqNo::incseq(sndISN());
+    snd.collected = 0;
+    snd.next_repair = 0;
+    snd.timestamp = 0;
+    snd.repair.resize(m_number_repair);
+    for (size_t j = 0; j < m_number_repair; ++j)
+        ConfigureShard(snd.repair[j]);
+
+    size_t history = SRT_RS_MAX_RCV_HISTORY;
+    if (history * m_number_source > rcvBufferSize() / 2)
+        history = max<size_t>(2, rcvBufferSize() / 2 / m_number_source);
+
+    rcv.blocks.resize(history);
+    rcv.newest = 0;
+    rcv.newest_base = CSeqNo::incseq(rcvISN());
+    ResetBlock(rcv.blocks[0], 0, rcv.newest_base);
+
+    HLOGC(pflog.Debug, log << "RS: INIT: K=" << m_number_source << " M=" << m_number_repair
+            << " ISN { snd=" << snd.base << " rcv=" << rcv.newest_base << " } history=" << history << " blocks");
+}
+
+void RSFilterBuiltin::ConfigureShard(Shard& s) const
+{
+    s.data.resize(Shard::PAYLOAD_OFFSET + payloadSize());
+}
+
+void RSFilterBuiltin::PacketMeta(const CPacket& pkt, char* w_meta)
+{
+    // The message number with all its flags, unknown for a lost packet,
+    // goes in network order like the timestamp and the length.
+    const uint32_t msgno = htonl(uint32_t(pkt.m_iMsgNo));
+    const uint32_t timestamp = htonl(pkt.getMsgTimeStamp());
+    const uint16_t length = htons(uint16_t(pkt.size()));
+
+    memcpy(w_meta, &msgno, sizeof msgno);
+    memcpy(w_meta + 4, &timestamp, sizeof timestamp);
+    memcpy(w_meta + 8, &length, sizeof length);
+}
+
+void RSFilterBuiltin::ShardFromPacket(const CPacket& pkt, Shard& w_shard) const
+{
+    PacketMeta(pkt, (w_shard.meta()));
+
+    // The payload is coded with the padding zeros up to the payload size.
+    memcpy(w_shard.payload(), pkt.data(), pkt.size());
+    memset(w_shard.payload() + pkt.size(), 0, payloadSize() - pkt.size());
+}
+
+void RSFilterBuiltin::MulAddShard(Shard& dst, Shard& src, uint8_t c) const
+{
+    gfMulAddInto(dst.meta(), src.meta(), c, Shard::META_SIZE);
+    gfMulAddInto(dst.payload(), src.payload(), c, payloadSize());
+}
+
+void RSFilterBuiltin::feedSource(CPacket& packet)
+{
+    const int pos = CSeqNo::seqoff(snd.base, packet.getSeqNo());
+    if (pos < 0 || pos >= int(m_number_source) || packet.size() > payloadSize())
+    {
+        LOGC(pflog.Error, log << "RS: feedSource: IPE: %" << packet.getSeqNo() << " size=" << packet.size()
+                << " outside the block %" << snd.base << " +" << m_number_source << ", NOT CODED");
+        return;
+    }
+
+    // Code the packet directly into the repair packets, without
+    // making the shard with the padding.
+    char meta[Shard::META_SIZE];
+    PacketMeta(packet, (meta));
+
+    for (size_t j = 0; j < m_number_repair; ++j)
+    {
+        const uint8_t c = coefficient(j, pos);
+        gfMulAddInto(snd.repair[j].meta(), meta, c, Shard::META_SIZE);
+        gfMulAddInto(snd.repair[j].payload(), packet.data(), c, packet.size());
+    }
+
+    snd.timestamp = packet.getMsgTimeStamp();
+    snd.collected++;
+
+    HLOGC(pflog.Debug, log << "RS: feedSource: %" << packet.getSeqNo() << " [" << pos << "] size=" << packet.size()
+            << " collected " << snd.collected << "/" << m_number_source);
+}
+
+bool RSFilterBuiltin::packControlPacket(SrtPacket& rpkt, int32_t seq)
+{
+    // The repair packets follow the last packet of the block, one
+    // instead of every next data packet until all are sent.
+    if (snd.collected < m_number_source)
+        return false;
+
+    Shard& r = snd.repair[snd.next_repair];
+
+    char* out = rpkt.buffer;
+    out[0] = char(snd.next_repair);
+    out[1] = 0;
+    memcpy(out + 2, r.meta(), Shard::META_SIZE);
+    memcpy(out + EXTRA_SIZE, r.payload(), payloadSize());
+    rpkt.length = EXTRA_SIZE + payloadSize();
+
+    // The sequence number of the last packet in the block identifies
+    // the block for the receiver.
+    rpkt.hdr[SRT_PH_SEQNO] = seq;
+    rpkt.hdr[SRT_PH_TIMESTAMP] = snd.timestamp;
+
+    HLOGC(pflog.Debug, log << "RS/CTL: repair [" << snd.next_repair << "] for block %" << snd.base << " at %" << seq);
+
+    if (++snd.next_repair == m_number_repair)
+    {
+        snd.base = CSeqNo::incseq(snd.base, int(m_number_source));
+        snd.collected = 0;
+        snd.next_repair = 0;
+        for (size_t j = 0; j < m_number_repair; ++j)
+            memset(snd.repair[j].data.data(), 0, snd.repair[j].data.size());
+    }
+    return true;
+}
+
+void RSFilterBuiltin::ResetBlock(Block& b, int64_t number, int32_t base)
+{
+    // The shards aren't cleared, they are overwritten when received.
+    if (b.shards.empty())
+    {
+        b.shards.resize(m_number_source + m_number_repair);
+        for (size_t i = 0; i < b.shards.size(); ++i)
+            ConfigureShard(b.shards[i]);
+    }
+    b.number = number;
+    b.base = base;
+    b.received.assign(m_number_source + m_number_repair, false);
+    b.nsource = 0;
+    b.nrepair = 0;
+    b.done = false;
+    b.closed = false;
+}
+
+RSFilterBuiltin::Block* RSFilterBuiltin::RcvGetBlock(int32_t seqno, loss_seqs_t& irrecover)
+{
+    const int64_t history = int64_t(rcv.blocks.size());
+    const int64_t k = int64_t(m_number_source);
+
+    // Floor division, so that a preceding sequence gets the preceding block.
+    const int64_t off = CSeqNo::seqoff(rcv.newest_base, seqno);
+    const int64_t number = rcv.newest + (off >= 0 ? off / k : -((-off + k - 1) / k));
+
+    if (number < 0 || number <= rcv.newest - history)
+    {
+        HLOGC(pflog.Debug, log << "RS: %" << seqno << " in the block #" << number << " too old, newest #" << rcv.newest);
+        return NULL;
+    }
+
+    if (number > rcv.newest)
+    {
+        // Take over the slots of the oldest blocks, reporting what they
+        // didn't rebuild.
+        const int64_t first = max(rcv.newest + 1, number - history + 1);
+        for (int64_t n = first; n <= number; ++n)
+        {
+            Block& b = rcv.blocks[size_t(n % history)];
+            if (b.number >= 0 && !b.closed)
+                CollectIrrecover(b, irrecover);
+            ResetBlock(b, n, CSeqNo::incseq(rcv.newest_base, int((n - rcv.newest) * k)));
+        }
+
+        rcv.newest_base = CSeqNo::incseq(rcv.newest_base, int((number - rcv.newest) * k));
+        rcv.newest = number;
+    }
+
+    Block& b = rcv.blocks[size_t(number % history)];
+    if (b.number != number)
+        return NULL;
+    return &b;
+}
+
+bool RSFilterBuiltin::receive(const CPacket& rpkt, loss_seqs_t& loss_seqs)
+{
+    loss_seqs_t irrecover;
+    const bool is_repair = rpkt.getMsgSeq() == SRT_MSGNO_CONTROL;
+    Block* b = RcvGetBlock(rpkt.getSeqNo(), (irrecover));
+
+    if (is_repair)
+    {
+        const size_t index = uint8_t(rpkt.data()[0]);
+        if (rpkt.size() != EXTRA_SIZE + payloadSize() || index >= m_number_repair)
+        {
+            LOGC(pflog.Warn, log << "RS: repair packet %" << rpkt.getSeqNo() << " index=" << index
+                    << " size=" << rpkt.size() << " doesn't match the configuration, IGNORED");
+        }
+        else if (b && !b->done && !b->received[m_number_source + index])
+        {
+            Shard& s = b->shards[m_number_source + index];
+            memcpy(s.meta(), rpkt.data() + 2, Shard::META_SIZE);
+            memcpy(s.payload(), rpkt.data() + EXTRA_SIZE, payloadSize());
+            b->received[m_number_source + index] = true;
+            b->nrepair++;
+        }
+    }
+    else if (b && !b->done)
+    {
+        const size_t pos = CSeqNo::seqoff(b->base, rpkt.getSeqNo());
+        if (rpkt.size() > payloadSize())
+        {
+            LOGC(pflog.Warn, log << "RS: %" << rpkt.getSeqNo() << " size=" << rpkt.size()
+                    << " exceeds the payload size, NOT CODED");
+        }
+        else if (!b->received[pos])
+        {
+            ShardFromPacket(rpkt, (b->shards[pos]));
+            b->received[pos] = true;
+            b->nsource++;
+        }
+    }
+
+    if (b)
+        RcvRebuild(*b);
+
+    // A data packet of a later block comes after the repair packets of the
+    // earlier blocks, so what these couldn't rebuild is lost, unless
+    // reordered.
+    if (b && !is_repair)
+    {
+        for (size_t i = 0; i < rcv.blocks.size(); ++i)
+        {
+            Block& older = rcv.blocks[i];
+            if (older.number >= 0 && older.number < b->number && !older.closed)
+                CollectIrrecover(older, (irrecover));
+        }
+    }
+
+    if (m_fallback_level == SRT_ARQ_ONREQ)
+        loss_seqs = irrecover;
+
+    // The repair packets are never passed to the receiver buffer.
+    return !is_repair;
+}
+
+void RSFilterBuiltin::CollectIrrecover(Block& b, loss_seqs_t& irrecover)
+{
+    b.closed = true;
+    if (b.done)
+        return;
+
+    for (size_t i = 0; i < m_number_source; ++i)
+    {
+        if (b.received[i])
+            continue;
+
+        const int32_t seq = CSeqNo::incseq(b.base, int(i));
+        if (!irrecover.empty() && CSeqNo::incseq(irrecover.back().second) == seq)
+            irrecover.back().second = seq;
+        else
+            irrecover.push_back(make_pair(seq, seq));
+    }
+
+    HLOGC(pflog.Debug, log << "RS: block %" << b.base << " closed with " << b.nsource << "/" << m_number_source
+            << " source and " << b.nrepair << " repair packets, IRRECOVERABLE: " << Printable(irrecover));
+}
+
+void RSFilterBuiltin::RcvRebuild(Block& b)
+{
+    if (b.done)
+        return;
+
+    const size_t k = m_number_source;
+    if (b.nsource == k)
+    {
+        b.done = true;
+        return;
+    }
+
+    const size_t nlost = k - b.nsource;
+    if (b.nrepair < nlost)
+        return;
+
+    // The lost source packets and as many repair packets to rebuild them.
+    vector<size_t> lost, repair;
+    for (size_t i = 0; i < k; ++i)
+    {
+        if (!b.received[i])
+            lost.push_back(i);
+    }
+    for (size_t j = 0; j < m_number_repair && repair.size() < nlost; ++j)
+    {
+        if (b.received[k + j])
+            repair.push_back(j);
+    }
+
+    // Invert the matrix of the coefficients of the lost packets
+    // in the repair packets with the Gauss-Jordan elimination.
+    const size_t n = nlost;
+    vector<uint8_t> a(n * n), inv(n * n, 0);
+    for (size_t r = 0; r < n; ++r)
+    {
+        for (size_t c = 0; c < n; ++c)
+            a[r * n + c] = coefficient(repair[r], lost[c]);
+        inv[r * n + r] = 1;
+    }
+
+    for (size_t c = 0; c < n; ++c)
+    {
+        size_t pivot = c;
+        while (pivot < n && a[pivot * n + c] == 0)
+            ++pivot;
+        if (pivot == n)
+        {
+            LOGC(pflog.Error, log << "RS: IPE: singular matrix for block %" << b.base << ", NOT REBUILDING");
+            return;
+        }
+        for (size_t x = 0; x < n; ++x)
+        {
+            swap(a[c * n + x], a[pivot * n + x]);
+            swap(inv[c * n + x], inv[pivot * n + x]);
+        }
+
+        const uint8_t scale = gfInv(a[c * n + c]);
+        for (size_t x = 0; x < n; ++x)
+        {
+            a[c * n + x] = gfMul(a[c * n + x], scale);
+            inv[c * n + x] = gfMul(inv[c * n + x], scale);
+        }
+
+        for (size_t r = 0; r < n; ++r)
+        {
+            const uint8_t f = a[r * n + c];
+            if (r == c || f == 0)
+                continue;
+            for (size_t x = 0; x < n; ++x)
+            {
+                a[r * n + x] ^= gfMul(f, a[c * n + x]);
+                inv[r * n + x] ^= gfMul(f, inv[c * n + x]);
+            }
+        }
+    }
+
+    // Take the received source packets out of the repair packets,
+    // which leaves the combinations of the lost packets only.
+    for (size_t r = 0; r < n; ++r)
+    {
+        Shard& syndrome = b.shards[k + repair[r]];
+        for (size_t i = 0; i < k; ++i)
+        {
+            if (b.received[i])
+                MulAddShard(syndrome, b.shards[i], coefficient(repair[r], i));
+        }
+    }
+
+    for (size_t c = 0; c < n; ++c)
+    {
+        Shard& s = b.shards[lost[c]];
+        memset(s.meta(), 0, Shard::META_SIZE);
+        memset(s.payload(), 0, payloadSize());
+        for (size_t r = 0; r < n; ++r)
+            MulAddShard(s, b.shards[k + repair[r]], inv[c * n + r]);
+
+        uint32_t msgno, timestamp;
+        uint16_t length;
+        memcpy(&msgno, s.meta(), sizeof msgno);
+        memcpy(&timestamp, s.meta() + 4, sizeof timestamp);
+        memcpy(&length, s.meta() + 8, sizeof length);
+        const size_t length_hw = ntohs(length);
+        const int32_t seqno = CSeqNo::incseq(b.base, int(lost[c]));
+
+        if (length_hw > payloadSize())
+        {
+            LOGC(pflog.Warn, log << "RS: DECODED length '" << length_hw << "' of %" << seqno
+                    << " exceeds payload size. NOT REBUILDING.");
+            continue;
+        }
+
+        rcv.rebuilt.push_back(length_hw);
+        Receive::PrivPacket& p = rcv.rebuilt.back();
+
+        // The REXMIT flag is set because this packet comes out of order,
+        // just like with the "fec" filter.
+        p.hdr[SRT_PH_SEQNO] = seqno;
+        p.hdr[SRT_PH_MSGNO] = ntohl(msgno) | MSGNO_REXMIT::wrap(true);
+        p.hdr[SRT_PH_TIMESTAMP] = ntohl(timestamp);
+        p.hdr[SRT_PH_ID] = rcv.id;
+        memcpy(p.buffer, s.payload(), length_hw);
+
+        HLOGC(pflog.Debug, log << "RS: REBUILT: %" << seqno << " msgno=" << MSGNO_SEQ::unwrap(p.hdr[SRT_PH_MSGNO])
+                << " TS=" << p.hdr[SRT_PH_TIMESTAMP] << " size=" << length_hw);
+    }
+
+    // The repair packets used are now spoiled, so the block is over
+    // even if a rebuilt packet was dropped.
+    b.done = true;
+}
+
+} // namespace srt
@@ -0,0 +1,148 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#ifndef INC_SRT_FEC_RS_H
+#define INC_SRT_FEC_RS_H
+
+#include <string>
+#include <vector>
+
+#include "packetfilter_api.h"
+#include "fec_xor.h"
+
+namespace srt {
+
+/// The builtin "rs" filter: systematic Reed-Solomon coding with a Cauchy
+/// matrix over GF(2^8). For every block of K consecutive data packets
+/// M repair packets are sent, and any K packets of the block received
+/// out of these K+M suffice to rebuild the lost data packets.
+class RSFilterBuiltin: public SrtPacketFilterBase
+{
+    SrtFilterConfig cfg;
+    size_t m_number_source; // K
+    size_t m_number_repair; // M
+    SRT_ARQLevel m_fallback_level;
+
+    // The coding matrix: the coefficient of the source packet i in
+    // the repair packet j is at [j * K + i]. The first row is all 1,
+    // so the first repair packet is the XOR of the source packets.
+    std::vector<uint8_t> m_coefficients;
+
+    uint8_t coefficient(size_t repair, size_t source) const
+    {
+        return m_coefficients[repair * m_number_source + source];
+    }
+
+    // The coded form of a packet: the header fields that aren't known
+    // for a lost packet, followed by the payload padded with zeros up to
+    // the payload size. The payload starts at an aligned offset.
+    struct Shard
+    {
+        static const size_t META_SIZE = 10; // message number, timestamp, length
+        static const size_t PAYLOAD_OFFSET = 16;
+
+        CAlignedBuffer data;
+
+        char* meta() { return data.data(); }
+        char* payload() { return data.data() + PAYLOAD_OFFSET; }
+    };
+
+    static void PacketMeta(const CPacket& pkt, char* w_meta);
+    void ConfigureShard(Shard& s) const;
+    void ShardFromPacket(const CPacket& pkt, Shard& w_shard) const;
+    void MulAddShard(Shard& dst, Shard& src, uint8_t c) const;
+
+    struct Send
+    {
+        int32_t base;           //< Sequence of the first packet in the block
+        size_t collected;       //< Number of the source packets coded
+        size_t next_repair;     //< Index of the next repair packet to send
+        uint32_t timestamp;     //< Timestamp of the last source packet
+        std::vector<Shard> repair;
+    } snd;
+
+    struct Block
+    {
+        int64_t number;         //< Number of the block since the ISN, -1 if unused
+        int32_t base;           //< Sequence of the first packet in the block
+        std::vector<Shard> shards; // K source packets, then M repair packets
+        std::vector<bool> received;
+        size_t nsource;
+        size_t nrepair;
+        bool done;              //< All the source packets are there, received or rebuilt
+        bool closed;            //< The losses that can't be rebuilt are already reported
+
+        Block(): number(-1), base(SRT_SEQNO_NONE), nsource(0), nrepair(0), done(false), closed(false)
+        {
+        }
+    };
+
+    struct Receive
+    {
+        SRTSOCKET id;
+
+        // The block number is counted since the ISN, relative to
+        // the newest block, which makes it immune to the sequence
+        // number wrapping.
+        int64_t newest;
+        int32_t newest_base;
+
+        // The blocks in a ring, the block N in the slot N % size.
+        std::vector<Block> blocks;
+
+        typedef SrtPacket PrivPacket;
+        std::vector<PrivPacket>& rebuilt;
+
+        Receive(std::vector<SrtPacket>& provided): id(SRT_INVALID_SOCK), newest(0), newest_base(0), rebuilt(provided)
+        {
+        }
+    } rcv;
+
+    /// Find the block of the sequence, advancing the newest block if needed.
+    /// @return the block, or NULL if the block is too old to be remembered
+    Block* RcvGetBlock(int32_t seqno, loss_seqs_t& irrecover);
+    void ResetBlock(Block& b, int64_t number, int32_t base);
+    void RcvRebuild(Block& b);
+    void CollectIrrecover(Block& b, loss_seqs_t& irrecover);
+
+public:
+
+    RSFilterBuiltin(const SrtFilterInitializer& init, std::vector<SrtPacket>& provided, const std::string& confstr);
+
+    size_t numberSource() const { return m_number_source; }
+    size_t numberRepair() const { return m_number_repair; }
+
+    // Sender side
+
+    virtual bool packControlPacket(SrtPacket& r_packet, int32_t seq) ATR_OVERRIDE;
+    virtual void feedSource(CPacket& r_packet) ATR_OVERRIDE;
+
+    // Receiver side
+
+    virtual bool receive(const CPacket& pkt, loss_seqs_t& loss_seqs) ATR_OVERRIDE;
+
+    // Configuration
+
+    // The repair packet contains:
+    // - the index of the repair packet in the block
+    // - one reserved byte
+    // - the coded message number, timestamp and length
+    // - the coded payload, of the length of SRTO_PAYLOADSIZE.
+    static const size_t EXTRA_SIZE = 2 + Shard::META_SIZE;
+
+    virtual SRT_ARQLevel arqLevel() ATR_OVERRIDE { return m_fallback_level; }
+
+    static const char defaultConfig [];
+    static bool verifyConfig(const SrtFilterConfig& config, std::string& w_errormsg);
+};
+
+} // namespace srt
+
+#endif
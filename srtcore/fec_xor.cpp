@@ -0,0 +1,266 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#include "platform_sys.h"
+
+#include <cstring>
+
+#include "fec_xor.h"
+
+#if SRT_XOR_AVX2
+#include <immintrin.h>
+#elif SRT_XOR_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace srt
+{
+
+namespace
+{
+
+// 8 bytes at a time, with memcpy for the unaligned access,
+// which the compiler turns into plain loads and stores.
+void xorWords(char* dst, const char* src, size_t len)
+{
+    size_t i = 0;
+    for (; i + 4 * sizeof(uint64_t) <= len; i += 4 * sizeof(uint64_t))
+    {
+        uint64_t d[4], s[4];
+        memcpy(d, dst + i, sizeof d);
+        memcpy(s, src + i, sizeof s);
+        d[0] ^= s[0];
+        d[1] ^= s[1];
+        d[2] ^= s[2];
+        d[3] ^= s[3];
+        memcpy(dst + i, d, sizeof d);
+    }
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t))
+    {
+        uint64_t d, s;
+        memcpy(&d, dst + i, sizeof d);
+        memcpy(&s, src + i, sizeof s);
+        d ^= s;
+        memcpy(dst + i, &d, sizeof d);
+    }
+    for (; i < len; ++i)
+        dst[i] ^= src[i];
+}
+
+#if SRT_XOR_SSE2
+// A cache line at a time, then 16 bytes at a time.
+void xorSSE2(char* dst, const char* src, size_t len)
+{
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64)
+    {
+        __m128i* d  = reinterpret_cast<__m128i*>(dst + i);
+        const __m128i* s = reinterpret_cast<const __m128i*>(src + i);
+        const __m128i r0 = _mm_xor_si128(_mm_loadu_si128(d + 0), _mm_loadu_si128(s + 0));
+        const __m128i r1 = _mm_xor_si128(_mm_loadu_si128(d + 1), _mm_loadu_si128(s + 1));
+        const __m128i r2 = _mm_xor_si128(_mm_loadu_si128(d + 2), _mm_loadu_si128(s + 2));
+        const __m128i r3 = _mm_xor_si128(_mm_loadu_si128(d + 3), _mm_loadu_si128(s + 3));
+        _mm_storeu_si128(d + 0, r0);
+        _mm_storeu_si128(d + 1, r1);
+        _mm_storeu_si128(d + 2, r2);
+        _mm_storeu_si128(d + 3, r3);
+    }
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+        _mm_storeu_si128(d, _mm_xor_si128(_mm_loadu_si128(d), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+    }
+    xorWords(dst + i, src + i, len - i);
+}
+#endif
+
+#if SRT_XOR_AVX2
+// Two cache lines at a time, then 32 bytes at a time.
+__attribute__((target("avx2"))) void xorAVX2(char* dst, const char* src, size_t len)
+{
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128)
+    {
+        __m256i* d  = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i* s = reinterpret_cast<const __m256i*>(src + i);
+        const __m256i r0 = _mm256_xor_si256(_mm256_loadu_si256(d + 0), _mm256_loadu_si256(s + 0));
+        const __m256i r1 = _mm256_xor_si256(_mm256_loadu_si256(d + 1), _mm256_loadu_si256(s + 1));
+        const __m256i r2 = _mm256_xor_si256(_mm256_loadu_si256(d + 2), _mm256_loadu_si256(s + 2));
+        const __m256i r3 = _mm256_xor_si256(_mm256_loadu_si256(d + 3), _mm256_loadu_si256(s + 3));
+        _mm256_storeu_si256(d + 0, r0);
+        _mm256_storeu_si256(d + 1, r1);
+        _mm256_storeu_si256(d + 2, r2);
+        _mm256_storeu_si256(d + 3, r3);
+    }
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+        _mm256_storeu_si256(d, _mm256_xor_si256(_mm256_loadu_si256(d), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+    }
+    xorSSE2(dst + i, src + i, len - i);
+}
+
+bool haveAVX2()
+{
+    // Required when called before the constructors of the runtime library.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+XorFunction selectXorKernel()
+{
+    const vector<XorKernel> kernels = supportedXorKernels();
+    return kernels.back().fn;
+}
+
+const XorFunction s_xorKernel = selectXorKernel();
+
+// The tables of GF(2^8): the logarithms and the exponents of the generator 2,
+// and the full multiplication table for the table-driven kernel.
+struct GfTables
+{
+    uint8_t exp[512];
+    uint8_t log[256];
+    uint8_t mul[256][256];
+
+    GfTables()
+    {
+        unsigned x = 1;
+        for (int i = 0; i < 255; ++i)
+        {
+            exp[i] = exp[i + 255] = uint8_t(x);
+            log[x] = uint8_t(i);
+            x <<= 1;
+            if (x & 0x100)
+                x ^= 0x11D;
+        }
+        exp[510] = exp[511] = exp[0];
+        log[0]   = 0; // Never used
+
+        for (int a = 0; a < 256; ++a)
+        {
+            mul[a][0] = mul[0][a] = 0;
+            for (int b = 1; a && b < 256; ++b)
+                mul[a][b] = exp[log[a] + log[b]];
+        }
+    }
+};
+
+const GfTables s_gf;
+
+void gfMulAddTable(char* dst, const char* src, uint8_t c, size_t len)
+{
+    const uint8_t* row = s_gf.mul[c];
+    for (size_t i = 0; i < len; ++i)
+        dst[i] ^= row[uint8_t(src[i])];
+}
+
+#if SRT_XOR_AVX2
+// The product is looked up separately for the low and high 4 bits
+// of every byte, 32 bytes at a time.
+__attribute__((target("avx2"))) void gfMulAddAVX2(char* dst, const char* src, uint8_t c, size_t len)
+{
+    uint8_t lo[16], hi[16];
+    for (int x = 0; x < 16; ++x)
+    {
+        lo[x] = s_gf.mul[c][x];
+        hi[x] = s_gf.mul[c][x << 4];
+    }
+    const __m256i tlo  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lo)));
+    const __m256i thi  = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hi)));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i*      d    = reinterpret_cast<__m256i*>(dst + i);
+        const __m256i s    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m256i plo  = _mm256_shuffle_epi8(tlo, _mm256_and_si256(s, mask));
+        const __m256i phi  = _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask));
+        _mm256_storeu_si256(d, _mm256_xor_si256(_mm256_loadu_si256(d), _mm256_xor_si256(plo, phi)));
+    }
+    gfMulAddTable(dst + i, src + i, c, len - i);
+}
+#endif
+
+GfMulAddFunction selectGfMulAddKernel()
+{
+    const vector<GfMulAddKernel> kernels = supportedGfMulAddKernels();
+    return kernels.back().fn;
+}
+
+const GfMulAddFunction s_gfMulAddKernel = selectGfMulAddKernel();
+
+} // namespace
+
+vector<XorKernel> supportedXorKernels()
+{
+    vector<XorKernel> kernels;
+    const XorKernel words = {"words", &xorWords};
+    kernels.push_back(words);
+#if SRT_XOR_SSE2
+    const XorKernel sse2 = {"sse2", &xorSSE2};
+    kernels.push_back(sse2);
+#endif
+#if SRT_XOR_AVX2
+    if (haveAVX2())
+    {
+        const XorKernel avx2 = {"avx2", &xorAVX2};
+        kernels.push_back(avx2);
+    }
+#endif
+    return kernels;
+}
+
+void xorInto(char* dst, const char* src, size_t len)
+{
+    s_xorKernel(dst, src, len);
+}
+
+uint8_t gfMul(uint8_t a, uint8_t b)
+{
+    return s_gf.mul[a][b];
+}
+
+uint8_t gfInv(uint8_t a)
+{
+    return s_gf.exp[255 - s_gf.log[a]];
+}
+
+vector<GfMulAddKernel> supportedGfMulAddKernels()
+{
+    vector<GfMulAddKernel> kernels;
+    const GfMulAddKernel table = {"table", &gfMulAddTable};
+    kernels.push_back(table);
+#if SRT_XOR_AVX2
+    if (haveAVX2())
+    {
+        const GfMulAddKernel avx2 = {"avx2", &gfMulAddAVX2};
+        kernels.push_back(avx2);
+    }
+#endif
+    return kernels;
+}
+
+void gfMulAddInto(char* dst, const char* src, uint8_t c, size_t len)
+{
+    // The coefficients 0 and 1 are common in the coding matrices.
+    if (c == 0)
+        return;
+    if (c == 1)
+        s_xorKernel(dst, src, len);
+    else
+        s_gfMulAddKernel(dst, src, c, len);
+}
+
+} // namespace srt
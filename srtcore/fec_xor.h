@@ -0,0 +1,148 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#ifndef INC_SRT_FEC_XOR_H
+#define INC_SRT_FEC_XOR_H
+
+#include "platform_sys.h"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// The kernels of the FEC filters: XOR for the builtin "fec" filter,
+// GF(2^8) multiply-add for the builtin "rs" filter.
+
+// The x86 kernels: SSE2 is there on every x86_64 CPU, AVX2 is compiled
+// with the target attribute and used only if the CPU supports it.
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define SRT_XOR_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define SRT_XOR_AVX2 1
+#endif
+#endif
+
+namespace srt
+{
+
+/// XOR @a len bytes of @a src into @a dst. The buffers may be of any alignment.
+typedef void (*XorFunction)(char* dst, const char* src, size_t len);
+
+struct XorKernel
+{
+    const char* name;
+    XorFunction fn;
+};
+
+/// The XOR kernels that can run on this CPU, from the portable one
+/// up to the one used by xorInto().
+std::vector<XorKernel> supportedXorKernels();
+
+/// XOR @a len bytes of @a src into @a dst with the fastest kernel
+/// supported by the CPU, selected on startup.
+void xorInto(char* dst, const char* src, size_t len);
+
+/// Multiplication in GF(2^8) with the polynomial x^8+x^4+x^3+x^2+1.
+uint8_t gfMul(uint8_t a, uint8_t b);
+
+/// The multiplicative inverse in GF(2^8); @a a must not be 0.
+uint8_t gfInv(uint8_t a);
+
+/// XOR the product of @a c and every byte of @a src into @a dst.
+typedef void (*GfMulAddFunction)(char* dst, const char* src, uint8_t c, size_t len);
+
+struct GfMulAddKernel
+{
+    const char*      name;
+    GfMulAddFunction fn;
+};
+
+/// The GF(2^8) multiply-add kernels that can run on this CPU, from the
+/// table-driven one up to the one used by gfMulAddInto().
+std::vector<GfMulAddKernel> supportedGfMulAddKernels();
+
+/// dst[i] ^= c * src[i] in GF(2^8) with the fastest kernel supported by the CPU.
+void gfMulAddInto(char* dst, const char* src, uint8_t c, size_t len);
+
+/// A zero-initialized buffer starting at the cache line, so that the XOR
+/// kernels work a cache line at a time.
+class CAlignedBuffer
+{
+public:
+    static const size_t ALIGNMENT = 64;
+
+    CAlignedBuffer()
+        : m_pStorage(NULL)
+        , m_pData(NULL)
+        , m_zSize(0)
+    {
+    }
+
+    CAlignedBuffer(const CAlignedBuffer& other)
+        : m_pStorage(NULL)
+        , m_pData(NULL)
+        , m_zSize(0)
+    {
+        *this = other;
+    }
+
+    CAlignedBuffer& operator=(const CAlignedBuffer& other)
+    {
+        if (this != &other)
+        {
+            resize(other.m_zSize);
+            if (m_zSize)
+                memcpy(m_pData, other.m_pData, m_zSize);
+        }
+        return *this;
+    }
+
+    ~CAlignedBuffer() { delete[] m_pStorage; }
+
+    /// Change the size, keeping the contents as std::vector::resize does,
+    /// with the added bytes zeroed.
+    void resize(size_t size)
+    {
+        if (size == m_zSize)
+            return;
+
+        char* storage = NULL;
+        char* data    = NULL;
+        if (size)
+        {
+            storage = new char[size + ALIGNMENT - 1];
+            data    = storage + (ALIGNMENT - reinterpret_cast<size_t>(storage) % ALIGNMENT) % ALIGNMENT;
+            const size_t kept = size < m_zSize ? size : m_zSize;
+            if (kept)
+                memcpy(data, m_pData, kept);
+            memset(data + kept, 0, size - kept);
+        }
+
+        delete[] m_pStorage;
+        m_pStorage = storage;
+        m_pData    = data;
+        m_zSize    = size;
+    }
+
+    size_t      size() const { return m_zSize; }
+    char*       data() { return m_pData; }
+    const char* data() const { return m_pData; }
+    char&       operator[](size_t i) { return m_pData[i]; }
+    const char& operator[](size_t i) const { return m_pData[i]; }
+
+private:
+    char*  m_pStorage;
+    char*  m_pData;
+    size_t m_zSize;
+};
+
+} // namespace srt
+
+#endif
@@ -274,12 +274,21 @@ CUDTGroup::CUDTGroup(SRT_GROUP_TYPE gtype)
     , m_bOpened(false)
     , m_bConnected(false)
     , m_bClosing(false)
+    , m_pRcvUnitQueue(NULL)
+    , m_pRcvBuffer(NULL)
+    , m_iRcvUnitSize(0)
+    , m_bRcvTsbPdInsertWakeup(false)
+    , m_bRcvTsbPdClosing(false)
     , m_iLastSchedSeqNo(SRT_SEQNO_NONE)
     , m_iLastSchedMsgNo(SRT_MSGNO_NONE)
 {
     setupMutex(m_GroupLock, "Group");
     setupMutex(m_RcvDataLock, "G/RcvData");
     setupCond(m_RcvDataCond, "G/RcvData");
+    setupMutex(m_RcvInsertLock, "G/RcvInsert");
+    setupMutex(m_RcvBufferLock, "G/RcvBuffer");
+    setupMutex(m_RcvTsbPdLock, "G/RcvTsbPd");
+    setupCond(m_RcvTsbPdCond, "G/RcvTsbPd");
     m_RcvEID = m_Global.m_EPoll.create(&m_RcvEpolld);
     m_SndEID = m_Global.m_EPoll.create(&m_SndEpolld);
 
@@ -292,11 +301,20 @@ CUDTGroup::CUDTGroup(SRT_GROUP_TYPE gtype)
 
 CUDTGroup::~CUDTGroup()
 {
+    rcvTsbPdStop();
+    // The buffer returns its units to the queue.
+    delete m_pRcvBuffer;
+    delete m_pRcvUnitQueue;
+
     srt_epoll_release(m_RcvEID);
     srt_epoll_release(m_SndEID);
     releaseMutex(m_GroupLock);
     releaseMutex(m_RcvDataLock);
     releaseCond(m_RcvDataCond);
+    releaseMutex(m_RcvInsertLock);
+    releaseMutex(m_RcvBufferLock);
+    releaseMutex(m_RcvTsbPdLock);
+    releaseCond(m_RcvTsbPdCond);
 }
 
 void CUDTGroup::GroupContainer::erase(CUDTGroup::gli_t it)
@@ -512,6 +530,17 @@ void CUDTGroup::deriveSettings(CUDT* u)
     IM(SRTO_LINGER, Linger);
     IM(SRTO_UDP_SNDBUF, iUDPSndBufSize);
     IM(SRTO_UDP_RCVBUF, iUDPRcvBufSize);
+    IM(SRTO_UDP_RCVBATCH, iUDPRcvBatch);
+    IM(SRTO_UDP_SNDBATCH, iUDPSndBatch);
+    IM(SRTO_RCVWORKERS, iRcvWorkers);
+    IM(SRTO_SNDWORKERS, iSndWorkers);
+    IM(SRTO_RCVUNITS, iRcvUnits);
+    IM(SRTO_UDP_IOURING, bUDPIoUring);
+    if (!u->m_config.sInprocLink.empty())
+    {
+        const string& link = u->m_config.sInprocLink;
+        m_config.push_back(ConfigItem(SRTO_INPROC_LINK, link.c_str(), (int)link.size()));
+    }
     // SRTO_RENDEZVOUS: impossible to have it set on a listener socket.
     // SRTO_SNDTIMEO/RCVTIMEO: groupwise setting
     IM(SRTO_CONNTIMEO, tdConnTimeOut);
@@ -538,6 +567,7 @@ void CUDTGroup::deriveSettings(CUDT* u)
     IM(SRTO_ENFORCEDENCRYPTION, bEnforcedEnc);
     IM(SRTO_IPV6ONLY, iIpV6Only);
     IM(SRTO_PEERIDLETIMEO, iPeerIdleTimeout_ms);
+    IM(SRTO_GROUPRCVBUF, bGroupRcvBuffer);
 
     importOption(m_config, SRTO_PACKETFILTER, u->m_config.sPacketFilterConfig.str());
 
@@ -647,6 +677,17 @@ static bool getOptDefault(SRT_SOCKOPT optname, void* pw_optval, int& w_optlen)
     case SRTO_UDP_SNDBUF:
     case SRTO_UDP_RCVBUF:
         RD(CSrtConfig::DEF_UDP_BUFFER_SIZE);
+    case SRTO_UDP_RCVBATCH:
+    case SRTO_UDP_SNDBATCH:
+    case SRTO_RCVWORKERS:
+    case SRTO_SNDWORKERS:
+        RD(1);
+    case SRTO_RCVUNITS:
+        RD(CSrtMuxerConfig::DEF_RCV_UNITS);
+    case SRTO_UDP_IOURING:
+        RD(false);
+    case SRTO_INPROC_LINK:
+        RD(std::string());
     case SRTO_RENDEZVOUS:
         RD(false);
     case SRTO_SNDTIMEO:
@@ -711,6 +752,8 @@ static bool getOptDefault(SRT_SOCKOPT optname, void* pw_optval, int& w_optlen)
         RD(0);
     case SRTO_GROUPMINSTABLETIMEO:
         RD(CSrtConfig::COMM_DEF_MIN_STABILITY_TIMEOUT_MS);
+    case SRTO_GROUPRCVBUF:
+        RD(false);
     }
 
 #undef RD
@@ -969,11 +1012,10 @@ void CUDTGroup::close()
         // The external part will be done in Global (CUDTUnited)
     }
 
-    // Release blocked clients
-    // XXX This looks like a dead code. Group receiver functions
-    // do not use any lock on m_RcvDataLock, it is likely a remainder
-    // of the old, internal impementation. 
-    // CSync::lock_notify_one(m_RcvDataCond, m_RcvDataLock);
+    // Release blocked clients. Only the reader of the group receiver
+    // buffer waits on m_RcvDataCond, the others wait on the member sockets.
+    rcvTsbPdStop();
+    CSync::lock_notify_all(m_RcvDataCond, m_RcvDataLock);
 }
 
 // [[using locked(m_Global->m_GlobControlLock)]]
@@ -1027,6 +1069,58 @@ int CUDTGroup::send(const char* buf, int len, SRT_MSGCTRL& w_mc)
     }
 }
 
+namespace
+{
+// Drops the reference of the sending function to the shared payload.
+struct SharedPayloadRef
+{
+    groups::SharedPayload* payload;
+
+    SharedPayloadRef()
+        : payload(NULL)
+    {
+    }
+
+    ~SharedPayloadRef()
+    {
+        if (payload)
+            payload->release();
+    }
+};
+} // namespace
+
+// [[using locked(m_GroupLock)]]
+int CUDTGroup::sendBroadcast_Member(CUDT& u, const char* buf, int len, groups::SharedPayload* payload, SRT_MSGCTRL& w_mc)
+{
+    if (!payload)
+        return u.sendmsg2(buf, len, (w_mc));
+
+    // The reference is taken over by the sender buffer, or released
+    // by sendmsg2 when the payload isn't stored, but not when it throws.
+    payload->acquire();
+    int stat = 0;
+    try
+    {
+        stat = u.sendmsg2(payload->data(), len, (w_mc), &groups::SharedPayload::releaseFn, payload);
+    }
+    catch (CUDTException& e)
+    {
+        // SRT_ECONGEST (SRT_ENABLE_ECN) is only a notification: the payload is stored already.
+        if (e.getErrorCode() != SRT_ECONGEST)
+            payload->release();
+        throw;
+    }
+    catch (...)
+    {
+        payload->release();
+        throw;
+    }
+
+    if (stat == 0)
+        payload->release();
+    return stat;
+}
+
 int CUDTGroup::sendBroadcast(const char* buf, int len, SRT_MSGCTRL& w_mc)
 {
     // Avoid stupid errors in the beginning.
@@ -1161,6 +1255,16 @@ int CUDTGroup::sendBroadcast(const char* buf, int len, SRT_MSGCTRL& w_mc)
     if (w_mc.srctime == 0)
         w_mc.srctime = count_microseconds(steady_clock::now().time_since_epoch());
 
+    // With more than one link, the sender buffers share one copy of the payload,
+    // unless it's encrypted in place there (the same on all the members).
+    SharedPayloadRef shared;
+    if (activeLinks.size() + idleLinks.size() > 1)
+    {
+        const gli_t first = activeLinks.empty() ? idleLinks[0] : activeLinks[0];
+        if (!first->ps->core().sndEncryptsInPlace())
+            shared.payload = groups::SharedPayload::create(buf, len);
+    }
+
     for (vector<gli_t>::iterator snd = activeLinks.begin(); snd != activeLinks.end(); ++snd)
     {
         gli_t d   = *snd;
@@ -1172,7 +1276,7 @@ int CUDTGroup::sendBroadcast(const char* buf, int len, SRT_MSGCTRL& w_mc)
             // Possible return values are only 0, in case when len was passed 0, or a positive
             // >0 value that defines the size of the data that it has sent, that is, in case
             // of Live mode, equal to 'len'.
-            stat = d->ps->core().sendmsg2(buf, len, (w_mc));
+            stat = sendBroadcast_Member(d->ps->core(), buf, len, shared.payload, (w_mc));
         }
         catch (CUDTException& e)
         {
@@ -1260,7 +1364,7 @@ int CUDTGroup::sendBroadcast(const char* buf, int len, SRT_MSGCTRL& w_mc)
 
         try
         {
-            stat = d->ps->core().sendmsg2(buf, len, (w_mc));
+            stat = sendBroadcast_Member(d->ps->core(), buf, len, shared.payload, (w_mc));
         }
         catch (CUDTException& e)
         {
@@ -1573,7 +1677,7 @@ int CUDTGroup::sendBroadcast(const char* buf, int len, SRT_MSGCTRL& w_mc)
                     // Possible return values are only 0, in case when len was passed 0, or a positive
                     // >0 value that defines the size of the data that it has sent, that is, in case
                     // of Live mode, equal to 'len'.
-                    stat = d->ps->core().sendmsg2(buf, len, (w_mc));
+                    stat = sendBroadcast_Member(d->ps->core(), buf, len, shared.payload, (w_mc));
                 }
                 catch (CUDTException& e)
                 {
@@ -2090,6 +2194,9 @@ void CUDTGroup::updateReadState(SRTSOCKET /* not sure if needed */, int32_t sequ
 int32_t CUDTGroup::getRcvBaseSeqNo()
 {
     ScopedLock lg(m_GroupLock);
+    // The group receiver buffer also moves on when its TSBPD thread drops packets.
+    if (m_pRcvBuffer)
+        return CSeqNo::decseq(m_pRcvBuffer->getStartSeqNo());
     return m_RcvBaseSeqNo;
 }
 
@@ -2136,6 +2243,117 @@ static bool isValidSeqno(int32_t iBaseSeqno, int32_t iPktSeqno)
     return false;
 }
 
+// [[using locked(m_GroupLock)]]
+int CUDTGroup::recv_FromRcvBuffer(char* buf, int len, SRT_MSGCTRL& w_mc)
+{
+    const bool                     has_timeout = m_iRcvTimeOut >= 0;
+    const steady_clock::time_point exptime     = steady_clock::now() + milliseconds_from(m_iRcvTimeOut);
+
+    for (;;)
+    {
+        if (!m_bOpened || !m_bConnected)
+        {
+            LOGC(grlog.Error,
+                 log << boolalpha << "grp/recv: $" << id() << ": ABANDONING: opened=" << m_bOpened
+                     << " connected=" << m_bConnected);
+            throw CUDTException(MJ_CONNECTION, MN_NOCONN, 0);
+        }
+
+        if (m_bClosing)
+        {
+            HLOGC(grlog.Debug, log << "grp/recv: $" << id() << ": GROUP CLOSED, ABANDONING.");
+            throw CUDTException(MJ_CONNECTION, MN_CONNLOST, 0);
+        }
+
+        int  res            = 0;
+        bool canReadFurther = false;
+        {
+            ScopedLock                     lck(m_RcvBufferLock);
+            const steady_clock::time_point tnow = steady_clock::now();
+            if (m_pRcvBuffer->isRcvDataReady(tnow))
+            {
+                res            = m_pRcvBuffer->readMessage((buf), len, &w_mc);
+                canReadFurther = m_pRcvBuffer->isRcvDataReady(tnow);
+            }
+        }
+
+        if (res > 0)
+        {
+            HLOGC(grlog.Debug,
+                  log << "grp/recv: $" << id() << ": Extracted data with %" << w_mc.pktseq << " #" << w_mc.msgno
+                      << ": " << BufferStamp(buf, res));
+            fillGroupData((w_mc), w_mc);
+            m_RcvBaseSeqNo = w_mc.pktseq;
+
+            // Update stats as per delivery
+            m_stats.recv.count(res);
+            updateAvgPayloadSize(res);
+
+            if (!canReadFurther)
+            {
+                // The TSBPD thread is waiting for the reader to take out
+                // everything that was ready, and signals the next packet.
+                m_Global.m_EPoll.update_events(id(), m_sPollID, SRT_EPOLL_IN, false);
+                rcvTsbPdWake();
+            }
+            return res;
+        }
+
+        // The packets are delivered only as long as any member can still
+        // provide them. Note that the members don't report read-readiness.
+        bool anyAlive = false;
+        for (gli_t gi = m_Group.begin(); gi != m_Group.end(); ++gi)
+        {
+            if (!gi->ps->broken())
+            {
+                anyAlive = true;
+                break;
+            }
+        }
+
+        if (!anyAlive)
+        {
+            LOGC(grlog.Error, log << "grp/recv: ALL LINKS BROKEN, ABANDONING.");
+            m_Global.m_EPoll.update_events(id(), m_sPollID, SRT_EPOLL_IN, false);
+            throw CUDTException(MJ_CONNECTION, MN_NOCONN, 0);
+        }
+
+        if (!m_bSynRecving)
+        {
+            HLOGC(grlog.Debug, log << "grp/recv: $" << id() << ": Nothing to read, clearing readiness.");
+            m_Global.m_EPoll.update_events(id(), m_sPollID, SRT_EPOLL_IN, false);
+            rcvTsbPdWake();
+            throw CUDTException(MJ_AGAIN, MN_RDAVAIL, 0);
+        }
+
+        // Another reader could have taken out the packets signaled by the TSBPD thread.
+        rcvTsbPdWake();
+
+        // Do not block forever, check connection status each 1 sec.
+        steady_clock::time_point tswait = steady_clock::now() + seconds_from(1);
+        if (has_timeout)
+        {
+            if (steady_clock::now() >= exptime)
+                throw CUDTException(MJ_AGAIN, MN_RDAVAIL, 0);
+            tswait = std::min(tswait, exptime);
+        }
+
+        {
+            // The members need the group lock to process the incoming packets.
+            InvertedLock ungroup(m_GroupLock);
+            UniqueLock   datalock(m_RcvDataLock);
+            CSync        rcvdata_cc(m_RcvDataCond, datalock);
+
+            // The TSBPD thread signals under m_RcvDataLock, don't miss it.
+            enterCS(m_RcvBufferLock);
+            const bool ready = m_pRcvBuffer->isRcvDataReady(steady_clock::now());
+            leaveCS(m_RcvBufferLock);
+            if (!ready)
+                rcvdata_cc.wait_until(tswait);
+        }
+    }
+}
+
 int CUDTGroup::recv(char* buf, int len, SRT_MSGCTRL& w_mc)
 {
     // First, acquire GlobControlLock to make sure all member sockets still exist
@@ -2160,6 +2378,9 @@ int CUDTGroup::recv(char* buf, int len, SRT_MSGCTRL& w_mc)
     if (m_bClosing)
         throw CUDTException(MJ_CONNECTION, MN_CONNLOST, 0);
 
+    if (m_pRcvBuffer)
+        return recv_FromRcvBuffer((buf), len, (w_mc));
+
     // Later iteration over it might be less efficient than
     // by vector, but we'll also often try to check a single id
     // if it was ever seen broken, so that it's skipped.
@@ -2230,6 +2451,7 @@ int CUDTGroup::recv(char* buf, int len, SRT_MSGCTRL& w_mc)
                      log << "grp/recv: $" << id() << ": @" << ps->m_SocketID << ": SEQUENCE DISCREPANCY: base=%"
                          << m_RcvBaseSeqNo << " vs pkt=%" << info.seqno << ", setting ESECFAIL");
                 ps->core().m_bBroken = true;
+                ps->core().rescheduleTimers();
                 broken.insert(ps);
                 continue;
             }
@@ -2339,17 +2561,25 @@ void CUDTGroup::synchronizeDrift(const srt::CUDT* srcMember)
 {
     SRT_ASSERT(srcMember != NULL);
     ScopedLock glock(m_GroupLock);
-    if (m_Group.size() <= 1)
-    {
-        HLOGC(grlog.Debug, log << "GROUP: synch uDRIFT NOT DONE, no other links");
-        return;
-    }
 
     steady_clock::time_point timebase;
     steady_clock::duration   udrift(0);
     bool wrap_period = false;
     srcMember->m_pRcvBuffer->getInternalTimeBase((timebase), (wrap_period), (udrift));
 
+    if (m_pRcvBuffer)
+    {
+        // The group receiver buffer follows the members, even if there's only one.
+        ScopedLock lck(m_RcvBufferLock);
+        m_pRcvBuffer->applyGroupDrift(timebase, wrap_period, udrift);
+    }
+
+    if (m_Group.size() <= 1)
+    {
+        HLOGC(grlog.Debug, log << "GROUP: synch uDRIFT NOT DONE, no other links");
+        return;
+    }
+
     HLOGC(grlog.Debug,
         log << "GROUP: synch uDRIFT=" << FormatDuration(udrift) << " TB=" << FormatTime(timebase) << "("
         << (wrap_period ? "" : "NO ") << "wrap period)");
@@ -2370,6 +2600,215 @@ void CUDTGroup::synchronizeDrift(const srt::CUDT* srcMember)
     }
 }
 
+// [[using locked(m_GroupLock)]]
+bool CUDTGroup::rcvBufferAttach(CUDT* member, bool first)
+{
+    steady_clock::time_point timebase;
+    steady_clock::duration   udrift(0);
+    bool                     wrap_period = false;
+    member->m_pRcvBuffer->getInternalTimeBase((timebase), (wrap_period), (udrift));
+    const uint32_t delay_us = uint32_t(member->m_iTsbPdDelay_ms) * 1000;
+
+    if (m_pRcvBuffer)
+    {
+        if (first)
+        {
+            // All previous members are gone. The reception is restarted
+            // with the sequence numbers and the time base of this member.
+            ScopedLock ilck(m_RcvInsertLock);
+            ScopedLock blck(m_RcvBufferLock);
+            m_pRcvBuffer->dropAll();
+            m_pRcvBuffer->setStartSeqNo(member->m_iRcvLastAck);
+            m_pRcvBuffer->applyGroupTime(timebase, wrap_period, delay_us, udrift);
+            HLOGC(grlog.Debug,
+                  log << "grp/rcvbuf: $" << id() << ": restarted with @" << member->m_SocketID << " at %"
+                      << member->m_iRcvLastAck);
+        }
+        return true;
+    }
+
+    const int unit_size = (int)member->maxPayloadSize();
+    try
+    {
+        m_pRcvUnitQueue = new CUnitQueue(member->m_config.iRcvUnits, unit_size);
+        m_pRcvBuffer    = new CRcvBuffer(member->m_iRcvLastAck,
+                                      member->m_pRcvBuffer->capacity(),
+                                      m_pRcvUnitQueue,
+                                      member->m_config.bMessageAPI);
+    }
+    catch (...)
+    {
+        LOGC(grlog.Error,
+             log << "grp/rcvbuf: $" << id() << ": can't allocate the group receiver buffer, members use their own");
+        delete m_pRcvUnitQueue;
+        m_pRcvUnitQueue = NULL;
+        return false;
+    }
+
+    m_iRcvUnitSize = unit_size;
+    m_pRcvBuffer->setPeerRexmitFlag(member->m_bPeerRexmitFlag);
+    m_pRcvBuffer->applyGroupTime(timebase, wrap_period, delay_us, udrift);
+
+    m_bRcvTsbPdClosing = false;
+    if (!StartThread(m_RcvTsbPdThread, CUDTGroup::rcvTsbPd, this, "SRT:GTsbPd"))
+    {
+        LOGC(grlog.Error, log << "grp/rcvbuf: $" << id() << ": can't start the TSBPD thread, members use their own buffers");
+        delete m_pRcvBuffer;
+        m_pRcvBuffer = NULL;
+        delete m_pRcvUnitQueue;
+        m_pRcvUnitQueue = NULL;
+        return false;
+    }
+
+    HLOGC(grlog.Debug,
+          log << "grp/rcvbuf: $" << id() << ": created with @" << member->m_SocketID << " at %" << member->m_iRcvLastAck
+              << " size=" << m_pRcvBuffer->capacity());
+    return true;
+}
+
+bool CUDTGroup::rcvBufferHasPacket(int32_t seqno) const
+{
+    return m_pRcvBuffer->hasPacket(seqno);
+}
+
+int CUDTGroup::rcvBufferInsert(CUnit* unit)
+{
+    CPacket& packet = unit->m_Packet;
+    int      res    = -3;
+    {
+        ScopedLock lck(m_RcvInsertLock);
+
+        // Another member could have just inserted it.
+        if (m_pRcvBuffer->hasPacket(packet.getSeqNo()))
+            return -1;
+
+        if (packet.getLength() > size_t(m_iRcvUnitSize))
+        {
+            LOGC(grlog.Error,
+                 log << "grp/rcvbuf: $" << id() << ": packet %" << packet.getSeqNo() << " size " << packet.getLength()
+                     << " exceeds the unit size " << m_iRcvUnitSize);
+            return -3;
+        }
+
+        // The member's unit goes back to its receiver queue, so the group buffer
+        // needs its own copy. Only the first copy of every packet is made.
+        CUnit* u = m_pRcvUnitQueue->reserveNextAvailUnit();
+        if (!u)
+        {
+            LOGC(grlog.Error, log << "grp/rcvbuf: $" << id() << ": LOCAL STORAGE DEPLETED, can't store %" << packet.getSeqNo());
+            return -3;
+        }
+
+        memcpy((u->m_Packet.getHeader()), packet.getHeader(), CPacket::HDR_SIZE);
+        memcpy((u->m_Packet.m_pcData), packet.m_pcData, packet.getLength());
+        u->m_Packet.setLength(packet.getLength());
+
+        res = m_pRcvBuffer->insert(u);
+        m_pRcvUnitQueue->releaseUnit(u);
+    }
+
+    if (res == 0 && m_bRcvTsbPdInsertWakeup)
+        rcvTsbPdWake();
+
+    return res;
+}
+
+void* CUDTGroup::rcvTsbPd(void* param)
+{
+    CUDTGroup* self = (CUDTGroup*)param;
+
+    THREAD_STATE_INIT("SRT:GTsbPd");
+
+    UniqueLock tsbpd_lock(self->m_RcvTsbPdLock);
+    CSync      tsbpd_cc(self->m_RcvTsbPdCond, tsbpd_lock);
+
+    while (!self->m_bRcvTsbPdClosing)
+    {
+        INCREMENT_THREAD_ITERATIONS();
+
+        const steady_clock::time_point tsNextDelivery = self->rcvTsbPdDeliver();
+
+        THREAD_PAUSED();
+        if (!is_zero(tsNextDelivery))
+            tsbpd_cc.wait_until(tsNextDelivery);
+        else
+            tsbpd_cc.wait();
+        THREAD_RESUMED();
+    }
+    THREAD_EXIT();
+    HLOGC(tslog.Debug, log << self->CONID() << "grp/tsbpd: EXITING");
+    return NULL;
+}
+
+// [[using locked(m_RcvTsbPdLock)]]
+// Must not lock m_GroupLock: the reader holds it when waking this thread up.
+CUDTGroup::time_point CUDTGroup::rcvTsbPdDeliver()
+{
+    // Set before checking the buffer, so that a packet inserted
+    // in the meantime wakes up the next round.
+    m_bRcvTsbPdInsertWakeup = true;
+
+    bool rxready = false;
+
+    enterCS(m_RcvBufferLock);
+    const steady_clock::time_point tnow = steady_clock::now();
+
+    const CRcvBuffer::PacketInfo info = m_pRcvBuffer->getFirstValidPacketInfo();
+
+    steady_clock::time_point tsNextDelivery = info.tsbpd_time;
+    if (!is_zero(info.tsbpd_time) && tnow >= info.tsbpd_time)
+    {
+        rxready = true;
+        if (info.seq_gap)
+        {
+            // None of the members has delivered the missing packets in time.
+            const int iDropCnt = m_pRcvBuffer->dropUpTo(info.seqno);
+            const uint64_t avgpayloadsz = m_pRcvBuffer->getRcvAvgPayloadSize();
+            m_stats.recvDrop.count(stats::BytesPackets(iDropCnt * avgpayloadsz, (uint32_t)iDropCnt));
+            HLOGC(tslog.Debug,
+                  log << CONID() << "grp/tsbpd: DROPSEQ: up to seqno %" << CSeqNo::decseq(info.seqno) << " ("
+                      << iDropCnt << " packets) playable at " << FormatTime(info.tsbpd_time));
+        }
+        tsNextDelivery = steady_clock::time_point();
+    }
+    leaveCS(m_RcvBufferLock);
+
+    if (rxready)
+    {
+        HLOGC(tslog.Debug, log << CONID() << "grp/tsbpd: PLAYING PACKET seq=" << info.seqno);
+        if (m_bSynRecving)
+            CSync::lock_notify_one(m_RcvDataCond, m_RcvDataLock);
+        m_Global.m_EPoll.update_events(id(), m_sPollID, SRT_EPOLL_IN, true);
+        CGlobEvent::triggerEvent();
+
+        // The reader wakes this thread up once it has read everything that was ready.
+        m_bRcvTsbPdInsertWakeup = false;
+    }
+    else if (!is_zero(tsNextDelivery))
+    {
+        HLOGC(tslog.Debug,
+              log << CONID() << "grp/tsbpd: FUTURE PACKET seq=" << info.seqno << " T=" << FormatTime(tsNextDelivery));
+        m_bRcvTsbPdInsertWakeup = false;
+    }
+
+    return tsNextDelivery;
+}
+
+void CUDTGroup::rcvTsbPdWake()
+{
+    CSync::lock_notify_one(m_RcvTsbPdCond, m_RcvTsbPdLock);
+}
+
+void CUDTGroup::rcvTsbPdStop()
+{
+    if (!m_RcvTsbPdThread.joinable())
+        return;
+
+    m_bRcvTsbPdClosing = true;
+    rcvTsbPdWake();
+    m_RcvTsbPdThread.join();
+}
+
 void CUDTGroup::bstatsSocket(CBytePerfMon* perf, bool clear)
 {
     if (!m_bConnected)
@@ -2388,6 +2827,8 @@ void CUDTGroup::bstatsSocket(CBytePerfMon* perf, bool clear)
     memset(perf, 0, sizeof *perf);
 
     ScopedLock gg(m_GroupLock);
+    // The TSBPD thread of the group receiver buffer counts the drops under m_RcvBufferLock.
+    ScopedLock bufferlock(m_RcvBufferLock);
 
     perf->msTimeStamp = count_milliseconds(currtime - m_tsStartTime);
 
@@ -4070,6 +4511,12 @@ void CUDTGroup::addEPoll(int eid)
             else
                 any_pending |= true;
         }
+
+        if (m_pRcvBuffer)
+        {
+            ScopedLock lck(m_RcvBufferLock);
+            any_read = m_pRcvBuffer->isRcvDataReady(steady_clock::now());
+        }
     }
 
     // This is stupid, but we don't have any other interface to epoll
@@ -4123,6 +4570,8 @@ void CUDTGroup::updateFailedLink()
         // No healthy links, set ERR on epoll.
         HLOGC(gmlog.Debug, log << "group/updateFailedLink: All sockets broken");
         m_Global.m_EPoll.update_events(id(), m_sPollID, SRT_EPOLL_IN | SRT_EPOLL_OUT | SRT_EPOLL_ERR, true);
+        // Wake up the reader of the group receiver buffer, if any.
+        CSync::lock_notify_all(m_RcvDataCond, m_RcvDataLock);
     }
     else
     {
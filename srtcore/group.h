@@ -25,6 +25,10 @@ Written by
 namespace srt
 {
 
+class CRcvBuffer;
+class CUnitQueue;
+struct CUnit;
+
 #if ENABLE_HEAVY_LOGGING
 const char* const srt_log_grp_state[] = {"PENDING", "IDLE", "RUNNING", "BROKEN"};
 #endif
@@ -214,6 +218,15 @@ private:
     // For Backup, sending all previous packet
     int sendBackupRexmit(srt::CUDT& core, SRT_MSGCTRL& w_mc);
 
+    /// Send the payload over a member link of a broadcast group.
+    /// @param u the member socket
+    /// @param buf payload
+    /// @param len payload length in bytes
+    /// @param payload if not NULL, the copy of @a buf to be referred to by the sender buffer
+    /// @param[in,out] w_mc message control
+    /// @return the result of CUDT::sendmsg2
+    int sendBroadcast_Member(CUDT& u, const char* buf, int len, groups::SharedPayload* payload, SRT_MSGCTRL& w_mc);
+
     // Support functions for sendBackup and sendBroadcast
     /// Check if group member is idle.
     /// @param d group member
@@ -654,6 +667,20 @@ private:
     /// @throws CUDTException(MJ_AGAIN, MN_RDAVAIL, 0)
     std::vector<srt::CUDTSocket*> recv_WaitForReadReady(const std::vector<srt::CUDTSocket*>& aliveMembers, std::set<srt::CUDTSocket*>& w_broken);
 
+    /// Read the next message from the group receiver buffer.
+    /// [[using locked(m_GroupLock)]] temporally unlocks-locks internally
+    ///
+    /// @throws CUDTException(MJ_CONNECTION, MN_NOCONN, 0)
+    /// @throws CUDTException(MJ_CONNECTION, MN_CONNLOST, 0)
+    /// @throws CUDTException(MJ_AGAIN, MN_RDAVAIL, 0)
+    int recv_FromRcvBuffer(char* buf, int len, SRT_MSGCTRL& w_mc);
+
+    /// The TSBPD thread of the group receiver buffer.
+    static void* rcvTsbPd(void* param);
+    time_point   rcvTsbPdDeliver();
+    void         rcvTsbPdWake();
+    void         rcvTsbPdStop();
+
     // This is the sequence number of a packet that has been previously
     // delivered. Initially it should be set to SRT_SEQNO_NONE so that the sequence read
     // from the first delivering socket will be taken as a good deal.
@@ -673,6 +700,21 @@ private:
     // is ready to deliver.
     sync::Condition       m_RcvDataCond;
     sync::Mutex           m_RcvDataLock;
+
+    // The receiver buffer of the group (SRTO_GROUPRCVBUF), NULL if the members use their own.
+    // The members insert the packets under m_RcvInsertLock (CRcvBuffer::insert()
+    // supports a single inserter), the reader and the TSBPD thread use it under
+    // m_RcvBufferLock, which also protects m_stats.recvDrop.
+    CUnitQueue*           m_pRcvUnitQueue;
+    CRcvBuffer*           m_pRcvBuffer;
+    int                   m_iRcvUnitSize;
+    sync::Mutex           m_RcvInsertLock;
+    sync::Mutex           m_RcvBufferLock;
+    sync::CThread         m_RcvTsbPdThread;
+    sync::Condition       m_RcvTsbPdCond;     // Use together with m_RcvTsbPdLock
+    sync::Mutex           m_RcvTsbPdLock;
+    sync::atomic<bool>    m_bRcvTsbPdInsertWakeup; // Signal the TSBPD thread on insert
+    sync::atomic<bool>    m_bRcvTsbPdClosing;
     sync::atomic<int32_t> m_iLastSchedSeqNo; // represetnts the value of CUDT::m_iSndNextSeqNo for each running socket
     sync::atomic<int32_t> m_iLastSchedMsgNo;
     // Statistics
@@ -794,6 +836,24 @@ public:
 
     void updateLatestRcv(srt::CUDTSocket*);
 
+    /// Make the members receive into the group receiver buffer (SRTO_GROUPRCVBUF).
+    /// The buffer is created when the first member is attached and reset when
+    /// a member is attached as the first connected one again.
+    /// [[using locked(m_GroupLock)]]
+    /// @param member the member socket, already synchronized with the group
+    /// @param first true if @a member is the first connected member of the group
+    /// @return false if the group receiver buffer couldn't be set up
+    bool rcvBufferAttach(srt::CUDT* member, bool first);
+
+    /// Check if the packet has been already received over any member.
+    /// Like rcvBufferInsert(), can be called without locking.
+    bool rcvBufferHasPacket(int32_t seqno) const;
+
+    /// Insert a copy of the packet received by a member into the group receiver buffer.
+    /// Can be called by the receiving threads of all the members at the same time.
+    /// @return the CRcvBuffer::insert() result, also -3 if there's no unit for the copy.
+    int rcvBufferInsert(CUnit* unit);
+
     // Property accessors
     SRTU_PROPERTY_RW_CHAIN(CUDTGroup, SRTSOCKET, id, m_GroupID);
     SRTU_PROPERTY_RW_CHAIN(CUDTGroup, SRTSOCKET, peerid, m_PeerGroupID);
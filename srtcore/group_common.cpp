@@ -15,6 +15,9 @@ Written by
 
 #include "platform_sys.h"
 
+#include <cstring>
+#include <new>
+
 #include "group_common.h"
 #include "api.h"
 
@@ -59,5 +62,34 @@ SocketData prepareSocketData(CUDTSocket* s)
     return sd;
 }
 
+SharedPayload::SharedPayload(int len)
+    : m_iRefCount(1)
+    , m_iLength(len)
+    , m_pcData(reinterpret_cast<char*>(this + 1))
+{
+}
+
+SharedPayload* SharedPayload::create(const char* data, int len)
+{
+    char* const          mem = new char[sizeof(SharedPayload) + len];
+    SharedPayload* const p   = new (mem) SharedPayload(len);
+    memcpy(p->m_pcData, data, len);
+    return p;
+}
+
+void SharedPayload::release()
+{
+    if (--m_iRefCount != 0)
+        return;
+
+    this->~SharedPayload();
+    delete[] reinterpret_cast<char*>(this);
+}
+
+void SharedPayload::releaseFn(void* opaque, const char*, int)
+{
+    static_cast<SharedPayload*>(opaque)->release();
+}
+
 } // namespace groups
 } // namespace srt
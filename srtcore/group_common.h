@@ -56,6 +56,36 @@ namespace groups
     typedef std::list<SocketData> group_t;
     typedef group_t::iterator     gli_t;
 
+    /// Payload of a message sent over several member links. The sender
+    /// buffers of all the members refer to it instead of having their own
+    /// copies, and each one releases it when the message is acknowledged
+    /// or dropped there. The payload is freed with the last reference.
+    class SharedPayload
+    {
+    public:
+        /// Copy the message into a new shared payload, referred to once.
+        static SharedPayload* create(const char* data, int len);
+
+        const char* data() const { return m_pcData; }
+        int         size() const { return m_iLength; }
+
+        void acquire() { ++m_iRefCount; }
+        void release();
+
+        /// Release function of the sender buffer, with the payload as @a opaque.
+        static void releaseFn(void* opaque, const char* buf, int len);
+
+    private:
+        SharedPayload(int len);
+
+        sync::atomic<int> m_iRefCount;
+        int               m_iLength;
+        char*             m_pcData; // Follows the object in the same allocation
+
+        SharedPayload(const SharedPayload&);
+        SharedPayload& operator=(const SharedPayload&);
+    };
+
 } // namespace groups
 } // namespace srt
 
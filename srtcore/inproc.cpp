@@ -0,0 +1,434 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#include "platform_sys.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#include "inproc.h"
+#include "common.h"
+#include "utilities.h"
+#include "logging.h"
+#include "logger_defs.h"
+
+using namespace std;
+using namespace srt::sync;
+using namespace srt_logging;
+
+namespace srt
+{
+
+CInprocLinkModel::CInprocLinkModel()
+    : iDelayUs(0)
+    , iJitterUs(0)
+    , dLossRate(0)
+    , dReorderRate(0)
+    , iReorderUs(5000)
+    , llBandwidth(0)
+    , iQueueUs(100000)
+    , uSeed(1)
+{
+}
+
+// Parse a non-negative number not greater than @a max.
+static bool parseNumber(const string& s, double max, double& w_value)
+{
+    char* end = NULL;
+    w_value   = strtod(s.c_str(), &end);
+    return !s.empty() && *end == '\0' && w_value >= 0 && w_value <= max;
+}
+
+bool CInprocLinkModel::parse(const string& config, CInprocLinkModel& w_model)
+{
+    static const double MAX_TIME_MS = 10000;
+
+    CInprocLinkModel model;
+    if (config == "on")
+    {
+        w_model = model;
+        return true;
+    }
+
+    vector<string> parts;
+    Split(config, ',', back_inserter(parts));
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        vector<string> keyval;
+        Split(parts[i], ':', back_inserter(keyval));
+        double value;
+        if (keyval.size() != 2)
+            return false;
+
+        const string& key = keyval[0];
+        if (key == "delay" && parseNumber(keyval[1], MAX_TIME_MS, (value)))
+            model.iDelayUs = int(value * 1000);
+        else if (key == "jitter" && parseNumber(keyval[1], MAX_TIME_MS, (value)))
+            model.iJitterUs = int(value * 1000);
+        else if (key == "loss" && parseNumber(keyval[1], 100, (value)))
+            model.dLossRate = value / 100;
+        else if (key == "reorder" && parseNumber(keyval[1], 100, (value)))
+            model.dReorderRate = value / 100;
+        else if (key == "reorderdelay" && parseNumber(keyval[1], MAX_TIME_MS, (value)))
+            model.iReorderUs = int(value * 1000);
+        else if (key == "bandwidth" && parseNumber(keyval[1], 1e6, (value)))
+            model.llBandwidth = int64_t(value * 1e6 / 8);
+        else if (key == "queue" && parseNumber(keyval[1], MAX_TIME_MS, (value)))
+            model.iQueueUs = int(value * 1000);
+        else if (key == "seed" && parseNumber(keyval[1], 0xFFFFFFFF, (value)))
+            model.uSeed = uint32_t(value);
+        else
+            return false;
+    }
+
+    if (parts.empty())
+        return false;
+
+    w_model = model;
+    return true;
+}
+
+CInprocEndpoint::CInprocEndpoint(const CInprocLinkModel& model, size_t capacity)
+    : m_pSlots(NULL)
+    , m_uMask(0)
+    , m_uHead(0)
+    , m_uTail(0)
+    , m_bWaiting(false)
+    , m_bWakeup(false)
+    , m_Model(model)
+    , m_uOrder(0)
+{
+    size_t size = 1;
+    while (size < capacity)
+        size *= 2;
+    m_pSlots = new Slot[size];
+    m_uMask  = size - 1;
+    for (size_t i = 0; i < size; ++i)
+        m_pSlots[i].seq.store(i);
+
+    // Any nonzero state of the generator will do, 0 would make it produce zeros only.
+    m_uRandom = (uint64_t(m_Model.uSeed) << 32) ^ 0x9E3779B97F4A7C15ULL;
+
+    setupCond(m_WaitCond, "InprocWait");
+}
+
+CInprocEndpoint::~CInprocEndpoint()
+{
+    releaseCond(m_WaitCond);
+    for (size_t i = 0; i < m_Pending.size(); ++i)
+        delete m_Pending[i].dgram;
+    for (size_t i = 0; i < m_Spare.size(); ++i)
+        delete m_Spare[i];
+    delete[] m_pSlots;
+}
+
+bool CInprocEndpoint::push(const sockaddr_any& source, const IOVector* iov, int iovlen)
+{
+    size_t len = 0;
+    for (int i = 0; i < iovlen; ++i)
+        len += iov[i].size();
+    if (len > MAX_DATAGRAM)
+        return false;
+
+    // Take the next position, unless it's still occupied by a datagram not yet read.
+    Slot*    slot = NULL;
+    uint64_t pos  = m_uHead.load();
+    for (;;)
+    {
+        slot                = &m_pSlots[pos & m_uMask];
+        const int64_t ahead = int64_t(slot->seq.load() - pos);
+        if (ahead == 0)
+        {
+            if (m_uHead.compare_exchange(pos, pos + 1))
+                break;
+        }
+        else if (ahead < 0)
+        {
+            return false; // Full
+        }
+        pos = m_uHead.load();
+    }
+
+    Datagram& d = slot->dgram;
+    d.tsSent    = steady_clock::now();
+    d.source    = source;
+    d.len       = 0;
+    for (int i = 0; i < iovlen; ++i)
+    {
+        memcpy(d.data + d.len, const_cast<IOVector&>(iov[i]).data(), iov[i].size());
+        d.len += iov[i].size();
+    }
+    slot->seq.store(pos + 1);
+
+    if (m_bWaiting.load())
+        CSync::lock_notify_one(m_WaitCond, m_WaitLock);
+    return true;
+}
+
+CInprocEndpoint::Slot* CInprocEndpoint::front()
+{
+    Slot* slot = &m_pSlots[m_uTail & m_uMask];
+    return slot->seq.load() == m_uTail + 1 ? slot : NULL;
+}
+
+void CInprocEndpoint::pop()
+{
+    // The position is free for the sender going round the ring once more.
+    m_pSlots[m_uTail & m_uMask].seq.store(m_uTail + m_uMask + 1);
+    ++m_uTail;
+}
+
+double CInprocEndpoint::random()
+{
+    // xorshift64*
+    m_uRandom ^= m_uRandom >> 12;
+    m_uRandom ^= m_uRandom << 25;
+    m_uRandom ^= m_uRandom >> 27;
+    return double((m_uRandom * 0x2545F4914F6CDD1DULL) >> 11) / 9007199254740992.0; // 2^53
+}
+
+bool CInprocEndpoint::drawLoss()
+{
+    return m_Model.dLossRate > 0 && random() < m_Model.dLossRate;
+}
+
+steady_clock::duration CInprocEndpoint::drawDelay()
+{
+    int64_t delay_us = m_Model.iDelayUs;
+    if (m_Model.iJitterUs > 0)
+        delay_us += int64_t(random() * m_Model.iJitterUs);
+    if (m_Model.dReorderRate > 0 && random() < m_Model.dReorderRate)
+        delay_us += m_Model.iReorderUs;
+    return microseconds_from(delay_us);
+}
+
+void CInprocEndpoint::schedule()
+{
+    for (Slot* slot = front(); slot; slot = front())
+    {
+        const Datagram& d = slot->dgram;
+        if (drawLoss())
+        {
+            pop();
+            continue;
+        }
+
+        // The datagram waits for the link in the queue, then it's transmitted and delayed.
+        steady_clock::time_point due = d.tsSent;
+        if (m_Model.llBandwidth > 0)
+        {
+            if (m_tsLinkFree > due)
+            {
+                if (m_tsLinkFree - due > microseconds_from(m_Model.iQueueUs))
+                {
+                    pop(); // The queue is full
+                    continue;
+                }
+                due = m_tsLinkFree;
+            }
+            due += microseconds_from(int64_t((d.len + CPacket::UDP_HDR_SIZE) * 1000000 / m_Model.llBandwidth));
+            m_tsLinkFree = due;
+        }
+        due += drawDelay();
+
+        Datagram* held;
+        if (m_Spare.empty())
+        {
+            held = new Datagram;
+        }
+        else
+        {
+            held = m_Spare.back();
+            m_Spare.pop_back();
+        }
+        held->source = d.source;
+        held->len    = d.len;
+        memcpy(held->data, d.data, d.len);
+        pop();
+
+        const Pending p = {due, m_uOrder++, held};
+        m_Pending.push_back(p);
+        push_heap(m_Pending.begin(), m_Pending.end());
+    }
+}
+
+int CInprocEndpoint::copyOut(const Datagram& dgram, sockaddr_any& w_source, IOVector* iov, int iovlen)
+{
+    size_t pos = 0;
+    for (int i = 0; i < iovlen && pos < dgram.len; ++i)
+    {
+        const size_t n = min(iov[i].size(), dgram.len - pos);
+        memcpy(iov[i].data(), dgram.data + pos, n);
+        pos += n;
+    }
+    if (pos < dgram.len)
+    {
+        HLOGC(krlog.Debug, log << "INPROC: dropping a datagram of " << dgram.len << " bytes, too big for the buffer");
+        return -1;
+    }
+
+    w_source = dgram.source;
+    return int(dgram.len);
+}
+
+int CInprocEndpoint::receive(sockaddr_any& w_source, IOVector* iov, int iovlen, int timeout_us)
+{
+    const steady_clock::time_point deadline = steady_clock::now() + microseconds_from(timeout_us);
+    for (;;)
+    {
+        if (m_Model.immediate())
+        {
+            // Nothing is held back, so read directly from the ring.
+            for (Slot* slot = front(); slot; slot = front())
+            {
+                const int len = drawLoss() ? -1 : copyOut(slot->dgram, (w_source), iov, iovlen);
+                pop();
+                if (len != -1)
+                    return len;
+            }
+        }
+        else
+        {
+            schedule();
+        }
+
+        const steady_clock::time_point now = steady_clock::now();
+        while (!m_Pending.empty() && m_Pending[0].tsDue <= now)
+        {
+            Datagram* d = m_Pending[0].dgram;
+            pop_heap(m_Pending.begin(), m_Pending.end());
+            m_Pending.pop_back();
+            m_Spare.push_back(d);
+
+            const int len = copyOut(*d, (w_source), iov, iovlen);
+            if (len != -1)
+                return len;
+        }
+
+        if (now >= deadline)
+            return -1;
+
+        steady_clock::time_point until = deadline;
+        if (!m_Pending.empty() && m_Pending[0].tsDue < until)
+            until = m_Pending[0].tsDue;
+
+        // A sender notifies only when it sees m_bWaiting set, so the ring
+        // must be checked again after setting it.
+        UniqueLock lk(m_WaitLock);
+        m_bWaiting.store(true);
+        if (!front() && !m_bWakeup.load())
+            m_WaitCond.wait_until(lk, until);
+        m_bWaiting.store(false);
+
+        if (m_bWakeup.exchange(false))
+            return -1;
+    }
+}
+
+void CInprocEndpoint::wakeup()
+{
+    m_bWakeup.store(true);
+    CSync::lock_notify_one(m_WaitCond, m_WaitLock);
+}
+
+namespace
+{
+
+// The endpoint bound to a port, and the number of the senders using it.
+struct PortEntry
+{
+    sync::atomic<CInprocEndpoint*> endpoint;
+    sync::atomic<int>              users;
+};
+
+const int MIN_EPHEMERAL_PORT = 49152;
+const int NUM_PORTS          = 65536;
+
+// Allocated when the first endpoint is bound and never freed, so that
+// the senders can use it without locking.
+sync::atomic<PortEntry*> s_pPorts;
+Mutex                    s_BindLock;
+int                      s_iNextPort = MIN_EPHEMERAL_PORT;
+
+} // namespace
+
+CInprocEndpoint* CInprocNetwork::bind(const sockaddr_any& addr,
+                                      const CInprocLinkModel& model,
+                                      int rcvbuf_size,
+                                      sockaddr_any& w_bound)
+{
+    ScopedLock lk(s_BindLock);
+    if (!s_pPorts.load())
+        s_pPorts.store(new PortEntry[NUM_PORTS]);
+    PortEntry* ports = s_pPorts.load();
+
+    int port = addr.hport();
+    if (port == 0)
+    {
+        for (int i = MIN_EPHEMERAL_PORT; i < NUM_PORTS && port == 0; ++i)
+        {
+            if (!ports[s_iNextPort].endpoint.load())
+                port = s_iNextPort;
+            s_iNextPort = s_iNextPort + 1 < NUM_PORTS ? s_iNextPort + 1 : MIN_EPHEMERAL_PORT;
+        }
+    }
+
+    if (port == 0 || ports[port].endpoint.load())
+    {
+        LOGC(kmlog.Error, log << "INPROC: can't bind to " << addr.str() << ": no free port or port in use");
+        throw CUDTException(MJ_SETUP, MN_NORES, EADDRINUSE);
+    }
+
+    // The ring holds as many datagrams of the usual size as the UDP buffer would.
+    const size_t capacity = max<size_t>(256, rcvbuf_size / CPacket::ETH_MAX_MTU_SIZE);
+    CInprocEndpoint* ep   = new CInprocEndpoint(model, capacity);
+    ports[port].endpoint.store(ep);
+
+    w_bound = addr;
+    w_bound.hport(port);
+    HLOGC(kmlog.Debug, log << "INPROC: bound to " << w_bound.str() << " with a ring of " << capacity << " datagrams");
+    return ep;
+}
+
+void CInprocNetwork::unbind(const sockaddr_any& bound, CInprocEndpoint* endpoint)
+{
+    ScopedLock lk(s_BindLock);
+    PortEntry& entry = s_pPorts.load()[bound.hport()];
+    entry.endpoint.store(NULL);
+
+    // A sender that has seen the endpoint is still using it.
+    while (entry.users.load() != 0)
+        sync::this_thread::sleep_for(microseconds_from(10));
+
+    delete endpoint;
+}
+
+void CInprocNetwork::send(const sockaddr_any& source, const sockaddr_any& target, const IOVector* iov, int iovlen)
+{
+    PortEntry* ports = s_pPorts.load();
+    if (!ports)
+        return;
+
+    // The endpoint is read after announcing the use, so that unbind()
+    // either waits for this sender, or this sender doesn't see the endpoint.
+    PortEntry& entry = ports[target.hport()];
+    ++entry.users;
+    CInprocEndpoint* ep = entry.endpoint.load();
+    if (ep && !ep->push(source, iov, iovlen))
+    {
+        HLOGC(kmlog.Debug, log << "INPROC: ring of " << target.str() << " full, datagram lost");
+    }
+    --entry.users;
+}
+
+} // namespace srt
@@ -0,0 +1,178 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#ifndef INC_SRT_INPROC_H
+#define INC_SRT_INPROC_H
+
+#include <string>
+#include <vector>
+
+#include "netinet_any.h"
+#include "packet.h"
+#include "sync.h"
+
+namespace srt
+{
+
+/// Impairments of the in-process link (see SRTO_INPROC_LINK), applied
+/// to the datagrams received by a multiplexer.
+struct CInprocLinkModel
+{
+    int      iDelayUs;     // Constant one-way delay
+    int      iJitterUs;    // Random extra delay, uniformly distributed in [0, jitter]
+    double   dLossRate;    // Probability of losing a datagram
+    double   dReorderRate; // Probability of holding a datagram back by iReorderUs
+    int      iReorderUs;
+    int64_t  llBandwidth;  // Link capacity in bytes per second (0: unlimited)
+    int      iQueueUs;     // Maximum queueing time at the link capacity, longer queued datagrams are dropped
+    uint32_t uSeed;        // Seed of the random draws, so that the runs are reproducible
+
+    CInprocLinkModel();
+
+    /// Whether every datagram can be delivered as soon as it's sent.
+    bool immediate() const { return iDelayUs == 0 && iJitterUs == 0 && dReorderRate == 0 && llBandwidth == 0; }
+
+    /// Parse the value of SRTO_INPROC_LINK: "on", or a comma-separated list of
+    /// KEY:VALUE with the keys: delay, jitter, reorderdelay and queue (in ms),
+    /// loss and reorder (in %), bandwidth (in Mbps) and seed.
+    /// @param [in] config the configuration string
+    /// @param [out] w_model the parsed model
+    /// @return false if the configuration is invalid
+    static bool parse(const std::string& config, CInprocLinkModel& w_model);
+};
+
+/// @brief The endpoint of a multiplexer on the in-process link.
+///
+/// The datagrams are sent by any thread into a lock-free ring, which is read
+/// by the receiver thread of the multiplexer only. The receiver applies the
+/// impairments of the link model, holding back the delayed datagrams until
+/// they are due.
+class CInprocEndpoint
+{
+public:
+    /// @param [in] model the impairments of the received datagrams
+    /// @param [in] capacity number of datagrams in the ring, rounded up to a power of 2
+    CInprocEndpoint(const CInprocLinkModel& model, size_t capacity);
+    ~CInprocEndpoint();
+
+    /// Put a datagram into the ring.
+    /// @return false if the ring is full or the datagram is too big, in which case it's lost
+    bool push(const sockaddr_any& source, const IOVector* iov, int iovlen);
+
+    /// Receive a datagram that is due, waiting up to @a timeout_us for one.
+    /// @param [out] w_source the address of the sender
+    /// @param [in,out] iov the buffers for the datagram
+    /// @param [in] iovlen number of elements in @a iov
+    /// @param [in] timeout_us time to wait for a datagram
+    /// @return size of the datagram, or -1 if none has come in time
+    int receive(sockaddr_any& w_source, IOVector* iov, int iovlen, int timeout_us);
+
+    /// Make the receiver waiting in receive() return -1 now, or when
+    /// it would wait the next time. Can be called by any thread.
+    void wakeup();
+
+    /// The maximum size of a datagram, as on the Ethernet.
+    static const size_t MAX_DATAGRAM = CPacket::ETH_MAX_MTU_SIZE - CPacket::UDP_HDR_SIZE;
+
+private:
+    CInprocEndpoint(const CInprocEndpoint&);
+    CInprocEndpoint& operator=(const CInprocEndpoint&);
+
+    struct Datagram
+    {
+        sync::steady_clock::time_point tsSent;
+        sockaddr_any                   source;
+        size_t                         len;
+        char                           data[MAX_DATAGRAM];
+    };
+
+    struct Slot
+    {
+        sync::atomic<uint64_t> seq; // Position of the datagram in the ring, +1 when filled
+        Datagram               dgram;
+    };
+
+    /// A datagram held back until it's due.
+    struct Pending
+    {
+        sync::steady_clock::time_point tsDue;
+        uint64_t                       order; // Keeps the order of the datagrams due at the same time
+        Datagram*                      dgram;
+
+        // For the heap with the earliest datagram on top
+        bool operator<(const Pending& other) const
+        {
+            return tsDue > other.tsDue || (tsDue == other.tsDue && order > other.order);
+        }
+    };
+
+    /// The oldest datagram in the ring, or NULL if the ring is empty.
+    Slot* front();
+    void  pop();
+
+    /// Move all the datagrams from the ring to m_Pending, unless lost.
+    void schedule();
+
+    /// Draw whether a datagram is lost and the extra delay it gets.
+    bool               drawLoss();
+    sync::steady_clock::duration drawDelay();
+    double             random();
+
+    /// Copy a datagram to the receiver's buffers.
+    /// @return size of the datagram, or -1 if it doesn't fit
+    static int copyOut(const Datagram& dgram, sockaddr_any& w_source, IOVector* iov, int iovlen);
+
+    Slot*                  m_pSlots;
+    uint64_t               m_uMask;
+    sync::atomic<uint64_t> m_uHead; // Next position to fill, taken by the senders
+    uint64_t               m_uTail; // Next position to read, receiver only
+
+    // The receiver waits for the senders only when the ring is empty.
+    sync::atomic<bool> m_bWaiting;
+    sync::atomic<bool> m_bWakeup; // Set by wakeup()
+    sync::Mutex        m_WaitLock;
+    sync::Condition    m_WaitCond;
+
+    // The state of the receiver only.
+    CInprocLinkModel               m_Model;
+    uint64_t                       m_uRandom;
+    std::vector<Pending>           m_Pending; // Heap by the time of delivery
+    std::vector<Datagram*>         m_Spare;   // Datagram buffers for reuse
+    uint64_t                       m_uOrder;
+    sync::steady_clock::time_point m_tsLinkFree; // When the link capacity is free again
+};
+
+/// The in-process network: the endpoints of the multiplexers using SRTO_INPROC_LINK,
+/// identified by the port only.
+class CInprocNetwork
+{
+public:
+    /// Bind an endpoint to the port of @a addr, or to a free port if it's 0.
+    /// @param [in] addr the requested address
+    /// @param [in] model the impairments of the datagrams received by the endpoint
+    /// @param [in] rcvbuf_size size of the receiver buffer in bytes, as SRTO_UDP_RCVBUF
+    /// @param [out] w_bound the bound address, with the port set
+    /// @return the endpoint, to be released by unbind()
+    /// @throw CUDTException if the port is already in use
+    static CInprocEndpoint* bind(const sockaddr_any& addr, const CInprocLinkModel& model, int rcvbuf_size,
+                                 sockaddr_any& w_bound);
+
+    /// Release the endpoint and its port. Must not be called before the receiver
+    /// thread stops using the endpoint.
+    static void unbind(const sockaddr_any& bound, CInprocEndpoint* endpoint);
+
+    /// Send a datagram to the endpoint bound to the port of @a target.
+    /// Just like with UDP, the datagram is silently lost if it can't be delivered.
+    static void send(const sockaddr_any& source, const sockaddr_any& target, const IOVector* iov, int iovlen);
+};
+
+} // namespace srt
+
+#endif
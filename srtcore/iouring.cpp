@@ -0,0 +1,665 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#include "platform_sys.h"
+
+#ifdef SRT_ENABLE_IO_URING
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <poll.h>
+
+#include "iouring.h"
+#include "common.h"
+#include "srt_compat.h"
+#include "logging.h"
+#include "logger_defs.h"
+
+// Flags and features possibly missing in older system headers.
+#ifndef IORING_SETUP_COOP_TASKRUN
+#define IORING_SETUP_COOP_TASKRUN (1U << 8)
+#endif
+#ifndef IORING_SETUP_SINGLE_ISSUER
+#define IORING_SETUP_SINGLE_ISSUER (1U << 12)
+#endif
+#ifndef IORING_FEAT_NATIVE_WORKERS
+#define IORING_FEAT_NATIVE_WORKERS (1U << 9)
+#endif
+
+using namespace std;
+using namespace srt_logging;
+
+namespace srt
+{
+
+// Enough for a batch of sending. The completion queue has twice as many
+// entries, so it can't overflow with the completions for RECV_BUFFERS.
+static const unsigned RING_ENTRIES = 128;
+
+// A provided buffer holds io_uring_recvmsg_out, the name and the control
+// data in the headroom, then the message. The room for the name fits
+// sockaddr_in6, rounded up so that the control data is aligned.
+static const size_t   RECV_NAME_SIZE = 32;
+static const unsigned RECV_GROUP     = 0;
+
+// user_data of the multishot receiving request, of its cancellation and
+// of the polling for the wakeups, out of the batch indexes.
+static const unsigned RECV_TAG   = CIoUring::MAX_BATCH + 1;
+static const unsigned CANCEL_TAG = CIoUring::MAX_BATCH + 2;
+static const unsigned WAKE_TAG   = CIoUring::MAX_BATCH + 3;
+
+// Failed system calls or receiving requests in a row after which the ring
+// is given up and the system calls are used instead.
+static const int MAX_FAILURES = 8;
+
+CIoUring::CIoUring()
+    : m_State(RING_NONE)
+    , m_RecvState(RING_NONE)
+    , m_iFD(-1)
+    , m_bMultishot(false)
+    , m_pSqMap(NULL)
+    , m_zSqMapSize(0)
+    , m_pCqMap(NULL)
+    , m_zCqMapSize(0)
+    , m_pSqes(NULL)
+    , m_zSqesSize(0)
+    , m_puSqHead(NULL)
+    , m_puSqTail(NULL)
+    , m_uSqMask(0)
+    , m_puSqArray(NULL)
+    , m_puCqHead(NULL)
+    , m_puCqTail(NULL)
+    , m_uCqMask(0)
+    , m_pCqes(NULL)
+    , m_uSqeTail(0)
+    , m_uToSubmit(0)
+    , m_iRecvFD(-1)
+    , m_pBufRing(NULL)
+    , m_zBufRingSize(0)
+    , m_uBufTail(0)
+    , m_bRecvArmed(false)
+    , m_iRecvFailures(0)
+    , m_iWakeFD(-1)
+    , m_bWakeArmed(false)
+{
+    memset(&m_RecvHdr, 0, sizeof m_RecvHdr);
+    memset(m_apRecvBufs, 0, sizeof m_apRecvBufs);
+    memset(m_azRecvBufLens, 0, sizeof m_azRecvBufLens);
+}
+
+CIoUring::~CIoUring()
+{
+    release();
+}
+
+bool CIoUring::prepare()
+{
+    if (m_State == RING_NONE)
+    {
+        if (setup())
+        {
+            m_State = RING_READY;
+            HLOGC(kmlog.Debug, log << "io_uring: ring set up with " << RING_ENTRIES << " entries");
+        }
+        else
+        {
+            const int err = errno;
+            release();
+            m_State = RING_FAILED;
+            LOGC(kmlog.Warn, log << "io_uring: not available (" << SysStrError(err) << "), using the system calls");
+        }
+    }
+    return m_State == RING_READY;
+}
+
+bool CIoUring::prepareRecv(int fd, int wakefd)
+{
+    if (m_RecvState == RING_NONE && prepare())
+    {
+        m_iWakeFD = wakefd;
+        if (setupRecv(fd))
+        {
+            m_RecvState = RING_READY;
+            HLOGC(kmlog.Debug, log << "io_uring: receiving from @" << fd << " with " << unsigned(RECV_BUFFERS) << " buffers");
+        }
+        else
+        {
+            const int err = errno;
+            m_RecvState   = RING_FAILED;
+            LOGC(kmlog.Warn, log << "io_uring: receiving not available (" << SysStrError(err) << "), using the system calls");
+        }
+    }
+    SRT_ASSERT(m_RecvState != RING_READY || fd == m_iRecvFD);
+    return m_RecvState == RING_READY && m_State == RING_READY;
+}
+
+bool CIoUring::setup()
+{
+    io_uring_params p;
+    memset(&p, 0, sizeof p);
+    p.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+    m_iFD = (int)::syscall(__NR_io_uring_setup, RING_ENTRIES, &p);
+    // The flags are not supported before Linux 6.0, which also
+    // introduced the multishot receiving.
+    m_bMultishot = m_iFD != -1;
+    if (m_iFD == -1 && errno == EINVAL)
+    {
+        memset(&p, 0, sizeof p);
+        m_iFD = (int)::syscall(__NR_io_uring_setup, RING_ENTRIES, &p);
+    }
+    if (m_iFD == -1)
+        return false;
+
+    // The receiving waits for the completions with a timeout.
+    if (!(p.features & IORING_FEAT_EXT_ARG))
+        m_bMultishot = false;
+
+    // Linux 5.12 is required for the non-blocking receiving with MSG_DONTWAIT
+    // in the linked requests, otherwise they would wait for the data.
+    if (!(p.features & IORING_FEAT_NATIVE_WORKERS))
+    {
+        errno = ENOSYS;
+        return false;
+    }
+
+    vector<char> probe_buf(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = (io_uring_probe*)&probe_buf[0];
+    if (::syscall(__NR_io_uring_register, m_iFD, IORING_REGISTER_PROBE, probe, 256) == -1)
+        return false;
+
+    static const int required_ops[] = {IORING_OP_RECVMSG, IORING_OP_SENDMSG};
+    for (size_t i = 0; i < sizeof required_ops / sizeof required_ops[0]; ++i)
+    {
+        const int op = required_ops[i];
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+        {
+            errno = ENOSYS;
+            return false;
+        }
+    }
+
+    m_zSqMapSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    m_zCqMapSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        m_zSqMapSize = m_zCqMapSize = max(m_zSqMapSize, m_zCqMapSize);
+    }
+
+    m_pSqMap = ::mmap(NULL, m_zSqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFD, IORING_OFF_SQ_RING);
+    if (m_pSqMap == MAP_FAILED)
+    {
+        m_pSqMap = NULL;
+        return false;
+    }
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        m_pCqMap = m_pSqMap;
+    }
+    else
+    {
+        m_pCqMap = ::mmap(NULL, m_zCqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFD, IORING_OFF_CQ_RING);
+        if (m_pCqMap == MAP_FAILED)
+        {
+            m_pCqMap = NULL;
+            return false;
+        }
+    }
+
+    m_zSqesSize = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes  = ::mmap(NULL, m_zSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_iFD, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+        return false;
+    m_pSqes = (io_uring_sqe*)sqes;
+
+    char* sq    = (char*)m_pSqMap;
+    m_puSqHead  = (unsigned*)(sq + p.sq_off.head);
+    m_puSqTail  = (unsigned*)(sq + p.sq_off.tail);
+    m_uSqMask   = *(unsigned*)(sq + p.sq_off.ring_mask);
+    m_puSqArray = (unsigned*)(sq + p.sq_off.array);
+
+    char* cq   = (char*)m_pCqMap;
+    m_puCqHead = (unsigned*)(cq + p.cq_off.head);
+    m_puCqTail = (unsigned*)(cq + p.cq_off.tail);
+    m_uCqMask  = *(unsigned*)(cq + p.cq_off.ring_mask);
+    m_pCqes    = (io_uring_cqe*)(cq + p.cq_off.cqes);
+
+    m_uSqeTail = *m_puSqTail;
+    return true;
+}
+
+bool CIoUring::setupRecv(int fd)
+{
+#ifdef IORING_RECV_MULTISHOT
+    if (!m_bMultishot)
+    {
+        errno = ENOSYS;
+        return false;
+    }
+
+    m_zBufRingSize = RECV_BUFFERS * sizeof(io_uring_buf);
+    void* ring     = ::mmap(NULL, m_zBufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED)
+        return false;
+    m_pBufRing = ring;
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof reg);
+    reg.ring_addr    = (uintptr_t)m_pBufRing;
+    reg.ring_entries = RECV_BUFFERS;
+    reg.bgid         = RECV_GROUP;
+    if (::syscall(__NR_io_uring_register, m_iFD, IORING_REGISTER_PBUF_RING, &reg, 1) == -1)
+        return false;
+
+    // The buffers are given by the caller afterwards.
+    m_uBufTail = 0;
+
+    SRT_STATIC_ASSERT(sizeof(io_uring_recvmsg_out) + RECV_NAME_SIZE < RECV_HEADROOM, "No room for the control data");
+    m_RecvHdr.msg_namelen    = RECV_NAME_SIZE;
+    m_RecvHdr.msg_controllen = RECV_HEADROOM - sizeof(io_uring_recvmsg_out) - RECV_NAME_SIZE;
+    m_iRecvFD                = fd;
+    return true;
+#else
+    (void)fd;
+    errno = ENOSYS;
+    return false;
+#endif
+}
+
+void CIoUring::release()
+{
+    // Closing the ring first cancels the receiving request using the buffers.
+    if (m_iFD != -1)
+        ::close(m_iFD);
+    if (m_pSqes)
+        ::munmap(m_pSqes, m_zSqesSize);
+    if (m_pCqMap && m_pCqMap != m_pSqMap)
+        ::munmap(m_pCqMap, m_zCqMapSize);
+    if (m_pSqMap)
+        ::munmap(m_pSqMap, m_zSqMapSize);
+    if (m_pBufRing)
+        ::munmap(m_pBufRing, m_zBufRingSize);
+
+    m_pSqes      = NULL;
+    m_pCqMap     = NULL;
+    m_pSqMap     = NULL;
+    m_pBufRing   = NULL;
+    m_iFD        = -1;
+    m_bRecvArmed = false;
+    m_bWakeArmed = false;
+}
+
+void CIoUring::fail(const char* what, int err)
+{
+    LOGC(kmlog.Error, log << "io_uring: " << what << " failed " << MAX_FAILURES << " times ("
+            << SysStrError(err) << "), using the system calls");
+    release();
+    m_State     = RING_FAILED;
+    m_RecvState = RING_FAILED;
+    errno       = err;
+}
+
+io_uring_sqe* CIoUring::getSqe()
+{
+    // There's always enough room, as every batch is completed before the next one.
+    const unsigned idx = m_uSqeTail & m_uSqMask;
+    m_puSqArray[idx]   = idx;
+    ++m_uSqeTail;
+    ++m_uToSubmit;
+
+    io_uring_sqe* sqe = &m_pSqes[idx];
+    memset(sqe, 0, sizeof *sqe);
+    return sqe;
+}
+
+void CIoUring::flushSqes()
+{
+    __atomic_store_n(m_puSqTail, m_uSqeTail, __ATOMIC_RELEASE);
+}
+
+bool CIoUring::submitAndComplete(unsigned n)
+{
+    flushSqes();
+
+    unsigned to_submit = m_uToSubmit;
+    unsigned done      = 0;
+    int      failures  = 0;
+    m_uToSubmit        = 0;
+    while (done < n)
+    {
+        const int ret = (int)::syscall(__NR_io_uring_enter, m_iFD, to_submit, n - done, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret == -1)
+        {
+            const int err = errno;
+            // Nothing submitted yet means that nothing is in use by the kernel.
+            if (to_submit == n && err != EINTR && err != EAGAIN && err != EBUSY)
+            {
+                // Take back the entries not submitted.
+                m_uSqeTail -= to_submit;
+                flushSqes();
+                return false;
+            }
+
+            // Otherwise wait for the completions, as the buffers are in use,
+            // but not forever if the error persists: closing the ring cancels
+            // the requests in progress.
+            if (++failures >= MAX_FAILURES)
+            {
+                fail("submitting", err);
+                return false;
+            }
+        }
+        else
+        {
+            to_submit -= min(to_submit, (unsigned)ret);
+            failures = 0;
+        }
+
+        unsigned       head = *m_puCqHead;
+        const unsigned tail = __atomic_load_n(m_puCqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe& cqe = m_pCqes[head & m_uCqMask];
+            if (cqe.user_data <= MAX_BATCH)
+                m_aiResults[cqe.user_data] = cqe.res;
+            ++done;
+        }
+        __atomic_store_n(m_puCqHead, head, __ATOMIC_RELEASE);
+    }
+
+    return true;
+}
+
+#ifdef IORING_RECV_MULTISHOT
+
+void CIoUring::armRecv()
+{
+    // One request receives the messages until it fails or the buffers
+    // run out, each message in a provided buffer, with one completion each.
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode       = IORING_OP_RECVMSG;
+    sqe->fd           = m_iRecvFD;
+    sqe->addr         = (uintptr_t)&m_RecvHdr;
+    sqe->len          = 1;
+    sqe->flags        = IOSQE_BUFFER_SELECT;
+    sqe->ioprio       = IORING_RECV_MULTISHOT;
+    sqe->buf_group    = RECV_GROUP;
+    sqe->user_data    = RECV_TAG;
+    m_bRecvArmed      = true;
+}
+
+void CIoUring::armWake()
+{
+    // One-shot, so that it's completed once for every wakeup. The events
+    // are word-reversed on big-endian machines (see io_uring_sqe).
+    uint32_t events = POLLIN;
+#if __BYTE_ORDER == __BIG_ENDIAN
+    events = (events << 16) | (events >> 16);
+#endif
+    io_uring_sqe* sqe  = getSqe();
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = m_iWakeFD;
+    sqe->poll32_events = events;
+    sqe->user_data     = WAKE_TAG;
+    m_bWakeArmed       = true;
+}
+
+unsigned CIoUring::reapRecv(RecvMsg* msgs, unsigned n, int& w_err)
+{
+    unsigned       nrecv = 0;
+    unsigned       head  = *m_puCqHead;
+    const unsigned tail  = __atomic_load_n(m_puCqTail, __ATOMIC_ACQUIRE);
+    for (; head != tail && nrecv < n; ++head)
+    {
+        const io_uring_cqe& cqe = m_pCqes[head & m_uCqMask];
+        if (cqe.user_data == WAKE_TAG)
+        {
+            m_bWakeArmed = false; // The caller drains the descriptor.
+            continue;
+        }
+
+        if (cqe.user_data != RECV_TAG)
+            continue;
+
+        if (!(cqe.flags & IORING_CQE_F_MORE))
+            m_bRecvArmed = false; // Re-armed with the next system call.
+
+        if (cqe.flags & IORING_CQE_F_BUFFER)
+        {
+            // A buffer used for nothing is given back to the kernel, unless
+            // the messages are dropped, which is when all buffers are returned.
+            const unsigned bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+            if (cqe.res >= 0 && msgs)
+            {
+                parseRecv(bid, cqe.res, (msgs[nrecv]));
+                ++nrecv;
+                m_iRecvFailures = 0;
+            }
+            else if (msgs)
+            {
+                pushRecvBuffer(bid);
+            }
+        }
+        else if (cqe.res < 0 && cqe.res != -ENOBUFS)
+        {
+            // ENOBUFS only means that all buffers are in use.
+            w_err = -cqe.res;
+            ++m_iRecvFailures;
+        }
+    }
+    __atomic_store_n(m_puCqHead, head, __ATOMIC_RELEASE);
+    return nrecv;
+}
+
+void CIoUring::parseRecv(unsigned bid, int res, RecvMsg& w_msg) const
+{
+    const char* const buf = m_apRecvBufs[bid];
+    const io_uring_recvmsg_out& out = *(const io_uring_recvmsg_out*)buf;
+    const char* name = buf + sizeof out;
+
+    w_msg.bid        = bid;
+    w_msg.flags      = out.flags;
+    w_msg.name       = (const sockaddr*)name;
+    w_msg.namelen    = out.namelen;
+    w_msg.control    = name + m_RecvHdr.msg_namelen;
+    w_msg.controllen = min<size_t>(out.controllen, m_RecvHdr.msg_controllen);
+    w_msg.len        = size_t(res) - RECV_HEADROOM;
+}
+
+void CIoUring::pushRecvBuffer(unsigned bid)
+{
+    // Indexed directly, as io_uring_buf_ring::bufs has a different offset in C++.
+    // The tail of the ring overlays the resv field of the first buffer.
+    io_uring_buf* bufs = (io_uring_buf*)m_pBufRing;
+    io_uring_buf& b    = bufs[m_uBufTail & (RECV_BUFFERS - 1)];
+    b.addr             = (uintptr_t)m_apRecvBufs[bid];
+    b.len              = (uint32_t)m_azRecvBufLens[bid];
+    b.bid              = (uint16_t)bid;
+    ++m_uBufTail;
+    __atomic_store_n(&bufs[0].resv, (uint16_t)m_uBufTail, __ATOMIC_RELEASE);
+}
+
+#endif // IORING_RECV_MULTISHOT
+
+void CIoUring::provideRecvBuffer(unsigned bid, char* buf, size_t len)
+{
+#ifdef IORING_RECV_MULTISHOT
+    SRT_ASSERT(m_RecvState == RING_READY && bid < RECV_BUFFERS && len > RECV_HEADROOM);
+    m_apRecvBufs[bid]    = buf;
+    m_azRecvBufLens[bid] = len;
+    pushRecvBuffer(bid);
+#else
+    (void)bid;
+    (void)buf;
+    (void)len;
+#endif
+}
+
+int CIoUring::recvmsgs(RecvMsg* msgs, unsigned n, long timeout_us)
+{
+#ifdef IORING_RECV_MULTISHOT
+    // The messages already received need no system call.
+    int      err   = 0;
+    unsigned nrecv = reapRecv(msgs, n, (err));
+    if (nrecv == 0 && err == 0)
+    {
+        if (!m_bRecvArmed)
+            armRecv();
+        if (!m_bWakeArmed && m_iWakeFD != -1)
+            armWake();
+        flushSqes();
+
+        __kernel_timespec ts;
+        ts.tv_sec  = timeout_us / 1000000;
+        ts.tv_nsec = (timeout_us % 1000000) * 1000;
+        io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof arg);
+        arg.ts = (uintptr_t)&ts;
+
+        const int ret = (int)::syscall(__NR_io_uring_enter, m_iFD, m_uToSubmit, 1,
+                IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof arg);
+        if (ret == -1)
+        {
+            err = errno;
+            if (err != ETIME && err != EINTR)
+                ++m_iRecvFailures;
+        }
+        else
+        {
+            m_uToSubmit -= min(m_uToSubmit, (unsigned)ret);
+        }
+        nrecv = reapRecv(msgs, n, (err));
+    }
+    else if (!m_bRecvArmed)
+    {
+        // Re-arm the request finished while the buffers were all taken.
+        armRecv();
+        flushSqes();
+        const int ret = (int)::syscall(__NR_io_uring_enter, m_iFD, m_uToSubmit, 0, 0, NULL, 0);
+        if (ret == -1)
+        {
+            err = errno;
+            ++m_iRecvFailures;
+        }
+        else
+        {
+            m_uToSubmit -= min(m_uToSubmit, (unsigned)ret);
+        }
+    }
+
+    if (m_iRecvFailures >= MAX_FAILURES)
+    {
+        fail("receiving", err);
+        return nrecv > 0 ? (int)nrecv : -1;
+    }
+
+    if (nrecv == 0)
+    {
+        errno = err == 0 || err == ETIME ? EAGAIN : err;
+        return -1;
+    }
+    return (int)nrecv;
+#else
+    (void)msgs;
+    (void)n;
+    (void)timeout_us;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+bool CIoUring::cancelRecv()
+{
+#ifdef IORING_RECV_MULTISHOT
+    if (m_State != RING_READY || m_RecvState != RING_READY)
+    {
+        // A ring given up after the buffers were given may still be
+        // torn down by the kernel.
+        return m_uBufTail == 0;
+    }
+
+    // The buffers left in the buffer ring are not to be used again.
+    m_RecvState = RING_FAILED;
+    if (!m_bRecvArmed)
+        return true;
+
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->fd           = -1;
+    sqe->addr         = RECV_TAG;
+    sqe->user_data    = CANCEL_TAG;
+    flushSqes();
+
+    __kernel_timespec ts;
+    ts.tv_sec  = 0;
+    ts.tv_nsec = 10000000;
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof arg);
+    arg.ts = (uintptr_t)&ts;
+
+    // The request is finished with its last completion.
+    for (int i = 0; m_bRecvArmed && i < MAX_FAILURES; ++i)
+    {
+        const int ret = (int)::syscall(__NR_io_uring_enter, m_iFD, m_uToSubmit, 1,
+                IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof arg);
+        if (ret > 0)
+            m_uToSubmit -= min(m_uToSubmit, (unsigned)ret);
+
+        int err = 0;
+        reapRecv(NULL, RECV_BUFFERS, (err));
+    }
+
+    if (m_bRecvArmed)
+    {
+        // Closing the ring cancels the request, but not right away.
+        fail("cancelling", ETIMEDOUT);
+        return false;
+    }
+    return true;
+#else
+    return true;
+#endif
+}
+
+int CIoUring::sendmmsg(int fd, mmsghdr* msgs, unsigned n)
+{
+    SRT_ASSERT(m_iRecvFD == -1);
+    for (unsigned i = 0; i < n; ++i)
+    {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode       = IORING_OP_SENDMSG;
+        sqe->fd           = fd;
+        sqe->addr         = (uintptr_t)&msgs[i].msg_hdr;
+        sqe->len          = 1;
+        sqe->flags        = i + 1 < n ? IOSQE_IO_LINK : 0;
+        sqe->user_data    = i;
+    }
+
+    if (!submitAndComplete(n))
+        return -1;
+
+    unsigned nsent = 0;
+    for (; nsent < n && m_aiResults[nsent] >= 0; ++nsent)
+        msgs[nsent].msg_len = m_aiResults[nsent];
+
+    if (nsent == 0)
+    {
+        errno = -m_aiResults[0];
+        return -1;
+    }
+    return (int)nsent;
+}
+
+} // namespace srt
+
+#endif // SRT_ENABLE_IO_URING
@@ -0,0 +1,195 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#ifndef INC_SRT_IOURING_H
+#define INC_SRT_IOURING_H
+
+#ifdef SRT_ENABLE_IO_URING
+
+#include <sys/socket.h>
+#include <linux/io_uring.h>
+
+namespace srt
+{
+
+/// @brief Minimal io_uring instance for the batched UDP I/O of CChannel
+/// (see SRTO_UDP_IOURING), using the system calls directly.
+///
+/// A ring is used either for receiving or for sending, by one thread only.
+/// Receiving keeps one multishot request armed on the socket, which places
+/// every message in one of the buffers provided by the caller, so the messages
+/// already received are taken without a system call and without copying.
+/// Sending submits every batch as one chain of linked requests and completes
+/// all of them before the call returns, so that no buffer is left in use by
+/// the kernel.
+class CIoUring
+{
+public:
+    CIoUring();
+    ~CIoUring();
+
+    /// Set up the ring for sending in the first call. Must be called by the thread using the ring.
+    /// @return false if io_uring can't be used, in which case it isn't tried again.
+    bool prepare();
+
+    /// Set up the ring for receiving from @a fd in the first call, like prepare().
+    /// The ring receives only from this socket afterwards.
+    /// @param [in] fd socket
+    /// @param [in] wakefd descriptor ending the waiting in recvmsgs() when readable, or -1
+    /// @return false if io_uring can't be used for receiving (Linux 6.0 is required).
+    bool prepareRecv(int fd, int wakefd = -1);
+
+    /// A message received into a buffer given with provideRecvBuffer(). The message
+    /// itself starts at RECV_HEADROOM in the buffer, the name and the control
+    /// data are placed before it.
+    struct RecvMsg
+    {
+        unsigned        bid;        // id of the buffer
+        int             flags;      // as msg_flags of recvmsg()
+        const sockaddr* name;
+        socklen_t       namelen;    // actual length, possibly more than the room for it
+        const void*     control;
+        size_t          controllen;
+        size_t          len;        // length of the message in the buffer
+    };
+
+    /// Room taken before the message in the buffers for receiving.
+    static const size_t RECV_HEADROOM = 128;
+
+    /// Maximum number of buffers for receiving, which are identified by a number below it.
+    static const unsigned RECV_BUFFERS = 128;
+
+    /// Give a buffer to the kernel to receive a message into, after prepareRecv().
+    /// The buffer is in use by the kernel until returned by recvmsgs(), or
+    /// until cancelRecv() succeeds.
+    /// @param [in] bid id of the buffer, below RECV_BUFFERS and not given already
+    /// @param [in] buf buffer, with RECV_HEADROOM bytes before the message
+    /// @param [in] len size of the buffer, including RECV_HEADROOM
+    void provideRecvBuffer(unsigned bid, char* buf, size_t len);
+
+    /// Receive messages as recvmmsg() with MSG_WAITFORONE would: wait up to
+    /// @a timeout_us for the first message, then take only the messages already
+    /// received by the system. The waiting also ends when the descriptor given
+    /// to prepareRecv() is readable, which is left to the caller to drain.
+    /// The buffers of the messages returned belong to the caller again.
+    /// @param [out] msgs messages received
+    /// @param [in] n number of messages
+    /// @param [in] timeout_us time to wait for the first message
+    /// @return number of messages received, or -1 with errno set
+    int recvmsgs(RecvMsg* msgs, unsigned n, long timeout_us);
+
+    /// Cancel the receiving request, dropping the messages not taken, so that
+    /// the socket isn't referred to by the ring any longer when it's closed.
+    /// Must be called by the receiving thread.
+    /// @return true if no buffer is in use by the kernel any longer, false
+    /// if that can't be confirmed, in which case the buffers must be kept.
+    bool cancelRecv();
+
+    /// Send messages as sendmmsg() would: in order, stopping at the first failure.
+    /// @param [in] fd socket
+    /// @param [in,out] msgs messages to send, msg_len set as by sendmmsg()
+    /// @param [in] n number of messages, up to MAX_BATCH
+    /// @return number of messages sent, or -1 with errno set
+    int sendmmsg(int fd, mmsghdr* msgs, unsigned n);
+
+    static const unsigned MAX_BATCH = 64;
+
+private:
+    CIoUring(const CIoUring&);
+    CIoUring& operator=(const CIoUring&);
+
+    bool setup();
+    bool setupRecv(int fd);
+    void release();
+
+    /// Release the ring after a failure that can't be recovered from,
+    /// so that the system calls are used from now on.
+    void fail(const char* what, int err);
+
+    /// Get the next submission entry, cleared.
+    io_uring_sqe* getSqe();
+
+    /// Make all the entries got visible to the kernel.
+    void flushSqes();
+
+    /// Submit all the entries and collect @a n completions into m_aiResults,
+    /// indexed by user_data.
+    /// @return false on a failure of the system call (errno set)
+    bool submitAndComplete(unsigned n);
+
+    /// Prepare the multishot receiving request, submitted with the next system call.
+    void armRecv();
+
+    /// Prepare the polling for m_iWakeFD, submitted with the next system call.
+    void armWake();
+
+    /// Take the received messages from the completion queue, up to @a n.
+    /// @param [out] msgs messages to fill in, or NULL to drop them
+    /// @param [out] w_err the error of a failed receiving request, if any
+    /// @return number of messages taken
+    unsigned reapRecv(RecvMsg* msgs, unsigned n, int& w_err);
+
+    /// Fill in @a w_msg for the message of @a res bytes received into the buffer @a bid.
+    void parseRecv(unsigned bid, int res, RecvMsg& w_msg) const;
+
+    /// Add the buffer @a bid to the buffer ring.
+    void pushRecvBuffer(unsigned bid);
+
+    enum State
+    {
+        RING_NONE,
+        RING_READY,
+        RING_FAILED
+    };
+    State m_State;
+    State m_RecvState;
+
+    int      m_iFD;
+    bool     m_bMultishot; // multishot receiving is supported by the kernel
+    void*    m_pSqMap;
+    size_t   m_zSqMapSize;
+    void*    m_pCqMap; // the same as m_pSqMap with IORING_FEAT_SINGLE_MMAP
+    size_t   m_zCqMapSize;
+    io_uring_sqe* m_pSqes;
+    size_t   m_zSqesSize;
+
+    unsigned* m_puSqHead;
+    unsigned* m_puSqTail;
+    unsigned  m_uSqMask;
+    unsigned* m_puSqArray;
+    unsigned* m_puCqHead;
+    unsigned* m_puCqTail;
+    unsigned  m_uCqMask;
+    io_uring_cqe* m_pCqes;
+
+    unsigned m_uSqeTail;   // tail of the entries got, not yet submitted
+    unsigned m_uToSubmit;  // number of entries got since the last submission
+
+    int m_aiResults[MAX_BATCH + 1]; // results of the last batch
+
+    // Receiving
+    int      m_iRecvFD;
+    msghdr   m_RecvHdr;     // reserved name and control sizes in the provided buffers
+    void*    m_pBufRing;    // io_uring_buf_ring shared with the kernel
+    size_t   m_zBufRingSize;
+    char*    m_apRecvBufs[RECV_BUFFERS]; // buffers given with provideRecvBuffer()
+    size_t   m_azRecvBufLens[RECV_BUFFERS];
+    unsigned m_uBufTail;    // tail of the buffer ring
+    bool     m_bRecvArmed;  // the multishot request is active
+    int      m_iRecvFailures; // failures in a row of the receiving request
+    int      m_iWakeFD;     // see prepareRecv()
+    bool     m_bWakeArmed;  // the polling for m_iWakeFD is active
+};
+
+} // namespace srt
+
+#endif // SRT_ENABLE_IO_URING
+
+#endif
@@ -52,6 +52,7 @@ modified by
 
 #include "platform_sys.h"
 
+#include <algorithm>
 #include "list.h"
 #include "packet.h"
 #include "logging.h"
@@ -70,30 +71,197 @@ using srt_logging::tslog;
 
 using namespace srt::sync;
 
-srt::CSndLossList::CSndLossList(int size)
-    : m_caSeq()
-    , m_iHead(-1)
-    , m_iLength(0)
-    , m_iSize(size)
-    , m_iLastInsertPos(-1)
-    , m_ListLock()
+namespace
+{
+
+int popcount64(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return int((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// v must not be 0.
+int ctz64(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    while (!(v & 1))
+    {
+        v >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Mask of len bits starting from bit pos (pos + len <= 64).
+uint64_t bitMask(int pos, int len)
+{
+    return (len == 64 ? ~uint64_t(0) : ((uint64_t(1) << len) - 1)) << pos;
+}
+
+} // namespace
+
+srt::CSeqBitmap::CSeqBitmap(int size)
+    : m_pWords(NULL)
+    , m_iCapacity(((size + 63) / 64) * 64)
+    , m_iBasePos(0)
+    , m_iBaseSeq(0)
+{
+    const int nwords = m_iCapacity / 64;
+    m_pWords = new uint64_t[nwords];
+    std::fill(m_pWords, m_pWords + nwords, uint64_t(0));
+}
+
+srt::CSeqBitmap::~CSeqBitmap()
+{
+    delete[] m_pWords;
+}
+
+void srt::CSeqBitmap::reset(int32_t seqno)
+{
+    m_iBasePos = 0;
+    m_iBaseSeq = seqno;
+}
+
+void srt::CSeqBitmap::rebase(int32_t seqno)
+{
+    int pos = m_iBasePos + offsetOf(seqno) % m_iCapacity;
+    if (pos < 0)
+        pos += m_iCapacity;
+    else if (pos >= m_iCapacity)
+        pos -= m_iCapacity;
+    m_iBasePos = pos;
+    m_iBaseSeq = seqno;
+}
+
+int srt::CSeqBitmap::set(int from, int to)
+{
+    return update(from, to, OP_SET);
+}
+
+int srt::CSeqBitmap::clear(int from, int to)
 {
-    m_caSeq = new Seq[size];
+    return update(from, to, OP_CLEAR);
+}
+
+int srt::CSeqBitmap::count(int from, int to) const
+{
+    return update(from, to, OP_COUNT);
+}
+
+int srt::CSeqBitmap::update(int from, int to, Op op) const
+{
+    SRT_ASSERT(from >= 0 && from <= to && to < m_iCapacity);
+    const int pos = phys(from);
+    const int len = to - from + 1;
+
+    // The range may wrap around the end of the ring.
+    const int first = std::min(len, m_iCapacity - pos);
+    int       n     = updateSegment(pos, first, op);
+    if (first < len)
+        n += updateSegment(0, len - first, op);
+    return n;
+}
+
+int srt::CSeqBitmap::updateSegment(int pos, int len, Op op) const
+{
+    int n = 0;
+    while (len > 0)
+    {
+        uint64_t& word = m_pWords[pos / 64];
+        const int bit  = pos % 64;
+        const int nb   = std::min(64 - bit, len);
+        const uint64_t mask = bitMask(bit, nb);
+
+        if (op == OP_SET)
+        {
+            n += popcount64(mask & ~word);
+            word |= mask;
+        }
+        else if (op == OP_CLEAR)
+        {
+            n += popcount64(mask & word);
+            word &= ~mask;
+        }
+        else
+        {
+            n += popcount64(mask & word);
+        }
+
+        pos += nb;
+        len -= nb;
+    }
+    return n;
+}
+
+int srt::CSeqBitmap::find(int from, int to, bool set) const
+{
+    if (from > to)
+        return -1;
 
-    // -1 means there is no data in the node
-    for (int i = 0; i < size; ++i)
+    SRT_ASSERT(from >= 0 && to < m_iCapacity);
+    const int pos   = phys(from);
+    const int len   = to - from + 1;
+    const int first = std::min(len, m_iCapacity - pos);
+
+    int found = findSegment(pos, first, set);
+    if (found != -1)
+        return from + found;
+
+    if (first < len)
     {
-        m_caSeq[i].seqstart = SRT_SEQNO_NONE;
-        m_caSeq[i].seqend   = SRT_SEQNO_NONE;
+        found = findSegment(0, len - first, set);
+        if (found != -1)
+            return from + first + found;
     }
+    return -1;
+}
+
+int srt::CSeqBitmap::findSegment(int pos, int len, bool set) const
+{
+    for (int done = 0; done < len;)
+    {
+        const uint64_t word = m_pWords[pos / 64];
+        const int      bit  = pos % 64;
+        const int      nb   = std::min(64 - bit, len - done);
+        const uint64_t bits = (set ? word : ~word) & bitMask(bit, nb);
 
+        if (bits)
+            return done + ctz64(bits) - bit;
+
+        pos += nb;
+        done += nb;
+    }
+    return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The first lost sequence number is the base of the bitmap, and a new loss may
+// be up to the size from it. The capacity leaves room also for the losses
+// reported before the first one (they are accepted if the span fits).
+srt::CSndLossList::CSndLossList(int size)
+    : m_Lost(3 * size)
+    , m_iLastSeq(SRT_SEQNO_NONE)
+    , m_iLength(0)
+    , m_iSize(size)
+    , m_ListLock()
+{
     // sender list needs mutex protection
     setupMutex(m_ListLock, "LossList");
 }
 
 srt::CSndLossList::~CSndLossList()
 {
-    delete[] m_caSeq;
     releaseMutex(m_ListLock);
 }
 
@@ -103,6 +271,22 @@ void srt::CSndLossList::traceState() const
 }
 
 int srt::CSndLossList::insert(int32_t seqno1, int32_t seqno2)
+{
+    ScopedLock listguard(m_ListLock);
+    return insert_(seqno1, seqno2);
+}
+
+int srt::CSndLossList::insert(const ranges_t& ranges)
+{
+    ScopedLock listguard(m_ListLock);
+
+    int n = 0;
+    for (ranges_t::const_iterator i = ranges.begin(); i != ranges.end(); ++i)
+        n += insert_(i->first, i->second);
+    return n;
+}
+
+int srt::CSndLossList::insert_(int32_t seqno1, int32_t seqno2)
 {
     if (seqno1 < 0 || seqno2 < 0 ) {
         LOGC(qslog.Error, log << "IPE: Tried to insert negative seqno " << seqno1 << ":" << seqno2
@@ -117,106 +301,54 @@ int srt::CSndLossList::insert(int32_t seqno1, int32_t seqno2)
         return 0;
     }
 
-    ScopedLock listguard(m_ListLock);
-
     if (m_iLength == 0)
     {
-        insertHead(0, seqno1, seqno2);
-        return m_iLength;
+        m_Lost.reset(seqno1);
+        m_Lost.set(0, inserted_range - 1);
+        m_iLastSeq = seqno2;
+        m_iLength  = inserted_range;
+        return inserted_range;
     }
 
-    // Find the insert position in the non-empty list
-    const int origlen = m_iLength;
-    const int offset  = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno1);
-
+    const int offset = m_Lost.offsetOf(seqno1);
     if (offset >= m_iSize)
     {
         LOGC(qslog.Error, log << "IPE: New loss record is too far from the first record. Ignoring. "
-                << "First loss seqno " << m_caSeq[m_iHead].seqstart
+                << "First loss seqno " << m_Lost.base()
                 << ", insert seqno " << seqno1 << ":" << seqno2);
         return 0;
     }
 
-    int loc = (m_iHead + offset + m_iSize) % m_iSize;
-
-    if (loc < 0)
+    if (offset < 0)
     {
-        const int offset_seqno2 = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno2);
-        const int loc_seqno2    = (m_iHead + offset_seqno2 + m_iSize) % m_iSize;
-
-        if (loc_seqno2 < 0)
+        // The size of the CSndLossList should be at least the size of the flow window.
+        // It means that all the packets sender has sent should fit within m_iSize.
+        // If the new loss does not fit, there is some error.
+        const int32_t last = CSeqNo::seqcmp(seqno2, m_iLastSeq) > 0 ? seqno2 : m_iLastSeq;
+        if (m_Lost.offsetOf(seqno2) <= -m_iSize || CSeqNo::seqlen(seqno1, last) > m_Lost.capacity())
         {
-            // The size of the CSndLossList should be at least the size of the flow window.
-            // It means that all the packets sender has sent should fit within m_iSize.
-            // If the new loss does not fit, there is some error.
             LOGC(qslog.Error, log << "IPE: New loss record is too old. Ignoring. "
-                << "First loss seqno " << m_caSeq[m_iHead].seqstart
+                << "First loss seqno " << m_Lost.base()
                 << ", insert seqno " << seqno1 << ":" << seqno2);
             return 0;
         }
 
-        loc = loc_seqno2;
+        m_Lost.rebase(seqno1);
     }
-
-    if (offset < 0)
-    {
-        insertHead(loc, seqno1, seqno2);
-    }
-    else if (offset > 0)
+    else if (m_Lost.offsetOf(seqno2) >= m_Lost.capacity())
     {
-        if (seqno1 == m_caSeq[loc].seqstart)
-        {
-            const bool updated = updateElement(loc, seqno1, seqno2);
-            if (!updated)
-                return 0;
-        }
-        else
-        {
-            // Find the prior node.
-            // It should be the highest sequence number less than seqno1.
-            // 1. Start the search either from m_iHead, or from m_iLastInsertPos
-            int i = m_iHead;
-            if ((m_iLastInsertPos != -1) && (CSeqNo::seqcmp(m_caSeq[m_iLastInsertPos].seqstart, seqno1) < 0))
-                i = m_iLastInsertPos;
-
-            // 2. Find the highest sequence number less than seqno1.
-            while (m_caSeq[i].inext != -1 && CSeqNo::seqcmp(m_caSeq[m_caSeq[i].inext].seqstart, seqno1) < 0)
-                i = m_caSeq[i].inext;
-
-            // 3. Check if seqno1 overlaps with (seqbegin, seqend)
-            const int seqend = m_caSeq[i].seqend == SRT_SEQNO_NONE ? m_caSeq[i].seqstart : m_caSeq[i].seqend;
-
-            if (CSeqNo::seqcmp(seqend, seqno1) < 0 && CSeqNo::incseq(seqend) != seqno1)
-            {
-                // No overlap
-                // TODO: Here we should actually insert right after i, not at loc.
-                insertAfter(loc, i, seqno1, seqno2);
-            }
-            else
-            {
-                // TODO: Replace with updateElement(i, seqno1, seqno2).
-                // Some changes to updateElement(..) are required.
-                m_iLastInsertPos = i;
-                if (CSeqNo::seqcmp(seqend, seqno2) >= 0)
-                    return 0;
-
-                // overlap, coalesce with prior node, insert(3, 7) to [2, 5], ... becomes [2, 7]
-                m_iLength += CSeqNo::seqlen(seqend, seqno2) - 1;
-                m_caSeq[i].seqend = seqno2;
-
-                loc = i;
-            }
-        }
-    }
-    else // offset == 0, loc == m_iHead
-    {
-        const bool updated = updateElement(m_iHead, seqno1, seqno2);
-        if (!updated)
-            return 0;
+        LOGC(qslog.Error, log << "IPE: New loss record is too far from the first record. Ignoring. "
+                << "First loss seqno " << m_Lost.base()
+                << ", insert seqno " << seqno1 << ":" << seqno2);
+        return 0;
     }
 
-    coalesce(loc);
-    return m_iLength - origlen;
+    const int from = m_Lost.offsetOf(seqno1);
+    const int n    = m_Lost.set(from, from + inserted_range - 1);
+    if (CSeqNo::seqcmp(seqno2, m_iLastSeq) > 0)
+        m_iLastSeq = seqno2;
+    m_iLength += n;
+    return n;
 }
 
 void srt::CSndLossList::removeUpTo(int32_t seqno)
@@ -226,109 +358,21 @@ void srt::CSndLossList::removeUpTo(int32_t seqno)
     if (0 == m_iLength)
         return;
 
-    // Remove all from the head pointer to a node with a larger seq. no. or the list is empty
-    int offset = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno);
-    int loc    = (m_iHead + offset + m_iSize) % m_iSize;
+    const int offset = m_Lost.offsetOf(seqno);
+    if (offset < 0)
+        return;
 
-    if (0 == offset)
+    const int lastoff = m_Lost.offsetOf(m_iLastSeq);
+    if (offset >= lastoff)
     {
-        // It is the head. Remove the head and point to the next node
-        loc = (loc + 1) % m_iSize;
-
-        if (SRT_SEQNO_NONE == m_caSeq[m_iHead].seqend)
-            loc = m_caSeq[m_iHead].inext;
-        else
-        {
-            m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-            if (CSeqNo::seqcmp(m_caSeq[m_iHead].seqend, CSeqNo::incseq(seqno)) > 0)
-                m_caSeq[loc].seqend = m_caSeq[m_iHead].seqend;
-
-            m_caSeq[m_iHead].seqend = SRT_SEQNO_NONE;
-
-            m_caSeq[loc].inext = m_caSeq[m_iHead].inext;
-        }
-
-        m_caSeq[m_iHead].seqstart = SRT_SEQNO_NONE;
-
-        if (m_iLastInsertPos == m_iHead)
-            m_iLastInsertPos = -1;
-
-        m_iHead = loc;
-
-        m_iLength--;
+        m_Lost.clear(0, lastoff);
+        m_iLength = 0;
+        return;
     }
-    else if (offset > 0)
-    {
-        int h = m_iHead;
-
-        if (seqno == m_caSeq[loc].seqstart)
-        {
-            // target node is not empty, remove part/all of the seqno in the node.
-            int temp = loc;
-            loc      = (loc + 1) % m_iSize;
-
-            if (SRT_SEQNO_NONE == m_caSeq[temp].seqend)
-                m_iHead = m_caSeq[temp].inext;
-            else
-            {
-                // remove part, e.g., [3, 7] becomes [], [4, 7] after remove(3)
-                m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-                if (CSeqNo::seqcmp(m_caSeq[temp].seqend, m_caSeq[loc].seqstart) > 0)
-                    m_caSeq[loc].seqend = m_caSeq[temp].seqend;
-                m_iHead              = loc;
-                m_caSeq[loc].inext   = m_caSeq[temp].inext;
-                m_caSeq[temp].inext  = loc;
-                m_caSeq[temp].seqend = SRT_SEQNO_NONE;
-            }
-        }
-        else
-        {
-            // target node is empty, check prior node
-            int i = m_iHead;
-            while ((-1 != m_caSeq[i].inext) && (CSeqNo::seqcmp(m_caSeq[m_caSeq[i].inext].seqstart, seqno) < 0))
-                i = m_caSeq[i].inext;
-
-            loc = (loc + 1) % m_iSize;
-
-            if (SRT_SEQNO_NONE == m_caSeq[i].seqend)
-                m_iHead = m_caSeq[i].inext;
-            else if (CSeqNo::seqcmp(m_caSeq[i].seqend, seqno) > 0)
-            {
-                // remove part/all seqno in the prior node
-                m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-                if (CSeqNo::seqcmp(m_caSeq[i].seqend, m_caSeq[loc].seqstart) > 0)
-                    m_caSeq[loc].seqend = m_caSeq[i].seqend;
-
-                m_caSeq[i].seqend = seqno;
-
-                m_caSeq[loc].inext = m_caSeq[i].inext;
-                m_caSeq[i].inext   = loc;
-
-                m_iHead = loc;
-            }
-            else
-                m_iHead = m_caSeq[i].inext;
-        }
-
-        // Remove all nodes prior to the new head
-        while (h != m_iHead)
-        {
-            if (m_caSeq[h].seqend != SRT_SEQNO_NONE)
-            {
-                m_iLength -= CSeqNo::seqlen(m_caSeq[h].seqstart, m_caSeq[h].seqend);
-                m_caSeq[h].seqend = SRT_SEQNO_NONE;
-            }
-            else
-                m_iLength--;
-
-            m_caSeq[h].seqstart = SRT_SEQNO_NONE;
 
-            if (m_iLastInsertPos == h)
-                m_iLastInsertPos = -1;
-
-            h = m_caSeq[h].inext;
-        }
-    }
+    m_iLength -= m_Lost.clear(0, offset);
+    if (m_iLength > 0)
+        m_Lost.rebase(CSeqNo::incseq(m_Lost.base(), m_Lost.findSet(offset + 1, lastoff)));
 }
 
 int srt::CSndLossList::getLossLength() const
@@ -343,158 +387,34 @@ int32_t srt::CSndLossList::popLostSeq()
     ScopedLock listguard(m_ListLock);
 
     if (0 == m_iLength)
-    {
-        SRT_ASSERT(m_iHead == -1);
         return SRT_SEQNO_NONE;
-    }
-
-    if (m_iLastInsertPos == m_iHead)
-        m_iLastInsertPos = -1;
 
     // return the first loss seq. no.
-    const int32_t seqno = m_caSeq[m_iHead].seqstart;
-
-    // head moves to the next node
-    if (SRT_SEQNO_NONE == m_caSeq[m_iHead].seqend)
-    {
-        //[3, SRT_SEQNO_NONE] becomes [], and head moves to next node in the list
-        m_caSeq[m_iHead].seqstart = SRT_SEQNO_NONE;
-        m_iHead                   = m_caSeq[m_iHead].inext;
-    }
-    else
-    {
-        // shift to next node, e.g., [3, 7] becomes [], [4, 7]
-        int loc = (m_iHead + 1) % m_iSize;
-
-        m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-        if (CSeqNo::seqcmp(m_caSeq[m_iHead].seqend, m_caSeq[loc].seqstart) > 0)
-            m_caSeq[loc].seqend = m_caSeq[m_iHead].seqend;
-
-        m_caSeq[m_iHead].seqstart = SRT_SEQNO_NONE;
-        m_caSeq[m_iHead].seqend   = SRT_SEQNO_NONE;
-
-        m_caSeq[loc].inext = m_caSeq[m_iHead].inext;
-        m_iHead            = loc;
-    }
-
+    const int32_t seqno = m_Lost.base();
+    m_Lost.clear(0, 0);
     m_iLength--;
 
-    return seqno;
-}
-
-void srt::CSndLossList::insertHead(int pos, int32_t seqno1, int32_t seqno2)
-{
-    SRT_ASSERT(pos >= 0);
-    m_caSeq[pos].seqstart = seqno1;
-    SRT_ASSERT(m_caSeq[pos].seqend == SRT_SEQNO_NONE);
-    if (seqno2 != seqno1)
-        m_caSeq[pos].seqend = seqno2;
-
-    // new node becomes head
-    m_caSeq[pos].inext = m_iHead;
-    m_iHead            = pos;
-    m_iLastInsertPos   = pos;
-
-    m_iLength += CSeqNo::seqlen(seqno1, seqno2);
-}
-
-void srt::CSndLossList::insertAfter(int pos, int pos_after, int32_t seqno1, int32_t seqno2)
-{
-    m_caSeq[pos].seqstart = seqno1;
-    SRT_ASSERT(m_caSeq[pos].seqend == SRT_SEQNO_NONE);
-    if (seqno2 != seqno1)
-        m_caSeq[pos].seqend = seqno2;
-
-    m_caSeq[pos].inext       = m_caSeq[pos_after].inext;
-    m_caSeq[pos_after].inext = pos;
-    m_iLastInsertPos         = pos;
-
-    m_iLength += CSeqNo::seqlen(seqno1, seqno2);
-}
-
-void srt::CSndLossList::coalesce(int loc)
-{
-    // coalesce with next node. E.g., [3, 7], ..., [6, 9] becomes [3, 9]
-    while ((m_caSeq[loc].inext != -1) && (m_caSeq[loc].seqend != SRT_SEQNO_NONE))
-    {
-        const int i = m_caSeq[loc].inext;
-        if (CSeqNo::seqcmp(m_caSeq[i].seqstart, CSeqNo::incseq(m_caSeq[loc].seqend)) > 0)
-            break;
-
-        // coalesce if there is overlap
-        if (m_caSeq[i].seqend != SRT_SEQNO_NONE)
-        {
-            if (CSeqNo::seqcmp(m_caSeq[i].seqend, m_caSeq[loc].seqend) > 0)
-            {
-                if (CSeqNo::seqcmp(m_caSeq[loc].seqend, m_caSeq[i].seqstart) >= 0)
-                    m_iLength -= CSeqNo::seqlen(m_caSeq[i].seqstart, m_caSeq[loc].seqend);
-
-                m_caSeq[loc].seqend = m_caSeq[i].seqend;
-            }
-            else
-                m_iLength -= CSeqNo::seqlen(m_caSeq[i].seqstart, m_caSeq[i].seqend);
-        }
-        else
-        {
-            if (m_caSeq[i].seqstart == CSeqNo::incseq(m_caSeq[loc].seqend))
-                m_caSeq[loc].seqend = m_caSeq[i].seqstart;
-            else
-                m_iLength--;
-        }
-
-        m_caSeq[i].seqstart = SRT_SEQNO_NONE;
-        m_caSeq[i].seqend   = SRT_SEQNO_NONE;
-        m_caSeq[loc].inext  = m_caSeq[i].inext;
-    }
-}
+    // the base moves to the next lost seq. no.
+    if (m_iLength > 0)
+        m_Lost.rebase(CSeqNo::incseq(seqno, m_Lost.findSet(1, m_Lost.offsetOf(m_iLastSeq))));
 
-bool srt::CSndLossList::updateElement(int pos, int32_t seqno1, int32_t seqno2)
-{
-    m_iLastInsertPos = pos;
-
-    if (seqno2 == SRT_SEQNO_NONE || seqno2 == seqno1)
-        return false;
-
-    if (m_caSeq[pos].seqend == SRT_SEQNO_NONE)
-    {
-        m_iLength += CSeqNo::seqlen(seqno1, seqno2) - 1;
-        m_caSeq[pos].seqend = seqno2;
-        return true;
-    }
-
-    // seqno2 <= m_caSeq[pos].seqend
-    if (CSeqNo::seqcmp(seqno2, m_caSeq[pos].seqend) <= 0)
-        return false;
-
-    // seqno2 > m_caSeq[pos].seqend
-    m_iLength += CSeqNo::seqlen(m_caSeq[pos].seqend, seqno2) - 1;
-    m_caSeq[pos].seqend = seqno2;
-    return true;
+    return seqno;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// The capacity leaves room for the losses beyond the size, which would
+// otherwise have to be rejected.
 srt::CRcvLossList::CRcvLossList(int size)
-    : m_caSeq()
-    , m_iHead(-1)
-    , m_iTail(-1)
+    : m_Lost(2 * size)
+    , m_iLastSeq(SRT_SEQNO_NONE)
     , m_iLength(0)
-    , m_iSize(size)
     , m_iLargestSeq(SRT_SEQNO_NONE)
 {
-    m_caSeq = new Seq[m_iSize];
-
-    // -1 means there is no data in the node
-    for (int i = 0; i < size; ++i)
-    {
-        m_caSeq[i].seqstart = SRT_SEQNO_NONE;
-        m_caSeq[i].seqend   = SRT_SEQNO_NONE;
-    }
 }
 
 srt::CRcvLossList::~CRcvLossList()
 {
-    delete[] m_caSeq;
 }
 
 int srt::CRcvLossList::insert(int32_t seqno1, int32_t seqno2)
@@ -518,62 +438,71 @@ int srt::CRcvLossList::insert(int32_t seqno1, int32_t seqno2)
             LOGC(qrlog.Warn,
                  log << "RCV-LOSS/insert: (" << seqno1 << "," << seqno2
                      << ") to be inserted is too small: m_iLargestSeq=" << m_iLargestSeq << ", m_iLength=" << m_iLength
-                     << ", m_iHead=" << m_iHead << ", m_iTail=" << m_iTail << " -- REJECTING");
+                     << ", first=" << getFirstLostSeq() << " -- REJECTING");
             return 0;
         }
     }
     m_iLargestSeq = seqno2;
 
+    const int n = CSeqNo::seqlen(seqno1, seqno2);
     if (0 == m_iLength)
     {
         // insert data into an empty list
-        m_iHead                   = 0;
-        m_iTail                   = 0;
-        m_caSeq[m_iHead].seqstart = seqno1;
-        if (seqno2 != seqno1)
-            m_caSeq[m_iHead].seqend = seqno2;
-
-        m_caSeq[m_iHead].inext  = -1;
-        m_caSeq[m_iHead].iprior = -1;
-        const int n = CSeqNo::seqlen(seqno1, seqno2);
-        m_iLength += n;
+        if (n > m_Lost.capacity())
+        {
+            LOGC(qrlog.Error,
+                 log << "RCV-LOSS/insert: IPE: new LOSS %(" << seqno1 << "-" << seqno2 << ") TOO LONG -- REJECTING");
+            return -1;
+        }
+
+        m_Lost.reset(seqno1);
+        m_Lost.set(0, n - 1);
+        m_iLastSeq = seqno2;
+        m_iLength  = n;
         return n;
     }
 
-    // otherwise searching for the position where the node should be
-    const int offset = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno1);
+    // otherwise find the position from the first loss
+    const int offset = m_Lost.offsetOf(seqno1);
     if (offset < 0)
     {
         LOGC(qrlog.Error,
              log << "RCV-LOSS/insert: IPE: new LOSS %(" << seqno1 << "-" << seqno2 << ") PREDATES HEAD %"
-                 << m_caSeq[m_iHead].seqstart << " -- REJECTING");
+                 << m_Lost.base() << " -- REJECTING");
         return -1;
     }
 
-    int loc = (m_iHead + offset) % m_iSize;
-
-    if ((SRT_SEQNO_NONE != m_caSeq[m_iTail].seqend) && (CSeqNo::incseq(m_caSeq[m_iTail].seqend) == seqno1))
+    if (offset + n > m_Lost.capacity())
     {
-        // coalesce with prior node, e.g., [2, 5], [6, 7] becomes [2, 7]
-        loc                 = m_iTail;
-        m_caSeq[loc].seqend = seqno2;
+        LOGC(qrlog.Error,
+             log << "RCV-LOSS/insert: IPE: new LOSS %(" << seqno1 << "-" << seqno2 << ") TOO FAR FROM HEAD %"
+                 << m_Lost.base() << " -- REJECTING");
+        return -1;
     }
-    else
-    {
-        // create new node
-        m_caSeq[loc].seqstart = seqno1;
 
-        if (seqno2 != seqno1)
-            m_caSeq[loc].seqend = seqno2;
+    m_Lost.set(offset, offset + n - 1);
+    m_iLastSeq = seqno2;
+    m_iLength += n;
+    return n;
+}
 
-        m_caSeq[m_iTail].inext = loc;
-        m_caSeq[loc].iprior    = m_iTail;
-        m_caSeq[loc].inext     = -1;
-        m_iTail                = loc;
-    }
+int srt::CRcvLossList::removeRange(int from, int to)
+{
+    const int lastoff = m_Lost.offsetOf(m_iLastSeq);
+    if (from < 0)
+        from = 0;
+    if (to > lastoff)
+        to = lastoff;
+    if (from > to)
+        return 0;
+
+    const int n = m_Lost.clear(from, to);
+    m_iLength -= n;
+
+    // Move the base to the first lost one.
+    if (n > 0 && from == 0 && m_iLength > 0)
+        m_Lost.rebase(CSeqNo::incseq(m_Lost.base(), m_Lost.findSet(to + 1, lastoff)));
 
-    const int n = CSeqNo::seqlen(seqno1, seqno2);
-    m_iLength += n;
     return n;
 }
 
@@ -586,130 +515,8 @@ bool srt::CRcvLossList::remove(int32_t seqno)
         return false;
 
     // locate the position of "seqno" in the list
-    int offset = CSeqNo::seqoff(m_caSeq[m_iHead].seqstart, seqno);
-    if (offset < 0)
-        return false;
-
-    int loc = (m_iHead + offset) % m_iSize;
-
-    if (seqno == m_caSeq[loc].seqstart)
-    {
-        // This is a seq. no. that starts the loss sequence
-
-        if (SRT_SEQNO_NONE == m_caSeq[loc].seqend)
-        {
-            // there is only 1 loss in the sequence, delete it from the node
-            if (m_iHead == loc)
-            {
-                m_iHead = m_caSeq[m_iHead].inext;
-                if (-1 != m_iHead)
-                    m_caSeq[m_iHead].iprior = -1;
-                else
-                    m_iTail = -1;
-            }
-            else
-            {
-                m_caSeq[m_caSeq[loc].iprior].inext = m_caSeq[loc].inext;
-                if (-1 != m_caSeq[loc].inext)
-                    m_caSeq[m_caSeq[loc].inext].iprior = m_caSeq[loc].iprior;
-                else
-                    m_iTail = m_caSeq[loc].iprior;
-            }
-
-            m_caSeq[loc].seqstart = SRT_SEQNO_NONE;
-        }
-        else
-        {
-            // there are more than 1 loss in the sequence
-            // move the node to the next and update the starter as the next loss inSeqNo(seqno)
-
-            // find next node
-            int i = (loc + 1) % m_iSize;
-
-            // remove the "seqno" and change the starter as next seq. no.
-            m_caSeq[i].seqstart = CSeqNo::incseq(m_caSeq[loc].seqstart);
-
-            // process the sequence end
-            if (CSeqNo::seqcmp(m_caSeq[loc].seqend, CSeqNo::incseq(m_caSeq[loc].seqstart)) > 0)
-                m_caSeq[i].seqend = m_caSeq[loc].seqend;
-
-            // remove the current node
-            m_caSeq[loc].seqstart = SRT_SEQNO_NONE;
-            m_caSeq[loc].seqend   = SRT_SEQNO_NONE;
-
-            // update list pointer
-            m_caSeq[i].inext  = m_caSeq[loc].inext;
-            m_caSeq[i].iprior = m_caSeq[loc].iprior;
-
-            if (m_iHead == loc)
-                m_iHead = i;
-            else
-                m_caSeq[m_caSeq[i].iprior].inext = i;
-
-            if (m_iTail == loc)
-                m_iTail = i;
-            else
-                m_caSeq[m_caSeq[i].inext].iprior = i;
-        }
-
-        m_iLength--;
-
-        return true;
-    }
-
-    // There is no loss sequence in the current position
-    // the "seqno" may be contained in a previous node
-
-    // searching previous node
-    int i = (loc - 1 + m_iSize) % m_iSize;
-    while (SRT_SEQNO_NONE == m_caSeq[i].seqstart)
-        i = (i - 1 + m_iSize) % m_iSize;
-
-    // not contained in this node, return
-    if ((SRT_SEQNO_NONE == m_caSeq[i].seqend) || (CSeqNo::seqcmp(seqno, m_caSeq[i].seqend) > 0))
-        return false;
-
-    if (seqno == m_caSeq[i].seqend)
-    {
-        // it is the sequence end
-
-        if (seqno == CSeqNo::incseq(m_caSeq[i].seqstart))
-            m_caSeq[i].seqend = SRT_SEQNO_NONE;
-        else
-            m_caSeq[i].seqend = CSeqNo::decseq(seqno);
-    }
-    else
-    {
-        // split the sequence
-
-        // construct the second sequence from CSeqNo::incseq(seqno) to the original sequence end
-        // located at "loc + 1"
-        loc = (loc + 1) % m_iSize;
-
-        m_caSeq[loc].seqstart = CSeqNo::incseq(seqno);
-        if (CSeqNo::seqcmp(m_caSeq[i].seqend, m_caSeq[loc].seqstart) > 0)
-            m_caSeq[loc].seqend = m_caSeq[i].seqend;
-
-        // the first (original) sequence is between the original sequence start to CSeqNo::decseq(seqno)
-        if (seqno == CSeqNo::incseq(m_caSeq[i].seqstart))
-            m_caSeq[i].seqend = SRT_SEQNO_NONE;
-        else
-            m_caSeq[i].seqend = CSeqNo::decseq(seqno);
-
-        // update the list pointer
-        m_caSeq[loc].inext  = m_caSeq[i].inext;
-        m_caSeq[i].inext    = loc;
-        m_caSeq[loc].iprior = i;
-
-        if (m_iTail == i)
-            m_iTail = loc;
-        else
-            m_caSeq[m_caSeq[loc].inext].iprior = loc;
-    }
-
-    m_iLength--;
-
-    return true;
+    const int offset = m_Lost.offsetOf(seqno);
+    return removeRange(offset, offset) > 0;
 }
 
 bool srt::CRcvLossList::remove(int32_t seqno1, int32_t seqno2)
@@ -718,10 +525,13 @@ bool srt::CRcvLossList::remove(int32_t seqno1, int32_t seqno2)
     {
         return false;
     }
-    for (int32_t i = seqno1; CSeqNo::seqcmp(i, seqno2) <= 0; i = CSeqNo::incseq(i))
-    {
-        remove(i);
-    }
+
+    // Same as removing every sequence number in the range.
+    if (m_iLargestSeq == SRT_SEQNO_NONE || CSeqNo::seqcmp(seqno2, m_iLargestSeq) > 0)
+        m_iLargestSeq = seqno2;
+
+    if (m_iLength > 0)
+        removeRange(m_Lost.offsetOf(seqno1), m_Lost.offsetOf(seqno2));
     return true;
 }
 
@@ -744,11 +554,7 @@ int32_t srt::CRcvLossList::removeUpTo(int32_t seqno_last)
 
     // NOTE: seqno_last is past-the-end here. Removed are only seqs
     // that are earlier than this.
-    for (int32_t i = first; CSeqNo::seqcmp(i, seqno_last) <= 0; i = CSeqNo::incseq(i))
-    {
-        //HLOGC(tslog.Debug, log << "... removing %" << i);
-        remove(i);
-    }
+    remove(first, seqno_last);
 
     return first;
 }
@@ -758,20 +564,10 @@ bool srt::CRcvLossList::find(int32_t seqno1, int32_t seqno2) const
     if (0 == m_iLength)
         return false;
 
-    int p = m_iHead;
-
-    while (-1 != p)
-    {
-        if ((CSeqNo::seqcmp(m_caSeq[p].seqstart, seqno1) == 0) ||
-            ((CSeqNo::seqcmp(m_caSeq[p].seqstart, seqno1) > 0) && (CSeqNo::seqcmp(m_caSeq[p].seqstart, seqno2) <= 0)) ||
-            ((CSeqNo::seqcmp(m_caSeq[p].seqstart, seqno1) < 0) && (m_caSeq[p].seqend != SRT_SEQNO_NONE) &&
-             CSeqNo::seqcmp(m_caSeq[p].seqend, seqno1) >= 0))
-            return true;
-
-        p = m_caSeq[p].inext;
-    }
-
-    return false;
+    const int lastoff = m_Lost.offsetOf(m_iLastSeq);
+    const int from    = std::max(0, m_Lost.offsetOf(seqno1));
+    const int to      = std::min(lastoff, m_Lost.offsetOf(seqno2));
+    return from <= to && m_Lost.findSet(from, to) != -1;
 }
 
 int srt::CRcvLossList::getLossLength() const
@@ -784,29 +580,35 @@ int32_t srt::CRcvLossList::getFirstLostSeq() const
     if (0 == m_iLength)
         return SRT_SEQNO_NONE;
 
-    return m_caSeq[m_iHead].seqstart;
+    return m_Lost.base();
 }
 
 void srt::CRcvLossList::getLossArray(int32_t* array, int& len, int limit)
 {
     len = 0;
+    if (0 == m_iLength)
+        return;
 
-    int i = m_iHead;
-
-    while ((len < limit - 1) && (-1 != i))
+    const int lastoff = m_Lost.offsetOf(m_iLastSeq);
+    for (int off = 0; (len < limit - 1) && off <= lastoff;)
     {
-        array[len] = m_caSeq[i].seqstart;
-        if (SRT_SEQNO_NONE != m_caSeq[i].seqend)
+        const int first = m_Lost.findSet(off, lastoff);
+        if (first == -1)
+            break;
+        int last = m_Lost.findClear(first, lastoff);
+        last     = last == -1 ? lastoff : last - 1;
+
+        array[len] = CSeqNo::incseq(m_Lost.base(), first);
+        if (last != first)
         {
             // there are more than 1 loss in the sequence
             array[len] |= LOSSDATA_SEQNO_RANGE_FIRST;
             ++len;
-            array[len] = m_caSeq[i].seqend;
+            array[len] = CSeqNo::incseq(m_Lost.base(), last);
         }
 
         ++len;
-
-        i = m_caSeq[i].inext;
+        off = last + 1;
     }
 }
 
@@ -54,15 +54,84 @@ modified by
 #define INC_SRT_LIST_H
 
 #include <deque>
+#include <vector>
 
 #include "udt.h"
 #include "common.h"
 
 namespace srt {
 
+/// Set of sequence numbers within a window following a base sequence number,
+/// kept as a ring of bits: one bit per sequence number at its offset from the base.
+/// The operations on ranges are done on whole 64-bit words. The offsets passed
+/// to the range operations are inclusive and must be within [0, capacity()).
+class CSeqBitmap
+{
+public:
+    /// @param size minimum span of sequence numbers (rounded up to the word size).
+    explicit CSeqBitmap(int size);
+    ~CSeqBitmap();
+
+    int capacity() const { return m_iCapacity; }
+    int32_t base() const { return m_iBaseSeq; }
+    int offsetOf(int32_t seqno) const { return CSeqNo::seqoff(m_iBaseSeq, seqno); }
+
+    /// Set a new base sequence number when no bit is set.
+    void reset(int32_t seqno);
+
+    /// Move the base to the given sequence number, keeping the bits.
+    /// The bits that would be out of the window must be clear.
+    void rebase(int32_t seqno);
+
+    /// @return number of bits that were clear before.
+    int set(int from, int to);
+
+    /// @return number of bits that were set before.
+    int clear(int from, int to);
+
+    /// @return number of bits set in the range.
+    int count(int from, int to) const;
+
+    /// @return offset of the first set bit in the range, or -1 if none.
+    int findSet(int from, int to) const { return find(from, to, true); }
+
+    /// @return offset of the first clear bit in the range, or -1 if none.
+    int findClear(int from, int to) const { return find(from, to, false); }
+
+private:
+    enum Op
+    {
+        OP_SET,
+        OP_CLEAR,
+        OP_COUNT
+    };
+
+    int update(int from, int to, Op op) const;
+    int updateSegment(int pos, int len, Op op) const;
+    int find(int from, int to, bool set) const;
+    int findSegment(int pos, int len, bool set) const;
+
+    int phys(int offset) const
+    {
+        const int p = m_iBasePos + offset;
+        return p >= m_iCapacity ? p - m_iCapacity : p;
+    }
+
+    uint64_t* m_pWords;
+    int       m_iCapacity; // number of bits
+    int       m_iBasePos;  // bit position of the base sequence number
+    int32_t   m_iBaseSeq;
+
+private:
+    CSeqBitmap(const CSeqBitmap&);
+    CSeqBitmap& operator=(const CSeqBitmap&);
+};
+
 class CSndLossList
 {
 public:
+    typedef std::vector< std::pair<int32_t, int32_t> > ranges_t;
+
     CSndLossList(int size = 1024);
     ~CSndLossList();
 
@@ -72,6 +141,11 @@ public:
     /// @return number of packets that are not in the list previously.
     int insert(int32_t seqno1, int32_t seqno2);
 
+    /// Insert all ranges from a loss report at once.
+    /// @param [in] ranges first and last sequence number of every range.
+    /// @return number of packets that are not in the list previously.
+    int insert(const ranges_t& ranges);
+
     /// Remove the given sequence number and all numbers that precede it.
     /// @param [in] seqno sequence number.
     void removeUpTo(int32_t seqno);
@@ -87,66 +161,35 @@ public:
     template <class Stream>
     Stream& traceState(Stream& sout) const
     {
-        int pos = m_iHead;
-        while (pos != SRT_SEQNO_NONE)
+        const int lastoff = m_iLength ? m_Lost.offsetOf(m_iLastSeq) : -1;
+        for (int off = 0; off <= lastoff;)
         {
-            sout << "[" << pos << "]:" << m_caSeq[pos].seqstart;
-            if (m_caSeq[pos].seqend != SRT_SEQNO_NONE)
-                sout << ":" << m_caSeq[pos].seqend;
-            if (m_caSeq[pos].inext == -1)
-                sout << "=|";
-            else
-                sout << "->[" << m_caSeq[pos].inext << "]";
+            const int first = m_Lost.findSet(off, lastoff);
+            if (first == -1)
+                break;
+            int last = m_Lost.findClear(first, lastoff);
+            last     = last == -1 ? lastoff : last - 1;
+            sout << CSeqNo::incseq(m_Lost.base(), first);
+            if (last != first)
+                sout << ":" << CSeqNo::incseq(m_Lost.base(), last);
             sout << ", ";
-            pos = m_caSeq[pos].inext;
+            off = last + 1;
         }
-        sout << " {len:" << m_iLength << " head:" << m_iHead << " last:" << m_iLastInsertPos << "}";
+        sout << " {len:" << m_iLength << "}";
         return sout;
     }
     void traceState() const;
 
-    // Debug/unittest support.
-
-    int head() const { return m_iHead; }
-    int next(int loc) const { return m_caSeq[loc].inext; }
-    int last() const { return m_iLastInsertPos; }
-
 private:
-    struct Seq
-    {
-        int32_t seqstart; // sequence number starts
-        int32_t seqend;   // sequence number ends
-        int     inext;    // index of the next node in the list
-    } * m_caSeq;
+    int insert_(int32_t seqno1, int32_t seqno2);
 
-    int       m_iHead;          // first node
-    int       m_iLength;        // loss length
-    const int m_iSize;          // size of the static array
-    int       m_iLastInsertPos; // position of last insert node
+    CSeqBitmap m_Lost;        // the lost sequence numbers, with the first lost one as the base
+    int32_t    m_iLastSeq;    // not earlier than the last lost sequence number (if not empty)
+    int        m_iLength;     // loss length
+    const int  m_iSize;       // maximum span of a range and offset of a new range from the first one
 
     mutable srt::sync::Mutex m_ListLock; // used to synchronize list operation
 
-private:
-    /// Inserts an element to the beginning and updates head pointer.
-    /// No lock.
-    void insertHead(int pos, int32_t seqno1, int32_t seqno2);
-
-    /// Inserts an element after previous element.
-    /// No lock.
-    void insertAfter(int pos, int pos_after, int32_t seqno1, int32_t seqno2);
-
-    /// Check if it is possible to coalesce element at loc with further elements.
-    /// @param loc - last changed location
-    void coalesce(int loc);
-
-    /// Update existing element with the new range (increase only)
-    /// @param pos     position of the element being updated
-    /// @param seqno1  first sequence number in range
-    /// @param seqno2  last sequence number in range (SRT_SEQNO_NONE if no range)
-    bool updateElement(int pos, int32_t seqno1, int32_t seqno2);
-
-    static const int LOC_NONE = -1;
-
 private:
     CSndLossList(const CSndLossList&);
     CSndLossList& operator=(const CSndLossList&);
@@ -210,70 +253,18 @@ public:
     void getLossArray(int32_t* array, int& len, int limit);
 
 private:
-    struct Seq
-    {
-        int32_t seqstart; // sequence number starts
-        int32_t seqend;   // sequence number ends
-        int     inext;    // index of the next node in the list
-        int     iprior;   // index of the previous node in the list
-    } * m_caSeq;
-
-    int m_iHead;   // first node in the list
-    int m_iTail;   // last node in the list;
-    int m_iLength; // loss length
-    int m_iSize;   // size of the static array
-    int m_iLargestSeq; // largest seq ever seen
+    /// Clear the range of offsets and move the base to the next lost sequence number.
+    /// @return number of removed sequence numbers.
+    int removeRange(int from, int to);
+
+    CSeqBitmap m_Lost;        // the lost sequence numbers, with the first lost one as the base
+    int32_t    m_iLastSeq;    // not earlier than the last lost sequence number (if not empty)
+    int        m_iLength;     // loss length
+    int        m_iLargestSeq; // largest seq ever seen
 
 private:
     CRcvLossList(const CRcvLossList&);
     CRcvLossList& operator=(const CRcvLossList&);
-
-public:
-    struct iterator
-    {
-        int32_t head;
-        Seq*    seq;
-
-        iterator(Seq* str, int32_t v)
-            : head(v)
-            , seq(str)
-        {
-        }
-
-        iterator next() const
-        {
-            if (head == -1)
-                return *this; // should report error, but we can only throw exception, so simply ignore it.
-
-            return iterator(seq, seq[head].inext);
-        }
-
-        iterator& operator++()
-        {
-            *this = next();
-            return *this;
-        }
-
-        iterator operator++(int)
-        {
-            iterator old(seq, head);
-            *this = next();
-            return old;
-        }
-
-        bool operator==(const iterator& second) const
-        {
-            // Ignore seq - should be the same and this is only a sanity check.
-            return head == second.head;
-        }
-
-        bool operator!=(const iterator& second) const { return !(*this == second); }
-
-        std::pair<int32_t, int32_t> operator*() { return std::make_pair(seq[head].seqstart, seq[head].seqend); }
-    };
-
-    iterator begin() { return iterator(m_caSeq, m_iHead); }
-    iterator end() { return iterator(m_caSeq, -1); }
 };
 
 struct CRcvFreshLoss
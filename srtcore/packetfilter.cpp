@@ -128,9 +128,8 @@ void srt::PacketFilter::receive(CUnit* unit, std::vector<CUnit*>& w_incoming, lo
 
     if (m_filter->receive(rpkt, w_loss_seqs))
     {
-        // For the sake of rebuilding MARK THIS UNIT GOOD, otherwise the
-        // unit factory will supply it from getNextAvailUnit() as if it were not in use.
-        unit->m_bTaken = true;
+        // The unit stays reserved for the time of dispatching, so the unit
+        // factory will not supply it from getNextAvailUnit() for rebuilding.
         HLOGC(pflog.Debug, log << "FILTER: PASSTHRU current packet %" << unit->m_Packet.getSeqNo());
         w_incoming.push_back(unit);
     }
@@ -172,18 +171,10 @@ void srt::PacketFilter::receive(CUnit* unit, std::vector<CUnit*>& w_incoming, lo
         m_parent->m_stats.rcvr.suppliedByFilter.count((uint32_t)nsupply);
     }
 
-    // Now that all units have been filled as they should be,
-    // SET THEM ALL FREE. This is because now it's up to the 
-    // buffer to decide as to whether it wants them or not.
-    // Wanted units will be set GOOD flag, unwanted will remain
-    // with FREE and therefore will be returned at the next
-    // call to getNextAvailUnit().
-    unit->m_bTaken = false;
-    for (vector<CUnit*>::iterator i = w_incoming.begin(); i != w_incoming.end(); ++i)
-    {
-        CUnit* u = *i;
-        u->m_bTaken = false;
-    }
+    // Now that all units have been filled as they should be, it's up to
+    // the buffer to decide as to whether it wants them or not. Wanted units
+    // will be set GOOD flag, unwanted will be returned at the next call to
+    // getNextAvailUnit() after the reservation is released (see CUDT::processData).
 
     // Packets must be sorted by sequence number, ascending, in order
     // not to challenge the SRT's contiguity checker.
@@ -244,20 +235,16 @@ void srt::PacketFilter::InsertRebuilt(vector<CUnit*>& incoming, CUnitQueue* uq)
 
     for (vector<SrtPacket>::iterator i = m_provided.begin(); i != m_provided.end(); ++i)
     {
-        CUnit* u = uq->getNextAvailUnit();
+        // The unit is RESERVED because otherwise the next call
+        // to getNextAvailUnit will return THE SAME UNIT. The reservation
+        // is released after the buffer decides whether it wants it or not.
+        CUnit* u = uq->reserveNextAvailUnit();
         if (!u)
         {
             LOGC(pflog.Error, log << "FILTER: LOCAL STORAGE DEPLETED. Can't return rebuilt packets.");
             break;
         }
 
-        // LOCK the unit as taken because otherwise the next
-        // call to getNextAvailUnit will return THE SAME UNIT.
-        u->m_bTaken = true;
-        // After returning from this function, all units will be
-        // set back to FREE so that the buffer can decide whether
-        // it wants them or not.
-
         CPacket& packet = u->m_Packet;
 
         memcpy((packet.getHeader()), i->hdr, CPacket::HDR_SIZE);
@@ -294,6 +281,9 @@ void srt::PacketFilter::globalInit()
 
     filters["fec"] = new Creator<FECFilterBuiltin>;
     builtin_filters.insert("fec");
+
+    filters["rs"] = new Creator<RSFilterBuiltin>;
+    builtin_filters.insert("rs");
 }
 
 bool srt::PacketFilter::configure(CUDT* parent, CUnitQueue* uq, const std::string& confstr)
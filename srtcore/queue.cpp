@@ -53,6 +53,9 @@ modified by
 #include "platform_sys.h"
 
 #include <cstring>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 
 #include "common.h"
 #include "api.h"
@@ -65,59 +68,79 @@ using namespace std;
 using namespace srt::sync;
 using namespace srt_logging;
 
-srt::CUnitQueue::CUnitQueue(int initNumUnits, int mss)
-    : m_iNumTaken(0)
+srt::CUnitQueue::CUnitQueue(int initNumUnits, int mss, int headroom)
+    : m_pSlabs(NULL)
+    , m_iNumSlabs(0)
+    , m_uFreeHead(0)
+    , m_iSize(0)
+    , m_iNumTaken(0)
+    , m_iMaxTaken(0)
     , m_iMSS(mss)
-    , m_iBlockSize(initNumUnits)
+    , m_iHeadroom(headroom)
+    , m_iFirstSlabSize(initNumUnits)
+    , m_iBlockSize(std::min(initNumUnits, (int)MAX_GROW_UNITS))
 {
-    CQEntry* tempq = allocateEntry(m_iBlockSize, m_iMSS);
-
-    if (tempq == NULL)
-        throw CUDTException(MJ_SYSTEMRES, MN_MEMORY);
+    for (int i = 0; i < SLAB_DIR_PAGES; ++i)
+        m_aSlabDir[i] = NULL;
 
-    m_pQEntry = m_pCurrQueue = m_pLastQueue = tempq;
-    m_pQEntry->m_pNext = m_pQEntry;
+    CSlab* slab = allocateSlab(initNumUnits, m_iMSS, m_iHeadroom);
 
-    m_pAvailUnit = m_pCurrQueue->m_pUnit;
+    if (slab == NULL)
+        throw CUDTException(MJ_SYSTEMRES, MN_MEMORY);
 
-    m_iSize = m_iBlockSize;
+    addSlab_(slab);
 }
 
 srt::CUnitQueue::~CUnitQueue()
 {
-    CQEntry* p = m_pQEntry;
-
-    while (p != NULL)
+    while (m_pSlabs)
     {
-        delete[] p->m_pUnit;
-        delete[] p->m_pBuffer;
-
-        CQEntry* q = p;
-        if (p == m_pLastQueue)
-            p = NULL;
-        else
-            p = p->m_pNext;
-        delete q;
+        CSlab* next = m_pSlabs->m_pNext;
+        releaseSlab(m_pSlabs);
+        m_pSlabs = next;
     }
+
+    for (int i = 0; i < SLAB_DIR_PAGES; ++i)
+        delete[] m_aSlabDir[i];
 }
 
-srt::CUnitQueue::CQEntry* srt::CUnitQueue::allocateEntry(const int iNumUnits, const int mss)
+srt::CUnitQueue::CSlab* srt::CUnitQueue::allocateSlab(const int iNumUnits, const int mss, const int headroom)
 {
-    CQEntry* tempq = NULL;
-    CUnit* tempu   = NULL;
-    char* tempb    = NULL;
+    CSlab* slab = NULL;
+    CUnit* units = NULL;
+    char*  buf   = NULL;
+    bool   mapped = false;
+    const size_t unitsize = size_t(headroom) + mss;
+    const size_t bufsize  = size_t(iNumUnits) * unitsize;
 
     try
     {
-        tempq = new CQEntry;
-        tempu = new CUnit[iNumUnits];
-        tempb = new char[iNumUnits * mss];
+        slab  = new CSlab;
+        units = new CUnit[iNumUnits];
+
+#if defined(MAP_ANONYMOUS)
+        // A buffer spanning huge pages gets its own mapping, so that it can be
+        // backed by them; the pages are allocated at the first touch.
+        if (bufsize >= HUGE_PAGE_SIZE)
+        {
+            void* p = mmap(NULL, bufsize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p != MAP_FAILED)
+            {
+#if defined(MADV_HUGEPAGE)
+                madvise(p, bufsize, MADV_HUGEPAGE);
+#endif
+                buf    = static_cast<char*>(p);
+                mapped = true;
+            }
+        }
+#endif
+        if (!buf)
+            buf = new char[bufsize];
     }
     catch (...)
     {
-        delete tempq;
-        delete[] tempu;
-        delete[] tempb;
+        delete slab;
+        delete[] units;
 
         LOGC(rslog.Error, log << "CUnitQueue: failed to allocate " << iNumUnits << " units.");
         return NULL;
@@ -125,15 +148,46 @@ srt::CUnitQueue::CQEntry* srt::CUnitQueue::allocateEntry(const int iNumUnits, co
 
     for (int i = 0; i < iNumUnits; ++i)
     {
-        tempu[i].m_bTaken = false;
-        tempu[i].m_Packet.m_pcData = tempb + i * mss;
+        units[i].m_iFlags = 0;
+        units[i].m_uIndex = 0;
+        units[i].m_uNextFree = 0;
+        units[i].m_Packet.m_pcData = buf + size_t(i) * unitsize + headroom;
     }
 
-    tempq->m_pUnit   = tempu;
-    tempq->m_pBuffer = tempb;
-    tempq->m_iSize   = iNumUnits;
+    slab->m_pUnit       = units;
+    slab->m_pBuffer     = buf;
+    slab->m_zBufferSize = bufsize;
+    slab->m_bMapped     = mapped;
+    slab->m_iSize       = iNumUnits;
+    slab->m_pNext       = NULL;
+
+    return slab;
+}
+
+void srt::CUnitQueue::releaseSlab(CSlab* slab)
+{
+    delete[] slab->m_pUnit;
+#if defined(MAP_ANONYMOUS)
+    if (slab->m_bMapped)
+        munmap(slab->m_pBuffer, slab->m_zBufferSize);
+    else
+#endif
+        delete[] slab->m_pBuffer;
+    delete slab;
+}
+
+void srt::CUnitQueue::prefault()
+{
+    static const size_t PAGE_SIZE = 4096;
 
-    return tempq;
+    ScopedLock lk(m_FreeLock);
+    for (CSlab* slab = m_pSlabs; slab; slab = slab->m_pNext)
+    {
+        // The buffers of the units are not in use yet, or written only by the receiving thread.
+        volatile char* b = slab->m_pBuffer;
+        for (size_t off = 0; off < slab->m_zBufferSize; off += PAGE_SIZE)
+            b[off] = b[off];
+    }
 }
 
 int srt::CUnitQueue::increase_()
@@ -141,66 +195,192 @@ int srt::CUnitQueue::increase_()
     const int numUnits = m_iBlockSize;
     HLOGC(qrlog.Debug, log << "CUnitQueue::increase: Capacity" << capacity() << " + " << numUnits << " new units, " << m_iNumTaken << " in use.");
 
-    CQEntry* tempq = allocateEntry(numUnits, m_iMSS);
-    if (tempq == NULL)
+    CSlab* slab = allocateSlab(numUnits, m_iMSS, m_iHeadroom);
+    if (slab == NULL)
         return -1;
 
-    m_pLastQueue->m_pNext = tempq;
-    m_pLastQueue          = tempq;
-    m_pLastQueue->m_pNext = m_pQEntry;
-
-    m_iSize += numUnits;
+    if (!addSlab_(slab))
+    {
+        LOGC(qrlog.Error, log << "CUnitQueue: Capacity" << capacity() << " can not grow any further.");
+        releaseSlab(slab);
+        return -1;
+    }
 
     return 0;
 }
 
-srt::CUnit* srt::CUnitQueue::getNextAvailUnit()
+bool srt::CUnitQueue::addSlab_(CSlab* slab)
 {
-    const int iNumUnitsTotal = capacity();
-    if (m_iNumTaken * 10 > iNumUnitsTotal * 9) // 90% or more are in use.
-        increase_();
+    const int page = m_iNumSlabs / SLAB_DIR_PAGE_SIZE;
+    if (page >= SLAB_DIR_PAGES)
+        return false;
 
-    if (m_iNumTaken >= capacity())
+    if (!m_aSlabDir[page])
+        m_aSlabDir[page] = new CSlab*[SLAB_DIR_PAGE_SIZE];
+
+    // The units are found by position only once pushed, which publishes the directory entry.
+    m_aSlabDir[page][m_iNumSlabs % SLAB_DIR_PAGE_SIZE] = slab;
+    ++m_iNumSlabs;
+
+    slab->m_pNext = m_pSlabs;
+    m_pSlabs      = slab;
+
+    const int size = m_iSize;
+    for (int i = 0; i < slab->m_iSize; ++i)
+        slab->m_pUnit[i].m_uIndex = uint32_t(size + i);
+
+    for (int i = slab->m_iSize - 1; i >= 0; --i)
     {
-        LOGC(qrlog.Error, log << "CUnitQueue: No free units to take. Capacity" << capacity() << ".");
-        return NULL;
+        slab->m_pUnit[i].m_iFlags = CUnit::LISTED;
+        pushFree(&slab->m_pUnit[i]);
+    }
+
+    m_iSize = size + slab->m_iSize;
+    return true;
+}
+
+srt::CUnit* srt::CUnitQueue::unitAt(uint32_t index) const
+{
+    // The first slab has m_iFirstSlabSize units, the next ones m_iBlockSize.
+    int slab = 0;
+    if (index >= uint32_t(m_iFirstSlabSize))
+    {
+        index -= m_iFirstSlabSize;
+        slab  = 1 + index / m_iBlockSize;
+        index = index % m_iBlockSize;
+    }
+    return &m_aSlabDir[slab / SLAB_DIR_PAGE_SIZE][slab % SLAB_DIR_PAGE_SIZE]->m_pUnit[index];
+}
+
+void srt::CUnitQueue::pushFree(CUnit* unit)
+{
+    // The most recently released units are reused first, as they are likely in the cache.
+    const uint64_t unitpos = unit->m_uIndex + 1;
+    for (;;)
+    {
+        const uint64_t head = m_uFreeHead.load();
+        unit->m_uNextFree = uint32_t(head & FREE_INDEX_MASK);
+        if (m_uFreeHead.compare_exchange(head, ((head & ~FREE_INDEX_MASK) + FREE_TAG_ONE) | unitpos))
+            return;
     }
+}
 
-    int units_checked = 0;
-    do
+srt::CUnit* srt::CUnitQueue::popFree()
+{
+    for (;;)
     {
-        const CUnit* end = m_pCurrQueue->m_pUnit + m_pCurrQueue->m_iSize;
-        for (; m_pAvailUnit != end; ++m_pAvailUnit, ++units_checked)
+        const uint64_t head    = m_uFreeHead.load();
+        const uint32_t unitpos = uint32_t(head & FREE_INDEX_MASK);
+        if (unitpos == 0)
+            return NULL;
+
+        // If the unit was popped meanwhile, m_uNextFree may be outdated, but then the tag has changed.
+        CUnit* unit = unitAt(unitpos - 1);
+        const uint64_t next = ((head & ~FREE_INDEX_MASK) + FREE_TAG_ONE) | unit->m_uNextFree.load();
+        if (!m_uFreeHead.compare_exchange(head, next))
+            continue;
+
+        // Off the list now. A unit taken while on it is dropped, makeUnitFree() pushes it back.
+        for (;;)
         {
-            if (!m_pAvailUnit->m_bTaken)
+            const int flags = unit->m_iFlags.load();
+            SRT_ASSERT((flags & (CUnit::LISTED | CUnit::RESERVED)) == CUnit::LISTED);
+            const int newflags = (flags & CUnit::TAKEN) ? (flags & ~CUnit::LISTED) : CUnit::RESERVED;
+            if (unit->m_iFlags.compare_exchange(flags, newflags))
             {
-                return m_pAvailUnit;
+                if (newflags == CUnit::RESERVED)
+                    return unit;
+                break;
             }
         }
+    }
+}
 
-        m_pCurrQueue = m_pCurrQueue->m_pNext;
-        m_pAvailUnit = m_pCurrQueue->m_pUnit;
-    } while (units_checked < m_iSize);
+void srt::CUnitQueue::grow()
+{
+    if (m_iNumTaken * 10 <= capacity() * 9 && (m_uFreeHead.load() & FREE_INDEX_MASK) != 0)
+        return;
 
-    return NULL;
+    ScopedLock lk(m_FreeLock);
+    // Another thread might have grown the queue meanwhile.
+    if (m_iNumTaken * 10 > capacity() * 9 || (m_uFreeHead.load() & FREE_INDEX_MASK) == 0) // 90% or more are in use, or all are reserved.
+        increase_();
 }
 
-void srt::CUnitQueue::makeUnitFree(CUnit* unit)
+srt::CUnit* srt::CUnitQueue::getNextAvailUnit()
+{
+    // The released unit is back on top of the free list, so it is found again.
+    CUnit* u = reserveNextAvailUnit();
+    if (u)
+        releaseUnit(u);
+    return u;
+}
+
+srt::CUnit* srt::CUnitQueue::reserveNextAvailUnit()
+{
+    grow();
+    CUnit* u = popFree();
+    if (!u)
+    {
+        // Emptied by the other threads since grow().
+        grow();
+        u = popFree();
+    }
+
+    if (!u)
+        LOGC(qrlog.Error, log << "CUnitQueue: No free units to take. Capacity" << capacity() << ".");
+
+    return u;
+}
+
+void srt::CUnitQueue::releaseUnit(CUnit* unit)
 {
     SRT_ASSERT(unit != NULL);
-    SRT_ASSERT(unit->m_bTaken);
-    unit->m_bTaken.store(false);
+    for (;;)
+    {
+        const int flags = unit->m_iFlags.load();
+        SRT_ASSERT((flags & (CUnit::RESERVED | CUnit::LISTED)) == CUnit::RESERVED);
+        const int newflags = (flags & CUnit::TAKEN) ? CUnit::TAKEN : CUnit::LISTED;
+        if (unit->m_iFlags.compare_exchange(flags, newflags))
+        {
+            if (newflags == CUnit::LISTED)
+                pushFree(unit);
+            return;
+        }
+    }
+}
 
-    --m_iNumTaken;
+void srt::CUnitQueue::makeUnitFree(CUnit* unit)
+{
+    SRT_ASSERT(unit != NULL);
+    for (;;)
+    {
+        const int flags = unit->m_iFlags.load();
+        SRT_ASSERT(flags & CUnit::TAKEN);
+        // Still reserved or on the free list, the unit is pushed by releaseUnit() or remains there.
+        const int newflags = (flags & (CUnit::RESERVED | CUnit::LISTED)) ? (flags & ~CUnit::TAKEN) : CUnit::LISTED;
+        if (unit->m_iFlags.compare_exchange(flags, newflags))
+        {
+            --m_iNumTaken;
+            if (newflags == CUnit::LISTED)
+                pushFree(unit);
+            return;
+        }
+    }
 }
 
 void srt::CUnitQueue::makeUnitTaken(CUnit* unit)
 {
-    ++m_iNumTaken;
-
     SRT_ASSERT(unit != NULL);
-    SRT_ASSERT(!unit->m_bTaken);
-    unit->m_bTaken.store(true);
+    SRT_ASSERT(!unit->isTaken());
+    unit->m_iFlags |= CUnit::TAKEN;
+
+    const int taken = ++m_iNumTaken;
+    for (int maxtaken = m_iMaxTaken; taken > maxtaken; maxtaken = m_iMaxTaken)
+    {
+        if (m_iMaxTaken.compare_exchange(maxtaken, taken))
+            break;
+    }
 }
 
 srt::CSndUList::CSndUList(sync::CTimer* pTimer)
@@ -406,9 +586,8 @@ void srt::CSndUList::remove_(const CUDT* u)
 
 //
 srt::CSndQueue::CSndQueue()
-    : m_pSndUList(NULL)
-    , m_pChannel(NULL)
-    , m_pTimer(NULL)
+    : m_pChannel(NULL)
+    , m_iBatchSize(1)
     , m_bClosing(false)
 {
 }
@@ -417,21 +596,9 @@ srt::CSndQueue::~CSndQueue()
 {
     m_bClosing = true;
 
-    if (m_pTimer != NULL)
-    {
-        m_pTimer->interrupt();
-    }
-
-    // Unblock CSndQueue worker thread if it is waiting.
-    m_pSndUList->signalInterrupt();
-
-    if (m_WorkerThread.joinable())
-    {
-        HLOGC(rslog.Debug, log << "SndQueue: EXIT");
-        m_WorkerThread.join();
-    }
-
-    delete m_pSndUList;
+    // Each shard interrupts and joins its worker thread.
+    for (size_t i = 0; i < m_vShards.size(); ++i)
+        delete m_vShards[i];
 }
 
 int srt::CSndQueue::ioctlQuery(int type) const
@@ -447,21 +614,37 @@ int srt::CSndQueue::sockoptQuery(int level, int type) const
 int srt::CSndQueue::m_counter = 0;
 #endif
 
-void srt::CSndQueue::init(CChannel* c, CTimer* t)
+void srt::CSndQueue::init(CChannel* c, CTimer* t, const CSrtMuxerConfig& mcfg)
 {
-    m_pChannel  = c;
-    m_pTimer    = t;
-    m_pSndUList = new CSndUList(t);
+    m_pChannel = c;
+
+#ifdef SRT_ENABLE_MMSG
+    m_iBatchSize = std::max(1, std::min(mcfg.iUDPSndBatch, (int)CSrtMuxerConfig::MAX_UDP_BATCH));
+#else
+    // Collecting packets makes no sense without a batched system call.
+    m_iBatchSize = 1;
+#endif
 
 #if ENABLE_LOGGING
     ++m_counter;
     const std::string thrname = "SRT:SndQ:w" + Sprint(m_counter);
-    const char*       thname  = thrname.c_str();
 #else
-    const char* thname = "SRT:SndQ";
+    const std::string thrname = "SRT:SndQ";
 #endif
-    if (!StartThread(m_WorkerThread, CSndQueue::worker, this, thname))
-        throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+
+    // The first worker uses the timer of the multiplexer, which is
+    // also ticked by the receiver queue; the others have their own.
+    const int nshards = std::max(1, std::min(mcfg.iSndWorkers, (int)CSrtMuxerConfig::MAX_QUEUE_WORKERS));
+    for (int i = 0; i < nshards; ++i)
+    {
+        m_vShards.push_back(new CSndQueueShard(this, i == 0 ? t : NULL));
+        m_vShards.back()->start(nshards == 1 ? thrname : thrname + "." + Sprint(i));
+    }
+}
+
+srt::CSndUList* srt::CSndQueue::listOf(const CUDT* u) const
+{
+    return m_vShards[u->m_SocketID % m_vShards.size()]->m_pSndUList;
 }
 
 int srt::CSndQueue::getIpTTL() const
@@ -481,8 +664,43 @@ bool srt::CSndQueue::getBind(char* dst, size_t len) const
 }
 #endif
 
+srt::CSndQueueShard::CSndQueueShard(CSndQueue* parent, CTimer* t)
+    : m_pParent(parent)
+    , m_pTimer(t ? t : &m_OwnTimer)
+    , m_pSndUList(new CSndUList(m_pTimer))
+    , m_iBatchFill(0)
+{
+    if (m_pParent->m_iBatchSize > 1)
+    {
+        m_BatchStorage.resize(m_pParent->m_iBatchSize * (CPacket::HDR_SIZE + CPacket::SRT_MAX_PAYLOAD_SIZE));
+        m_vBatchSlots.resize(m_pParent->m_iBatchSize);
+    }
+}
+
+srt::CSndQueueShard::~CSndQueueShard()
+{
+    m_pTimer->interrupt();
+
+    // Unblock the worker thread if it is waiting.
+    m_pSndUList->signalInterrupt();
+
+    if (m_WorkerThread.joinable())
+    {
+        HLOGC(rslog.Debug, log << "SndQueue: EXIT");
+        m_WorkerThread.join();
+    }
+
+    delete m_pSndUList;
+}
+
+void srt::CSndQueueShard::start(const std::string& thname)
+{
+    if (!StartThread(m_WorkerThread, CSndQueueShard::worker, this, thname.c_str()))
+        throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+}
+
 #if defined(SRT_DEBUG_SNDQ_HIGHRATE)
-static void CSndQueueDebugHighratePrint(const srt::CSndQueue* self, const steady_clock::time_point currtime)
+static void CSndQueueDebugHighratePrint(const srt::CSndQueueShard* self, const steady_clock::time_point currtime)
 {
     if (self->m_DbgTime <= currtime)
     {
@@ -500,12 +718,13 @@ static void CSndQueueDebugHighratePrint(const srt::CSndQueue* self, const steady
 }
 #endif
 
-void* srt::CSndQueue::worker(void* param)
+void* srt::CSndQueueShard::worker(void* param)
 {
-    CSndQueue* self = (CSndQueue*)param;
+    CSndQueueShard* self = (CSndQueueShard*)param;
+    const CSndQueue* queue = self->m_pParent;
 
 #if ENABLE_LOGGING
-    THREAD_STATE_INIT(("SRT:SndQ:w" + Sprint(m_counter)).c_str());
+    THREAD_STATE_INIT(("SRT:SndQ:w" + Sprint(CSndQueue::m_counter)).c_str());
 #else
     THREAD_STATE_INIT("SRT:SndQ:worker");
 #endif
@@ -519,12 +738,16 @@ void* srt::CSndQueue::worker(void* param)
 #define IF_DEBUG_HIGHRATE(statement) (void)0
 #endif /* SRT_DEBUG_SNDQ_HIGHRATE */
 
-    while (!self->m_bClosing)
+    while (!queue->m_bClosing)
     {
         const steady_clock::time_point next_time = self->m_pSndUList->getNextProcTime();
 
         INCREMENT_THREAD_ITERATIONS();
 
+        // Send out the collected packets if no other one is due within the time slice.
+        if (self->m_iBatchFill > 0 && (is_zero(next_time) || next_time > self->m_tsBatchDeadline))
+            self->worker_FlushBatch();
+
         IF_DEBUG_HIGHRATE(self->m_WorkerStats.lIteration++);
 
         if (is_zero(next_time))
@@ -533,7 +756,7 @@ void* srt::CSndQueue::worker(void* param)
 
             // wait here if there is no sockets with data to be sent
             THREAD_PAUSED();
-            if (!self->m_bClosing)
+            if (!queue->m_bClosing)
             {
                 self->m_pSndUList->waitNonEmpty();
                 IF_DEBUG_HIGHRATE(self->m_WorkerStats.lCondWait++);
@@ -593,16 +816,62 @@ void* srt::CSndQueue::worker(void* param)
         if (!is_zero(next_send_time))
             self->m_pSndUList->update(u, CSndUList::DO_RESCHEDULE, next_send_time);
 
+        if (queue->m_iBatchSize > 1 && pkt.getLength() <= CPacket::SRT_MAX_PAYLOAD_SIZE)
+        {
+            HLOGC(qslog.Debug, log << self->CONID() << "chn:BATCHING: " << pkt.Info());
+            self->worker_QueueBatch(addr, pkt, source_addr);
+            continue;
+        }
+
+        // Keep the order of packets, if a batch is pending.
+        if (self->m_iBatchFill > 0)
+            self->worker_FlushBatch();
+
         HLOGC(qslog.Debug, log << self->CONID() << "chn:SENDING: " << pkt.Info());
-        self->m_pChannel->sendto(addr, pkt, source_addr);
+        queue->m_pChannel->sendto(addr, pkt, source_addr);
 
         IF_DEBUG_HIGHRATE(self->m_WorkerStats.lSendTo++);
     }
 
+    if (self->m_iBatchFill > 0)
+        self->worker_FlushBatch();
+
     THREAD_EXIT();
     return NULL;
 }
 
+void srt::CSndQueueShard::worker_QueueBatch(const sockaddr_any& addr, CPacket& w_pkt, const sockaddr_any& src)
+{
+    if (m_iBatchFill == 0)
+        m_tsBatchDeadline = steady_clock::now() + microseconds_from(SEND_BATCH_SLICE_US);
+
+    const size_t slot_size = CPacket::HDR_SIZE + CPacket::SRT_MAX_PAYLOAD_SIZE;
+    char*        buf       = &m_BatchStorage[m_iBatchFill * slot_size];
+
+    // Converted to the network order in place, as CChannel::sendto() does.
+    w_pkt.toNL();
+    memcpy(buf, w_pkt.getHeader(), CPacket::HDR_SIZE);
+    memcpy(buf + CPacket::HDR_SIZE, w_pkt.data(), w_pkt.getLength());
+    w_pkt.toHL();
+
+    CSendSlot& slot = m_vBatchSlots[m_iBatchFill];
+    slot.addr       = addr;
+    slot.source     = src;
+    slot.data       = buf;
+    slot.size       = CPacket::HDR_SIZE + w_pkt.getLength();
+
+    if (++m_iBatchFill == m_pParent->m_iBatchSize)
+        worker_FlushBatch();
+}
+
+void srt::CSndQueueShard::worker_FlushBatch()
+{
+    HLOGC(qslog.Debug, log << CONID() << "chn:SENDING batch of " << m_iBatchFill << " packets");
+    m_pParent->m_pChannel->sendto_batch(&m_vBatchSlots[0], m_iBatchFill, (m_BatchBuffers));
+    IF_DEBUG_HIGHRATE(m_WorkerStats.lSendTo += m_iBatchFill);
+    m_iBatchFill = 0;
+}
+
 int srt::CSndQueue::sendto(const sockaddr_any& addr, CPacket& w_packet, const sockaddr_any& src)
 {
     // send out the packet immediately (high priority), this is a control packet
@@ -614,190 +883,342 @@ int srt::CSndQueue::sendto(const sockaddr_any& addr, CPacket& w_packet, const so
 }
 
 //
-srt::CRcvUList::CRcvUList()
-    : m_pUList(NULL)
-    , m_pLast(NULL)
+srt::CTimerWheel::CTimerWheel()
+    : m_tsBase(steady_clock::now())
+    , m_llCurrent(0)
+    , m_iSize(0)
 {
+    for (int i = 0; i < NUM_SLOTS; ++i)
+        m_aSlots[i] = NULL;
 }
 
-srt::CRcvUList::~CRcvUList() {}
-
-void srt::CRcvUList::insert(const CUDT* u)
+void srt::CTimerWheel::schedule(CRNode* n, const steady_clock::time_point& deadline)
 {
-    CRNode* n        = u->m_pRNode;
-    n->m_tsTimeStamp = steady_clock::now();
-
-    if (NULL == m_pUList)
+    if (n->m_iSlot != -1)
     {
-        // empty list, insert as the single node
-        n->m_pPrev = n->m_pNext = NULL;
-        m_pLast = m_pUList = n;
-
-        return;
+        unlink_(n);
+        --m_iSize;
     }
 
-    // always insert at the end for RcvUList
-    n->m_pPrev       = m_pLast;
-    n->m_pNext       = NULL;
-    m_pLast->m_pNext = n;
-    m_pLast          = n;
+    // Round up, so that the socket isn't checked before the deadline,
+    // and not earlier than the next tick, which is not processed yet.
+    const int64_t us = count_microseconds(deadline - m_tsBase);
+    n->m_llTick      = std::max((us + TICK_US - 1) / TICK_US, m_llCurrent + 1);
+
+    link_(n);
+    ++m_iSize;
 }
 
-void srt::CRcvUList::remove(const CUDT* u)
+void srt::CTimerWheel::remove(CRNode* n)
 {
-    CRNode* n = u->m_pRNode;
-
-    if (!n->m_bOnList)
+    if (n->m_iSlot == -1)
         return;
 
-    if (NULL == n->m_pPrev)
+    unlink_(n);
+    --m_iSize;
+}
+
+void srt::CTimerWheel::collectDue(const steady_clock::time_point& currtime, std::vector<CRNode*>& w_due)
+{
+    const int64_t target = count_microseconds(currtime - m_tsBase) / TICK_US;
+    if (m_iSize == 0)
     {
-        // n is the first node
-        m_pUList = n->m_pNext;
-        if (NULL == m_pUList)
-            m_pLast = NULL;
-        else
-            m_pUList->m_pPrev = NULL;
+        m_llCurrent = std::max(m_llCurrent, target);
+        return;
     }
-    else
+
+    while (m_llCurrent < target)
     {
-        n->m_pPrev->m_pNext = n->m_pNext;
-        if (NULL == n->m_pNext)
+        ++m_llCurrent;
+        if ((m_llCurrent & (L0_SLOTS - 1)) == 0)
         {
-            // n is the last node
-            m_pLast = n->m_pPrev;
+            // Entering the next level 1 slot: move its sockets to level 0,
+            // and first, if entering the next round of level 1, the overflow ones.
+            const int64_t l1 = m_llCurrent >> L0_BITS;
+            if ((l1 & (L1_SLOTS - 1)) == 0)
+                cascade_(OVERFLOW_SLOT);
+            cascade_(L0_SLOTS + int(l1 & (L1_SLOTS - 1)));
         }
-        else
-            n->m_pNext->m_pPrev = n->m_pPrev;
-    }
 
-    n->m_pNext = n->m_pPrev = NULL;
+        CRNode*& slot = m_aSlots[m_llCurrent & (L0_SLOTS - 1)];
+        while (slot)
+        {
+            CRNode* n = slot;
+            unlink_(n);
+            --m_iSize;
+            w_due.push_back(n);
+        }
+
+        if (m_iSize == 0)
+        {
+            m_llCurrent = target;
+            break;
+        }
+    }
 }
 
-void srt::CRcvUList::update(const CUDT* u)
+steady_clock::time_point srt::CTimerWheel::nextDeadline() const
 {
-    CRNode* n = u->m_pRNode;
-
-    if (!n->m_bOnList)
-        return;
-
-    n->m_tsTimeStamp = steady_clock::now();
+    if (m_iSize == 0)
+        return steady_clock::time_point();
 
-    // if n is the last node, do not need to change
-    if (NULL == n->m_pNext)
-        return;
+    // Level 0 contains only the ticks until the end of the current level 1 slot.
+    const int64_t l0_end = m_llCurrent | (L0_SLOTS - 1);
+    for (int64_t t = m_llCurrent + 1; t <= l0_end; ++t)
+    {
+        if (m_aSlots[t & (L0_SLOTS - 1)])
+            return timeOf(t);
+    }
 
-    if (NULL == n->m_pPrev)
+    // The sockets in level 1 (and overflow) are due not earlier than their slot begins.
+    const int64_t l1 = m_llCurrent >> L0_BITS;
+    for (int64_t i = l1 + 1; i < l1 + L1_SLOTS; ++i)
     {
-        m_pUList          = n->m_pNext;
-        m_pUList->m_pPrev = NULL;
+        if (m_aSlots[L0_SLOTS + (i & (L1_SLOTS - 1))])
+            return timeOf(i << L0_BITS);
+        if ((i & (L1_SLOTS - 1)) == 0 && m_aSlots[OVERFLOW_SLOT])
+            return timeOf(i << L0_BITS);
     }
+    return timeOf((l1 + L1_SLOTS) << L0_BITS);
+}
+
+void srt::CTimerWheel::link_(CRNode* n)
+{
+    const int64_t l1     = n->m_llTick >> L0_BITS;
+    const int64_t cur_l1 = m_llCurrent >> L0_BITS;
+
+    if (l1 == cur_l1)
+        n->m_iSlot = int(n->m_llTick & (L0_SLOTS - 1));
+    else if (l1 - cur_l1 < L1_SLOTS)
+        n->m_iSlot = L0_SLOTS + int(l1 & (L1_SLOTS - 1));
     else
-    {
+        n->m_iSlot = OVERFLOW_SLOT;
+
+    CRNode*& head = m_aSlots[n->m_iSlot];
+    n->m_pPrev    = NULL;
+    n->m_pNext    = head;
+    if (head)
+        head->m_pPrev = n;
+    head = n;
+}
+
+void srt::CTimerWheel::unlink_(CRNode* n)
+{
+    if (n->m_pPrev)
         n->m_pPrev->m_pNext = n->m_pNext;
+    else
+        m_aSlots[n->m_iSlot] = n->m_pNext;
+
+    if (n->m_pNext)
         n->m_pNext->m_pPrev = n->m_pPrev;
+
+    n->m_pNext = n->m_pPrev = NULL;
+    n->m_iSlot = -1;
+}
+
+void srt::CTimerWheel::cascade_(int slot)
+{
+    CRNode* n      = m_aSlots[slot];
+    m_aSlots[slot] = NULL;
+    while (n)
+    {
+        CRNode* next = n->m_pNext;
+        link_(n);
+        n = next;
     }
+}
 
-    n->m_pPrev       = m_pLast;
-    n->m_pNext       = NULL;
-    m_pLast->m_pNext = n;
-    m_pLast          = n;
+steady_clock::time_point srt::CTimerWheel::timeOf(int64_t tick) const
+{
+    return m_tsBase + microseconds_from(tick * TICK_US);
 }
 
-//
 srt::CHash::CHash()
-    : m_pBucket(NULL)
-    , m_iHashSize(0)
+    : m_pTable(NULL)
+    , m_iReaders(0)
+    , m_iSize(0)
+    , m_iRemoved(0)
 {
 }
 
 srt::CHash::~CHash()
 {
-    for (int i = 0; i < m_iHashSize; ++i)
-    {
-        CBucket* b = m_pBucket[i];
-        while (NULL != b)
-        {
-            CBucket* n = b->m_pNext;
-            delete b;
-            b = n;
-        }
-    }
+    deleteTable(m_pTable);
+    for (size_t i = 0; i < m_vRetired.size(); ++i)
+        deleteTable(m_vRetired[i]);
+}
 
-    delete[] m_pBucket;
+srt::CHash::CTable* srt::CHash::createTable(size_t nslots)
+{
+    CTable* t   = new CTable;
+    t->m_pSlots = new CSlot[nslots];
+    t->m_zMask  = nslots - 1;
+    return t;
 }
 
-void srt::CHash::init(int size)
+void srt::CHash::deleteTable(CTable* t)
 {
-    m_pBucket = new CBucket*[size];
+    if (!t)
+        return;
+    delete[] t->m_pSlots;
+    delete t;
+}
 
-    for (int i = 0; i < size; ++i)
-        m_pBucket[i] = NULL;
+void srt::CHash::init(int size)
+{
+    // Keep the load factor at most 1/2 for short probe sequences.
+    size_t nslots = 16;
+    while (nslots < size_t(size) * 2)
+        nslots *= 2;
 
-    m_iHashSize = size;
+    m_pTable = createTable(nslots);
 }
 
-srt::CUDT* srt::CHash::lookup(int32_t id)
+srt::CUDT* srt::CHash::find_(const CTable* t, int32_t id)
 {
-    // simple hash function (% hash table size); suitable for socket descriptors
-    CBucket* b = m_pBucket[id % m_iHashSize];
-
-    while (NULL != b)
+    for (size_t i = slotOf(id, t->m_zMask);; i = (i + 1) & t->m_zMask)
     {
-        if (id == b->m_iID)
-            return b->m_pUDT;
-        b = b->m_pNext;
-    }
+        const CSlot&  slot    = t->m_pSlots[i];
+        const int32_t slot_id = slot.m_iID;
+        if (slot_id == EMPTY_ID)
+            return NULL;
 
-    return NULL;
+        if (slot_id == id)
+        {
+            // Check that the slot wasn't reused for another socket in the meantime.
+            CUDT* u = slot.m_pUDT;
+            return slot.m_iID == id ? u : NULL;
+        }
+    }
 }
 
-void srt::CHash::insert(int32_t id, CUDT* u)
+srt::CUDT* srt::CHash::lookupShared(int32_t id) const
 {
-    CBucket* b = m_pBucket[id % m_iHashSize];
-
-    CBucket* n = new CBucket;
-    n->m_iID   = id;
-    n->m_pUDT  = u;
-    n->m_pNext = b;
-
-    m_pBucket[id % m_iHashSize] = n;
+    // The table can't be freed as long as m_iReaders isn't 0.
+    ++m_iReaders;
+    CUDT* u = find_(m_pTable, id);
+    --m_iReaders;
+    return u;
 }
 
-void srt::CHash::remove(int32_t id)
+void srt::CHash::insert(int32_t id, CUDT* u)
 {
-    CBucket* b = m_pBucket[id % m_iHashSize];
-    CBucket* p = NULL;
+    SRT_ASSERT(id > 0);
 
-    while (NULL != b)
+    CTable* t = m_pTable;
+    if (size_t(m_iSize + m_iRemoved + 1) * 4 > (t->m_zMask + 1) * 3)
     {
-        if (id == b->m_iID)
-        {
-            if (NULL == p)
-                m_pBucket[id % m_iHashSize] = b->m_pNext;
-            else
-                p->m_pNext = b->m_pNext;
-
-            delete b;
+        rehash_(m_iSize + 1);
+        t = m_pTable;
+    }
 
+    CSlot* target = NULL;
+    for (size_t i = slotOf(id, t->m_zMask);; i = (i + 1) & t->m_zMask)
+    {
+        CSlot&        slot    = t->m_pSlots[i];
+        const int32_t slot_id = slot.m_iID;
+        if (slot_id == id)
+        {
+            slot.m_pUDT = u;
             return;
         }
 
-        p = b;
-        b = b->m_pNext;
+        if (slot_id == REMOVED_ID && !target)
+            target = &slot;
+
+        if (slot_id == EMPTY_ID)
+        {
+            if (!target)
+                target = &slot;
+            break;
+        }
     }
-}
 
-//
-srt::CRendezvousQueue::CRendezvousQueue()
-    : m_lRendezvousID()
-    , m_RIDListLock()
-{
-}
+    if (target->m_iID == REMOVED_ID)
+        --m_iRemoved;
 
-srt::CRendezvousQueue::~CRendezvousQueue()
-{
-    m_lRendezvousID.clear();
+    // The ID is set last, so that lookup() doesn't find it before the socket.
+    target->m_pUDT = u;
+    target->m_iID  = id;
+    ++m_iSize;
+}
+
+void srt::CHash::remove(int32_t id)
+{
+    CTable* t = m_pTable;
+    for (size_t i = slotOf(id, t->m_zMask);; i = (i + 1) & t->m_zMask)
+    {
+        CSlot&        slot    = t->m_pSlots[i];
+        const int32_t slot_id = slot.m_iID;
+        if (slot_id == EMPTY_ID)
+            break;
+
+        if (slot_id == id)
+        {
+            // The slot stays occupied, so that the probe sequences of other entries aren't broken.
+            slot.m_pUDT = NULL;
+            slot.m_iID  = REMOVED_ID;
+            --m_iSize;
+            ++m_iRemoved;
+            break;
+        }
+    }
+
+    reclaim_();
+}
+
+void srt::CHash::rehash_(int count)
+{
+    const CTable* oldt = m_pTable;
+
+    size_t nslots = oldt->m_zMask + 1;
+    while (nslots < size_t(count) * 2)
+        nslots *= 2;
+
+    CTable* t = createTable(nslots);
+    for (size_t i = 0; i <= oldt->m_zMask; ++i)
+    {
+        const CSlot&  old    = oldt->m_pSlots[i];
+        const int32_t old_id = old.m_iID;
+        if (old_id == EMPTY_ID || old_id == REMOVED_ID)
+            continue;
+
+        size_t n = slotOf(old_id, t->m_zMask);
+        while (t->m_pSlots[n].m_iID != EMPTY_ID)
+            n = (n + 1) & t->m_zMask;
+
+        t->m_pSlots[n].m_pUDT = old.m_pUDT.load();
+        t->m_pSlots[n].m_iID  = old_id;
+    }
+
+    HLOGC(qrlog.Debug, log << "CHash: rehashed " << m_iSize << " entries into " << nslots << " slots");
+    m_vRetired.push_back(m_pTable.exchange(t));
+    m_iRemoved = 0;
+
+    reclaim_();
+}
+
+void srt::CHash::reclaim_()
+{
+    // A lookup started after the table was replaced doesn't use the old one.
+    if (m_vRetired.empty() || m_iReaders != 0)
+        return;
+
+    for (size_t i = 0; i < m_vRetired.size(); ++i)
+        deleteTable(m_vRetired[i]);
+    m_vRetired.clear();
+}
+
+//
+srt::CRendezvousQueue::CRendezvousQueue()
+    : m_lRendezvousID()
+    , m_RIDListLock()
+{
+}
+
+srt::CRendezvousQueue::~CRendezvousQueue()
+{
+    m_lRendezvousID.clear();
 }
 
 void srt::CRendezvousQueue::insert(const SRTSOCKET&           id,
@@ -833,6 +1254,12 @@ void srt::CRendezvousQueue::remove(const SRTSOCKET& id)
     }
 }
 
+bool srt::CRendezvousQueue::empty() const
+{
+    ScopedLock lkv(m_RIDListLock);
+    return m_lRendezvousID.empty();
+}
+
 srt::CUDT* srt::CRendezvousQueue::retrieve(const sockaddr_any& addr, SRTSOCKET& w_id) const
 {
     ScopedLock vg(m_RIDListLock);
@@ -1122,12 +1549,14 @@ bool srt::CRendezvousQueue::qualifyToHandle(EReadStatus    rst,
 srt::CRcvQueue::CRcvQueue()
     : m_WorkerThread()
     , m_pUnitQueue(NULL)
-    , m_pRcvUList(NULL)
+    , m_pTimers(NULL)
     , m_pHash(NULL)
     , m_pChannel(NULL)
     , m_pTimer(NULL)
     , m_iIPversion()
     , m_szPayloadSize()
+    , m_iBatchSize(1)
+    , m_bUnitPosted(false)
     , m_bClosing(false)
     , m_LSLock()
     , m_pListener(NULL)
@@ -1142,7 +1571,7 @@ srt::CRcvQueue::CRcvQueue()
 
 srt::CRcvQueue::~CRcvQueue()
 {
-    m_bClosing = true;
+    setClosing();
 
     if (m_WorkerThread.joinable())
     {
@@ -1151,8 +1580,11 @@ srt::CRcvQueue::~CRcvQueue()
     }
     releaseCond(m_BufferCond);
 
+    for (size_t i = 0; i < m_vShards.size(); ++i)
+        delete m_vShards[i];
+
     delete m_pUnitQueue;
-    delete m_pRcvUList;
+    delete m_pTimers;
     delete m_pHash;
     delete m_pRendezvousQueue;
 
@@ -1172,13 +1604,31 @@ srt::CRcvQueue::~CRcvQueue()
 srt::sync::atomic<int> srt::CRcvQueue::m_counter(0);
 #endif
 
-void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CChannel* cc, CTimer* t)
+void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CChannel* cc, CTimer* t, const CSrtMuxerConfig& mcfg)
 {
     m_iIPversion    = version;
     m_szPayloadSize = payload;
 
+    m_iBatchSize = std::max(1, std::min(mcfg.iUDPRcvBatch, (int)CSrtMuxerConfig::MAX_UDP_BATCH));
+    m_vBatchUnits.resize(m_iBatchSize, NULL);
+    m_vBatchPackets.resize(m_iBatchSize, NULL);
+    m_vBatchAddrs.resize(m_iBatchSize, sockaddr_any(version));
+    m_vBatchStatus.resize(m_iBatchSize, RST_AGAIN);
+
+    // With io_uring the packets are received straight into the units,
+    // which then need room for the data placed before the payload.
+    int headroom = 0;
+    if (mcfg.bUDPIoUring && CChannel::RECV_LENT_MAX > 0)
+    {
+        headroom = (int)CChannel::RECV_HEADROOM;
+        m_vLentUnits.resize(CChannel::RECV_LENT_MAX, NULL);
+        for (int id = CChannel::RECV_LENT_MAX - 1; id >= 0; --id)
+            m_vUnlentIds.push_back(id);
+        m_vBatchIds.resize(m_iBatchSize, -1);
+    }
+
     SRT_ASSERT(m_pUnitQueue == NULL);
-    m_pUnitQueue = new CUnitQueue(qsize, (int)payload);
+    m_pUnitQueue = new CUnitQueue(qsize, (int)payload, headroom);
 
     m_pHash = new CHash;
     m_pHash->init(hsize);
@@ -1186,7 +1636,7 @@ void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CCh
     m_pChannel = cc;
     m_pTimer   = t;
 
-    m_pRcvUList        = new CRcvUList;
+    m_pTimers          = new CTimerWheel;
     m_pRendezvousQueue = new CRendezvousQueue;
 
 #if ENABLE_LOGGING
@@ -1196,6 +1646,13 @@ void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CCh
     const std::string thrname = "SRT:RcvQ:w";
 #endif
 
+    const int nshards = std::min(mcfg.iRcvWorkers, (int)CSrtMuxerConfig::MAX_QUEUE_WORKERS);
+    for (int i = 0; nshards > 1 && i < nshards; ++i)
+    {
+        m_vShards.push_back(new CRcvQueueShard(this));
+        m_vShards.back()->start(thrname + "." + Sprint(i));
+    }
+
     if (!StartThread(m_WorkerThread, CRcvQueue::worker, this, thrname.c_str()))
     {
         throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
@@ -1204,9 +1661,7 @@ void srt::CRcvQueue::init(int qsize, size_t payload, int version, int hsize, CCh
 
 void* srt::CRcvQueue::worker(void* param)
 {
-    CRcvQueue*   self = (CRcvQueue*)param;
-    sockaddr_any sa(self->getIPversion());
-    int32_t      id = 0;
+    CRcvQueue* self = (CRcvQueue*)param;
 
 #if ENABLE_LOGGING
     THREAD_STATE_INIT(("SRT:RcvQ:w" + Sprint(m_counter)).c_str());
@@ -1214,16 +1669,58 @@ void* srt::CRcvQueue::worker(void* param)
     THREAD_STATE_INIT("SRT:RcvQ:worker");
 #endif
 
+    // The packets are read into the units by this thread.
+    self->m_pUnitQueue->prefault();
+
     CUnit*         unit = 0;
     EConnectStatus cst  = CONN_AGAIN;
     while (!self->m_bClosing)
     {
         bool        have_received = false;
-        EReadStatus rst           = self->worker_RetrieveUnit((id), (unit), (sa));
+        int         nrecv         = 0;
+        EReadStatus rst           = self->worker_RetrieveUnits((nrecv));
 
         INCREMENT_THREAD_ITERATIONS();
-        if (rst == RST_OK)
+        if (rst == RST_ERROR)
         {
+            // According to the description by CChannel::recvfrom, this can be either of:
+            // - IPE: all errors except EBADF
+            // - socket was closed in the meantime by another thread: EBADF
+            // If EBADF, then it's expected that the "closing" state is also set.
+            // Check that just to report possible errors, but interrupt the loop anyway.
+            if (self->m_bClosing)
+            {
+                HLOGC(qrlog.Debug,
+                      log << self->CONID() << "CChannel reported error, but Queue is closing - INTERRUPTING worker.");
+            }
+            else
+            {
+                LOGC(qrlog.Fatal,
+                     log << self->CONID()
+                         << "CChannel reported ERROR DURING TRANSMISSION - IPE. INTERRUPTING worker anyway.");
+            }
+            cst = CONN_REJECT;
+            break;
+        }
+        // OTHERWISE: if this is an "AGAIN" situation, no data was read, but the process should continue.
+
+        // Dispatch the whole batch of received packets first, then take care of the timers.
+        for (int i = 0; i < nrecv; ++i)
+        {
+            // Hand over the unit to the dispatcher; it's up to the receiver
+            // buffer (or the packet filter) to take it now. The unit stays
+            // reserved until dispatched, so that it's not given away when
+            // the buffer doesn't want it.
+            unit = self->m_vBatchUnits[i];
+
+            if (self->m_vBatchStatus[i] != RST_OK)
+            {
+                self->m_pUnitQueue->releaseUnit(unit);
+                continue; // Read, but rejected by the channel.
+            }
+
+            const sockaddr_any& sa = self->m_vBatchAddrs[i];
+            const int32_t       id = unit->m_Packet.m_iID;
             if (id < 0)
             {
                 // User error on peer. May log something, but generally can only ignore it.
@@ -1231,11 +1728,14 @@ void* srt::CRcvQueue::worker(void* param)
                 HLOGC(qrlog.Debug,
                       log << self->CONID() << "RECEIVED negative socket id '" << id
                           << "', rejecting (POSSIBLE ATTACK)");
+                self->m_pUnitQueue->releaseUnit(unit);
                 continue;
             }
 
+            self->m_bUnitPosted = false;
+
             // NOTE: cst state is being changed here.
-            // This state should be maintained through any next failed calls to worker_RetrieveUnit.
+            // This state should be maintained through any next failed calls to worker_RetrieveUnits.
             // Any error switches this to rejection, just for a case.
 
             // Note to rendezvous connection. This can accept:
@@ -1255,90 +1755,91 @@ void* srt::CRcvQueue::worker(void* param)
                 // CAN RETURN CONN_REJECT, but m_RejectReason is already set
             }
             HLOGC(qrlog.Debug, log << self->CONID() << "worker: result for the unit: " << ConnectStatusStr(cst));
+
+            if (self->m_bUnitPosted)
+            {
+                // The unit now belongs to the shard and must not be accessed anymore.
+                // The packet was addressed to a connected socket, so as for the
+                // connectors this is the same as if no packet was received.
+                unit = NULL;
+                continue;
+            }
+
             if (cst == CONN_AGAIN)
             {
                 HLOGC(qrlog.Debug, log << self->CONID() << "worker: packet not dispatched, continuing reading.");
+                self->m_pUnitQueue->releaseUnit(unit);
                 continue;
             }
             have_received = true;
+
+            HLOGC(qrlog.Debug,
+                  log << "worker: RECEIVED PACKET --> updateConnStatus. cst=" << ConnectStatusStr(cst) << " id=" << id
+                      << " pkt-payload-size=" << unit->m_Packet.getLength());
+
+            // Check connection requests status for all sockets in the RendezvousQueue.
+            // Pass the connection status from the last call of:
+            // worker_ProcessAddressedPacket --->
+            // worker_TryAsyncRend_OrStore --->
+            // CUDT::processAsyncConnectResponse --->
+            // CUDT::processConnectResponse
+            self->m_pRendezvousQueue->updateConnStatus(RST_OK, cst, unit);
+            self->m_pUnitQueue->releaseUnit(unit);
+
+            // XXX updateConnStatus may have removed the connector from the list,
+            // however there's still m_mBuffer in CRcvQueue for that socket to care about.
         }
-        else if (rst == RST_ERROR)
-        {
-            // According to the description by CChannel::recvfrom, this can be either of:
-            // - IPE: all errors except EBADF
-            // - socket was closed in the meantime by another thread: EBADF
-            // If EBADF, then it's expected that the "closing" state is also set.
-            // Check that just to report possible errors, but interrupt the loop anyway.
-            if (self->m_bClosing)
-            {
-                HLOGC(qrlog.Debug,
-                      log << self->CONID() << "CChannel reported error, but Queue is closing - INTERRUPTING worker.");
-            }
-            else
-            {
-                LOGC(qrlog.Fatal,
-                     log << self->CONID()
-                         << "CChannel reported ERROR DURING TRANSMISSION - IPE. INTERRUPTING worker anyway.");
-            }
-            cst = CONN_REJECT;
-            break;
-        }
-        // OTHERWISE: this is an "AGAIN" situation. No data was read, but the process should continue.
 
-        // take care of the timing event for all UDT sockets
-        const steady_clock::time_point curtime_minus_syn =
-            steady_clock::now() - microseconds_from(CUDT::COMM_SYN_INTERVAL_US);
+        // With the dispatch workers a unit not reserved may be reused at any time.
+        if (!self->m_vShards.empty())
+            unit = NULL;
 
-        CRNode* ul = self->m_pRcvUList->m_pUList;
-        while ((NULL != ul) && (ul->m_tsTimeStamp < curtime_minus_syn))
+        // Pass the posted packets to the shards. These take care of the
+        // timing events for their sockets, so the list is empty then.
+        for (size_t i = 0; i < self->m_vShards.size(); ++i)
+            self->m_vShards[i]->flush();
+
+        // take care of the timing event for the UDT sockets that are due
+        const steady_clock::time_point currtime = steady_clock::now();
+        self->m_pTimers->collectDue(currtime, (self->m_vDueTimers));
+        for (size_t i = 0; i < self->m_vDueTimers.size(); ++i)
         {
-            CUDT* u = ul->m_pUDT;
+            CUDT* u = self->m_vDueTimers[i]->m_pUDT;
 
             if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
             {
                 u->checkTimers();
-                self->m_pRcvUList->update(u);
+                self->m_pTimers->schedule(u->m_pRNode, u->nextTimerDeadline(currtime));
             }
             else
             {
                 HLOGC(qrlog.Debug,
                       log << CUDTUnited::CONID(u->m_SocketID) << " SOCKET broken, REMOVING FROM RCV QUEUE/MAP.");
-                // the socket must be removed from Hash table first, then RcvUList
+                // the socket must be removed from Hash table first; it's already off the wheel
                 self->m_pHash->remove(u->m_SocketID);
-                self->m_pRcvUList->remove(u);
                 u->m_pRNode->m_bOnList = false;
             }
-
-            ul = self->m_pRcvUList->m_pUList;
-        }
-
-        if (have_received)
-        {
-            HLOGC(qrlog.Debug,
-                  log << "worker: RECEIVED PACKET --> updateConnStatus. cst=" << ConnectStatusStr(cst) << " id=" << id
-                      << " pkt-payload-size=" << unit->m_Packet.getLength());
         }
+        self->m_vDueTimers.clear();
 
-        // Check connection requests status for all sockets in the RendezvousQueue.
-        // Pass the connection status from the last call of:
-        // worker_ProcessAddressedPacket --->
-        // worker_TryAsyncRend_OrStore --->
-        // CUDT::processAsyncConnectResponse --->
-        // CUDT::processConnectResponse
-        self->m_pRendezvousQueue->updateConnStatus(rst, cst, unit);
-
-        // XXX updateConnStatus may have removed the connector from the list,
-        // however there's still m_mBuffer in CRcvQueue for that socket to care about.
+        // With no packet dispatched, still let the pending connections
+        // be updated (resending handshake, checking expiration).
+        if (!have_received)
+            self->m_pRendezvousQueue->updateConnStatus(RST_AGAIN, cst, unit);
     }
 
+    const bool reusable = self->m_pChannel->stopReceiving();
+    self->worker_ReturnLentUnits(reusable);
     HLOGC(qrlog.Debug, log << "worker: EXIT");
 
     THREAD_EXIT();
     return NULL;
 }
 
-srt::EReadStatus srt::CRcvQueue::worker_RetrieveUnit(int32_t& w_id, CUnit*& w_unit, sockaddr_any& w_addr)
+srt::EReadStatus srt::CRcvQueue::worker_RetrieveUnits(int& w_nrecv)
 {
+    w_nrecv = 0;
+
 #if !USE_BUSY_WAITING
     // This might be not really necessary, and probably
     // not good for extensive bidirectional communication.
@@ -1346,27 +1847,73 @@ srt::EReadStatus srt::CRcvQueue::worker_RetrieveUnit(int32_t& w_id, CUnit*& w_un
 #endif
 
     // check waiting list, if new socket, insert it to the list
-    while (ifNewEntry())
+    worker_InsertNewEntries();
+
+    if (!m_vShards.empty())
     {
-        CUDT* ne = getNewEntry();
-        if (ne)
+        // Sockets found broken by the shards: remove them from the hash
+        // table first, so that no more packets are posted for them.
+        std::vector<CUDT*> removed;
         {
-            HLOGC(qrlog.Debug,
-                  log << CUDTUnited::CONID(ne->m_SocketID)
-                      << " SOCKET pending for connection - ADDING TO RCV QUEUE/MAP");
-            m_pRcvUList->insert(ne);
-            m_pHash->insert(ne->m_SocketID, ne);
+            ScopedLock listguard(m_IDLock);
+            removed.swap(m_vRemovedEntry);
+        }
+
+        for (size_t i = 0; i < removed.size(); ++i)
+        {
+            HLOGC(qrlog.Debug, log << CUDTUnited::CONID(removed[i]->m_SocketID) << " SOCKET broken, REMOVING FROM MAP.");
+            m_pHash->remove(removed[i]->m_SocketID);
+            shardOf(removed[i])->postRelease(removed[i]);
         }
     }
-    // find next available slot for incoming packet
-    w_unit = m_pUnitQueue->getNextAvailUnit();
-    if (!w_unit)
+
+    worker_Reschedule();
+
+    // Not to wait for the packets with these.
+    for (size_t i = 0; i < m_vShards.size(); ++i)
+        m_vShards[i]->flush();
+
+    // Wake up when the first timer check is due, unless woken up by another
+    // thread before that (see CChannel::wakeReceiver()).
+    const int wait_us = worker_WaitTime();
+
+    const bool lent = m_pChannel->receivesLent();
+    if (!lent && !m_vLentUnits.empty())
+    {
+        // Also when the ring has failed: the kernel might still write into them.
+        worker_ReturnLentUnits(false);
+    }
+
+    // find next available slots for incoming packets
+    int navail = 0;
+    if (lent)
+    {
+        navail = worker_LendUnits();
+    }
+    else
+    {
+        for (; navail < m_iBatchSize; ++navail)
+        {
+            // RESERVE the unit because otherwise the next call to
+            // getNextAvailUnit will return THE SAME UNIT. The reservation
+            // is released after dispatching it.
+            CUnit* u = m_pUnitQueue->reserveNextAvailUnit();
+            if (!u)
+                break;
+
+            u->m_Packet.setLength(m_szPayloadSize);
+            m_vBatchUnits[navail]   = u;
+            m_vBatchPackets[navail] = &u->m_Packet;
+        }
+    }
+
+    if (navail == 0)
     {
         // no space, skip this packet
         CPacket temp;
         temp.allocate(m_szPayloadSize);
         THREAD_PAUSED();
-        EReadStatus rst = m_pChannel->recvfrom((w_addr), (temp));
+        EReadStatus rst = m_pChannel->recvfrom((m_vBatchAddrs[0]), (temp), wait_us);
         THREAD_RESUMED();
         // Note: this will print nothing about the packet details unless heavy logging is on.
         LOGC(qrlog.Error, log << CONID() << "LOCAL STORAGE DEPLETED. Dropping 1 packet: " << temp.Info());
@@ -1376,20 +1923,44 @@ srt::EReadStatus srt::CRcvQueue::worker_RetrieveUnit(int32_t& w_id, CUnit*& w_un
         return rst == RST_ERROR ? RST_ERROR : RST_AGAIN;
     }
 
-    w_unit->m_Packet.setLength(m_szPayloadSize);
+    // reading next incoming packets, at least one is read if RST_OK is returned
+    EReadStatus rst;
+    if (lent)
+    {
+        THREAD_PAUSED();
+        rst = m_pChannel->recvfrom_lent(&m_vBatchAddrs[0], &m_vBatchIds[0], &m_vBatchStatus[0], m_iBatchSize, (w_nrecv), wait_us);
+        THREAD_RESUMED();
+
+        // The units received into are dispatched as those read in a batch.
+        for (int i = 0; i < w_nrecv; ++i)
+        {
+            const int id     = m_vBatchIds[i];
+            m_vBatchUnits[i] = m_vLentUnits[id];
+            m_vLentUnits[id] = NULL;
+            m_vUnlentIds.push_back(id);
+        }
+    }
+    else
+    {
+        THREAD_PAUSED();
+        rst = m_pChannel->recvfrom_batch(&m_vBatchAddrs[0], &m_vBatchPackets[0], &m_vBatchStatus[0], navail, (w_nrecv), wait_us);
+        THREAD_RESUMED();
 
-    // reading next incoming packet, recvfrom returns -1 is nothing has been received
-    THREAD_PAUSED();
-    EReadStatus rst = m_pChannel->recvfrom((w_addr), (w_unit->m_Packet));
-    THREAD_RESUMED();
+        // Units not filled with packets are not in use.
+        for (int i = w_nrecv; i < navail; ++i)
+            m_pUnitQueue->releaseUnit(m_vBatchUnits[i]);
+    }
 
-    if (rst == RST_OK)
+#if ENABLE_HEAVY_LOGGING
+    for (int i = 0; i < w_nrecv; ++i)
     {
-        w_id = w_unit->m_Packet.m_iID;
+        if (m_vBatchStatus[i] != RST_OK)
+            continue;
         HLOGC(qrlog.Debug,
-              log << "INCOMING PACKET: FROM=" << w_addr.str() << " BOUND=" << m_pChannel->bindAddressAny().str() << " "
-                  << w_unit->m_Packet.Info());
+              log << "INCOMING PACKET: FROM=" << m_vBatchAddrs[i].str() << " BOUND=" << m_pChannel->bindAddressAny().str()
+                  << " " << m_vBatchUnits[i]->m_Packet.Info());
     }
+#endif
     return rst;
 }
 
@@ -1439,6 +2010,14 @@ srt::EConnectStatus srt::CRcvQueue::worker_ProcessConnectionRequest(CUnit* unit,
 srt::EConnectStatus srt::CRcvQueue::worker_ProcessAddressedPacket(int32_t id, CUnit* unit, const sockaddr_any& addr)
 {
     CUDT* u = m_pHash->lookup(id);
+    if (!u && ifNewEntry())
+    {
+        // The socket might have got connected while this packet was being
+        // received, and the packet be the first one sent to it by the peer.
+        worker_InsertNewEntries();
+        u = m_pHash->lookup(id);
+    }
+
     if (!u)
     {
         // Pass this to either async rendezvous connection,
@@ -1469,17 +2048,131 @@ srt::EConnectStatus srt::CRcvQueue::worker_ProcessAddressedPacket(int32_t id, CU
         return CONN_REJECT;
     }
 
+    if (!m_vShards.empty())
+    {
+        shardOf(u)->post(u, unit);
+        m_bUnitPosted = true;
+        return CONN_RUNNING;
+    }
+
     if (unit->m_Packet.isControl())
         u->processCtrl(unit->m_Packet);
     else
         u->processData(unit);
 
     u->checkTimers();
-    m_pRcvUList->update(u);
+    m_pTimers->schedule(u->m_pRNode, u->nextTimerDeadline(steady_clock::now()));
 
     return CONN_RUNNING;
 }
 
+void srt::CRcvQueue::worker_InsertNewEntries()
+{
+    while (ifNewEntry())
+    {
+        CUDT* ne = getNewEntry();
+        if (ne)
+        {
+            HLOGC(qrlog.Debug,
+                  log << CUDTUnited::CONID(ne->m_SocketID)
+                      << " SOCKET pending for connection - ADDING TO RCV QUEUE/MAP");
+            worker_InsertNewEntry(ne);
+        }
+    }
+}
+
+void srt::CRcvQueue::worker_InsertNewEntry(CUDT* ne)
+{
+    if (m_vShards.empty())
+        m_pTimers->schedule(ne->m_pRNode, ne->nextTimerDeadline(steady_clock::now()));
+    else
+        shardOf(ne)->postInsert(ne);
+    m_pHash->insert(ne->m_SocketID, ne);
+}
+
+void srt::CRcvQueue::worker_Reschedule()
+{
+    {
+        ScopedLock listguard(m_IDLock);
+        if (m_vRescheduled.empty())
+            return;
+        m_vRescheduling.swap(m_vRescheduled);
+    }
+
+    const steady_clock::time_point now = steady_clock::now();
+    for (size_t i = 0; i < m_vRescheduling.size(); ++i)
+    {
+        // Not connected yet, or already removed.
+        CUDT* u = m_pHash->lookup(m_vRescheduling[i]);
+        if (!u)
+            continue;
+
+        if (!m_vShards.empty())
+            shardOf(u)->postReschedule(u);
+        else if (u->m_pRNode->m_iSlot != -1)
+            m_pTimers->schedule(u->m_pRNode, u->nextTimerDeadline(now));
+    }
+    m_vRescheduling.clear();
+}
+
+int srt::CRcvQueue::worker_LendUnits()
+{
+    while (!m_vUnlentIds.empty())
+    {
+        // Reserved as in a batch, until received into and dispatched.
+        CUnit* u = m_pUnitQueue->reserveNextAvailUnit();
+        if (!u)
+            break;
+
+        const int id = m_vUnlentIds.back();
+        m_vUnlentIds.pop_back();
+        u->m_Packet.setLength(m_szPayloadSize);
+        m_pChannel->lendRecvPacket(u->m_Packet, id);
+        m_vLentUnits[id] = u;
+    }
+    return int(m_vLentUnits.size() - m_vUnlentIds.size());
+}
+
+void srt::CRcvQueue::worker_ReturnLentUnits(bool reusable)
+{
+    for (size_t id = 0; id < m_vLentUnits.size(); ++id)
+    {
+        if (m_vLentUnits[id] && reusable)
+            m_pUnitQueue->releaseUnit(m_vLentUnits[id]);
+    }
+
+    if (!reusable && m_vLentUnits.size() != m_vUnlentIds.size())
+    {
+        LOGC(qrlog.Warn, log << CONID() << "worker: " << m_vLentUnits.size() - m_vUnlentIds.size()
+                << " units lent to io_uring are left reserved, as the system might still write into them");
+    }
+    m_vLentUnits.clear();
+    m_vUnlentIds.clear();
+}
+
+int srt::CRcvQueue::worker_WaitTime() const
+{
+    // The pending connections are updated on every pass (handshake
+    // retransmission, expiration), as it was done without the timers.
+    if (!m_pRendezvousQueue->empty())
+        return CChannel::RECV_POLL_US;
+
+    // With nothing to check, the value is just kept in range.
+    static const int MAX_WAIT_US = 1000 * 1000;
+    if (!m_vShards.empty() || m_pTimers->empty())
+        return MAX_WAIT_US;
+
+    const steady_clock::duration wait = m_pTimers->nextDeadline() - steady_clock::now();
+    if (wait <= steady_clock::duration::zero())
+        return 0;
+    return (int)std::min<int64_t>(count_microseconds(wait), MAX_WAIT_US);
+}
+
+srt::CRcvQueueShard* srt::CRcvQueue::shardOf(const CUDT* u) const
+{
+    return m_vShards[u->m_SocketID % m_vShards.size()];
+}
+
 // This function responds to the fact that a packet has come
 // for a socket that does not expect to receive a normal connection
 // request. This can be then:
@@ -1578,8 +2271,7 @@ srt::EConnectStatus srt::CRcvQueue::worker_TryAsyncRend_OrStore(int32_t id, CUni
                 HLOGC(cnlog.Debug,
                       log << CUDTUnited::CONID(ne->m_SocketID)
                           << " SOCKET pending for connection - ADDING TO RCV QUEUE/MAP");
-                m_pRcvUList->insert(ne);
-                m_pHash->insert(ne->m_SocketID, ne);
+                worker_InsertNewEntry(ne);
 
                 // The current situation is that this has passed processAsyncConnectResponse, but actually
                 // this packet *SHOULD HAVE BEEN* handled by worker_ProcessAddressedPacket, however the
@@ -1618,10 +2310,17 @@ srt::EConnectStatus srt::CRcvQueue::worker_TryAsyncRend_OrStore(int32_t id, CUni
     return CONN_CONTINUE;
 }
 
+void srt::CRcvQueue::setClosing()
+{
+    m_bClosing = true;
+    if (m_pChannel)
+        m_pChannel->wakeReceiver();
+}
+
 void srt::CRcvQueue::stopWorker()
 {
     // We use the decent way, so we say to the thread "please exit".
-    m_bClosing = true;
+    setClosing();
 
     // Sanity check of the function's affinity.
     if (srt::sync::this_thread::get_id() == m_WorkerThread.get_id())
@@ -1715,6 +2414,9 @@ void srt::CRcvQueue::registerConnector(const SRTSOCKET&                id,
     HLOGC(cnlog.Debug,
           log << "registerConnector: adding @" << id << " addr=" << addr.str() << " TTL=" << FormatTime(ttl));
     m_pRendezvousQueue->insert(id, u, addr, ttl);
+
+    // The worker waits shorter with the pending connections.
+    m_pChannel->wakeReceiver();
 }
 
 void srt::CRcvQueue::removeConnector(const SRTSOCKET& id)
@@ -1741,8 +2443,11 @@ void srt::CRcvQueue::removeConnector(const SRTSOCKET& id)
 void srt::CRcvQueue::setNewEntry(CUDT* u)
 {
     HLOGC(cnlog.Debug, log << CUDTUnited::CONID(u->m_SocketID) << "setting socket PENDING FOR CONNECTION");
-    ScopedLock listguard(m_IDLock);
-    m_vNewEntry.push_back(u);
+    {
+        ScopedLock listguard(m_IDLock);
+        m_vNewEntry.push_back(u);
+    }
+    m_pChannel->wakeReceiver();
 }
 
 bool srt::CRcvQueue::ifNewEntry()
@@ -1750,6 +2455,24 @@ bool srt::CRcvQueue::ifNewEntry()
     return !(m_vNewEntry.empty());
 }
 
+void srt::CRcvQueue::setRemovedEntry(CUDT* u)
+{
+    {
+        ScopedLock listguard(m_IDLock);
+        m_vRemovedEntry.push_back(u);
+    }
+    m_pChannel->wakeReceiver();
+}
+
+void srt::CRcvQueue::rescheduleTimers(SRTSOCKET id)
+{
+    {
+        ScopedLock listguard(m_IDLock);
+        m_vRescheduled.push_back(id);
+    }
+    m_pChannel->wakeReceiver();
+}
+
 srt::CUDT* srt::CRcvQueue::getNewEntry()
 {
     ScopedLock listguard(m_IDLock);
@@ -1784,6 +2507,172 @@ void srt::CRcvQueue::storePktClone(int32_t id, const CPacket& pkt)
     }
 }
 
+//
+srt::CRcvQueueShard::CRcvQueueShard(CRcvQueue* parent)
+    : m_pParent(parent)
+    , m_bClosing(false)
+{
+    setupCond(m_QueueCond, "RcvQShard");
+}
+
+srt::CRcvQueueShard::~CRcvQueueShard()
+{
+    {
+        ScopedLock lk(m_QueueLock);
+        m_bClosing = true;
+    }
+    m_QueueCond.notify_one();
+
+    if (m_WorkerThread.joinable())
+        m_WorkerThread.join();
+    releaseCond(m_QueueCond);
+}
+
+void srt::CRcvQueueShard::start(const std::string& thname)
+{
+    if (!StartThread(m_WorkerThread, CRcvQueueShard::worker, this, thname.c_str()))
+        throw CUDTException(MJ_SYSTEMRES, MN_THREAD);
+}
+
+void srt::CRcvQueueShard::post(CUDT* u, CUnit* unit)
+{
+    const Item item = {Item::PACKET, u, unit};
+    m_vPosted.push_back(item);
+}
+
+void srt::CRcvQueueShard::postInsert(CUDT* u)
+{
+    const Item item = {Item::INSERT, u, NULL};
+    m_vPosted.push_back(item);
+}
+
+void srt::CRcvQueueShard::postRelease(CUDT* u)
+{
+    const Item item = {Item::RELEASE, u, NULL};
+    m_vPosted.push_back(item);
+}
+
+void srt::CRcvQueueShard::postReschedule(CUDT* u)
+{
+    const Item item = {Item::RESCHEDULE, u, NULL};
+    m_vPosted.push_back(item);
+}
+
+void srt::CRcvQueueShard::flush()
+{
+    if (m_vPosted.empty())
+        return;
+
+    {
+        ScopedLock lk(m_QueueLock);
+        m_vQueue.insert(m_vQueue.end(), m_vPosted.begin(), m_vPosted.end());
+    }
+    m_QueueCond.notify_one();
+    m_vPosted.clear();
+}
+
+void* srt::CRcvQueueShard::worker(void* param)
+{
+    CRcvQueueShard* self = (CRcvQueueShard*)param;
+    THREAD_STATE_INIT("SRT:RcvQ:shard");
+
+    std::vector<Item> items;
+    while (!self->m_bClosing)
+    {
+        INCREMENT_THREAD_ITERATIONS();
+        {
+            UniqueLock lk(self->m_QueueLock);
+            if (self->m_vQueue.empty() && !self->m_bClosing)
+            {
+                // Wake up at the latest when the first socket is due for the timer checks.
+                const steady_clock::time_point next_check = self->m_Timers.nextDeadline();
+                THREAD_PAUSED();
+                if (is_zero(next_check))
+                    self->m_QueueCond.wait(lk);
+                else
+                    self->m_QueueCond.wait_until(lk, next_check);
+                THREAD_RESUMED();
+            }
+            items.swap(self->m_vQueue);
+        }
+
+        for (size_t i = 0; i < items.size(); ++i)
+            self->dispatch(items[i]);
+        items.clear();
+
+        self->checkTimers();
+    }
+
+    THREAD_EXIT();
+    return NULL;
+}
+
+void srt::CRcvQueueShard::dispatch(const Item& item)
+{
+    CUDT* u = item.m_pUDT;
+
+    if (item.m_Type == Item::INSERT)
+    {
+        m_Timers.schedule(u->m_pRNode, u->nextTimerDeadline(steady_clock::now()));
+        return;
+    }
+
+    if (item.m_Type == Item::RESCHEDULE)
+    {
+        // Off the wheel only when found broken, waiting for the release.
+        if (u->m_pRNode->m_iSlot != -1)
+            m_Timers.schedule(u->m_pRNode, u->nextTimerDeadline(steady_clock::now()));
+        return;
+    }
+
+    if (item.m_Type == Item::RELEASE)
+    {
+        // Already removed from m_Timers by checkTimers() and from the
+        // hash table by the receiver queue. The socket may be deleted now.
+        u->m_pRNode->m_bOnList = false;
+        return;
+    }
+
+    // Same as in CRcvQueue::worker_ProcessAddressedPacket.
+    CUnit* unit = item.m_pUnit;
+    if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
+    {
+        if (unit->m_Packet.isControl())
+            u->processCtrl(unit->m_Packet);
+        else
+            u->processData(unit);
+
+        u->checkTimers();
+        m_Timers.schedule(u->m_pRNode, u->nextTimerDeadline(steady_clock::now()));
+    }
+    m_pParent->m_pUnitQueue->releaseUnit(unit);
+}
+
+void srt::CRcvQueueShard::checkTimers()
+{
+    const steady_clock::time_point currtime = steady_clock::now();
+    m_Timers.collectDue(currtime, (m_vDueTimers));
+    for (size_t i = 0; i < m_vDueTimers.size(); ++i)
+    {
+        CUDT* u = m_vDueTimers[i]->m_pUDT;
+
+        if (u->m_bConnected && !u->m_bBroken && !u->m_bClosing)
+        {
+            u->checkTimers();
+            m_Timers.schedule(u->m_pRNode, u->nextTimerDeadline(currtime));
+        }
+        else
+        {
+            HLOGC(qrlog.Debug,
+                  log << CUDTUnited::CONID(u->m_SocketID) << " SOCKET broken, REMOVING FROM RCV QUEUE SHARD.");
+            // The socket must be removed from the hash table first,
+            // then it's released here (see dispatch()).
+            m_pParent->setRemovedEntry(u);
+        }
+    }
+    m_vDueTimers.clear();
+}
+
 void srt::CMultiplexer::destroy()
 {
     // Reverse order of the assigned.
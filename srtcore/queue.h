@@ -55,6 +55,7 @@ modified by
 
 #include "common.h"
 #include "packet.h"
+#include "channel.h"
 #include "socketconfig.h"
 #include "netinet_any.h"
 #include "utilities.h"
@@ -71,64 +72,144 @@ class CUDT;
 struct CUnit
 {
     CPacket m_Packet; // packet
-    sync::atomic<bool> m_bTaken; // true if the unit is is use (can be stored in the RCV buffer).
+
+    enum Flags
+    {
+        TAKEN    = 1, // in use (can be stored in the RCV buffer)
+        RESERVED = 2, // being filled or dispatched (see CUnitQueue::reserveNextAvailUnit)
+        LISTED   = 4  // on the free list of CUnitQueue
+    };
+    sync::atomic<int> m_iFlags; // Flags, changed with compare-exchange
+
+    bool isTaken() const { return (m_iFlags.load() & TAKEN) != 0; }
+    bool isReserved() const { return (m_iFlags.load() & RESERVED) != 0; }
+
+    uint32_t m_uIndex; // position of the unit in CUnitQueue
+    sync::atomic<uint32_t> m_uNextFree; // m_uIndex + 1 of the next unit on the free list, 0 for none
 };
 
+/// Storage of the packets received by a multiplexer. The units are allocated
+/// in slabs, each with a contiguous payload buffer, and the units neither
+/// taken nor reserved are kept on a lock-free stack, so that reserving and
+/// releasing a unit takes constant time without blocking the other receiving
+/// threads and the readers. The units are found by their position through
+/// a directory of the slabs, and the head of the stack carries a tag changed
+/// with every update, so that a unit popped and pushed again meanwhile does
+/// not pass for an unchanged head. m_FreeLock is only taken to grow.
+///
+/// A unit taken while on the stack (see getNextAvailUnit()) is left there
+/// and dropped when popped; the LISTED flag tells makeUnitFree() whether it
+/// still has to be pushed.
 class CUnitQueue
 {
 public:
     /// @brief Construct a unit queue.
-    /// @param mss Initial number of units to allocate.
+    /// @param initNumUnits Initial number of units to allocate.
     /// @param mss Maximum segment size meaning the size of each unit.
+    /// @param headroom Space left free before the buffer of each unit (see CChannel::RECV_HEADROOM).
     /// @throws CUDTException SRT_ENOBUF.
-    CUnitQueue(int initNumUnits, int mss);
+    CUnitQueue(int initNumUnits, int mss, int headroom = 0);
     ~CUnitQueue();
 
 public:
     int capacity() const { return m_iSize; }
     int size() const { return m_iSize - m_iNumTaken; }
 
+    /// Number of units currently taken by the receiver buffers.
+    int numTaken() const { return m_iNumTaken; }
+
+    /// The highest number of units taken at a time since the creation.
+    int maxTaken() const { return m_iMaxTaken; }
+
 public:
     /// @brief Find an available unit for incoming packet. Allocate new units if 90% or more are in use.
-    /// @note This function is not thread-safe. Currently only CRcvQueue::worker thread calls it, thus
-    /// it is not an issue. However, must be protected if used from several threads in the future.
+    /// The unit stays available (and is returned again) until taken or reserved; with more than one
+    /// thread getting units, use reserveNextAvailUnit() instead.
     /// @return Pointer to the available unit, NULL if not found.
     CUnit* getNextAvailUnit();
 
+    /// @brief Find an available unit as getNextAvailUnit() does and mark it as reserved,
+    /// so that no other call can return the same unit until the reservation is released
+    /// by releaseUnit(). A reserved unit can be taken by the receiver buffer.
+    /// @return Pointer to the reserved unit, NULL if not found.
+    CUnit* reserveNextAvailUnit();
+
+    /// Release the reservation of a unit made by reserveNextAvailUnit().
+    /// The unit becomes available again unless taken by a receiver buffer.
+    void releaseUnit(CUnit* unit);
+
     void makeUnitFree(CUnit* unit);
 
     void makeUnitTaken(CUnit* unit);
 
+    /// Touch the pages of the payload buffers from the calling thread, so that
+    /// they are allocated now (on its NUMA node) rather than at the first packet.
+    void prefault();
+
 private:
-    struct CQEntry
+    static const int MAX_GROW_UNITS = 128; // Maximum number of units allocated when growing
+    static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    struct CSlab
     {
-        CUnit* m_pUnit;   // unit queue
-        char*  m_pBuffer; // data buffer
-        int    m_iSize;   // size of each queue
+        CUnit* m_pUnit;       // units of the slab
+        char*  m_pBuffer;     // payload buffer of all the units
+        size_t m_zBufferSize; // size of the payload buffer in bytes
+        bool   m_bMapped;     // the buffer was allocated with mmap
+        int    m_iSize;       // number of units
 
-        CQEntry* m_pNext;
+        CSlab* m_pNext;
     };
 
+    static const int SLAB_DIR_PAGE_SIZE = 256;  // Number of slabs in a page of the directory
+    static const int SLAB_DIR_PAGES     = 1024; // Maximum number of pages of the directory
+
+    static const uint64_t FREE_TAG_ONE    = uint64_t(1) << 32; // The tag is in the high 32 bits of m_uFreeHead
+    static const uint64_t FREE_INDEX_MASK = FREE_TAG_ONE - 1;  // m_uIndex + 1 of the first unit, 0 for none
+
     /// Increase the unit queue size (by @a m_iBlockSize units).
-    /// Uses m_mtx to protect access and changes of the queue state.
+    /// Must be called with m_FreeLock locked.
     /// @return 0: success, -1: failure.
     int increase_();
 
-    /// @brief Allocated a CQEntry of iNumUnits with each unit of mss bytes.
+    /// Allocate new units if 90% or more are in use, or if none is free.
+    void grow();
+
+    /// Add a slab to the directory and push its units to the free list.
+    /// Must be called with m_FreeLock locked.
+    /// @return false if the directory is full.
+    bool addSlab_(CSlab* slab);
+
+    /// @return The unit at the given position.
+    CUnit* unitAt(uint32_t index) const;
+
+    /// Pop units off the free list until one not taken is found and reserve it.
+    /// @return The reserved unit, NULL if the list is empty.
+    CUnit* popFree();
+    void pushFree(CUnit* unit);
+
+    /// @brief Allocate a slab of iNumUnits with each unit of mss bytes.
+    /// Large buffers are mapped separately and may be backed by huge pages.
     /// @param iNumUnits a number of units to allocate
     /// @param mss the size of each unit in bytes.
-    /// @return a pointer to a newly allocated entry on success, NULL otherwise.
-    static CQEntry* allocateEntry(const int iNumUnits, const int mss);
+    /// @param headroom the space before each unit in bytes.
+    /// @return a pointer to a newly allocated slab on success, NULL otherwise.
+    static CSlab* allocateSlab(const int iNumUnits, const int mss, const int headroom);
+    static void   releaseSlab(CSlab* slab);
 
 private:
-    CQEntry* m_pQEntry;    // pointer to the first unit queue
-    CQEntry* m_pCurrQueue; // pointer to the current available queue
-    CQEntry* m_pLastQueue; // pointer to the last unit queue
-    CUnit* m_pAvailUnit; // recent available unit
-    int m_iSize;  // total size of the unit queue, in number of packets
+    CSlab* m_pSlabs; // allocated slabs, the last allocated first
+    CSlab** m_aSlabDir[SLAB_DIR_PAGES]; // slabs by number, in pages of SLAB_DIR_PAGE_SIZE; see unitAt()
+    int m_iNumSlabs; // number of slabs in m_aSlabDir
+    sync::atomic<uint64_t> m_uFreeHead; // Tag and first unit of the free list, see FREE_TAG_ONE
+    sync::atomic<int> m_iSize;  // total size of the unit queue, in number of packets
     sync::atomic<int> m_iNumTaken; // total number of valid (occupied) packets in the queue
+    sync::atomic<int> m_iMaxTaken; // the highest value of m_iNumTaken
     const int m_iMSS; // unit buffer size
-    const int m_iBlockSize; // Number of units in each CQEntry.
+    const int m_iHeadroom; // space before the unit buffer
+    const int m_iFirstSlabSize; // Number of units allocated at the construction.
+    const int m_iBlockSize; // Number of units allocated when growing.
+    sync::Mutex m_FreeLock; // Serializes growing, protects m_pSlabs and the directory updates
 
 private:
     CUnitQueue(const CUnitQueue&);
@@ -221,8 +302,9 @@ private:
 
 struct CRNode
 {
-    CUDT*                          m_pUDT;        // Pointer to the instance of CUDT socket
-    sync::steady_clock::time_point m_tsTimeStamp; // Time Stamp
+    CUDT*   m_pUDT;  // Pointer to the instance of CUDT socket
+    int64_t m_llTick; // Deadline for the timer checks, in ticks of CTimerWheel
+    int     m_iSlot; // Slot of CTimerWheel, -1 if not on the wheel
 
     CRNode* m_pPrev; // previous link
     CRNode* m_pNext; // next link
@@ -230,39 +312,71 @@ struct CRNode
     sync::atomic<bool> m_bOnList; // if the node is already on the list
 };
 
-class CRcvUList
+/// Hierarchical timer wheel for the periodic timer checks (CUDT::checkTimers())
+/// of the sockets in the receiver queue. Each socket is scheduled at its own
+/// deadline (CUDT::nextTimerDeadline()) and visited only when it has come.
+/// Scheduling and removal are O(1); the wheel advances in ticks of 1 ms.
+class CTimerWheel
 {
 public:
-    CRcvUList();
-    ~CRcvUList();
+    CTimerWheel();
 
 public:
-    /// Insert a new UDT instance to the list.
-    /// @param [in] u pointer to the UDT instance
+    /// Schedule the timer checks of the socket, moving it if already scheduled.
+    /// @param [in] n node of the UDT instance
+    /// @param [in] deadline time of the timer checks
 
-    void insert(const CUDT* u);
+    void schedule(CRNode* n, const sync::steady_clock::time_point& deadline);
 
-    /// Remove the UDT instance from the list.
-    /// @param [in] u pointer to the UDT instance
+    /// Remove the UDT instance from the wheel.
+    /// @param [in] n node of the UDT instance
 
-    void remove(const CUDT* u);
+    void remove(CRNode* n);
 
-    /// Move the UDT instance to the end of the list, if it already exists; otherwise, do nothing.
-    /// @param [in] u pointer to the UDT instance
+    /// Advance the wheel to @a currtime and take the sockets whose deadline has come.
+    /// @param [in] currtime current time
+    /// @param [out] w_due nodes removed from the wheel, to be checked and rescheduled
 
-    void update(const CUDT* u);
+    void collectDue(const sync::steady_clock::time_point& currtime, std::vector<CRNode*>& w_due);
 
-public:
-    CRNode* m_pUList; // the head node
+    /// Get the earliest time when any socket may be due. This may be earlier than
+    /// the deadline of any socket in case of those scheduled far ahead.
+    /// @return The time, or zero time if the wheel is empty.
+
+    sync::steady_clock::time_point nextDeadline() const;
+
+    bool empty() const { return m_iSize == 0; }
 
 private:
-    CRNode* m_pLast; // the last node
+    static const int TICK_US  = 1000;
+    static const int L0_BITS  = 8; // Level 0: one slot per tick
+    static const int L0_SLOTS = 1 << L0_BITS;
+    static const int L1_BITS  = 6; // Level 1: one slot per L0_SLOTS ticks
+    static const int L1_SLOTS = 1 << L1_BITS;
+
+    // Level 0, level 1, then the slot for deadlines beyond level 1.
+    static const int OVERFLOW_SLOT = L0_SLOTS + L1_SLOTS;
+    static const int NUM_SLOTS     = OVERFLOW_SLOT + 1;
+
+    void link_(CRNode* n);
+    void unlink_(CRNode* n);
+    void cascade_(int slot);
+    sync::steady_clock::time_point timeOf(int64_t tick) const;
+
+    sync::steady_clock::time_point m_tsBase;    // Time of tick 0
+    int64_t                        m_llCurrent; // The last tick processed
+    int                            m_iSize;     // Number of sockets on the wheel
+    CRNode*                        m_aSlots[NUM_SLOTS];
 
 private:
-    CRcvUList(const CRcvUList&);
-    CRcvUList& operator=(const CRcvUList&);
+    CTimerWheel(const CTimerWheel&);
+    CTimerWheel& operator=(const CTimerWheel&);
 };
 
+/// Socket ID lookup table of a multiplexer. It's an open-addressing table
+/// with linear probing, which grows as needed. It may be modified by one thread
+/// only, while lookupShared() may be called by any other thread without locking.
+/// A table replaced by growing is freed only when no such lookup is in progress.
 class CHash
 {
 public:
@@ -271,15 +385,22 @@ public:
 
 public:
     /// Initialize the hash table.
-    /// @param [in] size hash table size
+    /// @param [in] size initial number of entries to make room for
 
     void init(int size);
 
-    /// Look for a UDT instance from the hash table.
+    /// Look for a UDT instance from the hash table. To be called only
+    /// by the thread that modifies the table.
     /// @param [in] id socket ID
     /// @return Pointer to a UDT instance, or NULL if not found.
 
-    CUDT* lookup(int32_t id);
+    CUDT* lookup(int32_t id) const { return find_(m_pTable, id); }
+
+    /// Look for a UDT instance from the hash table, from any thread.
+    /// @param [in] id socket ID
+    /// @return Pointer to a UDT instance, or NULL if not found.
+
+    CUDT* lookupShared(int32_t id) const;
 
     /// Insert an entry to the hash table.
     /// @param [in] id socket ID
@@ -292,16 +413,48 @@ public:
 
     void remove(int32_t id);
 
+    /// @return Number of entries in the table.
+    int size() const { return m_iSize; }
+
 private:
-    struct CBucket
+    // Values of CSlot::m_iID that are not a socket ID.
+    static const int32_t EMPTY_ID   = 0;
+    static const int32_t REMOVED_ID = -1;
+
+    struct CSlot
     {
-        int32_t m_iID;  // Socket ID
-        CUDT*   m_pUDT; // Socket instance
+        sync::atomic<int32_t> m_iID;  // Socket ID, EMPTY_ID or REMOVED_ID
+        sync::atomic<CUDT*>   m_pUDT; // Socket instance
+    };
 
-        CBucket* m_pNext; // next bucket
-    } * *m_pBucket;       // list of buckets (the hash table)
+    struct CTable
+    {
+        CSlot* m_pSlots;
+        size_t m_zMask; // Number of slots - 1 (the number is a power of 2)
+    };
+
+    static CTable* createTable(size_t nslots);
+    static void    deleteTable(CTable* t);
+
+    static size_t slotOf(int32_t id, size_t mask)
+    {
+        // Socket IDs are mostly consecutive; spread them over the table.
+        return (size_t(uint32_t(id) * 2654435761U)) & mask;
+    }
+
+    static CUDT* find_(const CTable* t, int32_t id);
+
+    /// Rebuild the table without removed entries, large enough for @a count entries.
+    void rehash_(int count);
 
-    int m_iHashSize; // size of hash table
+    /// Free the tables replaced by rehash_() if no lookup is in progress.
+    void reclaim_();
+
+    sync::atomic<CTable*>     m_pTable;   // The current table
+    std::vector<CTable*>      m_vRetired; // Replaced tables, possibly still in use by lookup()
+    mutable sync::atomic<int> m_iReaders; // Number of lookupShared() calls in progress
+    int                       m_iSize;    // Number of entries
+    int                       m_iRemoved; // Number of slots with REMOVED_ID
 
 private:
     CHash(const CHash&);
@@ -336,6 +489,9 @@ public:
     /// @return a pointer to CUDT instance retrieved, or NULL if nothing was found.
     CUDT* retrieve(const sockaddr_any& addr, SRTSOCKET& id) const;
 
+    /// @brief Check if no socket is pending for connection.
+    bool empty() const;
+
     /// @brief Update status of connections in the pending queue.
     /// Stop connecting if TTL expires. Resend handshake request every 250 ms if no response from the peer.
     /// @param rst result of reading from a UDP socket: received packet / nothin read / read error.
@@ -391,10 +547,76 @@ private:
     mutable sync::Mutex m_RIDListLock;
 };
 
+class CSndQueue;
+
+/// A sending worker of the sender queue (see SRTO_SNDWORKERS). It schedules
+/// the sending for a subset of the sockets of a multiplexer, selected by the
+/// socket ID, using its own list and timer.
+class CSndQueueShard
+{
+    friend class CSndQueue;
+
+public:
+    /// @param [in] parent the sender queue
+    /// @param [in] t timer to use, or NULL to use an own one
+    CSndQueueShard(CSndQueue* parent, sync::CTimer* t);
+    ~CSndQueueShard();
+
+    void start(const std::string& thname);
+
+    std::string CONID() const { return ""; }
+
+private:
+    static void* worker(void* param);
+    sync::CThread m_WorkerThread;
+
+    // Subroutines of worker for batched sending
+    void worker_QueueBatch(const sockaddr_any& addr, CPacket& pkt, const sockaddr_any& src);
+    void worker_FlushBatch();
+
+private:
+    CSndQueue* const m_pParent;
+    sync::CTimer     m_OwnTimer;  // Used if no timer was given
+    sync::CTimer*    m_pTimer;    // Timing facility
+    CSndUList*       m_pSndUList; // List of UDT instances for data sending
+
+    // Data packets collected by the worker (see SRTO_UDP_SNDBATCH), copied
+    // in the network order into m_BatchStorage, as their payload is only
+    // borrowed from the sender buffer. The batch is flushed when it is full
+    // or when the next packet isn't due until the end of the time slice.
+    static const int SEND_BATCH_SLICE_US = 100;
+
+    int                            m_iBatchFill;
+    std::vector<char>              m_BatchStorage;
+    std::vector<CSendSlot>         m_vBatchSlots;
+    CSendBatchBuffers              m_BatchBuffers;
+    sync::steady_clock::time_point m_tsBatchDeadline;
+
+public:
+#if defined(SRT_DEBUG_SNDQ_HIGHRATE) //>>debug high freq worker
+    sync::steady_clock::duration m_DbgPeriod;
+    mutable sync::steady_clock::time_point m_DbgTime;
+    struct
+    {
+        unsigned long lIteration;   //
+        unsigned long lSleepTo;     // SleepTo
+        unsigned long lNotReadyPop; // Continue
+        unsigned long lSendTo;
+        unsigned long lNotReadyTs;
+        unsigned long lCondWait; // block on m_WindowCond
+    } mutable m_WorkerStats;
+#endif /* SRT_DEBUG_SNDQ_HIGHRATE */
+
+private:
+    CSndQueueShard(const CSndQueueShard&);
+    CSndQueueShard& operator=(const CSndQueueShard&);
+};
+
 class CSndQueue
 {
     friend class CUDT;
     friend class CUDTUnited;
+    friend class CSndQueueShard;
 
 public:
     CSndQueue();
@@ -410,7 +632,8 @@ public:
     /// Initialize the sending queue.
     /// @param [in] c UDP channel to be associated to the queue
     /// @param [in] t Timer
-    void init(CChannel* c, sync::CTimer* t);
+    /// @param [in] mcfg multiplexer configuration (batched sending, workers)
+    void init(CChannel* c, sync::CTimer* t, const CSrtMuxerConfig& mcfg);
 
     /// Send out a packet to a given address. The @a src parameter is
     /// blindly passed by the caller down the call with intention to
@@ -440,31 +663,16 @@ public:
 
     void setClosing() { m_bClosing = true; }
 
-private:
-    static void*  worker(void* param);
-    sync::CThread m_WorkerThread;
+    /// Get the list scheduling the sending for the given socket.
+    /// A socket is always handled by the same worker.
+    CSndUList* listOf(const CUDT* u) const;
 
 private:
-    CSndUList*    m_pSndUList; // List of UDT instances for data sending
-    CChannel*     m_pChannel;  // The UDP channel for data sending
-    sync::CTimer* m_pTimer;    // Timing facility
+    std::vector<CSndQueueShard*> m_vShards; // Sending workers (see SRTO_SNDWORKERS)
+    CChannel*                    m_pChannel; // The UDP channel for data sending
+    int                          m_iBatchSize; // Number of packets sent in one call (see SRTO_UDP_SNDBATCH)
 
-    sync::atomic<bool> m_bClosing;            // closing the worker
-
-public:
-#if defined(SRT_DEBUG_SNDQ_HIGHRATE) //>>debug high freq worker
-    sync::steady_clock::duration m_DbgPeriod;
-    mutable sync::steady_clock::time_point m_DbgTime;
-    struct
-    {
-        unsigned long lIteration;   //
-        unsigned long lSleepTo;     // SleepTo
-        unsigned long lNotReadyPop; // Continue
-        unsigned long lSendTo;
-        unsigned long lNotReadyTs;
-        unsigned long lCondWait; // block on m_WindowCond
-    } mutable m_WorkerStats;
-#endif /* SRT_DEBUG_SNDQ_HIGHRATE */
+    sync::atomic<bool> m_bClosing;            // closing the workers
 
 private:
 
@@ -476,8 +684,69 @@ private:
     CSndQueue& operator=(const CSndQueue&);
 };
 
+class CRcvQueue;
+
+/// A dispatch worker of the receiver queue (see SRTO_RCVWORKERS). It takes care
+/// of a subset of the connected sockets of a multiplexer, selected by the socket ID:
+/// it dispatches the packets read for them by the receiver queue thread and runs
+/// their periodic timer checks.
+class CRcvQueueShard
+{
+public:
+    CRcvQueueShard(CRcvQueue* parent);
+    ~CRcvQueueShard();
+
+    void start(const std::string& thname);
+
+    /// Pass a packet to be dispatched to the socket. The unit stays
+    /// reserved until the worker dispatches it.
+    void post(CUDT* u, CUnit* unit);
+
+    /// Start the timer checks for a newly connected socket.
+    void postInsert(CUDT* u);
+
+    /// Release the socket, already removed from the receiver queue, when all
+    /// packets posted before have been dispatched.
+    void postRelease(CUDT* u);
+
+    /// Schedule the timer checks of the socket again (see CRcvQueue::rescheduleTimers()).
+    void postReschedule(CUDT* u);
+
+    /// Pass the items posted so far to the worker thread.
+    void flush();
+
+private:
+    struct Item
+    {
+        enum Type { PACKET, INSERT, RELEASE, RESCHEDULE };
+
+        Type   m_Type;
+        CUDT*  m_pUDT;
+        CUnit* m_pUnit; // PACKET only
+    };
+
+    static void* worker(void* param);
+    void         dispatch(const Item& item);
+    void         checkTimers();
+
+    CRcvQueue* const   m_pParent;
+    CTimerWheel        m_Timers;    // Sockets of this worker, for the timer checks
+    std::vector<CRNode*> m_vDueTimers; // Sockets taken from m_Timers for the timer checks
+    std::vector<Item>  m_vPosted;   // Items not yet flushed (receiver queue thread only)
+    std::vector<Item>  m_vQueue;    // Items passed to the worker
+    sync::Mutex        m_QueueLock; // Protects m_vQueue
+    sync::Condition    m_QueueCond;
+    sync::CThread      m_WorkerThread;
+    sync::atomic<bool> m_bClosing;
+
+private:
+    CRcvQueueShard(const CRcvQueueShard&);
+    CRcvQueueShard& operator=(const CRcvQueueShard&);
+};
+
 class CRcvQueue
 {
+    friend class CRcvQueueShard;
     friend class CUDT;
     friend class CUDTUnited;
 
@@ -499,7 +768,8 @@ public:
     /// @param [in] hsize hash table size
     /// @param [in] c UDP channel to be associated to the queue
     /// @param [in] t timer
-    void init(int size, size_t payload, int version, int hsize, CChannel* c, sync::CTimer* t);
+    /// @param [in] mcfg multiplexer configuration (batch reading, dispatch workers)
+    void init(int size, size_t payload, int version, int hsize, CChannel* c, sync::CTimer* t, const CSrtMuxerConfig& mcfg);
 
     /// Read a packet for a specific UDT socket id.
     /// @param [in] id Socket ID
@@ -509,7 +779,7 @@ public:
 
     void stopWorker();
 
-    void setClosing() { m_bClosing = true; }
+    void setClosing();
 
     int getIPversion() { return m_iIPversion; }
 
@@ -517,14 +787,32 @@ private:
     static void*  worker(void* param);
     sync::CThread m_WorkerThread;
     // Subroutines of worker
-    EReadStatus    worker_RetrieveUnit(int32_t& id, CUnit*& unit, sockaddr_any& sa);
+    EReadStatus    worker_RetrieveUnits(int& w_nrecv);
     EConnectStatus worker_ProcessConnectionRequest(CUnit* unit, const sockaddr_any& sa);
     EConnectStatus worker_TryAsyncRend_OrStore(int32_t id, CUnit* unit, const sockaddr_any& sa);
     EConnectStatus worker_ProcessAddressedPacket(int32_t id, CUnit* unit, const sockaddr_any& sa);
+    void           worker_InsertNewEntry(CUDT* ne);
+    void           worker_InsertNewEntries();
+    void           worker_Reschedule();
+
+    /// Keep the channel supplied with the units to receive into, when it
+    /// receives into the packets lent to it (see CChannel::receivesLent()).
+    /// @return number of units lent to the channel
+    int worker_LendUnits();
+
+    /// Take back the units lent to the channel, which are released if @a reusable.
+    /// No more units are lent afterwards.
+    void worker_ReturnLentUnits(bool reusable);
+
+    /// The time to wait for the packets: until the first timer check is due.
+    int worker_WaitTime() const;
+
+    CRcvQueueShard* shardOf(const CUDT* u) const;
 
 private:
     CUnitQueue*   m_pUnitQueue; // The received packet queue
-    CRcvUList*    m_pRcvUList;  // List of UDT instances that will read packets from the queue
+    CTimerWheel*  m_pTimers;    // Timer checks of the UDT instances that will read packets from the queue
+    std::vector<CRNode*> m_vDueTimers; // UDT instances taken from m_pTimers for the timer checks
     CHash*        m_pHash;      // Hash table for UDT socket looking up
     CChannel*     m_pChannel;   // UDP channel for receiving packets
     sync::CTimer* m_pTimer;     // shared timer with the snd queue
@@ -532,6 +820,27 @@ private:
     int m_iIPversion;           // IP version
     size_t m_szPayloadSize;     // packet payload size
 
+    // Units being read in one batch by the worker (see SRTO_UDP_RCVBATCH).
+    // Units not yet dispatched stay reserved so that they are not
+    // given away by CUnitQueue::getNextAvailUnit() in the meantime.
+    int                       m_iBatchSize;
+    std::vector<CUnit*>       m_vBatchUnits;
+    std::vector<CPacket*>     m_vBatchPackets;
+    std::vector<sockaddr_any> m_vBatchAddrs;
+    std::vector<EReadStatus>  m_vBatchStatus;
+
+    // Units lent to the channel to receive into, by number, and the numbers
+    // not in use. These also stay reserved until dispatched.
+    std::vector<CUnit*> m_vLentUnits;
+    std::vector<int>    m_vUnlentIds;
+    std::vector<int>    m_vBatchIds; // Numbers of the units received into
+
+    // Dispatch workers, if configured (see SRTO_RCVWORKERS). In this case the
+    // worker only reads the packets and looks up the destination socket, and
+    // m_pTimers isn't used. A unit passed to a shard stays reserved.
+    std::vector<CRcvQueueShard*> m_vShards;
+    bool                         m_bUnitPosted; // The last dispatched unit was passed to a shard
+
     sync::atomic<bool> m_bClosing; // closing the worker
 #if ENABLE_LOGGING
     static srt::sync::atomic<int> m_counter; // A static counter to log RcvQueue worker thread number.
@@ -551,6 +860,15 @@ private:
     bool  ifNewEntry();
     CUDT* getNewEntry();
 
+    // Called by a shard for a socket found broken; the worker will
+    // remove it from m_pHash and then release it in the shard.
+    void  setRemovedEntry(CUDT* u);
+
+    /// Have the timer checks of the socket scheduled again, as its state was
+    /// changed by another thread (see CUDT::rescheduleTimers()). Ignored if
+    /// the socket isn't in the queue.
+    void rescheduleTimers(SRTSOCKET id);
+
     void storePktClone(int32_t id, const CPacket& pkt);
 
 private:
@@ -558,7 +876,10 @@ private:
     CUDT*             m_pListener;        // pointer to the (unique, if any) listening UDT entity
     CRendezvousQueue* m_pRendezvousQueue; // The list of sockets in rendezvous mode
 
-    std::vector<CUDT*> m_vNewEntry; // newly added entries, to be inserted
+    std::vector<CUDT*> m_vNewEntry;     // newly added entries, to be inserted
+    std::vector<CUDT*> m_vRemovedEntry; // entries removed by shards, to be removed from m_pHash
+    std::vector<SRTSOCKET> m_vRescheduled;  // sockets to schedule the timer checks again for
+    std::vector<SRTSOCKET> m_vRescheduling; // m_vRescheduled taken by the worker
     sync::Mutex        m_IDLock;
 
     std::map<int32_t, std::queue<CPacket*> > m_mBuffer; // temporary buffer for rendezvous connection request
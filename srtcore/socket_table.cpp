@@ -0,0 +1,282 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#include "platform_sys.h"
+
+#include "socket_table.h"
+#include "api.h"
+
+using namespace std;
+
+namespace srt
+{
+
+namespace
+{
+const size_t MIN_TABLE_SIZE = 256;
+
+// The socket IDs are generated one after another, so the low bits
+// of the ID spread them over the table without collisions.
+inline size_t slotOf(SRTSOCKET u, size_t mask)
+{
+    return size_t(uint32_t(u)) & mask;
+}
+} // namespace
+
+CSocketTable::Array::Array(size_t size)
+    : mask(size - 1)
+    , slots(new Slot[size])
+{
+}
+
+CSocketTable::Array::~Array()
+{
+    delete[] slots;
+}
+
+CSocketTable::CSocketTable()
+    : m_pArray(new Array(MIN_TABLE_SIZE))
+    , m_zLive(0)
+    , m_zUsed(0)
+    , m_iEpoch(0)
+{
+}
+
+CSocketTable::~CSocketTable()
+{
+    clear();
+    delete m_pArray.load();
+}
+
+CSocketTable::Reader::Reader(const CSocketTable& table, SRTSOCKET u)
+    : m_pCount(NULL)
+    , m_pSocket(NULL)
+{
+    const size_t stripe = size_t(uint32_t(u)) % STRIPES;
+    for (;;)
+    {
+        // If the epoch has changed before the reader was counted, the
+        // thread that advanced it might have not seen the count. Count
+        // the reader in the new epoch then.
+        const uint32_t epoch = table.m_iEpoch.load();
+        m_pCount             = &table.m_Readers[epoch & 1][stripe].count;
+        ++*m_pCount;
+        if (table.m_iEpoch.load() == epoch)
+            break;
+        --*m_pCount;
+    }
+
+    m_pSocket = table.lookup(u);
+}
+
+CSocketTable::Reader::~Reader()
+{
+    --*m_pCount;
+}
+
+CUDTSocket* CSocketTable::lookup(SRTSOCKET u) const
+{
+    // There's always a free slot in the array, which ends the search.
+    const Array* a = m_pArray.load();
+    for (size_t i = slotOf(u, a->mask);; i = (i + 1) & a->mask)
+    {
+        const SRTSOCKET id = a->slots[i].id.load();
+        if (id == 0)
+            return NULL;
+        if (id == u)
+        {
+            // The slot of a removed socket may be just reused for another
+            // one, after the ID was read.
+            CUDTSocket* s = a->slots[i].socket.load();
+            return (s && s->m_SocketID == u) ? s : NULL;
+        }
+    }
+}
+
+// [[using locked(CUDTUnited::m_GlobControlLock)]]
+void CSocketTable::insert(SRTSOCKET u, CUDTSocket* s)
+{
+    // Keep at least a quarter of the slots free, so that
+    // the search ends early.
+    Array* a = m_pArray.load();
+    if ((m_zUsed + 1) * 4 > (a->mask + 1) * 3)
+    {
+        grow();
+        a = m_pArray.load();
+    }
+
+    // Find the slot with this ID, or the first slot of a removed
+    // socket, but only if the ID isn't further on.
+    Slot* reuse = NULL;
+    size_t i = slotOf(u, a->mask);
+    for (;; i = (i + 1) & a->mask)
+    {
+        const SRTSOCKET id = a->slots[i].id.load();
+        if (id == u)
+        {
+            reuse = &a->slots[i];
+            break;
+        }
+        if (id == 0)
+            break;
+        if (!reuse && a->slots[i].socket.load() == NULL)
+            reuse = &a->slots[i];
+    }
+
+    Slot* slot = reuse ? reuse : &a->slots[i];
+    if (slot->id.load() == 0)
+        ++m_zUsed;
+    if (slot->socket.load() == NULL)
+        ++m_zLive;
+
+    // The ID goes first so that the readers of the previous ID
+    // of a reused slot can't see this socket.
+    slot->id.store(u);
+    slot->socket.store(s);
+}
+
+// [[using locked(CUDTUnited::m_GlobControlLock)]]
+void CSocketTable::grow()
+{
+    Array* old  = m_pArray.load();
+    size_t size = MIN_TABLE_SIZE;
+    while ((m_zLive + 1) * 2 > size)
+        size *= 2;
+
+    Array* a = new Array(size);
+    for (size_t i = 0; i <= old->mask; ++i)
+    {
+        CUDTSocket* s = old->slots[i].socket.load();
+        if (!s)
+            continue;
+
+        const SRTSOCKET u = old->slots[i].id.load();
+        size_t          j = slotOf(u, a->mask);
+        while (a->slots[j].id.load() != 0)
+            j = (j + 1) & a->mask;
+        a->slots[j].id.store(u);
+        a->slots[j].socket.store(s);
+    }
+
+    try
+    {
+        m_RetiredArrays.push_back(make_pair(old, m_iEpoch.load()));
+    }
+    catch (...)
+    {
+        delete a;
+        throw;
+    }
+
+    m_pArray.store(a);
+    m_zUsed = m_zLive;
+}
+
+// [[using locked(CUDTUnited::m_GlobControlLock)]]
+void CSocketTable::remove(CUDTSocket* s)
+{
+    const Array* a = m_pArray.load();
+    for (size_t i = slotOf(s->m_SocketID, a->mask);; i = (i + 1) & a->mask)
+    {
+        const SRTSOCKET id = a->slots[i].id.load();
+        if (id == 0)
+            return;
+        if (id == s->m_SocketID)
+        {
+            if (a->slots[i].socket.load() == s)
+            {
+                a->slots[i].socket.store(NULL);
+                --m_zLive;
+            }
+            return;
+        }
+    }
+}
+
+// [[using locked(CUDTUnited::m_GlobControlLock)]]
+bool CSocketTable::release(CUDTSocket* s)
+{
+    map<CUDTSocket*, uint32_t>::iterator i = m_Released.find(s);
+    if (i == m_Released.end())
+    {
+        remove(s);
+        m_Released[s] = m_iEpoch.load();
+        return false;
+    }
+
+    if (!reclaimable(i->second))
+        return false;
+
+    m_Released.erase(i);
+    return true;
+}
+
+// [[using locked(CUDTUnited::m_GlobControlLock)]]
+void CSocketTable::dispose(CUDTSocket* s)
+{
+    remove(s);
+    m_Disposed.push_back(make_pair(s, m_iEpoch.load()));
+}
+
+bool CSocketTable::hasReaders(uint32_t epoch) const
+{
+    for (size_t i = 0; i < STRIPES; ++i)
+    {
+        if (m_Readers[epoch & 1][i].count.load() != 0)
+            return true;
+    }
+    return false;
+}
+
+// [[using locked(CUDTUnited::m_GlobControlLock)]]
+void CSocketTable::collect()
+{
+    // The readers are only in the current and the previous epoch, so the
+    // counters of the previous one can be taken over by the next one when
+    // they are all gone.
+    const uint32_t epoch = m_iEpoch.load();
+    if (!hasReaders(epoch - 1))
+        m_iEpoch.store(epoch + 1);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < m_RetiredArrays.size(); ++i)
+    {
+        if (reclaimable(m_RetiredArrays[i].second))
+            delete m_RetiredArrays[i].first;
+        else
+            m_RetiredArrays[kept++] = m_RetiredArrays[i];
+    }
+    m_RetiredArrays.resize(kept);
+
+    kept = 0;
+    for (size_t i = 0; i < m_Disposed.size(); ++i)
+    {
+        if (reclaimable(m_Disposed[i].second))
+            delete m_Disposed[i].first;
+        else
+            m_Disposed[kept++] = m_Disposed[i];
+    }
+    m_Disposed.resize(kept);
+}
+
+void CSocketTable::clear()
+{
+    for (size_t i = 0; i < m_RetiredArrays.size(); ++i)
+        delete m_RetiredArrays[i].first;
+    m_RetiredArrays.clear();
+
+    for (size_t i = 0; i < m_Disposed.size(); ++i)
+        delete m_Disposed[i].first;
+    m_Disposed.clear();
+
+    m_Released.clear();
+}
+
+} // namespace srt
@@ -0,0 +1,133 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#ifndef INC_SRT_SOCKET_TABLE_H
+#define INC_SRT_SOCKET_TABLE_H
+
+#include <map>
+#include <vector>
+#include "srt.h"
+#include "sync.h"
+
+namespace srt
+{
+
+class CUDTSocket;
+
+/// @brief The handle table of the sockets, for the lookup by the API calls
+/// without locking CUDTUnited::m_GlobControlLock.
+///
+/// The table is a hash table with linear probing, where the removed entries
+/// are left as empty socket pointers under their IDs. The readers find the
+/// sockets with atomic loads only; when the table grows, the new array is
+/// published atomically. The writers are serialized by m_GlobControlLock.
+///
+/// The arrays and the sockets removed from the table are freed with the
+/// epoch-based reclamation: the readers are counted per epoch, and
+/// CUDTUnited::checkBrokenSockets() advances the epoch when the readers of
+/// the previous one are gone. Whatever was removed in the epoch N can't be
+/// seen by any reader in the epoch N+2.
+class CSocketTable
+{
+public:
+    CSocketTable();
+    ~CSocketTable();
+
+    /// Looks up a socket, keeping it from being deleted for the lifetime
+    /// of the object. Intended to be used as a local variable.
+    class Reader
+    {
+    public:
+        Reader(const CSocketTable& table, SRTSOCKET u);
+        ~Reader();
+
+        /// The socket found, or NULL.
+        CUDTSocket* socket() const { return m_pSocket; }
+
+    private:
+        sync::atomic<int>* m_pCount;
+        CUDTSocket*        m_pSocket;
+
+        Reader(const Reader&);
+        Reader& operator=(const Reader&);
+    };
+
+    // The functions below are to be called with CUDTUnited::m_GlobControlLock locked.
+
+    /// Add the socket under the ID @a u.
+    void insert(SRTSOCKET u, CUDTSocket* s);
+
+    /// Remove the socket from the table, if it's still there.
+    /// @return true if no reader can be using the socket any more,
+    /// so it can be deleted; otherwise call again later.
+    bool release(CUDTSocket* s);
+
+    /// Remove the socket from the table and delete it when
+    /// no reader can be using it any more.
+    void dispose(CUDTSocket* s);
+
+    /// Start the next epoch, if possible, and free what can be freed.
+    void collect();
+
+    /// Free everything without waiting for the readers.
+    void clear();
+
+    /// The number of sockets in the table.
+    size_t size() const { return m_zLive; }
+
+private:
+    struct Slot
+    {
+        sync::atomic<SRTSOCKET>   id;     //< 0 if never used
+        sync::atomic<CUDTSocket*> socket; //< NULL if removed
+    };
+
+    struct Array
+    {
+        Array(size_t size);
+        ~Array();
+
+        size_t mask;
+        Slot*  slots;
+    };
+
+    // Readers are counted separately for the sockets in different stripes,
+    // so that the API calls for different sockets don't share a cache line.
+    static const size_t STRIPES = 16;
+    struct ReaderCount
+    {
+        sync::atomic<int> count;
+        char              pad[64 - sizeof(sync::atomic<int>) % 64];
+    };
+
+    CUDTSocket* lookup(SRTSOCKET u) const;
+    void        remove(CUDTSocket* s);
+    void        grow();
+    bool        hasReaders(uint32_t epoch) const;
+    bool        reclaimable(uint32_t epoch) const { return m_iEpoch.load() - epoch >= 2; }
+
+    sync::atomic<Array*>   m_pArray;
+    size_t                 m_zLive; // Slots with a socket
+    size_t                 m_zUsed; // Slots with an ID, including the removed sockets
+    sync::atomic<uint32_t> m_iEpoch;
+    mutable ReaderCount    m_Readers[2][STRIPES];
+
+    // The removed things, with the epoch of the removal
+    std::vector<std::pair<Array*, uint32_t> >      m_RetiredArrays;
+    std::map<CUDTSocket*, uint32_t>                m_Released;
+    std::vector<std::pair<CUDTSocket*, uint32_t> > m_Disposed;
+
+    CSocketTable(const CSocketTable&);
+    CSocketTable& operator=(const CSocketTable&);
+};
+
+} // namespace srt
+
+#endif
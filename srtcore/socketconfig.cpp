@@ -51,6 +51,7 @@ written by
 
 #include "srt.h"
 #include "socketconfig.h"
+#include "inproc.h"
 
 namespace srt
 {
@@ -173,6 +174,103 @@ struct CSrtConfigSetter<SRTO_UDP_RCVBUF>
         co.iUDPRcvBufSize = std::max(co.iMSS, cast_optval<int>(optval, optlen));
     }
 };
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_RCVBATCH>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtMuxerConfig::MAX_UDP_BATCH)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iUDPRcvBatch = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_SNDBATCH>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtMuxerConfig::MAX_UDP_BATCH)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iUDPSndBatch = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_RCVWORKERS>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtMuxerConfig::MAX_QUEUE_WORKERS)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iRcvWorkers = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_SNDWORKERS>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < 1 || val > CSrtMuxerConfig::MAX_QUEUE_WORKERS)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iSndWorkers = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_RCVUNITS>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        const int val = cast_optval<int>(optval, optlen);
+        if (val < CSrtMuxerConfig::MIN_RCV_UNITS || val > CSrtMuxerConfig::MAX_RCV_UNITS)
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+
+        co.iRcvUnits = val;
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_UDP_IOURING>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        co.bUDPIoUring = cast_optval<bool>(optval, optlen);
+    }
+};
+
+template<>
+struct CSrtConfigSetter<SRTO_INPROC_LINK>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        using namespace srt_logging;
+        std::string val;
+        if (optlen == -1)
+            val = (const char*)optval;
+        else
+            val.assign((const char*)optval, optlen);
+
+        CInprocLinkModel model;
+        if (!val.empty() && !CInprocLinkModel::parse(val, (model)))
+        {
+            LOGC(kmlog.Error, log << "SRTO_INPROC_LINK: Incorrect syntax. Use: on, or KEY:VALUE[,KEY:VALUE...]");
+            throw CUDTException(MJ_NOTSUP, MN_INVAL, 0);
+        }
+
+        co.sInprocLink = val;
+    }
+};
 template<>
 struct CSrtConfigSetter<SRTO_RENDEZVOUS>
 {
@@ -888,6 +986,15 @@ struct CSrtConfigSetter<SRTO_GROUPMINSTABLETIMEO>
         LOGC(smlog.Error, log << "SRTO_GROUPMINSTABLETIMEO set " << val_ms);
     }
 };
+
+template<>
+struct CSrtConfigSetter<SRTO_GROUPRCVBUF>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        co.bGroupRcvBuffer = cast_optval<bool>(optval, optlen);
+    }
+};
 #endif
 
 template<>
@@ -937,6 +1044,15 @@ struct CSrtConfigSetter<SRTO_CRYPTOMODE>
 };
 #endif
 
+template<>
+struct CSrtConfigSetter<SRTO_CRYPTOAHEAD>
+{
+    static void set(CSrtConfig& co, const void* optval, int optlen)
+    {
+        co.bCryptoAhead = cast_optval<bool>(optval, optlen);
+    }
+};
+
 int dispatchSet(SRT_SOCKOPT optName, CSrtConfig& co, const void* optval, int optlen)
 {
     switch (optName)
@@ -950,6 +1066,13 @@ int dispatchSet(SRT_SOCKOPT optName, CSrtConfig& co, const void* optval, int opt
         DISPATCH(SRTO_LINGER);
         DISPATCH(SRTO_UDP_SNDBUF);
         DISPATCH(SRTO_UDP_RCVBUF);
+        DISPATCH(SRTO_UDP_RCVBATCH);
+        DISPATCH(SRTO_UDP_SNDBATCH);
+        DISPATCH(SRTO_RCVWORKERS);
+        DISPATCH(SRTO_SNDWORKERS);
+        DISPATCH(SRTO_RCVUNITS);
+        DISPATCH(SRTO_UDP_IOURING);
+        DISPATCH(SRTO_INPROC_LINK);
         DISPATCH(SRTO_RENDEZVOUS);
         DISPATCH(SRTO_SNDTIMEO);
         DISPATCH(SRTO_RCVTIMEO);
@@ -986,6 +1109,7 @@ int dispatchSet(SRT_SOCKOPT optName, CSrtConfig& co, const void* optval, int opt
 #if ENABLE_BONDING
         DISPATCH(SRTO_GROUPCONNECT);
         DISPATCH(SRTO_GROUPMINSTABLETIMEO);
+        DISPATCH(SRTO_GROUPRCVBUF);
 #endif
         DISPATCH(SRTO_KMREFRESHRATE);
         DISPATCH(SRTO_KMPREANNOUNCE);
@@ -997,6 +1121,7 @@ int dispatchSet(SRT_SOCKOPT optName, CSrtConfig& co, const void* optval, int opt
 #ifdef ENABLE_AEAD_API_PREVIEW
         DISPATCH(SRTO_CRYPTOMODE);
 #endif
+        DISPATCH(SRTO_CRYPTOAHEAD);
 #ifdef ENABLE_MAXREXMITBW
         DISPATCH(SRTO_MAXREXMITBW);
 #endif
@@ -1095,6 +1220,12 @@ bool SRT_SocketOptionObject::add(SRT_SOCKOPT optname, const void* optval, size_t
         //SRTO_TSBPDMODE - per transmission setting
     case SRTO_UDP_RCVBUF:
     case SRTO_UDP_SNDBUF:
+    case SRTO_UDP_RCVBATCH:
+    case SRTO_UDP_SNDBATCH:
+    case SRTO_RCVWORKERS:
+    case SRTO_SNDWORKERS:
+    case SRTO_RCVUNITS:
+    case SRTO_UDP_IOURING:
         break;
 
     default:
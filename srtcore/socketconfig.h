@@ -79,6 +79,11 @@ namespace srt
 struct CSrtMuxerConfig
 {
     static const int DEF_UDP_BUFFER_SIZE = 65536;
+    static const int MAX_UDP_BATCH = 64; // Maximum number of packets in one batched UDP call
+    static const int MAX_QUEUE_WORKERS = 16; // Maximum number of worker threads of a queue
+    static const int DEF_RCV_UNITS = 128; // Default number of packet units preallocated for receiving
+    static const int MIN_RCV_UNITS = 32;
+    static const int MAX_RCV_UNITS = 1024 * 1024;
 
     int  iIpTTL;
     int  iIpToS;
@@ -90,6 +95,13 @@ struct CSrtMuxerConfig
 #endif
     int iUDPSndBufSize; // UDP sending buffer size
     int iUDPRcvBufSize; // UDP receiving buffer size
+    int iUDPRcvBatch;   // Number of UDP packets read from the system in one call
+    int iUDPSndBatch;   // Number of UDP packets sent to the system in one call
+    int iRcvWorkers;    // Number of threads dispatching the received packets
+    int iSndWorkers;    // Number of threads scheduling the sending
+    int iRcvUnits;      // Number of packet units preallocated for receiving
+    bool bUDPIoUring;   // Use io_uring for the UDP I/O, if available
+    std::string sInprocLink; // Configuration of the in-process link used instead of UDP (empty: UDP)
 
     // NOTE: this operator is not reversable. The syntax must use:
     //  muxer_entry == socket_entry
@@ -104,6 +116,13 @@ struct CSrtMuxerConfig
 #endif
             && CEQUAL(iUDPSndBufSize)
             && CEQUAL(iUDPRcvBufSize)
+            && CEQUAL(iUDPRcvBatch)
+            && CEQUAL(iUDPSndBatch)
+            && CEQUAL(iRcvWorkers)
+            && CEQUAL(iSndWorkers)
+            && CEQUAL(iRcvUnits)
+            && CEQUAL(bUDPIoUring)
+            && CEQUAL(sInprocLink)
             && (other.iIpV6Only == -1 || CEQUAL(iIpV6Only))
             // NOTE: iIpV6Only is not regarded because
             // this matches only in case of IPv6 with "any" address.
@@ -121,6 +140,12 @@ struct CSrtMuxerConfig
         , bReuseAddr(true) // This is default in SRT
         , iUDPSndBufSize(DEF_UDP_BUFFER_SIZE)
         , iUDPRcvBufSize(DEF_UDP_BUFFER_SIZE)
+        , iUDPRcvBatch(1)
+        , iUDPSndBatch(1)
+        , iRcvWorkers(1)
+        , iSndWorkers(1)
+        , iRcvUnits(DEF_RCV_UNITS)
+        , bUDPIoUring(false)
     {
     }
 };
@@ -251,8 +276,10 @@ struct CSrtConfig: CSrtMuxerConfig
     int      iGroupConnect;    // 1 - allow group connections
     int      iPeerIdleTimeout_ms; // Timeout for hearing anything from the peer (ms).
     uint32_t uMinStabilityTimeout_ms;
+    bool     bGroupRcvBuffer; // SRTO_GROUPRCVBUF
     int      iRetransmitAlgo;
     int      iCryptoMode; // SRTO_CRYPTOMODE
+    bool     bCryptoAhead; // SRTO_CRYPTOAHEAD
 
     int64_t llInputBW;         // Input stream rate (bytes/sec). 0: use internally estimated input bandwidth
     int64_t llMinInputBW;      // Minimum input stream rate estimate (bytes/sec)
@@ -306,8 +333,10 @@ struct CSrtConfig: CSrtMuxerConfig
         , iGroupConnect(0)
         , iPeerIdleTimeout_ms(COMM_RESPONSE_TIMEOUT_MS)
         , uMinStabilityTimeout_ms(COMM_DEF_MIN_STABILITY_TIMEOUT_MS)
+        , bGroupRcvBuffer(false)
         , iRetransmitAlgo(1)
         , iCryptoMode(CIPHER_MODE_AUTO)
+        , bCryptoAhead(false)
         , llInputBW(0)
         , llMinInputBW(0)
         , iOverheadBW(25)
@@ -245,6 +245,15 @@ typedef enum SRT_SOCKOPT {
 #ifdef ENABLE_MAXREXMITBW
    SRTO_MAXREXMITBW = 63,    // Maximum bandwidth limit for retransmision (Bytes/s)
 #endif
+   SRTO_UDP_RCVBATCH = 64,   // Maximum number of UDP packets read from the system in one call (recvmmsg)
+   SRTO_UDP_SNDBATCH = 65,   // Maximum number of UDP packets sent to the system in one call (sendmmsg/GSO)
+   SRTO_RCVWORKERS = 66,     // Number of threads dispatching the received packets to the sockets of a multiplexer
+   SRTO_SNDWORKERS = 67,     // Number of threads scheduling the sending for the sockets of a multiplexer
+   SRTO_RCVUNITS = 68,       // Number of packet units allocated for receiving when creating a multiplexer
+   SRTO_CRYPTOAHEAD = 69,    // Encrypt the payload when scheduled for sending, instead of when sent
+   SRTO_UDP_IOURING = 70,    // Use io_uring for the UDP reading and sending of a multiplexer (Linux)
+   SRTO_INPROC_LINK = 71,    // Connect the multiplexer to the in-process link instead of UDP, with the given impairments
+   SRTO_GROUPRCVBUF = 72,    // Receive the packets of all group members into one receiver buffer of the group
 
    SRTO_E_SIZE // Always last element, not a valid option.
 } SRT_SOCKOPT;
@@ -413,6 +422,13 @@ struct CBytePerfMon
    int64_t  pktRecvUnique;              // number of packets to be received by the application
    uint64_t byteSentUnique;             // number of data bytes, sent by the application
    uint64_t byteRecvUnique;             // number of data bytes to be received by the application
+
+   // New stats in 1.5.4
+
+   // Instant (shared by all sockets of the multiplexer)
+   int      pktRcvUnitsCapacity;        // number of packet units allocated for receiving
+   int      pktRcvUnitsInUse;           // number of packet units held by the receiver buffers
+   int      pktRcvUnitsMaxInUse;        // the highest pktRcvUnitsInUse since the multiplexer was created
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -754,6 +770,10 @@ static const int SRT_ERROR = -1;
 
 // library initialization
 SRT_API       int srt_startup(void);
+// Like srt_startup(), but the TSBPD delivery of all receiving sockets is done
+// by a shared pool of tsbpd_workers threads instead of a thread per socket.
+// With 0 it's the same as srt_startup(). Effective only for the first startup.
+SRT_API       int srt_startup_tsbpd(int tsbpd_workers);
 SRT_API       int srt_cleanup(void);
 
 //
@@ -847,6 +867,23 @@ SRT_API int srt_send    (SRTSOCKET u, const char* buf, int len);
 SRT_API int srt_sendmsg (SRTSOCKET u, const char* buf, int len, int ttl/* = -1*/, int inorder/* = false*/);
 SRT_API int srt_sendmsg2(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL *mctrl);
 
+// Scatter-gather: the message is sent from, or received into, several blocks.
+// SRT_IOVEC has the same layout as struct iovec.
+typedef struct SRT_IoVec
+{
+    void* base;
+    size_t len;
+} SRT_IOVEC;
+
+SRT_API int srt_sendmsgv(SRTSOCKET u, const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL *mctrl);
+
+// Zero-copy sending: the data are not copied into the sender buffer, but the buffer
+// is referred to until the packets are acknowledged or dropped, and then returned
+// to the application by calling release_fn.
+typedef void srt_send_release_fn(void* opaq, const char* buf, int len);
+SRT_API int srt_sendmsg_zerocopy(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL *mctrl,
+                                 srt_send_release_fn* release_fn, void* release_opaque);
+
 //
 // Receiving functions
 //
@@ -855,6 +892,26 @@ SRT_API int srt_recv    (SRTSOCKET u, char* buf, int len);
 // srt_recvmsg is actually an alias to srt_recv, it stays under the old name for compat reasons.
 SRT_API int srt_recvmsg (SRTSOCKET u, char* buf, int len);
 SRT_API int srt_recvmsg2(SRTSOCKET u, char *buf, int len, SRT_MSGCTRL *mctrl);
+SRT_API int srt_recvmsgv(SRTSOCKET u, const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL *mctrl);
+
+// Zero-copy receiving: the message is not copied out of the receiver buffer, but
+// the application gets the segments of it (one per packet) and borrows the buffers
+// holding them, until the message is returned by srt_recvmsg_release.
+typedef struct SRT_MsgSegment
+{
+    const char* data;
+    int len;
+} SRT_MSGSEGMENT;
+
+typedef struct SRT_MsgLoan
+{
+    const SRT_MSGSEGMENT* segments; // Segments of the message, in order
+    int nsegments;                  // Number of segments
+    void* handle;                   // For internal use
+} SRT_MSGLOAN;
+
+SRT_API int srt_recvmsg_borrow(SRTSOCKET u, SRT_MSGLOAN *loan, SRT_MSGCTRL *mctrl);
+SRT_API int srt_recvmsg_release(SRTSOCKET u, SRT_MSGLOAN *loan);
 
 
 // Special send/receive functions for files only.
@@ -904,6 +961,11 @@ SRT_API int srt_epoll_uwait(int eid, SRT_EPOLL_EVENT* fdsSet, int fdsSize, int64
 SRT_API int32_t srt_epoll_set(int eid, int32_t flags);
 SRT_API int srt_epoll_release(int eid);
 
+// Returns a system descriptor that is readable as long as any SRT socket
+// event is ready in the given EID, to be polled together with other system
+// descriptors (Linux only). The descriptor is owned by the EID.
+SRT_API int srt_epoll_notify_fd(int eid);
+
 // Logging control
 
 SRT_API void srt_setloglevel(int ll);
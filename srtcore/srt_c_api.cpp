@@ -30,6 +30,12 @@ using namespace srt;
 extern "C" {
 
 int srt_startup() { return CUDT::startup(); }
+int srt_startup_tsbpd(int tsbpd_workers)
+{
+    if (tsbpd_workers < 0)
+        return CUDT::APIError(MJ_NOTSUP, MN_INVAL, 0);
+    return CUDT::startup(tsbpd_workers);
+}
 int srt_cleanup() { return CUDT::cleanup(); }
 
 // Socket creation.
@@ -147,13 +153,20 @@ int srt_close(SRTSOCKET u)
     SRT_SOCKSTATUS st = srt_getsockstate(u);
 
     if ((st == SRTS_NONEXIST) ||
-        (st == SRTS_CLOSED)   ||
         (st == SRTS_CLOSING) )
     {
         // It's closed already. Do nothing.
         return 0;
     }
 
+    if (st == SRTS_CLOSED)
+    {
+        // Closed by the GC after it broke, but still to be removed from
+        // the EIDs. It may be gone in the meantime, which is no error.
+        CUDT::close(u);
+        return 0;
+    }
+
     return CUDT::close(u);
 }
 
@@ -231,6 +244,34 @@ int srt_sendmsg2(SRTSOCKET u, const char * buf, int len, SRT_MSGCTRL *mctrl)
     return CUDT::sendmsg2(u, buf, len, (mignore));
 }
 
+int srt_sendmsg_zerocopy(SRTSOCKET u, const char* buf, int len, SRT_MSGCTRL* mctrl,
+                         srt_send_release_fn* release_fn, void* release_opaque)
+{
+    if (!release_fn)
+        return CUDT::APIError(MJ_NOTSUP, MN_INVAL, 0);
+
+    if (mctrl)
+        return CUDT::sendmsg2(u, buf, len, (*mctrl), release_fn, release_opaque);
+    SRT_MSGCTRL mignore = srt_msgctrl_default;
+    return CUDT::sendmsg2(u, buf, len, (mignore), release_fn, release_opaque);
+}
+
+int srt_sendmsgv(SRTSOCKET u, const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL *mctrl)
+{
+    if (mctrl)
+        return CUDT::sendmsgv(u, iov, iovcnt, (*mctrl));
+    SRT_MSGCTRL mignore = srt_msgctrl_default;
+    return CUDT::sendmsgv(u, iov, iovcnt, (mignore));
+}
+
+int srt_recvmsgv(SRTSOCKET u, const SRT_IOVEC* iov, int iovcnt, SRT_MSGCTRL *mctrl)
+{
+    if (mctrl)
+        return CUDT::recvmsgv(u, iov, iovcnt, (*mctrl));
+    SRT_MSGCTRL mignore = srt_msgctrl_default;
+    return CUDT::recvmsgv(u, iov, iovcnt, (mignore));
+}
+
 int srt_recvmsg2(SRTSOCKET u, char * buf, int len, SRT_MSGCTRL *mctrl)
 {
     if (mctrl)
@@ -239,6 +280,24 @@ int srt_recvmsg2(SRTSOCKET u, char * buf, int len, SRT_MSGCTRL *mctrl)
     return CUDT::recvmsg2(u, buf, len, (mignore));
 }
 
+int srt_recvmsg_borrow(SRTSOCKET u, SRT_MSGLOAN* loan, SRT_MSGCTRL* mctrl)
+{
+    if (!loan)
+        return CUDT::APIError(MJ_NOTSUP, MN_INVAL, 0);
+
+    if (mctrl)
+        return CUDT::recvmsgBorrow(u, (*loan), (*mctrl));
+    SRT_MSGCTRL mignore = srt_msgctrl_default;
+    return CUDT::recvmsgBorrow(u, (*loan), (mignore));
+}
+
+int srt_recvmsg_release(SRTSOCKET u, SRT_MSGLOAN* loan)
+{
+    if (!loan)
+        return CUDT::APIError(MJ_NOTSUP, MN_INVAL, 0);
+    return CUDT::recvmsgRelease(u, (*loan));
+}
+
 const char* srt_getlasterror_str() { return UDT::getlasterror().getErrorMessage(); }
 
 int srt_getlasterror(int* loc_errno)
@@ -340,6 +399,8 @@ int32_t srt_epoll_set(int eid, int32_t flags) { return CUDT::epoll_set(eid, flag
 
 int srt_epoll_release(int eid) { return CUDT::epoll_release(eid); }
 
+int srt_epoll_notify_fd(int eid) { return CUDT::epoll_notify_fd(eid); }
+
 void srt_setloglevel(int ll)
 {
     UDT::setloglevel(srt_logging::LogLevel::type(ll));
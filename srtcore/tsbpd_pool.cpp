@@ -0,0 +1,205 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#include "platform_sys.h"
+
+#include "tsbpd_pool.h"
+#include "core.h"
+#include "logging.h"
+#include "logger_defs.h"
+
+using namespace std;
+using namespace srt_logging;
+using namespace srt::sync;
+
+namespace srt
+{
+
+CTsbPdPool::CTsbPdPool()
+    : m_iNextSchedule(0)
+    , m_bClosing(false)
+    , m_bRunning(false)
+{
+    setupCond(m_WorkCond, "TsbPdPoolWork");
+    setupCond(m_IdleCond, "TsbPdPoolIdle");
+}
+
+CTsbPdPool::~CTsbPdPool()
+{
+    stop();
+    releaseCond(m_WorkCond);
+    releaseCond(m_IdleCond);
+}
+
+bool CTsbPdPool::start(int nworkers)
+{
+    ScopedLock lk(m_Lock);
+    m_bClosing = false;
+    for (int i = 0; i < nworkers; ++i)
+    {
+        CThread* th = new CThread;
+        if (!StartThread(*th, CTsbPdPool::worker, this, "SRT:TsbPd." + Sprint(i)))
+        {
+            delete th;
+            LOGC(inlog.Error, log << "TSBPD pool: failed to start worker " << i);
+            m_bClosing = true;
+            break;
+        }
+        m_Workers.push_back(th);
+    }
+
+    if (m_bClosing)
+    {
+        InvertedLock unlk(m_Lock);
+        stop();
+        return false;
+    }
+
+    m_bRunning = true;
+    HLOGC(inlog.Debug, log << "TSBPD pool: started " << nworkers << " workers");
+    return true;
+}
+
+void CTsbPdPool::stop()
+{
+    {
+        ScopedLock lk(m_Lock);
+        m_bRunning = false;
+        m_bClosing = true;
+        m_WorkCond.notify_all();
+    }
+
+    for (size_t i = 0; i < m_Workers.size(); ++i)
+    {
+        m_Workers[i]->join();
+        delete m_Workers[i];
+    }
+    m_Workers.clear();
+
+    // Sockets still registered here are no longer served.
+    ScopedLock lk(m_Lock);
+    m_Sockets.clear();
+    m_Deadlines = std::priority_queue<Deadline>();
+}
+
+void CTsbPdPool::add(CUDT* u)
+{
+    ScopedLock lk(m_Lock);
+    m_Sockets[u] = Slot();
+    schedule_(u, steady_clock::now());
+}
+
+void CTsbPdPool::wake(CUDT* u)
+{
+    ScopedLock lk(m_Lock);
+    std::map<CUDT*, Slot>::iterator i = m_Sockets.find(u);
+    if (i == m_Sockets.end())
+        return;
+
+    if (i->second.bBusy)
+        i->second.bWakeup = true;
+    else
+        schedule_(u, steady_clock::now());
+}
+
+void CTsbPdPool::remove(CUDT* u)
+{
+    UniqueLock lk(m_Lock);
+    std::map<CUDT*, Slot>::iterator i = m_Sockets.find(u);
+    if (i == m_Sockets.end())
+        return;
+
+    while (i->second.bBusy)
+        m_IdleCond.wait(lk);
+
+    // The entries in the heap are skipped by the workers when not found.
+    m_Sockets.erase(i);
+}
+
+void CTsbPdPool::schedule_(CUDT* u, const time_point& when)
+{
+    Slot& s      = m_Sockets[u];
+    s.iSchedule  = ++m_iNextSchedule;
+    s.bScheduled = true;
+
+    const bool earliest = m_Deadlines.empty() || when < m_Deadlines.top().tsTime;
+    Deadline   d;
+    d.tsTime    = when;
+    d.pSocket   = u;
+    d.iSchedule = s.iSchedule;
+    m_Deadlines.push(d);
+
+    if (earliest)
+        m_WorkCond.notify_one();
+}
+
+void* CTsbPdPool::worker(void* param)
+{
+    CTsbPdPool* self = (CTsbPdPool*)param;
+
+    THREAD_STATE_INIT("SRT:TsbPdPool");
+
+    UniqueLock lk(self->m_Lock);
+    while (!self->m_bClosing)
+    {
+        INCREMENT_THREAD_ITERATIONS();
+
+        if (self->m_Deadlines.empty())
+        {
+            THREAD_PAUSED();
+            self->m_WorkCond.wait(lk);
+            THREAD_RESUMED();
+            continue;
+        }
+
+        const Deadline next = self->m_Deadlines.top();
+        std::map<CUDT*, Slot>::iterator i = self->m_Sockets.find(next.pSocket);
+        if (i == self->m_Sockets.end() || !i->second.bScheduled || i->second.iSchedule != next.iSchedule)
+        {
+            // Rescheduled or removed since.
+            self->m_Deadlines.pop();
+            continue;
+        }
+
+        if (next.tsTime > steady_clock::now())
+        {
+            THREAD_PAUSED();
+            self->m_WorkCond.wait_until(lk, next.tsTime);
+            THREAD_RESUMED();
+            continue;
+        }
+
+        self->m_Deadlines.pop();
+        Slot& s      = i->second;
+        s.bScheduled = false;
+        s.bBusy      = true;
+        s.bWakeup    = false;
+
+        time_point next_delivery;
+        {
+            // The socket locks its m_RecvLock, which is before m_Lock in hierarchy.
+            InvertedLock unlk(self->m_Lock);
+            next_delivery = next.pSocket->tsbpdPoolRound();
+        }
+
+        // The slot can't be removed while busy.
+        s.bBusy = false;
+        if (s.bWakeup)
+            self->schedule_(next.pSocket, steady_clock::now());
+        else if (!is_zero(next_delivery))
+            self->schedule_(next.pSocket, next_delivery);
+        self->m_IdleCond.notify_all();
+    }
+
+    THREAD_EXIT();
+    return NULL;
+}
+
+} // namespace srt
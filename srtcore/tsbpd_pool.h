@@ -0,0 +1,102 @@
+/*
+ * SRT - Secure, Reliable, Transport
+ * Copyright (c) 2021 Haivision Systems Inc.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ */
+
+#ifndef INC_SRT_TSBPD_POOL_H
+#define INC_SRT_TSBPD_POOL_H
+
+#include <map>
+#include <queue>
+#include <vector>
+#include "sync.h"
+
+namespace srt
+{
+
+class CUDT;
+
+/// @brief Pool of threads doing the TSBPD delivery for all the receiving sockets.
+/// Used instead of a TSBPD thread per socket when started with srt_startup_tsbpd().
+/// Every socket is in the deadline heap with the time of its next delivery,
+/// or waits for a wake-up (like the TSBPD thread waits on CUDT::m_RcvTsbPdCond).
+/// A socket is processed by one worker at a time, calling CUDT::tsbpdPoolRound().
+class CTsbPdPool
+{
+    typedef sync::steady_clock::time_point time_point;
+
+public:
+    CTsbPdPool();
+    ~CTsbPdPool();
+
+    /// Start the worker threads.
+    /// @param nworkers number of threads.
+    /// @return false if failed to start the threads (the pool is not running then).
+    bool start(int nworkers);
+
+    /// Stop and join the worker threads. All sockets must have been removed.
+    void stop();
+
+    bool running() const { return m_bRunning; }
+
+    /// Register a socket, to be processed at once.
+    void add(CUDT* u);
+
+    /// Have the socket processed at once. Ignored if not registered.
+    void wake(CUDT* u);
+
+    /// Unregister a socket. Waits until no worker processes it.
+    void remove(CUDT* u);
+
+private:
+    static void* worker(void* param);
+
+    // [[using locked(m_Lock)]]
+    void schedule_(CUDT* u, const time_point& when);
+
+    struct Slot
+    {
+        Slot()
+            : iSchedule(0)
+            , bScheduled(false)
+            , bBusy(false)
+            , bWakeup(false)
+        {
+        }
+
+        uint64_t iSchedule;  //< Number of the heap entry that is valid for the socket
+        bool     bScheduled; //< In the heap (otherwise waiting for a wake-up or busy)
+        bool     bBusy;      //< Being processed by a worker
+        bool     bWakeup;    //< Woken up while busy, to be processed again at once
+    };
+
+    struct Deadline
+    {
+        time_point tsTime;
+        CUDT*      pSocket;
+        uint64_t   iSchedule;
+
+        // The earliest on the top of std::priority_queue.
+        bool operator<(const Deadline& other) const { return tsTime > other.tsTime; }
+    };
+
+    sync::Mutex     m_Lock;
+    sync::Condition m_WorkCond; // Signaled when the earliest deadline changes or when stopping
+    sync::Condition m_IdleCond; // Signaled when a worker finished processing a socket
+
+    std::map<CUDT*, Slot>           m_Sockets;
+    std::priority_queue<Deadline>   m_Deadlines; // Includes outdated entries, skipped by the workers
+    uint64_t                        m_iNextSchedule;
+    bool                            m_bClosing;
+    std::vector<sync::CThread*>     m_Workers;
+    sync::atomic<bool>              m_bRunning; // Read without locking when the sockets start receiving
+};
+
+} // namespace srt
+
+#endif
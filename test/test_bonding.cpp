@@ -9,6 +9,7 @@
 
 #include "srt.h"
 #include "netinet_any.h"
+#include "common.h"
 
 TEST(Bonding, SRTConnectGroup)
 {
@@ -330,3 +331,194 @@ TEST(Bonding, CloseGroupAndSocket)
     listen_promise.wait();
 }
 
+// The members of a broadcast group share one copy of the payload
+// in their sender buffers, which must still reach the peer intact.
+TEST(Bonding, BroadcastSharedPayload)
+{
+    srt::TestInit srtinit;
+
+    const SRTSOCKET server_sock = srt_create_socket();
+    sockaddr_in sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(4210);
+    ASSERT_EQ(inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr), 1);
+
+    const int yes = 1;
+    ASSERT_SRT_SUCCESS(srt_setsockflag(server_sock, SRTO_GROUPCONNECT, &yes, sizeof yes));
+    ASSERT_SRT_SUCCESS(srt_bind(server_sock, (sockaddr*)&sa, sizeof sa));
+    ASSERT_SRT_SUCCESS(srt_listen(server_sock, 5));
+
+    const SRTSOCKET ss = srt_create_group(SRT_GTYPE_BROADCAST);
+    ASSERT_NE(ss, SRT_ERROR);
+
+    SRT_SOCKGROUPCONFIG targets[2] = {
+        srt_prepare_endpoint(NULL, (sockaddr*)&sa, sizeof sa),
+        srt_prepare_endpoint(NULL, (sockaddr*)&sa, sizeof sa)
+    };
+
+    std::future<SRTSOCKET> accepted = std::async(std::launch::async, [server_sock] {
+        return srt_accept(server_sock, NULL, NULL);
+    });
+
+    ASSERT_SRT_SUCCESS(srt_connect_group(ss, targets, 2));
+    for (auto& gd: targets)
+        srt_delete_config(gd.config);
+
+    const SRTSOCKET acp = accepted.get();
+    ASSERT_NE(acp, SRT_INVALID_SOCK);
+    const int rcvtimeo = 3000;
+    ASSERT_SRT_SUCCESS(srt_setsockflag(acp, SRTO_RCVTIMEO, &rcvtimeo, sizeof rcvtimeo));
+
+    // Wait for both links, so that the payload is shared.
+    for (int i = 0; i < 100; ++i)
+    {
+        SRT_SOCKGROUPDATA gdata[2];
+        size_t            gsize = 2;
+        int               nconnected = 0;
+        if (srt_group_data(ss, gdata, &gsize) != SRT_ERROR)
+        {
+            for (size_t j = 0; j < gsize; ++j)
+                nconnected += gdata[j].sockstate == SRTS_CONNECTED;
+        }
+        if (nconnected == 2)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    const int NMSG = 200;
+    std::thread sender([ss] {
+        char buf[1316];
+        for (int i = 0; i < NMSG; ++i)
+        {
+            memset(buf, i & 0xFF, sizeof buf);
+            if (srt_send(ss, buf, sizeof buf) != int(sizeof buf))
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    for (int i = 0; i < NMSG; ++i)
+    {
+        char buf[1500];
+        const int rd = srt_recv(acp, buf, sizeof buf);
+        ASSERT_EQ(rd, 1316) << "Message " << i << ": " << srt_getlasterror_str();
+        EXPECT_EQ(buf[0], char(i & 0xFF));
+        EXPECT_EQ(buf[rd - 1], char(i & 0xFF));
+    }
+    sender.join();
+
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(acp, &stats, true), SRT_SUCCESS);
+    EXPECT_EQ(stats.pktRecvUniqueTotal, NMSG);
+
+    srt_close(ss);
+    srt_close(acp);
+    srt_close(server_sock);
+}
+
+TEST(Bonding, BroadcastGroupRcvBuffer)
+{
+    srt::TestInit srtinit;
+
+    const SRTSOCKET server_sock = srt_create_socket();
+    sockaddr_in sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(4211);
+    ASSERT_EQ(inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr), 1);
+
+    const int yes = 1;
+    const bool grprcvbuf = true;
+    ASSERT_SRT_SUCCESS(srt_setsockflag(server_sock, SRTO_GROUPCONNECT, &yes, sizeof yes));
+    ASSERT_SRT_SUCCESS(srt_setsockflag(server_sock, SRTO_GROUPRCVBUF, &grprcvbuf, sizeof grprcvbuf));
+    // Small member buffers: the test sends several times their capacity, which only passes
+    // if the members, receiving nothing the group can read, keep advancing with the group.
+    const int RCVBUF_PKTS = 128;
+    const int rcvbuf = RCVBUF_PKTS * (1500 - 28);
+    ASSERT_SRT_SUCCESS(srt_setsockflag(server_sock, SRTO_RCVBUF, &rcvbuf, sizeof rcvbuf));
+    ASSERT_SRT_SUCCESS(srt_bind(server_sock, (sockaddr*)&sa, sizeof sa));
+    ASSERT_SRT_SUCCESS(srt_listen(server_sock, 5));
+
+    const SRTSOCKET ss = srt_create_group(SRT_GTYPE_BROADCAST);
+    ASSERT_NE(ss, SRT_ERROR);
+
+    SRT_SOCKGROUPCONFIG targets[2] = {
+        srt_prepare_endpoint(NULL, (sockaddr*)&sa, sizeof sa),
+        srt_prepare_endpoint(NULL, (sockaddr*)&sa, sizeof sa)
+    };
+
+    std::future<SRTSOCKET> accepted = std::async(std::launch::async, [server_sock] {
+        return srt_accept(server_sock, NULL, NULL);
+    });
+
+    ASSERT_SRT_SUCCESS(srt_connect_group(ss, targets, 2));
+    for (auto& gd: targets)
+        srt_delete_config(gd.config);
+
+    const SRTSOCKET acp = accepted.get();
+    ASSERT_NE(acp, SRT_INVALID_SOCK);
+    const int rcvtimeo = 3000;
+    ASSERT_SRT_SUCCESS(srt_setsockflag(acp, SRTO_RCVTIMEO, &rcvtimeo, sizeof rcvtimeo));
+
+    bool optval = false;
+    int  optlen = sizeof optval;
+    ASSERT_SRT_SUCCESS(srt_getsockflag(acp, SRTO_GROUPRCVBUF, &optval, &optlen));
+    EXPECT_TRUE(optval);
+
+    // Wait for both links, so that the packets come over both of them.
+    for (int i = 0; i < 100; ++i)
+    {
+        SRT_SOCKGROUPDATA gdata[2];
+        size_t            gsize = 2;
+        int               nconnected = 0;
+        if (srt_group_data(ss, gdata, &gsize) != SRT_ERROR)
+        {
+            for (size_t j = 0; j < gsize; ++j)
+                nconnected += gdata[j].sockstate == SRTS_CONNECTED;
+        }
+        if (nconnected == 2)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    const int NMSG = 8 * RCVBUF_PKTS;
+    std::thread sender([ss] {
+        char buf[1316];
+        for (int i = 0; i < NMSG; ++i)
+        {
+            memset(buf, i & 0xFF, sizeof buf);
+            if (srt_send(ss, buf, sizeof buf) != int(sizeof buf))
+                break;
+            // Under half a buffer within the default latency.
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+
+    int32_t lastseq = SRT_SEQNO_NONE;
+    for (int i = 0; i < NMSG; ++i)
+    {
+        char buf[1500];
+        SRT_MSGCTRL mc = srt_msgctrl_default;
+        const int rd = srt_recvmsg2(acp, buf, sizeof buf, &mc);
+        ASSERT_EQ(rd, 1316) << "Message " << i << ": " << srt_getlasterror_str();
+        EXPECT_EQ(buf[0], char(i & 0xFF));
+        EXPECT_EQ(buf[rd - 1], char(i & 0xFF));
+        // Every packet is delivered once, in order.
+        if (lastseq != SRT_SEQNO_NONE)
+        {
+            EXPECT_EQ(mc.pktseq, srt::CSeqNo::incseq(lastseq));
+        }
+        lastseq = mc.pktseq;
+    }
+    sender.join();
+
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(acp, &stats, true), SRT_SUCCESS);
+    EXPECT_EQ(stats.pktRecvUniqueTotal, NMSG);
+    EXPECT_EQ(stats.pktRcvDropTotal, 0);
+
+    srt_close(ss);
+    srt_close(acp);
+    srt_close(server_sock);
+}
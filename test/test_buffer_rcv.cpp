@@ -1,5 +1,7 @@
 #include <array>
+#include <atomic>
 #include <numeric>
+#include <thread>
 #include "gtest/gtest.h"
 #include "buffer_rcv.h"
 
@@ -604,6 +606,59 @@ TEST_F(CRcvBufferReadMsg, LongMsgReadReady)
     EXPECT_EQ(m_unit_queue->size(), m_unit_queue->capacity());
 }
 
+// A message is borrowed instead of copied: the units leave the buffer,
+// but stay taken until returned, while the buffer accepts more packets.
+TEST_F(CRcvBufferReadMsg, BorrowMessage)
+{
+    const size_t msg_pkts = 4;
+    EXPECT_EQ(addMessage(msg_pkts, 1, m_init_seqno), 0);
+    EXPECT_EQ(addMessage(1, 2, m_init_seqno + int(msg_pkts)), 0);
+    ackPackets(msg_pkts + 1);
+
+    vector<CUnit*> units;
+    SRT_MSGCTRL    mc = srt_msgctrl_default;
+    EXPECT_EQ(m_rcv_buffer->readMessage(NULL, 0, &mc, &units), int(msg_pkts * m_payload_sz));
+    EXPECT_EQ(mc.msgno, 1);
+    ASSERT_EQ(units.size(), msg_pkts);
+    for (size_t i = 0; i < msg_pkts; ++i)
+    {
+        EXPECT_EQ(units[i]->m_Packet.getSeqNo(), m_init_seqno + int(i));
+        EXPECT_TRUE(verifyPayload(units[i]->m_Packet.m_pcData, m_payload_sz, m_init_seqno + int(i)));
+    }
+    EXPECT_EQ(m_unit_queue->numTaken(), int(msg_pkts) + 1);
+
+    // The buffer positions are free for new packets, the borrowed payload stays intact.
+    EXPECT_EQ(addMessage(msg_pkts, 3, m_init_seqno + int(msg_pkts) + 1), 0);
+    array<char, m_payload_sz> buff;
+    EXPECT_EQ(readMessage(buff.data(), buff.size()), int(m_payload_sz));
+    EXPECT_TRUE(verifyPayload(units[0]->m_Packet.m_pcData, m_payload_sz, m_init_seqno));
+
+    m_rcv_buffer->releaseBorrowed(units);
+    EXPECT_EQ(m_unit_queue->numTaken(), int(msg_pkts));
+}
+
+// A message of 3 packets is scattered over blocks not aligned with the packets.
+TEST_F(CRcvBufferReadMsg, ScatterMessage)
+{
+    const size_t msg_pkts = 3;
+    EXPECT_EQ(addMessage(msg_pkts, 1, m_init_seqno), 0);
+    ackPackets(msg_pkts);
+
+    array<char, 16>                    header;
+    array<char, msg_pkts * m_payload_sz> body;
+    SRT_IOVEC iov[2] = {{header.data(), header.size()}, {body.data(), body.size()}};
+
+    SRT_MSGCTRL mc = srt_msgctrl_default;
+    EXPECT_EQ(m_rcv_buffer->readMessage(iov, 2, &mc), int(msg_pkts * m_payload_sz));
+    EXPECT_EQ(mc.msgno, 1);
+
+    vector<char> joined(header.begin(), header.end());
+    joined.insert(joined.end(), body.begin(), body.end());
+    for (size_t i = 0; i < msg_pkts; ++i)
+        EXPECT_TRUE(verifyPayload(&joined[i * m_payload_sz], m_payload_sz, m_init_seqno + int(i)));
+    EXPECT_EQ(m_unit_queue->numTaken(), 0);
+}
+
 // One message (4 packets) is added to the buffer. Can be read out of order.
 // Reading should be possible even before the missing packet is dropped.
 TEST_F(CRcvBufferReadMsg, MsgOutOfOrderDrop)
@@ -770,6 +825,74 @@ TEST_F(CRcvBufferReadMsg, TSBPDGapBeforeValid)
     EXPECT_EQ(m_unit_queue->size(), m_unit_queue->capacity());
 }
 
+/// TSBPD = ON, packets are inserted without locking while another thread reads
+/// them, and drops the missing ones like the TSBPD thread. Some packets come late,
+/// so that the insertion races with the reader dropping their position.
+/// Every packet is read once and in order, or rejected, and no unit is lost.
+TEST_F(CRcvBufferReadMsg, ConcurrentInsertAndRead)
+{
+    m_rcv_buffer->setTsbPdMode(m_tsbpd_base - sync::seconds_from(10), false, m_delay);
+    ASSERT_FALSE(m_rcv_buffer->insertNeedsLock());
+
+    const int         num_pkts = 7 * 15000;
+    std::atomic<bool> inserting(true);
+    int               num_late_inserted = 0;
+
+    std::thread producer([&] {
+        for (int i = 0; i < num_pkts; ++i)
+        {
+            // Every 7th packet comes after the next two.
+            const int idx = (i % 7 == 5) ? i - 2 : (i % 7 == 3 || i % 7 == 4) ? i + 1 : i;
+            const int seqno = CSeqNo::incseq(m_init_seqno, idx);
+            for (;;)
+            {
+                const int res = addPacket(seqno, idx % 1000 + 1);
+                if (res == -3) // The buffer is full, wait for the reader.
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (idx % 7 == 3)
+                    num_late_inserted += (res == 0) ? 1 : 0;
+                else
+                    EXPECT_EQ(res, 0) << "seqno " << seqno;
+                break;
+            }
+        }
+        inserting = false;
+    });
+
+    array<char, m_payload_sz> buff;
+    int32_t last_seqno = CSeqNo::decseq(m_init_seqno);
+    int     num_read = 0, num_late_read = 0;
+    while (inserting || !m_rcv_buffer->empty())
+    {
+        if (m_rcv_buffer->isRcvDataReady(sync::steady_clock::now()))
+        {
+            SRT_MSGCTRL mctrl = srt_msgctrl_default;
+            ASSERT_EQ(m_rcv_buffer->readMessage(buff.data(), buff.size(), &mctrl), (int)m_payload_sz);
+            ASSERT_GT(CSeqNo::seqcmp(mctrl.pktseq, last_seqno), 0);
+            ASSERT_TRUE(verifyPayload(buff.data(), m_payload_sz, mctrl.pktseq));
+            last_seqno = mctrl.pktseq;
+            ++num_read;
+            num_late_read += (CSeqNo::seqoff(m_init_seqno, mctrl.pktseq) % 7 == 3) ? 1 : 0;
+            continue;
+        }
+
+        const CRcvBuffer::PacketInfo info = m_rcv_buffer->getFirstValidPacketInfo();
+        if (info.seq_gap)
+            m_rcv_buffer->dropUpTo(info.seqno);
+        else
+            std::this_thread::yield();
+    }
+    producer.join();
+
+    // A late packet can also be dropped just after it was inserted.
+    EXPECT_LE(num_late_read, num_late_inserted);
+    EXPECT_EQ(num_read - num_late_read, num_pkts - num_pkts / 7);
+    EXPECT_EQ(m_unit_queue->numTaken(), 0);
+}
+
 
 class CRcvBufferReadStream
     : public CRcvBufferReadMsg
@@ -0,0 +1,264 @@
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "buffer_snd.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::sync;
+
+namespace
+{
+
+struct Released
+{
+    vector<const char*> bufs;
+    vector<int>         lens;
+};
+
+void onRelease(void* opaq, const char* buf, int len)
+{
+    Released* r = static_cast<Released*>(opaq);
+    r->bufs.push_back(buf);
+    r->lens.push_back(len);
+}
+
+const int PAYLOAD_SIZE = 1456;
+
+} // namespace
+
+/// The packets of a message sent without copying refer to the user buffer,
+/// also when read for a retransmission, and the buffer is released when acknowledged.
+TEST(CSndBuffer, ZeroCopyAck)
+{
+    CSndBuffer         sndbuf(AF_INET, 8, PAYLOAD_SIZE, 0);
+    Released           released;
+    const vector<char> msg1(3 * PAYLOAD_SIZE, 'a'); // 3 packets
+    const vector<char> msg2(100, 'b');
+
+    SRT_MSGCTRL mc = srt_msgctrl_default;
+    mc.pktseq      = 1000;
+    sndbuf.addBuffer(&msg1[0], (int)msg1.size(), (mc), &onRelease, &released);
+    mc.msgno = SRT_MSGNO_NONE;
+    sndbuf.addBuffer(&msg2[0], (int)msg2.size(), (mc), &onRelease, &released);
+    EXPECT_EQ(sndbuf.getCurrBufSize(), 4);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        CPacket                  pkt;
+        steady_clock::time_point origin;
+        int                      skipped = 0;
+        bool                     encrypted = false;
+        ASSERT_GT(sndbuf.readData((pkt), (origin), 0, (skipped), (encrypted)), 0);
+        EXPECT_EQ(pkt.m_pcData, i < 3 ? &msg1[i * PAYLOAD_SIZE] : &msg2[0]);
+    }
+
+    CPacket                  rexmit;
+    steady_clock::time_point origin;
+    int                      msglen = 0;
+    ASSERT_EQ(sndbuf.readData(1, (rexmit), (origin), (msglen)), PAYLOAD_SIZE);
+    EXPECT_EQ(rexmit.m_pcData, &msg1[PAYLOAD_SIZE]);
+
+    // The message is released only when all its packets are acknowledged.
+    sndbuf.ackData(2);
+    EXPECT_TRUE(released.bufs.empty());
+    sndbuf.ackData(1);
+    ASSERT_EQ(released.bufs.size(), 1u);
+    EXPECT_EQ(released.bufs[0], &msg1[0]);
+    EXPECT_EQ(released.lens[0], (int)msg1.size());
+
+    sndbuf.ackData(1);
+    ASSERT_EQ(released.bufs.size(), 2u);
+    EXPECT_EQ(released.bufs[1], &msg2[0]);
+}
+
+/// Copied and referred messages can be mixed, and the blocks that referred to
+/// a user buffer before are used for copying again.
+TEST(CSndBuffer, ZeroCopyMixed)
+{
+    CSndBuffer         sndbuf(AF_INET, 4, PAYLOAD_SIZE, 0);
+    Released           released;
+    const vector<char> msg(PAYLOAD_SIZE, 'z');
+
+    for (int round = 0; round < 20; ++round)
+    {
+        const char  copied[] = "copied";
+        SRT_MSGCTRL mc       = srt_msgctrl_default;
+        mc.pktseq            = 1000 + 2 * round;
+        sndbuf.addBuffer(&msg[0], (int)msg.size(), (mc), &onRelease, &released);
+        mc.msgno = SRT_MSGNO_NONE;
+        sndbuf.addBuffer(copied, sizeof copied, (mc));
+
+        CPacket                  pkt;
+        steady_clock::time_point origin;
+        int                      skipped = 0;
+        bool                     encrypted = false;
+        ASSERT_EQ(sndbuf.readData((pkt), (origin), 0, (skipped), (encrypted)), PAYLOAD_SIZE);
+        EXPECT_EQ(pkt.m_pcData, &msg[0]);
+        ASSERT_EQ(sndbuf.readData((pkt), (origin), 0, (skipped), (encrypted)), (int)sizeof copied);
+        EXPECT_NE(pkt.m_pcData, copied);
+        EXPECT_STREQ(pkt.m_pcData, copied);
+
+        sndbuf.ackData(2);
+        EXPECT_EQ(released.bufs.size(), size_t(round + 1));
+    }
+}
+
+/// The user buffers are released also when the packets are dropped
+/// as too late, or when the buffer is deleted.
+TEST(CSndBuffer, ZeroCopyDropAndDelete)
+{
+    Released           released;
+    const vector<char> msg1(200, 'x');
+    const vector<char> msg2(300, 'y');
+    {
+        CSndBuffer sndbuf(AF_INET, 8, PAYLOAD_SIZE, 0);
+
+        SRT_MSGCTRL mc = srt_msgctrl_default;
+        mc.pktseq      = 1000;
+        sndbuf.addBuffer(&msg1[0], (int)msg1.size(), (mc), &onRelease, &released);
+        const steady_clock::time_point between = steady_clock::now() + microseconds_from(1);
+        sync::this_thread::sleep_for(milliseconds_from(2));
+        mc.msgno   = SRT_MSGNO_NONE;
+        mc.srctime = 0; // Set to the time of the previous message
+        sndbuf.addBuffer(&msg2[0], (int)msg2.size(), (mc), &onRelease, &released);
+
+        int     bytes = 0;
+        int32_t first_msgno = 0;
+        EXPECT_EQ(sndbuf.dropLateData((bytes), (first_msgno), between), 1);
+        ASSERT_EQ(released.bufs.size(), 1u);
+        EXPECT_EQ(released.bufs[0], &msg1[0]);
+    }
+
+    ASSERT_EQ(released.bufs.size(), 2u);
+    EXPECT_EQ(released.bufs[1], &msg2[0]);
+    EXPECT_EQ(released.lens[1], (int)msg2.size());
+}
+
+/// A message gathered from several blocks is split into packets regardless of
+/// the block boundaries, and only the requested size is taken.
+TEST(CSndBuffer, GatherBlocks)
+{
+    CSndBuffer sndbuf(AF_INET, 8, PAYLOAD_SIZE, 0);
+
+    // A header and 14 TS packets, the second packet of the message starting inside a block.
+    vector<char> header(12, 'H');
+    vector<char> ts(14 * 188);
+    for (size_t i = 0; i < ts.size(); ++i)
+        ts[i] = char(i / 188);
+
+    vector<SRT_IOVEC> iov;
+    SRT_IOVEC         v = {&header[0], header.size()};
+    iov.push_back(v);
+    for (int i = 0; i < 14; ++i)
+    {
+        SRT_IOVEC p = {&ts[i * 188], 188};
+        iov.push_back(p);
+    }
+
+    const int   len = int(header.size() + ts.size());
+    SRT_MSGCTRL mc  = srt_msgctrl_default;
+    mc.pktseq       = 1000;
+    sndbuf.addBuffer(&iov[0], (int)iov.size(), len, (mc));
+    EXPECT_EQ(sndbuf.getCurrBufSize(), 2);
+
+    vector<char> joined(header);
+    joined.insert(joined.end(), ts.begin(), ts.end());
+
+    CPacket                  pkt;
+    steady_clock::time_point origin;
+    int                      skipped = 0;
+    bool                     encrypted = false;
+    ASSERT_EQ(sndbuf.readData((pkt), (origin), 0, (skipped), (encrypted)), PAYLOAD_SIZE);
+    EXPECT_EQ(memcmp(pkt.m_pcData, &joined[0], PAYLOAD_SIZE), 0);
+    ASSERT_EQ(sndbuf.readData((pkt), (origin), 0, (skipped), (encrypted)), len - PAYLOAD_SIZE);
+    EXPECT_EQ(memcmp(pkt.m_pcData, &joined[PAYLOAD_SIZE], len - PAYLOAD_SIZE), 0);
+
+    // Only the beginning of the blocks, as in stream mode with little space left.
+    mc.msgno = SRT_MSGNO_NONE;
+    sndbuf.addBuffer(&iov[0], (int)iov.size(), 100, (mc));
+    ASSERT_EQ(sndbuf.readData((pkt), (origin), 0, (skipped), (encrypted)), 100);
+    EXPECT_EQ(memcmp(pkt.m_pcData, &joined[0], 100), 0);
+}
+
+/// The packets are found by the offset from the ACK point also after the ring
+/// wrapped around and was grown, and the packets read before growing stay valid.
+TEST(CSndBuffer, RingGrow)
+{
+    CSndBuffer sndbuf(AF_INET, 4, PAYLOAD_SIZE, 0);
+
+    SRT_MSGCTRL mc = srt_msgctrl_default;
+    mc.pktseq      = 1000;
+    int nextval    = 0;
+    for (int round = 0; round < 5; ++round)
+    {
+        // Move the ACK point, so that the ring wraps around.
+        char data[100];
+        memset(data, nextval++, sizeof data);
+        mc.msgno = SRT_MSGNO_NONE;
+        sndbuf.addBuffer(data, sizeof data, (mc));
+
+        CPacket                  pkt;
+        steady_clock::time_point origin;
+        int                      skipped = 0;
+        bool                     encrypted = false;
+        ASSERT_EQ(sndbuf.readData((pkt), (origin), 0, (skipped), (encrypted)), (int)sizeof data);
+        sndbuf.ackData(1);
+    }
+    EXPECT_EQ(sndbuf.getCurrBufSize(), 0);
+
+    // Two packets sent, then the buffer grows several times.
+    vector<CPacket*>   sent;
+    vector<int32_t>    msgnos;
+    const int          npkts = 40;
+    for (int i = 0; i < npkts; ++i)
+    {
+        char data[100];
+        memset(data, nextval + i, sizeof data);
+        mc.msgno = SRT_MSGNO_NONE;
+        sndbuf.addBuffer(data, sizeof data, (mc));
+        msgnos.push_back(mc.msgno);
+
+        if (i < 2)
+        {
+            sent.push_back(new CPacket);
+            steady_clock::time_point origin;
+            int                      skipped = 0;
+            bool                     encrypted = false;
+            ASSERT_EQ(sndbuf.readData((*sent.back()), (origin), 0, (skipped), (encrypted)), (int)sizeof data);
+        }
+    }
+    EXPECT_EQ(sndbuf.getCurrBufSize(), npkts);
+
+    for (size_t i = 0; i < sent.size(); ++i)
+    {
+        EXPECT_EQ(sent[i]->m_pcData[0], char(nextval + i));
+        EXPECT_EQ(sent[i]->m_pcData[99], char(nextval + i));
+        delete sent[i];
+    }
+
+    for (int offset = 0; offset < npkts; ++offset)
+    {
+        CPacket                  rexmit;
+        steady_clock::time_point origin;
+        int                      msglen = 0;
+        EXPECT_EQ(sndbuf.getMsgNoAt(offset), msgnos[offset]);
+        ASSERT_EQ(sndbuf.readData(offset, (rexmit), (origin), (msglen)), 100);
+        EXPECT_EQ(rexmit.m_pcData[0], char(nextval + offset));
+        EXPECT_FALSE(is_zero(sndbuf.getPacketRexmitTime(offset)));
+    }
+    EXPECT_EQ(sndbuf.getMsgNoAt(npkts), SRT_MSGNO_CONTROL);
+
+    // The original sending continues after the packets sent before growing.
+    CPacket                  pkt;
+    steady_clock::time_point origin;
+    int                      skipped = 0;
+    bool                     encrypted = false;
+    ASSERT_EQ(sndbuf.readData((pkt), (origin), 0, (skipped), (encrypted)), 100);
+    EXPECT_EQ(pkt.m_pcData[0], char(nextval + 2));
+
+    sndbuf.ackData(npkts - 1);
+    EXPECT_EQ(sndbuf.getCurrBufSize(), 1);
+    EXPECT_EQ(sndbuf.getMsgNoAt(0), msgnos[npkts - 1]);
+}
@@ -0,0 +1,178 @@
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "channel.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::sync;
+
+namespace
+{
+
+const int PAYLOAD_SIZE = 1316;
+
+// The longest wait in the tests, not to be reached.
+const int LONG_WAIT_US = 10 * 1000 * 1000;
+
+// Packets lent to the receiving channel, where it receives into these (io_uring).
+const int LENT_PACKETS = 8;
+
+// A receiving channel bound to the loopback and a channel sending to it.
+struct ChannelPair
+{
+    CChannel     snd, rcv;
+    sockaddr_any rcvaddr;
+    bool         lending;
+    CPacket      lent[LENT_PACKETS];
+    char         lentbuf[LENT_PACKETS][CChannel::RECV_HEADROOM + PAYLOAD_SIZE];
+
+    ChannelPair(const CSrtMuxerConfig& cfg)
+        : lending(false)
+    {
+        rcv.setConfig(cfg);
+        snd.setConfig(cfg);
+        in_addr lo;
+        lo.s_addr = htonl(INADDR_LOOPBACK);
+        rcv.open(sockaddr_any(lo, 0));
+        snd.open(AF_INET);
+        rcv.getSockAddr((rcvaddr));
+    }
+
+    ~ChannelPair()
+    {
+        rcv.stopReceiving();
+        snd.close();
+        rcv.close();
+    }
+
+    void send()
+    {
+        CPacket pkt;
+        pkt.allocate(PAYLOAD_SIZE);
+        pkt.m_iSeqNo     = 1;
+        pkt.m_iMsgNo     = 1 | MSGNO_PACKET_BOUNDARY::wrap(PB_SOLO);
+        pkt.m_iTimeStamp = 0;
+        pkt.m_iID        = 0;
+        memset(pkt.data(), 'a', PAYLOAD_SIZE);
+        pkt.setLength(PAYLOAD_SIZE);
+        snd.sendto(rcvaddr, pkt, sockaddr_any(AF_INET));
+    }
+
+    void lend(int id)
+    {
+        lent[id].m_pcData = lentbuf[id] + CChannel::RECV_HEADROOM;
+        lent[id].setLength(PAYLOAD_SIZE);
+        rcv.lendRecvPacket(lent[id], id);
+    }
+
+    // Receive up to batch packets, waiting up to wait_us; w_waited is the time it took.
+    EReadStatus receive(int batch, int wait_us, steady_clock::duration& w_waited)
+    {
+        if (rcv.receivesLent())
+        {
+            if (!lending)
+            {
+                for (int id = 0; id < LENT_PACKETS; ++id)
+                    lend(id);
+                lending = true;
+            }
+
+            vector<sockaddr_any> addrs(batch);
+            vector<int>          ids(batch);
+            vector<EReadStatus>  status(batch);
+
+            int                            nrecv = 0;
+            const steady_clock::time_point start = steady_clock::now();
+            const EReadStatus rst = rcv.recvfrom_lent(&addrs[0], &ids[0], &status[0], batch, (nrecv), wait_us);
+            w_waited = steady_clock::now() - start;
+
+            for (int i = 0; i < nrecv; ++i)
+            {
+                EXPECT_EQ(lent[ids[i]].m_iSeqNo, 1);
+                EXPECT_EQ(lent[ids[i]].getLength(), size_t(PAYLOAD_SIZE));
+                EXPECT_EQ(lent[ids[i]].data()[PAYLOAD_SIZE - 1], 'a');
+                lend(ids[i]);
+            }
+            return rst;
+        }
+
+        vector<CPacket>      pkts(batch);
+        vector<CPacket*>     ptrs(batch);
+        vector<sockaddr_any> addrs(batch);
+        vector<EReadStatus>  status(batch);
+        for (int i = 0; i < batch; ++i)
+        {
+            pkts[i].allocate(PAYLOAD_SIZE);
+            ptrs[i] = &pkts[i];
+        }
+
+        int                            nrecv = 0;
+        const steady_clock::time_point start = steady_clock::now();
+        const EReadStatus rst = rcv.recvfrom_batch(&addrs[0], &ptrs[0], &status[0], batch, (nrecv), wait_us);
+        w_waited = steady_clock::now() - start;
+        return rst;
+    }
+};
+
+// The receiving waits as long as told, unless woken up or a packet comes.
+void testWakeReceiver(const CSrtMuxerConfig& cfg, int batch)
+{
+    ChannelPair            chans(cfg);
+    steady_clock::duration waited;
+
+    // Nothing comes in time.
+    EXPECT_EQ(chans.receive(batch, 50 * 1000, (waited)), RST_AGAIN);
+    EXPECT_GE(waited, milliseconds_from(40));
+
+    // Woken up while waiting. The receiving is done by this thread only, as with io_uring.
+    std::thread waker([&chans] {
+        std::this_thread::sleep_for(chrono::milliseconds(100));
+        chans.rcv.wakeReceiver();
+    });
+    EXPECT_EQ(chans.receive(batch, LONG_WAIT_US, (waited)), RST_AGAIN);
+    EXPECT_LT(waited, seconds_from(5));
+    waker.join();
+
+    // Woken up before waiting, and then only once.
+    chans.rcv.wakeReceiver();
+    chans.rcv.wakeReceiver();
+    EXPECT_EQ(chans.receive(batch, LONG_WAIT_US, (waited)), RST_AGAIN);
+    EXPECT_LT(waited, seconds_from(5));
+    EXPECT_EQ(chans.receive(batch, 50 * 1000, (waited)), RST_AGAIN);
+    EXPECT_GE(waited, milliseconds_from(40));
+
+    chans.send();
+    EXPECT_EQ(chans.receive(batch, LONG_WAIT_US, (waited)), RST_OK);
+    EXPECT_LT(waited, seconds_from(5));
+}
+
+} // namespace
+
+TEST(CChannel, WakeReceiver)
+{
+    CSrtMuxerConfig cfg;
+    testWakeReceiver(cfg, 1);
+}
+
+TEST(CChannel, WakeReceiverBatch)
+{
+    CSrtMuxerConfig cfg;
+    testWakeReceiver(cfg, 8);
+}
+
+TEST(CChannel, WakeReceiverIoUring)
+{
+    CSrtMuxerConfig cfg;
+    cfg.bUDPIoUring = true; // The system calls are used where io_uring isn't available.
+    testWakeReceiver(cfg, 8);
+}
+
+TEST(CChannel, WakeReceiverInproc)
+{
+    CSrtMuxerConfig cfg;
+    cfg.sInprocLink = "on";
+    testWakeReceiver(cfg, 8);
+}
@@ -1,9 +1,11 @@
 #include <array>
+#include <memory>
 #include <numeric>
+#include <vector>
 
 #include "gtest/gtest.h"
 
-#if defined(SRT_ENABLE_ENCRYPTION) && defined(ENABLE_AEAD_API_PREVIEW)
+#if defined(SRT_ENABLE_ENCRYPTION)
 #include "crypto.h"
 #include "hcrypt.h" // Imports the CRYSPR_HAS_AESGCM definition.
 #include "socketconfig.h"
@@ -15,8 +17,9 @@ namespace srt
         : public ::testing::Test
     {
     protected:
-        Crypto()
+        Crypto(int mode = CSrtConfig::CIPHER_MODE_AES_GCM)
             : m_crypt(0)
+            , m_iMode(mode)
         {
             // initialization code here
         }
@@ -43,8 +46,8 @@ namespace srt
             cfg.iSndCryptoKeyLen = SrtHSRequest::SRT_PBKEYLEN_BITS::wrap(4);
             m_crypt.setCryptoKeylen(cfg.iSndCryptoKeyLen);
 
-            cfg.iCryptoMode = CSrtConfig::CIPHER_MODE_AES_GCM;
-            EXPECT_EQ(m_crypt.init(HSD_INITIATOR, cfg, true), HaiCrypt_IsAESGCM_Supported() != 0);
+            cfg.iCryptoMode = m_iMode;
+            EXPECT_EQ(m_crypt.init(HSD_INITIATOR, cfg, true), m_iMode != CSrtConfig::CIPHER_MODE_AES_GCM || HaiCrypt_IsAESGCM_Supported() != 0);
 
             const unsigned char* kmmsg = m_crypt.getKmMsg_data(0);
             const size_t km_len = m_crypt.getKmMsg_size(0);
@@ -63,9 +66,87 @@ namespace srt
     protected:
 
         srt::CCryptoControl m_crypt;
+        const int m_iMode;
         const std::string m_pwd = "abcdefghijk";
     };
 
+    class CryptoCTR
+        : public Crypto
+    {
+    protected:
+        CryptoCTR()
+            : Crypto(CSrtConfig::CIPHER_MODE_AES_CTR)
+        {
+        }
+    };
+
+    // Packets to be encrypted, with the payload depending on the sequence number.
+    std::vector<std::unique_ptr<CPacket>> makePackets(int kflg, size_t pld_size, int num)
+    {
+        std::vector<std::unique_ptr<CPacket>> packets;
+        for (int i = 0; i < num; ++i)
+        {
+            std::unique_ptr<CPacket> pkt(new CPacket);
+            pkt->allocate(1500);
+            pkt->m_iSeqNo = 1000 + i;
+            pkt->m_iMsgNo = (1 + i) | PacketBoundaryBits(PB_SOLO) | MSGNO_ENCKEYSPEC::wrap(kflg);
+            pkt->m_iTimeStamp = 356 + i;
+            std::iota(pkt->data(), pkt->data() + pld_size, char('0' + i));
+            pkt->setLength(pld_size);
+            packets.push_back(std::move(pkt));
+        }
+        return packets;
+    }
+
+    std::vector<CPacket*> pointers(const std::vector<std::unique_ptr<CPacket>>& packets)
+    {
+        std::vector<CPacket*> ptrs;
+        for (const auto& p : packets)
+            ptrs.push_back(p.get());
+        return ptrs;
+    }
+
+    // The batch functions give the same result as encrypting and decrypting the packets one by one,
+    // also with more packets than passed at once to HaiCrypt, and leave clear packets as they are.
+    TEST_F(CryptoCTR, Batch)
+    {
+        const size_t pld_size = 1316;
+        const int    num      = 100;
+        const int    kflg     = m_crypt.getSndCryptoFlags();
+
+        auto single  = makePackets(kflg, pld_size, num);
+        auto batched = makePackets(kflg, pld_size, num);
+        const auto clear = makePackets(kflg, pld_size, num);
+
+        for (auto& p : single)
+            ASSERT_EQ(m_crypt.encrypt(*p), ENCS_CLEAR);
+        auto ptrs = pointers(batched);
+        ASSERT_EQ(m_crypt.encrypt(ptrs.data(), num), ENCS_CLEAR);
+
+        for (int i = 0; i < num; ++i)
+        {
+            ASSERT_EQ(batched[i]->getLength(), pld_size);
+            EXPECT_EQ(memcmp(batched[i]->data(), single[i]->data(), pld_size), 0) << "packet " << i;
+            EXPECT_NE(memcmp(batched[i]->data(), clear[i]->data(), pld_size), 0) << "packet " << i;
+        }
+
+        // A packet not encrypted in between.
+        memcpy(batched[10]->data(), clear[10]->data(), pld_size);
+        batched[10]->setMsgCryptoFlags(EK_NOENC);
+
+        std::vector<EncryptionStatus> status(num, ENCS_NOTSUP);
+        m_crypt.decrypt(ptrs.data(), num, status.data());
+        for (int i = 0; i < num; ++i)
+        {
+            EXPECT_EQ(status[i], ENCS_CLEAR);
+            EXPECT_EQ(batched[i]->getMsgCryptoFlags(), EK_NOENC);
+            ASSERT_EQ(batched[i]->getLength(), pld_size);
+            EXPECT_EQ(memcmp(batched[i]->data(), clear[i]->data(), pld_size), 0) << "packet " << i;
+        }
+    }
+
+#if defined(ENABLE_AEAD_API_PREVIEW)
+
 
     // Check that destroying the buffer also frees memory units.
     TEST_F(Crypto, GCM)
@@ -106,6 +187,36 @@ namespace srt
         
     }
 
+    // Only the packets failing the authentication fail in a batch.
+    TEST_F(Crypto, GCMBatch)
+    {
+        if (HaiCrypt_IsAESGCM_Supported() == 0)
+            GTEST_SKIP() << "The crypto service provider does not support AES GCM.";
+
+        const size_t pld_size = 1316;
+        const size_t tag_len  = 16;
+        const int    num      = 10;
+
+        auto packets = makePackets(m_crypt.getSndCryptoFlags(), pld_size, num);
+        auto ptrs    = pointers(packets);
+        ASSERT_EQ(m_crypt.encrypt(ptrs.data(), num), ENCS_CLEAR);
+        for (int i = 0; i < num; ++i)
+            EXPECT_EQ(packets[i]->getLength(), pld_size + tag_len);
+
+        packets[3]->data()[10] ^= 1;
+
+        std::vector<EncryptionStatus> status(num, ENCS_NOTSUP);
+        m_crypt.decrypt(ptrs.data(), num, status.data());
+        for (int i = 0; i < num; ++i)
+        {
+            EXPECT_EQ(status[i], i == 3 ? ENCS_FAILED : ENCS_CLEAR) << "packet " << i;
+            if (i != 3)
+                EXPECT_EQ(packets[i]->getLength(), pld_size);
+        }
+    }
+
+#endif // ENABLE_AEAD_API_PREVIEW
+
 } // namespace srt
 
-#endif //SRT_ENABLE_ENCRYPTION && ENABLE_AEAD_API_PREVIEW
+#endif //SRT_ENABLE_ENCRYPTION
@@ -8,6 +8,10 @@
 #include "api.h"
 #include "epoll.h"
 
+#ifdef __linux__
+#include <poll.h>
+#endif
+
 
 using namespace std;
 using namespace srt;
@@ -367,6 +371,59 @@ TEST(CEPoll, NotifyConnectionBreak)
 
 }
 
+// The caller's connection breaks when the listener closes it, and the caller
+// socket is then closed by the GC before the application closes it. Closing it
+// still removes it from the EID at once, and not only when the GC deletes it.
+TEST(CEPoll, CloseBrokenSocket)
+{
+    srt::TestInit srtinit;
+
+    srt::UniqueSocket server_sock = srt_create_socket();
+    ASSERT_NE(server_sock, SRT_ERROR);
+
+    sockaddr_in sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(5556);
+    ASSERT_EQ(inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr), 1);
+
+    ASSERT_NE(srt_bind(server_sock, (sockaddr*)& sa, sizeof(sa)), SRT_ERROR);
+    ASSERT_NE(srt_listen(server_sock, 1), SRT_ERROR);
+
+    const SRTSOCKET client_sock = srt_create_socket();
+    ASSERT_NE(client_sock, SRT_ERROR);
+    ASSERT_NE(srt_connect(client_sock, (sockaddr*)& sa, sizeof(sa)), SRT_ERROR);
+
+    sockaddr_in scl;
+    int sclen = sizeof scl;
+    const SRTSOCKET sock = srt_accept(server_sock, (sockaddr*)& scl, &sclen);
+    ASSERT_NE(sock, SRT_INVALID_SOCK);
+
+    const int epoll_id = srt_epoll_create();
+    ASSERT_GE(epoll_id, 0);
+    const int epoll_out = SRT_EPOLL_OUT | SRT_EPOLL_ERR;
+    ASSERT_NE(srt_epoll_add_usock(epoll_id, client_sock, &epoll_out), SRT_ERROR);
+
+    EXPECT_NE(srt_close(sock), SRT_ERROR);
+
+    // Wait for the GC to close the broken caller.
+    for (int i = 0; i < 50 && srt_getsockstate(client_sock) != SRTS_CLOSED; ++i)
+        this_thread::sleep_for(chrono::milliseconds(100));
+    ASSERT_EQ(srt_getsockstate(client_sock), SRTS_CLOSED);
+
+    int wlen = 2;
+    SRTSOCKET write[2];
+    EXPECT_EQ(srt_epoll_wait(epoll_id, NULL, NULL, write, &wlen, 0, 0, 0, 0, 0), 1);
+
+    EXPECT_EQ(srt_close(client_sock), SRT_SUCCESS);
+
+    // With no sockets subscribed the waiting fails at once.
+    wlen = 2;
+    EXPECT_EQ(srt_epoll_wait(epoll_id, NULL, NULL, write, &wlen, 0, 0, 0, 0, 0), SRT_ERROR);
+
+    EXPECT_EQ(srt_epoll_release(epoll_id), 0);
+}
+
 
 TEST(CEPoll, HandleEpollEvent2)
 {
@@ -429,6 +486,92 @@ TEST(CEPoll, HandleEpollEvent2)
 }
 
 
+#ifdef __linux__
+/// The notify descriptor is readable exactly while an event is ready,
+/// and is cleared when the edge-triggered event is consumed.
+TEST(CEPoll, NotifyFD)
+{
+    srt::TestInit srtinit;
+
+    srt::UniqueSocket client_sock = srt_create_socket();
+    ASSERT_NE(client_sock, SRT_ERROR);
+
+    CEPoll epoll;
+    const int epoll_id = epoll.create();
+    ASSERT_GE(epoll_id, 0);
+
+    const int epoll_err = SRT_EPOLL_ERR | SRT_EPOLL_ET;
+    ASSERT_NE(epoll.update_usock(epoll_id, client_sock, &epoll_err), SRT_ERROR);
+
+    const int fd = epoll.notify_fd(epoll_id);
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(epoll.notify_fd(epoll_id), fd);
+
+    pollfd pfd = {fd, POLLIN, 0};
+    EXPECT_EQ(poll(&pfd, 1, 0), 0);
+
+    set<int> epoll_ids = { epoll_id };
+    epoll.update_events(client_sock, epoll_ids, SRT_EPOLL_ERR, true);
+    EXPECT_EQ(poll(&pfd, 1, 0), 1);
+    // Still readable, as nothing was consumed.
+    EXPECT_EQ(poll(&pfd, 1, 0), 1);
+
+    SRT_EPOLL_EVENT fds[8];
+    ASSERT_EQ(epoll.uwait(epoll_id, fds, 8, 0), 1);
+    EXPECT_EQ(poll(&pfd, 1, 0), 0);
+
+    EXPECT_EQ(epoll.release(epoll_id), 0);
+    EXPECT_THROW(epoll.notify_fd(epoll_id), CUDTException);
+}
+#endif
+
+/// A thread waiting on one EID is woken up by the event, and one waiting
+/// without a timeout gets an error when its EID is released.
+TEST(CEPoll, WakeupWaiting)
+{
+    srt::TestInit srtinit;
+
+    srt::UniqueSocket client_sock = srt_create_socket();
+    ASSERT_NE(client_sock, SRT_ERROR);
+
+    CEPoll epoll;
+    const int ready_eid = epoll.create();
+    const int idle_eid  = epoll.create();
+    const int epoll_in  = SRT_EPOLL_IN;
+    ASSERT_NE(epoll.update_usock(ready_eid, client_sock, &epoll_in), SRT_ERROR);
+    ASSERT_NE(epoll.update_usock(idle_eid, client_sock, &epoll_in), SRT_ERROR);
+
+    auto ready_wait = async(launch::async, [&] {
+        SRT_EPOLL_EVENT fds[8];
+        return epoll.uwait(ready_eid, fds, 8, 5000);
+    });
+    auto idle_wait = async(launch::async, [&] {
+        SRT_EPOLL_EVENT fds[8];
+        try
+        {
+            return epoll.uwait(idle_eid, fds, 8, -1);
+        }
+        catch (const CUDTException& e)
+        {
+            return e.getErrorCode() == CUDTException(MJ_NOTSUP, MN_EIDINVAL).getErrorCode() ? -2 : -3;
+        }
+    });
+
+    this_thread::sleep_for(chrono::milliseconds(50));
+    set<int> epoll_ids = { ready_eid };
+    const auto start = chrono::steady_clock::now();
+    epoll.update_events(client_sock, epoll_ids, SRT_EPOLL_IN, true);
+    EXPECT_EQ(ready_wait.get(), 1);
+    EXPECT_LT(chrono::steady_clock::now() - start, chrono::seconds(1));
+
+    EXPECT_EQ(idle_wait.wait_for(chrono::milliseconds(50)), future_status::timeout);
+    EXPECT_EQ(epoll.release(idle_eid), 0);
+    ASSERT_EQ(idle_wait.wait_for(chrono::seconds(2)), future_status::ready);
+    EXPECT_EQ(idle_wait.get(), -2);
+
+    EXPECT_EQ(epoll.release(ready_eid), 0);
+}
+
 TEST(CEPoll, HandleEpollNoEvent)
 {
     srt::TestInit srtinit;
@@ -917,3 +917,42 @@ TEST_F(TestFECRebuilding, Rebuild)
 
     EXPECT_EQ(memcmp(skipped.data(), rebuilt.data(), rebuilt.size()), 0);
 }
+
+// Every XOR kernel gives the same result as XOR-ing byte by byte,
+// whatever the length and the alignment of the buffers.
+TEST(TestFEC, XorKernels)
+{
+    const vector<XorKernel> kernels = supportedXorKernels();
+    ASSERT_FALSE(kernels.empty());
+
+    vector<char> src(1500 + 64), dst(1500 + 64);
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = char(i * 7 + 3);
+        dst[i] = char(i * 13 + 1);
+    }
+
+    for (size_t k = 0; k < kernels.size(); ++k)
+    {
+        for (size_t len = 0; len <= 300; ++len)
+        {
+            for (size_t offset = 0; offset < 4; ++offset)
+            {
+                vector<char> expected = dst, result = dst;
+                for (size_t i = 0; i < len; ++i)
+                    expected[offset + i] ^= src[i + 1];
+
+                kernels[k].fn(&result[offset], &src[1], len);
+                ASSERT_EQ(result, expected) << kernels[k].name << " len=" << len << " offset=" << offset;
+            }
+        }
+    }
+
+    CAlignedBuffer clip;
+    clip.resize(1456);
+    EXPECT_EQ(reinterpret_cast<size_t>(clip.data()) % CAlignedBuffer::ALIGNMENT, 0U);
+    EXPECT_EQ(count(clip.data(), clip.data() + clip.size(), 0), 1456);
+    xorInto(clip.data(), &src[0], 1316);
+    EXPECT_EQ(memcmp(clip.data(), &src[0], 1316), 0);
+    EXPECT_EQ(count(clip.data() + 1316, clip.data() + clip.size(), 0), 1456 - 1316);
+}
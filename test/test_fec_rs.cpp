@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "packet.h"
+#include "fec_rs.h"
+#include "core.h"
+#include "packetfilter.h"
+#include "packetfilter_api.h"
+
+using namespace std;
+using namespace srt;
+
+class TestRSRebuilding: public srt::Test
+{
+protected:
+    unique_ptr<RSFilterBuiltin> snd, rcv;
+    vector<SrtPacket> snd_provided, provided;
+    vector<unique_ptr<CPacket>> source;
+    int sockid = 54321;
+    int isn = 123456;
+    size_t plsize = 1316;
+
+    TestRSRebuilding()
+    {
+        // Required to make ParseFilterConfig find the filter
+        PacketFilter::globalInit();
+    }
+
+    void setup() override
+    {
+    }
+
+    void teardown() override
+    {
+    }
+
+    SrtFilterInitializer initializer() const
+    {
+        SrtFilterInitializer init = {sockid, isn - 1, isn - 1, plsize, CSrtConfig::DEF_BUFFER_SIZE};
+        return init;
+    }
+
+    void restartReceiver(const string& conf)
+    {
+        provided.clear();
+        rcv.reset(new RSFilterBuiltin(initializer(), provided, conf));
+    }
+
+    void configure(const string& conf, size_t npackets)
+    {
+        snd.reset(new RSFilterBuiltin(initializer(), snd_provided, conf));
+        restartReceiver(conf);
+
+        source.clear();
+        int32_t seq = isn;
+        for (size_t i = 0; i < npackets; ++i)
+        {
+            source.emplace_back(new CPacket);
+            CPacket& p = *source.back();
+            p.allocate(SRT_LIVE_MAX_PLSIZE);
+
+            uint32_t* hdr = p.getHeader();
+            hdr[SRT_PH_SEQNO] = seq;
+            hdr[SRT_PH_MSGNO] = int32_t(i + 1) | MSGNO_PACKET_BOUNDARY::wrap(PB_SOLO) | MSGNO_ENCKEYSPEC::wrap(i % 3);
+            hdr[SRT_PH_ID] = sockid;
+            hdr[SRT_PH_TIMESTAMP] = 10 * int(i) + 7;
+
+            const size_t length = 100 + (i * 377) % (plsize - 100);
+            p.setLength(length);
+            for (size_t b = 0; b < length; ++b)
+                p.data()[b] = char(rand());
+
+            seq = CSeqNo::incseq(seq);
+        }
+    }
+
+    // Send all the source packets through the sender filter,
+    // returning them together with the repair packets in the sending order.
+    vector<unique_ptr<CPacket>> sendAll()
+    {
+        vector<unique_ptr<CPacket>> sent;
+        SrtPacket ctl(SRT_LIVE_MAX_PLSIZE);
+        int32_t lastseq = CSeqNo::decseq(isn);
+        size_t i = 0;
+        for (;;)
+        {
+            if (snd->packControlPacket(ctl, lastseq))
+            {
+                CPacket* p = new CPacket;
+                p->allocate(SRT_LIVE_MAX_PLSIZE);
+                memcpy(p->getHeader(), ctl.hdr, SRT_PH_E_SIZE * sizeof(uint32_t));
+                memcpy(p->data(), ctl.buffer, ctl.length);
+                p->setLength(ctl.length);
+                p->m_iMsgNo = SRT_MSGNO_CONTROL | MSGNO_PACKET_BOUNDARY::wrap(PB_SOLO);
+                sent.emplace_back(p);
+                continue;
+            }
+
+            if (i == source.size())
+                break;
+            snd->feedSource(*source[i]);
+            sent.emplace_back(source[i]->clone());
+            lastseq = source[i]->getSeqNo();
+            ++i;
+        }
+        return sent;
+    }
+
+    void expectRebuilt(const SrtPacket& rebuilt)
+    {
+        const int index = CSeqNo::seqoff(isn, rebuilt.hdr[SRT_PH_SEQNO]);
+        ASSERT_GE(index, 0);
+        ASSERT_LT(index, int(source.size()));
+        CPacket& orig = *source[index];
+
+        EXPECT_EQ(orig.getHeader()[SRT_PH_MSGNO] | MSGNO_REXMIT::wrap(true), rebuilt.hdr[SRT_PH_MSGNO]);
+        EXPECT_EQ(orig.getHeader()[SRT_PH_TIMESTAMP], rebuilt.hdr[SRT_PH_TIMESTAMP]);
+        EXPECT_EQ(uint32_t(sockid), rebuilt.hdr[SRT_PH_ID]);
+        ASSERT_EQ(orig.size(), rebuilt.size());
+        EXPECT_EQ(memcmp(orig.data(), rebuilt.data(), rebuilt.size()), 0);
+    }
+};
+
+TEST(TestRS, ConfigVerify)
+{
+    PacketFilter::globalInit();
+
+    const char* const good[] = {"rs", "rs,k:10", "rs,k:10,m:4", "rs,m:1,arq:never", "rs,k:250,m:6"};
+    const char* const bad[] = {"rs,k:0", "rs,m:0", "rs,k:250,m:7", "rs,k:10,arq:sometimes", "rs,k:10,cols:2"};
+
+    for (size_t i = 0; i < sizeof good / sizeof good[0]; ++i)
+    {
+        SrtFilterConfig cfg;
+        string error;
+        ASSERT_TRUE(ParseFilterConfig(good[i], (cfg))) << good[i];
+        EXPECT_EQ(cfg.extra_size, size_t(RSFilterBuiltin::EXTRA_SIZE));
+        EXPECT_TRUE(RSFilterBuiltin::verifyConfig(cfg, (error))) << good[i] << ": " << error;
+    }
+
+    for (size_t i = 0; i < sizeof bad / sizeof bad[0]; ++i)
+    {
+        SrtFilterConfig cfg;
+        string error;
+        ASSERT_TRUE(ParseFilterConfig(bad[i], (cfg))) << bad[i];
+        EXPECT_FALSE(RSFilterBuiltin::verifyConfig(cfg, (error))) << bad[i];
+    }
+
+    // The number of source packets is mandatory.
+    SrtFilterInitializer init = {54321, 0, 0, 1316, CSrtConfig::DEF_BUFFER_SIZE};
+    vector<SrtPacket> provided;
+    EXPECT_THROW(RSFilterBuiltin(init, provided, "rs,m:2"), CUDTException);
+}
+
+// Every GF(2^8) multiply-add kernel gives the same result as the tables.
+TEST(TestRS, GfKernels)
+{
+    for (int a = 1; a < 256; ++a)
+        ASSERT_EQ(gfMul(uint8_t(a), gfInv(uint8_t(a))), 1) << a;
+    EXPECT_EQ(gfMul(2, 0x80), 0x1D);
+
+    vector<char> src(1500), dst(1500);
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+        src[i] = char(i * 7 + 3);
+        dst[i] = char(i * 13 + 1);
+    }
+
+    const vector<GfMulAddKernel> kernels = supportedGfMulAddKernels();
+    ASSERT_FALSE(kernels.empty());
+    const uint8_t coefs[] = {0, 1, 2, 0x53, 0xFF};
+    for (size_t k = 0; k < kernels.size(); ++k)
+    {
+        for (size_t c = 0; c < sizeof coefs; ++c)
+        {
+            for (size_t len = 0; len <= 100; len += 1 + len / 8)
+            {
+                vector<char> expected = dst, result = dst;
+                for (size_t i = 0; i < len; ++i)
+                    expected[i + 1] ^= char(gfMul(coefs[c], uint8_t(src[i])));
+
+                kernels[k].fn(&result[1], &src[0], coefs[c], len);
+                ASSERT_EQ(result, expected) << kernels[k].name << " c=" << int(coefs[c]) << " len=" << len;
+
+                result = dst;
+                gfMulAddInto(&result[1], &src[0], coefs[c], len);
+                ASSERT_EQ(result, expected) << "gfMulAddInto c=" << int(coefs[c]) << " len=" << len;
+            }
+        }
+    }
+}
+
+// Any M packets lost out of the block, source or repair, are rebuilt.
+TEST_F(TestRSRebuilding, RebuildAnyLosses)
+{
+    const size_t k = 8, m = 3;
+    configure("rs,k:8,m:3", k);
+    const vector<unique_ptr<CPacket>> sent = sendAll();
+    ASSERT_EQ(sent.size(), k + m);
+
+    // All the combinations of up to M lost packets
+    for (unsigned mask = 0; mask < (1u << (k + m)); ++mask)
+    {
+        size_t nlost = 0, nlost_source = 0;
+        for (size_t i = 0; i < k + m; ++i)
+        {
+            if (mask & (1u << i))
+            {
+                ++nlost;
+                nlost_source += i < k;
+            }
+        }
+        if (nlost > m)
+            continue;
+
+        restartReceiver("rs,k:8,m:3");
+        size_t npassed = 0;
+        for (size_t i = 0; i < sent.size(); ++i)
+        {
+            if (mask & (1u << i))
+                continue;
+            RSFilterBuiltin::loss_seqs_t loss;
+            npassed += rcv->receive(*sent[i], (loss));
+            EXPECT_TRUE(loss.empty());
+        }
+
+        EXPECT_EQ(npassed, k - nlost_source);
+        ASSERT_EQ(provided.size(), nlost_source) << "mask=" << mask;
+        for (size_t i = 0; i < provided.size(); ++i)
+            expectRebuilt(provided[i]);
+    }
+}
+
+// With more than M losses, the lost packets are reported as soon as a
+// packet of the next block comes, and the next block is rebuilt.
+TEST_F(TestRSRebuilding, Irrecoverable)
+{
+    const size_t k = 10, m = 2;
+    configure("rs,k:10,m:2", 2 * k);
+    const vector<unique_ptr<CPacket>> sent = sendAll();
+    ASSERT_EQ(sent.size(), 2 * (k + m));
+
+    // Lost: 3 source packets in the first block, 2 in the second
+    const size_t lost[] = {1, 2, 5, 13, 20};
+    RSFilterBuiltin::loss_seqs_t reported;
+    for (size_t i = 0; i < sent.size(); ++i)
+    {
+        if (find(lost, lost + 5, i) != lost + 5)
+            continue;
+        RSFilterBuiltin::loss_seqs_t loss;
+        rcv->receive(*sent[i], (loss));
+        reported.insert(reported.end(), loss.begin(), loss.end());
+    }
+
+    ASSERT_EQ(reported.size(), 2U);
+    EXPECT_EQ(reported[0], make_pair(isn + 1, isn + 2));
+    EXPECT_EQ(reported[1], make_pair(isn + 5, isn + 5));
+
+    // The second block starts at the index 12 in the sent packets.
+    ASSERT_EQ(provided.size(), 2U);
+    for (size_t i = 0; i < provided.size(); ++i)
+        expectRebuilt(provided[i]);
+    EXPECT_EQ(provided[0].hdr[SRT_PH_SEQNO], uint32_t(isn + 11));
+    EXPECT_EQ(provided[1].hdr[SRT_PH_SEQNO], uint32_t(isn + 18));
+}
+
+// The configurations are merged with the defaults of the "rs" filter,
+// and a live transmission over a lossy link without ARQ gets every packet.
+TEST(TestRS, LiveTransmission)
+{
+    srt::TestInit srtinit;
+    const SRTSOCKET lsn = srt_create_socket(), clr = srt_create_socket();
+
+    const string link = "delay:5,loss:2,seed:3";
+    ASSERT_EQ(srt_setsockflag(lsn, SRTO_INPROC_LINK, link.c_str(), int(link.size())), 0);
+    ASSERT_EQ(srt_setsockflag(clr, SRTO_INPROC_LINK, link.c_str(), int(link.size())), 0);
+
+    const char config_clr [] = "rs,k:10,m:4";
+    const char config_lsn [] = "rs,arq:never";
+    ASSERT_EQ(srt_setsockflag(clr, SRTO_PACKETFILTER, config_clr, sizeof config_clr - 1), 0);
+    ASSERT_EQ(srt_setsockflag(lsn, SRTO_PACKETFILTER, config_lsn, sizeof config_lsn - 1), 0);
+
+    sockaddr_in sa = sockaddr_in();
+    sa.sin_family  = AF_INET;
+    sa.sin_port    = htons(5210);
+    ASSERT_EQ(inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr), 1);
+    ASSERT_EQ(srt_bind(lsn, (sockaddr*)&sa, sizeof sa), 0);
+    ASSERT_EQ(srt_listen(lsn, 1), 0);
+    ASSERT_EQ(srt_connect(clr, (sockaddr*)&sa, sizeof sa), 0);
+
+    const SRTSOCKET acc = srt_accept(lsn, NULL, NULL);
+    ASSERT_NE(acc, SRT_INVALID_SOCK);
+
+    char config[200] = "";
+    int  config_size = sizeof config;
+    EXPECT_EQ(srt_getsockflag(acc, SRTO_PACKETFILTER, config, &config_size), 0);
+    vector<string> params;
+    Split(string(config, config_size), ',', back_inserter(params));
+    sort(params.begin(), params.end());
+    EXPECT_EQ(params, vector<string>({"arq:never", "k:10", "m:4", "rs"}));
+
+    const int n = 500;
+    const int size = 1316;
+    thread receiver([&] {
+        char buf[1500];
+        for (int i = 0; i < n; ++i)
+        {
+            ASSERT_EQ(srt_recv(acc, buf, sizeof buf), size);
+            EXPECT_EQ(buf[0], char(i % 100));
+        }
+    });
+
+    vector<char> payload(size);
+    for (int i = 0; i < n; ++i)
+    {
+        payload[0] = char(i % 100);
+        ASSERT_EQ(srt_send(clr, &payload[0], size), size);
+        std::this_thread::sleep_for(chrono::microseconds(500));
+    }
+    receiver.join();
+
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(acc, &stats, 0), 0);
+    EXPECT_GT(stats.pktRcvFilterSupplyTotal, 0);
+    EXPECT_EQ(stats.pktRcvDropTotal, 0);
+
+    srt_close(acc);
+    srt_close(clr);
+    srt_close(lsn);
+}
@@ -28,7 +28,9 @@
 
 //#pragma comment (lib, "ws2_32.lib")
 
-TEST(Transmission, FileUpload)
+typedef std::vector< std::pair<SRT_SOCKOPT, int> > IntOptions;
+
+static void TestFileUpload(const IntOptions& options)
 {
     srt::TestInit srtinit;
 
@@ -42,6 +44,12 @@ TEST(Transmission, FileUpload)
     srt_setsockflag(sock_lsn, SRTO_TRANSTYPE, &tt, sizeof tt);
     srt_setsockflag(sock_clr, SRTO_TRANSTYPE, &tt, sizeof tt);
 
+    for (IntOptions::const_iterator i = options.begin(); i != options.end(); ++i)
+    {
+        ASSERT_NE(srt_setsockflag(sock_lsn, i->first, &i->second, sizeof i->second), SRT_ERROR);
+        ASSERT_NE(srt_setsockflag(sock_clr, i->first, &i->second, sizeof i->second), SRT_ERROR);
+    }
+
     // Configure listener 
     sockaddr_in sa_lsn = sockaddr_in();
     sa_lsn.sin_family = AF_INET;
@@ -197,3 +205,46 @@ TEST(Transmission, FileUpload)
     remove("file.target");
 
 }
+
+TEST(Transmission, FileUpload)
+{
+    TestFileUpload(IntOptions());
+}
+
+TEST(Transmission, FileUploadBatchedRead)
+{
+    IntOptions options;
+    options.push_back(std::make_pair(SRTO_UDP_RCVBATCH, 32));
+    TestFileUpload(options);
+}
+
+TEST(Transmission, FileUploadBatchedSend)
+{
+    IntOptions options;
+    options.push_back(std::make_pair(SRTO_UDP_SNDBATCH, 32));
+    TestFileUpload(options);
+}
+
+TEST(Transmission, FileUploadIoUring)
+{
+    IntOptions options;
+    options.push_back(std::make_pair(SRTO_UDP_IOURING, 1));
+    options.push_back(std::make_pair(SRTO_UDP_RCVBATCH, 32));
+    options.push_back(std::make_pair(SRTO_UDP_SNDBATCH, 32));
+    TestFileUpload(options);
+}
+
+TEST(Transmission, FileUploadRcvWorkers)
+{
+    IntOptions options;
+    options.push_back(std::make_pair(SRTO_RCVWORKERS, 4));
+    TestFileUpload(options);
+}
+
+TEST(Transmission, FileUploadSndWorkers)
+{
+    IntOptions options;
+    options.push_back(std::make_pair(SRTO_SNDWORKERS, 4));
+    options.push_back(std::make_pair(SRTO_UDP_SNDBATCH, 32));
+    TestFileUpload(options);
+}
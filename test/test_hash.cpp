@@ -0,0 +1,134 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "queue.h"
+
+using namespace std;
+using namespace srt;
+
+namespace
+{
+
+// The socket instances are never accessed by CHash, so any distinct pointer values will do.
+CUDT* fakeSocket(int32_t id)
+{
+    return reinterpret_cast<CUDT*>(static_cast<intptr_t>(id) * 16);
+}
+
+// Socket IDs are assigned in decreasing order, starting from a random value.
+vector<int32_t> makeSocketIDs(size_t count)
+{
+    vector<int32_t> ids;
+    int32_t         id = 0x2345678;
+    for (size_t i = 0; i < count; ++i)
+        ids.push_back(id--);
+    return ids;
+}
+
+} // namespace
+
+TEST(CHash, InsertLookupRemove)
+{
+    CHash hash;
+    hash.init(4);
+
+    EXPECT_EQ(hash.lookup(100), nullptr);
+
+    hash.insert(100, fakeSocket(100));
+    hash.insert(101, fakeSocket(101));
+    EXPECT_EQ(hash.size(), 2);
+    EXPECT_EQ(hash.lookup(100), fakeSocket(100));
+    EXPECT_EQ(hash.lookup(101), fakeSocket(101));
+    EXPECT_EQ(hash.lookup(102), nullptr);
+
+    hash.remove(100);
+    EXPECT_EQ(hash.size(), 1);
+    EXPECT_EQ(hash.lookup(100), nullptr);
+    EXPECT_EQ(hash.lookup(101), fakeSocket(101));
+
+    // Removing a missing entry does nothing.
+    hash.remove(100);
+    hash.remove(555);
+    EXPECT_EQ(hash.size(), 1);
+
+    hash.insert(100, fakeSocket(100));
+    EXPECT_EQ(hash.lookup(100), fakeSocket(100));
+}
+
+/// The table is initialized for a few entries, but must hold as many as inserted,
+/// also when the entries are often removed and new ones inserted.
+TEST(CHash, GrowAndChurn)
+{
+    CHash hash;
+    hash.init(16);
+
+    const vector<int32_t> ids = makeSocketIDs(50000);
+    for (int32_t id : ids)
+        hash.insert(id, fakeSocket(id));
+    ASSERT_EQ(hash.size(), 50000);
+
+    for (size_t i = 0; i < ids.size(); i += 2)
+        hash.remove(ids[i]);
+    ASSERT_EQ(hash.size(), 25000);
+
+    for (size_t i = 0; i < ids.size(); ++i)
+        ASSERT_EQ(hash.lookup(ids[i]), i % 2 ? fakeSocket(ids[i]) : nullptr) << "i=" << i;
+
+    const vector<int32_t> more = makeSocketIDs(200000);
+    for (size_t i = 50000; i < more.size(); ++i)
+    {
+        hash.insert(more[i], fakeSocket(more[i]));
+        hash.remove(more[i - 1000]);
+    }
+
+    // The last 1000 of the first entries were removed by the loop above.
+    for (size_t i = 1; i < ids.size() - 1000; i += 2)
+        ASSERT_EQ(hash.lookup(ids[i]), fakeSocket(ids[i])) << "i=" << i;
+    for (size_t i = more.size() - 1000; i < more.size(); ++i)
+        ASSERT_EQ(hash.lookup(more[i]), fakeSocket(more[i])) << "i=" << i;
+}
+
+/// Lookups from other threads don't need any locking, while one thread modifies the table.
+TEST(CHash, ConcurrentLookup)
+{
+    CHash hash;
+    hash.init(16);
+
+    const vector<int32_t> stable = makeSocketIDs(1000);
+    for (int32_t id : stable)
+        hash.insert(id, fakeSocket(id));
+
+    atomic<bool> done(false);
+    atomic<int>  failures(0);
+
+    vector<thread> readers;
+    for (int r = 0; r < 3; ++r)
+    {
+        readers.emplace_back([&, r]() {
+            size_t i = r;
+            while (!done)
+            {
+                const int32_t id = stable[i++ % stable.size()];
+                if (hash.lookupShared(id) != fakeSocket(id))
+                    ++failures;
+            }
+        });
+    }
+
+    // Grow the table several times and reuse the removed slots.
+    const int32_t first = stable.back() - 1;
+    for (int32_t id = first; id > first - 100000; --id)
+    {
+        hash.insert(id, fakeSocket(id));
+        if (id < first - 500)
+            hash.remove(id + 500);
+    }
+
+    done = true;
+    for (thread& t : readers)
+        t.join();
+
+    EXPECT_EQ(failures, 0);
+}
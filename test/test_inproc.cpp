@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "channel.h"
+#include "inproc.h"
+#include "srt.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::sync;
+
+namespace
+{
+
+const int PAYLOAD_SIZE = 1316;
+
+// A pair of channels on the in-process link, the receiver with the given impairments.
+struct InprocPair
+{
+    CChannel     snd, rcv;
+    sockaddr_any rcvaddr;
+
+    InprocPair(const string& link)
+    {
+        CSrtMuxerConfig cfg;
+        cfg.sInprocLink    = link;
+        cfg.iUDPRcvBufSize = 8 * 1024 * 1024;
+        rcv.setConfig(cfg);
+        snd.setConfig(cfg);
+        in_addr lo;
+        lo.s_addr = htonl(INADDR_LOOPBACK);
+        rcv.open(sockaddr_any(lo, 0));
+        snd.open(AF_INET);
+        rcv.getSockAddr((rcvaddr));
+    }
+
+    ~InprocPair()
+    {
+        snd.close();
+        rcv.close();
+    }
+
+    void send(int32_t seq)
+    {
+        CPacket pkt;
+        pkt.allocate(PAYLOAD_SIZE);
+        pkt.m_iSeqNo     = seq;
+        pkt.m_iMsgNo     = 1 | MSGNO_PACKET_BOUNDARY::wrap(PB_SOLO);
+        pkt.m_iTimeStamp = 0;
+        pkt.m_iID        = 0;
+        memset(pkt.data(), 'a' + seq % 26, PAYLOAD_SIZE);
+        pkt.setLength(PAYLOAD_SIZE);
+        snd.sendto(rcvaddr, pkt, sockaddr_any(AF_INET));
+    }
+
+    // Receive until nothing comes for 100 ms; returns the sequence numbers in the order of receiving.
+    vector<int32_t> receiveAll()
+    {
+        vector<int32_t> seqs;
+        CPacket         pkt;
+        pkt.allocate(CInprocEndpoint::MAX_DATAGRAM);
+        const steady_clock::time_point start = steady_clock::now();
+        steady_clock::time_point       last  = start;
+        while (steady_clock::now() - last < milliseconds_from(100))
+        {
+            pkt.setLength(CInprocEndpoint::MAX_DATAGRAM);
+            sockaddr_any from;
+            if (rcv.recvfrom((from), (pkt)) != RST_OK)
+                continue;
+            EXPECT_EQ(pkt.getLength(), size_t(PAYLOAD_SIZE));
+            EXPECT_EQ(pkt.data()[PAYLOAD_SIZE - 1], char('a' + pkt.m_iSeqNo % 26));
+            seqs.push_back(pkt.m_iSeqNo);
+            last = steady_clock::now();
+        }
+        return seqs;
+    }
+};
+
+} // namespace
+
+TEST(CInprocLink, ParseConfig)
+{
+    CInprocLinkModel m;
+    EXPECT_TRUE(CInprocLinkModel::parse("on", (m)));
+    EXPECT_TRUE(m.immediate());
+
+    EXPECT_TRUE(CInprocLinkModel::parse("delay:20,jitter:2.5,loss:1,reorder:0.5,reorderdelay:3,bandwidth:100,queue:50,seed:7", (m)));
+    EXPECT_EQ(m.iDelayUs, 20000);
+    EXPECT_EQ(m.iJitterUs, 2500);
+    EXPECT_DOUBLE_EQ(m.dLossRate, 0.01);
+    EXPECT_DOUBLE_EQ(m.dReorderRate, 0.005);
+    EXPECT_EQ(m.iReorderUs, 3000);
+    EXPECT_EQ(m.llBandwidth, 12500000);
+    EXPECT_EQ(m.iQueueUs, 50000);
+    EXPECT_EQ(m.uSeed, 7u);
+    EXPECT_FALSE(m.immediate());
+
+    EXPECT_FALSE(CInprocLinkModel::parse("", (m)));
+    EXPECT_FALSE(CInprocLinkModel::parse("delay", (m)));
+    EXPECT_FALSE(CInprocLinkModel::parse("delay:-1", (m)));
+    EXPECT_FALSE(CInprocLinkModel::parse("loss:101", (m)));
+    EXPECT_FALSE(CInprocLinkModel::parse("loss:1x", (m)));
+    EXPECT_FALSE(CInprocLinkModel::parse("speed:1", (m)));
+}
+
+TEST(CInprocLink, SocketOption)
+{
+    srt::TestInit srtinit;
+    const SRTSOCKET s = srt_create_socket();
+
+    const string link = "delay:10,loss:2";
+    EXPECT_EQ(srt_setsockflag(s, SRTO_INPROC_LINK, link.c_str(), int(link.size())), 0);
+    char buf[100];
+    int  len = sizeof buf;
+    EXPECT_EQ(srt_getsockflag(s, SRTO_INPROC_LINK, buf, &len), 0);
+    EXPECT_EQ(string(buf, len), link);
+
+    EXPECT_EQ(srt_setsockflag(s, SRTO_INPROC_LINK, "loss", 4), SRT_ERROR);
+    EXPECT_EQ(srt_setsockflag(s, SRTO_INPROC_LINK, "", 0), 0);
+
+    srt_close(s);
+}
+
+/// All the packets come in order, and the port can't be bound twice.
+TEST(CInprocLink, Delivery)
+{
+    InprocPair link("on");
+    EXPECT_NE(link.rcvaddr.hport(), 0);
+
+    CChannel other;
+    CSrtMuxerConfig cfg;
+    cfg.sInprocLink = "on";
+    other.setConfig(cfg);
+    EXPECT_THROW(other.open(link.rcvaddr), CUDTException);
+
+    const int n = 1000;
+    for (int i = 0; i < n; ++i)
+        link.send(i);
+
+    const vector<int32_t> seqs = link.receiveAll();
+    ASSERT_EQ(seqs.size(), size_t(n));
+    for (int i = 0; i < n; ++i)
+        EXPECT_EQ(seqs[i], i);
+}
+
+/// With the same seed, the same packets are lost.
+TEST(CInprocLink, LossReproducible)
+{
+    const int       n = 2000;
+    vector<int32_t> runs[2];
+    for (int r = 0; r < 2; ++r)
+    {
+        InprocPair link("loss:10,seed:5");
+        for (int i = 0; i < n; ++i)
+            link.send(i);
+        runs[r] = link.receiveAll();
+    }
+
+    EXPECT_EQ(runs[0], runs[1]);
+    EXPECT_GT(runs[0].size(), size_t(n * 0.85));
+    EXPECT_LT(runs[0].size(), size_t(n * 0.95));
+}
+
+/// The packets are delivered after the delay, and the ones held back come out of order.
+TEST(CInprocLink, DelayAndReorder)
+{
+    InprocPair link("delay:30,reorder:20,reorderdelay:2");
+
+    const int                      n     = 200;
+    const steady_clock::time_point start = steady_clock::now();
+    for (int i = 0; i < n; ++i)
+    {
+        link.send(i);
+        std::this_thread::sleep_for(chrono::microseconds(100));
+    }
+
+    CPacket pkt;
+    pkt.allocate(CInprocEndpoint::MAX_DATAGRAM);
+    sockaddr_any from;
+    while (link.rcv.recvfrom((from), (pkt)) != RST_OK)
+        pkt.setLength(CInprocEndpoint::MAX_DATAGRAM);
+    EXPECT_GE(steady_clock::now() - start, milliseconds_from(30));
+    EXPECT_EQ(from.hport(), link.snd.bindAddressAny().hport());
+
+    vector<int32_t> seqs = link.receiveAll();
+    seqs.insert(seqs.begin(), pkt.m_iSeqNo);
+    ASSERT_EQ(seqs.size(), size_t(n));
+    EXPECT_FALSE(is_sorted(seqs.begin(), seqs.end()));
+    EXPECT_EQ(set<int32_t>(seqs.begin(), seqs.end()).size(), size_t(n));
+}
+
+/// A live transmission over a link with losses, recovered by retransmission.
+TEST(CInprocLink, LiveTransmission)
+{
+    srt::TestInit srtinit;
+    const SRTSOCKET lsn = srt_create_socket(), clr = srt_create_socket();
+
+    const string link = "delay:5,jitter:1,loss:3";
+    ASSERT_EQ(srt_setsockflag(lsn, SRTO_INPROC_LINK, link.c_str(), int(link.size())), 0);
+    ASSERT_EQ(srt_setsockflag(clr, SRTO_INPROC_LINK, link.c_str(), int(link.size())), 0);
+
+    sockaddr_in sa = sockaddr_in();
+    sa.sin_family  = AF_INET;
+    sa.sin_port    = htons(5200);
+    ASSERT_EQ(inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr), 1);
+    ASSERT_EQ(srt_bind(lsn, (sockaddr*)&sa, sizeof sa), 0);
+    ASSERT_EQ(srt_listen(lsn, 1), 0);
+    ASSERT_EQ(srt_connect(clr, (sockaddr*)&sa, sizeof sa), 0);
+
+    const SRTSOCKET acc = srt_accept(lsn, NULL, NULL);
+    ASSERT_NE(acc, SRT_INVALID_SOCK);
+
+    const int n = 500;
+    thread    receiver([&] {
+        char buf[1500];
+        for (int i = 0; i < n; ++i)
+        {
+            ASSERT_EQ(srt_recv(acc, buf, sizeof buf), PAYLOAD_SIZE);
+            EXPECT_EQ(buf[0], char(i % 100));
+        }
+    });
+
+    vector<char> payload(PAYLOAD_SIZE);
+    for (int i = 0; i < n; ++i)
+    {
+        payload[0] = char(i % 100);
+        ASSERT_EQ(srt_send(clr, &payload[0], PAYLOAD_SIZE), PAYLOAD_SIZE);
+        std::this_thread::sleep_for(chrono::microseconds(500));
+    }
+    receiver.join();
+
+    SRT_TRACEBSTATS stats;
+    EXPECT_EQ(srt_bstats(clr, &stats, 0), 0);
+    EXPECT_GT(stats.pktRetransTotal, 0);
+
+    srt_close(acc);
+    srt_close(clr);
+    srt_close(lsn);
+}
@@ -0,0 +1,126 @@
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "iouring.h"
+#include "srt_compat.h"
+#include "sync.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::sync;
+
+namespace
+{
+
+int bindLoopback(sockaddr_in& w_addr)
+{
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&w_addr, 0, sizeof w_addr);
+    w_addr.sin_family      = AF_INET;
+    w_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len          = sizeof w_addr;
+    if (fd == -1 || ::bind(fd, (sockaddr*)&w_addr, sizeof w_addr) == -1
+            || ::getsockname(fd, (sockaddr*)&w_addr, &len) == -1)
+        return -1;
+    return fd;
+}
+
+} // namespace
+
+/// The messages sent through one ring are received through another one into
+/// the buffers given to it, and the receiving returns with EAGAIN after the
+/// timeout when nothing comes.
+TEST(CIoUring, SendReceive)
+{
+    sockaddr_in rcvaddr, sndaddr;
+    const int   rcvfd = bindLoopback((rcvaddr));
+    const int   sndfd = bindLoopback((sndaddr));
+    ASSERT_NE(rcvfd, -1);
+    ASSERT_NE(sndfd, -1);
+
+    CIoUring sndring, rcvring;
+    if (!sndring.prepare() || !rcvring.prepareRecv(rcvfd))
+    {
+        ::close(rcvfd);
+        ::close(sndfd);
+        GTEST_SKIP() << "io_uring is not available in the system.";
+    }
+
+    const int       nsend = 5;
+    char            sndbuf[nsend][100];
+    iovec           sndiov[nsend];
+    vector<mmsghdr> sndmsgs(nsend);
+    for (int i = 0; i < nsend; ++i)
+    {
+        memset(sndbuf[i], 'a' + i, sizeof sndbuf[i]);
+        sndiov[i].iov_base             = sndbuf[i];
+        sndiov[i].iov_len              = 10 + i;
+        sndmsgs[i].msg_hdr.msg_name    = &rcvaddr;
+        sndmsgs[i].msg_hdr.msg_namelen = sizeof rcvaddr;
+        sndmsgs[i].msg_hdr.msg_iov     = &sndiov[i];
+        sndmsgs[i].msg_hdr.msg_iovlen  = 1;
+    }
+    ASSERT_EQ(sndring.sendmmsg(sndfd, &sndmsgs[0], nsend), nsend);
+    for (int i = 0; i < nsend; ++i)
+        EXPECT_EQ(sndmsgs[i].msg_len, 10u + i);
+
+    // The buffers to receive into, each message placed after the headroom.
+    const unsigned nbufs   = 8;
+    const size_t   bufsize = CIoUring::RECV_HEADROOM + 100;
+    vector<char>   rcvbufs(nbufs * bufsize);
+    for (unsigned bid = 0; bid < nbufs; ++bid)
+        rcvring.provideRecvBuffer(bid, &rcvbufs[bid * bufsize], bufsize);
+
+    // More messages requested than sent: only the waiting ones are taken.
+    // The messages may be received in more than one call.
+    vector<CIoUring::RecvMsg> rcvmsgs(nbufs);
+    int nrecvd = 0;
+    while (nrecvd < nsend)
+    {
+        const int res = rcvring.recvmsgs(&rcvmsgs[nrecvd], nbufs - nrecvd, 100000);
+        ASSERT_GT(res, 0) << SysStrError(errno);
+        nrecvd += res;
+    }
+    ASSERT_EQ(nrecvd, nsend);
+    for (int i = 0; i < nsend; ++i)
+    {
+        const CIoUring::RecvMsg& msg = rcvmsgs[i];
+        ASSERT_LT(msg.bid, nbufs);
+        ASSERT_EQ(msg.len, 10u + i);
+        EXPECT_EQ(memcmp(&rcvbufs[msg.bid * bufsize + CIoUring::RECV_HEADROOM], sndbuf[i], msg.len), 0);
+        ASSERT_GE(msg.namelen, sizeof(sockaddr_in));
+        EXPECT_EQ(((const sockaddr_in*)msg.name)->sin_port, sndaddr.sin_port);
+        rcvring.provideRecvBuffer(msg.bid, &rcvbufs[msg.bid * bufsize], bufsize);
+    }
+
+    const steady_clock::time_point start = steady_clock::now();
+    EXPECT_EQ(rcvring.recvmsgs(&rcvmsgs[0], nbufs, 20000), -1);
+    EXPECT_EQ(errno, EAGAIN);
+    EXPECT_GE(count_milliseconds(steady_clock::now() - start), 15);
+
+    // More messages than the buffers: these are given again after use.
+    for (int round = 0; round < 100; ++round)
+    {
+        ASSERT_EQ(sndring.sendmmsg(sndfd, &sndmsgs[0], nsend), nsend);
+        for (nrecvd = 0; nrecvd < nsend;)
+        {
+            const int res = rcvring.recvmsgs(&rcvmsgs[0], nbufs, 100000);
+            ASSERT_GT(res, 0) << SysStrError(errno);
+            for (int i = 0; i < res; ++i)
+            {
+                EXPECT_EQ(rcvmsgs[i].len, 10u + nrecvd + i);
+                rcvring.provideRecvBuffer(rcvmsgs[i].bid, &rcvbufs[rcvmsgs[i].bid * bufsize], bufsize);
+            }
+            nrecvd += res;
+        }
+        ASSERT_EQ(nrecvd, nsend);
+    }
+
+    // No buffer is written into afterwards.
+    EXPECT_TRUE(rcvring.cancelRecv());
+
+    ::close(rcvfd);
+    ::close(sndfd);
+}
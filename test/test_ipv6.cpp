@@ -1,4 +1,5 @@
 #include <thread>
+#include <future>
 #include <string>
 #include "gtest/gtest.h"
 #include "test_env.h"
@@ -61,6 +62,7 @@ public:
             srt_close(m_listener_sock);
 
         PrintAddresses(m_caller_sock, "CALLER");
+        m_caller_done.set_value();
     }
 
     std::map<int, std::string> fam = { {AF_INET, "IPv4"}, {AF_INET6, "IPv6"} };
@@ -94,6 +96,8 @@ public:
                 << "EMPTY address in srt_getsockname";
         }
 
+        // Closing breaks the caller's connection, which it must not see before it's done.
+        m_caller_done.get_future().wait();
         srt_close(accepted_sock);
         return sn;
     }
@@ -116,6 +120,7 @@ private:
 protected:
     SRTSOCKET m_caller_sock;
     SRTSOCKET m_listener_sock;
+    std::promise<void> m_caller_done;
     const int m_listen_port = 4200;
 };
 
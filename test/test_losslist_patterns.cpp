@@ -0,0 +1,289 @@
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "common.h"
+#include "list.h"
+#include "packet.h"
+
+using namespace std;
+using namespace srt;
+
+namespace
+{
+
+// Deterministic pseudo-random numbers, so that a failure can be reproduced.
+struct Random
+{
+    uint32_t state;
+    explicit Random(uint32_t seed) : state(seed) {}
+
+    uint32_t next()
+    {
+        state = state * 1103515245 + 12345;
+        return state >> 8;
+    }
+
+    int below(int n) { return int(next() % uint32_t(n)); }
+    bool chance(double p) { return next() % 1000000 < uint32_t(p * 1000000); }
+};
+
+// Sequence numbers relative to a start close to the wrap-around point.
+const int32_t START_SEQ = CSeqNo::m_iMaxSeqNo - 3000;
+
+int32_t seqAt(int off)
+{
+    return CSeqNo::incseq(START_SEQ, off);
+}
+
+// Decode a loss array as in a loss report.
+vector<pair<int32_t, int32_t> > decodeLossArray(const int32_t* array, int len)
+{
+    vector<pair<int32_t, int32_t> > ranges;
+    for (int i = 0; i < len; ++i)
+    {
+        if (array[i] & LOSSDATA_SEQNO_RANGE_FIRST)
+        {
+            ranges.push_back(make_pair(array[i] & ~LOSSDATA_SEQNO_RANGE_FIRST, array[i + 1]));
+            ++i;
+        }
+        else
+        {
+            ranges.push_back(make_pair(array[i], array[i]));
+        }
+    }
+    return ranges;
+}
+
+// Gilbert-Elliott model of the burst loss: in the bad state every packet is lost,
+// and the average loss rate is the given one with bursts of 4 packets in average.
+class BurstLoss
+{
+public:
+    BurstLoss(double rate, uint32_t seed)
+        : m_rnd(seed)
+        , m_bBad(false)
+        , m_dToBad(rate / (1 - rate) / 4)
+        , m_dToGood(0.25)
+    {
+    }
+
+    bool lost()
+    {
+        m_bBad = m_bBad ? !m_rnd.chance(m_dToGood) : m_rnd.chance(m_dToBad);
+        return m_bBad;
+    }
+
+private:
+    Random m_rnd;
+    bool   m_bBad;
+    double m_dToBad;
+    double m_dToGood;
+};
+
+} // namespace
+
+/// Random operations on the sender loss list give the same results as a set,
+/// also when the sequence numbers wrap around.
+TEST(LossListPatterns, SenderMatchesModel)
+{
+    const int    size = 1024;
+    CSndLossList list(size);
+    set<int>     model; // offsets from START_SEQ
+    Random       rnd(1);
+
+    int acked = 0;
+    for (int step = 0; step < 20000; ++step)
+    {
+        const int op = rnd.below(10);
+        if (op < 5)
+        {
+            // New losses start after the ACK point and within the size from the first loss.
+            const int first = model.empty() ? acked : *model.begin();
+            const int from  = max(acked, first + rnd.below(size / 2) - size / 8);
+            const int to    = from + rnd.below(20);
+
+            int expected = 0;
+            for (int i = from; i <= to; ++i)
+                expected += model.insert(i).second ? 1 : 0;
+
+            ASSERT_EQ(list.insert(seqAt(from), seqAt(to)), expected) << "step " << step;
+        }
+        else if (op < 8)
+        {
+            const int32_t seq = list.popLostSeq();
+            if (model.empty())
+            {
+                ASSERT_EQ(seq, SRT_SEQNO_NONE);
+                continue;
+            }
+            ASSERT_EQ(seq, seqAt(*model.begin())) << "step " << step;
+            acked = max(acked, *model.begin());
+            model.erase(model.begin());
+        }
+        else
+        {
+            acked += rnd.below(50);
+            list.removeUpTo(seqAt(acked));
+            model.erase(model.begin(), model.upper_bound(acked));
+        }
+        ASSERT_EQ(list.getLossLength(), (int)model.size()) << "step " << step;
+    }
+
+    // The batch insert gives the same result as the single ones.
+    CSndLossList::ranges_t ranges;
+    ranges.push_back(make_pair(seqAt(acked + 10), seqAt(acked + 12)));
+    ranges.push_back(make_pair(seqAt(acked + 11), seqAt(acked + 15)));
+    ranges.push_back(make_pair(seqAt(acked + 20), seqAt(acked + 20)));
+    while (list.popLostSeq() != SRT_SEQNO_NONE)
+        ;
+    EXPECT_EQ(list.insert(ranges), 7);
+    EXPECT_EQ(list.popLostSeq(), seqAt(acked + 10));
+}
+
+/// Random operations on the receiver loss list give the same results as a set,
+/// including the loss array sent in the loss report.
+TEST(LossListPatterns, ReceiverMatchesModel)
+{
+    const int    size = 1024;
+    CRcvLossList list(size);
+    set<int>     model; // offsets from START_SEQ
+    Random       rnd(2);
+
+    int next = 0; // next sequence to receive
+    for (int step = 0; step < 20000; ++step)
+    {
+        const int op = rnd.below(10);
+        if (op < 4)
+        {
+            // Packets arriving after a gap, while the span of the losses fits the size.
+            const int first = model.empty() ? next : *model.begin();
+            const int gap   = 1 + rnd.below(8);
+            if (next + gap - first >= size)
+            {
+                model.erase(model.begin(), model.upper_bound(next + gap - size));
+                list.removeUpTo(seqAt(next + gap - size));
+            }
+            else
+            {
+                ASSERT_EQ(list.insert(seqAt(next), seqAt(next + gap - 1)), gap);
+                for (int i = next; i < next + gap; ++i)
+                    model.insert(i);
+            }
+            next += gap + 1;
+            list.remove(seqAt(next - 1));
+        }
+        else if (op < 7 && !model.empty())
+        {
+            // A retransmitted packet, or one that was not lost.
+            const int  seq     = *model.begin() + rnd.below(next - *model.begin());
+            const bool removed = model.erase(seq) > 0;
+            ASSERT_EQ(list.remove(seqAt(seq)), removed) << "step " << step;
+        }
+        else if (op < 8 && !model.empty())
+        {
+            // Removing also marks the sequences as received, so not beyond the last one.
+            const int from = *model.begin() + rnd.below(next - *model.begin());
+            const int to   = min(from + rnd.below(10), next - 1);
+            model.erase(model.lower_bound(from), model.upper_bound(to));
+            list.remove(seqAt(from), seqAt(to));
+        }
+        else if (op < 9 && !model.empty())
+        {
+            const int from = *model.begin() - 5 + rnd.below(next - *model.begin() + 5);
+            const int to   = from + rnd.below(10);
+            const bool found = model.lower_bound(from) != model.upper_bound(to);
+            ASSERT_EQ(list.find(seqAt(from), seqAt(to)), found) << "step " << step;
+        }
+        else
+        {
+            int32_t array[64];
+            int     len = 0;
+            list.getLossArray(array, len, 64);
+            const vector<pair<int32_t, int32_t> > ranges = decodeLossArray(array, len);
+
+            set<int>::const_iterator m = model.begin();
+            for (size_t r = 0; r < ranges.size(); ++r)
+            {
+                for (int32_t s = ranges[r].first; CSeqNo::seqcmp(s, ranges[r].second) <= 0; s = CSeqNo::incseq(s))
+                {
+                    ASSERT_TRUE(m != model.end());
+                    ASSERT_EQ(s, seqAt(*m)) << "step " << step;
+                    ++m;
+                }
+                // Every range is complete.
+                if (m != model.end())
+                {
+                    ASSERT_NE(CSeqNo::incseq(ranges[r].second), seqAt(*m));
+                }
+            }
+        }
+
+        ASSERT_EQ(list.getLossLength(), (int)model.size()) << "step " << step;
+        ASSERT_EQ(list.getFirstLostSeq(), model.empty() ? SRT_SEQNO_NONE : seqAt(*model.begin()));
+    }
+}
+
+/// Benchmark: the receiver and sender loss lists replaying a transmission with burst
+/// losses at different rates. The receiver sends a loss report every 64 packets,
+/// the sender inserts it at once and retransmits, and the retransmission may be lost again.
+TEST(LossListPatterns, Benchmark)
+{
+    const int    window   = 8192;
+    const int    npackets = 500000;
+    const double rates[]  = {0.001, 0.01, 0.05, 0.1, 0.2};
+
+    for (size_t r = 0; r < sizeof rates / sizeof rates[0]; ++r)
+    {
+        CRcvLossList rcv(window);
+        CSndLossList snd(window * 2);
+        BurstLoss    loss(rates[r], 42);
+        Random       rnd(7);
+        int32_t      array[350];
+        int64_t      nlost = 0, nrexmit = 0;
+
+        const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        int last_rcvd = -1;
+        for (int seq = 0; seq < npackets; ++seq)
+        {
+            if (loss.lost())
+            {
+                ++nlost;
+            }
+            else
+            {
+                if (seq > last_rcvd + 1)
+                    rcv.insert(seqAt(last_rcvd + 1), seqAt(seq - 1));
+                last_rcvd = seq;
+            }
+
+            if (seq % 64 == 63)
+            {
+                int len = 0;
+                rcv.getLossArray(array, len, 350);
+                snd.insert(decodeLossArray(array, len));
+
+                for (int32_t lost = snd.popLostSeq(); lost != SRT_SEQNO_NONE; lost = snd.popLostSeq())
+                {
+                    ++nrexmit;
+                    if (!loss.lost())
+                        rcv.remove(lost);
+                }
+
+                // The packets too old are dropped (ACK and TLPKTDROP).
+                if (seq > window / 2)
+                {
+                    rcv.removeUpTo(seqAt(seq - window / 2));
+                    snd.removeUpTo(seqAt(seq - window / 2));
+                }
+            }
+        }
+        const double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+        cout << "[ BENCH    ] loss " << rates[r] * 100 << "%: " << nlost << " lost, " << nrexmit
+             << " retransmitted, " << ns / npackets << " ns/packet\n";
+        EXPECT_LE(rcv.getLossLength(), window);
+    }
+}
@@ -1,8 +1,11 @@
 #include <iostream>
+#include <thread>
 #include "gtest/gtest.h"
 #include "test_env.h"
 #include "common.h"
 #include "list.h"
+#include "core.h"
+#include "api.h"
 
 using namespace std;
 using namespace srt;
@@ -137,3 +140,130 @@ TEST(CRcvFreshLossListTest, CheckFreshLossList)
     EXPECT_EQ(floss.size(), 4);
 
 }
+
+namespace srt {
+    /// The receiver state of a socket, driven without a connection.
+    class TestMockRcvLoss
+    {
+    public:
+        TestMockRcvLoss(CUDT& core, int32_t isn, int size)
+            : m_core(core)
+            , m_units(size, 1500)
+        {
+            m_core.m_pRcvBuffer     = new CRcvBuffer(isn, size, &m_units, true);
+            m_core.m_pRcvLossList   = new CRcvLossList(size);
+            m_core.m_iRcvCurrSeqNo  = CSeqNo::decseq(isn);
+        }
+
+        ~TestMockRcvLoss()
+        {
+            delete m_core.m_pRcvBuffer;
+            m_core.m_pRcvBuffer = NULL;
+            delete m_core.m_pRcvLossList;
+            m_core.m_pRcvLossList = NULL;
+        }
+
+        /// What the receiving thread does first for a packet past a gap: insert it,
+        /// without m_RcvBufferLock, which makes it readable.
+        /// @return The gap, to be passed to recordLoss().
+        CUDT::loss_seqs_t insertAfterGap(int32_t seqno)
+        {
+            CUnit* unit = m_units.reserveNextAvailUnit();
+            EXPECT_NE(unit, nullptr);
+            CPacket& packet = unit->m_Packet;
+            packet.m_iSeqNo     = seqno;
+            packet.m_iTimeStamp = 0;
+            packet.m_iMsgNo     = 1 | PacketBoundaryBits(PB_SOLO) | MSGNO_PACKET_INORDER::wrap(1);
+            packet.setLength(1316);
+            EXPECT_EQ(m_core.m_pRcvBuffer->insert(unit), 0);
+            m_units.releaseUnit(unit);
+
+            const int32_t seqlo = CSeqNo::incseq(m_core.m_iRcvCurrSeqNo);
+            m_core.m_iRcvCurrSeqNo = seqno;
+            return CUDT::loss_seqs_t(1, make_pair(seqlo, CSeqNo::decseq(seqno)));
+        }
+
+        /// What the receiving thread does next.
+        void recordLoss(const CUDT::loss_seqs_t& seqs) { m_core.recordRcvLoss(seqs, 0); }
+
+        /// What the TSBPD thread does for a packet due.
+        void dropTooLateUpTo(int32_t seqno)
+        {
+            sync::ScopedLock lck(m_core.m_RcvBufferLock);
+            m_core.rcvDropTooLateUpTo(seqno);
+        }
+
+        int32_t firstLoss()
+        {
+            sync::ScopedLock lck(m_core.m_RcvLossLock);
+            return m_core.m_pRcvLossList->getFirstLostSeq();
+        }
+
+        int32_t bufferStart() const { return m_core.m_pRcvBuffer->getStartSeqNo(); }
+
+    private:
+        CUDT&      m_core;
+        CUnitQueue m_units;
+    };
+}
+
+/// A packet inserted past a gap is readable before its loss is recorded, so the TSBPD thread
+/// may drop the gap in between. The loss must not remain recorded behind the buffer start,
+/// which would make the ACK go backwards.
+TEST(CRcvLossRecord, RaceWithDropTooLate)
+{
+    srt::TestInit srtinit;
+
+    CUDTSocket* s = NULL;
+    const SRTSOCKET sid = CUDT::uglobal().newSocket(&s);
+    ASSERT_NE(s, nullptr);
+
+    const int32_t isn = CSeqNo::m_iMaxSeqNo - 500; // Wraps around during the test
+    {
+        TestMockRcvLoss rcv(s->core(), isn, 64);
+
+        // The TSBPD thread drops the gap after the packet was inserted, before the loss is recorded.
+        int32_t pktseq = CSeqNo::incseq(isn, 10);
+        const CUDT::loss_seqs_t gap = rcv.insertAfterGap(pktseq);
+        rcv.dropTooLateUpTo(pktseq);
+        rcv.recordLoss(gap);
+        EXPECT_EQ(rcv.firstLoss(), SRT_SEQNO_NONE);
+        EXPECT_EQ(rcv.bufferStart(), pktseq);
+
+        // Both at a time.
+        int32_t seqno = CSeqNo::incseq(pktseq);
+        rcv.dropTooLateUpTo(seqno);
+        for (int i = 0; i < 2000; ++i)
+        {
+            pktseq = CSeqNo::incseq(seqno, 10);
+
+            sync::atomic<bool> go(false);
+            std::thread receiver([&] {
+                while (!go) {}
+                rcv.recordLoss(rcv.insertAfterGap(pktseq));
+            });
+            std::thread tsbpd([&] {
+                while (!go) {}
+                rcv.dropTooLateUpTo(pktseq);
+            });
+            go = true;
+            receiver.join();
+            tsbpd.join();
+
+            const int32_t first = rcv.firstLoss();
+            if (first != SRT_SEQNO_NONE)
+            {
+                ASSERT_GE(CSeqNo::seqcmp(first, rcv.bufferStart()), 0)
+                    << "Iteration " << i << ": loss %" << first << " behind the buffer start %" << rcv.bufferStart();
+            }
+
+            // Drop the packet too, for the next gap to start after it.
+            seqno = CSeqNo::incseq(pktseq);
+            rcv.dropTooLateUpTo(seqno);
+            ASSERT_EQ(rcv.firstLoss(), SRT_SEQNO_NONE);
+            ASSERT_EQ(rcv.bufferStart(), seqno);
+        }
+    }
+
+    srt_close(sid);
+}
@@ -167,6 +167,7 @@ const OptionTestEntry g_test_matrix_options[] =
     //SRTO_BINDTODEVICE
     //{ SRTO_CONGESTION,      "SRTO_CONGESTION",  RestrictionType::PRE,               4,           "live",     "file",   "live",       "file",   {"liv", ""} },
     { SRTO_CONNTIMEO,        "SRTO_CONNTIMEO",  RestrictionType::PRE,     sizeof(int),                0,  INT32_MAX,     3000,          250,   {-1} },
+    { SRTO_CRYPTOAHEAD,    "SRTO_CRYPTOAHEAD",  RestrictionType::PRE,    sizeof(bool),            false,       true,    false,         true,     {} },
     { SRTO_DRIFTTRACER,    "SRTO_DRIFTTRACER",  RestrictionType::POST,   sizeof(bool),            false,       true,     true,        false,     {} },
     { SRTO_ENFORCEDENCRYPTION, "SRTO_ENFORCEDENCRYPTION", RestrictionType::PRE, sizeof(bool),     false,       true,     true,        false,     {} },
     //SRTO_EVENT
@@ -175,8 +176,10 @@ const OptionTestEntry g_test_matrix_options[] =
 #if ENABLE_BONDING
     // Max value can't exceed SRTO_PEERIDLETIMEO
     { SRTO_GROUPMINSTABLETIMEO, "SRTO_GROUPMINSTABLETIMEO", RestrictionType::PRE, sizeof(int),       60,       5000,       60,           70,     {0, -1, 50, 5001} },
+    { SRTO_GROUPRCVBUF,    "SRTO_GROUPRCVBUF",  RestrictionType::PRE,    sizeof(bool),            false,       true,    false,         true,     {} },
 #endif
     //SRTO_GROUPTYPE
+    //SRTO_INPROC_LINK
     //SRTO_INPUTBW
     //SRTO_IPTOS
     //SRTO_IPTTL
@@ -224,6 +227,12 @@ const OptionTestEntry g_test_matrix_options[] =
     { SRTO_TLPKTDROP,        "SRTO_TLPKTDROP",  RestrictionType::PRE,    sizeof(bool),             false,      true,     true, false, {} },
     //SRTO_TRANSTYPE
     //SRTO_TSBPDMODE
+    { SRTO_UDP_IOURING,  "SRTO_UDP_IOURING",  RestrictionType::PREBIND, sizeof(bool),         false,      true,     false,        true, {} },
+    { SRTO_UDP_RCVBATCH, "SRTO_UDP_RCVBATCH", RestrictionType::PREBIND, sizeof(int),              1,        64,        1,          16, {0, -1, 65} },
+    { SRTO_UDP_SNDBATCH, "SRTO_UDP_SNDBATCH", RestrictionType::PREBIND, sizeof(int),              1,        64,        1,          16, {0, -1, 65} },
+    { SRTO_RCVWORKERS,   "SRTO_RCVWORKERS",   RestrictionType::PREBIND, sizeof(int),              1,        16,        1,           4, {0, -1, 17} },
+    { SRTO_SNDWORKERS,   "SRTO_SNDWORKERS",   RestrictionType::PREBIND, sizeof(int),              1,        16,        1,           4, {0, -1, 17} },
+    { SRTO_RCVUNITS,     "SRTO_RCVUNITS",     RestrictionType::PREBIND, sizeof(int),             32,   1048576,      128,        8192, {0, -1, 31, 1048577} },
     //SRTO_UDP_RCVBUF
     //SRTO_UDP_SNDBUF
     //SRTO_VERSION
@@ -0,0 +1,189 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "api.h"
+#include "socket_table.h"
+
+using namespace std;
+using namespace srt;
+
+namespace
+{
+
+// Sockets with the IDs given, as generated by CUDTUnited: one after another, backward.
+struct SocketSet
+{
+    vector<unique_ptr<CUDTSocket>> sockets;
+
+    SocketSet(SRTSOCKET first, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            sockets.emplace_back(new CUDTSocket);
+            sockets.back()->m_SocketID = first - i;
+        }
+    }
+
+    void insertInto(CSocketTable& table)
+    {
+        for (auto& s : sockets)
+            table.insert(s->m_SocketID, s.get());
+    }
+};
+
+CUDTSocket* find(const CSocketTable& table, SRTSOCKET u)
+{
+    CSocketTable::Reader r(table, u);
+    return r.socket();
+}
+
+// Release the socket, passing through the epochs as many
+// times as needed when there are no readers.
+void releaseAll(CSocketTable& table, SocketSet& set)
+{
+    for (auto& s : set.sockets)
+        EXPECT_FALSE(table.release(s.get()));
+    table.collect();
+    table.collect();
+    for (auto& s : set.sockets)
+        EXPECT_TRUE(table.release(s.get()));
+}
+
+} // namespace
+
+TEST(CSocketTable, LookupAndGrow)
+{
+    CSocketTable table;
+    SocketSet    set(5000, 1000); // More than fits in the initial array
+    set.insertInto(table);
+    EXPECT_EQ(table.size(), 1000u);
+
+    for (auto& s : set.sockets)
+        EXPECT_EQ(find(table, s->m_SocketID), s.get());
+
+    EXPECT_EQ(find(table, 5001), nullptr);
+    EXPECT_EQ(find(table, 4000), nullptr);
+    EXPECT_EQ(find(table, 0), nullptr);
+    EXPECT_EQ(find(table, SRT_INVALID_SOCK), nullptr);
+
+    releaseAll(table, set);
+    EXPECT_EQ(table.size(), 0u);
+    for (auto& s : set.sockets)
+        EXPECT_EQ(find(table, s->m_SocketID), nullptr);
+}
+
+TEST(CSocketTable, ReuseRemovedSlots)
+{
+    CSocketTable table;
+
+    // The IDs going around the table many times, the slots
+    // of the removed sockets are taken by the new ones.
+    for (int round = 0; round < 50; ++round)
+    {
+        SocketSet set(100000 - round * 150, 150);
+        set.insertInto(table);
+        for (auto& s : set.sockets)
+            ASSERT_EQ(find(table, s->m_SocketID), s.get());
+        releaseAll(table, set);
+    }
+    EXPECT_EQ(table.size(), 0u);
+}
+
+TEST(CSocketTable, ReleaseWaitsForReaders)
+{
+    CSocketTable table;
+    SocketSet    set(100, 2);
+    set.insertInto(table);
+    CUDTSocket* s = set.sockets[0].get();
+
+    {
+        CSocketTable::Reader r(table, 100);
+        ASSERT_EQ(r.socket(), s);
+
+        // Removed from the table at once, but not released
+        // for deletion as long as the reader may use it.
+        EXPECT_FALSE(table.release(s));
+        EXPECT_EQ(find(table, 100), nullptr);
+        EXPECT_EQ(find(table, 99), set.sockets[1].get());
+
+        for (int i = 0; i < 5; ++i)
+        {
+            table.collect();
+            EXPECT_FALSE(table.release(s));
+        }
+    }
+
+    table.collect();
+    EXPECT_TRUE(table.release(s));
+}
+
+// The API calls looking up the sockets without locking,
+// while the sockets are being created, closed and deleted.
+TEST(CSocketTable, ConcurrentLookup)
+{
+    srt::TestInit srtinit;
+
+    const int       NSOCKETS = 64;
+    const SRTSOCKET first    = srt_create_socket();
+    ASSERT_NE(first, SRT_INVALID_SOCK);
+
+    atomic<bool>   stop(false);
+    atomic<int>    invalid(0);
+    vector<thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&, t] {
+            // The IDs are generated backward, so these are the IDs of
+            // the sockets created below, and some that never exist.
+            unsigned i = t;
+            while (!stop)
+            {
+                const SRTSOCKET      u  = first - SRTSOCKET(i++ % (NSOCKETS * 8));
+                const SRT_SOCKSTATUS st = srt_getsockstate(u);
+                if (st != SRTS_INIT && st != SRTS_CLOSED && st != SRTS_NONEXIST)
+                    ++invalid;
+
+                SRT_TRACEBSTATS perf;
+                srt_bstats(u, &perf, 0);
+            }
+        });
+    }
+
+    vector<SRTSOCKET> closed(1, first);
+    EXPECT_EQ(srt_close(first), 0);
+    for (int round = 0; round < 4; ++round)
+    {
+        vector<SRTSOCKET> ids;
+        for (int i = 0; i < NSOCKETS; ++i)
+        {
+            ids.push_back(srt_create_socket());
+            EXPECT_NE(ids.back(), SRT_INVALID_SOCK);
+            EXPECT_EQ(srt_getsockstate(ids.back()), SRTS_INIT);
+        }
+        for (SRTSOCKET u : ids)
+        {
+            EXPECT_EQ(srt_close(u), 0);
+            EXPECT_EQ(srt_getsockstate(u), SRTS_CLOSED);
+        }
+        closed.insert(closed.end(), ids.begin(), ids.end());
+
+        // Let the GC delete some of the closed sockets in the meantime.
+        this_thread::sleep_for(chrono::milliseconds(500));
+    }
+
+    // Deleted after a second since closing, when no
+    // reader can be using them.
+    for (int i = 0; i < 100 && srt_getsockstate(closed.back()) != SRTS_NONEXIST; ++i)
+        this_thread::sleep_for(chrono::milliseconds(100));
+
+    stop = true;
+    for (auto& r : readers)
+        r.join();
+
+    EXPECT_EQ(invalid, 0);
+    for (SRTSOCKET u : closed)
+        EXPECT_EQ(srt_getsockstate(u), SRTS_NONEXIST);
+}
@@ -1,7 +1,11 @@
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <thread>
 #include <iostream>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "test_env.h"
@@ -67,3 +71,328 @@ TEST(SocketData, PeerName)
     srt_close(accepted_sock);
     srt_close(lsock);
 }
+
+namespace
+{
+struct ZeroCopyReleased
+{
+    std::atomic<int> count;
+    ZeroCopyReleased() : count(0) {}
+};
+
+void onZeroCopyRelease(void* opaq, const char*, int)
+{
+    ++static_cast<ZeroCopyReleased*>(opaq)->count;
+}
+
+void testZeroCopySend(const char* passphrase)
+{
+    srt::TestInit srtinit;
+
+    int csock = srt_create_socket();
+    int lsock = srt_create_socket();
+
+    if (passphrase)
+    {
+        ASSERT_NE(srt_setsockflag(csock, SRTO_PASSPHRASE, passphrase, (int)strlen(passphrase)), -1);
+        ASSERT_NE(srt_setsockflag(lsock, SRTO_PASSPHRASE, passphrase, (int)strlen(passphrase)), -1);
+    }
+
+    sockaddr_any addr = srt::CreateAddr("127.0.0.1", 5000, AF_INET);
+    ASSERT_NE(srt_bind(lsock, addr.get(), addr.size()), -1);
+    ASSERT_NE(srt_listen(lsock, 5), -1);
+    ASSERT_NE(srt_connect(csock, addr.get(), addr.size()), -1);
+
+    sockaddr_any rev_addr;
+    int accepted_sock = srt_accept(lsock, rev_addr.get(), &rev_addr.len);
+    ASSERT_NE(accepted_sock, SRT_INVALID_SOCK);
+
+    // The buffers must stay untouched until released.
+    const int nmsg = 50;
+    vector<vector<char> > msgs(nmsg, vector<char>(1316));
+    for (int i = 0; i < nmsg; ++i)
+        memset(&msgs[i][0], 'a' + i % 26, msgs[i].size());
+
+    ZeroCopyReleased released;
+    EXPECT_EQ(srt_sendmsg_zerocopy(csock, &msgs[0][0], 1316, NULL, NULL, NULL), SRT_ERROR);
+    for (int i = 0; i < nmsg; ++i)
+        ASSERT_EQ(srt_sendmsg_zerocopy(csock, &msgs[i][0], 1316, NULL, &onZeroCopyRelease, &released), 1316);
+
+    for (int i = 0; i < nmsg; ++i)
+    {
+        char rcvbuf[1500];
+        ASSERT_EQ(srt_recvmsg(accepted_sock, rcvbuf, sizeof rcvbuf), 1316);
+        EXPECT_EQ(rcvbuf[0], 'a' + i % 26);
+        EXPECT_EQ(rcvbuf[1315], 'a' + i % 26);
+    }
+
+    // The buffers are released when acknowledged.
+    for (int retry = 0; retry < 100 && released.count < nmsg; ++retry)
+        this_thread::sleep_for(milliseconds(20));
+    EXPECT_EQ(released.count, nmsg);
+
+    srt_close(csock);
+    srt_close(accepted_sock);
+    srt_close(lsock);
+}
+} // namespace
+
+TEST(SocketData, ZeroCopySend)
+{
+    testZeroCopySend(NULL);
+}
+
+// With encryption the data are copied and the buffers released at once.
+TEST(SocketData, ZeroCopySendEncrypted)
+{
+    testZeroCopySend("zerocopy-secret");
+}
+
+// The payload encrypted in the sender buffer is decrypted by the peer,
+// also across the key refreshes.
+TEST(SocketData, CryptoAhead)
+{
+    srt::TestInit srtinit;
+
+    int csock = srt_create_socket();
+    int lsock = srt_create_socket();
+
+    const char passphrase[] = "crypto-ahead-secret";
+    const bool ahead        = true;
+    const int  refresh      = 64;
+    ASSERT_NE(srt_setsockflag(csock, SRTO_PASSPHRASE, passphrase, sizeof passphrase - 1), -1);
+    ASSERT_NE(srt_setsockflag(lsock, SRTO_PASSPHRASE, passphrase, sizeof passphrase - 1), -1);
+    ASSERT_NE(srt_setsockflag(csock, SRTO_CRYPTOAHEAD, &ahead, sizeof ahead), -1);
+    ASSERT_NE(srt_setsockflag(csock, SRTO_KMREFRESHRATE, &refresh, sizeof refresh), -1);
+
+    sockaddr_any addr = srt::CreateAddr("127.0.0.1", 5000, AF_INET);
+    ASSERT_NE(srt_bind(lsock, addr.get(), addr.size()), -1);
+    ASSERT_NE(srt_listen(lsock, 5), -1);
+    ASSERT_NE(srt_connect(csock, addr.get(), addr.size()), -1);
+
+    sockaddr_any rev_addr;
+    int accepted_sock = srt_accept(lsock, rev_addr.get(), &rev_addr.len);
+    ASSERT_NE(accepted_sock, SRT_INVALID_SOCK);
+
+    const int nmsg = 300;
+    for (int i = 0; i < nmsg; ++i)
+    {
+        char msg[1316];
+        memset(msg, 'a' + i % 26, sizeof msg);
+        msg[0] = char(i);
+        ASSERT_EQ(srt_sendmsg(csock, msg, sizeof msg, -1, true), (int)sizeof msg);
+        if (i % 50 == 49)
+            this_thread::sleep_for(milliseconds(5));
+    }
+
+    for (int i = 0; i < nmsg; ++i)
+    {
+        char rcvbuf[1500];
+        ASSERT_EQ(srt_recvmsg(accepted_sock, rcvbuf, sizeof rcvbuf), 1316);
+        EXPECT_EQ(rcvbuf[0], char(i));
+        EXPECT_EQ(rcvbuf[1], 'a' + i % 26);
+        EXPECT_EQ(rcvbuf[1315], 'a' + i % 26);
+    }
+
+    srt_close(csock);
+    srt_close(accepted_sock);
+    srt_close(lsock);
+}
+
+TEST(SocketData, ZeroCopyRecv)
+{
+    srt::TestInit srtinit;
+
+    int csock = srt_create_socket();
+    int lsock = srt_create_socket();
+
+    sockaddr_any addr = srt::CreateAddr("127.0.0.1", 5000, AF_INET);
+    ASSERT_NE(srt_bind(lsock, addr.get(), addr.size()), -1);
+    ASSERT_NE(srt_listen(lsock, 5), -1);
+    ASSERT_NE(srt_connect(csock, addr.get(), addr.size()), -1);
+
+    sockaddr_any rev_addr;
+    int accepted_sock = srt_accept(lsock, rev_addr.get(), &rev_addr.len);
+    ASSERT_NE(accepted_sock, SRT_INVALID_SOCK);
+
+    const int nmsg = 20;
+    for (int i = 0; i < nmsg; ++i)
+    {
+        vector<char> msg(1316, char('a' + i));
+        ASSERT_EQ(srt_sendmsg(csock, &msg[0], (int)msg.size(), -1, true), 1316);
+    }
+
+    // All messages are kept borrowed at once.
+    vector<SRT_MSGLOAN> loans(nmsg);
+    for (int i = 0; i < nmsg; ++i)
+    {
+        SRT_MSGCTRL mc = srt_msgctrl_default;
+        ASSERT_EQ(srt_recvmsg_borrow(accepted_sock, &loans[i], &mc), 1316);
+        EXPECT_EQ(mc.msgno, i + 1);
+        ASSERT_EQ(loans[i].nsegments, 1);
+        EXPECT_EQ(loans[i].segments[0].len, 1316);
+    }
+
+    for (int i = 0; i < nmsg; ++i)
+    {
+        const SRT_MSGSEGMENT& seg = loans[i].segments[0];
+        EXPECT_EQ(seg.data[0], 'a' + i);
+        EXPECT_EQ(seg.data[seg.len - 1], 'a' + i);
+    }
+
+    // A message can be returned only once, and only to the socket it was borrowed from.
+    EXPECT_EQ(srt_recvmsg_release(csock, &loans[0]), SRT_ERROR);
+    SRT_MSGLOAN first = loans[0];
+    EXPECT_EQ(srt_recvmsg_release(accepted_sock, &loans[0]), 0);
+    EXPECT_EQ(loans[0].handle, nullptr);
+    EXPECT_EQ(srt_recvmsg_release(accepted_sock, &first), SRT_ERROR);
+
+    for (int i = 1; i < nmsg / 2; ++i)
+        EXPECT_EQ(srt_recvmsg_release(accepted_sock, &loans[i]), 0);
+
+    // The messages still borrowed are returned when the socket is deleted.
+    srt_close(csock);
+    srt_close(accepted_sock);
+    srt_close(lsock);
+}
+
+// A header and TS packets are sent as one message without joining them,
+// and received into separate blocks of other sizes.
+TEST(SocketData, ScatterGather)
+{
+    srt::TestInit srtinit;
+
+    int csock = srt_create_socket();
+    int lsock = srt_create_socket();
+
+    sockaddr_any addr = srt::CreateAddr("127.0.0.1", 5000, AF_INET);
+    ASSERT_NE(srt_bind(lsock, addr.get(), addr.size()), -1);
+    ASSERT_NE(srt_listen(lsock, 5), -1);
+    ASSERT_NE(srt_connect(csock, addr.get(), addr.size()), -1);
+
+    sockaddr_any rev_addr;
+    int accepted_sock = srt_accept(lsock, rev_addr.get(), &rev_addr.len);
+    ASSERT_NE(accepted_sock, SRT_INVALID_SOCK);
+
+    char         header[4] = {'S', 'R', 'T', '!'};
+    vector<char> ts(6 * 188); // With the header, still fits in the live payload size
+    for (size_t i = 0; i < ts.size(); ++i)
+        ts[i] = char(i / 188);
+
+    vector<SRT_IOVEC> siov;
+    SRT_IOVEC         h = {header, sizeof header};
+    siov.push_back(h);
+    for (int i = 0; i < 6; ++i)
+    {
+        SRT_IOVEC p = {&ts[i * 188], 188};
+        siov.push_back(p);
+    }
+    const int len = int(sizeof header + ts.size());
+    EXPECT_EQ(srt_sendmsgv(csock, NULL, 0, NULL), SRT_ERROR);
+    ASSERT_EQ(srt_sendmsgv(csock, &siov[0], (int)siov.size(), NULL), len);
+
+    char      rhead[4];
+    char      rbody[1500];
+    SRT_IOVEC riov[2] = {{rhead, sizeof rhead}, {rbody, sizeof rbody}};
+    ASSERT_EQ(srt_recvmsgv(accepted_sock, riov, 2, NULL), len);
+    EXPECT_EQ(memcmp(rhead, header, sizeof header), 0);
+    EXPECT_EQ(memcmp(rbody, &ts[0], ts.size()), 0);
+
+    srt_close(csock);
+    srt_close(accepted_sock);
+    srt_close(lsock);
+}
+
+// The TSBPD delivery of several live connections done by the shared pool,
+// with the receivers reading in the blocking mode and by epoll.
+TEST(SocketData, TsbPdPool)
+{
+    ASSERT_GE(srt_startup_tsbpd(2), 0);
+
+    const int nconn = 4;
+    const int nmsg  = 100;
+
+    int lsock = srt_create_socket();
+    sockaddr_any addr = srt::CreateAddr("127.0.0.1", 5000, AF_INET);
+    ASSERT_NE(srt_bind(lsock, addr.get(), addr.size()), -1);
+    ASSERT_NE(srt_listen(lsock, nconn), -1);
+
+    vector<int> callers, accepted;
+    for (int i = 0; i < nconn; ++i)
+    {
+        int csock = srt_create_socket();
+        ASSERT_NE(srt_connect(csock, addr.get(), addr.size()), -1);
+        sockaddr_any rev_addr;
+        int asock = srt_accept(lsock, rev_addr.get(), &rev_addr.len);
+        ASSERT_NE(asock, SRT_INVALID_SOCK);
+        callers.push_back(csock);
+        accepted.push_back(asock);
+    }
+
+    // The first half read by the blocking calls, the second one by epoll.
+    const int eid = srt_epoll_create();
+    for (int i = nconn / 2; i < nconn; ++i)
+    {
+        bool no = false;
+        srt_setsockflag(accepted[i], SRTO_RCVSYN, &no, sizeof no);
+        const int events = SRT_EPOLL_IN;
+        ASSERT_NE(srt_epoll_add_usock(eid, accepted[i], &events), SRT_ERROR);
+    }
+
+    std::atomic<int> received(0);
+    vector<thread> readers;
+    for (int i = 0; i < nconn / 2; ++i)
+    {
+        const int s = accepted[i];
+        readers.emplace_back([s, &received]() {
+            char buf[1500];
+            for (int m = 0; m < nmsg; ++m)
+            {
+                if (srt_recvmsg(s, buf, sizeof buf) != 1316 || buf[0] != char(m))
+                    return;
+                ++received;
+            }
+        });
+    }
+
+    for (int m = 0; m < nmsg; ++m)
+    {
+        char msg[1316];
+        memset(msg, m, sizeof msg);
+        for (int i = 0; i < nconn; ++i)
+            ASSERT_EQ(srt_sendmsg(callers[i], msg, sizeof msg, -1, true), 1316);
+        this_thread::sleep_for(milliseconds(1));
+    }
+
+    vector<int> next(nconn, 0);
+    for (int polled = 0; polled < (nconn - nconn / 2) * nmsg;)
+    {
+        SRT_EPOLL_EVENT ev[nconn];
+        const int       nready = srt_epoll_uwait(eid, ev, nconn, 2000);
+        ASSERT_GT(nready, 0) << "polled=" << polled;
+        for (int e = 0; e < nready; ++e)
+        {
+            const int i = int(find(accepted.begin(), accepted.end(), ev[e].fd) - accepted.begin());
+            char      buf[1500];
+            while (srt_recvmsg(accepted[i], buf, sizeof buf) == 1316)
+            {
+                ASSERT_EQ(buf[0], char(next[i]));
+                ++next[i];
+                ++polled;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < readers.size(); ++i)
+        readers[i].join();
+    EXPECT_EQ(received, (nconn / 2) * nmsg);
+
+    srt_epoll_release(eid);
+    for (int i = 0; i < nconn; ++i)
+    {
+        srt_close(callers[i]);
+        srt_close(accepted[i]);
+    }
+    srt_close(lsock);
+    EXPECT_NE(srt_cleanup(), -1);
+}
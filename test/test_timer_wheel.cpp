@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <vector>
+#include "gtest/gtest.h"
+#include "test_env.h"
+#include "queue.h"
+
+using namespace std;
+using namespace srt;
+using namespace srt::sync;
+
+namespace
+{
+
+// The wheel uses only the links of the nodes, never the socket instances.
+vector<CRNode> makeNodes(size_t count)
+{
+    vector<CRNode> nodes(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        nodes[i].m_pUDT   = NULL;
+        nodes[i].m_llTick = 0;
+        nodes[i].m_iSlot  = -1;
+        nodes[i].m_pPrev  = NULL;
+        nodes[i].m_pNext  = NULL;
+    }
+    return nodes;
+}
+
+bool contains(const vector<CRNode*>& due, const CRNode* n)
+{
+    return find(due.begin(), due.end(), n) != due.end();
+}
+
+} // namespace
+
+TEST(CTimerWheel, ScheduleAndCollect)
+{
+    CTimerWheel wheel;
+    vector<CRNode> nodes = makeNodes(3);
+    const steady_clock::time_point start = steady_clock::now();
+
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_TRUE(is_zero(wheel.nextDeadline()));
+
+    wheel.schedule(&nodes[0], start + milliseconds_from(10));
+    wheel.schedule(&nodes[1], start + milliseconds_from(20));
+    wheel.schedule(&nodes[2], start + milliseconds_from(30));
+    EXPECT_FALSE(wheel.empty());
+
+    // Never earlier than the first deadline, and not later than one tick after it.
+    const steady_clock::time_point next = wheel.nextDeadline();
+    EXPECT_GE(next, start + milliseconds_from(10));
+    EXPECT_LE(next, start + milliseconds_from(11));
+
+    vector<CRNode*> due;
+    wheel.collectDue(start + milliseconds_from(8), (due));
+    EXPECT_TRUE(due.empty());
+
+    wheel.collectDue(start + milliseconds_from(25), (due));
+    ASSERT_EQ(due.size(), 2u);
+    EXPECT_TRUE(contains(due, &nodes[0]));
+    EXPECT_TRUE(contains(due, &nodes[1]));
+    EXPECT_EQ(nodes[0].m_iSlot, -1);
+
+    // Rescheduling moves the node, and the removed one is never due.
+    due.clear();
+    wheel.schedule(&nodes[0], start + milliseconds_from(40));
+    wheel.schedule(&nodes[2], start + milliseconds_from(50));
+    wheel.remove(&nodes[0]);
+    wheel.remove(&nodes[0]);
+    wheel.collectDue(start + milliseconds_from(45), (due));
+    EXPECT_TRUE(due.empty());
+    wheel.collectDue(start + milliseconds_from(55), (due));
+    ASSERT_EQ(due.size(), 1u);
+    EXPECT_EQ(due[0], &nodes[2]);
+    EXPECT_TRUE(wheel.empty());
+}
+
+/// A deadline already passed is due at the next collection.
+TEST(CTimerWheel, PastDeadline)
+{
+    CTimerWheel wheel;
+    vector<CRNode> nodes = makeNodes(1);
+    const steady_clock::time_point start = steady_clock::now();
+
+    vector<CRNode*> due;
+    wheel.collectDue(start + milliseconds_from(100), (due));
+    wheel.schedule(&nodes[0], start);
+    EXPECT_LE(wheel.nextDeadline(), start + milliseconds_from(102));
+
+    wheel.collectDue(start + milliseconds_from(102), (due));
+    ASSERT_EQ(due.size(), 1u);
+    EXPECT_EQ(due[0], &nodes[0]);
+}
+
+/// Deadlines beyond the first level (256 ticks) and beyond the second one
+/// (256 * 64 ticks) are cascaded down and become due at their time.
+TEST(CTimerWheel, Cascade)
+{
+    CTimerWheel wheel;
+    const int delays_ms[] = {3, 255, 257, 1000, 5000, 16000, 16500, 40000, 100000};
+    const size_t count = sizeof delays_ms / sizeof delays_ms[0];
+    vector<CRNode> nodes = makeNodes(count);
+    const steady_clock::time_point start = steady_clock::now();
+
+    for (size_t i = 0; i < count; ++i)
+        wheel.schedule(&nodes[i], start + milliseconds_from(delays_ms[i]));
+
+    size_t collected = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const steady_clock::time_point deadline = start + milliseconds_from(delays_ms[i]);
+
+        // The wheel may wake up earlier than the deadline, when it's on a higher level,
+        // but it must not skip it. Follow the wake-ups as a receiver worker would.
+        vector<CRNode*> due;
+        for (;;)
+        {
+            const steady_clock::time_point next = wheel.nextDeadline();
+            ASSERT_FALSE(is_zero(next));
+            ASSERT_LE(next, deadline + milliseconds_from(1)) << "i=" << i;
+            wheel.collectDue(next, (due));
+            if (!due.empty())
+                break;
+        }
+
+        ASSERT_EQ(due.size(), 1u) << "i=" << i;
+        EXPECT_EQ(due[0], &nodes[i]);
+        ++collected;
+    }
+    EXPECT_EQ(collected, count);
+    EXPECT_TRUE(wheel.empty());
+}
+
+/// Many sockets with random deadlines are each collected once, in the tick of the deadline.
+TEST(CTimerWheel, ManySockets)
+{
+    CTimerWheel wheel;
+    const size_t count = 10000;
+    vector<CRNode> nodes = makeNodes(count);
+    vector<int> delays_ms(count);
+    const steady_clock::time_point start = steady_clock::now();
+
+    unsigned seed = 12345;
+    for (size_t i = 0; i < count; ++i)
+    {
+        seed         = seed * 1103515245 + 12345;
+        delays_ms[i] = int((seed >> 8) % 30000) + 1;
+        wheel.schedule(&nodes[i], start + milliseconds_from(delays_ms[i]));
+    }
+
+    vector<int> collected_at(count, -1);
+    vector<CRNode*> due;
+    for (int ms = 0; ms <= 30002; ++ms)
+    {
+        due.clear();
+        wheel.collectDue(start + milliseconds_from(ms), (due));
+        for (size_t i = 0; i < due.size(); ++i)
+        {
+            const size_t idx = due[i] - &nodes[0];
+            ASSERT_EQ(collected_at[idx], -1);
+            collected_at[idx] = ms;
+        }
+    }
+
+    EXPECT_TRUE(wheel.empty());
+    for (size_t i = 0; i < count; ++i)
+    {
+        EXPECT_GE(collected_at[i], delays_ms[i]) << "i=" << i;
+        EXPECT_LE(collected_at[i], delays_ms[i] + 1) << "i=" << i;
+    }
+}
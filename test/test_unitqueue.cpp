@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <thread>
 #include <vector>
 #include "gtest/gtest.h"
 #include "test_env.h"
@@ -86,3 +89,204 @@ TEST(CUnitQueue, IncreaseAndFreeGrouped)
             << "Buffer capacity should not exceed two queues of 4 units";
     }
 }
+
+/// A reserved unit is not given away again until the reservation is released,
+/// and a unit taken by the receiver buffer is not available until made free.
+TEST(CUnitQueue, ReserveAndRelease)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 4;
+    CUnitQueue unit_queue(buffer_size_pkts, 1500);
+
+    CUnit* reserved = unit_queue.reserveNextAvailUnit();
+    ASSERT_NE(reserved, nullptr);
+    EXPECT_TRUE(reserved->isReserved());
+
+    CUnit* avail = unit_queue.getNextAvailUnit();
+    ASSERT_NE(avail, nullptr);
+    EXPECT_NE(avail, reserved);
+    // Not reserved, so the same unit is returned again.
+    EXPECT_EQ(unit_queue.getNextAvailUnit(), avail);
+
+    // A reserved unit taken by the buffer stays in use after the reservation is released.
+    unit_queue.makeUnitTaken(reserved);
+    unit_queue.releaseUnit(reserved);
+    EXPECT_FALSE(reserved->isReserved());
+    for (int i = 0; i < 2 * buffer_size_pkts; ++i)
+    {
+        CUnit* unit = unit_queue.reserveNextAvailUnit();
+        ASSERT_NE(unit, nullptr);
+        EXPECT_NE(unit, reserved);
+        unit_queue.releaseUnit(unit);
+    }
+
+    // The last released unit is reused first.
+    unit_queue.makeUnitFree(reserved);
+    EXPECT_EQ(unit_queue.getNextAvailUnit(), reserved);
+}
+
+/// All the units of the queue can be reserved at once, which makes it grow.
+TEST(CUnitQueue, ReserveAll)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 4;
+    CUnitQueue unit_queue(buffer_size_pkts, 1500);
+
+    vector<CUnit*> reserved;
+    for (int i = 0; i < 3 * buffer_size_pkts; ++i)
+    {
+        CUnit* unit = unit_queue.reserveNextAvailUnit();
+        ASSERT_NE(unit, nullptr);
+        EXPECT_EQ(find(reserved.begin(), reserved.end(), unit), reserved.end());
+        reserved.push_back(unit);
+    }
+    EXPECT_EQ(unit_queue.capacity(), 3 * buffer_size_pkts);
+
+    for (CUnit* unit : reserved)
+        unit_queue.releaseUnit(unit);
+    EXPECT_EQ(unit_queue.size(), unit_queue.capacity());
+}
+
+/// The headroom before the buffer of every unit, also of the units added when
+/// growing, can be written without touching the buffer of another unit.
+TEST(CUnitQueue, Headroom)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 4;
+    const int mss              = 1500;
+    const int headroom         = 144;
+    CUnitQueue unit_queue(buffer_size_pkts, mss, headroom);
+
+    vector<CUnit*> reserved;
+    for (int i = 0; i < 3 * buffer_size_pkts; ++i)
+    {
+        CUnit* unit = unit_queue.reserveNextAvailUnit();
+        ASSERT_NE(unit, nullptr);
+        memset(unit->m_Packet.data() - headroom, 'h', headroom);
+        memset(unit->m_Packet.data(), 'a' + i, mss);
+        reserved.push_back(unit);
+    }
+
+    for (size_t i = 0; i < reserved.size(); ++i)
+    {
+        const char* data = reserved[i]->m_Packet.data();
+        EXPECT_EQ(data[0], char('a' + i));
+        EXPECT_EQ(data[mss - 1], char('a' + i));
+        unit_queue.releaseUnit(reserved[i]);
+    }
+}
+
+/// The occupancy statistics follow the units taken and made free.
+TEST(CUnitQueue, Statistics)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 10000; // Big enough to be mapped separately
+    CUnitQueue unit_queue(buffer_size_pkts, 1500);
+    unit_queue.prefault();
+
+    vector<CUnit*> taken_units;
+    for (int i = 0; i < 100; ++i)
+    {
+        CUnit* unit = unit_queue.getNextAvailUnit();
+        ASSERT_NE(unit, nullptr);
+        memset(unit->m_Packet.m_pcData, i, 1500);
+        unit_queue.makeUnitTaken(unit);
+        taken_units.push_back(unit);
+    }
+    EXPECT_EQ(unit_queue.numTaken(), 100);
+    EXPECT_EQ(unit_queue.maxTaken(), 100);
+
+    for (int i = 0; i < 60; ++i)
+        unit_queue.makeUnitFree(taken_units[i]);
+    EXPECT_EQ(unit_queue.numTaken(), 40);
+    EXPECT_EQ(unit_queue.maxTaken(), 100);
+    EXPECT_EQ(unit_queue.capacity(), buffer_size_pkts);
+    EXPECT_EQ(unit_queue.size(), buffer_size_pkts - 40);
+
+    for (int i = 60; i < 100; ++i)
+        unit_queue.makeUnitFree(taken_units[i]);
+    EXPECT_EQ(unit_queue.numTaken(), 0);
+}
+
+/// Units reserved, taken, released and made free by several threads at a time
+/// are never given to two of them at once, and all come back to the queue.
+TEST(CUnitQueue, ConcurrentReserveAndFree)
+{
+    srt::TestInit srtinit;
+    const int buffer_size_pkts = 64;
+    const int num_threads = 4;
+    CUnitQueue unit_queue(buffer_size_pkts, 1500);
+
+    // The payloads are not initialized.
+    vector<CUnit*> units;
+    for (int i = 0; i < buffer_size_pkts; ++i)
+    {
+        units.push_back(unit_queue.reserveNextAvailUnit());
+        ASSERT_NE(units.back(), nullptr);
+        units.back()->m_Packet.m_pcData[0] = 0;
+    }
+    for (CUnit* unit : units)
+        unit_queue.releaseUnit(unit);
+
+    vector<thread> threads;
+    vector<int> collisions(num_threads, 0);
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&unit_queue, &collisions, t]() {
+            vector<CUnit*> taken_units;
+            for (int i = 0; i < 20000; ++i)
+            {
+                CUnit* unit = unit_queue.reserveNextAvailUnit();
+                ASSERT_NE(unit, nullptr);
+                // A free unit has no owner written in its payload.
+                if (unit->m_Packet.m_pcData[0] != 0)
+                    ++collisions[t];
+                unit->m_Packet.m_pcData[0] = char(t + 1);
+
+                if (i % 3 == 0)
+                {
+                    unit->m_Packet.m_pcData[0] = 0;
+                    unit_queue.releaseUnit(unit);
+                    continue;
+                }
+
+                unit_queue.makeUnitTaken(unit);
+                unit_queue.releaseUnit(unit);
+                taken_units.push_back(unit);
+                if (taken_units.size() > 8)
+                {
+                    CUnit* oldest = taken_units.front();
+                    taken_units.erase(taken_units.begin());
+                    if (oldest->m_Packet.m_pcData[0] != char(t + 1))
+                        ++collisions[t];
+                    oldest->m_Packet.m_pcData[0] = 0;
+                    unit_queue.makeUnitFree(oldest);
+                }
+            }
+
+            for (CUnit* unit : taken_units)
+            {
+                unit->m_Packet.m_pcData[0] = 0;
+                unit_queue.makeUnitFree(unit);
+            }
+        });
+    }
+
+    for (thread& th : threads)
+        th.join();
+
+    for (int t = 0; t < num_threads; ++t)
+        EXPECT_EQ(collisions[t], 0);
+    EXPECT_EQ(unit_queue.numTaken(), 0);
+    EXPECT_EQ(unit_queue.size(), unit_queue.capacity());
+
+    // All the units are on the free list again.
+    vector<CUnit*> reserved;
+    for (int i = 0; i < unit_queue.capacity(); ++i)
+    {
+        CUnit* unit = unit_queue.reserveNextAvailUnit();
+        ASSERT_NE(unit, nullptr);
+        EXPECT_EQ(find(reserved.begin(), reserved.end(), unit), reserved.end());
+        reserved.push_back(unit);
+    }
+}